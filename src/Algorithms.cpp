@@ -22,6 +22,7 @@
 
 #include <algorithm> // Of course we stand on the shoulders of the standard library, rather than reinvent the wheel
 #include <cmath>
+#include <vector>
 
 #include <QDebug>
 #include <QVector>
@@ -56,6 +57,58 @@ namespace {
       Polynomial() << -616.868 << 1111.14 << -630.272 << 135.997
    };
 
+   /**
+    * \brief Lookup table for the inverse of \c platoFromSG_20C20C, ie for getting SG from Plato.
+    *
+    *        We evaluate the (forward) cubic at evenly-spaced gravities across the plausible range.  Since the cubic is
+    *        strictly increasing on that range (its derivative is smallest at 1.150, where it is still about 200), the
+    *        resulting Plato values are sorted, so we can binary search them and linearly interpolate to get a first
+    *        guess at the SG.  With a step of 0.001 SG, that guess is within about 2e-7 of the true root, and a single
+    *        Newton step on the cubic then takes us to within about 1e-13 -- ie better than the secant root-finding we
+    *        used to do on every call.
+    */
+   class SgFromPlatoTable {
+   public:
+      SgFromPlatoTable() : sgs{}, platos{} {
+         int const numPoints =
+            static_cast<int>(std::round((maxPlausibleSpecificGravity - minPlausibleSpecificGravity) / step)) + 1;
+         this->sgs.reserve(numPoints);
+         this->platos.reserve(numPoints);
+         for (int ii = 0; ii < numPoints; ++ii) {
+            double const sg = minPlausibleSpecificGravity + ii * step;
+            this->sgs.push_back(sg);
+            this->platos.push_back(platoFromSG_20C20C.eval(sg));
+         }
+         return;
+      }
+
+      //! \return \c true if \c plato is in the range covered by the table
+      bool covers(double const plato) const {
+         return this->platos.front() <= plato && plato <= this->platos.back();
+      }
+
+      //! \return SG for \c plato, which must be in the range covered by the table
+      double sgFor(double const plato) const {
+         Q_ASSERT(this->covers(plato));
+         std::size_t const upper = std::clamp<std::size_t>(
+            std::lower_bound(this->platos.cbegin(), this->platos.cend(), plato) - this->platos.cbegin(),
+            1,
+            this->platos.size() - 1
+         );
+         std::size_t const lower = upper - 1;
+         double const positionInRange = (plato - this->platos[lower]) / (this->platos[upper] - this->platos[lower]);
+         double const guess = this->sgs[lower] + positionInRange * (this->sgs[upper] - this->sgs[lower]);
+
+         // One Newton step to polish the guess
+         return guess - (platoFromSG_20C20C.eval(guess) - plato) / platoFromSG_20C20C.evalDerivative(guess);
+      }
+
+   private:
+      static constexpr double step = 0.001;
+      std::vector<double> sgs;
+      std::vector<double> platos;
+   };
+
    // Water density polynomial, given in kg/L as a function of degrees C.
    // 1.80544064e-8*x^3 - 6.268385468e-6*x^2 + 3.113930471e-5*x + 0.999924134
    Polynomial const waterDensityPoly_C {
@@ -221,13 +274,21 @@ double & Polynomial::operator[] (size_t n) {
 }
 
 double Polynomial::eval(double x) const {
+   // Horner's method (https://en.wikipedia.org/wiki/Horner%27s_method), which needs only one multiply and one add per
+   // coefficient
    double ret = 0.0;
-
-   for(size_t i = order(); i > 0; --i) {
-      ret += m_coeffs[i] * intPow( x, i );
+   for (auto coeff = m_coeffs.crbegin(); coeff != m_coeffs.crend(); ++coeff) {
+      ret = ret * x + *coeff;
    }
-   ret += m_coeffs[0];
+   return ret;
+}
 
+double Polynomial::evalDerivative(double x) const {
+   // Horner's method again, on the coefficients of the derivative (ie n * a_n for x^(n-1))
+   double ret = 0.0;
+   for (size_t i = order(); i > 0; --i) {
+      ret = ret * x + static_cast<double>(i) * m_coeffs[i];
+   }
    return ret;
 }
 
@@ -298,7 +359,13 @@ double Algorithms::SG_20C20C_toPlato(double sg) {
 }
 
 double Algorithms::PlatoToSG_20C20C(double plato) {
-   // Copy the polynomial, cuz we need to alter it.
+   // Built on first use.  (As of C++11, initialisation of function-local statics is thread-safe.)
+   static SgFromPlatoTable const sgFromPlatoTable;
+   if (sgFromPlatoTable.covers(plato)) {
+      return sgFromPlatoTable.sgFor(plato);
+   }
+
+   // Outside the plausible range, do it the slow way.  Copy the polynomial, cuz we need to alter it.
    Polynomial poly(platoFromSG_20C20C);
 
    // After this, finding the root of the polynomial will be finding the SG.
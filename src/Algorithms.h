@@ -68,6 +68,9 @@ public:
    //! \brief Evaluate the polynomial at point \c x
    double eval(double x) const;
 
+   //! \brief Evaluate the first derivative of the polynomial at point \c x
+   double evalDerivative(double x) const;
+
    /*!
     * \brief Root-finding by the secant method.
     *
@@ -111,7 +114,13 @@ namespace Algorithms {
 
    //! \returns plato of \b sg
    double SG_20C20C_toPlato( double sg );
-   //! \returns sg of \b plato
+   /**
+    * \returns sg of \b plato
+    *
+    *          This is the inverse of \c SG_20C20C_toPlato.  For plausible gravities (0.900 to 1.150) it uses a lookup
+    *          table and a single Newton step, which agrees with root-finding on the cubic to better than 1e-12.  Outside
+    *          that range it falls back to \c Polynomial::rootFind.
+    */
    double PlatoToSG_20C20C( double plato );
 
    //! \brief Convert Specific Gravity (measured at 20°C) to Brix
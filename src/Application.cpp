@@ -31,12 +31,14 @@
 
 #include <QDebug>
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QJsonObject>
 #include <QJsonParseError>
 #include <QMessageBox>
 #include <QObject>
 #include <QString>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
@@ -81,6 +83,10 @@ namespace {
    //! \brief Where the user says the database files are
    QDir userDataDir;
 
+   //! \brief See Application::logStartupStage
+   QElapsedTimer startupTimer;
+   qint64 previousStartupStage_ms = 0;
+
    /**
     * \brief Create a directory if it doesn't exist, popping a error dialog if creation fails
     */
@@ -448,7 +454,20 @@ bool Application::initialize() {
    // Check if the database was successfully loaded before
    // loading the main window.
    qDebug() << Q_FUNC_INFO << "Loading Database...";
-   return Database::instance().loadSuccessful();
+   bool const loadedOk = Database::instance().loadSuccessful();
+   logStartupStage("Database loaded");
+   return loadedOk;
+}
+
+void Application::logStartupStage(char const * const stageName) {
+   if (!startupTimer.isValid()) {
+      startupTimer.start();
+   }
+   qint64 const elapsed_ms = startupTimer.elapsed();
+   qInfo().noquote() <<
+      QString{"Startup timeline: %1 at %2 ms (+%3 ms)"}.arg(stageName).arg(elapsed_ms).arg(elapsed_ms - previousStartupStage_ms);
+   previousStartupStage_ms = elapsed_ms;
+   return;
 }
 
 void Application::cleanup() {
@@ -482,18 +501,31 @@ int Application::run() {
    BtSplashScreen splashScreen;
    splashScreen.show();
    qApp->processEvents();
+   logStartupStage("Splash screen shown");
    if( !initialize() )
    {
       cleanup();
       return 1;
    }
    Database::instance().checkForNewDefaultData();
+   logStartupStage("Checked for new default data");
 
    // .:TBD:. Could maybe move the calls to init and setVisible inside createMainWindowInstance() in MainWindow.cpp
    MainWindow & mainWindow = MainWindow::instance();
+   logStartupStage("Main window constructed");
    mainWindow.init();
+   logStartupStage("Main window initialised");
    mainWindow.setVisible(true);
    splashScreen.finish(&mainWindow);
+   logStartupStage("Main window shown");
+
+   //
+   // Only the recipe tree is populated before the main window is shown.  The other trees get populated once the event
+   // loop is running.  (If the user clicks on one of them before then, it gets populated straight away -- see
+   // BtTreeView::showEvent.)  Note that this defers building the trees, but most of the object stores behind them have
+   // already been loaded by now -- see comment in BtTreeModel::BtTreeModel.
+   //
+   QTimer::singleShot(0, &mainWindow, &MainWindow::loadDeferredTrees);
 
    initiateCheckForNewVersion(&mainWindow);
    do {
@@ -507,6 +539,21 @@ int Application::run() {
    return ret;
 }
 
+int Application::runHeadless(std::function<int()> const & job) {
+   setInteractive(false);
+   if (!initialize()) {
+      cleanup();
+      return 1;
+   }
+   logStartupStage("Ready to run batch job");
+
+   int const ret = job();
+
+   cleanup();
+   qDebug() << Q_FUNC_INFO << "Cleaned up.  Returning " << ret;
+   return ret;
+}
+
 void Application::readSystemOptions() {
    // update the config file before we do anything
    updateConfig();
@@ -30,6 +30,8 @@
 // need to use this to turn on Mac keyboard shortcuts (see https://doc.qt.io/qt-5/qkeysequence.html#qt_set_sequence_auto_mnemonic)
 extern void qt_set_sequence_auto_mnemonic(bool b);
 
+#include <functional>
+
 #include <QDir>
 #include <QMetaProperty>
 
@@ -70,6 +72,14 @@ namespace Application {
     */
    int run();
 
+   /*!
+    * \brief Alternative to \c run() for when there is no display (eg nightly jobs on a server).  Does the same set-up,
+    *        including loading the database, but without creating any widgets and in non-interactive mode, then runs
+    *        \c job and cleans up.
+    * \return Exit code from \c job, or 1 if set-up failed
+    */
+   int runHeadless(std::function<int()> const & job);
+
    //! \brief Read options from options. This replaces readPersistentOptions()
    void readSystemOptions();
    //! \brief Writes the persistent options back to the options store
@@ -93,6 +103,12 @@ namespace Application {
     */
    void cleanup();
 
+   /**
+    * \brief Log that start-up has reached \c stageName, along with the time since the first call to this function and
+    *        since the previous call, so that the log shows where start-up time is going.
+    */
+   void logStartupStage(char const * const stageName);
+
    /*!
     * \brief If false, run the application in a way that requires no user interaction
     *
@@ -0,0 +1,420 @@
+/*
+ * BatchJobs.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BatchJobs.h"
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QTextStream>
+
+#include "database/Database.h"
+#include "database/ObjectStoreWrapper.h"
+#include "model/Recipe.h"
+#include "RecipeBulkRecalc.h"
+#include "RecipeDisplaySnapshot.h"
+#include "RecipeFormatter.h"
+#include "RecipeSimilarity.h"
+#include "utils/ParallelFor.h"
+#include "xml/BeerXml.h"
+
+namespace {
+   //! Where results and timings go
+   QTextStream & out() {
+      static QTextStream stream{stdout};
+      return stream;
+   }
+
+   void say(QString const & message) {
+      out() << message << "\n";
+      out().flush();
+      return;
+   }
+
+   void reportStage(QString const & stageName,
+                    int const numItems,
+                    QString const & itemName,
+                    double const elapsed_s,
+                    int const numThreads) {
+      QString const message = QString{"%1: %2 %3 in %4 s (%5 per second, %6 thread(s))"}
+         .arg(stageName)
+         .arg(numItems)
+         .arg(itemName)
+         .arg(elapsed_s, 0, 'f', 3)
+         .arg(elapsed_s > 0.0 ? numItems / elapsed_s : 0.0, 0, 'f', 1)
+         .arg(numThreads);
+      qInfo().noquote() << Q_FUNC_INFO << message;
+      say(message);
+      return;
+   }
+
+   /**
+    * \brief Times one stage of a job and reports how many items per second it got through, so that it's easy to see
+    *        how changes to the code (or the number of threads) affect throughput.
+    */
+   class Throughput {
+   public:
+      Throughput(QString const & stageName, int const numThreads) :
+         stageName{stageName},
+         numThreads{numThreads},
+         timer{} {
+         this->timer.start();
+         return;
+      }
+
+      void report(int const numItems, QString const & itemName) const {
+         reportStage(this->stageName,
+                     numItems,
+                     itemName,
+                     static_cast<double>(this->timer.nsecsElapsed()) / 1.0e9,
+                     this->numThreads);
+         return;
+      }
+
+   private:
+      QString const stageName;
+      int const numThreads;
+      QElapsedTimer timer;
+   };
+
+   QList<Recipe *> allRecipes() {
+      return ObjectStoreWrapper::findAllMatching<Recipe>([](Recipe const * recipe) { return !recipe->deleted(); });
+   }
+
+   //! Recipe names can contain all sorts of things that aren't valid in file names
+   QString fileNameFor(Recipe const & recipe, QString const & suffix) {
+      QString name = recipe.name();
+      for (auto & character : name) {
+         if (!character.isLetterOrNumber() && character != ' ' && character != '-' && character != '_') {
+            character = '_';
+         }
+      }
+      // Including the key means two recipes with the same name don't overwrite each other
+      return QString{"%1 - %2.%3"}.arg(recipe.key()).arg(name.trimmed()).arg(suffix);
+   }
+
+   //! Double any quotes and put quotes round the whole thing
+   QString csvQuoted(QString text) {
+      return QString{"\"%1\""}.arg(text.replace('"', "\"\""));
+   }
+
+   //=================================================== Jobs =========================================================
+
+   int recalc(QStringList const & arguments, int const numThreads) {
+      if (arguments.size() > 1) {
+         qCritical() << Q_FUNC_INFO << "Usage: recalc [file]";
+         return 1;
+      }
+
+      QFile file;
+      if (arguments.isEmpty()) {
+         file.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+      } else {
+         file.setFileName(arguments.at(0));
+         if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << Q_FUNC_INFO << "Unable to open" << arguments.at(0) << "for writing:" << file.errorString();
+            return 1;
+         }
+      }
+
+      // This writes any changed OG/FG back to the DB, so, afterwards, the Recipe objects have all the values we want
+      RecipeBulkRecalc::Stats const stats = RecipeBulkRecalc::recalcAll(numThreads);
+      reportStage("Snapshot",    stats.numRecipes, "recipes", stats.snapshot_s,  1);
+      reportStage("Recalculate", stats.numRecipes, "recipes", stats.calc_s,      stats.numThreads);
+      reportStage("Write back",  stats.numRecipes, "recipes", stats.writeBack_s, 1);
+      say(QString{"%1 of %2 recipes had values that changed"}.arg(stats.numChanged).arg(stats.numRecipes));
+
+      QTextStream csv{&file};
+      csv << "key,name,og,fg,abv_pct,ibu,color_srm,boilVolume_l,finalVolume_l,calories\n";
+      for (auto recipe : allRecipes()) {
+         csv <<
+            recipe->key() << "," << csvQuoted(recipe->name()) << "," <<
+            QString::number(recipe->og(), 'f', 4) << "," << QString::number(recipe->fg(), 'f', 4) << "," <<
+            QString::number(recipe->ABV_pct(), 'f', 2) << "," << QString::number(recipe->IBU(), 'f', 1) << "," <<
+            QString::number(recipe->color_srm(), 'f', 1) << "," <<
+            QString::number(recipe->boilVolume_l(), 'f', 2) << "," <<
+            QString::number(recipe->finalVolume_l(), 'f', 2) << "," <<
+            QString::number(recipe->calories12oz(), 'f', 0) << "\n";
+      }
+      csv.flush();
+      return 0;
+   }
+
+   /**
+    * \brief Show how the recipe calculations scale with the number of threads, from 1 up to \c numThreads.  Nothing is
+    *        written to the DB.
+    */
+   int recalcScaling(QStringList const & arguments, int const numThreads) {
+      if (!arguments.isEmpty()) {
+         qCritical() << Q_FUNC_INFO << "Usage: recalc-scaling";
+         return 1;
+      }
+
+      int const numRecipes = allRecipes().size();
+      say("threads,seconds,speedup,efficiency_pct");
+      for (auto const & point : RecipeBulkRecalc::measureScaling(numThreads)) {
+         say(QString{"%1,%2,%3,%4"}
+            .arg(point.numThreads)
+            .arg(point.calc_s, 0, 'f', 4)
+            .arg(point.speedup, 0, 'f', 2)
+            .arg(100.0 * point.speedup / point.numThreads, 0, 'f', 0));
+         qInfo() <<
+            Q_FUNC_INFO << numRecipes << "recipes on" << point.numThreads << "thread(s) in" << point.calc_s << "s";
+      }
+      return 0;
+   }
+
+   /**
+    * \brief List the recipes most like a given one (see \c RecipeSimilarity), as CSV on standard output
+    */
+   int similar(QStringList const & arguments, [[maybe_unused]] int const numThreads) {
+      bool idOk = true;
+      bool countOk = true;
+      int const recipeId = arguments.isEmpty() ? -1 : arguments.at(0).toInt(&idOk);
+      int const count = arguments.size() < 2 ? 10 : arguments.at(1).toInt(&countOk);
+      if (arguments.isEmpty() || arguments.size() > 2 || !idOk || !countOk) {
+         qCritical() << Q_FUNC_INFO << "Usage: similar recipe-key [count]";
+         return 1;
+      }
+      Recipe * recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(recipeId);
+      if (!recipe) {
+         qCritical() << Q_FUNC_INFO << "No recipe with key" << recipeId;
+         return 1;
+      }
+
+      RecipeSimilarity & recipeSimilarity = RecipeSimilarity::getInstance();
+      {
+         // The first call works out the vectors for every recipe
+         Throughput const timing{"Index", 1};
+         timing.report(recipeSimilarity.size(), "recipes");
+      }
+      QVector<RecipeSimilarity::Match> matches;
+      {
+         Throughput const timing{"Search", 1};
+         matches = recipeSimilarity.findSimilar(recipeId, count);
+         timing.report(recipeSimilarity.size(), "recipes");
+      }
+
+      say(QString{"Recipes most like #%1 (%2)"}.arg(recipe->key()).arg(recipe->name()));
+      say("key,name,distance");
+      for (auto const & match : matches) {
+         Recipe const * matchingRecipe = ObjectStoreWrapper::getByIdRaw<Recipe>(match.recipeId);
+         say(QString{"%1,%2,%3"}
+            .arg(match.recipeId)
+            .arg(csvQuoted(matchingRecipe ? matchingRecipe->name() : QString{}))
+            .arg(static_cast<double>(match.distance), 0, 'f', 4));
+      }
+      return 0;
+   }
+
+   int exportBeerXml(QStringList const & arguments, [[maybe_unused]] int const numThreads) {
+      if (arguments.size() != 1) {
+         qCritical() << Q_FUNC_INFO << "Usage: export-beerxml file";
+         return 1;
+      }
+
+      QFile file{arguments.at(0)};
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         qCritical() << Q_FUNC_INFO << "Unable to open" << arguments.at(0) << "for writing:" << file.errorString();
+         return 1;
+      }
+
+      // The XML library isn't thread-safe the way we use it, so this is all on one thread
+      Throughput const timing{"Export BeerXML", 1};
+      QList<Recipe const *> recipes;
+      for (auto recipe : allRecipes()) {
+         recipes.append(recipe);
+      }
+      BeerXML & beerXml = BeerXML::getInstance();
+      beerXml.createXmlFile(file);
+      beerXml.toXml(recipes, file);
+      file.close();
+      timing.report(recipes.size(), "recipes");
+      return 0;
+   }
+
+   /**
+    * \brief Write each recipe to its own file.  \c prepare is called for each recipe on this thread, as anything that
+    *        reads the model objects has to be, and returns a function that generates the file contents.  Those
+    *        functions are then run, and the files written, in parallel, so we only ever hold the contents of the files
+    *        being written at the time.
+    */
+   int exportFormatted(QStringList const & arguments,
+                       int const numThreads,
+                       QString const & suffix,
+                       std::function<std::function<QString()>(Recipe &)> const & prepare) {
+      if (arguments.size() != 1) {
+         qCritical() << Q_FUNC_INFO << "Usage: export-html|export-text directory";
+         return 1;
+      }
+      QDir const directory{arguments.at(0)};
+      if (!directory.exists() && !directory.mkpath(".")) {
+         qCritical() << Q_FUNC_INFO << "Unable to create directory" << arguments.at(0);
+         return 1;
+      }
+
+      QList<Recipe *> const recipes = allRecipes();
+      Throughput const prepareTiming{"Prepare", 1};
+      std::vector<QPair<QString, std::function<QString()>>> files;
+      files.reserve(static_cast<std::size_t>(recipes.size()));
+      for (auto recipe : recipes) {
+         files.emplace_back(directory.filePath(fileNameFor(*recipe, suffix)), prepare(*recipe));
+      }
+      prepareTiming.report(recipes.size(), "recipes");
+
+      Throughput const writeTiming{"Format and write", numThreads};
+      std::atomic<int> numFailures{0};
+      ParallelFor::forEachIndex(
+         static_cast<int>(files.size()),
+         [&files, &numFailures](int const ii) {
+            auto const & fileNameAndFormat = files[static_cast<std::size_t>(ii)];
+            QByteArray const content = fileNameAndFormat.second().toUtf8();
+            QFile file{fileNameAndFormat.first};
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(content) != content.size()) {
+               qCritical() << Q_FUNC_INFO << "Unable to write" << fileNameAndFormat.first << ":" << file.errorString();
+               ++numFailures;
+            }
+         },
+         numThreads,
+         1
+      );
+      writeTiming.report(static_cast<int>(files.size()) - numFailures, "files");
+      return numFailures > 0 ? 1 : 0;
+   }
+
+   int exportHtml(QStringList const & arguments, int const numThreads) {
+      // The HTML is built from a snapshot, so only taking that has to happen on this thread
+      return exportFormatted(arguments,
+                             numThreads,
+                             "html",
+                             [](Recipe & recipe) {
+                                return [snapshot = RecipeDisplaySnapshot::create(recipe)]() {
+                                   return RecipeFormatter::getHtmlFormat(snapshot);
+                                };
+                             });
+   }
+
+   int exportText(QStringList const & arguments, int const numThreads) {
+      // The text view is still built from the model objects, so has to be done here
+      RecipeFormatter recipeFormatter;
+      return exportFormatted(arguments,
+                             numThreads,
+                             "txt",
+                             [&recipeFormatter](Recipe & recipe) {
+                                recipeFormatter.setRecipe(&recipe);
+                                return [text = recipeFormatter.getTextFormat()]() { return text; };
+                             });
+   }
+
+   int importXml(QStringList const & arguments, [[maybe_unused]] int const numThreads) {
+      if (arguments.isEmpty()) {
+         qCritical() << Q_FUNC_INFO << "Usage: import file...";
+         return 1;
+      }
+
+      // Importing writes to the database, so has to be done on this thread
+      Throughput const timing{"Import", 1};
+      int numFailures = 0;
+      for (auto const & fileName : arguments) {
+         QString userMessage;
+         QTextStream userMessageAsStream{&userMessage};
+         bool const succeeded = BeerXML::getInstance().importFromXML(fileName, userMessageAsStream);
+         say(QString{"%1 %2: %3"}.arg(succeeded ? "Imported" : "FAILED to import").arg(fileName).arg(userMessage));
+         if (!succeeded) {
+            ++numFailures;
+         }
+      }
+      timing.report(arguments.size() - numFailures, "files");
+      return numFailures > 0 ? 1 : 0;
+   }
+
+   int convertDb(QStringList const & arguments, [[maybe_unused]] int const numThreads) {
+      bool const isSqlite = arguments.size() == 1 && arguments.at(0) == "sqlite";
+      bool const isPgsql  = arguments.size() == 5 && arguments.at(0) == "pgsql";
+      bool portOk = isSqlite;
+      int const port = isPgsql ? arguments.at(2).toInt(&portOk) : 0;
+      if ((!isSqlite && !isPgsql) || !portOk) {
+         qCritical() <<
+            Q_FUNC_INFO << "Usage: convert-db sqlite | convert-db pgsql host port database user (with password in "
+            "BREWTARGET_DB_PASSWORD environment variable)";
+         return 1;
+      }
+
+      Database::DbType const newType = isSqlite ? Database::DbType::SQLITE : Database::DbType::PGSQL;
+      if (Database::instance().dbType() == newType) {
+         qCritical() << Q_FUNC_INFO << "Database is already" << arguments.at(0);
+         return 1;
+      }
+
+      Throughput const timing{"Convert database", 1};
+      try {
+         if (isSqlite) {
+            Database::instance().convertDatabase("", "", "", "", 0, newType);
+         } else {
+            Database::instance().convertDatabase(arguments.at(1),
+                                                 arguments.at(3),
+                                                 arguments.at(4),
+                                                 QString::fromLocal8Bit(qgetenv("BREWTARGET_DB_PASSWORD")),
+                                                 port,
+                                                 newType);
+         }
+      } catch (QString const & error) {
+         // Database::convertDatabase will already have logged the error
+         say(QString{"FAILED to convert database: %1"}.arg(error));
+         return 1;
+      }
+      timing.report(allRecipes().size(), "recipes");
+      return 0;
+   }
+
+   using JobFunction = int (*)(QStringList const &, int);
+   QMap<QString, JobFunction> const jobs {
+      {"recalc",         recalc       },
+      {"recalc-scaling", recalcScaling},
+      {"similar",        similar      },
+      {"export-beerxml", exportBeerXml},
+      {"export-html",    exportHtml   },
+      {"export-text",    exportText   },
+      {"import",         importXml    },
+      {"convert-db",     convertDb    },
+   };
+}
+
+QStringList BatchJobs::jobNames() {
+   return jobs.keys();
+}
+
+int BatchJobs::run(QString const & jobName, QStringList const & arguments, int const numThreads) {
+   auto const job = jobs.constFind(jobName);
+   if (job == jobs.cend()) {
+      qCritical() << Q_FUNC_INFO << "Unknown job" << jobName << "- valid jobs are" << jobNames();
+      return 1;
+   }
+
+   qInfo() << Q_FUNC_INFO << "Running" << jobName << "with arguments" << arguments << "on" << numThreads << "thread(s)";
+   Throughput const timing{jobName, numThreads};
+   int const result = (*job)(arguments, numThreads);
+   timing.report(result == 0 ? 1 : 0, "job(s) completed");
+   return result;
+}
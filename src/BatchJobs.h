@@ -0,0 +1,67 @@
+/*
+ * BatchJobs.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BATCHJOBS_H
+#define BATCHJOBS_H
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \brief Jobs that can be run from the command line (with \c --batch) without any user interface, eg as nightly jobs
+ *        on a server with no display.  See \c Application::runHeadless for how they are run.
+ *
+ *        Everything the user needs to see (results and how long things took) goes to standard output; errors go to
+ *        the log as usual.  Work that only needs plain data (eg the recipe calculations on \c RecipeSnapshot objects,
+ *        or writing out files) is spread across worker threads.  Anything that touches model objects or the database
+ *        stays on the main thread.
+ *
+ *        The jobs, and the arguments they take, are:
+ *           \b recalc [file]                 Recalculate every recipe, saving any changed values, and write a CSV
+ *                                            summary of the results to \c file (or standard output)
+ *           \b recalc-scaling                Time the recipe calculations on 1, 2, ... up to the number of threads
+ *                                            (see \c RecipeBulkRecalc::measureScaling)
+ *           \b similar recipe-key [count]    List the \c count (default 10) recipes most like the one with the given
+ *                                            key (see \c RecipeSimilarity)
+ *           \b export-beerxml file           Export every recipe to \c file in BeerXML
+ *           \b export-html directory         Write each recipe as HTML to its own file in \c directory
+ *           \b export-text directory         Write each recipe as plain text to its own file in \c directory
+ *           \b import file...                Import the BeerXML \c file(s) (eg supplier catalogues) into the database
+ *           \b convert-db sqlite             Copy the database to SQLite, in the user data directory
+ *           \b convert-db pgsql host port database user
+ *                                            Copy the database to PostgreSQL.  The password is read from the
+ *                                            \c BREWTARGET_DB_PASSWORD environment variable.
+ */
+namespace BatchJobs {
+   //! \brief Names of all the jobs, for the command line help
+   QStringList jobNames();
+
+   /**
+    * \brief Run the named job.  The database must already be loaded.
+    *
+    * \param jobName One of \c jobNames()
+    * \param arguments Arguments for the job (see above)
+    * \param numThreads How many threads to use for the parts of the job that can be done in parallel
+    *
+    * \return Exit code for the application: 0 for success, non-zero otherwise
+    */
+   int run(QString const & jobName, QStringList const & arguments, int numThreads);
+}
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * BoundedUndoStack.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BoundedUndoStack.h"
+
+#include <algorithm>
+#include <deque>
+
+#include <QDebug>
+
+#include "PersistentSettings.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   /**
+    * \brief What a \c QUndoCommand costs before we take into account anything in the subclass: the object itself, its
+    *        private data (text, action text, child list etc) and the heap overhead for each of those.  This is only an
+    *        estimate, but it's the right order of magnitude, which is all we need for enforcing a memory limit.
+    */
+   std::size_t constexpr baseCommandSize_bytes = sizeof(QUndoCommand) + 128;
+}
+
+// This private implementation class holds all private non-virtual members of BoundedUndoStack
+class BoundedUndoStack::impl {
+public:
+   impl(int const maxCommands, std::size_t const maxMemory_bytes) :
+      maxCommands{std::max(maxCommands, 1)},
+      maxMemory_bytes{maxMemory_bytes},
+      commands{},
+      sizes{},
+      index{0},
+      memoryUsage_bytes{0},
+      numMerged{0},
+      numEvicted{0} {
+      return;
+   }
+
+   ~impl() = default;
+
+   /**
+    * \brief Remove the command at \c position, updating the memory total.  Caller is responsible for adjusting
+    *        \c index.
+    */
+   void erase(std::size_t const position) {
+      this->memoryUsage_bytes -= this->sizes[position];
+      this->commands.erase(this->commands.begin() + static_cast<std::ptrdiff_t>(position));
+      this->sizes.erase(this->sizes.begin() + static_cast<std::ptrdiff_t>(position));
+      return;
+   }
+
+   //! \brief Throw away everything above \c index (ie the commands that were undone and can be redone)
+   void discardRedoableCommands() {
+      while (this->commands.size() > this->index) {
+         this->erase(this->commands.size() - 1);
+      }
+      return;
+   }
+
+   //! \brief Re-estimate the size of the command at \c position, eg after something has been merged into it
+   void resize(std::size_t const position) {
+      this->memoryUsage_bytes -= this->sizes[position];
+      this->sizes[position] = BoundedUndoStack::estimateMemory_bytes(*this->commands[position]);
+      this->memoryUsage_bytes += this->sizes[position];
+      return;
+   }
+
+   //! \brief Throw away the oldest commands until we're within our limits, but always keep the newest one
+   void enforceLimits() {
+      while (this->commands.size() > 1 &&
+             (this->commands.size() > static_cast<std::size_t>(this->maxCommands) ||
+              this->memoryUsage_bytes > this->maxMemory_bytes)) {
+         this->erase(0);
+         // The oldest command can only be one that can be undone, because we only get here after a push, which throws
+         // away anything that can be redone.
+         Q_ASSERT(this->index > 0);
+         --this->index;
+         ++this->numEvicted;
+      }
+      return;
+   }
+
+   void updateGauges() const {
+      BT_SET_GAUGE("undoStack/commands", static_cast<qint64>(this->commands.size()));
+      BT_SET_GAUGE("undoStack/bytes",    static_cast<qint64>(this->memoryUsage_bytes));
+      BT_SET_GAUGE("undoStack/merged",   this->numMerged);
+      BT_SET_GAUGE("undoStack/evicted",  this->numEvicted);
+      return;
+   }
+
+   int const maxCommands;
+   std::size_t const maxMemory_bytes;
+
+   //! Oldest command first
+   std::deque<std::unique_ptr<QUndoCommand>> commands;
+   //! Estimated size of each command in \c commands
+   std::deque<std::size_t> sizes;
+   //! Number of commands that are currently done (ie that can be undone).  Same meaning as \c QUndoStack::index().
+   std::size_t index;
+   std::size_t memoryUsage_bytes;
+   int numMerged;
+   int numEvicted;
+};
+
+BoundedUndoStack::BoundedUndoStack(int const maxCommands, std::size_t const maxMemory_bytes) :
+   pimpl{std::make_unique<impl>(maxCommands, maxMemory_bytes)} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+BoundedUndoStack::~BoundedUndoStack() = default;
+
+std::unique_ptr<BoundedUndoStack> BoundedUndoStack::fromSettings() {
+   int const maxCommands = PersistentSettings::value(PersistentSettings::Names::undoMaxCommands,
+                                                     defaultMaxCommands).toInt();
+   std::size_t const maxMemory_bytes = PersistentSettings::value(
+      PersistentSettings::Names::undoMaxMemory_MiB,
+      static_cast<qulonglong>(defaultMaxMemory_bytes / (1024 * 1024))
+   ).toULongLong() * 1024 * 1024;
+   qInfo() <<
+      Q_FUNC_INFO << "Undo stack limited to" << maxCommands << "commands and" << maxMemory_bytes / (1024 * 1024) <<
+      "MiB";
+   return std::make_unique<BoundedUndoStack>(maxCommands, maxMemory_bytes);
+}
+
+void BoundedUndoStack::push(QUndoCommand * command) {
+   Q_ASSERT(command);
+   std::unique_ptr<QUndoCommand> newCommand{command};
+   newCommand->redo();
+
+   this->pimpl->discardRedoableCommands();
+
+   //
+   // As with QUndoStack, a command can merge with the one before it if they have the same (non-negative) ID and the
+   // earlier command's mergeWith() agrees.
+   //
+   if (this->pimpl->index > 0) {
+      std::size_t const topPosition = this->pimpl->index - 1;
+      QUndoCommand & top = *this->pimpl->commands[topPosition];
+      if (newCommand->id() >= 0 && top.id() == newCommand->id() && top.mergeWith(newCommand.get())) {
+         ++this->pimpl->numMerged;
+         if (top.isObsolete()) {
+            // Merging has left the top command doing nothing (eg a field was edited back to its original value) so we
+            // can throw it away.
+            qDebug() << Q_FUNC_INFO << "Merged command" << top.text() << "is now a no-op";
+            this->pimpl->erase(topPosition);
+            --this->pimpl->index;
+         } else {
+            this->pimpl->resize(topPosition);
+         }
+         this->pimpl->updateGauges();
+         return;
+      }
+   }
+
+   if (newCommand->isObsolete()) {
+      this->pimpl->updateGauges();
+      return;
+   }
+
+   std::size_t const size = estimateMemory_bytes(*newCommand);
+   this->pimpl->commands.push_back(std::move(newCommand));
+   this->pimpl->sizes.push_back(size);
+   this->pimpl->memoryUsage_bytes += size;
+   ++this->pimpl->index;
+
+   this->pimpl->enforceLimits();
+   this->pimpl->updateGauges();
+   return;
+}
+
+bool BoundedUndoStack::canUndo() const {
+   return this->pimpl->index > 0;
+}
+
+bool BoundedUndoStack::canRedo() const {
+   return this->pimpl->index < this->pimpl->commands.size();
+}
+
+QString BoundedUndoStack::undoText() const {
+   if (!this->canUndo()) {
+      return QString{};
+   }
+   return this->pimpl->commands[this->pimpl->index - 1]->actionText();
+}
+
+QString BoundedUndoStack::redoText() const {
+   if (!this->canRedo()) {
+      return QString{};
+   }
+   return this->pimpl->commands[this->pimpl->index]->actionText();
+}
+
+void BoundedUndoStack::undo() {
+   if (!this->canUndo()) {
+      return;
+   }
+   --this->pimpl->index;
+   this->pimpl->commands[this->pimpl->index]->undo();
+   return;
+}
+
+void BoundedUndoStack::redo() {
+   if (!this->canRedo()) {
+      return;
+   }
+   this->pimpl->commands[this->pimpl->index]->redo();
+   ++this->pimpl->index;
+   return;
+}
+
+void BoundedUndoStack::clear() {
+   this->pimpl->commands.clear();
+   this->pimpl->sizes.clear();
+   this->pimpl->index = 0;
+   this->pimpl->memoryUsage_bytes = 0;
+   this->pimpl->updateGauges();
+   return;
+}
+
+int BoundedUndoStack::count() const {
+   return static_cast<int>(this->pimpl->commands.size());
+}
+
+std::size_t BoundedUndoStack::memoryUsage_bytes() const {
+   return this->pimpl->memoryUsage_bytes;
+}
+
+int BoundedUndoStack::numMerged() const {
+   return this->pimpl->numMerged;
+}
+
+int BoundedUndoStack::numEvicted() const {
+   return this->pimpl->numEvicted;
+}
+
+std::size_t BoundedUndoStack::estimateMemory_bytes(QUndoCommand const & command) {
+   std::size_t size = baseCommandSize_bytes + static_cast<std::size_t>(command.text().size()) * sizeof(QChar);
+   auto const sizedCommand = dynamic_cast<SizedCommand const *>(&command);
+   if (sizedCommand) {
+      size += sizedCommand->heldMemory_bytes();
+   }
+   for (int ii = 0; ii < command.childCount(); ++ii) {
+      size += estimateMemory_bytes(*command.child(ii));
+   }
+   return size;
+}
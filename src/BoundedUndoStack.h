@@ -0,0 +1,128 @@
+/*
+ * BoundedUndoStack.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BOUNDEDUNDOSTACK_H
+#define BOUNDEDUNDOSTACK_H
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <QString>
+#include <QUndoCommand>
+
+/**
+ * \class BoundedUndoStack
+ *
+ * \brief Undo/redo stack of \c QUndoCommand objects that, unlike \c QUndoStack, limits both the number of commands
+ *        and (an estimate of) the memory they hold on to, discarding the oldest commands first when either limit is
+ *        exceeded.  Memory matters because, eg, an \c UndoableAddOrRemove for something that was deleted is the only
+ *        thing keeping that object alive.
+ *
+ *        Otherwise it follows the same rules as \c QUndoStack: \c push calls \c redo on the command, throws away
+ *        anything that was undone and not redone, and tries to merge the command into the one before it (see
+ *        \c QUndoCommand::id and \c QUndoCommand::mergeWith).  A command that is obsolete after merging (eg because a
+ *        field was edited back to its original value) is discarded.
+ *
+ *        We only implement the parts of the \c QUndoStack interface that we use.
+ */
+class BoundedUndoStack {
+public:
+   /**
+    * \brief Undo commands that hold on to more than their own fixed-size members (eg strings, or shared pointers to
+    *        objects that would otherwise have been deleted) should also inherit from this, so that the stack can
+    *        take that memory into account.
+    */
+   class SizedCommand {
+   public:
+      virtual ~SizedCommand() = default;
+
+      /**
+       * \return Approximate number of bytes this command is keeping alive, including its own size but excluding any
+       *         child commands (which the stack will ask separately)
+       */
+      virtual std::size_t heldMemory_bytes() const = 0;
+   };
+
+   //! \brief Defaults for the limits, used if nothing is set in \c PersistentSettings
+   static int         constexpr defaultMaxCommands = 500;
+   static std::size_t constexpr defaultMaxMemory_bytes = 32 * 1024 * 1024;
+
+   /**
+    * \param maxCommands  Maximum number of commands to keep.  Must be at least 1.
+    * \param maxMemory_bytes Maximum (estimated) memory for the commands to hold on to.  We always keep the most recent
+    *                        command, even if on its own it is over this limit.
+    */
+   BoundedUndoStack(int maxCommands = defaultMaxCommands, std::size_t maxMemory_bytes = defaultMaxMemory_bytes);
+   ~BoundedUndoStack();
+
+   /**
+    * \brief Make a stack with the limits set in \c PersistentSettings (\c undoMaxCommands and \c undoMaxMemory_MiB),
+    *        or the defaults where they are not set.
+    */
+   static std::unique_ptr<BoundedUndoStack> fromSettings();
+
+   /**
+    * \brief Do \c command and add it to the top of the stack, as for \c QUndoStack::push.  The stack takes ownership
+    *        of \c command, which may have been deleted by the time this returns (if it was merged or obsolete).
+    */
+   void push(QUndoCommand * command);
+
+   bool canUndo() const;
+   bool canRedo() const;
+
+   //! \return \c actionText() of the command that \c undo() would undo, or empty string if there isn't one
+   QString undoText() const;
+   //! \return \c actionText() of the command that \c redo() would redo, or empty string if there isn't one
+   QString redoText() const;
+
+   void undo();
+   void redo();
+
+   //! \brief Throw away all commands
+   void clear();
+
+   //! \return Number of commands on the stack (including ones that can be redone)
+   int count() const;
+
+   //! \return Estimated memory held by all commands on the stack
+   std::size_t memoryUsage_bytes() const;
+
+   //! \return Number of commands pushed that were merged into the command before them
+   int numMerged() const;
+
+   //! \return Number of commands thrown away because one of the limits was exceeded
+   int numEvicted() const;
+
+   /**
+    * \brief Estimate the memory held by \c command and its children.  Exposed mainly for testing.
+    */
+   static std::size_t estimateMemory_bytes(QUndoCommand const & command);
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   BoundedUndoStack(BoundedUndoStack const &) = delete;
+   BoundedUndoStack & operator=(BoundedUndoStack const &) = delete;
+   BoundedUndoStack(BoundedUndoStack &&) = delete;
+   BoundedUndoStack & operator=(BoundedUndoStack &&) = delete;
+};
+
+#endif
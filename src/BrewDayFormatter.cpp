@@ -22,40 +22,75 @@
  */
 #include "BrewDayFormatter.h"
 
+#include <QDate>
 #include <QList>
-#include <QStringList>
 
 #include "Html.h"
 #include "measurement/Measurement.h"
-#include "model/Equipment.h"
-#include "model/Instruction.h"
-#include "model/Mash.h"
-#include "model/Style.h"
-#include "PersistentSettings.h"
+#include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "RecipeDisplaySnapshot.h"
+
+namespace {
+   /**
+    * \brief As \c Recipe::getReagents for fermentables
+    */
+   QList<QString> getFermentableReagents(RecipeDisplaySnapshot const & recipe) {
+      QList<QString> reagents;
+      auto const & ferms = recipe.fermentables;
+      for (int ii = 0; ii < ferms.size(); ++ii) {
+         if (ferms[ii].isMashed) {
+            reagents.append(
+               QString(ii + 1 < ferms.size() ? "%1 %2, " : "%1 %2 ")
+                  .arg(recipe.displayUnitSystems.displayAmount(Measurement::Amount{ferms[ii].amount_kg,
+                                                                                   Measurement::Units::kilograms}))
+                  .arg(ferms[ii].name)
+            );
+         }
+      }
+      return reagents;
+   }
 
-BrewDayFormatter::BrewDayFormatter(QObject * parent)
-   : QObject(parent) {
-   recObs = nullptr;
+   /**
+    * \brief As \c Recipe::getReagents for mash steps.  (We use the same translation strings.)
+    */
+   QList<QString> getMashStepReagents(RecipeDisplaySnapshot const & recipe) {
+      QList<QString> reagents;
+      auto const & msteps = recipe.mashSteps;
+      for (int ii = 0; ii < msteps.size(); ++ii) {
+         if (!msteps[ii].isInfusion) {
+            continue;
+         }
+         reagents.append(
+            (ii + 1 < msteps.size() ? Recipe::tr("%1 water to %2, ") : Recipe::tr("%1 water to %2 "))
+               .arg(recipe.displayUnitSystems.displayAmount(Measurement::Amount{msteps[ii].infuseAmount_l,
+                                                                                Measurement::Units::liters}))
+               .arg(recipe.displayUnitSystems.displayAmount(Measurement::Amount{msteps[ii].infuseTemp_c,
+                                                                                Measurement::Units::celsius}))
+         );
+      }
+      return reagents;
+   }
 }
 
-void BrewDayFormatter::setRecipe(Recipe * recipe) {
-   recObs = recipe;
+QString BrewDayFormatter::buildHtml(RecipeDisplaySnapshot const & recipe) {
+   return buildHtmlHeader() +
+          buildTitleHtml(recipe) +
+          buildInstructionHtml(recipe) +
+          buildFooterHtml() +
+          Html::createFooter();
 }
 
-QString BrewDayFormatter::buildHtml() {
-   return buildTitleHtml() + buildInstructionHtml() + buildFooterHtml();
+QString BrewDayFormatter::buildHtmlHeader() {
+   return Html::createHeader(tr("Brewday"), ":/css/brewday.css");
 }
 
-QString BrewDayFormatter::buildTitleHtml(bool includeImage) {
-
-   // Do the style sheet first
-   if (cssName == nullptr) {
-      cssName = ":/css/brewday.css";
-   }
-
-   QString header = Html::createHeader(tr("Brewday"), cssName);
+QString BrewDayFormatter::buildTitleHtml(RecipeDisplaySnapshot const & recipe, bool includeImage) {
+   auto const & units = recipe.displayUnitSystems;
+   // Everything we show that isn't stored in the Recipe has to be calculated from the snapshot
+   RecipeCalcs::Results const calcs = RecipeCalcs::calcAll(recipe.calcInputs);
 
-   QString body = QString("<h1>%1</h1>").arg(recObs->name());
+   QString body = QString("<h1>%1</h1>").arg(recipe.calcInputs.name);
    if (includeImage) {
       body += QString("<img src=\"%1\" />").arg("qrc:/images/title.svg");
    }
@@ -66,7 +101,7 @@ QString BrewDayFormatter::buildTitleHtml(bool includeImage) {
    body += QString("<tr><td class=\"left\">%1</td>")
            .arg(tr("Style"));
    body += QString("<td class=\"value\">%1</td>")
-           .arg((recObs->style()) ? recObs->style()->name() : "unknown");
+           .arg(recipe.style ? recipe.style->name : "unknown");
    body += QString("<td class=\"right\">%1</td>")
            .arg(tr("Date"));
    body += QString("<td class=\"value\">%1</td></tr>")
@@ -76,115 +111,48 @@ QString BrewDayFormatter::buildTitleHtml(bool includeImage) {
    body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
            .arg(tr("Boil Time"))
            .arg(
-              recObs->equipment() ? Measurement::displayAmount(Measurement::Amount{recObs->equipment()->boilTime_min(),
-                                                                                   Measurement::Units::minutes}) : "unknown"
+              recipe.calcInputs.equipment ?
+                 units.displayAmount(Measurement::Amount{recipe.calcInputs.equipment->boilTime_min,
+                                                         Measurement::Units::minutes}) : "unknown"
            )
            .arg(tr("Efficiency"))
-           .arg(Measurement::displayQuantity(recObs->efficiency_pct(), 0));
+           .arg(Measurement::displayQuantity(recipe.calcInputs.efficiency_pct, 0));
 
    // third row: pre-Boil Volume and Preboil Gravity
    body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
            .arg(tr("Boil Volume"))
-           .arg(Measurement::displayAmount(Measurement::Amount{recObs->boilVolume_l(), Measurement::Units::liters}, 2))
+           .arg(units.displayAmount(Measurement::Amount{calcs.volumes.boilVolume_l, Measurement::Units::liters}, 2))
            .arg(tr("Preboil Gravity"))
-           .arg(Measurement::displayAmount(Measurement::Amount{recObs->boilGrav(), Measurement::Units::specificGravity}, 3));
+           .arg(units.displayAmount(Measurement::Amount{calcs.boilGrav, Measurement::Units::specificGravity}, 3));
 
    // fourth row: Final volume and starting gravity
    body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
            .arg(tr("Final Volume"))
-           .arg(Measurement::displayAmount(Measurement::Amount{recObs->finalVolume_l(), Measurement::Units::liters}, 2))
+           .arg(units.displayAmount(Measurement::Amount{calcs.volumes.finalVolume_l, Measurement::Units::liters}, 2))
            .arg(tr("Starting Gravity"))
-           .arg(Measurement::displayAmount(Measurement::Amount{recObs->og(), Measurement::Units::specificGravity}, 3));
+           .arg(units.displayAmount(Measurement::Amount{calcs.gravities.og, Measurement::Units::specificGravity}, 3));
 
    // fifth row: IBU and Final gravity
    body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</tr>")
            .arg(tr("IBU"))
-           .arg(Measurement::displayQuantity(recObs->IBU(), 1))
+           .arg(Measurement::displayQuantity(calcs.IBU, 1))
            .arg(tr("Final Gravity"))
-           .arg(Measurement::displayAmount(Measurement::Amount{recObs->fg(), Measurement::Units::specificGravity}, 3));
+           .arg(units.displayAmount(Measurement::Amount{calcs.gravities.fg, Measurement::Units::specificGravity}, 3));
 
    // sixth row: ABV and estimate calories
    bool metricVolume =
-      Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity::Volume) ==
-      Measurement::UnitSystems::volume_Metric;
+      units.get(Measurement::PhysicalQuantity::Volume) == Measurement::UnitSystems::volume_Metric;
    body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2%</td><td class=\"right\">%3</td><td class=\"value\">%4</tr>")
            .arg(tr("ABV"))
-           .arg(Measurement::displayQuantity(recObs->ABV_pct(), 1))
+           .arg(Measurement::displayQuantity(calcs.ABV_pct, 1))
            .arg(metricVolume ? tr("Estimated calories (per 33 cl)") :
                 tr("Estimated calories (per 12 oz)"))
-           .arg(Measurement::displayQuantity(metricVolume ? recObs->calories33cl() : recObs->calories12oz(), 0));
+           // Calories are calculated per 12 oz, so this is the same conversion as Recipe::calories33cl
+           .arg(Measurement::displayQuantity(metricVolume ? calcs.calories * 3.3 / 3.55 : calcs.calories, 0));
 
    body += "</table>";
 
-   return header + body;
-}
-
-QList<QStringList> BrewDayFormatter::buildTitleList() {
-   QList<QStringList> ret;
-
-   if (! recObs) {
-      return ret;
-   }
-
-   QString body = "";
-   QStringList row;
-   row.append(tr("Style"));
-   row.append((recObs->style()) ? recObs->style()->name() : "unknown");
-   row.append(tr("Date"));
-   row.append(QDate::currentDate().toString());
-   ret.append(row);
-   row.clear();
-
-   // second row:  boil time and efficiency.
-   row.append(tr("Boil Time"));
-   row.append(
-      recObs->equipment() ? Measurement::displayAmount(Measurement::Amount{recObs->equipment()->boilTime_min(),
-                                                                           Measurement::Units::minutes}) : "unknown"
-   );
-   row.append(tr("Efficiency"));
-   row.append(Measurement::displayQuantity(recObs->efficiency_pct(), 0));
-   ret.append(row);
-   row.clear();
-
-   // third row: pre-Boil Volume and Preboil Gravity
-   row.append(tr("Boil Volume"));
-   row.append(Measurement::displayAmount(Measurement::Amount{recObs->boilVolume_l(), Measurement::Units::liters}, 2));
-   row.append(tr("Preboil Gravity"));
-   row.append(Measurement::displayAmount(Measurement::Amount{recObs->boilGrav(), Measurement::Units::specificGravity}, 3));
-   ret.append(row);
-   row.clear();
-   ret.append(row);
-   row.clear();
-
-   // fourth row: Final volume and starting gravity
-   row.append(tr("Final Volume"));
-   row.append(Measurement::displayAmount(Measurement::Amount{recObs->finalVolume_l(), Measurement::Units::liters}, 2));
-   row.append(tr("Starting Gravity"));
-   row.append(Measurement::displayAmount(Measurement::Amount{recObs->og(), Measurement::Units::specificGravity}, 3));
-   ret.append(row);
-   row.clear();
-
-   // fifth row: IBU and Final gravity
-   row.append(tr("IBU"));
-   row.append(Measurement::displayQuantity(recObs->IBU(), 1));
-   row.append(tr("Final Gravity"));
-   row.append(Measurement::displayAmount(Measurement::Amount{recObs->fg(), Measurement::Units::specificGravity}, 3));
-   ret.append(row);
-   row.clear();
-
-   // sixth row: ABV and estimate calories
-   row.append(tr("ABV"));
-   row.append(Measurement::displayQuantity(recObs->ABV_pct(), 1));
-   bool metricVolume =
-      Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity::Volume) ==
-      Measurement::UnitSystems::volume_Metric;
-
-   row.append(metricVolume ? tr("Estimated calories (per 33 cl)") : tr("Estimated calories (per 12 oz)"));
-   row.append(Measurement::displayQuantity(metricVolume ? recObs->calories33cl() : recObs->calories12oz(), 0));
-   ret.append(row);
-   row.clear();
-
-   return ret;
+   return body;
 }
 
 /**
@@ -192,7 +160,7 @@ QList<QStringList> BrewDayFormatter::buildTitleList() {
  *
  * @return QString
  */
-QString BrewDayFormatter::buildInstructionHtml() {
+QString BrewDayFormatter::buildInstructionHtml(RecipeDisplaySnapshot const & recipe) {
    QString middle = QString("<h2>%1</h2>").arg(tr("Instructions"));
    middle += QString("<table id=\"steps\">");
    middle += QString("<tr><th class=\"check\">%1</th><th class=\"time\">%2</th><th class=\"step\">%3</th></tr>")
@@ -200,31 +168,31 @@ QString BrewDayFormatter::buildInstructionHtml() {
              .arg(tr("Time"))
              .arg(tr("Step"));
 
-   QList<Instruction *> instructions = recObs->instructions();
-   auto mashSteps = recObs->mash()->mashSteps();
+   auto const & instructions = recipe.instructions;
    int size = instructions.size();
    for (int i = 0; i < size; ++i) {
       QString stepTime, tmp;
       QList<QString> reagents;
 
-      Instruction * ins = instructions[i];
+      auto const & ins = instructions[i];
 
-      if (ins->interval() > 0.0) {
-         stepTime = Measurement::displayAmount(Measurement::Amount{ins->interval(), Measurement::Units::minutes}, 0);
+      if (ins.interval_min > 0.0) {
+         stepTime = recipe.displayUnitSystems.displayAmount(Measurement::Amount{ins.interval_min,
+                                                                                Measurement::Units::minutes}, 0);
       } else {
          stepTime = "--";
       }
 
       tmp = "";
 
-      // TODO: comparing ins->name() with these untranslated strings means this
+      // TODO: comparing ins.name with these untranslated strings means this
       // doesn't work in other languages. Find a better way.
-      if (ins->name() == tr("Add grains")) {
-         reagents = recObs->getReagents(recObs->fermentables());
-      } else if (ins->name() == tr("Heat water")) {
-         reagents = recObs->getReagents(recObs->mash()->mashSteps());
+      if (ins.name == tr("Add grains")) {
+         reagents = getFermentableReagents(recipe);
+      } else if (ins.name == tr("Heat water")) {
+         reagents = getMashStepReagents(recipe);
       } else {
-         reagents = ins->reagents();
+         reagents = ins.reagents;
       }
 
       if (reagents.size() > 1) {
@@ -237,7 +205,7 @@ QString BrewDayFormatter::buildInstructionHtml() {
       } else if (reagents.size() == 1) {
          tmp = reagents.at(0);
       } else {
-         tmp = ins->directions();
+         tmp = ins.directions;
       }
 
       QString altTag = i % 2 ? "alt" : "norm";
@@ -245,7 +213,7 @@ QString BrewDayFormatter::buildInstructionHtml() {
       middle += QString("<tr class=\"%1\"><td class=\"check\"></td><td class=\"time\">%2</td><td align=\"step\">%3 : %4</td></tr>")
                 .arg(altTag)
                 .arg(stepTime)
-                .arg(ins->name())
+                .arg(ins.name)
                 .arg(tmp);
    }
    middle += "</table>";
@@ -253,61 +221,6 @@ QString BrewDayFormatter::buildInstructionHtml() {
    return middle;
 }
 
-QList<QStringList> BrewDayFormatter::buildInstructionList() {
-   QList<QStringList> ret;
-
-   QStringList row;
-   int i, size;
-
-   row.append(tr("Completed"));
-   row.append(tr("Time"));
-   row.append(tr("Step"));
-   ret.append(row);
-   row.clear();
-
-   QList<Instruction *> instructions = recObs->instructions();
-   auto mashSteps = recObs->mash()->mashSteps();
-   size = instructions.size();
-   for (i = 0; i < size; ++i) {
-      QString stepTime, tmp;
-      QList<QString> reagents;
-
-      Instruction * ins = instructions[i];
-
-      if (ins->interval() > 0.0) {
-         stepTime = Measurement::displayAmount(Measurement::Amount{ins->interval(), Measurement::Units::minutes}, 0);
-      } else {
-         stepTime = "--";
-      }
-
-      // TODO: comparing ins->name() with these untranslated strings means this
-      // doesn't work in other languages. Find a better way.
-      if (ins->name() == tr("Add grains")) {
-         reagents = recObs->getReagents(recObs->fermentables());
-      } else if (ins->name() == tr("Heat water")) {
-         reagents = recObs->getReagents(recObs->mash()->mashSteps());
-      } else {
-         reagents = ins->reagents();
-      }
-
-      tmp = "";
-      if (reagents.size() > 0) {
-         foreach (QString reagent, reagents) {
-            tmp += QString("\t%1\n").arg(reagent);
-         }
-      } else {
-         tmp = ins->directions();
-      }
-
-      row.append(stepTime);
-      row.append(QString("%1 : %2").arg(ins->name()).arg(tmp));
-      ret.append(row);
-      row.clear();
-   }
-
-   return ret;
-}
-
 QString BrewDayFormatter::buildFooterHtml() {
    QString bottom = QString("<table id=\"notes\">");
    bottom += QString("<tr><td class=\"left\">%1:</td><td class=\"value\"></td><td class=\"right\">%2:</td><td class=\"value\"></td></tr>")
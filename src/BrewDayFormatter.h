@@ -1,6 +1,6 @@
 /*
  * BrewDayFormatter.h is part of Brewtarget, and is Copyright the following
- * authors 2009-2021
+ * authors 2009-2023
  * - Jeff Bailey <skydvr38@verizon.net>
  * - Mattias Måhl <mattias@kejsarsten.com>
  * - Matt Young <mfsy@yahoo.com>
@@ -23,77 +23,57 @@
 #ifndef BREWDAYFORMATTER_H
 #define BREWDAYFORMATTER_H
 
-#include <QList>
 #include <QObject>
-#include <QStringList>
-#include <QWidget>
+#include <QString>
 
-#include "model/Recipe.h"
+struct RecipeDisplaySnapshot;
 
+/*!
+ * \class BrewDayFormatter
+ *
+ * \brief Creates the HTML brew day sheet for a recipe.  Everything works from a \c RecipeDisplaySnapshot (which has to
+ *        be taken on the GUI thread) and is safe to call on any thread.  (This is only a \c QObject so that the strings
+ *        have the right translation context.)
+ */
 class BrewDayFormatter : public QObject {
    Q_OBJECT
 
 public:
    /**
-    * @brief Construct a new Brew Day Formatter object
-    *
-    * @param parent
-    */
-   BrewDayFormatter(QObject *parent);
-
-   /**
-    * @brief Set the Recipe object
+    * @brief Builds the whole HTML page for Brewday instructions
     *
-    * @param recipe
+    * @return QString
     */
-   void setRecipe(Recipe *recipe);
+   static QString buildHtml(RecipeDisplaySnapshot const & recipe);
 
    /**
-    * @brief Builds the whole HTML page for Brewday instructions
+    * @brief The start of the HTML page, up to and including the opening body tag
     *
     * @return QString
     */
-   QString buildHtml();
+   static QString buildHtmlHeader();
 
-private:
    /**
     * @brief Create HTML string containing the basic information about the recipe
     *
     * @param includeImage
     * @return QString
     */
-   QString buildTitleHtml(bool includeImage = true);
+   static QString buildTitleHtml(RecipeDisplaySnapshot const & recipe, bool includeImage = true);
 
-   /**
-    * @brief Creates a list of string-lists that contains the data about the basic information about the recipe.
-    *
-    * @return QList<QStringList>
-    */
-   QList<QStringList> buildTitleList();
-public:
    /**
     * @brief Create HTML string containing the instructions for the recipe
     *
     * @return QString
     */
-   QString buildInstructionHtml();
-private:
-   /**
-    * @brief Create a list of string-lists that contain the instructions on how to brew the recipe
-    *
-    * @return QList<QStringList>
-    */
-   QList<QStringList> buildInstructionList();
-public:
+   static QString buildInstructionHtml(RecipeDisplaySnapshot const & recipe);
+
    /**
     * @brief Builds and returns the Boil notes section for the bottom of the HTML page
     *
     * @return QString
     */
-   QString buildFooterHtml();
-private:
-   Recipe *recObs;
-   QString cssName;
+   static QString buildFooterHtml();
 };
 
 #endif
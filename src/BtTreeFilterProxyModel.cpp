@@ -21,6 +21,7 @@
 #include "BtTreeFilterProxyModel.h"
 
 #include <QDebug>
+#include <QTimer>
 
 #include "BtFolder.h"
 #include "BtTreeModel.h"
@@ -33,6 +34,7 @@
 #include "model/Style.h"
 #include "model/Water.h"
 #include "model/Yeast.h"
+#include "StyleIndex.h"
 
 namespace {
 
@@ -228,7 +230,47 @@ namespace {
 BtTreeFilterProxyModel::BtTreeFilterProxyModel(QObject * parent,
                                                BtTreeModel::TypeMasks mask) :
    QSortFilterProxyModel{parent},
-   treeMask{mask} {
+   treeMask{mask},
+   currentStyleFilter{StyleFilter::All},
+   refilterPending{false} {
+   return;
+}
+
+void BtTreeFilterProxyModel::setStyleFilter(StyleFilter styleFilter) {
+   if (styleFilter == this->currentStyleFilter) {
+      return;
+   }
+   this->currentStyleFilter = styleFilter;
+   if (this->treeMask != BtTreeModel::RECIPEMASK) {
+      return;
+   }
+   if (styleFilter != StyleFilter::All) {
+      connect(&StyleIndex::getInstance(),
+              &StyleIndex::changed,
+              this,
+              &BtTreeFilterProxyModel::styleIndexChanged,
+              Qt::UniqueConnection);
+   }
+   this->invalidateFilter();
+   return;
+}
+
+BtTreeFilterProxyModel::StyleFilter BtTreeFilterProxyModel::styleFilter() const {
+   return this->currentStyleFilter;
+}
+
+void BtTreeFilterProxyModel::styleIndexChanged() {
+   if (this->currentStyleFilter == StyleFilter::All || this->refilterPending) {
+      return;
+   }
+   //
+   // Editing a recipe can mean lots of changes in a row, so we wait until they're done and then re-filter once
+   //
+   this->refilterPending = true;
+   QTimer::singleShot(0, this, [this]() {
+      this->refilterPending = false;
+      this->invalidateFilter();
+   });
    return;
 }
 
@@ -294,7 +336,21 @@ bool BtTreeFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex
 
       // we are showing the child (context menu -> show snapshots ) OR
       // we are meant to display this thing.
-      return model->showChild(child) || thing->display();
+      if (model->showChild(child)) {
+         return true;
+      }
+      if (!thing->display()) {
+         return false;
+      }
+
+      // Brew notes aren't subject to the style filter, but are only shown when their recipe is
+      auto recipe = qobject_cast<Recipe *>(thing);
+      if (this->currentStyleFilter == StyleFilter::All || !recipe) {
+         return true;
+      }
+      StyleIndex::Conformance const conformance = StyleIndex::getInstance().conformance(recipe->key());
+      return this->currentStyleFilter == StyleFilter::InStyle ? conformance == StyleIndex::Conformance::InStyle :
+                                                                 conformance == StyleIndex::Conformance::OutOfStyle;
    }
 
    if (thing) {
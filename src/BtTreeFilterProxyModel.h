@@ -36,14 +36,33 @@ class BtTreeFilterProxyModel : public QSortFilterProxyModel {
    Q_OBJECT
 
 public:
+   /**
+    * \brief For the recipe tree, which recipes to show according to whether they are within the ranges of their own
+    *        style (see \c StyleIndex).  Ignored for other trees.
+    */
+   enum class StyleFilter {
+      All,
+      InStyle,
+      OutOfStyle
+   };
+
    BtTreeFilterProxyModel(QObject *parent, BtTreeModel::TypeMasks mask);
 
+   void setStyleFilter(StyleFilter styleFilter);
+   StyleFilter styleFilter() const;
+
 protected:
    bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
    bool filterAcceptsRow( int source_row, const QModelIndex &source_parent) const;
 
+private slots:
+   //! \brief Re-filter (once the current event is done) when recipes may have gone in or out of style
+   void styleIndexChanged();
+
 private:
    BtTreeModel::TypeMasks treeMask;
+   StyleFilter currentStyleFilter;
+   bool refilterPending;
 };
 
 #endif
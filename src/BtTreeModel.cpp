@@ -35,7 +35,6 @@
 #include "BtFolder.h"
 #include "BtTreeItem.h"
 #include "BtTreeView.h"
-#include "RecipeFormatter.h"
 #include "database/ObjectStoreWrapper.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
@@ -48,6 +47,8 @@
 #include "model/Water.h"
 #include "utils/BtStringConst.h"
 #include "PersistentSettings.h"
+#include "ToolTipCache.h"
+#include "utils/Instrumentation.h"
 
 namespace {
    NamedEntity * getElement(BtTreeItem::Type oType, int id) {
@@ -92,69 +93,48 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
    switch (type) {
       case RECIPEMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::RECIPE);
-         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectInserted, this, &BtTreeModel::elementAddedRecipe);
-         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedRecipe);
-         // Brewnotes need love too!
-         connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectInserted, this, &BtTreeModel::elementAddedBrewNote);
-         connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedBrewNote);
-         // And some versioning stuff, because why not?
-         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalPropertyChanged, this, &BtTreeModel::recipePropertyChanged);
          this->itemType = BtTreeItem::Type::RECIPE;
          _mimeType = "application/x-brewtarget-recipe";
          m_maxColumns = BtTreeItem::RECIPENUMCOLS;
          break;
       case EQUIPMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::EQUIPMENT);
-         connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectInserted, this, &BtTreeModel::elementAddedEquipment);
-         connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedEquipment);
          this->itemType = BtTreeItem::Type::EQUIPMENT;
          _mimeType = "application/x-brewtarget-recipe";
          m_maxColumns = BtTreeItem::EQUIPMENTNUMCOLS;
          break;
       case FERMENTMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::FERMENTABLE);
-         connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectInserted, this, &BtTreeModel::elementAddedFermentable);
-         connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedFermentable);
          this->itemType = BtTreeItem::Type::FERMENTABLE;
          _mimeType = "application/x-brewtarget-ingredient";
          m_maxColumns = BtTreeItem::FERMENTABLENUMCOLS;
          break;
       case HOPMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::HOP);
-         connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectInserted, this, &BtTreeModel::elementAddedHop);
-         connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedHop);
          this->itemType = BtTreeItem::Type::HOP;
          _mimeType = "application/x-brewtarget-ingredient";
          m_maxColumns = BtTreeItem::HOPNUMCOLS;
          break;
       case MISCMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::MISC);
-         connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectInserted, this, &BtTreeModel::elementAddedMisc);
-         connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedMisc);
          this->itemType = BtTreeItem::Type::MISC;
          _mimeType = "application/x-brewtarget-ingredient";
          m_maxColumns = BtTreeItem::MISCNUMCOLS;
          break;
       case STYLEMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::STYLE);
-         connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectInserted, this, &BtTreeModel::elementAddedStyle);
-         connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedStyle);
          this->itemType = BtTreeItem::Type::STYLE;
          _mimeType = "application/x-brewtarget-recipe";
          m_maxColumns = BtTreeItem::STYLENUMCOLS;
          break;
       case YEASTMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::YEAST);
-         connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectInserted, this, &BtTreeModel::elementAddedYeast);
-         connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedYeast);
          this->itemType = BtTreeItem::Type::YEAST;
          _mimeType = "application/x-brewtarget-ingredient";
          m_maxColumns = BtTreeItem::YEASTNUMCOLS;
          break;
       case WATERMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::WATER);
-         connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectInserted, this, &BtTreeModel::elementAddedWater);
-         connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedWater);
          this->itemType = BtTreeItem::Type::WATER;
          _mimeType = "application/x-brewtarget-ingredient";
          m_maxColumns = BtTreeItem::WATERNUMCOLS;
@@ -165,10 +145,84 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
 
    this->treeMask = type;
    this->parentTree = parent;
+   this->loaded = false;
+   //
+   // The recipe tree is the first thing the user sees, so we populate it straight away.  Other trees are populated
+   // once the main window is showing (see MainWindow::loadDeferredTrees), or sooner if they are needed.
+   //
+   // This only saves building the tree items at startup.  It does not, in general, save loading the object stores
+   // behind the trees, because MainWindow::init loads most of them anyway: Recipe::connectSignalsForAllRecipes reads
+   // every recipe's equipment, fermentables, hops, yeasts and mash; the equipment and style combo boxes list every
+   // equipment and style; and showing the current recipe reads its ingredients, style and inventory.  (Of the stores
+   // with trees, only water is not needed until its tree is populated or the water dialog is opened.)
+   //
+   if (type == RECIPEMASK) {
+      this->ensureLoaded();
+   }
+   return;
+}
+
+void BtTreeModel::connectObjectStores() {
+   switch (this->treeMask) {
+      case RECIPEMASK:
+         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectInserted, this, &BtTreeModel::elementAddedRecipe);
+         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedRecipe);
+         // Brewnotes need love too!
+         connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectInserted, this, &BtTreeModel::elementAddedBrewNote);
+         connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedBrewNote);
+         // And some versioning stuff, because why not?
+         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalPropertyChanged, this, &BtTreeModel::recipePropertyChanged);
+         break;
+      case EQUIPMASK:
+         connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectInserted, this, &BtTreeModel::elementAddedEquipment);
+         connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedEquipment);
+         break;
+      case FERMENTMASK:
+         connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectInserted, this, &BtTreeModel::elementAddedFermentable);
+         connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedFermentable);
+         break;
+      case HOPMASK:
+         connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectInserted, this, &BtTreeModel::elementAddedHop);
+         connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedHop);
+         break;
+      case MISCMASK:
+         connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectInserted, this, &BtTreeModel::elementAddedMisc);
+         connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedMisc);
+         break;
+      case STYLEMASK:
+         connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectInserted, this, &BtTreeModel::elementAddedStyle);
+         connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedStyle);
+         break;
+      case YEASTMASK:
+         connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectInserted, this, &BtTreeModel::elementAddedYeast);
+         connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedYeast);
+         break;
+      case WATERMASK:
+         connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectInserted, this, &BtTreeModel::elementAddedWater);
+         connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedWater);
+         break;
+      default:
+         // Invalid masks were already logged in the constructor
+         break;
+   }
+   return;
+}
+
+void BtTreeModel::ensureLoaded() {
+   if (this->loaded) {
+      return;
+   }
+   qDebug() << Q_FUNC_INFO << "Populating tree" << this->treeMask;
+   this->loaded = true;
+   this->connectObjectStores();
    this->loadTreeModel();
    return;
 }
 
+bool BtTreeModel::isLoaded() const {
+   return this->loaded;
+}
+
 BtTreeModel::~BtTreeModel() {
    // Qt automatically handles the disconnection of any signals we were listening to
    delete rootItem;
@@ -296,25 +350,17 @@ QVariant BtTreeModel::data(const QModelIndex & index, int role) const {
 }
 
 QVariant BtTreeModel::toolTipData(const QModelIndex & index) const {
-   RecipeFormatter * whiskey = new RecipeFormatter();
-
    switch (treeMask) {
       case RECIPEMASK:
-         return whiskey->getToolTip(qobject_cast<Recipe *>(thing(index)));
       case STYLEMASK:
-         return whiskey->getToolTip(qobject_cast<Style *>(thing(index)));
       case EQUIPMASK:
-         return whiskey->getToolTip(qobject_cast<Equipment *>(thing(index)));
       case FERMENTMASK:
-         return whiskey->getToolTip(qobject_cast<Fermentable *>(thing(index)));
       case HOPMASK:
-         return whiskey->getToolTip(qobject_cast<Hop *>(thing(index)));
       case MISCMASK:
-         return whiskey->getToolTip(qobject_cast<Misc *>(thing(index)));
       case YEASTMASK:
-         return whiskey->getToolTip(qobject_cast<Yeast *>(thing(index)));
       case WATERMASK:
-         return whiskey->getToolTip(qobject_cast<Water *>(thing(index)));
+         // Tooltips are expensive to build, so we only do it once per object (until it changes)
+         return ToolTipCache::getInstance().getToolTip(thing(index));
       default:
          return item(index)->name();
    }
@@ -621,6 +667,8 @@ QList<NamedEntity *> BtTreeModel::elements() {
 }
 
 void BtTreeModel::loadTreeModel() {
+   BT_TIME_SCOPE("BtTreeModel::loadTreeModel");
+
    int i;
 
    QModelIndex ndxLocal;
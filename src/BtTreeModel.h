@@ -89,6 +89,17 @@ public:
    BtTreeModel(BtTreeView * parent = nullptr, TypeMasks type = RECIPEMASK);
    virtual ~BtTreeModel();
 
+   /**
+    * \brief Populate the tree (and start listening for additions and removals) if we haven't already.  Recipe trees
+    *        are populated on construction.  Other trees are empty until this is called, which allows us to defer
+    *        building them until after the main window is showing.  (This does not usually defer loading the object
+    *        store behind the tree, as most stores are needed at startup anyway -- see comment in the constructor.)
+    */
+   void ensureLoaded();
+
+   //! \brief Whether \c ensureLoaded has been called
+   bool isLoaded() const;
+
    //! \brief Reimplemented from QAbstractItemModel
    virtual QVariant data(const QModelIndex & index, int role) const;
    //! \brief Reimplemented from QAbstractItemModel
@@ -225,6 +236,9 @@ signals:
    void recipeSpawn(Recipe * descendant);
 
 private:
+   //! \brief Connects to the signals from the object store(s) for the things we show
+   void connectObjectStores();
+
    //! \brief Loads the tree.
    void loadTreeModel();
 
@@ -280,6 +294,7 @@ private:
    BtTreeItem::Type itemType;
    int m_maxColumns;
    QString _mimeType;
+   bool loaded;
 
 };
 
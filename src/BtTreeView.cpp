@@ -20,6 +20,7 @@
  */
 #include "BtTreeView.h"
 
+#include <QActionGroup>
 #include <QApplication>
 #include <QDebug>
 #include <QDrag>
@@ -88,6 +89,22 @@ BtTreeFilterProxyModel * BtTreeView::filter() {
    return m_filter;
 }
 
+void BtTreeView::populate() {
+   if (this->m_model->isLoaded()) {
+      return;
+   }
+   this->m_model->ensureLoaded();
+   this->setExpanded(findElement(nullptr), true);
+   this->resizeColumnToContents(0);
+   return;
+}
+
+void BtTreeView::showEvent(QShowEvent * event) {
+   this->populate();
+   QTreeView::showEvent(event);
+   return;
+}
+
 bool BtTreeView::removeRow(const QModelIndex & index) {
    QModelIndex modelIndex = m_filter->mapToSource(index);
    QModelIndex parent = m_model->parent(modelIndex);
@@ -458,6 +475,27 @@ void BtTreeView::setupContextMenu(QWidget * top, QWidget * editor) {
          m_spawnAction  = m_versionMenu->addAction(tr("Snapshot Recipe"), this, SLOT(spawnRecipe()));
          m_contextMenu->addMenu(m_versionMenu);
 
+         // style filter menu
+         {
+            QMenu * styleFilterMenu = m_contextMenu->addMenu(tr("Show"));
+            QActionGroup * styleFilterGroup = new QActionGroup(styleFilterMenu);
+            auto addStyleFilter = [this, styleFilterMenu, styleFilterGroup](
+               QString const & text,
+               BtTreeFilterProxyModel::StyleFilter styleFilter
+            ) {
+               QAction * action = styleFilterMenu->addAction(text);
+               action->setCheckable(true);
+               action->setChecked(this->m_filter->styleFilter() == styleFilter);
+               styleFilterGroup->addAction(action);
+               connect(action, &QAction::triggered, this, [this, styleFilter]() {
+                  this->m_filter->setStyleFilter(styleFilter);
+               });
+            };
+            addStyleFilter(tr("All Recipes"),                  BtTreeFilterProxyModel::StyleFilter::All       );
+            addStyleFilter(tr("Recipes Within Style Ranges"),  BtTreeFilterProxyModel::StyleFilter::InStyle   );
+            addStyleFilter(tr("Recipes Outside Style Ranges"), BtTreeFilterProxyModel::StyleFilter::OutOfStyle);
+         }
+
          m_contextMenu->addSeparator();
          m_brewItAction = m_contextMenu->addAction(tr("Brew It!"), top, SLOT(brewItHelper()));
          m_contextMenu->addSeparator();
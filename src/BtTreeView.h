@@ -25,6 +25,7 @@
 #include <QWidget>
 #include <QPoint>
 #include <QMouseEvent>
+#include <QShowEvent>
 
 #include "BtTreeItem.h"
 #include "BtTreeFilterProxyModel.h"
@@ -56,6 +57,12 @@ public:
    //! \b returns the filter associated with this model
    BtTreeFilterProxyModel * filter();
 
+   /**
+    * \brief Populate the tree if this has not already been done (see \c BtTreeModel::ensureLoaded).  This also happens
+    *        automatically when the tree is first shown.
+    */
+   void populate();
+
    //! \brief returns the context menu associated with the \c selected item
    QMenu * contextMenu(QModelIndex selected);
 
@@ -117,6 +124,9 @@ public:
    //! \brief catches a key stroke in a tree
    void keyPressEvent(QKeyEvent * event);
 
+   //! \brief makes sure the tree is populated before it is shown
+   virtual void showEvent(QShowEvent * event);
+
    //! \brief creates a context menu based on the type of tree
    void setupContextMenu(QWidget * top, QWidget * editor);
 
@@ -44,27 +44,34 @@ bool FermentableSortFilterProxyModel::lessThan(QModelIndex const & left,
    auto const columnIndex = static_cast<FermentableTableModel::ColumnIndex>(left.column());
    switch (columnIndex) {
       case FermentableTableModel::ColumnIndex::Inventory:
-         // If the numbers are equal, compare the names and be done with it
-         if (Measurement::qStringToSI(leftFermentable.toString(), Measurement::PhysicalQuantity::Mass) ==
-             Measurement::qStringToSI(rightFermentable.toString(), Measurement::PhysicalQuantity::Mass)) {
-            return getName(right) < getName(left);
-         } else if (Measurement::qStringToSI(leftFermentable.toString(),
-                                             Measurement::PhysicalQuantity::Mass).quantity() == 0.0 &&
-                    this->sortOrder() == Qt::AscendingOrder) {
-            // Show non-zero entries first.
-            return false;
+         {
+            // Parse each side once, rather than once per comparison below
+            auto const leftAmount  = Measurement::qStringToSI(leftFermentable.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            auto const rightAmount = Measurement::qStringToSI(rightFermentable.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            // If the numbers are equal, compare the names and be done with it
+            if (leftAmount == rightAmount) {
+               return getName(right) < getName(left);
+            } else if (leftAmount.quantity() == 0.0 && this->sortOrder() == Qt::AscendingOrder) {
+               // Show non-zero entries first.
+               return false;
+            }
+            return leftAmount < rightAmount;
          }
-         return Measurement::qStringToSI(leftFermentable.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightFermentable.toString(), Measurement::PhysicalQuantity::Mass);
 
       case FermentableTableModel::ColumnIndex::Amount:
-         // If the numbers are equal, compare the names and be done with it
-         if (Measurement::qStringToSI(leftFermentable.toString(), Measurement::PhysicalQuantity::Mass) ==
-             Measurement::qStringToSI(rightFermentable.toString(), Measurement::PhysicalQuantity::Mass)) {
-            return getName(right) < getName(left);
+         {
+            auto const leftAmount  = Measurement::qStringToSI(leftFermentable.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            auto const rightAmount = Measurement::qStringToSI(rightFermentable.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            // If the numbers are equal, compare the names and be done with it
+            if (leftAmount == rightAmount) {
+               return getName(right) < getName(left);
+            }
+            return leftAmount < rightAmount;
          }
-         return Measurement::qStringToSI(leftFermentable.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightFermentable.toString(), Measurement::PhysicalQuantity::Mass);
 
       case FermentableTableModel::ColumnIndex::Yield:
          {
@@ -51,12 +51,14 @@ bool HopSortFilterProxyModel::lessThan(QModelIndex const & left,
          }
 
       case HopTableModel::ColumnIndex::Inventory:
-         if (Measurement::qStringToSI(leftHop.toString(), Measurement::PhysicalQuantity::Mass).quantity() == 0.0 &&
-            this->sortOrder() == Qt::AscendingOrder) {
-            return false;
+         {
+            auto const leftAmount  = Measurement::qStringToSI(leftHop.toString(),  Measurement::PhysicalQuantity::Mass);
+            auto const rightAmount = Measurement::qStringToSI(rightHop.toString(), Measurement::PhysicalQuantity::Mass);
+            if (leftAmount.quantity() == 0.0 && this->sortOrder() == Qt::AscendingOrder) {
+               return false;
+            }
+            return leftAmount < rightAmount;
          }
-         return Measurement::qStringToSI(leftHop.toString(), Measurement::PhysicalQuantity::Mass) <
-                Measurement::qStringToSI(rightHop.toString(), Measurement::PhysicalQuantity::Mass);
 
       case HopTableModel::ColumnIndex::Amount:
          return Measurement::qStringToSI(leftHop.toString(), Measurement::PhysicalQuantity::Mass) <
@@ -0,0 +1,214 @@
+/*
+ * InstrumentationDialog.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "InstrumentationDialog.h"
+
+#include <cmath>
+
+#include <QDir>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QStringList>
+#include <QVBoxLayout>
+
+#include "utils/Instrumentation.h"
+
+namespace {
+   int constexpr autoRefreshInterval_ms = 1000;
+
+   // Columns before the histogram ones
+   enum Column {
+      Name,
+      Count,
+      Total_ms,
+      Mean_us,
+      Max_ms,
+      FirstHistogramColumn
+   };
+
+   QStringList columnHeadings() {
+      QStringList headings{"Probe", "Count", "Total (ms)", "Mean (µs)", "Max (ms)"};
+      // Histogram bucket headings are the upper limits, eg "<1µs", "<10µs", ..., with the last bucket being "≥1s"
+      auto describe = [](qint64 const limit_ns) {
+         if (limit_ns >= 1'000'000'000) { return QString{"%1s" }.arg(limit_ns / 1'000'000'000); }
+         if (limit_ns >=     1'000'000) { return QString{"%1ms"}.arg(limit_ns /     1'000'000); }
+         if (limit_ns >=         1'000) { return QString{"%1µs"}.arg(limit_ns /         1'000); }
+         return QString{"%1ns"}.arg(limit_ns);
+      };
+      for (auto const limit_ns : Instrumentation::histogramBucketLimits_ns) {
+         headings.append(QString{"<%1"}.arg(describe(limit_ns)));
+      }
+      headings.append(QString{"≥%1"}.arg(describe(Instrumentation::histogramBucketLimits_ns.back())));
+      return headings;
+   }
+
+   //! Numeric cells need to sort as numbers, not strings.  Fractional values are shown to three decimal places.
+   QTableWidgetItem * numericItem(double const value, bool const isFractional = false) {
+      auto item = new QTableWidgetItem{};
+      item->setData(Qt::DisplayRole, isFractional ? QVariant{std::round(value * 1000.0) / 1000.0} :
+                                                    QVariant{static_cast<qulonglong>(value)});
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      return item;
+   }
+}
+
+InstrumentationDialog::InstrumentationDialog(QWidget * parent) :
+   QDialog{parent},
+   table               {new QTableWidget{this}},
+   gaugeTable          {new QTableWidget{this}},
+   checkBox_autoRefresh{new QCheckBox{"Auto refresh", this}},
+   checkBox_trace      {new QCheckBox{"Record trace", this}},
+   label_traceEvents   {new QLabel{this}},
+   pushButton_refresh  {new QPushButton{"Refresh", this}},
+   pushButton_reset    {new QPushButton{"Reset", this}},
+   pushButton_saveTrace{new QPushButton{"Save trace...", this}},
+   autoRefreshTimer    {new QTimer{this}} {
+   this->setObjectName("instrumentationDialog");
+   this->setWindowTitle("Timing Probes");
+   this->resize(900, 500);
+
+   QStringList const headings = columnHeadings();
+   this->table->setColumnCount(headings.size());
+   this->table->setHorizontalHeaderLabels(headings);
+   this->table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+   this->table->setSortingEnabled(true);
+   this->table->verticalHeader()->setVisible(false);
+   this->table->horizontalHeader()->setSectionResizeMode(Column::Name, QHeaderView::Stretch);
+
+   this->gaugeTable->setColumnCount(2);
+   this->gaugeTable->setHorizontalHeaderLabels({"Gauge", "Value"});
+   this->gaugeTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+   this->gaugeTable->verticalHeader()->setVisible(false);
+   this->gaugeTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+   this->gaugeTable->setMaximumHeight(150);
+
+   this->checkBox_autoRefresh->setChecked(true);
+   this->checkBox_trace->setChecked(Instrumentation::isTracing());
+
+   auto buttonLayout = new QHBoxLayout{};
+   buttonLayout->addWidget(this->checkBox_autoRefresh);
+   buttonLayout->addWidget(this->pushButton_refresh);
+   buttonLayout->addWidget(this->pushButton_reset);
+   buttonLayout->addStretch();
+   buttonLayout->addWidget(this->checkBox_trace);
+   buttonLayout->addWidget(this->label_traceEvents);
+   buttonLayout->addWidget(this->pushButton_saveTrace);
+
+   auto mainLayout = new QVBoxLayout{this};
+   mainLayout->addWidget(this->table);
+   mainLayout->addWidget(this->gaugeTable);
+   mainLayout->addLayout(buttonLayout);
+
+   this->autoRefreshTimer->setInterval(autoRefreshInterval_ms);
+
+   connect(this->autoRefreshTimer,     &QTimer::timeout,      this, &InstrumentationDialog::refresh     );
+   connect(this->checkBox_autoRefresh, &QCheckBox::toggled,   this, [this](bool checked) {
+      if (checked && this->isVisible()) {
+         this->autoRefreshTimer->start();
+      } else {
+         this->autoRefreshTimer->stop();
+      }
+   });
+   connect(this->checkBox_trace,       &QCheckBox::toggled,   this, &InstrumentationDialog::setTracing  );
+   connect(this->pushButton_refresh,   &QPushButton::clicked, this, &InstrumentationDialog::refresh     );
+   connect(this->pushButton_reset,     &QPushButton::clicked, this, &InstrumentationDialog::resetProbes );
+   connect(this->pushButton_saveTrace, &QPushButton::clicked, this, &InstrumentationDialog::saveTrace   );
+   return;
+}
+
+InstrumentationDialog::~InstrumentationDialog() = default;
+
+void InstrumentationDialog::refresh() {
+   QVector<Instrumentation::ProbeStats> const allStats = Instrumentation::allStats();
+
+   // Turn off sorting while we fill the table, otherwise rows move around as we go
+   int const sortColumn = this->table->horizontalHeader()->sortIndicatorSection();
+   Qt::SortOrder const sortOrder = this->table->horizontalHeader()->sortIndicatorOrder();
+   this->table->setSortingEnabled(false);
+   this->table->setRowCount(allStats.size());
+   int row = 0;
+   for (auto const & stats : allStats) {
+      this->table->setItem(row, Column::Name,     new QTableWidgetItem{QString::fromUtf8(stats.name)});
+      this->table->setItem(row, Column::Count,    numericItem(stats.count));
+      this->table->setItem(row, Column::Total_ms, numericItem(stats.total_ns / 1.0e6, true));
+      this->table->setItem(row, Column::Mean_us,  numericItem(stats.count ? stats.total_ns / 1.0e3 / stats.count : 0.0, true));
+      this->table->setItem(row, Column::Max_ms,   numericItem(stats.max_ns / 1.0e6, true));
+      int column = Column::FirstHistogramColumn;
+      for (auto const bucketCount : stats.histogram) {
+         this->table->setItem(row, column++, numericItem(bucketCount));
+      }
+      ++row;
+   }
+   this->table->setSortingEnabled(true);
+   this->table->sortByColumn(sortColumn, sortOrder);
+
+   QVector<QPair<char const *, qint64>> const allGauges = Instrumentation::allGauges();
+   this->gaugeTable->setRowCount(allGauges.size());
+   row = 0;
+   for (auto const & gauge : allGauges) {
+      this->gaugeTable->setItem(row, 0, new QTableWidgetItem{QString::fromUtf8(gauge.first)});
+      this->gaugeTable->setItem(row, 1, numericItem(static_cast<double>(gauge.second)));
+      ++row;
+   }
+
+   this->label_traceEvents->setText(QString{"%1 events"}.arg(Instrumentation::numTraceEvents()));
+   return;
+}
+
+void InstrumentationDialog::resetProbes() {
+   Instrumentation::reset();
+   this->refresh();
+   return;
+}
+
+void InstrumentationDialog::setTracing(bool const enabled) {
+   Instrumentation::setTracing(enabled);
+   this->refresh();
+   return;
+}
+
+void InstrumentationDialog::saveTrace() {
+   QString const fileName = QFileDialog::getSaveFileName(this,
+                                                         "Save trace",
+                                                         QDir::homePath() + "/brewtarget-trace.json",
+                                                         "Chrome trace files (*.json)");
+   if (fileName.isEmpty()) {
+      return;
+   }
+   if (!Instrumentation::writeChromeTrace(fileName)) {
+      QMessageBox::warning(this, "Save trace", QString{"Unable to write %1"}.arg(fileName));
+   }
+   return;
+}
+
+void InstrumentationDialog::showEvent(QShowEvent * event) {
+   this->refresh();
+   if (this->checkBox_autoRefresh->isChecked()) {
+      this->autoRefreshTimer->start();
+   }
+   QDialog::showEvent(event);
+   return;
+}
+
+void InstrumentationDialog::hideEvent(QHideEvent * event) {
+   this->autoRefreshTimer->stop();
+   QDialog::hideEvent(event);
+   return;
+}
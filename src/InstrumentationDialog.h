@@ -0,0 +1,70 @@
+/*
+ * InstrumentationDialog.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef INSTRUMENTATIONDIALOG_H
+#define INSTRUMENTATIONDIALOG_H
+#pragma once
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+
+/*!
+ * \class InstrumentationDialog
+ *
+ * \brief Developer tool showing the figures from the timing probes and the values of the gauges (see
+ *        \c utils/Instrumentation.h), with controls to reset the probes and to record and save a trace.
+ *
+ *        This is aimed at developers rather than end users, so we don't bother translating it.
+ */
+class InstrumentationDialog : public QDialog {
+   Q_OBJECT
+
+public:
+   InstrumentationDialog(QWidget * parent = nullptr);
+   virtual ~InstrumentationDialog();
+
+public slots:
+   //! \brief Reload the table from the current probe figures
+   void refresh();
+
+private slots:
+   void resetProbes();
+   void setTracing(bool enabled);
+   void saveTrace();
+
+protected:
+   virtual void showEvent(QShowEvent * event);
+   virtual void hideEvent(QHideEvent * event);
+
+private:
+   QTableWidget * table;
+   QTableWidget * gaugeTable;
+   QCheckBox    * checkBox_autoRefresh;
+   QCheckBox    * checkBox_trace;
+   QLabel       * label_traceEvents;
+   QPushButton  * pushButton_refresh;
+   QPushButton  * pushButton_reset;
+   QPushButton  * pushButton_saveTrace;
+   QTimer       * autoRefreshTimer;
+};
+
+#endif
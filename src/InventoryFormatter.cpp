@@ -19,6 +19,8 @@
  */
 #include "InventoryFormatter.h"
 
+#include <type_traits>
+
 #include <QList>
 #include <QMap>
 #include <QStringList>
@@ -40,25 +42,45 @@ namespace {
     *
     * @return QString
     */
-   QString createInventoryHeader() {
+   QString createInventoryHeader(InventoryFormatter::Snapshot const & inventory) {
       return Html::createHeader(QObject::tr("Inventory"), ":css/inventory.css") +
             QString("<h1>%1 &mdash; %2</h1>")
                   .arg(QObject::tr("Inventory"))
-                  .arg(Localization::displayDateUserFormated(QDate::currentDate()));
+                  .arg(inventory.date);
+   }
+
+   /**
+    * \brief Copy out all the parent ingredients of type \c NE whose inventory is > 0.  (We don't want children because
+    *        they are just usages of the parents in recipes.)
+    */
+   template<class NE>
+   QVector<InventoryFormatter::Snapshot::Item> inventoryItems() {
+      auto inventory = ObjectStoreWrapper::findAllMatching<NE>(
+         [](std::shared_ptr<NE> ne) { return (ne->getParent() == nullptr && ne->inventory() > 0.0); }
+      );
+      QVector<InventoryFormatter::Snapshot::Item> items;
+      items.reserve(static_cast<int>(inventory.size()));
+      for (auto ne : inventory) {
+         double alpha_pct = 0.0;
+         bool amountIsWeight = true;
+         if constexpr (std::is_same_v<NE, Hop>) {
+            alpha_pct = ne->alpha_pct();
+         }
+         if constexpr (std::is_same_v<NE, Misc> || std::is_same_v<NE, Yeast>) {
+            amountIsWeight = ne->amountIsWeight();
+         }
+         items.append(InventoryFormatter::Snapshot::Item{ne->name(), ne->inventory(), amountIsWeight, alpha_pct});
+      }
+      return items;
    }
 
    /**
     * \brief Create Inventory HTML Table of \c Fermentable
     */
-   QString createInventoryTableFermentable() {
+   QString createInventoryTableFermentable(InventoryFormatter::Snapshot const & inventory) {
       QString result;
 
-      // Find all the parent Fermentables whose inventory is > 0
-      // (We don't want children because they are just usages of the parents in recipes.)
-      auto inventory = ObjectStoreWrapper::findAllMatching<Fermentable>(
-         [](std::shared_ptr<Fermentable> ff) { return (ff->getParent() == nullptr && ff->inventory() > 0.0); }
-      );
-      if (!inventory.empty()) {
+      if (!inventory.fermentables.empty()) {
          result += QString("<h2>%1</h2>").arg(QObject::tr("Fermentables"));
          result += "<table id=\"fermentables\">";
          result += QString("<tr>"
@@ -68,14 +90,15 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto fermentable : inventory) {
+         for (auto const & fermentable : inventory.fermentables) {
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(fermentable->name())
-                           .arg(Measurement::displayAmount(Measurement::Amount{fermentable->inventory(),
-                                                                               Measurement::Units::kilograms}));
+                           .arg(fermentable.name)
+                           .arg(inventory.displayUnitSystems.displayAmount(
+                              Measurement::Amount{fermentable.amount, Measurement::Units::kilograms}
+                           ));
          }
          result += "</table>";
       }
@@ -85,13 +108,10 @@ namespace {
    /**
     * \brief Create Inventory HTML Table of \c Hop
     */
-   QString createInventoryTableHop() {
+   QString createInventoryTableHop(InventoryFormatter::Snapshot const & inventory) {
       QString result;
 
-      auto inventory = ObjectStoreWrapper::findAllMatching<Hop>(
-         [](std::shared_ptr<Hop> hh) { return (hh->getParent() == nullptr && hh->inventory() > 0.0); }
-      );
-      if (!inventory.empty()) {
+      if (!inventory.hops.empty()) {
 
          result += QString("<h2>%1</h2>").arg(QObject::tr("Hops"));
          result += "<table id=\"hops\">";
@@ -104,16 +124,17 @@ namespace {
                         .arg(QObject::tr("Alpha %"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto hop : inventory) {
+         for (auto const & hop : inventory.hops) {
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "<td>%3</td>"
                               "</tr>")
-                           .arg(hop->name())
-                           .arg(hop->alpha_pct())
-                           .arg(Measurement::displayAmount(Measurement::Amount{hop->inventory(),
-                                                                               Measurement::Units::kilograms}));
+                           .arg(hop.name)
+                           .arg(hop.alpha_pct)
+                           .arg(inventory.displayUnitSystems.displayAmount(
+                              Measurement::Amount{hop.amount, Measurement::Units::kilograms}
+                           ));
          }
          result += "</table>";
       }
@@ -123,13 +144,10 @@ namespace {
    /**
     * \brief Create Inventory HTML Table of \c Misc
     */
-   QString createInventoryTableMiscellaneous() {
+   QString createInventoryTableMiscellaneous(InventoryFormatter::Snapshot const & inventory) {
       QString result;
 
-      auto inventory = ObjectStoreWrapper::findAllMatching<Misc>(
-         [](std::shared_ptr<Misc> mm) { return (mm->getParent() == nullptr && mm->inventory() > 0.0); }
-      );
-      if (!inventory.empty()) {
+      if (!inventory.miscs.empty()) {
 
          result += QString("<h2>%1</h2>").arg(QObject::tr("Miscellaneous"));
          result += "<table id=\"misc\">";
@@ -140,18 +158,18 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto miscellaneous : inventory) {
-            QString const displayAmount = Measurement::displayAmount(
+         for (auto const & miscellaneous : inventory.miscs) {
+            QString const displayAmount = inventory.displayUnitSystems.displayAmount(
                Measurement::Amount{
-                  miscellaneous->inventory(),
-                  miscellaneous->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
+                  miscellaneous.amount,
+                  miscellaneous.amountIsWeight ? Measurement::Units::kilograms : Measurement::Units::liters
                }
             );
             result += QString("<tr>"
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(miscellaneous->name())
+                           .arg(miscellaneous.name)
                            .arg(displayAmount);
          }
          result += "</table>";
@@ -162,12 +180,9 @@ namespace {
    /**
     * \brief Create Inventory HTML Table of \c Yeast
     */
-   QString createInventoryTableYeast() {
+   QString createInventoryTableYeast(InventoryFormatter::Snapshot const & inventory) {
       QString result;
-      auto inventory = ObjectStoreWrapper::findAllMatching<Yeast>(
-         [](std::shared_ptr<Yeast> yy) { return (yy->getParent() == nullptr && yy->inventory() > 0.0); }
-      );
-      if (!inventory.empty()) {
+      if (!inventory.yeasts.empty()) {
          result += QString("<h2>%1</h2>").arg(QObject::tr("Yeast"));
          result += "<table id=\"yeast\">";
          result += QString("<tr>"
@@ -177,11 +192,11 @@ namespace {
                         .arg(QObject::tr("Name"))
                         .arg(QObject::tr("Amount"));
 
-         for (auto yeast : inventory) {
-            QString const displayAmount = Measurement::displayAmount(
+         for (auto const & yeast : inventory.yeasts) {
+            QString const displayAmount = inventory.displayUnitSystems.displayAmount(
                Measurement::Amount{
-                  yeast->inventory(),
-                  yeast->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
+                  yeast.amount,
+                  yeast.amountIsWeight ? Measurement::Units::kilograms : Measurement::Units::liters
                }
             );
 
@@ -189,7 +204,7 @@ namespace {
                               "<td>%1</td>"
                               "<td>%2</td>"
                               "</tr>")
-                           .arg(yeast->name())
+                           .arg(yeast.name)
                            .arg(displayAmount);
          }
          result += "</table>";
@@ -201,13 +216,14 @@ namespace {
    /**
     * Create Inventory HTML Body
     */
-   QString createInventoryBody(InventoryFormatter::HtmlGenerationFlags flags) {
+   QString createInventoryBody(InventoryFormatter::Snapshot const & inventory) {
       // Only generate users selection of Ingredient inventory.
+      auto const flags = inventory.flags;
       QString result =
-         ((InventoryFormatter::FERMENTABLES  & flags) ? createInventoryTableFermentable() : "") +
-         ((InventoryFormatter::HOPS          & flags) ? createInventoryTableHop() : "") +
-         ((InventoryFormatter::MISCELLANEOUS & flags) ? createInventoryTableMiscellaneous() : "") +
-         ((InventoryFormatter::YEAST         & flags) ? createInventoryTableYeast() : "");
+         ((InventoryFormatter::FERMENTABLES  & flags) ? createInventoryTableFermentable(inventory) : "") +
+         ((InventoryFormatter::HOPS          & flags) ? createInventoryTableHop(inventory) : "") +
+         ((InventoryFormatter::MISCELLANEOUS & flags) ? createInventoryTableMiscellaneous(inventory) : "") +
+         ((InventoryFormatter::YEAST         & flags) ? createInventoryTableYeast(inventory) : "");
 
       // If user selects no printout or if there are no inventory for the selected ingredients
       if (result.size() == 0) {
@@ -236,8 +252,24 @@ bool InventoryFormatter::operator&(InventoryFormatter::HtmlGenerationFlags a,
    return (static_cast<int>(a) & static_cast<int>(b));
 }
 
-QString InventoryFormatter::createInventoryHtml(HtmlGenerationFlags flags) {
-   return createInventoryHeader() +
-          createInventoryBody(flags) +
+InventoryFormatter::Snapshot InventoryFormatter::snapshot(HtmlGenerationFlags flags) {
+   Snapshot inventory;
+   inventory.flags = flags;
+   // Only look in the object stores for the things we are going to print
+   if (FERMENTABLES  & flags) { inventory.fermentables = inventoryItems<Fermentable>(); }
+   if (HOPS          & flags) { inventory.hops         = inventoryItems<Hop        >(); }
+   if (MISCELLANEOUS & flags) { inventory.miscs        = inventoryItems<Misc       >(); }
+   if (YEAST         & flags) { inventory.yeasts       = inventoryItems<Yeast      >(); }
+   inventory.date = Localization::displayDateUserFormated(QDate::currentDate());
+   return inventory;
+}
+
+QString InventoryFormatter::createInventoryHtml(Snapshot const & inventory) {
+   return createInventoryHeader(inventory) +
+          createInventoryBody(inventory) +
           createInventoryFooter();
 }
+
+QString InventoryFormatter::createInventoryHtml(HtmlGenerationFlags flags) {
+   return InventoryFormatter::createInventoryHtml(InventoryFormatter::snapshot(flags));
+}
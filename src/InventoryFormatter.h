@@ -22,7 +22,10 @@
 #define INVENTORY_FORMATTER_H
 #pragma once
 
-class QString;
+#include <QString>
+#include <QVector>
+
+#include "measurement/Measurement.h"
 
 namespace InventoryFormatter {
    enum HtmlGenerationFlags {
@@ -53,7 +56,43 @@ namespace InventoryFormatter {
    bool operator&(HtmlGenerationFlags a, HtmlGenerationFlags b);
 
    /**
-    * @brief Create a Inventory HTML for export
+    * \brief The inventory to print, copied out of the object stores so that it can be formatted on any thread.
+    */
+   struct Snapshot {
+      struct Item {
+         QString name;
+         double  amount;
+         bool    amountIsWeight;
+         //! Only meaningful for hops
+         double  alpha_pct;
+      };
+
+      HtmlGenerationFlags flags;
+      //! Only the ingredient types selected by \c flags are filled in
+      QVector<Item> fermentables;
+      QVector<Item> hops;
+      QVector<Item> miscs;
+      QVector<Item> yeasts;
+      //! Already formatted for display
+      QString date;
+      Measurement::DisplayUnitSystems displayUnitSystems;
+   };
+
+   /**
+    * \brief Take a \c Snapshot of the inventory.  This reads the object stores and settings, so must be called on the
+    *        GUI thread.
+    */
+   Snapshot snapshot(HtmlGenerationFlags flags);
+
+   /**
+    * @brief Create a Inventory HTML for export.  Safe to call on any thread.
+    *
+    * @return QString containing the HTML code for the inventory tables.
+    */
+   QString createInventoryHtml(Snapshot const & inventory);
+
+   /**
+    * @brief Create a Inventory HTML for export.  Must be called on the GUI thread.
     *
     * @return QString containing the HTML code for the inventory tables.
     */
@@ -31,6 +31,7 @@
 #include <QTranslator>
 
 #include "Application.h"
+#include "measurement/AmountParser.h"
 #include "model/NamedEntity.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
@@ -153,13 +154,7 @@ QString const & Localization::getSystemLanguage() {
 }
 
 bool Localization::hasUnits(QString qstr) {
-   QString decimal = QRegExp::escape(Localization::getLocale().decimalPoint());
-   QString grouping = QRegExp::escape(Localization::getLocale().groupSeparator());
-
-   QRegExp amtUnit("((?:\\d+" + grouping + ")?\\d+(?:" + decimal + "\\d+)?|" + decimal + "\\d+)\\s*(\\w+)?");
-   amtUnit.indexIn(qstr);
-
-   bool result = amtUnit.cap(2).size() > 0;
+   bool result = Measurement::AmountParser::getInstance().parse(qstr).hasUnit();
 
    qDebug() << Q_FUNC_INFO << qstr << (result ? "has" : "does not have") << "units";
 
@@ -20,6 +20,10 @@
  */
 #include "Logging.h"
 
+#include <atomic>
+#include <cstring>      // For std::strcmp and std::strncmp
+#include <memory>
+#include <optional>
 #include <sstream>      // For std::ostringstream
 
 #include <boost/stacktrace.hpp>
@@ -33,6 +37,7 @@
 #include <QTextStream>
 #include <QThread>
 #include <QTime>
+#include <QWaitCondition>
 
 #include "PersistentSettings.h"
 
@@ -48,7 +53,8 @@
 //
 namespace {
 
-   Logging::Level currentLoggingLevel = Logging::LogLevel_INFO;
+   // Read by every thread that logs, so atomic
+   std::atomic<Logging::Level> currentLoggingLevel{Logging::LogLevel_INFO};
 
    // We decompose the log filename into its body and suffix for log rotation
    // The _current_ log file is always "brewtarget.log"
@@ -61,9 +67,15 @@ namespace {
    // Time format to use in log messages
    QString const timeFormat{"hh:mm:ss.zzz"};
 
+   // NB: logFile, stream and bytesInLogFile are only changed with both consumerMutex and mutex held, so any code that
+   //     holds either one can safely read them.
    QFile logFile;
    QMutex mutex;
 
+   // How many bytes are in the current log file (counting what is still buffered in the stream), so we don't have to ask
+   // the file system on every message
+   qint64 bytesInLogFile{0};
+
    // This global flag controls whether, in general, we are logging to stderr or not.  Usually it's turned off for at
    // least the part of automated testing where we're generating lots of test logging.
    bool isLoggingToStderr{true};
@@ -122,21 +134,195 @@ namespace {
       }
    }
 
+   /**
+    * \brief Everything we need to write one log message.  We capture this on the thread that did the logging, but we
+    *        defer turning it into text until it is written out.
+    */
+   struct PendingLogEntry {
+      QTime          time;
+      QString        threadId;
+      Logging::Level level;
+      QString        message;
+      //! Path of the source file, from QMessageLogContext.  This is either null or a string literal (__FILE__).
+      char const *   file;
+      int            line;
+      bool           toStderr;
+   };
+
+   //
+   // This is what actually turns a message into a line of text for the log file and/or std::cerr
+   //
+   QString formatEntry(PendingLogEntry const & entry) {
+      //
+      // We don't want to log the full path of the source file, because that might contain private info about the
+      // directory structure on the machine on which the build was done.  We could just show the filename with:
+      //    QString sourceFile = QFileInfo(entry.file).fileName();
+      // But we'd like to show the relative path under the src directory (eg database/Database.cpp rather than just
+      // Database.cpp).  (The code here assumes there will not be any subdirectory of src that is also called src,
+      // which seems pretty reasonable.)
+      //
+      QString const sourceFile = QString{entry.file}.split("/src/").last();
+      // NB: Using the multi-argument version of QString::arg means we only scan the format string once, and that
+      //     anything that looks like a placeholder inside the message itself is left alone.
+      return QString{"[%1] (%2) %3 : %4  [%5:%6]"}.arg(entry.time.toString(timeFormat),
+                                                       entry.threadId,
+                                                       Logging::getStringFromLogLevel(entry.level),
+                                                       entry.message,
+                                                       sourceFile,
+                                                       QString::number(entry.line));
+   }
+
+   /**
+    * \brief How many bytes \c text takes up in UTF-8, which is what we write the log file in.  This saves us encoding
+    *        every message twice just to find out its size.
+    */
+   qint64 utf8Length(QString const & text) {
+      qint64 length = 0;
+      for (QChar const character : text) {
+         ushort const code = character.unicode();
+         if (code < 0x80) {
+            length += 1;
+         } else if (code < 0x800 || character.isSurrogate()) {
+            // NB: A surrogate pair is one character that takes 4 bytes, ie 2 for each half
+            length += 2;
+         } else {
+            length += 3;
+         }
+      }
+      return length;
+   }
+
    //
-   // This is what actually outputs a message to the log file and/or std::cerr
+   // This is what actually outputs a message to the log file and/or std::cerr.  Caller is responsible for flushing.
    //
-   void doLog(const Logging::Level level, const QString message) {
-      QString logEntry = QString{"[%1] (%2) %3 : %4"}.arg(QTime::currentTime().toString(timeFormat))
-                                                     .arg(threadId)
-                                                     .arg(Logging::getStringFromLogLevel(level))
-                                                     .arg(message);
+   void writeEntry(PendingLogEntry const & entry) {
+      QString const logEntry = formatEntry(entry);
       QMutexLocker locker(&mutex);
-      if (isLoggingToStderr ||
-          forceStderrLogging) { errStream << logEntry << END_OF_LINE; }
-      if (stream)             {   *stream << logEntry << END_OF_LINE; }
+      if (entry.toStderr) { errStream << logEntry << '\n'; }
+      if (stream) {
+         *stream << logEntry << '\n';
+         bytesInLogFile += utf8Length(logEntry) + 1;
+      }
+      return;
+   }
+
+   void flushStreams() {
+      QMutexLocker locker(&mutex);
+      errStream.flush();
+      if (stream) { stream->flush(); }
       return;
    }
 
+   /**
+    * \brief Fixed-size multi-producer ring buffer of log entries waiting to be written out.
+    *
+    *        Any thread can push without taking a lock (so logging from a hot path never waits on a mutex or on disk
+    *        I/O).  This is the well-known bounded queue design of Dmitry Vyukov
+    *        (https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue): each cell carries a
+    *        sequence number that tells a producer whether the cell is free for position N and tells the consumer
+    *        whether it has been filled for position N.
+    *
+    *        Popping is only safe from one thread at a time -- see \c consumerMutex.
+    */
+   class LogRingBuffer {
+   public:
+      LogRingBuffer() : cells{std::make_unique<Cell[]>(capacity)}, enqueuePosition{0}, dequeuePosition{0} {
+         for (std::size_t ii = 0; ii < capacity; ++ii) {
+            this->cells[ii].sequence.store(ii, std::memory_order_relaxed);
+         }
+         return;
+      }
+
+      /**
+       * \brief Add an entry to the buffer
+       *
+       * \return \c false if the buffer is full, in which case \c entry is untouched
+       */
+      bool push(PendingLogEntry && entry) {
+         std::size_t position = this->enqueuePosition.load(std::memory_order_relaxed);
+         for (;;) {
+            Cell & cell = this->cells[position & mask];
+            std::size_t const sequence = cell.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (0 == difference) {
+               // The cell is free.  Try to claim it.  (If we fail, compare_exchange_weak updates position for us.)
+               if (this->enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                  cell.entry = std::move(entry);
+                  cell.sequence.store(position + 1, std::memory_order_release);
+                  return true;
+               }
+            } else if (difference < 0) {
+               // The consumer hasn't yet emptied the cell from the last time round
+               return false;
+            } else {
+               // Another producer got here first
+               position = this->enqueuePosition.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+      /**
+       * \brief Remove the oldest entry from the buffer.  Caller must hold \c consumerMutex.
+       */
+      std::optional<PendingLogEntry> pop() {
+         std::size_t const position = this->dequeuePosition.load(std::memory_order_relaxed);
+         Cell & cell = this->cells[position & mask];
+         std::size_t const sequence = cell.sequence.load(std::memory_order_acquire);
+         if (sequence != position + 1) {
+            // Nothing (finished being) written here yet
+            return std::nullopt;
+         }
+         std::optional<PendingLogEntry> entry{std::move(cell.entry)};
+         this->dequeuePosition.store(position + 1, std::memory_order_relaxed);
+         cell.sequence.store(position + capacity, std::memory_order_release);
+         return entry;
+      }
+
+   private:
+      // Must be a power of two
+      static constexpr std::size_t capacity = 8192;
+      static constexpr std::size_t mask = capacity - 1;
+
+      struct Cell {
+         std::atomic<std::size_t> sequence;
+         PendingLogEntry entry;
+      };
+
+      std::unique_ptr<Cell[]> cells;
+      std::atomic<std::size_t> enqueuePosition;
+      std::atomic<std::size_t> dequeuePosition;
+   };
+
+   LogRingBuffer pendingEntries;
+
+   // Held by whichever thread is taking entries out of pendingEntries (normally logWriterThread)
+   QMutex consumerMutex;
+
+   // Set to true when logWriterThread is running and should be sent messages
+   std::atomic<bool> asyncLoggingActive{false};
+
+   // True while the current thread holds consumerMutex (which is normally only the case for logWriterThread, inside
+   // drainPendingEntries())
+   thread_local bool isDrainingPendingEntries{false};
+
+   /**
+    * \brief RAII holder of \c consumerMutex.  Whilst it is held, anything this thread logs is written synchronously
+    *        (see \c logMessageHandler), as trying to queue it could deadlock.
+    */
+   class ConsumerLock {
+   public:
+      ConsumerLock() : locker{&consumerMutex} {
+         isDrainingPendingEntries = true;
+         return;
+      }
+      ~ConsumerLock() {
+         isDrainingPendingEntries = false;
+         return;
+      }
+   private:
+      QMutexLocker locker;
+   };
+
    /**
     * \brief Generates a log file name
     */
@@ -183,34 +369,54 @@ namespace {
       return dir.rename(logFileFullName(), newlogFilename);
    }
 
+   /**
+    * \brief Open \c logFile, and \c stream on it, if we can.  Caller must hold \c consumerMutex but not \c mutex.
+    *
+    *        NB: We hold \c mutex while we change \c logFile and \c stream, so we must not use Qt logging then (as we
+    *        would end up trying to acquire the same mutex in writeEntry()).  Any errors at those points need to go to
+    *        stderr.
+    */
+   bool tryOpenLogFile(QString const & fileName, QIODevice::OpenMode const openMode) {
+      QMutexLocker locker(&mutex);
+      logFile.setFileName(fileName);
+      if (!logFile.open(openMode)) {
+         return false;
+      }
+      bytesInLogFile = logFile.size();
+      stream = new QTextStream(&logFile);
+      stream->setCodec("UTF-8");
+      return true;
+   }
+
    /**
     * \brief initializes the log file and opens the stream for writing.
     *        This was moved to its own function as this has to be called every time logs are being pruned.
+    *
+    *        Caller must hold \c consumerMutex (eg via \c ConsumerLock).
     */
    bool openLogFile() {
       // We _really_ need to see problems with opening the log file on stderr!
       TemporarilyForceStderrLogging temporarilyForceStderrLogging;
 
-      // First check if it's time to rotate the log file
-      if (logFile.size() > Logging::logFileSize) {
-         // Acquire lock due to the file mangling below.  NB: This means we do not want to use Qt logging in this
-         // block, as we'd end up attempting to acquire the same mutex in the doLog() function above!  So, any errors
-         // between here and the closing brace need to go to stderr
+      {
+         // See comment in tryOpenLogFile() about not using Qt logging in this block
          QMutexLocker locker(&mutex);
          // Double check that the stream is not initiated, if so, kill it.
          closeLogFile();
-         if (!renameLogFileWithTimestamp(logDirectory)) {
-            errStream <<
-               "Could not rename the log file " << logFileFullName() << " in directory " <<
-               logDirectory.canonicalPath() << END_OF_LINE;
+
+         // Check if it's time to rotate the log file
+         if (logFile.size() > Logging::logFileSize) {
+            if (!renameLogFileWithTimestamp(logDirectory)) {
+               errStream <<
+                  "Could not rename the log file " << logFileFullName() << " in directory " <<
+                  logDirectory.canonicalPath() << END_OF_LINE;
+            }
          }
       }
 
       // Recreate/reopen the log file
       // Test default location
-      logFile.setFileName(logDirectory.filePath(logFileFullName()));
-      if (logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
-         stream = new QTextStream(&logFile);
+      if (tryOpenLogFile(logDirectory.filePath(logFileFullName()), QIODevice::WriteOnly | QIODevice::Append)) {
          qInfo() << Q_FUNC_INFO << "Logging to file" << QFileInfo(logFile).canonicalFilePath();
          return true;
       }
@@ -220,10 +426,8 @@ namespace {
          "for writing.  Will try using temporary directory";
 
       // Defaults to temporary
-      logFile.setFileName(QDir::temp().filePath(logFileFullName()));
-      if (logFile.open(QFile::WriteOnly | QFile::Truncate)) {
+      if (tryOpenLogFile(QDir::temp().filePath(logFileFullName()), QFile::WriteOnly | QFile::Truncate)) {
          logFile.setPermissions(QFileDevice::WriteUser | QFileDevice::ReadUser | QFileDevice::ExeUser);
-         stream = new QTextStream(&logFile);
          qWarning() <<
             Q_FUNC_INFO << "Log file is in a temporary directory: " << QFileInfo(logFile).canonicalFilePath();
          return true;
@@ -261,34 +465,173 @@ namespace {
       return;
    }
 
+   /**
+    * \brief Whether the current log file is big enough to rotate.  (If there is no log file, eg because its location is
+    *        not yet loaded from the settings, then we are only logging to stderr, and it isn't.)
+    */
+   bool logFileIsFull() {
+      // NB: writeEntry() can be called without consumerMutex (eg for fatal errors), so we need mutex to read this
+      QMutexLocker locker(&mutex);
+      return stream && bytesInLogFile >= Logging::logFileSize;
+   }
+
+   /**
+    * \brief Write out everything in \c pendingEntries, rotating the log file as needed
+    *
+    *        NB: Rotating the log file generates log messages of its own.  These are written synchronously (see
+    *        \c logMessageHandler) so they don't end up back in the buffer we are trying to empty.
+    */
+   void drainPendingEntries() {
+      ConsumerLock consumerLock;
+      bool wroteSomething = false;
+      while (auto entry = pendingEntries.pop()) {
+         writeEntry(*entry);
+         wroteSomething = true;
+
+         // Check whether it's time to prune the old logs and start a new log file
+         if (logFileIsFull()) {
+            pruneLogFiles();
+            openLogFile();
+         }
+      }
+      if (wroteSomething) {
+         flushStreams();
+      }
+      return;
+   }
+
+   /**
+    * \brief Background thread that takes log messages out of \c pendingEntries and writes them to the log file and/or
+    *        stderr.  This keeps formatting, disk I/O and log rotation off whatever thread did the logging.
+    *
+    *        We don't need any signals or slots, or an event loop, so this is just a plain QThread subclass.
+    */
+   class LogWriterThread : public QThread {
+   public:
+      LogWriterThread() : QThread{}, stopRequested{false}, isIdle{false}, wakeMutex{}, wakeCondition{} {
+         return;
+      }
+
+      virtual ~LogWriterThread() = default;
+
+      /**
+       * \brief Called by producers after adding to \c pendingEntries.  We only bother the wait condition if the writer
+       *        is (or is about to be) asleep.
+       */
+      void wake() {
+         if (this->isIdle.load(std::memory_order_relaxed)) {
+            this->wakeCondition.wakeOne();
+         }
+         return;
+      }
+
+      void requestStop() {
+         this->stopRequested.store(true, std::memory_order_release);
+         this->wakeCondition.wakeOne();
+         return;
+      }
+
+   protected:
+      virtual void run() override {
+         this->stopRequested.store(false, std::memory_order_release);
+         while (!this->stopRequested.load(std::memory_order_acquire)) {
+            drainPendingEntries();
+            //
+            // A producer can add something just after we finished draining but before we go to sleep, and its wake()
+            // will be lost.  Rather than make producers take a lock to prevent this, we just don't sleep for long.
+            //
+            QMutexLocker locker(&this->wakeMutex);
+            this->isIdle.store(true, std::memory_order_relaxed);
+            this->wakeCondition.wait(&this->wakeMutex, maxIdleTime_ms);
+            this->isIdle.store(false, std::memory_order_relaxed);
+         }
+         // Don't leave anything behind
+         drainPendingEntries();
+         return;
+      }
+
+   private:
+      static constexpr unsigned long maxIdleTime_ms = 50;
+
+      std::atomic<bool> stopRequested;
+      std::atomic<bool> isIdle;
+      QMutex            wakeMutex;
+      QWaitCondition    wakeCondition;
+   };
+
+   //
+   // Created on first call to Logging::initializeLogging() and, for simplicity, never deleted.  (Other threads might
+   // still be holding a pointer to it when logging is terminated.)
+   //
+   LogWriterThread * logWriterThread = nullptr;
+
+   //
+   // Logging levels apply to our own logging categories (see Logging.h) and to Qt's "default" category (used by plain
+   // qDebug(), qInfo(), etc).  Setting the levels on the category means that, for disabled levels, qCDebug() etc skip
+   // building the message entirely, and qDebug() etc are discarded inside Qt before our message handler is called.
+   //
+   char const categoryPrefix[] = "brewtarget.";
+   QLoggingCategory::CategoryFilter previousCategoryFilter = nullptr;
+
+   // NB: Qt calls this with its category registry locked, so we mustn't log from in here
+   void categoryFilter(QLoggingCategory * category) {
+      //
+      // Let Qt (or whoever else) configure the category first.  This leaves other categories (eg qt.*) alone and means
+      // rules set via QT_LOGGING_RULES etc can still switch off things that our logging level would allow.
+      //
+      bool const havePreviousFilter = (nullptr != previousCategoryFilter);
+      if (havePreviousFilter) {
+         previousCategoryFilter(category);
+      }
+
+      char const * const categoryName = category->categoryName();
+      if (0 == std::strcmp(categoryName, "default") ||
+          0 == std::strncmp(categoryName, categoryPrefix, sizeof(categoryPrefix) - 1)) {
+         auto gate = [category, havePreviousFilter](QtMsgType const msgType, Logging::Level const level) {
+            category->setEnabled(
+               msgType,
+               (!havePreviousFilter || category->isEnabled(msgType)) &&
+               currentLoggingLevel.load(std::memory_order_relaxed) <= level
+            );
+         };
+         gate(QtDebugMsg,   Logging::LogLevel_DEBUG);
+         gate(QtInfoMsg,    Logging::LogLevel_INFO);
+         gate(QtWarningMsg, Logging::LogLevel_WARNING);
+      }
+      return;
+   }
+
+   /**
+    * \brief (Re)apply \c currentLoggingLevel to all logging categories.  Qt runs the filter over every existing category
+    *        when it is installed, so we just (re)install it.
+    */
+   void applyLogLevelToCategories() {
+      QLoggingCategory::CategoryFilter const oldFilter = QLoggingCategory::installFilter(categoryFilter);
+      if (oldFilter != categoryFilter) {
+         previousCategoryFilter = oldFilter;
+      }
+      return;
+   }
+
    /**
     * \brief Handles all log messages, which should be logged using the standard Qt functions, eg:
     *        qDebug() << "message" << some_variable; //for a debug message!
+    *        or, for messages in one of our own logging categories:
+    *        qCDebug(Logging::database) << "message" << some_variable;
+    *
+    *        Normally we just capture the message and put it in the queue for the writer thread.  We write synchronously
+    *        if the writer thread isn't running, if we are in the middle of emptying the queue (eg the writer thread
+    *        logging about log rotation), or if the message is fatal (in which case the program is about to abort and we
+    *        need to get everything out first).
     */
    void logMessageHandler(QtMsgType qtMsgType, QMessageLogContext const & context, QString const & message) {
       Logging::Level logLevelOfMessage = levelFromQtMsgType(qtMsgType);
-      //
-      // First things first!  What logging level has the user chosen.
-      // then, if the file-stream is open and the log file size is to big, we need to prune the old logs and initiate a new logfile.
-      // after that we're all set, Log away!
-      //
 
       // Check that we're set to log this level, this is set by the user options.
-      if (logLevelOfMessage < currentLoggingLevel) {
+      if (logLevelOfMessage < currentLoggingLevel.load(std::memory_order_relaxed)) {
          return;
       }
 
-      // Check if there is a file actually set yet.  In a rare case if the logfile was not created at initialization,
-      // then we won't be logging to a file, the location may not yet have been loaded from the settings, thus only logging to the stderr.
-      // In this case we cannot do any of the pruning or filename generation.
-      if (stream) {
-         if (logFile.size() >= Logging::logFileSize) {
-            pruneLogFiles();
-            openLogFile();
-         }
-      }
-
-      // Writing the actual log
       //
       // QMessageLogContext members are a bit hard to find in Qt documentation so noted here:
       //    category : const char *
@@ -297,20 +640,45 @@ namespace {
       //    line : int
       //    version : int
       //
-      // We don't want to log the full path of the source file, because that might contain private info about the
-      // directory structure on the machine on which the build was done.  We could just show the filename with:
-      //    QString sourceFile = QFileInfo(context.file).fileName();
-      // But we'd like to show the relative path under the src directory (eg database/Database.cpp rather than just
-      // Database.cpp).  (The code here assumes there will not be any subdirectory of src that is also called src,
-      // which seems pretty reasonable.)
-      QString sourceFile = QString{context.file}.split("/src/").last();
-      doLog(logLevelOfMessage, QString("%1  [%2:%3]").arg(message).arg(sourceFile).arg(context.line));
+      PendingLogEntry entry{QTime::currentTime(),
+                            threadId,
+                            logLevelOfMessage,
+                            message,
+                            context.file,
+                            context.line,
+                            isLoggingToStderr || forceStderrLogging};
+
+      if (!isDrainingPendingEntries && asyncLoggingActive.load(std::memory_order_acquire) && qtMsgType != QtFatalMsg) {
+         while (!pendingEntries.push(std::move(entry))) {
+            // Buffer is full, so give the writer a chance to catch up
+            logWriterThread->wake();
+            QThread::yieldCurrentThread();
+         }
+         logWriterThread->wake();
+         return;
+      }
+
+      // Make sure anything queued before this message is written before it (unless we're already in the middle of doing
+      // that).
+      if (!isDrainingPendingEntries) {
+         drainPendingEntries();
+      }
+      writeEntry(entry);
+      flushStreams();
       return;
    }
 
 }
 
 
+namespace Logging {
+   Q_LOGGING_CATEGORY(database,    "brewtarget.database")
+   Q_LOGGING_CATEGORY(measurement, "brewtarget.measurement")
+   Q_LOGGING_CATEGORY(objectStore, "brewtarget.objectstore")
+   Q_LOGGING_CATEGORY(recipe,      "brewtarget.recipe")
+   Q_LOGGING_CATEGORY(xml,         "brewtarget.xml")
+}
+
 QVector<Logging::LevelDetail> const Logging::levelDetails{
    { Logging::LogLevel_DEBUG,   "DEBUG",   QObject::tr("Detailed (for debugging)")},
    { Logging::LogLevel_INFO,    "INFO",    QObject::tr("Normal")},
@@ -339,12 +707,15 @@ Logging::Level Logging::getLogLevelFromString(QString const name) {
 }
 
 Logging::Level Logging::getLogLevel() {
-   return currentLoggingLevel;
+   return currentLoggingLevel.load(std::memory_order_relaxed);
 }
 
-void Logging::setLogLevel(Level newLevel) {
-   currentLoggingLevel = newLevel;
-   PersistentSettings::insert(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(currentLoggingLevel));
+void Logging::setLogLevel(Level newLevel, bool const persist) {
+   currentLoggingLevel.store(newLevel, std::memory_order_relaxed);
+   applyLogLevelToCategories();
+   if (persist) {
+      PersistentSettings::insert(PersistentSettings::Names::LoggingLevel, Logging::getStringFromLogLevel(newLevel));
+   }
    return;
 }
 
@@ -366,13 +737,31 @@ bool Logging::initializeLogging() {
    // We _really_ need to see problems with opening the log file on stderr!
    TemporarilyForceStderrLogging temporarilyForceStderrLogging;
 
-   currentLoggingLevel = Logging::getLogLevelFromString(PersistentSettings::value(PersistentSettings::Names::LoggingLevel, "INFO").toString());
+   currentLoggingLevel.store(
+      Logging::getLogLevelFromString(
+         PersistentSettings::value(PersistentSettings::Names::LoggingLevel, "INFO").toString()
+      ),
+      std::memory_order_relaxed
+   );
    Logging::setDirectory(
       PersistentSettings::contains(PersistentSettings::Names::LogDirectory) ?
          std::optional<QDir>(PersistentSettings::value(PersistentSettings::Names::LogDirectory).toString()) : std::optional<QDir>(std::nullopt)
    );
 
+   applyLogLevelToCategories();
    qInstallMessageHandler(logMessageHandler);
+
+   // Now we can start writing log messages in the background
+   if (!logWriterThread) {
+      logWriterThread = new LogWriterThread;
+      logWriterThread->setObjectName("LogWriter");
+      // Make sure we get everything written out when the application exits, even if no-one calls terminateLogging()
+      qAddPostRoutine(Logging::terminateLogging);
+   }
+   if (!logWriterThread->isRunning()) {
+      logWriterThread->start(QThread::LowPriority);
+   }
+   asyncLoggingActive.store(true, std::memory_order_release);
    qDebug() << Q_FUNC_INFO << "Logging initialized.  Logs will be written to" << logDirectory.canonicalPath();
 
    // It's quite useful on debug builds to check that stack trace logging is working, rather than to find out it's not
@@ -393,6 +782,12 @@ void Logging::setLoggingToStderr(bool const enabled) {
 bool Logging::setDirectory(std::optional<QDir> newDirectory, Logging::PersistNewDirectory const persistNewDirectory) {
    qDebug() << Q_FUNC_INFO;
 
+   //
+   // Stop the writer thread from touching the log file or logDirectory until we're done.  Anything we log in the
+   // meantime gets written synchronously.
+   //
+   ConsumerLock consumerLock;
+
    QDir oldDirectory = logDirectory;
 
    // Supplying no directory in the parameter means use the default location, ie the config directory
@@ -513,7 +908,22 @@ QFileInfoList Logging::getLogFileList() {
 }
 
 
+void Logging::flush() {
+   drainPendingEntries();
+   return;
+}
+
 void Logging::terminateLogging() {
+   // From here on, messages get written synchronously
+   asyncLoggingActive.store(false, std::memory_order_release);
+   if (logWriterThread && logWriterThread->isRunning()) {
+      logWriterThread->requestStop();
+      logWriterThread->wait();
+   }
+   // Catch anything that was queued after the writer finished
+   drainPendingEntries();
+
+   ConsumerLock consumerLock;
    QMutexLocker locker(&mutex);
    closeLogFile();
    return;
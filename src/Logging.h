@@ -26,6 +26,7 @@
 
 #include <QDir>
 #include <QFileInfoList>
+#include <QLoggingCategory>
 #include <QString>
 #include <QVector>
 
@@ -33,6 +34,21 @@
  * \brief Provides a proxy to an OS agnostic log file.
  */
 namespace Logging {
+   /**
+    * \brief Logging categories for code that logs a lot in hot paths.  Use these with qCDebug(), qCInfo() etc, eg:
+    *           qCDebug(Logging::database) << Q_FUNC_INFO << "Returning connection" << connectionName;
+    *        When the category is disabled for the given level (which we do according to the current logging level), the
+    *        message is not even built, so there is essentially no cost to leaving such logging in place.
+    *
+    *        Categories are named "brewtarget.xxx".  As well as following our logging level, they can be further restricted
+    *        with the usual Qt mechanisms (eg QT_LOGGING_RULES="brewtarget.xml.debug=false").
+    */
+   Q_DECLARE_LOGGING_CATEGORY(database)
+   Q_DECLARE_LOGGING_CATEGORY(measurement)
+   Q_DECLARE_LOGGING_CATEGORY(objectStore)
+   Q_DECLARE_LOGGING_CATEGORY(recipe)
+   Q_DECLARE_LOGGING_CATEGORY(xml)
+
    /**
     * \brief Defines the importance of an individual message and used to controls what type of messages to log
     *
@@ -86,8 +102,12 @@ namespace Logging {
 
    /**
     * \brief Set logging level
+    *
+    * \param newLevel
+    * \param persist If \c true (the default), \c newLevel is also stored in \c PersistentSettings so it applies next
+    *                time the program runs.  Pass \c false to change the level temporarily (eg in tests).
     */
-   extern void setLogLevel(Level newLevel);
+   extern void setLogLevel(Level newLevel, bool const persist = true);
 
    /**
     * \return \b true if we are logging in the config dir (the default), \b false if we are logging in a directory
@@ -161,7 +181,13 @@ namespace Logging {
    extern QFileInfoList getLogFileList();
 
    /**
-    * \brief Terminate logging
+    * \brief Log messages are normally written to the log file (and stderr) by a background thread.  This function
+    *        writes out any that are still waiting, on the calling thread, before returning.
+    */
+   extern void flush();
+
+   /**
+    * \brief Terminate logging.  Any messages logged after this are written synchronously (and only to stderr).
     */
    extern void terminateLogging();
 
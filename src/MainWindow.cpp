@@ -33,6 +33,7 @@
 #endif
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <mutex> // For std::once_flag etc
 
@@ -55,6 +56,7 @@
 #include <QString>
 #include <QTextStream>
 #include <QtGui>
+#include <QTimer>
 #include <QToolButton>
 #include <QUrl>
 #include <QVBoxLayout>
@@ -85,6 +87,7 @@
 #include "HopSortFilterProxyModel.h"
 #include "Html.h"
 #include "HydrometerTool.h"
+#include "InstrumentationDialog.h"
 #include "InventoryFormatter.h"
 #include "MashDesigner.h"
 #include "MashEditor.h"
@@ -209,21 +212,237 @@ namespace {
 
       return;
    }
+
+   /**
+    * \brief Rarely-used dialogs are not created until the first time they are needed, to save time at start-up.  This
+    *        creates \c dialog (with \c parent as its parent) if it does not already exist.  If the dialog is created,
+    *        \c onCreate (if supplied) is then called with it, eg to make any signal connections it needs.
+    */
+   template<class DialogType>
+   DialogType * lazyDialog(DialogType * & dialog,
+                           MainWindow * parent,
+                           std::function<void(DialogType &)> onCreate = nullptr) {
+      if (!dialog) {
+         qDebug() << Q_FUNC_INFO << "Creating" << DialogType::staticMetaObject.className();
+         dialog = new DialogType(parent);
+         if (onCreate) {
+            onCreate(*dialog);
+         }
+      }
+      return dialog;
+   }
 }
 
 // This private implementation class holds all private non-virtual members of MainWindow
 class MainWindow::impl {
 public:
 
+   /**
+    * \brief The groups of widgets on the main window that show (calculated) properties of the current recipe.  When
+    *        the recipe changes, we only refresh the groups whose inputs changed.
+    */
+   enum RefreshArea : unsigned {
+      NoAreas      = 0,
+      RecipeFields = 1 << 0, // Name, batch size, boil size, efficiency, boil time
+      BoilGravity  = 1 << 1,
+      OgSlider     = 1 << 2,
+      FgSlider     = 1 << 3,
+      AbvSlider    = 1 << 4,
+      IbuSlider    = 1 << 5,
+      IbuGuSlider  = 1 << 6,
+      BatchSize    = 1 << 7,
+      BoilSize     = 1 << 8,
+      ColorSlider  = 1 << 9,
+      Calories     = 1 << 10,
+      MashSteps    = 1 << 11,
+      AllAreas     = ~0u
+   };
+
    impl(MainWindow & self) :
       self{self},
       fileOpener{},
-      fileOpenDirectory{QDir::homePath()} {
+      fileOpenDirectory{QDir::homePath()},
+      pendingRefreshAreas{NoAreas},
+      refreshScheduled{false},
+      numChangeSignals{0},
+      numCoalescedRefreshes{0} {
       return;
    }
 
    ~impl() = default;
 
+   /**
+    * \brief Which parts of the window need refreshing when the named property of the current recipe changes
+    */
+   static unsigned areasAffectedBy(QString const & propertyName) {
+      if (propertyName == PropertyNames::NamedEntity::name   ) { return RecipeFields;                       }
+      if (propertyName == PropertyNames::Recipe::batchSize_l ) { return RecipeFields | BatchSize;           }
+      if (propertyName == PropertyNames::Recipe::boilSize_l  ) { return RecipeFields | BoilSize;            }
+      if (propertyName == PropertyNames::Recipe::efficiency_pct ||
+          propertyName == PropertyNames::Recipe::boilTime_min) { return RecipeFields;                       }
+      if (propertyName == PropertyNames::Recipe::boilGrav    ) { return BoilGravity;                        }
+      if (propertyName == PropertyNames::Recipe::og          ) { return OgSlider | IbuGuSlider | Calories;  }
+      if (propertyName == PropertyNames::Recipe::fg          ) { return FgSlider | Calories;                }
+      if (propertyName == PropertyNames::Recipe::ABV_pct     ) { return AbvSlider;                          }
+      if (propertyName == PropertyNames::Recipe::IBU         ) { return IbuSlider | IbuGuSlider;            }
+      if (propertyName == PropertyNames::Recipe::finalVolume_l) { return BatchSize;                         }
+      if (propertyName == PropertyNames::Recipe::boilVolume_l) { return BoilSize;                           }
+      if (propertyName == PropertyNames::Recipe::color_srm   ) { return ColorSlider;                        }
+      if (propertyName == PropertyNames::Recipe::calories    ) { return Calories;                           }
+      if (propertyName == PropertyNames::Recipe::mash        ) { return MashSteps;                          }
+      // These are calculated by Recipe::recalcAll but not shown on the main window
+      if (propertyName == PropertyNames::Recipe::points          ||
+          propertyName == PropertyNames::Recipe::wortFromMash_l  ||
+          propertyName == PropertyNames::Recipe::postBoilVolume_l||
+          propertyName == PropertyNames::Recipe::grainsInMash_kg ||
+          propertyName == PropertyNames::Recipe::grains_kg       ||
+          propertyName == PropertyNames::Recipe::SRMColor) {
+         return NoAreas;
+      }
+      // Anything else (a change of style, equipment, ingredients etc) could affect more or less everything
+      return AllAreas;
+   }
+
+   /**
+    * \brief Note that the supplied areas need refreshing, and, if we haven't already done so, arrange to do the
+    *        refresh once control returns to the event loop.  This means that the burst of \c changed signals that
+    *        \c Recipe::recalcAll emits results in one refresh rather than a dozen.
+    */
+   void scheduleRefresh(unsigned const areas) {
+      ++this->numChangeSignals;
+      this->pendingRefreshAreas |= areas;
+      if (!this->refreshScheduled && this->pendingRefreshAreas != NoAreas) {
+         this->refreshScheduled = true;
+         QTimer::singleShot(0, &this->self, [this]() { this->doScheduledRefresh(); });
+      }
+      return;
+   }
+
+   /**
+    * \brief Called from the event loop to do whatever refreshing has accumulated since \c scheduleRefresh was first
+    *        called.
+    */
+   void doScheduledRefresh() {
+      this->refreshScheduled = false;
+      if (this->pendingRefreshAreas == NoAreas) {
+         // Someone called MainWindow::showChanges() in the meantime, which will have refreshed everything
+         return;
+      }
+      ++this->numCoalescedRefreshes;
+      qDebug() <<
+         Q_FUNC_INFO << "Refreshing areas" << QString::number(this->pendingRefreshAreas, 16) <<
+         "; refreshes avoided so far:" << this->numChangeSignals - this->numCoalescedRefreshes;
+      this->refresh(this->pendingRefreshAreas);
+      return;
+   }
+
+   /**
+    * \brief Update the widgets showing the supplied areas from the current recipe
+    */
+   void refresh(unsigned const areas) {
+      // Whatever we're about to do no longer needs doing on the next scheduled refresh
+      this->pendingRefreshAreas &= ~areas;
+
+      Recipe * recipe = this->self.recipeObs;
+      if (!recipe) {
+         return;
+      }
+
+      if (areas & RecipeFields) {
+         // May St. Stevens preserve me
+         this->self.lineEdit_name      ->setText  (recipe->name          ());
+         this->self.lineEdit_batchSize ->setAmount(recipe->batchSize_l   ());
+         this->self.lineEdit_boilSize  ->setAmount(recipe->boilSize_l    ());
+         this->self.lineEdit_efficiency->setAmount(recipe->efficiency_pct());
+         this->self.lineEdit_boilTime  ->setAmount(recipe->boilTime_min  ());
+         this->self.lineEdit_name      ->setCursorPosition(0);
+         this->self.lineEdit_batchSize ->setCursorPosition(0);
+         this->self.lineEdit_boilSize  ->setCursorPosition(0);
+         this->self.lineEdit_efficiency->setCursorPosition(0);
+         this->self.lineEdit_boilTime  ->setCursorPosition(0);
+      }
+
+      if (areas & BoilGravity) {
+         this->self.lineEdit_boilSg->setAmount(recipe->boilGrav());
+      }
+
+      Style const * style = recipe->style();
+      if (areas & OgSlider) {
+         if (style) {
+            updateDensitySlider(*this->self.styleRangeWidget_og, *this->self.oGLabel, style->ogMin(), style->ogMax(), 1.120);
+         }
+         this->self.styleRangeWidget_og->setValue(this->self.oGLabel->getAmountToDisplay(recipe->og()));
+      }
+
+      if (areas & FgSlider) {
+         if (style) {
+            updateDensitySlider(*this->self.styleRangeWidget_fg, *this->self.fGLabel, style->fgMin(), style->fgMax(), 1.030);
+         }
+         this->self.styleRangeWidget_fg->setValue(this->self.fGLabel->getAmountToDisplay(recipe->fg()));
+      }
+
+      if (areas & AbvSlider) {
+         this->self.styleRangeWidget_abv->setValue(recipe->ABV_pct());
+      }
+      if (areas & IbuSlider) {
+         this->self.styleRangeWidget_ibu->setValue(recipe->IBU());
+      }
+
+      if (areas & BatchSize) {
+         SmartLabel const & label = *this->self.label_batchSize;
+         this->self.rangeWidget_batchSize->setRange         (0, label.getAmountToDisplay(recipe->batchSize_l  ()));
+         this->self.rangeWidget_batchSize->setPreferredRange(0, label.getAmountToDisplay(recipe->finalVolume_l()));
+         this->self.rangeWidget_batchSize->setValue         (   label.getAmountToDisplay(recipe->finalVolume_l()));
+      }
+
+      if (areas & BoilSize) {
+         SmartLabel const & label = *this->self.label_boilSize;
+         this->self.rangeWidget_boilsize->setRange         (0, label.getAmountToDisplay(recipe->boilSize_l  ()));
+         this->self.rangeWidget_boilsize->setPreferredRange(0, label.getAmountToDisplay(recipe->boilVolume_l()));
+         this->self.rangeWidget_boilsize->setValue         (   label.getAmountToDisplay(recipe->boilVolume_l()));
+      }
+
+      if (areas & ColorSlider) {
+         /* Colors need the same basic treatment as gravity */
+         if (style) {
+            updateColorSlider(*this->self.styleRangeWidget_srm,
+                              *this->self.colorSRMLabel,
+                              style->colorMin_srm(),
+                              style->colorMax_srm());
+         }
+         this->self.styleRangeWidget_srm->setValue(this->self.colorSRMLabel->getAmountToDisplay(recipe->color_srm()));
+      }
+
+      if (areas & IbuGuSlider) {
+         // In some, incomplete, recipes, OG is approximately 1.000, which then makes GU close to 0 and thus IBU/GU
+         // insanely large.  Besides being meaningless, such a large number takes up a lot of space.  So, where gravity
+         // units are below 1, we just show IBU on the IBU/GU slider.
+         auto gravityUnits = (recipe->og()-1)*1000;
+         if (gravityUnits < 1) {
+            gravityUnits = 1;
+         }
+         this->self.ibuGuSlider->setValue(recipe->IBU()/gravityUnits);
+      }
+
+      if (areas & Calories) {
+         this->self.label_calories->setText(
+            QString("%1").arg(
+               Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity::Volume) ==
+                  Measurement::UnitSystems::volume_Metric ? recipe->calories33cl() : recipe->calories12oz(),
+               0,
+               'f',
+               0
+            )
+         );
+      }
+
+      // See if we need to change the mash in the table.
+      if ((areas & MashSteps) && recipe->mash()) {
+         this->self.mashStepTableModel->setMash(recipe->mash());
+      }
+      return;
+   }
+
    /**
     * @brief Import recipes, hops, equipment, etc from files specified by the user.  (Currently this is just BeerXML,
     *        but in future could well be other formats too.
@@ -334,17 +553,43 @@ public:
       return;
    }
 
+#ifndef BT_NO_INSTRUMENTATION
+   /**
+    * \brief Show the developer dialog for the timing probes, creating it the first time we need it, as almost nobody
+    *        will ever open it
+    */
+   void showInstrumentationDialog() {
+      if (!this->instrumentationDialog) {
+         this->instrumentationDialog = new InstrumentationDialog(&this->self);
+      }
+      this->instrumentationDialog->show();
+      this->instrumentationDialog->raise();
+      return;
+   }
+#endif
+
 private:
    MainWindow & self;
    QFileDialog* fileOpener;
    QString fileOpenDirectory;
+#ifndef BT_NO_INSTRUMENTATION
+   // Owned by self (via Qt parent-child ownership)
+   InstrumentationDialog * instrumentationDialog = nullptr;
+#endif
+
+   // Bitmask of RefreshArea values waiting for doScheduledRefresh()
+   unsigned pendingRefreshAreas;
+   bool refreshScheduled;
+   // Debug counters: refreshes avoided is the difference between these two
+   unsigned long numChangeSignals;
+   unsigned long numCoalescedRefreshes;
 };
 
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), pimpl{std::make_unique<impl>(*this)} {
    qDebug() << Q_FUNC_INFO;
 
-   this->undoStack = new QUndoStack(this);
+   this->undoStack = BoundedUndoStack::fromSettings();
 
    // Need to call this parent class method to get all the widgets added (I think).
    this->setupUi(this);
@@ -408,12 +653,14 @@ void MainWindow::init() {
    this->setupCSS();
    // initialize all of the dialog windows
    this->setupDialogs();
+   Application::logStartupStage("Dialogs created");
    // initialize the ranged sliders
    this->setupRanges();
    // the dialogs have to be setup before this is called
    this->setupComboBoxes();
    // do all the work to configure the tables models and their proxies
    this->setupTables();
+   Application::logStartupStage("Tables set up");
    // Create the keyboard shortcuts
    this->setupShortCuts();
    // Once more with the context menus too
@@ -438,6 +685,7 @@ void MainWindow::init() {
    // program - eg window size, which is stored in MainWindow::closeEvent().
    // Breaks the naming convention, doesn't it?
    this->restoreSavedState();
+   Application::logStartupStage("Saved state restored");
 
    // Moved from Database class
    Recipe::connectSignalsForAllRecipes();
@@ -447,7 +695,6 @@ void MainWindow::init() {
 
    // I do not like this connection here.
    connect(this->ancestorDialog,  &AncestorDialog::ancestoryChanged, treeView_recipe->model(), &BtTreeModel::versionedRecipe);
-   connect(this->optionDialog,    &OptionDialog::showAllAncestors,   treeView_recipe->model(), &BtTreeModel::catchAncestors );
    connect(this->treeView_recipe, &BtTreeView::recipeSpawn,          this,                     &MainWindow::versionedRecipe );
 
    // No connections from the database yet? Oh FSM, that probably means I'm
@@ -464,6 +711,27 @@ void MainWindow::init() {
    return;
 }
 
+void MainWindow::loadDeferredTrees() {
+   std::initializer_list<BtTreeView *> const deferredTrees{
+      this->treeView_equip,
+      this->treeView_ferm,
+      this->treeView_hops,
+      this->treeView_misc,
+      this->treeView_yeast,
+      this->treeView_style,
+      this->treeView_water
+   };
+   for (BtTreeView * tree : deferredTrees) {
+      if (!tree->model()->isLoaded()) {
+         tree->populate();
+         QTimer::singleShot(0, this, &MainWindow::loadDeferredTrees);
+         return;
+      }
+   }
+   Application::logStartupStage("All trees populated");
+   return;
+}
+
 
 // See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the header file)
 MainWindow::~MainWindow() = default;
@@ -590,25 +858,28 @@ void MainWindow::setupCSS()
 
 // Most dialogs are initialized in here. That should include any initial
 // configurations as well
+//
+// The ones set to nullptr here are rarely used and/or slow to construct, so we create them the first time they are
+// needed (see lazyDialog()).
 void MainWindow::setupDialogs()
 {
    dialog_about = new AboutDialog(this);
    equipEditor = new EquipmentEditor(this);
    singleEquipEditor = new EquipmentEditor(this, true);
    fermDialog = new FermentableDialog(this);
-   fermEditor = new FermentableEditor(this);
+   fermEditor = nullptr;
    hopDialog = new HopDialog(this);
-   hopEditor = new HopEditor(this);
+   hopEditor = nullptr;
    mashEditor = new MashEditor(this);
    mashStepEditor = new MashStepEditor(this);
    mashWizard = new MashWizard(this);
    miscDialog = new MiscDialog(this);
-   miscEditor = new MiscEditor(this);
+   miscEditor = nullptr;
    styleEditor = new StyleEditor(this);
    singleStyleEditor = new StyleEditor(this,true);
    yeastDialog = new YeastDialog(this);
-   yeastEditor = new YeastEditor(this);
-   optionDialog = new OptionDialog(this);
+   yeastEditor = nullptr;
+   optionDialog = nullptr;
    recipeScaler = new ScaleRecipeTool(this);
    recipeFormatter = new RecipeFormatter(this);
    printAndPreviewDialog = new PrintAndPreviewDialog(this);
@@ -616,15 +887,15 @@ void MainWindow::setupDialogs()
    converterTool = new ConverterTool(this);
    hydrometerTool = new HydrometerTool(this);
    alcoholTool = new AlcoholTool(this);
-   timerMainDialog = new TimerMainDialog(this);
+   timerMainDialog = nullptr;
    primingDialog = new PrimingDialog(this);
    strikeWaterDialog = new StrikeWaterDialog(this);
    refractoDialog = new RefractoDialog(this);
-   mashDesigner = new MashDesigner(this);
-   pitchDialog = new PitchDialog(this);
+   mashDesigner = nullptr;
+   pitchDialog = nullptr;
    btDatePopup = new BtDatePopup(this);
 
-   waterDialog = new WaterDialog(this);
+   waterDialog = nullptr;
    waterEditor = new WaterEditor(this);
 
    ancestorDialog = new AncestorDialog(this);
@@ -931,7 +1202,11 @@ void MainWindow::setupTriggers() {
    connect( actionHops, &QAction::triggered, hopDialog, &QWidget::show );                                               // > View > Hops
    connect( actionMiscs, &QAction::triggered, miscDialog, &QWidget::show );                                             // > View > Miscs
    connect( actionYeasts, &QAction::triggered, yeastDialog, &QWidget::show );                                           // > View > Yeasts
-   connect( actionOptions, &QAction::triggered, optionDialog, &OptionDialog::show );                                    // > Tools > Options
+   connect( actionOptions, &QAction::triggered, this, [this]() {                                                       // > Tools > Options
+      lazyDialog<OptionDialog>(this->optionDialog, this, [this](OptionDialog & dialog) {
+         connect(&dialog, &OptionDialog::showAllAncestors, this->treeView_recipe->model(), &BtTreeModel::catchAncestors);
+      })->show();
+   });
    connect( actionManual,                     &QAction::triggered, this,                  &MainWindow::openManual          ); // > About > Manual
    connect( actionScale_Recipe, &QAction::triggered, recipeScaler, &QWidget::show );                                    // > Tools > Scale Recipe
    connect( action_recipeToTextClipboard, &QAction::triggered, recipeFormatter, &RecipeFormatter::toTextClipboard );    // > Tools > Recipe to Clipboard as Text
@@ -944,11 +1219,18 @@ void MainWindow::setupTriggers() {
    connect( actionStrikeWater_Calculator, &QAction::triggered, strikeWaterDialog, &QWidget::show );                     // > Tools > Strike Water Calculator
    connect( actionRefractometer_Tools, &QAction::triggered, refractoDialog, &QWidget::show );                           // > Tools > Refractometer Tools
    connect( actionPitch_Rate_Calculator, &QAction::triggered, this, &MainWindow::showPitchDialog);                      // > Tools > Pitch Rate Calculator
-   connect( actionTimers, &QAction::triggered, timerMainDialog, &QWidget::show );                                       // > Tools > Timers
+   connect( actionTimers, &QAction::triggered, this, [this]() { lazyDialog(this->timerMainDialog, this)->show(); } );  // > Tools > Timers
    connect( actionDeleteSelected, &QAction::triggered, this, &MainWindow::deleteSelected );
    connect( actionWater_Chemistry, &QAction::triggered, this, &MainWindow::popChemistry);                               // > Tools > Water Chemistry
    connect( actionAncestors, &QAction::triggered, this, &MainWindow::setAncestor);                                      // > Tools > Ancestors
    connect( action_brewit, &QAction::triggered, this, &MainWindow::brewItHelper );
+#ifndef BT_NO_INSTRUMENTATION
+   // Developer-only, so not in the .ui file (and not translated)
+   QAction * actionTimingProbes = new QAction("Timing Probes...", this);
+   actionTimingProbes->setObjectName("actionTimingProbes");
+   menuTools->insertAction(actionOptions, actionTimingProbes);
+   connect( actionTimingProbes, &QAction::triggered, this, [this]() { this->pimpl->showInstrumentationDialog(); } ); // > Tools > Timing Probes
+#endif
    //One Dialog to rule them all, at least all printing and export.
    connect( actionPrint, &QAction::triggered, printAndPreviewDialog, &QWidget::show);                                   // > File > Print and Preview
 
@@ -988,7 +1270,11 @@ void MainWindow::setupClicks() {
    connect(this->pushButton_editMashStep,   &QAbstractButton::clicked, this,         &MainWindow::editSelectedMashStep );
    connect(this->pushButton_mashWizard,     &QAbstractButton::clicked, mashWizard,   &MashWizard::show );
    connect(this->pushButton_saveMash,       &QAbstractButton::clicked, this,         &MainWindow::saveMash );
-   connect(this->pushButton_mashDes,        &QAbstractButton::clicked, mashDesigner, &MashDesigner::show );
+   connect(this->pushButton_mashDes,        &QAbstractButton::clicked, this,         [this]() {
+      lazyDialog<MashDesigner>(this->mashDesigner, this, [this](MashDesigner & dialog) {
+         dialog.setRecipe(this->recipeObs);
+      })->show();
+   });
    connect(this->pushButton_mashUp,         &QAbstractButton::clicked, this,         &MainWindow::moveSelectedMashStepUp );
    connect(this->pushButton_mashDown,       &QAbstractButton::clicked, this,         &MainWindow::moveSelectedMashStepDown );
    connect(this->pushButton_mashRemove,     &QAbstractButton::clicked, this,         &MainWindow::removeMash );
@@ -1121,7 +1407,7 @@ void MainWindow::treeActivated(const QModelIndex &index) {
             {
                Fermentable * ferm = active->getItem<Fermentable>(index);
                if (ferm) {
-                  fermEditor->setFermentable(ferm);
+                  lazyDialog(fermEditor, this)->setFermentable(ferm);
                   fermEditor->show();
                }
             }
@@ -1130,7 +1416,7 @@ void MainWindow::treeActivated(const QModelIndex &index) {
             {
                Hop* h = active->getItem<Hop>(index);
                if (h) {
-                  hopEditor->setHop(h);
+                  lazyDialog(hopEditor, this)->setHop(h);
                   hopEditor->show();
                }
             }
@@ -1139,7 +1425,7 @@ void MainWindow::treeActivated(const QModelIndex &index) {
             {
                Misc * m = active->getItem<Misc>(index);
                if (m) {
-                  miscEditor->setMisc(m);
+                  lazyDialog(miscEditor, this)->setMisc(m);
                   miscEditor->show();
                }
             }
@@ -1157,7 +1443,7 @@ void MainWindow::treeActivated(const QModelIndex &index) {
             {
                Yeast * y = active->getItem<Yeast>(index);
                if (y) {
-                  yeastEditor->setYeast(y);
+                  lazyDialog(yeastEditor, this)->setYeast(y);
                   yeastEditor->show();
                }
             }
@@ -1335,7 +1621,9 @@ void MainWindow::setRecipe(Recipe* recipe) {
    recipeFormatter->setRecipe(recipe);
    ogAdjuster->setRecipe(recipe);
    recipeExtrasWidget->setRecipe(recipe);
-   mashDesigner->setRecipe(recipe);
+   if (mashDesigner) {
+      mashDesigner->setRecipe(recipe);
+   }
    equipmentButton->setRecipe(recipe);
    singleEquipEditor->setEquipment(recEquip);
    styleButton->setRecipe(recipe);
@@ -1460,107 +1748,19 @@ void MainWindow::showChanges(QMetaProperty* prop) {
       return;
    }
 
-   bool updateAll = (prop == nullptr);
-   QString propName;
-
    if (prop) {
-      propName = prop->name();
-   }
-
-   // May St. Stevens preserve me
-   this->lineEdit_name      ->setText  (this->recipeObs->name          ());
-   this->lineEdit_batchSize ->setAmount(this->recipeObs->batchSize_l   ());
-   this->lineEdit_boilSize  ->setAmount(this->recipeObs->boilSize_l    ());
-   this->lineEdit_efficiency->setAmount(this->recipeObs->efficiency_pct());
-   this->lineEdit_boilTime  ->setAmount(this->recipeObs->boilTime_min  ());
-   this->lineEdit_name      ->setCursorPosition(0);
-   this->lineEdit_batchSize ->setCursorPosition(0);
-   this->lineEdit_boilSize  ->setCursorPosition(0);
-   this->lineEdit_efficiency->setCursorPosition(0);
-   this->lineEdit_boilTime  ->setCursorPosition(0);
-/*
-   lineEdit_calcBatchSize->setText(recipeObs);
-   lineEdit_calcBoilSize->setText(recipeObs);
-*/
-
-   // Color manipulation
-/*
-   if( 0.95*recipeObs->batchSize_l() <= recipeObs->finalVolume_l() && recipeObs->finalVolume_l() <= 1.05*recipeObs->batchSize_l() )
-      lineEdit_calcBatchSize->setStyleSheet(goodSS);
-   else if( recipeObs->finalVolume_l() < 0.95*recipeObs->batchSize_l() )
-      lineEdit_calcBatchSize->setStyleSheet(lowSS);
-   else
-      lineEdit_calcBatchSize->setStyleSheet(highSS);
-
-   if( 0.95*recipeObs->boilSize_l() <= recipeObs->boilVolume_l() && recipeObs->boilVolume_l() <= 1.05*recipeObs->boilSize_l() )
-      lineEdit_calcBoilSize->setStyleSheet(goodSS);
-   else if( recipeObs->boilVolume_l() < 0.95* recipeObs->boilSize_l() )
-      lineEdit_calcBoilSize->setStyleSheet(lowSS);
-   else
-      lineEdit_calcBoilSize->setStyleSheet(highSS);
-*/
-   this->lineEdit_boilSg->setAmount(this->recipeObs->boilGrav());
-
-   Style const * style = this->recipeObs->style();
-   if (style) {
-      updateDensitySlider(*this->styleRangeWidget_og, *this->oGLabel, style->ogMin(), style->ogMax(), 1.120);
-   }
-   this->styleRangeWidget_og->setValue(this->oGLabel->getAmountToDisplay(recipeObs->og()));
-
-   if (style) {
-      updateDensitySlider(*this->styleRangeWidget_fg, *this->fGLabel, style->fgMin(), style->fgMax(), 1.030);
-   }
-   this->styleRangeWidget_fg->setValue(this->fGLabel->getAmountToDisplay(recipeObs->fg()));
-
-   this->styleRangeWidget_abv->setValue(recipeObs->ABV_pct());
-   this->styleRangeWidget_ibu->setValue(recipeObs->IBU());
-
-   this->rangeWidget_batchSize->setRange         (0,
-                                                  this->label_batchSize->getAmountToDisplay(this->recipeObs->batchSize_l()));
-   this->rangeWidget_batchSize->setPreferredRange(0,
-                                                  this->label_batchSize->getAmountToDisplay(this->recipeObs->finalVolume_l()));
-   this->rangeWidget_batchSize->setValue         (this->label_batchSize->getAmountToDisplay(this->recipeObs->finalVolume_l()));
-
-   this->rangeWidget_boilsize->setRange         (0,
-                                                 this->label_boilSize->getAmountToDisplay(this->recipeObs->boilSize_l()));
-   this->rangeWidget_boilsize->setPreferredRange(0,
-                                                 this->label_boilSize->getAmountToDisplay(this->recipeObs->boilVolume_l()));
-   this->rangeWidget_boilsize->setValue         (this->label_boilSize->getAmountToDisplay(this->recipeObs->boilVolume_l()));
-
-   /* Colors need the same basic treatment as gravity */
-   if (style) {
-      updateColorSlider(*this->styleRangeWidget_srm,
-                        *this->colorSRMLabel,
-                        style->colorMin_srm(),
-                        style->colorMax_srm());
-   }
-   this->styleRangeWidget_srm->setValue(this->colorSRMLabel->getAmountToDisplay(this->recipeObs->color_srm()));
-
-   // In some, incomplete, recipes, OG is approximately 1.000, which then makes GU close to 0 and thus IBU/GU insanely
-   // large.  Besides being meaningless, such a large number takes up a lot of space.  So, where gravity units are
-   // below 1, we just show IBU on the IBU/GU slider.
-   auto gravityUnits = (recipeObs->og()-1)*1000;
-   if (gravityUnits < 1) {
-      gravityUnits = 1;
+      this->pimpl->scheduleRefresh(impl::areasAffectedBy(prop->name()));
+      return;
    }
-   ibuGuSlider->setValue(recipeObs->IBU()/gravityUnits);
 
-   label_calories->setText(
-      QString("%1").arg(Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity::Volume) == Measurement::UnitSystems::volume_Metric ? recipeObs->calories33cl() : recipeObs->calories12oz(),0,'f',0)
-   );
-
-   // See if we need to change the mash in the table.
-   if ((updateAll && recipeObs->mash()) ||
-       (propName == "mash" && recipeObs->mash())) {
-      mashStepTableModel->setMash(recipeObs->mash());
-   }
+   // Explicit request to update everything, which we do straight away.  This also takes care of anything that was
+   // waiting for a scheduled refresh.
+   this->pimpl->refresh(impl::AllAreas);
 
    // Not sure about this, but I am annoyed that modifying the hop usage
    // modifiers isn't automatically updating my display
-   if (updateAll) {
-     recipeObs->recalcIBU();
-     hopTableProxy->invalidate();
-   }
+   recipeObs->recalcIBU();
+   hopTableProxy->invalidate();
    return;
 }
 
@@ -1941,8 +2141,20 @@ Recipe* MainWindow::currentRecipe() {
    return recipeObs;
 }
 
+QList<Recipe*> MainWindow::selectedRecipes() {
+   QList<Recipe*> recipes;
+   for (QModelIndex selected : treeView_recipe->selectionModel()->selectedRows()) {
+      Recipe* rec = treeView_recipe->getItem<Recipe>(selected);
+      // Skip anything that is not a recipe (eg folders and brew notes), and don't list a recipe twice
+      if (rec != nullptr && !recipes.contains(rec)) {
+         recipes.append(rec);
+      }
+   }
+   return recipes;
+}
+
 void MainWindow::setUndoRedoEnable() {
-   Q_ASSERT(this->undoStack != 0);
+   Q_ASSERT(this->undoStack);
    actionUndo->setEnabled(this->undoStack->canUndo());
    actionRedo->setEnabled(this->undoStack->canRedo());
 
@@ -1953,7 +2165,7 @@ void MainWindow::setUndoRedoEnable() {
 }
 
 void MainWindow::doOrRedoUpdate(QUndoCommand * update) {
-   Q_ASSERT(this->undoStack != nullptr);
+   Q_ASSERT(this->undoStack);
    Q_ASSERT(update != nullptr);
    this->undoStack->push(update);
    this->setUndoRedoEnable();
@@ -1974,7 +2186,7 @@ void MainWindow::doOrRedoUpdate(QObject & updatee,
 // For undo/redo, we use Qt's Undo framework
 void MainWindow::editUndo()
 {
-   Q_ASSERT(this->undoStack != 0);
+   Q_ASSERT(this->undoStack);
    if ( !this->undoStack->canUndo() ) {
       qDebug() << "Undo called but nothing to undo";
    } else {
@@ -1987,7 +2199,7 @@ void MainWindow::editUndo()
 
 void MainWindow::editRedo()
 {
-   Q_ASSERT(this->undoStack != 0);
+   Q_ASSERT(this->undoStack);
    if ( !this->undoStack->canRedo() ) {
       qDebug() << "Redo called but nothing to redo";
    } else {
@@ -2143,7 +2355,7 @@ void MainWindow::editSelectedFermentable() {
    if( f == nullptr )
       return;
 
-   fermEditor->setFermentable(f);
+   lazyDialog(fermEditor, this)->setFermentable(f);
    fermEditor->show();
 }
 
@@ -2152,7 +2364,7 @@ void MainWindow::editSelectedMisc() {
    if( m == nullptr )
       return;
 
-   miscEditor->setMisc(m);
+   lazyDialog(miscEditor, this)->setMisc(m);
    miscEditor->show();
 }
 
@@ -2162,7 +2374,7 @@ void MainWindow::editSelectedHop()
    if( h == nullptr )
       return;
 
-   hopEditor->setHop(h);
+   lazyDialog(hopEditor, this)->setHop(h);
    hopEditor->show();
 }
 
@@ -2172,7 +2384,7 @@ void MainWindow::editSelectedYeast()
    if( y == nullptr )
       return;
 
-   yeastEditor->setYeast(y);
+   lazyDialog(yeastEditor, this)->setYeast(y);
    yeastEditor->show();
 }
 
@@ -3082,6 +3294,8 @@ void MainWindow::redisplayLabel()
 
 void MainWindow::showPitchDialog()
 {
+   lazyDialog(pitchDialog, this);
+
    // First, copy the current recipe og and volume.
    if( recipeObs )
    {
@@ -3227,7 +3441,7 @@ void MainWindow::popChemistry()
 
    // late binding for the win?
    if (allow ) {
-      waterDialog->setRecipe(recipeObs);
+      lazyDialog(waterDialog, this)->setRecipe(recipeObs);
       waterDialog->show();
    }
    else {
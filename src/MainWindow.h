@@ -38,11 +38,11 @@
 #include <QPrinter>
 #include <QString>
 #include <QTimer>
-#include <QUndoStack>
 #include <QVariant>
 #include <QWidget>
 
 #include "ui_mainWindow.h"
+#include "BoundedUndoStack.h"
 #include "SimpleUndoableUpdate.h"
 
 
@@ -130,8 +130,18 @@ public:
     */
    void init();
 
+   /**
+    * \brief Populate the trees that were not populated during \c init (ie all except the recipe tree).  This does one
+    *        tree and then, if there are more to do, reschedules itself via the event loop, so that the window stays
+    *        responsive in between.  Called once the main window is showing.
+    */
+   void loadDeferredTrees();
+
    //! \brief Get the currently observed recipe.
    Recipe* currentRecipe();
+   //! \brief Get the recipes selected in the recipe tree.  (Unlike \c reduceInventory etc, this does not change the
+   //!        current recipe.)
+   QList<Recipe*> selectedRecipes();
    //! \brief Display a file dialog for writing xml files.
    QFile* openForWrite(QString filterStr = "BeerXML files (*.xml)", QString defaultSuff = "xml");
 
@@ -416,8 +426,8 @@ private:
    BtDatePopup* btDatePopup;
    int confirmDelete;
 
-   // Undo / Redo, using the Qt Undo framework
-   QUndoStack * undoStack = nullptr;
+   // Undo / Redo, using the Qt Undo framework commands, but our own stack so that we can limit how much it holds on to
+   std::unique_ptr<BoundedUndoStack> undoStack;
 
    //! \brief Fix pixel dimensions according to dots-per-inch (DPI) of screen we're on.
    void setSizesInPixelsBasedOnDpi();
@@ -29,6 +29,7 @@
 #include "HeatCalculations.h"
 #include "measurement/Measurement.h"
 #include "model/Fermentable.h"
+#include "model/MashSimulation.h"
 #include "PhysicalConstants.h"
 
 MashDesigner::MashDesigner(QWidget * parent) : QDialog     {parent},
@@ -122,14 +123,11 @@ bool MashDesigner::nextStep(int step) {
 
    this->prevStep = this->mashStep;
    if (this->mashStep) {
-      // NOTE: This needs to be changed. Assumes 1L of water is 1 kg.
-      this->MC += this->mashStep->infuseAmount_l() * HeatCalculations::Cw_calGC;
-      this->addedWater_l += this->mashStep->infuseAmount_l();
-
-      if (!this->prevStep) {
-         // If the last step is null, we need to add the influence of the tun.
-         this->MC += this->mash->tunSpecificHeat_calGC() * this->mash->tunWeight_kg();
-      }
+      // What's now in the tun is whatever the steps saved so far give (including the tun itself, which has been heated
+      // by the first of them).
+      auto const simulation = MashSimulation::forMash(*this->mash, MashSimulation::optionsFor(*this->recObs));
+      this->MC           = simulation->thermalMass_calC();
+      this->addedWater_l = simulation->totalMashWater_l();
    }
 
    // If we have a step number, and the step is smaller than the current
@@ -247,11 +245,10 @@ double MashDesigner::volFromTemp_l(double temp_c) {
    double tf = stepTemp_c();
    // Initial temp is the last step's temp if the last step exists, otherwise the grain temp.
    double t1 = (!this->prevStep) ? mash->grainTemp_c() : this->prevStep->stepTemp_c();
-   double mt = mash->tunSpecificHeat_calGC();
-   double ct = mash->tunWeight_kg();
+   // The first step also has to heat the tun
+   double tunThermalMass_calC = (!this->prevStep) ? mash->tunSpecificHeat_calGC() * mash->tunWeight_kg() : 0.0;
 
-   double mw = 1/(HeatCalculations::Cw_calGC * (tw - tf)) *
-      (MC * (tf - t1) + ((!this->prevStep) ? mt * ct * (tf - this->mash->tunTemp_c()) : 0));
+   double mw = MashSimulation::infusionAmount_l(tw, MC, t1, tf, tunThermalMass_calC, this->mash->tunTemp_c());
 
    // Sanity check for unlikely edge cases
    mw = std::max(0., mw);
@@ -276,28 +273,26 @@ double MashDesigner::tempFromVolume_c(double vol_l) {
 
    double tf = stepTemp_c();
 
-   // NOTE: This needs to be changed. Assumes 1L = 1 kg.
-   double mw = vol_l;
-   if (mw <= 0) {
+   if (vol_l <= 0) {
       return 0.0;
    }
-   double cw = HeatCalculations::Cw_calGC;
    // Initial temp is the last step's temp if the last step exists, otherwise the grain temp.
    double t1 = (!this->prevStep) ? this->mash->grainTemp_c() : this->prevStep->stepTemp_c();
    // When batch sparging, you lose about 10C from previous step.
-   if (isSparge()) {
-      t1 = (!this->prevStep) ? this->mash->grainTemp_c() : this->prevStep->stepTemp_c() - 10;
+   if (isSparge() && this->prevStep) {
+      t1 -= MashSimulation::spargeCooling_c;
    }
-   double mt = this->mash->tunSpecificHeat_calGC();
-   double ct = this->mash->tunWeight_kg();
+   double tunThermalMass_calC = this->mash->tunSpecificHeat_calGC() * this->mash->tunWeight_kg();
 
-   double batchMC = grain_kg * HeatCalculations::Cgrain_calGC
-                    + absorption_LKg * grain_kg * HeatCalculations::Cw_calGC
-                    + this->mash->tunWeight_kg() * this->mash->tunSpecificHeat_calGC();
+   double thermalMass_calC =
+      this->isSparge() ? MashSimulation::spargeThermalMass_calC(grain_kg, absorption_LKg, tunThermalMass_calC) : MC;
 
-   double tw = 1 / (mw * cw) * (
-      (this->isSparge() ? batchMC : MC) * (tf - t1) + (!this->prevStep ? mt * ct * (tf - this->mash->tunTemp_c()) : 0)
-   ) + tf;
+   double tw = MashSimulation::infusionTemp_c(vol_l,
+                                              thermalMass_calC,
+                                              t1,
+                                              tf,
+                                              !this->prevStep ? tunThermalMass_calC : 0.0,
+                                              this->mash->tunTemp_c());
 
    // Sanity check this value
    tw = std::min(tw, boilingTemp_c());  // Can't add water above boiling
@@ -418,7 +413,8 @@ double MashDesigner::waterFromMash_l() {
       return 0.0;
    }
 
-   double waterAdded_l = this->mash->totalMashWater_l();
+   double waterAdded_l =
+      MashSimulation::forMash(*this->mash, MashSimulation::optionsFor(*this->recObs))->totalMashWater_l();
 
    // A newly-created mash step will not yet have been added to the mash
    if (this->mashStep && this->mashStep->getMashId() <= 0) {
@@ -620,7 +616,6 @@ void MashDesigner::saveTargetTemp() {
 
 double MashDesigner::getDecoctionAmount_l() {
    double m_w, m_g, r;
-   double c_w, c_g;
    double tf, t1;
 
    if (!this->prevStep) {
@@ -634,11 +629,12 @@ double MashDesigner::getDecoctionAmount_l() {
    m_w = addedWater_l; // NOTE: this is bad. Assumes 1L = 1 kg.
    m_g = grain_kg;
 
-   c_w = HeatCalculations::Cw_calGC;
-   c_g = HeatCalculations::Cgrain_calGC;
-
    // r is the ratio of water and grain to take out for decoction.
-   r = ((MC)*(tf-t1)) / ((m_w*c_w + m_g*c_g)*(maxTemp_c()-tf) + (m_w*c_w + m_g*c_g)*(tf-t1));
+   r = MashSimulation::decoctionFraction(MC,
+                                         m_w * HeatCalculations::Cw_calGC + m_g * HeatCalculations::Cgrain_calGC,
+                                         t1,
+                                         tf,
+                                         maxTemp_c());
    if (r < 0 || r > 1) {
       //QMessageBox::critical(this, tr("Decoction error"), tr("Something went wrong in decoction calculation."));
       //Application::log(Application::ERROR, QString("MashDesigner Decoction: r=%1").arg(r));
@@ -33,6 +33,7 @@
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Mash.h"
+#include "model/MashSimulation.h"
 #include "model/MashStep.h"
 #include "PhysicalConstants.h"
 
@@ -123,34 +124,6 @@ void MashWizard::show()
    return;
 }
 
-double MashWizard::calcDecoctionAmount( MashStep* step, Mash* mash, double waterMass, double grainMass, double lastTemp, double boiling)
-{
-   double grainDensity = PhysicalConstants::grainDensity_kgL;
-
-   double stepTemp  = step->stepTemp_c();
-   double equipMass = (mash->equipAdjust()) ? mash->tunWeight_kg() : 0;
-   double c_e       = (mash->equipAdjust()) ? mash->tunSpecificHeat_calGC() : 0;
-
-   double grHeat = grainMass * HeatCalculations::Cw_calGC;
-   double waHeat = waterMass * HeatCalculations::Cgrain_calGC;
-   double eqHeat = equipMass * c_e;
-
-   double totalHeat = grHeat + waHeat;
-   double deltaTemp = stepTemp - lastTemp;
-
-   // r is the ratio of water and grain to take out for decoction.
-   double r = ((totalHeat + eqHeat)*deltaTemp) / (totalHeat*(boiling - stepTemp) + totalHeat*deltaTemp);
-
-   if( r < 0 || r > 1 )
-   {
-      QMessageBox::critical(this, tr("Decoction error"), tr("Something went wrong in decoction calculation.") );
-      qCritical() << Q_FUNC_INFO << "r=" << r;
-      return -1;
-   }
-   return r * (waterMass + grainMass/grainDensity);
-
-}
-
 void MashWizard::wizardry() {
    if( recObs == nullptr || recObs->mash() == nullptr )
       return;
@@ -158,10 +131,9 @@ void MashWizard::wizardry() {
    Mash* mash = recObs->mash();
    double thickness_LKg;
    double thickNum;
-   double MC, MCw; // Thermal mass of mash and water.
+   double MC; // Thermal mass of mash.
    double tw, tf, t1; // Water, final, and initial temps.
    double grainMass = 0.0, massWater = 0.0;
-   double grainDensity = PhysicalConstants::grainDensity_kgL;
    double absorption_LKg = PhysicalConstants::grainAbsorption_Lkg;
    double boilingPoint_c = 100.0;
    double lauterDeadspace = 0.0;
@@ -189,6 +161,10 @@ void MashWizard::wizardry() {
       return;
    }
 
+   // From here on, we're changing lots of mash steps, so we want to write them all in one go and only recalculate the
+   // recipe once at the end.
+   Recipe::EditSession editSession{*recObs};
+
    // Find any batch sparges and remove them
    for (auto step : steps) {
       if (step->isSparge()) {
@@ -222,11 +198,11 @@ void MashWizard::wizardry() {
    tf = mashStep->stepTemp_c();
    t1 = mash->grainTemp_c();
    massWater = thickness_LKg * grainMass;
-   MCw = HeatCalculations::Cw_calGC * massWater;
    MC = HeatCalculations::Cgrain_calGC * grainMass;
 
    // I am specifically ignoring BeerXML's request to only do this if mash->getEquipAdjust() is set.
-   tw = MC/MCw * (tf-t1) + (mash->tunSpecificHeat_calGC()*mash->tunWeight_kg())/MCw * (tf-mash->tunTemp_c()) + tf;
+   double const tunThermalMass_calC = mash->tunSpecificHeat_calGC() * mash->tunWeight_kg();
+   tw = MashSimulation::infusionTemp_c(massWater, MC, t1, tf, tunThermalMass_calC, mash->tunTemp_c());
 
    // Can't have water above boiling.
    if( tw > boilingPoint_c ) {
@@ -243,7 +219,7 @@ void MashWizard::wizardry() {
    // Do rest of steps.
    // Add thermal mass of equipment to MC.
    // I am specifically ignoring BeerXML's request to only do this if mash->getEquipAdjust() is set.
-   MC += mash->tunSpecificHeat_calGC()*mash->tunWeight_kg();
+   MC += tunThermalMass_calC;
 
    for (int i = 1; i < steps.size(); ++i) {
       mashStep = steps[i];
@@ -251,32 +227,30 @@ void MashWizard::wizardry() {
       if (mashStep->isTemperature()) {
          continue;
       } else if (mashStep->isDecoction()) {
-         double m_w, m_g, m_e, r;
-         double c_w, c_g, c_e;
-
          tf = mashStep->stepTemp_c();
          t1 = steps[i-1]->stepTemp_c();
 
-         m_w = 0; // Total mass of water.
+         double waterMass = 0; // Total mass of water.
          for (int j = 0; j < i; ++j) {
-            m_w += steps[j]->infuseAmount_l();
+            waterMass += steps[j]->infuseAmount_l();
          }
-         m_g = grainMass;
-         m_e = (mash->equipAdjust()) ? mash->tunWeight_kg() : 0;
-
-         c_w = HeatCalculations::Cw_calGC;
-         c_g = HeatCalculations::Cgrain_calGC;
-         c_e = (mash->equipAdjust()) ? mash->tunSpecificHeat_calGC() : 0;
+         double const boiledThermalMass_calC = waterMass * HeatCalculations::Cw_calGC +
+                                               grainMass * HeatCalculations::Cgrain_calGC;
+         double const equipThermalMass_calC = (mash->equipAdjust()) ? tunThermalMass_calC : 0;
 
          // r is the ratio of water and grain to take out for decoction.
-         r = ((m_w*c_w + m_g*c_g + m_e*c_e)*(tf-t1)) / ((m_w*c_w + m_g*c_g)*(boilingPoint_c-tf) + (m_w*c_w + m_g*c_g)*(tf-t1));
+         double const r = MashSimulation::decoctionFraction(boiledThermalMass_calC + equipThermalMass_calC,
+                                                            boiledThermalMass_calC,
+                                                            t1,
+                                                            tf,
+                                                            boilingPoint_c);
          if( r < 0 || r > 1 ) {
             QMessageBox::critical(this, tr("Decoction error"), tr("Something went wrong in decoction calculation.") );
             qCritical().nospace() << "Decoction: r=" << r;
             return;
          }
 
-         mashStep->setDecoctionAmount_l( r*(m_w + m_g/grainDensity) );
+         mashStep->setDecoctionAmount_l( r*(waterMass + grainMass/PhysicalConstants::grainDensity_kgL) );
       }
       else {
          tf = mashStep->stepTemp_c();
@@ -284,7 +258,7 @@ void MashWizard::wizardry() {
          tw = boilingPoint_c; // Assume adding boiling water to minimize final volume.
          MC += massWater * HeatCalculations::Cw_calGC; // Add thermal mass of last addition.
 
-         massWater = (MC*(tf-t1))/(HeatCalculations::Cw_calGC * (tw-tf));
+         massWater = MashSimulation::infusionAmount_l(tw, MC, t1, tf);
 
          mashStep->setInfuseAmount_l(massWater);
          mashStep->setInfuseTemp_c(tw);
@@ -314,7 +288,7 @@ void MashWizard::wizardry() {
       MC += massWater * HeatCalculations::Cw_calGC; // Add thermal mass of last addition.
 
 
-      tw = (MC*(tf-t1))/massWater/HeatCalculations::Cw_calGC + tf;
+      tw = MashSimulation::infusionTemp_c(massWater, MC, t1, tf);
 
       if(tw > boilingPoint_c)
          QMessageBox::information(this,
@@ -338,19 +312,17 @@ void MashWizard::wizardry() {
       int lastMashStep = steps.size()-1;
       tf = mash->spargeTemp_c();
       if( lastMashStep >= 0 )
-         t1 = steps[lastMashStep]->stepTemp_c() - 10.0; // You will lose about 10C from last step.
+         t1 = steps[lastMashStep]->stepTemp_c() - MashSimulation::spargeCooling_c; // You will lose about 10C from last step.
       else
       {
          qCritical() << "MashWizard::wizardry(): Should have had at least one mash step before getting to sparging.";
          return;
       }
-      MC = recObs->grainsInMash_kg() * HeatCalculations::Cgrain_calGC
-           + absorption_LKg * recObs->grainsInMash_kg() * HeatCalculations::Cw_calGC
-           + mash->tunWeight_kg() * mash->tunSpecificHeat_calGC();
+      MC = MashSimulation::spargeThermalMass_calC(recObs->grainsInMash_kg(), absorption_LKg, tunThermalMass_calC);
 
       massWater = spargeWater_l;
 
-      tw = (MC/(massWater*HeatCalculations::Cw_calGC))*(tf-t1) + tf;
+      tw = MashSimulation::infusionTemp_c(massWater, MC, t1, tf);
 
       if(tw > boilingPoint_c)
          QMessageBox::information(this,
@@ -46,12 +46,16 @@ bool MiscSortFilterProxyModel::lessThan(const QModelIndex &left,
    auto const columnIndex = static_cast<MiscTableModel::ColumnIndex>(left.column());
    switch (columnIndex) {
        case MiscTableModel::ColumnIndex::Inventory:
-         if (Measurement::qStringToSI(leftMisc.toString(), Measurement::PhysicalQuantity::Mass).quantity() == 0.0 &&
-             this->sortOrder() == Qt::AscendingOrder) {
-            return false;
+         {
+            auto const leftAmount  = Measurement::qStringToSI(leftMisc.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            auto const rightAmount = Measurement::qStringToSI(rightMisc.toString(),
+                                                              Measurement::PhysicalQuantity::Mass);
+            if (leftAmount.quantity() == 0.0 && this->sortOrder() == Qt::AscendingOrder) {
+               return false;
+            }
+            return leftAmount < rightAmount;
          }
-         return (Measurement::qStringToSI(leftMisc.toString(), Measurement::PhysicalQuantity::Mass) <
-                 Measurement::qStringToSI(rightMisc.toString(), Measurement::PhysicalQuantity::Mass));
 
       case MiscTableModel::ColumnIndex::Amount:
          return (Measurement::qStringToSI(leftMisc.toString(), Measurement::PhysicalQuantity::Mass) <
@@ -24,6 +24,7 @@
 #include <optional>
 
 #include <QAbstractButton>
+#include <QApplication>
 #include <QCheckBox>
 #include <QDebug>
 #include <QFileDialog>
@@ -44,7 +45,10 @@
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
+#include "model/RecipeSnapshot.h"
 #include "PersistentSettings.h"
+#include "RecipeBulkRecalc.h"
+#include "ToolTipCache.h"
 
 //
 // Anonymous namespace for constants, global variables and functions used only in this file
@@ -881,6 +885,9 @@ void OptionDialog::saveAndClose() {
    // Set the right language.
    Localization::setLanguage(this->comboBox_lang->currentData().toString());
 
+   // Units, formulae and language all show up in tooltips, so any we already generated may now be wrong
+   ToolTipCache::getInstance().invalidateAll();
+
    setVisible(false);
 }
 
@@ -901,13 +908,38 @@ bool OptionDialog::saveDefaultUnits() {
 void OptionDialog::saveFormulae() {
    bool okay = false;
 
+   IbuMethods::IbuType     const oldIbuFormula   = IbuMethods::ibuFormula;
+   ColorMethods::ColorType const oldColorFormula = ColorMethods::colorFormula;
+   double const oldMashHopAdjustment =
+      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toDouble();
+   double const oldFirstWortHopAdjustment =
+      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toDouble();
+
    int ndx = ibuFormulaComboBox->itemData(ibuFormulaComboBox->currentIndex()).toInt(&okay);
    IbuMethods::ibuFormula = static_cast<IbuMethods::IbuType>(ndx);
    ndx = colorFormulaComboBox->itemData(colorFormulaComboBox->currentIndex()).toInt(&okay);
    ColorMethods::colorFormula = static_cast<ColorMethods::ColorType>(ndx);
 
-   PersistentSettings::insert(PersistentSettings::Names::mashHopAdjustment, ibuAdjustmentMashHopDoubleSpinBox->value() / 100);
-   PersistentSettings::insert(PersistentSettings::Names::firstWortHopAdjustment, ibuAdjustmentFirstWortDoubleSpinBox->value() / 100);
+   double const mashHopAdjustment      = ibuAdjustmentMashHopDoubleSpinBox->value() / 100;
+   double const firstWortHopAdjustment = ibuAdjustmentFirstWortDoubleSpinBox->value() / 100;
+   PersistentSettings::insert(PersistentSettings::Names::mashHopAdjustment, mashHopAdjustment);
+   PersistentSettings::insert(PersistentSettings::Names::firstWortHopAdjustment, firstWortHopAdjustment);
+
+   //
+   // All of these go into the calculations for every recipe, so, if any of them changed, the values we have for every
+   // recipe (including the OG and FG stored in the DB) are out of date.
+   //
+   if (IbuMethods::ibuFormula != oldIbuFormula ||
+       ColorMethods::colorFormula != oldColorFormula ||
+       !qFuzzyCompare(mashHopAdjustment, oldMashHopAdjustment) ||
+       !qFuzzyCompare(firstWortHopAdjustment, oldFirstWortHopAdjustment)) {
+      qInfo() << Q_FUNC_INFO << "Formula settings changed, so recalculating all recipes";
+      RecipeSnapshot::calcSettingsChanged();
+      QApplication::setOverrideCursor(Qt::WaitCursor);
+      RecipeBulkRecalc::recalcAll();
+      QApplication::restoreOverrideCursor();
+   }
+   return;
 }
 
 void OptionDialog::saveLoggingSettings() {
@@ -84,6 +84,8 @@ AddSettingName(treeView_misc_headerState)        // MainWindow section
 AddSettingName(treeView_recipe_headerState)      // MainWindow section
 AddSettingName(treeView_style_headerState)       // MainWindow section
 AddSettingName(treeView_yeast_headerState)       // MainWindow section
+AddSettingName(undoMaxCommands)
+AddSettingName(undoMaxMemory_MiB)
 AddSettingName(unitSystem_color)
 AddSettingName(unitSystem_density)
 AddSettingName(unitSystem_diastaticPower)
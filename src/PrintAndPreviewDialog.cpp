@@ -19,17 +19,252 @@
  */
 #include "PrintAndPreviewDialog.h"
 
+#include <optional>
+
+#include <QAbstractTextDocumentLayout>
+#include <QCoreApplication>
 #include <QDebug>
+#include <QFile>
 #include <QFont>
 #include <QList>
 #include <QMessageBox>
+#include <QPageLayout>
+#include <QPagedPaintDevice>
 #include <QPainter>
+#include <QPdfWriter>
 #include <QPrinterInfo>
 #include <QSizePolicy>
 #include <QStandardPaths>
 #include <QTextBrowser>
+#include <QTextDocument>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
 
+#include "BrewDayFormatter.h"
+#include "Html.h"
 #include "InventoryFormatter.h"
+#include "RecipeDisplaySnapshot.h"
+
+namespace {
+   /**
+    * \brief Lays \c document out for \c device and paints it there, one page at a time, so that we never need the
+    *        whole printout rendered in memory.
+    *
+    * \param newPageFirst \c true if something has already been painted on \c device, in which case \c document starts
+    *                     on a new page
+    */
+   void paintDocument(QTextDocument & document,
+                      QPagedPaintDevice & device,
+                      QPainter & painter,
+                      bool const newPageFirst) {
+      document.documentLayout()->setPaintDevice(&device);
+      QSizeF const pageSize{static_cast<qreal>(device.width()), static_cast<qreal>(device.height())};
+      document.setPageSize(pageSize);
+      int const numPages = document.pageCount();
+      for (int pageNumber = 0; pageNumber < numPages; ++pageNumber) {
+         if (newPageFirst || pageNumber > 0) {
+            device.newPage();
+         }
+         QRectF const pageRect{QPointF{0.0, pageNumber * pageSize.height()}, pageSize};
+         painter.save();
+         painter.translate(0.0, -pageRect.top());
+         document.drawContents(&painter, pageRect);
+         painter.restore();
+      }
+      return;
+   }
+}
+
+/**
+ * \brief Everything needed to generate one printout, preview or export.  It is created (by \c createPrintJob) on the
+ *        GUI thread, which is where the Recipes and the settings live, so that the output can then be generated on
+ *        any thread.
+ *
+ *        The output is made of "parts": one per recipe, or just one for the inventory.
+ */
+struct PrintAndPreviewDialog::PrintJob {
+   PrintOutput output;
+   //! \c printContentKey() when the job was created
+   QString contentKey;
+   //! Only used for PdfFile and HtmlFile
+   QString fileName;
+   //! Only used for PdfFile
+   QPageLayout pageLayout;
+
+   //! Empty if we are printing the inventory
+   QVector<RecipeDisplaySnapshot> recipes;
+   bool includeRecipe;
+   bool includeBrewDay;
+
+   std::optional<InventoryFormatter::Snapshot> inventory;
+
+   int numParts() const {
+      return this->inventory ? 1 : this->recipes.size();
+   }
+
+   //! \brief A complete HTML document for part \c index
+   QString documentHtml(int const index) const {
+      if (this->inventory) {
+         return InventoryFormatter::createInventoryHtml(*this->inventory);
+      }
+      RecipeDisplaySnapshot const & recipe = this->recipes.at(index);
+      if (!this->includeRecipe) {
+         return BrewDayFormatter::buildHtml(recipe);
+      }
+      if (!this->includeBrewDay) {
+         return RecipeFormatter::getHtmlFormat(recipe);
+      }
+      return RecipeFormatter::buildHtmlHeader() +
+             RecipeFormatter::getHtmlBody(recipe, false) +
+             BrewDayFormatter::buildInstructionHtml(recipe) +
+             RecipeFormatter::buildHtmlFooter();
+   }
+
+   /**
+    * \brief Writes all the parts to \c out as one HTML document, a part at a time.  If there are several recipes, we
+    *        start with a table of contents.
+    */
+   void writeHtml(QTextStream & out) const {
+      if (this->numParts() == 0) {
+         return;
+      }
+      if (this->numParts() == 1) {
+         out << this->documentHtml(0);
+         return;
+      }
+
+      out << (this->includeRecipe ? RecipeFormatter::buildHtmlHeader() : BrewDayFormatter::buildHtmlHeader());
+      out << RecipeFormatter::buildHtmlTableOfContents(this->recipes);
+      for (auto const & recipe : this->recipes) {
+         out << QString("<a name=\"%1\"></a>").arg(recipe.calcInputs.name);
+         if (this->includeRecipe) {
+            out << RecipeFormatter::getHtmlBody(recipe, false);
+         } else {
+            out << BrewDayFormatter::buildTitleHtml(recipe);
+         }
+         if (this->includeBrewDay) {
+            out << BrewDayFormatter::buildInstructionHtml(recipe);
+         }
+         if (!this->includeRecipe) {
+            out << BrewDayFormatter::buildFooterHtml();
+         }
+         out << "<p></p>";
+      }
+      out << (this->includeRecipe ? RecipeFormatter::buildHtmlFooter() : Html::createFooter());
+      return;
+   }
+
+   /**
+    * \brief Generates the output.  Safe to call on any thread.
+    *
+    * \param documents For \c PreviewPages and \c PreviewHtml, receives the generated documents, which are moved to
+    *                  the GUI thread
+    *
+    * \return Empty on success, otherwise what went wrong
+    */
+   QString run(std::vector<std::unique_ptr<QTextDocument>> & documents) const {
+      QThread * guiThread = QCoreApplication::instance()->thread();
+      switch (this->output) {
+         case PrintOutput::PreviewPages:
+            for (int ii = 0; ii < this->numParts(); ++ii) {
+               auto document = std::make_unique<QTextDocument>();
+               document->setHtml(this->documentHtml(ii));
+               document->moveToThread(guiThread);
+               documents.push_back(std::move(document));
+            }
+            return "";
+
+         case PrintOutput::PreviewHtml:
+            {
+               QString html;
+               QTextStream out{&html};
+               this->writeHtml(out);
+               out.flush();
+               auto document = std::make_unique<QTextDocument>();
+               document->setHtml(html);
+               document->moveToThread(guiThread);
+               documents.push_back(std::move(document));
+            }
+            return "";
+
+         case PrintOutput::PdfFile:
+         case PrintOutput::HtmlFile:
+            break;
+      }
+
+      qDebug() << Q_FUNC_INFO << "Writing" << this->numParts() << "part(s) to" << this->fileName;
+      // We open the file ourselves, as QPdfWriter doesn't tell us if it can't
+      QFile file{this->fileName};
+      QIODevice::OpenMode const openMode =
+         this->output == PrintOutput::PdfFile ? QIODevice::WriteOnly : QIODevice::WriteOnly | QIODevice::Text;
+      if (!file.open(openMode)) {
+         qWarning() << Q_FUNC_INFO << "Could not open" << this->fileName << "for writing:" << file.errorString();
+         return file.errorString();
+      }
+
+      if (this->output == PrintOutput::PdfFile) {
+         QPdfWriter pdfWriter{&file};
+         pdfWriter.setPageLayout(this->pageLayout);
+         QPainter painter{&pdfWriter};
+         for (int ii = 0; ii < this->numParts(); ++ii) {
+            // Each part is laid out and written as we go, so we only ever have one in memory
+            QTextDocument document;
+            document.setHtml(this->documentHtml(ii));
+            paintDocument(document, pdfWriter, painter, ii > 0);
+         }
+      } else {
+         QTextStream out{&file};
+         this->writeHtml(out);
+      }
+
+      // Closing clears any earlier write error, so we have to check before as well as after
+      if (file.error() == QFileDevice::NoError) {
+         file.close();
+      }
+      if (file.error() != QFileDevice::NoError) {
+         qWarning() << Q_FUNC_INFO << "Error writing" << this->fileName << ":" << file.errorString();
+         return file.errorString();
+      }
+      qDebug() << Q_FUNC_INFO << "Finished writing" << this->fileName;
+      return "";
+   }
+};
+
+/**
+ * \brief Runs a \c PrintJob on its own thread.  Once \c QThread::finished has been emitted, \c errorMessage() says
+ *        what, if anything, went wrong, and \c takeDocuments() gives any documents generated.
+ */
+class PrintAndPreviewDialog::PrintJobThread : public QThread {
+public:
+   PrintJobThread(PrintJob && job) : QThread{}, printJob{std::move(job)} {
+      return;
+   }
+
+   PrintJob const & job() const {
+      return this->printJob;
+   }
+
+   //! \brief Empty if the job succeeded
+   QString const & errorMessage() const {
+      return this->error;
+   }
+
+   std::vector<std::unique_ptr<QTextDocument>> takeDocuments() {
+      return std::move(this->documents);
+   }
+
+protected:
+   virtual void run() override {
+      this->error = this->printJob.run(this->documents);
+      return;
+   }
+
+private:
+   PrintJob const printJob;
+   std::vector<std::unique_ptr<QTextDocument>> documents;
+   QString error;
+};
 
 /**
  * @brief Construct a new Print And Preview Dialog:: Print And Preview Dialog object
@@ -56,8 +291,6 @@ PrintAndPreviewDialog::PrintAndPreviewDialog(MainWindow * parent) : QDialog(pare
    printer->setPageLayout(layout);
 
    previewWidget = new QPrintPreviewWidget( printer , this);
-   recipeFormatter = new RecipeFormatter(this);
-   brewDayFormatter = new BrewDayFormatter(this);
    htmlDocument = new QTextBrowser(this);
 
    checkBox_Recipe->setChecked(true);
@@ -98,6 +331,12 @@ PrintAndPreviewDialog::~PrintAndPreviewDialog() = default;
 void PrintAndPreviewDialog::showEvent([[maybe_unused]] QShowEvent *e) {
    setVisible(true);
    collectRecipe();
+   // Display units etc may have changed since we were last shown, so don't reuse any documents we generated back then.
+   // (The recipe HTML itself is cached against the display settings, but we can free up whatever is in there for
+   // recipes that have since changed.)
+   RecipeFormatter::clearHtmlCache();
+   previewDocumentsKey.clear();
+   htmlPreviewDocumentKey.clear();
    currentlySelectedPageSize = printer->pageLayout().pageSize();
    int index = comboBox_PaperFormatSelector->findText(currentlySelectedPageSize.name());
    comboBox_PaperFormatSelector->setCurrentIndex(index);
@@ -110,13 +349,23 @@ void PrintAndPreviewDialog::showEvent([[maybe_unused]] QShowEvent *e) {
  * @brief Gets the Recipe from MainWindow and sets it to the respective formatters.
  */
 void PrintAndPreviewDialog::collectRecipe() {
-   selectedRecipe = mainWindow->currentRecipe();
-   recipeFormatter->setRecipe(selectedRecipe);
-   brewDayFormatter->setRecipe(selectedRecipe);
-   label_CurrentRecipe->setText((selectedRecipe != nullptr) ? selectedRecipe->name() : "NULL");
+   QStringList names;
+   for (Recipe const * recipe : recipesToPrint()) {
+      names.append(recipe->name());
+   }
+   label_CurrentRecipe->setText(names.isEmpty() ? "NULL" : names.join(", "));
    return;
 }
 
+QList<Recipe *> PrintAndPreviewDialog::recipesToPrint() const {
+   QList<Recipe *> recipes = mainWindow->selectedRecipes();
+   if (recipes.size() > 1) {
+      return recipes;
+   }
+   Recipe * current = mainWindow->currentRecipe();
+   return current ? QList<Recipe *>{current} : QList<Recipe *>{};
+}
+
 /**
  * @brief Collects the available printers on the computer and saves the list to the comboBox.
  */
@@ -287,6 +536,7 @@ void PrintAndPreviewDialog::verticalTabWidget_currentChanged([[maybe_unused]] in
 void PrintAndPreviewDialog::handlePrinting() {
    // Make it short if we are printing to paper.
    if (radioButton_OutputPaper->isChecked()) {
+      makePreviewDocumentsCurrent();
       previewWidget->print();
    } else {
       // if we are not sending to printer we need to save a file.
@@ -298,24 +548,7 @@ void PrintAndPreviewDialog::handlePrinting() {
          fileDialogFilter
          );
       qDebug() << Q_FUNC_INFO << "Filename to save: " << filename;
-      if (radioButton_OutputPDF->isChecked()) {
-         printer->setOutputFormat(QPrinter::PdfFormat);
-         printer->setOutputFileName(filename);
-         previewWidget->print();
-      } else {
-         QFile file(filename);
-         if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            qWarning() << Q_FUNC_INFO << tr("File %1 filname << could not be saved").arg(filename);
-            QMessageBox msgbox(this);
-            msgbox.setWindowTitle(tr("Error saving file"));
-            msgbox.setText(tr("Could not open the file %1 for writing! please try again with a new filename or diretory").arg(filename));
-            msgbox.exec();
-            return;
-         }
-         QTextStream ts(&file);
-         ts << htmlDocument->document()->toHtml();
-         file.close();
-      }
+      saveToFile(radioButton_OutputPDF->isChecked() ? PrintOutput::PdfFile : PrintOutput::HtmlFile, filename);
    }
    // Closing down the dialog.
    setVisible(false);
@@ -328,31 +561,18 @@ void PrintAndPreviewDialog::handlePrinting() {
  * @param checked
  */
 void PrintAndPreviewDialog::updatePreview() {
+   QString const contentKey = printContentKey();
    if (!radioButton_OutputHTML->isChecked()) {
-      previewWidget->updatePreview();
-   } else {
-      QString pDoc = "";
-
-      if (verticalTabWidget->currentIndex() == 0) {
-         bool chkRec = checkBox_Recipe->isChecked();
-         bool chkBDI = checkBox_BrewdayInstructions->isChecked();
-         if (chkRec) {
-            pDoc = recipeFormatter->getHtmlFormat();
-         }
-         if ( chkBDI && !chkRec ) {
-            pDoc += brewDayFormatter->buildHtml();
-         }
-      } else if (verticalTabWidget->currentIndex() == 1) {
-         InventoryFormatter::HtmlGenerationFlags flags  = static_cast<InventoryFormatter::HtmlGenerationFlags>(
-            checkBox_inventoryFermentables->isChecked() * InventoryFormatter::FERMENTABLES   +
-            checkBox_inventoryHops->isChecked()         * InventoryFormatter::HOPS           +
-            checkBox_inventoryYeast->isChecked()        * InventoryFormatter::YEAST          +
-            checkBox_inventoryMicellaneous->isChecked() * InventoryFormatter::MISCELLANEOUS
-         );
-         pDoc = InventoryFormatter::createInventoryHtml(flags);
+      if (contentKey == previewDocumentsKey) {
+         // Only the page layout can have changed, so we can just repaint what we have
+         previewWidget->updatePreview();
+      } else if (contentKey != pendingPreviewDocumentsKey) {
+         pendingPreviewDocumentsKey = contentKey;
+         startPrintJob(createPrintJob(PrintOutput::PreviewPages));
       }
-      // adding the generated HTML to the QTexBrowser.
-      htmlDocument->setHtml(pDoc);
+   } else if (contentKey != htmlPreviewDocumentKey && contentKey != pendingHtmlPreviewDocumentKey) {
+      pendingHtmlPreviewDocumentKey = contentKey;
+      startPrintJob(createPrintJob(PrintOutput::PreviewHtml));
    }
 
    // choose what displaywidget that should be showing depending on users choice.
@@ -489,30 +709,47 @@ void PrintAndPreviewDialog::setupPreviewWidgets() {
  * @param printer PagedPaintingDevice (QT) Printer to use for printout.
  */
 void PrintAndPreviewDialog::printDocument(QPrinter * printer) {
-   if ( mainWindow->currentRecipe() == nullptr) {
-      return;
+   // Render the pages onto the painter/printer for preview/printing.  If the documents are out of date, updatePreview
+   // will have started generating new ones, and we'll be called again once they are ready.
+   QPainter painter{printer};
+   bool firstDocument = true;
+   for (auto const & document : previewDocuments) {
+      paintDocument(*document, *printer, painter, !firstDocument);
+      firstDocument = false;
    }
-   recipeFormatter->setRecipe(mainWindow->currentRecipe());
-   // Setting up a blank page for drawing.
-   QTextBrowser textBrowser;
-   QString hDoc = "";
-   // If we are watching the Recipe tab we should print recipe stuff.
-   if (Ui_BtPrintAndPreview::verticalTabWidget->currentIndex() == 0) {
-      //
-      // TODO: All of the below code to generate the printout will be subject to change and refactoring when I get
-      //       around to making the template editor for printouts where you can save your templates and use them or
-      //       share them with other BT users.
-      //
-      hDoc += recipeFormatter->buildHtmlHeader();
-      if (checkBox_Recipe->isChecked()) {
-         hDoc += recipeFormatter->getHtmlFormat();
-      }
 
-      if (checkBox_BrewdayInstructions->isChecked()) {
-         hDoc += brewDayFormatter->buildInstructionHtml();
-      }
+   return;
+}
 
-      hDoc += recipeFormatter->buildHtmlFooter();
+QString PrintAndPreviewDialog::printContentKey() const {
+   int const checkBoxes =
+      checkBox_Recipe->isChecked()                << 0 |
+      checkBox_BrewdayInstructions->isChecked()   << 1 |
+      checkBox_inventoryFermentables->isChecked() << 2 |
+      checkBox_inventoryHops->isChecked()         << 3 |
+      checkBox_inventoryYeast->isChecked()        << 4 |
+      checkBox_inventoryMicellaneous->isChecked() << 5;
+   QString key = QString("%1:%2").arg(verticalTabWidget->currentIndex()).arg(checkBoxes);
+   for (Recipe const * recipe : recipesToPrint()) {
+      key += QString(":%1/%2").arg(reinterpret_cast<quintptr>(recipe), 0, 16).arg(recipe->generation());
+   }
+   return key;
+}
+
+PrintAndPreviewDialog::PrintJob PrintAndPreviewDialog::createPrintJob(PrintOutput const output,
+                                                                      QString const & fileName) const {
+   PrintJob job;
+   job.output         = output;
+   job.contentKey     = printContentKey();
+   job.fileName       = fileName;
+   job.pageLayout     = printer->pageLayout();
+   job.includeRecipe  = checkBox_Recipe->isChecked();
+   job.includeBrewDay = checkBox_BrewdayInstructions->isChecked();
+   // If we are watching the Recipe tab we should print recipe stuff.
+   if (verticalTabWidget->currentIndex() == 0) {
+      for (Recipe * recipe : recipesToPrint()) {
+         job.recipes.append(RecipeDisplaySnapshot::create(*recipe));
+      }
    } else if (verticalTabWidget->currentIndex() == 1) {
       InventoryFormatter::HtmlGenerationFlags flags = static_cast<InventoryFormatter::HtmlGenerationFlags>(
          checkBox_inventoryFermentables->isChecked() * InventoryFormatter::FERMENTABLES   +
@@ -520,12 +757,88 @@ void PrintAndPreviewDialog::printDocument(QPrinter * printer) {
          checkBox_inventoryYeast->isChecked()        * InventoryFormatter::YEAST          +
          checkBox_inventoryMicellaneous->isChecked() * InventoryFormatter::MISCELLANEOUS
       );
-      hDoc += InventoryFormatter::createInventoryHtml(flags);
+      job.inventory = InventoryFormatter::snapshot(flags);
+   }
+   return job;
+}
+
+void PrintAndPreviewDialog::startPrintJob(PrintJob && job) {
+   qDebug() << Q_FUNC_INFO << "Starting job for" << job.contentKey;
+   auto jobThread = new PrintJobThread{std::move(job)};
+   // This is connected before the deleteLater below, so the thread object is still there when it runs.  If we go away
+   // first, it doesn't run at all.
+   connect(jobThread, &QThread::finished, this, [this, jobThread]() { this->printJobFinished(*jobThread); });
+   // The thread object deletes itself when it's done, so it doesn't matter if we go away first
+   connect(jobThread, &QThread::finished, jobThread, &QObject::deleteLater);
+   jobThread->start();
+   return;
+}
+
+void PrintAndPreviewDialog::printJobFinished(PrintJobThread & jobThread) {
+   PrintJob const & job = jobThread.job();
+   switch (job.output) {
+      case PrintOutput::PreviewPages:
+         // Ignore the results of any job that has been overtaken by a later one
+         if (job.contentKey == pendingPreviewDocumentsKey) {
+            previewDocuments = jobThread.takeDocuments();
+            previewDocumentsKey = job.contentKey;
+            pendingPreviewDocumentsKey.clear();
+            previewWidget->updatePreview();
+         }
+         break;
+
+      case PrintOutput::PreviewHtml:
+         if (job.contentKey == pendingHtmlPreviewDocumentKey) {
+            auto documents = jobThread.takeDocuments();
+            // The browser doesn't own the document, so it has to be given the new one before we delete the old one
+            htmlDocument->setDocument(documents.front().get());
+            htmlPreviewDocument = std::move(documents.front());
+            htmlPreviewDocumentKey = job.contentKey;
+            pendingHtmlPreviewDocumentKey.clear();
+         }
+         break;
+
+      case PrintOutput::PdfFile:
+      case PrintOutput::HtmlFile:
+         {
+            QString const errorMessage = jobThread.errorMessage();
+            if (!errorMessage.isEmpty()) {
+               // We've usually closed by now, so the message belongs to the main window
+               QMessageBox msgbox(this->mainWindow);
+               msgbox.setWindowTitle(tr("Error saving file"));
+               msgbox.setText(tr("Could not save the file %1: %2").arg(job.fileName).arg(errorMessage));
+               msgbox.exec();
+            }
+            if (job.output == PrintOutput::PdfFile) {
+               emit this->pdfSaved(job.fileName, errorMessage.isEmpty());
+            }
+         }
+         break;
+   }
+   return;
+}
+
+void PrintAndPreviewDialog::makePreviewDocumentsCurrent() {
+   QString const contentKey = printContentKey();
+   if (contentKey == previewDocumentsKey) {
+      return;
    }
 
-   // Render the page onto the painter/printer for preview/printing.
-   textBrowser.setHtml(hDoc);
-   textBrowser.print(printer);
+   qDebug() << Q_FUNC_INFO << "Generating documents for" << contentKey;
+   std::vector<std::unique_ptr<QTextDocument>> documents;
+   createPrintJob(PrintOutput::PreviewPages).run(documents);
+   previewDocuments = std::move(documents);
+   previewDocumentsKey = contentKey;
+   // Anything still running is now out of date
+   pendingPreviewDocumentsKey.clear();
+   return;
+}
+
+void PrintAndPreviewDialog::saveToFile(PrintOutput const output, QString const & fileName) {
+   if (fileName.isEmpty()) {
+      return;
+   }
 
+   startPrintJob(createPrintJob(output, fileName));
    return;
 }
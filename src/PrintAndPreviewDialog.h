@@ -21,16 +21,20 @@
 #define PRINTANDPREVIEWDIALOG_H
 #include "ui_BtPrintAndPreview.h"
 
+#include <memory>
+#include <vector>
+
 #include <QDialog>
+#include <QList>
 #include <QMap>
 #include <QPageSize>
 #include <QPrinter>
 #include <QPrintPreviewWidget>
 #include <QString>
 #include <QTextBrowser>
+#include <QTextDocument>
 #include <QWidget>
 
-#include "BrewDayFormatter.h"
 #include "MainWindow.h"
 #include "model/Recipe.h"
 #include "RecipeFormatter.h"
@@ -77,6 +81,13 @@ public slots:
    void checkBoxInventoryIngredient_toggle(bool checked);
    void verticalTabWidget_currentChanged(int index);
 
+signals:
+   /**
+    * @brief Emitted (on the GUI thread) when a PDF started by \c saveToFile has been written, or has failed to be.  (In
+    *        the latter case, we will already have told the user.)
+    */
+   void pdfSaved(QString const & fileName, bool succeeded);
+
 private:
 
    /**
@@ -118,25 +129,84 @@ private:
     */
    void collectRecipe();
 
+   /**
+    * @brief The recipes to print: all the ones selected in the recipe tree if there is more than one, otherwise the
+    *        current one (if any).
+    */
+   QList<Recipe *> recipesToPrint() const;
+
    /**
     * @brief Handles the printing. sends to the selected output format.
     */
    void handlePrinting();
 
    /**
-    * @brief Updates the preview to the currently set options.
+    * @brief Updates the preview to the currently set options.  If the content has changed, the new documents are
+    *        generated on a worker thread, and the preview is updated when they are ready.
     */
    void updatePreview();
 
+   /**
+    * @brief Returns a string identifying everything that affects the content (as opposed to the page layout) of the
+    *        document to print: which tab is selected, which checkboxes are ticked, and which versions of which Recipes
+    *        we are printing.
+    */
+   QString printContentKey() const;
+
+   //! \brief What a \c PrintJob generates
+   enum class PrintOutput {
+      //! One document per recipe (or one for the inventory), for \c previewWidget and printing to paper
+      PreviewPages,
+      //! One document for \c htmlDocument
+      PreviewHtml,
+      PdfFile,
+      HtmlFile
+   };
+
+   // These are defined in PrintAndPreviewDialog.cpp
+   struct PrintJob;
+   class PrintJobThread;
+
+   /**
+    * @brief Snapshots everything needed to generate \c output for the current options.  This is the only part of
+    *        generating the output that has to be done on the GUI thread.
+    */
+   PrintJob createPrintJob(PrintOutput const output, QString const & fileName = "") const;
+
+   //! @brief Runs \c job on a worker thread.  \c printJobFinished is called (on the GUI thread) when it is done.
+   void startPrintJob(PrintJob && job);
+
+   void printJobFinished(PrintJobThread & thread);
+
+   /**
+    * @brief Makes sure \c previewDocuments are up-to-date, generating them on this thread if they are not.  This is
+    *        for when we have to print right now, rather than wait for \c updatePreview to catch up.
+    */
+   void makePreviewDocumentsCurrent();
+
+   /**
+    * @brief Writes the current document to a PDF or HTML file on a background thread, so that large documents do not
+    *        freeze the UI.  Emits \c pdfSaved when a PDF is done.
+    */
+   void saveToFile(PrintOutput const output, QString const & fileName);
+
    QPrintPreviewWidget* previewWidget;
-   RecipeFormatter* recipeFormatter;
-   BrewDayFormatter* brewDayFormatter;
    MainWindow *mainWindow;
-   Recipe *selectedRecipe;
    QPrinter * printer = nullptr;
    QMap<QString, QPageSize> PageSizeMap;
    QTextBrowser *htmlDocument;
    QPageSize currentlySelectedPageSize;
 
+   //! The documents that \c printDocument paints, and the \c printContentKey() they were generated for
+   std::vector<std::unique_ptr<QTextDocument>> previewDocuments;
+   QString previewDocumentsKey;
+   //! The document shown in \c htmlDocument, and the \c printContentKey() it was generated for
+   std::unique_ptr<QTextDocument> htmlPreviewDocument;
+   QString htmlPreviewDocumentKey;
+   //! The \c printContentKey() of the latest preview job we started, if it has not finished yet.  (We ignore the
+   //! results of any earlier ones.)
+   QString pendingPreviewDocumentsKey;
+   QString pendingHtmlPreviewDocumentKey;
+
 };
 #endif
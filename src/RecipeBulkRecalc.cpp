@@ -0,0 +1,151 @@
+/*
+ * RecipeBulkRecalc.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecipeBulkRecalc.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+
+#include "database/Database.h"
+#include "database/DbTransaction.h"
+#include "database/ObjectStoreWrapper.h"
+#include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   double secondsSince(QElapsedTimer const & timer) {
+      return static_cast<double>(timer.nsecsElapsed()) / 1.0e9;
+   }
+
+   QList<Recipe *> allRecipes() {
+      return ObjectStoreWrapper::findAllMatching<Recipe>([](Recipe const * recipe) { return !recipe->deleted(); });
+   }
+
+   std::vector<RecipeSnapshot> takeSnapshots(QList<Recipe *> const & recipes) {
+      std::vector<RecipeSnapshot> snapshots;
+      snapshots.reserve(static_cast<std::size_t>(recipes.size()));
+      for (auto recipe : recipes) {
+         snapshots.push_back(RecipeSnapshot::create(*recipe));
+      }
+      return snapshots;
+   }
+
+   std::vector<RecipeCalcs::Results> calcAll(std::vector<RecipeSnapshot> const & snapshots, int const numThreads) {
+      std::vector<RecipeCalcs::Results> results(snapshots.size());
+      ParallelFor::forEachIndex(
+         static_cast<int>(snapshots.size()),
+         [&snapshots, &results](int const ii) {
+            results[static_cast<std::size_t>(ii)] = RecipeCalcs::calcAll(snapshots[static_cast<std::size_t>(ii)]);
+         },
+         numThreads
+      );
+      return results;
+   }
+}
+
+RecipeBulkRecalc::Stats RecipeBulkRecalc::recalcAll(int const numThreads) {
+   BT_TIME_SCOPE("RecipeBulkRecalc::recalcAll");
+
+   Stats stats{0, 0, std::max(numThreads, 1), 0.0, 0.0, 0.0};
+   QElapsedTimer timer;
+
+   timer.start();
+   QList<Recipe *> const recipes = allRecipes();
+   std::vector<RecipeSnapshot> const snapshots = takeSnapshots(recipes);
+   // So we can tell if a Recipe changes between being snapshotted and having its results applied
+   std::vector<unsigned int> generations;
+   generations.reserve(snapshots.size());
+   for (auto recipe : recipes) {
+      generations.push_back(recipe->generation());
+   }
+   stats.numRecipes = recipes.size();
+   stats.snapshot_s = secondsSince(timer);
+
+   timer.restart();
+   std::vector<RecipeCalcs::Results> const results = calcAll(snapshots, stats.numThreads);
+   stats.calc_s = secondsSince(timer);
+
+   timer.restart();
+   {
+      // All the OG/FG writes go in one transaction.  (The ones in ObjectStore just become part of it -- see
+      // DbTransaction.)
+      Database & database = Database::instance();
+      QSqlDatabase connection = database.sqlDatabase();
+      DbTransaction dbTransaction{database, connection};
+      for (int ii = 0; ii < recipes.size(); ++ii) {
+         Recipe & recipe = *recipes.at(ii);
+         std::size_t const index = static_cast<std::size_t>(ii);
+         bool changed = false;
+         if (recipe.generation() == generations[index]) {
+            changed = recipe.applyCalcResults(results[index]);
+         } else {
+            // Shouldn't happen, as nothing else runs on this thread while we're calculating, but, if something did
+            // change the Recipe, our results are stale, so just redo it here.
+            qWarning() <<
+               Q_FUNC_INFO << "Recipe #" << recipe.key() << "changed during bulk recalculation; recalculating it on "
+               "its own";
+            changed = recipe.applyCalcResults(RecipeCalcs::calcAll(RecipeSnapshot::create(recipe)));
+         }
+         if (changed) {
+            ++stats.numChanged;
+         }
+      }
+      if (!dbTransaction.commit()) {
+         qCritical() << Q_FUNC_INFO << "Unable to commit recalculated values for" << stats.numRecipes << "recipes";
+      }
+   }
+   stats.writeBack_s = secondsSince(timer);
+
+   qInfo() <<
+      Q_FUNC_INFO << "Recalculated" << stats.numRecipes << "recipes (" << stats.numChanged << "changed) using" <<
+      stats.numThreads << "thread(s): snapshot" << stats.snapshot_s << "s, calculate" << stats.calc_s <<
+      "s, write back" << stats.writeBack_s << "s";
+   return stats;
+}
+
+std::vector<RecipeCalcs::Results> RecipeBulkRecalc::calculate(QList<Recipe *> const & recipes, int const numThreads) {
+   BT_TIME_SCOPE("RecipeBulkRecalc::calculate");
+   return calcAll(takeSnapshots(recipes), std::max(numThreads, 1));
+}
+
+QVector<RecipeBulkRecalc::ScalingPoint> RecipeBulkRecalc::measureScaling(int const maxThreads, int const repetitions) {
+   std::vector<RecipeSnapshot> const snapshots = takeSnapshots(allRecipes());
+
+   QVector<ScalingPoint> scaling;
+   for (int numThreads = 1; numThreads <= std::max(maxThreads, 1); ++numThreads) {
+      double fastest_s = std::numeric_limits<double>::max();
+      for (int rep = 0; rep < std::max(repetitions, 1); ++rep) {
+         QElapsedTimer timer;
+         timer.start();
+         calcAll(snapshots, numThreads);
+         fastest_s = std::min(fastest_s, secondsSince(timer));
+      }
+      double const singleThreaded_s = scaling.isEmpty() ? fastest_s : scaling.first().calc_s;
+      scaling.append(ScalingPoint{numThreads, fastest_s, fastest_s > 0.0 ? singleThreaded_s / fastest_s : 1.0});
+      qInfo() <<
+         Q_FUNC_INFO << snapshots.size() << "recipes on" << numThreads << "thread(s):" << fastest_s << "s, speedup" <<
+         scaling.last().speedup;
+   }
+   return scaling;
+}
@@ -0,0 +1,93 @@
+/*
+ * RecipeBulkRecalc.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RECIPEBULKRECALC_H
+#define RECIPEBULKRECALC_H
+#pragma once
+
+#include <vector>
+
+#include <QList>
+#include <QVector>
+
+#include "model/RecipeSnapshot.h"
+#include "utils/ParallelFor.h"
+
+class Recipe;
+
+/*!
+ * \brief Recalculate every \c Recipe in the database in one go, eg after a change to a setting (IBU or color formula,
+ *        first wort or mash hop adjustment) that affects all of them, or from the \c recalc batch job.
+ *
+ *        This is done in three stages:
+ *          - On the calling (GUI) thread, take a \c RecipeSnapshot of each Recipe
+ *          - Spread \c RecipeCalcs::calcAll across worker threads, one snapshot at a time
+ *          - Back on the calling thread, give each Recipe its results (\c Recipe::applyCalcResults), writing any
+ *            changed OG/FG to the DB in a single transaction
+ *
+ *        Only the middle stage is parallel, as model objects and DB connections belong to the GUI thread.
+ */
+namespace RecipeBulkRecalc {
+
+   //! \brief What \c recalcAll did and how long each stage took
+   struct Stats {
+      int    numRecipes;
+      //! Number of recipes where at least one calculated property changed
+      int    numChanged;
+      int    numThreads;
+      double snapshot_s;
+      double calc_s;
+      double writeBack_s;
+   };
+
+   /**
+    * \brief Recalculate all (non-deleted) recipes, as described above.  Must be called on the GUI thread.
+    *
+    * \param numThreads How many threads to use for the calculations
+    */
+   Stats recalcAll(int numThreads = ParallelFor::defaultNumThreads());
+
+   /**
+    * \brief Do the first two stages of \c recalcAll for \c recipes, but return the results instead of giving them to
+    *        the recipes.  So nothing is written to the DB and no signals are emitted, which is what we want when we
+    *        only need to read the calculated values (eg in \c StyleIndex).  Must be called on the GUI thread.
+    *
+    * \return One set of results for each of \c recipes, in the same order
+    */
+   std::vector<RecipeCalcs::Results> calculate(QList<Recipe *> const & recipes,
+                                               int numThreads = ParallelFor::defaultNumThreads());
+
+   //! \brief How long the calculation stage took with a given number of threads
+   struct ScalingPoint {
+      int    numThreads;
+      double calc_s;
+      //! Single-threaded time divided by \c calc_s
+      double speedup;
+   };
+
+   /**
+    * \brief Time the calculation stage of \c recalcAll on 1, 2, ... \c maxThreads threads, without writing anything
+    *        back, to show how well it scales on this machine.  Must be called on the GUI thread.
+    *
+    * \param repetitions How many times to run each calculation -- we take the fastest, which is the least affected by
+    *                    whatever else the machine is doing
+    */
+   QVector<ScalingPoint> measureScaling(int maxThreads = ParallelFor::defaultNumThreads(), int repetitions = 3);
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * RecipeDisplaySnapshot.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecipeDisplaySnapshot.h"
+
+#include "Localization.h"
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
+#include "model/BrewNote.h"
+#include "model/Instruction.h"
+#include "model/Mash.h"
+#include "model/MashStep.h"
+#include "model/Misc.h"
+#include "model/Recipe.h"
+#include "model/Style.h"
+#include "model/Yeast.h"
+
+RecipeDisplaySnapshot RecipeDisplaySnapshot::create(Recipe & recipe) {
+   // Do this first, so that any change from now on bumps the generation we are about to record
+   recipe.connectSignalsForCachedOutput();
+
+   RecipeDisplaySnapshot snapshot;
+   snapshot.generation = recipe.generation();
+   snapshot.calcInputs = RecipeSnapshot::create(recipe);
+   snapshot.brewer     = recipe.brewer();
+   snapshot.date       = Localization::displayDate(recipe.date());
+   snapshot.notes      = recipe.notes();
+
+   ::Style const * style = recipe.style();
+   if (style) {
+      snapshot.style = Style{style->name(), style->categoryNumber(), style->styleLetter()};
+   }
+
+   QList<::Fermentable *> const fermentables = recipe.fermentables();
+   snapshot.fermentables.reserve(fermentables.size());
+   for (auto fermentable : fermentables) {
+      snapshot.fermentables.append(Fermentable{
+         fermentable->name(),
+         fermentable->type(),
+         fermentable->amount_kg(),
+         fermentable->isMashed(),
+         fermentable->addAfterBoil(),
+         fermentable->yield_pct(),
+         fermentable->color_srm()
+      });
+   }
+
+   // RecipeSnapshot::create takes the hops in the same order, which is what makes calcIndex work
+   QList<::Hop *> const hops = recipe.hops();
+   snapshot.hops.reserve(hops.size());
+   for (int ii = 0; ii < hops.size(); ++ii) {
+      ::Hop const * hop = hops.at(ii);
+      snapshot.hops.append(Hop{
+         hop->name(),
+         hop->use(),
+         hop->form(),
+         hop->alpha_pct(),
+         hop->amount_kg(),
+         hop->time_min(),
+         ii
+      });
+   }
+
+   for (auto misc : recipe.miscs()) {
+      snapshot.miscs.append(Misc{
+         misc->name(),
+         misc->typeStringTr(),
+         misc->useStringTr(),
+         misc->amount(),
+         misc->amountIsWeight(),
+         misc->time()
+      });
+   }
+
+   for (auto yeast : recipe.yeasts()) {
+      snapshot.yeasts.append(Yeast{
+         yeast->name(),
+         yeast->typeStringTr(),
+         yeast->formStringTr(),
+         yeast->amount(),
+         yeast->amountIsWeight(),
+         yeast->addToSecondary()
+      });
+   }
+
+   ::Mash const * mash = recipe.mash();
+   if (mash) {
+      for (auto const & step : mash->mashSteps()) {
+         snapshot.mashSteps.append(MashStep{
+            step->name(),
+            step->typeStringTr(),
+            step->isInfusion(),
+            step->isDecoction(),
+            step->infuseAmount_l(),
+            step->infuseTemp_c(),
+            step->decoctionAmount_l(),
+            step->stepTemp_c(),
+            step->stepTime_min()
+         });
+      }
+   }
+
+   for (auto instruction : recipe.instructions()) {
+      snapshot.instructions.append(Instruction{
+         instruction->name(),
+         instruction->directions(),
+         instruction->interval(),
+         instruction->reagents()
+      });
+   }
+
+   for (auto brewNote : recipe.brewNotes()) {
+      snapshot.brewNotes.append(BrewNote{
+         brewNote->brewDate_short(),
+         brewNote->fermentDate_short(),
+         brewNote->sg(),
+         brewNote->volumeIntoBK_l(),
+         brewNote->strikeTemp_c(),
+         brewNote->mashFinTemp_c(),
+         brewNote->calculateEffIntoBK_pct(),
+         brewNote->calculateOg(),
+         brewNote->og(),
+         brewNote->postBoilVolume_l(),
+         brewNote->volumeIntoFerm_l(),
+         brewNote->calculateBrewHouseEff_pct(),
+         brewNote->calculateABV_pct(),
+         brewNote->fg(),
+         brewNote->finalVolume_l(),
+         brewNote->calculateActualABV_pct()
+      });
+   }
+
+   // Name the formulas the calculations will actually use, ie the ones captured in calcInputs
+   snapshot.ibuFormulaName   = IbuMethods::ibuFormulaName(snapshot.calcInputs.ibuFormula);
+   snapshot.colorFormulaName = ColorMethods::colorFormulaName(snapshot.calcInputs.colorFormula);
+
+   return snapshot;
+}
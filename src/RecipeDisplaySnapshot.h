@@ -0,0 +1,171 @@
+/*
+ * RecipeDisplaySnapshot.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RECIPEDISPLAYSNAPSHOT_H
+#define RECIPEDISPLAYSNAPSHOT_H
+#pragma once
+
+#include <optional>
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "measurement/Measurement.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/RecipeSnapshot.h"
+
+class Recipe;
+
+/*!
+ * \class RecipeDisplaySnapshot
+ *
+ * \brief Plain-value copy of everything about a \c Recipe that goes into its formatted (HTML) output -- ie what
+ *        \c RecipeFormatter and \c BrewDayFormatter print -- together with the display settings in force when it was
+ *        taken.
+ *
+ *        Like \c RecipeSnapshot (which it contains, for the calculated values), it has to be created on the GUI thread,
+ *        but can then be formatted on any thread.  This is what lets us build print previews, PDFs and HTML exports on
+ *        worker threads.
+ */
+struct RecipeDisplaySnapshot {
+   struct Style {
+      QString name;
+      QString categoryNumber;
+      QString styleLetter;
+   };
+
+   struct Fermentable {
+      QString             name;
+      ::Fermentable::Type type;
+      double              amount_kg;
+      bool                isMashed;
+      bool                addAfterBoil;
+      double              yield_pct;
+      double              color_srm;
+   };
+
+   struct Hop {
+      QString     name;
+      ::Hop::Use  use;
+      ::Hop::Form form;
+      double      alpha_pct;
+      double      amount_kg;
+      double      time_min;
+      //! Where this hop is in \c calcInputs.hops, and so in \c RecipeCalcs::Results::hopIbus
+      int         calcIndex;
+   };
+
+   struct Misc {
+      QString name;
+      QString typeName;
+      QString useName;
+      double  amount;
+      bool    amountIsWeight;
+      double  time_min;
+   };
+
+   struct Yeast {
+      QString name;
+      QString typeName;
+      QString formName;
+      double  amount;
+      bool    amountIsWeight;
+      bool    addToSecondary;
+   };
+
+   struct MashStep {
+      QString name;
+      QString typeName;
+      bool    isInfusion;
+      bool    isDecoction;
+      double  infuseAmount_l;
+      double  infuseTemp_c;
+      double  decoctionAmount_l;
+      double  stepTemp_c;
+      double  stepTime_min;
+   };
+
+   struct Instruction {
+      QString        name;
+      QString        directions;
+      double         interval_min;
+      QList<QString> reagents;
+   };
+
+   //! \brief The measured values, and the ones \c BrewNote calculates from them
+   struct BrewNote {
+      QString brewDate;
+      QString fermentDate;
+      double  sg;
+      double  volumeIntoBK_l;
+      double  strikeTemp_c;
+      double  mashFinTemp_c;
+      double  effIntoBK_pct;
+      double  projectedOg;
+      double  og;
+      double  postBoilVolume_l;
+      double  volumeIntoFerm_l;
+      double  brewhouseEff_pct;
+      double  projectedAbv_pct;
+      double  fg;
+      double  finalVolume_l;
+      double  actualAbv_pct;
+   };
+
+   /**
+    * \brief Take a snapshot of \c recipe.  This reads model objects and settings, so must be called on the GUI thread.
+    *
+    *        Formatted output is usually cached against \c Recipe::generation() (which we record in the snapshot), so
+    *        this also calls \c Recipe::connectSignalsForCachedOutput.
+    */
+   static RecipeDisplaySnapshot create(Recipe & recipe);
+
+   //! \c Recipe::generation() when the snapshot was taken
+   unsigned int generation;
+
+   //! Everything needed to work out the calculated values (OG, IBU, etc) with \c RecipeCalcs::calcAll
+   RecipeSnapshot calcInputs;
+
+   QString brewer;
+   //! Already formatted for display
+   QString date;
+   QString notes;
+
+   std::optional<Style>  style;
+   //! In the same order as \c Recipe::fermentables()
+   QVector<Fermentable>  fermentables;
+   //! In the same order as \c Recipe::hops()
+   QVector<Hop>          hops;
+   QVector<Misc>         miscs;
+   QVector<Yeast>        yeasts;
+   //! Empty if the recipe has no mash
+   QVector<MashStep>     mashSteps;
+   QVector<Instruction>  instructions;
+   QVector<BrewNote>     brewNotes;
+
+   //
+   // Display settings
+   //
+   Measurement::DisplayUnitSystems displayUnitSystems;
+   QString ibuFormulaName;
+   QString colorFormulaName;
+};
+
+#endif
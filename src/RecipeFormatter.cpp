@@ -20,9 +20,17 @@
  */
 #include "RecipeFormatter.h"
 
+#include <array>
+#include <initializer_list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 #include <QClipboard>
 #include <QDebug>
 #include <QHBoxLayout>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QObject>
 #include <QPrintDialog>
 #include <QPrinter>
@@ -30,6 +38,7 @@
 #include <QStringList>
 #include <QTextDocument>
 #include <QVBoxLayout>
+#include <QVector>
 
 #include "Html.h"
 #include "Localization.h"
@@ -46,10 +55,13 @@
 #include "model/Mash.h"
 #include "model/MashStep.h"
 #include "model/Misc.h"
+#include "model/RecipeSnapshot.h"
 #include "model/Style.h"
 #include "model/Water.h"
 #include "model/Yeast.h"
 #include "PersistentSettings.h"
+#include "RecipeDisplaySnapshot.h"
+#include "utils/Instrumentation.h"
 
 namespace {
    //! Get the maximum number of characters in a list of strings.
@@ -136,6 +148,103 @@ namespace {
       return sorted;
    }
 
+   /**
+    * \brief One row of a tooltip table, which has two label/value pairs
+    */
+   struct ToolTipRow {
+      QString leftLabel;
+      QString leftValue;
+      QString rightLabel;
+      QString rightValue;
+   };
+
+   /**
+    * \brief All tooltips share the same skeleton, so we build the fixed parts of it once.  In particular, this means we
+    *        only read the stylesheet resource once, rather than every time the mouse hovers over something.
+    *
+    *        Note that the multi-argument form of \c QString::arg does all its substitutions in a single pass, so it is
+    *        both quicker than chaining \c arg calls and immune to values that themselves contain "%1" etc.
+    */
+   QString const & toolTipHeader() {
+      static QString const header = QString(
+         "<html><head><style type=\"text/css\">%1</style></head>"
+         "<body><div id=\"headerdiv\"><table id=\"tooltip\">"
+      ).arg(Html::getCss(":/css/tooltip.css"));
+      return header;
+   }
+   QString const toolTipCaptionTemplate{"<caption>%1</caption>"};
+   QString const toolTipRowTemplate{
+      "<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>"
+      "<td class=\"left\">%3</td><td class=\"value\">%4</td></tr>"
+   };
+   QString const toolTipFooter{"</table></body></html>"};
+
+   //! Fill in the tooltip template with a caption and some rows
+   QString makeToolTip(QString const & caption, std::initializer_list<ToolTipRow> rows) {
+      QString const & header = toolTipHeader();
+      QString toolTip;
+      toolTip.reserve(header.size() + 128 * static_cast<int>(rows.size() + 1));
+      toolTip += header;
+      toolTip += toolTipCaptionTemplate.arg(caption);
+      for (auto const & row : rows) {
+         toolTip += toolTipRowTemplate.arg(row.leftLabel, row.leftValue, row.rightLabel, row.rightValue);
+      }
+      toolTip += toolTipFooter;
+      return toolTip;
+   }
+
+
+   /**
+    * \brief The sections that make up the HTML view of a Recipe.  Each is generated by one of the static
+    *        build...Html() member functions of \c RecipeFormatter::impl.
+    */
+   enum class HtmlSection {
+      StatTable,
+      Fermentables,
+      Hops,
+      Miscs,
+      Yeasts,
+      Mash,
+      Notes,
+      Instructions,
+      BrewNotes
+   };
+   constexpr std::size_t numHtmlSections = static_cast<std::size_t>(HtmlSection::BrewNotes) + 1;
+
+   /**
+    * \brief The sections we have already generated for a Recipe, and what they were generated from: the
+    *        \c Recipe::generation() and the display settings.
+    */
+   struct CachedHtmlSections {
+      explicit CachedHtmlSections(RecipeDisplaySnapshot const & recipe) : generation{recipe.generation},
+                                                                         displayUnitSystems{recipe.displayUnitSystems},
+                                                                         ibuFormulaName{recipe.ibuFormulaName},
+                                                                         colorFormulaName{recipe.colorFormulaName},
+                                                                         sections{} {
+         return;
+      }
+
+      bool isFor(RecipeDisplaySnapshot const & recipe) const {
+         return this->generation         == recipe.generation         &&
+                this->displayUnitSystems == recipe.displayUnitSystems &&
+                this->ibuFormulaName     == recipe.ibuFormulaName     &&
+                this->colorFormulaName   == recipe.colorFormulaName;
+      }
+
+      unsigned int                    generation;
+      Measurement::DisplayUnitSystems displayUnitSystems;
+      QString                         ibuFormulaName;
+      QString                         colorFormulaName;
+      std::array<std::optional<QString>, numHtmlSections> sections;
+   };
+
+   //
+   // HTML is built on worker threads (see PrintAndPreviewDialog and BatchJobs), so the cache is shared between them,
+   // keyed by Recipe key.  We only hold the mutex to look things up and store them, never whilst generating HTML.
+   //
+   QMutex htmlSectionCacheMutex;
+   std::unordered_map<int, CachedHtmlSections> htmlSectionCache;
+
 }
 
 
@@ -146,8 +255,9 @@ public:
    /**
     * Constructor
     */
-   impl() : textSeparator{nullptr},
-            rec{nullptr} {
+   impl(RecipeFormatter & self) : self{self},
+                                  textSeparator{nullptr},
+                                  rec{nullptr} {
       return;
    }
 
@@ -212,22 +322,96 @@ public:
       return ret;
    }
 
-   //! Get an HTML view.
-   QString getHtmlFormat() {
-      QString pDoc = this->buildHtmlHeader();
-      pDoc += this->buildStatTableHtml();
-      pDoc += this->buildFermentableTableHtml();
-      pDoc += this->buildHopsTableHtml();
-      pDoc += this->buildMiscTableHtml();
-      pDoc += this->buildYeastTableHtml();
-      pDoc += this->buildMashTableHtml();
-      pDoc += this->buildNotesHtml();
-      pDoc += this->buildInstructionTableHtml();
-      pDoc += this->buildBrewNotesHtml();
-
-      pDoc += this->buildHtmlFooter();
-
-      return pDoc;
+   /**
+    * \brief Builds one section of the HTML for \c recipe.  Only the snapshot is used, so this is safe on any thread.
+    *
+    * \param calcs The results of \c RecipeCalcs::calcAll for \c recipe.calcInputs
+    */
+   static QString buildSectionHtml(HtmlSection const section,
+                                   RecipeDisplaySnapshot const & recipe,
+                                   RecipeCalcs::Results const & calcs) {
+      switch (section) {
+         case HtmlSection::StatTable   : return impl::buildStatTableHtml       (recipe, calcs);
+         case HtmlSection::Fermentables: return impl::buildFermentableTableHtml(recipe, calcs);
+         case HtmlSection::Hops        : return impl::buildHopsTableHtml       (recipe, calcs);
+         case HtmlSection::Miscs       : return impl::buildMiscTableHtml       (recipe);
+         case HtmlSection::Yeasts      : return impl::buildYeastTableHtml      (recipe);
+         case HtmlSection::Mash        : return impl::buildMashTableHtml       (recipe);
+         case HtmlSection::Notes       : return impl::buildNotesHtml           (recipe);
+         case HtmlSection::Instructions: return impl::buildInstructionTableHtml(recipe);
+         case HtmlSection::BrewNotes   : return impl::buildBrewNotesHtml       (recipe);
+         // In C++ we have to have a default case even though the above is exhaustive
+         default: break;
+      }
+      // It's a coding error if we get here
+      Q_ASSERT(false);
+      return "";
+   }
+
+   /**
+    * \brief Appends the requested sections of \c recipe to \c doc, reusing the ones we generated last time if the
+    *        Recipe (and the display settings) have not changed since.  This saves a lot of work when the same Recipe is
+    *        printed in different ways (with and without brew day instructions, to the preview and then to a PDF, etc).
+    *
+    *        Safe to call on any thread.
+    */
+   static void appendSectionsHtml(QString & doc,
+                                  RecipeDisplaySnapshot const & recipe,
+                                  std::initializer_list<HtmlSection> sections) {
+      // Recipes that are not (yet) in the DB don't have a unique key, so we can't cache anything for them
+      bool const cacheable = recipe.calcInputs.key > 0;
+      std::vector<HtmlSection> const wanted{sections};
+
+      std::vector<std::optional<QString>> sectionsHtml(wanted.size());
+      if (cacheable) {
+         QMutexLocker locker{&htmlSectionCacheMutex};
+         auto const cached = htmlSectionCache.find(recipe.calcInputs.key);
+         if (cached != htmlSectionCache.end() && cached->second.isFor(recipe)) {
+            for (std::size_t ii = 0; ii < wanted.size(); ++ii) {
+               sectionsHtml[ii] = cached->second.sections[static_cast<std::size_t>(wanted[ii])];
+            }
+         }
+      }
+
+      // Build whatever we didn't find, outside the mutex so that other threads can carry on
+      std::optional<RecipeCalcs::Results> calcs;
+      bool builtAny = false;
+      for (std::size_t ii = 0; ii < wanted.size(); ++ii) {
+         if (!sectionsHtml[ii]) {
+            if (!calcs) {
+               calcs = RecipeCalcs::calcAll(recipe.calcInputs);
+            }
+            sectionsHtml[ii] = impl::buildSectionHtml(wanted[ii], recipe, *calcs);
+            builtAny = true;
+         }
+      }
+
+      if (cacheable && builtAny) {
+         QMutexLocker locker{&htmlSectionCacheMutex};
+         auto cached = htmlSectionCache.find(recipe.calcInputs.key);
+         if (cached == htmlSectionCache.end() || !cached->second.isFor(recipe)) {
+            cached = htmlSectionCache.insert_or_assign(recipe.calcInputs.key, CachedHtmlSections{recipe}).first;
+         }
+         for (std::size_t ii = 0; ii < wanted.size(); ++ii) {
+            cached->second.sections[static_cast<std::size_t>(wanted[ii])] = sectionsHtml[ii];
+         }
+      }
+
+      int totalSize = doc.size();
+      for (auto const & sectionHtml : sectionsHtml) {
+         totalSize += sectionHtml->size();
+      }
+      doc.reserve(totalSize);
+      for (auto const & sectionHtml : sectionsHtml) {
+         doc += *sectionHtml;
+      }
+      return;
+   }
+
+   static void clearHtmlCache() {
+      QMutexLocker locker{&htmlSectionCacheMutex};
+      htmlSectionCache.clear();
+      return;
    }
 
    QString getTextSeparator() {
@@ -244,119 +428,6 @@ public:
       return *this->textSeparator;
    }
 
-   QString buildHtmlHeader() {
-      return Html::createHeader(RecipeFormatter::tr("Recipe"), ":css/recipe.css");
-   }
-
-   QString buildStatTableHtml() {
-      QString header;
-      QString body;
-
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      Style* style = rec->style();
-
-      body += QString("<div id=\"headerdiv\">");
-      // NOTE: QTextBrowser does not support the caption tag
-      body += QString("<h1>%1 - %2 (%3%4)</h1>")
-            .arg( rec->name())
-            .arg( style ? style->name() : tr("unknown style"))
-            .arg( style ? style->categoryNumber() : tr("N/A") )
-            .arg( style ? style->styleLetter() : "" );
-
-      body += QString("<table id=\"header\">");
-      body += QString("<tr>"
-                     "<td class=\"label\">%1</td>"
-                     "<td class=\"value\">%2</td>"
-                     "</tr>")
-            .arg(tr("Brewer"))
-            .arg(rec->brewer());
-      body += QString("<tr>"
-                     "<td class=\"label\">%1</td>"
-                     "<td class=\"value \">%2</td>"
-                     "</tr>")
-            .arg(tr("Date"))
-            .arg(Localization::displayDate(rec->date()));
-      body += "</table>";
-
-      // Build the top table
-      // Build the first row: Batch Size and Boil Size.
-      // NOTE: using getBatchSize_l() and/or getBoilSize_l() only gives the
-      // *target* batch and boil size.  I think we want the actual (aka,
-      // estimated) sizes
-
-      body += "<table id=\"title\">";
-      body += QString("<tr>"
-                     "<td align=\"left\" class=\"left\">%1</td>"
-                     "<td width=\"20%\" class=\"value\">%2</td>")
-            .arg(tr("Batch Size"))
-            .arg(Measurement::displayAmount(Measurement::Amount{rec->finalVolume_l(), Measurement::Units::liters}));
-      body += QString("<td width=\"40%\" align=\"right\" class=\"right\">%1</td>"
-                     "<td class=\"value\">%2</td>"
-                     "</tr>")
-            .arg(tr("Boil Size"))
-            .arg(Measurement::displayAmount(Measurement::Amount{rec->boilVolume_l(), Measurement::Units::liters}));
-      // Second row: Boil Time and Efficiency
-      body += QString("<tr>"
-                     "<td align=\"left\" class=\"left\">%1</td>"
-                     "<td class=\"value\">%2</td>")
-            .arg(tr("Boil Time"))
-            .arg(Measurement::displayAmount(Measurement::Amount{
-                                               rec->equipment() == nullptr ? 0.0 : rec->equipment()->boilTime_min(),
-                                               Measurement::Units::minutes
-                                            }));
-      body += QString("<td align=\"right\" class=\"right\">%1</td>"
-                     "<td class=\"value\">%2</td></tr>")
-            .arg(tr("Efficiency"))
-            .arg(rec->efficiency_pct(), 0, 'f', 0);
-
-      // Third row: OG and FG
-      body += QString("<tr>"
-                     "<td align=\"left\" class=\"left\">%1</td>"
-                     "<td class=\"value\">%2</td>")
-            .arg(tr("OG"))
-            .arg(Measurement::displayAmount(Measurement::Amount{rec->og(), Measurement::Units::specificGravity}, 3));
-      body += QString("<td align=\"right\" class=\"right\">%1</td>"
-                     "<td class=\"value\">%2</td></tr>")
-            .arg(tr("FG"))
-            .arg(Measurement::displayAmount(Measurement::Amount{rec->fg(), Measurement::Units::specificGravity}, 3));
-
-      // Fourth row: ABV and Bitterness.  We need to set the bitterness string up first
-      body += QString("<tr>"
-                     "<td align=\"left\" class=\"left\">%1</td>"
-                     "<td class=\"value\">%2%</td>")
-            .arg(tr("ABV"))
-            .arg(Measurement::displayQuantity(rec->ABV_pct(), 1));
-      body += QString("<td align=\"right\" class=\"right\">%1</td>"
-                     "<td class=\"value\">%2 (%3)</td></tr>")
-            .arg(tr("IBU"))
-            .arg(Measurement::displayQuantity(rec->IBU(), 1))
-            .arg(IbuMethods::ibuFormulaName() );
-
-      // Fifth row: Color and calories.  Set up the color string first
-      body += QString("<tr>"
-                     "<td align=\"left\" class=\"left\">%1</td>"
-                     "<td class=\"value\">%2 (%3)</td>")
-            .arg(tr("Color"))
-            .arg(Measurement::displayAmount(Measurement::Amount{rec->color_srm(), Measurement::Units::srm}, 1))
-            .arg(ColorMethods::colorFormulaName());
-
-      bool displayMetricVolumes =
-         Measurement::getDisplayUnitSystem(Measurement::PhysicalQuantity::Volume) ==
-         Measurement::UnitSystems::volume_Metric;
-      body += QString("<td align=\"right\" class=\"right\">%1</td>"
-                     "<td class=\"value\">%2</td></tr>")
-            .arg(displayMetricVolumes ? tr("Estimated calories (per 33 cl)") : tr("Estimated calories (per 12 oz)"))
-            .arg(Measurement::displayQuantity(displayMetricVolumes ? rec->calories33cl() : rec->calories12oz(), 0) );
-
-      body += "</table>";
-
-      return header + body;
-
-   }
-
    QString buildStatTableTxt() {
       const int nbLines = 9;
 
@@ -409,63 +480,6 @@ public:
       return ret;
    }
 
-   QString buildFermentableTableHtml() {
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      QString ftable;
-      QList<Fermentable*> ferms = sortFermentablesByWeight(this->rec);
-
-      int size = ferms.size();
-      if ( size < 1 ) {
-         return "";
-      }
-
-      ftable = QString("<h3>%1</h3>").arg(tr("Fermentables"));
-      ftable += QString("<table id=\"fermentables\">");
-      // Set up the header row.
-      ftable += QString("<tr>"
-                        "<th align=\"left\" width=\"20%\">%1</th>"
-                        "<th align=\"left\" width=\"10%\">%2</th>"
-                        "<th align=\"left\" width=\"10%\">%3</th>"
-                        "<th align=\"left\" width=\"10%\">%4</th>"
-                        "<th align=\"left\" width=\"10%\">%5</th>"
-                        "<th align=\"left\" width=\"10%\">%6</th>"
-                        "<th align=\"left\" width=\"10%\">%7</th>"
-                        "</tr>")
-            .arg(tr("Name"))
-            .arg(tr("Type"))
-            .arg(tr("Amount"))
-            .arg(tr("Mashed"))
-            .arg(tr("Late"))
-            .arg(tr("Yield"))
-            .arg(tr("Color"));
-      // Now add a row for each fermentable
-      for(int ii = 0; ii < size; ++ii) {
-         Fermentable* ferm = ferms[ii];
-         ftable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6%</td><td>%7</td></tr>")
-               .arg(ferm->name())
-               .arg(Fermentable::typeDisplayNames[ferm->type()])
-               .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
-               .arg(ferm->isMashed() ? tr("Yes") : tr("No") )
-               .arg(ferm->addAfterBoil() ? tr("Yes") : tr("No"))
-               .arg(Measurement::displayQuantity(ferm->yield_pct(), 0) )
-               .arg(Measurement::displayAmount(Measurement::Amount{ferm->color_srm(), Measurement::Units::srm}, 1));
-      }
-      // One row for the total grain (QTextBrowser does not know the caption tag)
-      ftable += QString("<tr><td><b>%1</b></td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
-               .arg(tr("Total"))
-               .arg("&mdash;" )
-               .arg(Measurement::displayAmount(Measurement::Amount{rec->grains_kg(), Measurement::Units::kilograms}))
-               .arg("&mdash;")
-               .arg("&mdash;")
-               .arg("&mdash;")
-               .arg("&mdash;");
-      ftable += "</table>";
-      return ftable;
-   }
-
    QString buildFermentableTableTxt() {
       if (this->rec == nullptr) {
          return "";
@@ -516,53 +530,6 @@ public:
       return ret;
    }
 
-   QString buildHopsTableHtml() {
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      QList<Hop*> hops = sortHopsByTime(rec);
-
-      int size = hops.size();
-      if ( size < 1 ) {
-         return "";
-      }
-
-      QString hTable = QString("<h3>%1</h3>").arg(tr("Hops"));
-      hTable += QString("<table id=\"hops\">");
-      // Set up the header row.
-      hTable += QString("<tr>"
-                        "<th align=\"left\" width=\"20%\">%1</th>"
-                        "<th align=\"left\" width=\"10%\">%2</th>"
-                        "<th align=\"left\" width=\"10%\">%3</th>"
-                        "<th align=\"left\" width=\"10%\">%4</th>"
-                        "<th align=\"left\" width=\"10%\">%5</th>"
-                        "<th align=\"left\" width=\"10%\">%6</th>"
-                        "<th align=\"left\" width=\"10%\">%7</th>"
-                        "</tr>")
-            .arg(tr("Name"))
-            .arg(tr("Alpha"))
-            .arg(tr("Amount"))
-            .arg(tr("Use"))
-            .arg(tr("Time"))
-            .arg(tr("Form"))
-            .arg(tr("IBU"));
-
-      for(int ii = 0; ii < size; ++ii) {
-         Hop *hop = hops[ii];
-         hTable += QString("<tr><td>%1</td><td>%2%</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
-               .arg(hop->name())
-               .arg(Measurement::displayQuantity(hop->alpha_pct(), 1) )
-               .arg(Measurement::displayAmount(Measurement::Amount{hop->amount_kg(), Measurement::Units::kilograms}))
-               .arg(Hop::useDisplayNames[hop->use()])
-               .arg(Measurement::displayAmount(Measurement::Amount{hop->time_min(), Measurement::Units::minutes}))
-               .arg(Hop::formDisplayNames[hop->form()])
-               .arg(Measurement::displayQuantity(rec->ibuFromHop(hop), 1) );
-      }
-      hTable += "</table>";
-      return hTable;
-   }
-
    QString buildHopsTableTxt() {
       if (this->rec == nullptr) {
          return "";
@@ -610,51 +577,6 @@ public:
       return ret;
    }
 
-   QString buildMiscTableHtml() {
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      QList<Misc*> miscs = rec->miscs();
-      int size = miscs.size();
-      if ( size < 1 ) {
-         return "";
-      }
-
-      QString mtable = QString("<h3>%1</h3>").arg(tr("Misc"));
-      mtable += QString("<table id=\"misc\">");
-      // Set up the header row.
-      mtable += QString("<tr>"
-                        "<th align=\"left\" width=\"20%\">%1</th>"
-                        "<th align=\"left\" width=\"10%\">%2</th>"
-                        "<th align=\"left\" width=\"10%\">%3</th>"
-                        "<th align=\"left\" width=\"10%\">%4</th>"
-                        "<th align=\"left\" width=\"10%\">%5</th>"
-                        "</tr>")
-            .arg(tr("Name"))
-            .arg(tr("Type"))
-            .arg(tr("Use"))
-            .arg(tr("Amount"))
-            .arg(tr("Time"));
-      for (int ii = 0; ii < size; ++ii) {
-         Misc *misc = miscs[ii];
-
-         mtable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
-               .arg(misc->name())
-               .arg(misc->typeStringTr())
-               .arg(misc->useStringTr())
-               .arg(Measurement::displayAmount(Measurement::Amount{
-                                                  misc->amount(),
-                                                  misc->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
-                                               },
-                                               3))
-               .arg(Measurement::displayAmount(Measurement::Amount{misc->time(), Measurement::Units::minutes}));
-      }
-      mtable += "</table>";
-      return mtable;
-
-   }
-
    QString buildMiscTableTxt() {
       if (this->rec == nullptr) {
          return "";
@@ -699,60 +621,16 @@ public:
       return ret;
    }
 
-   QString buildYeastTableHtml() {
+   QString buildYeastTableTxt() {
       if (this->rec == nullptr) {
          return "";
       }
 
-      QList<Yeast*> yeasts = this->rec->yeasts();
+      QString ret = "";
+      QList<Yeast*> yeasts = rec->yeasts();
       int size = yeasts.size();
-
-      if (size < 1) {
-         return "";
-      }
-
-      QString ytable = QString("<h3>%1</h3>").arg(tr("Yeast"));
-      ytable += QString("<table id=\"yeast\">");
-      // Set up the header row.
-      ytable += QString("<tr>"
-                        "<th width=\"20%\" align=\"left\">%1</th>"
-                        "<th width=\"10%\" align=\"left\">%2</th>"
-                        "<th width=\"10%\" align=\"left\">%3</th>"
-                        "<th width=\"10%\" align=\"left\">%4</th>"
-                        "<th width=\"10%\" align=\"left\">%5</th></tr>")
-            .arg(tr("Name"))
-            .arg(tr("Type"))
-            .arg(tr("Form"))
-            .arg(tr("Amount"))
-            .arg(tr("Stage"));
-      for (int ii = 0; ii < size; ++ii) {
-         Yeast* y = yeasts[ii];
-
-         ytable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
-               .arg( y->name())
-               .arg( y->typeStringTr())
-               .arg( y->formStringTr())
-               .arg( Measurement::displayAmount(Measurement::Amount{
-                                                   y->amount(),
-                                                   y->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
-                                                },
-                                                2) )
-               .arg( y->addToSecondary() ? tr("Secondary") : tr("Primary"));
-      }
-      ytable += "</table>";
-      return ytable;
-   }
-
-   QString buildYeastTableTxt() {
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      QString ret = "";
-      QList<Yeast*> yeasts = rec->yeasts();
-      int size = yeasts.size();
-      if (size > 0) {
-         QStringList names, types, forms, amounts, stages;
+      if (size > 0) {
+         QStringList names, types, forms, amounts, stages;
 
          names.append(tr("Name"));
          types.append(tr("Type"));
@@ -786,66 +664,6 @@ public:
       return ret;
    }
 
-   QString buildMashTableHtml() {
-      if (!this->rec || !this->rec->mash()) {
-         return "";
-      }
-
-      auto mashSteps = this->rec->mash()->mashSteps();
-      if (mashSteps.size() == 0) {
-         return "";
-      }
-
-      QString mtable = QString("<h3>%1</h3>").arg(tr("Mash"));
-      mtable += "<table id=\"mash\">";
-
-      // Header row.
-      mtable += QString("<tr>"
-                        "<th align=\"left\" width=\"20%\">%1</th>"
-                        "<th align=\"left\" width=\"10%\">%2</th>"
-                        "<th align=\"left\" width=\"10%\">%3</th>"
-                        "<th align=\"left\" width=\"10%\">%4</th>"
-                        "<th align=\"left\" width=\"10%\">%5</th>"
-                        "<th align=\"left\" width=\"10%\">%6</th>"
-                        "</tr>")
-               .arg( tr("Name") )
-               .arg(tr("Type"))
-               .arg(tr("Amount"))
-               .arg(tr("Temp"))
-               .arg(tr("Target Temp"))
-               .arg(tr("Time"));
-      for (auto step : mashSteps) {
-         QString tmp = "<tr>";
-         tmp += QString("<td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td>")
-               .arg(step->name())
-               .arg(step->typeStringTr());
-
-         if (step->isInfusion()) {
-            tmp = tmp.arg(Measurement::displayAmount(Measurement::Amount{step->infuseAmount_l(),
-                                                                         Measurement::Units::liters}))
-                     .arg(Measurement::displayAmount(Measurement::Amount{step->infuseTemp_c(),
-                                                                         Measurement::Units::celsius}));
-         } else if (step->isDecoction()) {
-            tmp = tmp.arg( Measurement::displayAmount(Measurement::Amount{step->decoctionAmount_l(),
-                                                                          Measurement::Units::liters}))
-                  .arg("---");
-         } else {
-            tmp = tmp.arg( "---" ).arg("---");
-         }
-
-         tmp = tmp.arg( Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(),
-                                                                       Measurement::Units::celsius}));
-         tmp = tmp.arg( Measurement::displayAmount(Measurement::Amount{step->stepTime_min(),
-                                                                       Measurement::Units::minutes}, 0));
-
-         mtable += tmp + "</tr>";
-      }
-
-      mtable += "</table>";
-
-      return mtable;
-   }
-
    QString buildMashTableTxt() {
       if (!this->rec || !this->rec->mash()) {
          return "";
@@ -902,43 +720,6 @@ public:
       return ret;
    }
 
-   QString buildNotesHtml() {
-      if (this->rec == nullptr || rec->notes() == "") {
-         return "";
-      }
-
-      QString notes = QString("<h3>%1</h3>").arg(tr("Notes"));
-      // NOTE: (heh) Using the QTextDocument.toHtml() method doesn't really work
-      // here. So we cheat and use some newer functionality
-      notes += rec->notes().toHtmlEscaped();
-
-      return notes;
-   }
-
-   QString buildInstructionTableHtml() {
-      if (this->rec == nullptr) {
-         return "";
-      }
-
-      QList<Instruction*> instructions = this->rec->instructions();
-      int size = instructions.size();
-      if ( size < 1 ) {
-         return "";
-      }
-
-      QString itable = QString("<h3>%1</h3>").arg(tr("Instructions"));
-      itable += "<ol id=\"instruction\">";
-
-      for (int ii = 0; ii < size; ++ii) {
-         Instruction* ins = instructions[ii];
-         itable += QString("<li>%1</li>").arg( ins->directions());
-      }
-
-      itable += "</ol>";
-
-      return itable;
-   }
-
    QString buildInstructionTableTxt() {
       if (this->rec == nullptr) {
          return "";
@@ -979,47 +760,430 @@ public:
    QString buildSaltTableTxt();
    */
 
-   QString buildBrewNotesHtml() {
-      if (this->rec == nullptr) {
+   static QString buildHtmlHeader() {
+      return Html::createHeader(RecipeFormatter::tr("Recipe"), ":css/recipe.css");
+   }
+
+   static QString buildStatTableHtml(RecipeDisplaySnapshot const & recipe, RecipeCalcs::Results const & calcs) {
+      QString header;
+      QString body;
+
+      auto const & units = recipe.displayUnitSystems;
+      auto const & style = recipe.style;
+
+      body += QString("<div id=\"headerdiv\">");
+      // NOTE: QTextBrowser does not support the caption tag
+      body += QString("<h1>%1 - %2 (%3%4)</h1>")
+            .arg( recipe.calcInputs.name)
+            .arg( style ? style->name : tr("unknown style"))
+            .arg( style ? style->categoryNumber : tr("N/A") )
+            .arg( style ? style->styleLetter : "" );
+
+      body += QString("<table id=\"header\">");
+      body += QString("<tr>"
+                     "<td class=\"label\">%1</td>"
+                     "<td class=\"value\">%2</td>"
+                     "</tr>")
+            .arg(tr("Brewer"))
+            .arg(recipe.brewer);
+      body += QString("<tr>"
+                     "<td class=\"label\">%1</td>"
+                     "<td class=\"value \">%2</td>"
+                     "</tr>")
+            .arg(tr("Date"))
+            .arg(recipe.date);
+      body += "</table>";
+
+      // Build the top table
+      // Build the first row: Batch Size and Boil Size.
+      // NOTE: using getBatchSize_l() and/or getBoilSize_l() only gives the
+      // *target* batch and boil size.  I think we want the actual (aka,
+      // estimated) sizes
+
+      body += "<table id=\"title\">";
+      body += QString("<tr>"
+                     "<td align=\"left\" class=\"left\">%1</td>"
+                     "<td width=\"20%\" class=\"value\">%2</td>")
+            .arg(tr("Batch Size"))
+            .arg(units.displayAmount(Measurement::Amount{calcs.volumes.finalVolume_l, Measurement::Units::liters}));
+      body += QString("<td width=\"40%\" align=\"right\" class=\"right\">%1</td>"
+                     "<td class=\"value\">%2</td>"
+                     "</tr>")
+            .arg(tr("Boil Size"))
+            .arg(units.displayAmount(Measurement::Amount{calcs.volumes.boilVolume_l, Measurement::Units::liters}));
+      // Second row: Boil Time and Efficiency
+      body += QString("<tr>"
+                     "<td align=\"left\" class=\"left\">%1</td>"
+                     "<td class=\"value\">%2</td>")
+            .arg(tr("Boil Time"))
+            .arg(units.displayAmount(Measurement::Amount{
+                                        recipe.calcInputs.equipment ? recipe.calcInputs.equipment->boilTime_min : 0.0,
+                                        Measurement::Units::minutes
+                                     }));
+      body += QString("<td align=\"right\" class=\"right\">%1</td>"
+                     "<td class=\"value\">%2</td></tr>")
+            .arg(tr("Efficiency"))
+            .arg(recipe.calcInputs.efficiency_pct, 0, 'f', 0);
+
+      // Third row: OG and FG
+      body += QString("<tr>"
+                     "<td align=\"left\" class=\"left\">%1</td>"
+                     "<td class=\"value\">%2</td>")
+            .arg(tr("OG"))
+            .arg(units.displayAmount(Measurement::Amount{calcs.gravities.og, Measurement::Units::specificGravity}, 3));
+      body += QString("<td align=\"right\" class=\"right\">%1</td>"
+                     "<td class=\"value\">%2</td></tr>")
+            .arg(tr("FG"))
+            .arg(units.displayAmount(Measurement::Amount{calcs.gravities.fg, Measurement::Units::specificGravity}, 3));
+
+      // Fourth row: ABV and Bitterness.  We need to set the bitterness string up first
+      body += QString("<tr>"
+                     "<td align=\"left\" class=\"left\">%1</td>"
+                     "<td class=\"value\">%2%</td>")
+            .arg(tr("ABV"))
+            .arg(Measurement::displayQuantity(calcs.ABV_pct, 1));
+      body += QString("<td align=\"right\" class=\"right\">%1</td>"
+                     "<td class=\"value\">%2 (%3)</td></tr>")
+            .arg(tr("IBU"))
+            .arg(Measurement::displayQuantity(calcs.IBU, 1))
+            .arg(recipe.ibuFormulaName);
+
+      // Fifth row: Color and calories.  Set up the color string first
+      body += QString("<tr>"
+                     "<td align=\"left\" class=\"left\">%1</td>"
+                     "<td class=\"value\">%2 (%3)</td>")
+            .arg(tr("Color"))
+            .arg(units.displayAmount(Measurement::Amount{calcs.color_srm, Measurement::Units::srm}, 1))
+            .arg(recipe.colorFormulaName);
+
+      bool displayMetricVolumes =
+         units.get(Measurement::PhysicalQuantity::Volume) == Measurement::UnitSystems::volume_Metric;
+      body += QString("<td align=\"right\" class=\"right\">%1</td>"
+                     "<td class=\"value\">%2</td></tr>")
+            .arg(displayMetricVolumes ? tr("Estimated calories (per 33 cl)") : tr("Estimated calories (per 12 oz)"))
+            // Calories are calculated per 12 oz, so this is the same conversion as Recipe::calories33cl
+            .arg(Measurement::displayQuantity(displayMetricVolumes ? calcs.calories * 3.3 / 3.55 : calcs.calories, 0));
+
+      body += "</table>";
+
+      return header + body;
+
+   }
+
+   static QString buildFermentableTableHtml(RecipeDisplaySnapshot const & recipe, RecipeCalcs::Results const & calcs) {
+      QVector<RecipeDisplaySnapshot::Fermentable> ferms = recipe.fermentables;
+      int size = ferms.size();
+      if ( size < 1 ) {
          return "";
       }
+      // Same order as fermentablesLessThanByWeight
+      std::sort(ferms.begin(),
+                ferms.end(),
+                [](RecipeDisplaySnapshot::Fermentable const & lhs, RecipeDisplaySnapshot::Fermentable const & rhs) {
+                   if (qFuzzyCompare(lhs.amount_kg, rhs.amount_kg)) {
+                      return lhs.name < rhs.name;
+                   }
+                   return lhs.amount_kg > rhs.amount_kg;
+                });
+
+      auto const & units = recipe.displayUnitSystems;
+
+      QString ftable = QString("<h3>%1</h3>").arg(tr("Fermentables"));
+      ftable += QString("<table id=\"fermentables\">");
+      // Set up the header row.
+      ftable += QString("<tr>"
+                        "<th align=\"left\" width=\"20%\">%1</th>"
+                        "<th align=\"left\" width=\"10%\">%2</th>"
+                        "<th align=\"left\" width=\"10%\">%3</th>"
+                        "<th align=\"left\" width=\"10%\">%4</th>"
+                        "<th align=\"left\" width=\"10%\">%5</th>"
+                        "<th align=\"left\" width=\"10%\">%6</th>"
+                        "<th align=\"left\" width=\"10%\">%7</th>"
+                        "</tr>")
+            .arg(tr("Name"))
+            .arg(tr("Type"))
+            .arg(tr("Amount"))
+            .arg(tr("Mashed"))
+            .arg(tr("Late"))
+            .arg(tr("Yield"))
+            .arg(tr("Color"));
+      // Now add a row for each fermentable
+      for (auto const & ferm : ferms) {
+         ftable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6%</td><td>%7</td></tr>")
+               .arg(ferm.name)
+               .arg(Fermentable::typeDisplayNames[ferm.type])
+               .arg(units.displayAmount(Measurement::Amount{ferm.amount_kg, Measurement::Units::kilograms}))
+               .arg(ferm.isMashed ? tr("Yes") : tr("No") )
+               .arg(ferm.addAfterBoil ? tr("Yes") : tr("No"))
+               .arg(Measurement::displayQuantity(ferm.yield_pct, 0) )
+               .arg(units.displayAmount(Measurement::Amount{ferm.color_srm, Measurement::Units::srm}, 1));
+      }
+      // One row for the total grain (QTextBrowser does not know the caption tag)
+      ftable += QString("<tr><td><b>%1</b></td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
+               .arg(tr("Total"))
+               .arg("&mdash;" )
+               .arg(units.displayAmount(Measurement::Amount{calcs.grains_kg, Measurement::Units::kilograms}))
+               .arg("&mdash;")
+               .arg("&mdash;")
+               .arg("&mdash;")
+               .arg("&mdash;");
+      ftable += "</table>";
+      return ftable;
+   }
+
+   static QString buildHopsTableHtml(RecipeDisplaySnapshot const & recipe, RecipeCalcs::Results const & calcs) {
+      QVector<RecipeDisplaySnapshot::Hop> hops = recipe.hops;
+      int size = hops.size();
+      if ( size < 1 ) {
+         return "";
+      }
+      // Same order as hopLessThanByTime
+      std::sort(hops.begin(),
+                hops.end(),
+                [](RecipeDisplaySnapshot::Hop const & lhs, RecipeDisplaySnapshot::Hop const & rhs) {
+                   if (lhs.use == rhs.use) {
+                      if (lhs.time_min == rhs.time_min) {
+                         return lhs.name < rhs.name;
+                      }
+                      return lhs.time_min > rhs.time_min;
+                   }
+                   return lhs.use < rhs.use;
+                });
+
+      auto const & units = recipe.displayUnitSystems;
+
+      QString hTable = QString("<h3>%1</h3>").arg(tr("Hops"));
+      hTable += QString("<table id=\"hops\">");
+      // Set up the header row.
+      hTable += QString("<tr>"
+                        "<th align=\"left\" width=\"20%\">%1</th>"
+                        "<th align=\"left\" width=\"10%\">%2</th>"
+                        "<th align=\"left\" width=\"10%\">%3</th>"
+                        "<th align=\"left\" width=\"10%\">%4</th>"
+                        "<th align=\"left\" width=\"10%\">%5</th>"
+                        "<th align=\"left\" width=\"10%\">%6</th>"
+                        "<th align=\"left\" width=\"10%\">%7</th>"
+                        "</tr>")
+            .arg(tr("Name"))
+            .arg(tr("Alpha"))
+            .arg(tr("Amount"))
+            .arg(tr("Use"))
+            .arg(tr("Time"))
+            .arg(tr("Form"))
+            .arg(tr("IBU"));
+
+      for (auto const & hop : hops) {
+         hTable += QString("<tr><td>%1</td><td>%2%</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td></tr>")
+               .arg(hop.name)
+               .arg(Measurement::displayQuantity(hop.alpha_pct, 1) )
+               .arg(units.displayAmount(Measurement::Amount{hop.amount_kg, Measurement::Units::kilograms}))
+               .arg(Hop::useDisplayNames[hop.use])
+               .arg(units.displayAmount(Measurement::Amount{hop.time_min, Measurement::Units::minutes}))
+               .arg(Hop::formDisplayNames[hop.form])
+               .arg(Measurement::displayQuantity(calcs.hopIbus.value(hop.calcIndex), 1) );
+      }
+      hTable += "</table>";
+      return hTable;
+   }
+
+   static QString buildMiscTableHtml(RecipeDisplaySnapshot const & recipe) {
+      int size = recipe.miscs.size();
+      if ( size < 1 ) {
+         return "";
+      }
+
+      auto const & units = recipe.displayUnitSystems;
+
+      QString mtable = QString("<h3>%1</h3>").arg(tr("Misc"));
+      mtable += QString("<table id=\"misc\">");
+      // Set up the header row.
+      mtable += QString("<tr>"
+                        "<th align=\"left\" width=\"20%\">%1</th>"
+                        "<th align=\"left\" width=\"10%\">%2</th>"
+                        "<th align=\"left\" width=\"10%\">%3</th>"
+                        "<th align=\"left\" width=\"10%\">%4</th>"
+                        "<th align=\"left\" width=\"10%\">%5</th>"
+                        "</tr>")
+            .arg(tr("Name"))
+            .arg(tr("Type"))
+            .arg(tr("Use"))
+            .arg(tr("Amount"))
+            .arg(tr("Time"));
+      for (auto const & misc : recipe.miscs) {
+         mtable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
+               .arg(misc.name)
+               .arg(misc.typeName)
+               .arg(misc.useName)
+               .arg(units.displayAmount(
+                  Measurement::Amount{
+                     misc.amount,
+                     misc.amountIsWeight ? Measurement::Units::kilograms : Measurement::Units::liters
+                  },
+                  3
+               ))
+               .arg(units.displayAmount(Measurement::Amount{misc.time_min, Measurement::Units::minutes}));
+      }
+      mtable += "</table>";
+      return mtable;
+
+   }
+
+   static QString buildYeastTableHtml(RecipeDisplaySnapshot const & recipe) {
+      int size = recipe.yeasts.size();
+      if (size < 1) {
+         return "";
+      }
+
+      auto const & units = recipe.displayUnitSystems;
+
+      QString ytable = QString("<h3>%1</h3>").arg(tr("Yeast"));
+      ytable += QString("<table id=\"yeast\">");
+      // Set up the header row.
+      ytable += QString("<tr>"
+                        "<th width=\"20%\" align=\"left\">%1</th>"
+                        "<th width=\"10%\" align=\"left\">%2</th>"
+                        "<th width=\"10%\" align=\"left\">%3</th>"
+                        "<th width=\"10%\" align=\"left\">%4</th>"
+                        "<th width=\"10%\" align=\"left\">%5</th></tr>")
+            .arg(tr("Name"))
+            .arg(tr("Type"))
+            .arg(tr("Form"))
+            .arg(tr("Amount"))
+            .arg(tr("Stage"));
+      for (auto const & y : recipe.yeasts) {
+         ytable += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
+               .arg( y.name)
+               .arg( y.typeName)
+               .arg( y.formName)
+               .arg( units.displayAmount(
+                  Measurement::Amount{
+                     y.amount,
+                     y.amountIsWeight ? Measurement::Units::kilograms : Measurement::Units::liters
+                  },
+                  2
+               ) )
+               .arg( y.addToSecondary ? tr("Secondary") : tr("Primary"));
+      }
+      ytable += "</table>";
+      return ytable;
+   }
+
+   static QString buildMashTableHtml(RecipeDisplaySnapshot const & recipe) {
+      if (recipe.mashSteps.size() == 0) {
+         return "";
+      }
+
+      auto const & units = recipe.displayUnitSystems;
+
+      QString mtable = QString("<h3>%1</h3>").arg(tr("Mash"));
+      mtable += "<table id=\"mash\">";
 
+      // Header row.
+      mtable += QString("<tr>"
+                        "<th align=\"left\" width=\"20%\">%1</th>"
+                        "<th align=\"left\" width=\"10%\">%2</th>"
+                        "<th align=\"left\" width=\"10%\">%3</th>"
+                        "<th align=\"left\" width=\"10%\">%4</th>"
+                        "<th align=\"left\" width=\"10%\">%5</th>"
+                        "<th align=\"left\" width=\"10%\">%6</th>"
+                        "</tr>")
+               .arg( tr("Name") )
+               .arg(tr("Type"))
+               .arg(tr("Amount"))
+               .arg(tr("Temp"))
+               .arg(tr("Target Temp"))
+               .arg(tr("Time"));
+      for (auto const & step : recipe.mashSteps) {
+         QString tmp = "<tr>";
+         tmp += QString("<td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td>")
+               .arg(step.name)
+               .arg(step.typeName);
+
+         if (step.isInfusion) {
+            tmp = tmp.arg(units.displayAmount(Measurement::Amount{step.infuseAmount_l, Measurement::Units::liters}))
+                     .arg(units.displayAmount(Measurement::Amount{step.infuseTemp_c, Measurement::Units::celsius}));
+         } else if (step.isDecoction) {
+            tmp = tmp.arg( units.displayAmount(Measurement::Amount{step.decoctionAmount_l, Measurement::Units::liters}))
+                  .arg("---");
+         } else {
+            tmp = tmp.arg( "---" ).arg("---");
+         }
+
+         tmp = tmp.arg( units.displayAmount(Measurement::Amount{step.stepTemp_c, Measurement::Units::celsius}));
+         tmp = tmp.arg( units.displayAmount(Measurement::Amount{step.stepTime_min, Measurement::Units::minutes}, 0));
+
+         mtable += tmp + "</tr>";
+      }
+
+      mtable += "</table>";
+
+      return mtable;
+   }
+
+   static QString buildNotesHtml(RecipeDisplaySnapshot const & recipe) {
+      if (recipe.notes == "") {
+         return "";
+      }
+
+      QString notes = QString("<h3>%1</h3>").arg(tr("Notes"));
+      // NOTE: (heh) Using the QTextDocument.toHtml() method doesn't really work
+      // here. So we cheat and use some newer functionality
+      notes += recipe.notes.toHtmlEscaped();
+
+      return notes;
+   }
+
+   static QString buildInstructionTableHtml(RecipeDisplaySnapshot const & recipe) {
+      int size = recipe.instructions.size();
+      if ( size < 1 ) {
+         return "";
+      }
+
+      QString itable = QString("<h3>%1</h3>").arg(tr("Instructions"));
+      itable += "<ol id=\"instruction\">";
+
+      for (auto const & ins : recipe.instructions) {
+         itable += QString("<li>%1</li>").arg( ins.directions);
+      }
+
+      itable += "</ol>";
+
+      return itable;
+   }
+
+   static QString buildBrewNotesHtml(RecipeDisplaySnapshot const & recipe) {
       QString bnTable = "";
-      QList<BrewNote*> brewNotes = rec->brewNotes();
-      int size = brewNotes.size();
+      int size = recipe.brewNotes.size();
       if ( size < 1 ) {
          return bnTable;
       }
 
-      for(int ii = 0; ii < size; ++ii) {
-         BrewNote* note = brewNotes[ii];
+      auto const & units = recipe.displayUnitSystems;
 
-         bnTable += QString("<h2>%1 %2</h2>").arg(tr("Brew Date")).arg(note->brewDate_short());
+      for (auto const & note : recipe.brewNotes) {
+         bnTable += QString("<h2>%1 %2</h2>").arg(tr("Brew Date")).arg(note.brewDate);
 
          // PREBOIL, done two-by-two
          bnTable += "<table id=\"brewnote\">";
          bnTable += QString("<caption>%1</caption>").arg(tr("Preboil"));
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("SG"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->sg(), Measurement::Units::specificGravity}, 3))
+                  .arg(units.displayAmount(Measurement::Amount{note.sg, Measurement::Units::specificGravity}, 3))
                   .arg(tr("Volume into BK"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->volumeIntoBK_l(),
-                                                                      Measurement::Units::liters}));
+                  .arg(units.displayAmount(Measurement::Amount{note.volumeIntoBK_l, Measurement::Units::liters}));
 
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("Strike Temp"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->strikeTemp_c(),
-                                                                      Measurement::Units::celsius}))
+                  .arg(units.displayAmount(Measurement::Amount{note.strikeTemp_c, Measurement::Units::celsius}))
                   .arg(tr("Final Temp"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->mashFinTemp_c(),
-                                                                      Measurement::Units::celsius}));
+                  .arg(units.displayAmount(Measurement::Amount{note.mashFinTemp_c, Measurement::Units::celsius}));
 
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2%</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("Eff into BK"))
-                  .arg(Measurement::displayQuantity(note->calculateEffIntoBK_pct(), 2))
+                  .arg(Measurement::displayQuantity(note.effIntoBK_pct, 2))
                   .arg(tr("Projected OG"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->calculateOg(),
-                                                                      Measurement::Units::specificGravity}, 3));
+                  .arg(units.displayAmount(Measurement::Amount{note.projectedOg,
+                                                               Measurement::Units::specificGravity}, 3));
          bnTable += "</table>";
 
          // POSTBOIL
@@ -1027,19 +1191,17 @@ public:
          bnTable += QString("<caption>%1</caption>").arg(tr("Postboil"));
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("OG"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->og(), Measurement::Units::specificGravity}, 3))
+                  .arg(units.displayAmount(Measurement::Amount{note.og, Measurement::Units::specificGravity}, 3))
                   .arg(tr("Postboil Volume"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->postBoilVolume_l(),
-                                                                      Measurement::Units::liters}));
+                  .arg(units.displayAmount(Measurement::Amount{note.postBoilVolume_l, Measurement::Units::liters}));
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("Volume Into Fermenter"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->volumeIntoFerm_l(),
-                                                                      Measurement::Units::liters}))
+                  .arg(units.displayAmount(Measurement::Amount{note.volumeIntoFerm_l, Measurement::Units::liters}))
                   .arg(tr("Brewhouse Eff"))
-                  .arg(Measurement::displayQuantity(note->calculateBrewHouseEff_pct(), 2));
+                  .arg(Measurement::displayQuantity(note.brewhouseEff_pct, 2));
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2%</td></tr>")
                   .arg(tr("Projected ABV"))
-                  .arg(Measurement::displayQuantity(note->calculateABV_pct(), 2));
+                  .arg(Measurement::displayQuantity(note.projectedAbv_pct, 2));
          bnTable += "</table>";
 
 
@@ -1048,15 +1210,15 @@ public:
          bnTable += QString("<caption>%1</caption>").arg(tr("Postferment"));
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("FG"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->fg(), Measurement::Units::specificGravity}, 3))
+                  .arg(units.displayAmount(Measurement::Amount{note.fg, Measurement::Units::specificGravity}, 3))
                   .arg(tr("Volume"))
-                  .arg(Measurement::displayAmount(Measurement::Amount{note->finalVolume_l(), Measurement::Units::liters}));
+                  .arg(units.displayAmount(Measurement::Amount{note.finalVolume_l, Measurement::Units::liters}));
 
          bnTable += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td><td class=\"right\">%3</td><td class=\"value\">%4</td></tr>")
                   .arg(tr("Date"))
-                  .arg(note->fermentDate_short())
+                  .arg(note.fermentDate)
                   .arg(tr("ABV"))
-                  .arg(Measurement::displayQuantity(note->calculateActualABV_pct(), 2));
+                  .arg(Measurement::displayQuantity(note.actualAbv_pct, 2));
          bnTable += "</table>";
 
       }
@@ -1064,10 +1226,11 @@ public:
       return bnTable;
    }
 
-   QString buildHtmlFooter() {
+   static QString buildHtmlFooter() {
       return "</div></body></html>";
    }
 
+   RecipeFormatter & self;
    std::unique_ptr<QString> textSeparator;
    Recipe* rec;
 
@@ -1075,7 +1238,7 @@ public:
 
 
 RecipeFormatter::RecipeFormatter(QWidget* parent) : QObject{parent},
-                                                    pimpl{std::make_unique<impl>()} {
+                                                    pimpl{std::make_unique<impl>(*this)} {
    return;
 }
 
@@ -1091,59 +1254,85 @@ void RecipeFormatter::setRecipe(Recipe* recipe) {
 
 
 
-QString RecipeFormatter::getHtmlFormat(QList<Recipe*> recipes) {
-   Recipe *current = this->pimpl->rec;
+QString RecipeFormatter::getHtmlFormat() {
+   if (this->pimpl->rec == nullptr) {
+      return "";
+   }
+   return RecipeFormatter::getHtmlFormat(RecipeDisplaySnapshot::create(*this->pimpl->rec));
+}
 
-   QString hDoc = this->pimpl->buildHtmlHeader();
+QString RecipeFormatter::getHtmlFormat(RecipeDisplaySnapshot const & recipe) {
+   BT_TIME_SCOPE("RecipeFormatter::getHtmlFormat");
 
-   // build a toc -- why do I do this to myself?
-   hDoc += "<ul>";
-   foreach ( Recipe* foo, recipes ) {
-       hDoc += QString("<li><a href=\"#%1\">%1</a></li>").arg(foo->name());
+   QString pDoc = impl::buildHtmlHeader();
+   pDoc += RecipeFormatter::getHtmlBody(recipe, false);
+   pDoc += impl::buildHtmlFooter();
+
+   return pDoc;
+}
+
+QString RecipeFormatter::getHtmlBody(RecipeDisplaySnapshot const & recipe, bool const includeInstructions) {
+   QString body;
+   if (includeInstructions) {
+      impl::appendSectionsHtml(body, recipe, {HtmlSection::StatTable,
+                                              HtmlSection::Fermentables,
+                                              HtmlSection::Hops,
+                                              HtmlSection::Miscs,
+                                              HtmlSection::Yeasts,
+                                              HtmlSection::Mash,
+                                              HtmlSection::Notes,
+                                              HtmlSection::Instructions,
+                                              HtmlSection::BrewNotes});
+   } else {
+      impl::appendSectionsHtml(body, recipe, {HtmlSection::StatTable,
+                                              HtmlSection::Fermentables,
+                                              HtmlSection::Hops,
+                                              HtmlSection::Miscs,
+                                              HtmlSection::Yeasts,
+                                              HtmlSection::Mash,
+                                              HtmlSection::Notes,
+                                              HtmlSection::BrewNotes});
    }
-   hDoc += "</ul>";
-
-   foreach (Recipe* foo, recipes) {
-      this->pimpl->rec = foo;
-      hDoc += QString("<a name=\"%1\"></a>").arg(foo->name());
-      hDoc += this->pimpl->buildStatTableHtml();
-      hDoc += this->pimpl->buildFermentableTableHtml();
-      hDoc += this->pimpl->buildHopsTableHtml();
-      hDoc += this->pimpl->buildMiscTableHtml();
-      hDoc += this->pimpl->buildYeastTableHtml();
-      hDoc += this->pimpl->buildMashTableHtml();
-      hDoc += this->pimpl->buildNotesHtml();
-      hDoc += this->pimpl->buildInstructionTableHtml();
-      hDoc += this->pimpl->buildBrewNotesHtml();
+   return body;
+}
+
+QString RecipeFormatter::getHtmlFormat(QVector<RecipeDisplaySnapshot> const & recipes) {
+   QString hDoc = impl::buildHtmlHeader();
+   hDoc += RecipeFormatter::buildHtmlTableOfContents(recipes);
+   for (auto const & recipe : recipes) {
+      hDoc += QString("<a name=\"%1\"></a>").arg(recipe.calcInputs.name);
+      hDoc += RecipeFormatter::getHtmlBody(recipe, true);
       hDoc += "<p></p>";
    }
-   hDoc += this->pimpl->buildHtmlFooter();
-
-   this->pimpl->rec = current;
+   hDoc += impl::buildHtmlFooter();
    return hDoc;
 }
 
-QString RecipeFormatter::getHtmlFormat() {
-   QString pDoc = this->pimpl->buildHtmlHeader();
-   pDoc += this->pimpl->buildStatTableHtml();
-   pDoc += this->pimpl->buildFermentableTableHtml();
-   pDoc += this->pimpl->buildHopsTableHtml();
-   pDoc += this->pimpl->buildMiscTableHtml();
-   pDoc += this->pimpl->buildYeastTableHtml();
-   pDoc += this->pimpl->buildMashTableHtml();
-   pDoc += this->pimpl->buildNotesHtml();
-   pDoc += this->pimpl->buildBrewNotesHtml();
-   pDoc += this->pimpl->buildHtmlFooter();
+QString RecipeFormatter::buildHtmlTableOfContents(QVector<RecipeDisplaySnapshot> const & recipes) {
+   // build a toc -- why do I do this to myself?
+   QString toc = "<ul>";
+   for (auto const & recipe : recipes) {
+      toc += QString("<li><a href=\"#%1\">%1</a></li>").arg(recipe.calcInputs.name);
+   }
+   toc += "</ul>";
+   return toc;
+}
 
-   return pDoc;
+void RecipeFormatter::clearHtmlCache() {
+   impl::clearHtmlCache();
+   return;
 }
 
 QString RecipeFormatter::buildHtmlHeader() {
-   return this->pimpl->buildHtmlHeader();
+   return impl::buildHtmlHeader();
 }
 
 QString RecipeFormatter::buildHtmlFooter() {
-   return this->pimpl->buildHtmlFooter();
+   return impl::buildHtmlFooter();
+}
+
+QString RecipeFormatter::getTextFormat() {
+   return this->pimpl->getTextFormat();
 }
 
 QString RecipeFormatter::getBBCodeFormat() {
@@ -1201,47 +1390,30 @@ QString RecipeFormatter::getBBCodeFormat() {
 }
 
 QString RecipeFormatter::getToolTip(Recipe* rec) {
+   BT_TIME_SCOPE("RecipeFormatter::getToolTip(Recipe)");
+
    if (rec == nullptr) {
       return "";
    }
 
    Style* style = rec->style();
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-   //body += QString("<h1>%1</h1>").arg(rec->getName()());
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1 (%2%3)</caption>")
-         .arg( style ? style->name() : tr("unknown style"))
-         .arg( style ? style->categoryNumber() : tr("N/A") )
-         .arg( style ? style->styleLetter() : "" );
-
-   // Third row: OG and FG
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("OG"))
-           .arg(Measurement::displayAmount(Measurement::Amount{rec->og(), Measurement::Units::specificGravity}, 3));
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("FG"))
-           .arg(Measurement::displayAmount(Measurement::Amount{rec->fg(), Measurement::Units::specificGravity}, 3));
-
-   // Fourth row: Color and Bitterness.
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2 (%3)</td>")
-           .arg(tr("Color"))
-           .arg(Measurement::displayAmount(Measurement::Amount{rec->color_srm(), Measurement::Units::srm}, 1))
-           .arg(ColorMethods::colorFormulaName());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2 (%3)</td></tr>")
-           .arg(tr("IBU"))
-           .arg(Measurement::displayQuantity(rec->IBU(), 1))
-           .arg(IbuMethods::ibuFormulaName() );
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      QString("%1 (%2%3)").arg(style ? style->name()           : tr("unknown style"),
+                               style ? style->categoryNumber() : tr("N/A"),
+                               style ? style->styleLetter()    : ""),
+      {
+         // First row: OG and FG
+         {tr("OG"),    Measurement::displayAmount(Measurement::Amount{rec->og(), Measurement::Units::specificGravity}, 3),
+          tr("FG"),    Measurement::displayAmount(Measurement::Amount{rec->fg(), Measurement::Units::specificGravity}, 3)},
+         // Second row: Color and Bitterness.
+         {tr("Color"), QString("%1 (%2)").arg(
+                          Measurement::displayAmount(Measurement::Amount{rec->color_srm(), Measurement::Units::srm}, 1),
+                          ColorMethods::colorFormulaName()
+                       ),
+          tr("IBU"),   QString("%1 (%2)").arg(Measurement::displayQuantity(rec->IBU(), 1), IbuMethods::ibuFormulaName())}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Style* style) {
@@ -1249,38 +1421,17 @@ QString RecipeFormatter::getToolTip(Style* style) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( style->name() );
-
-   // First row -- category and number (letter)
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Category"))
-           .arg(style->category());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2%3</td></tr>")
-           .arg(tr("Code"))
-           .arg(style->categoryNumber())
-           .arg(style->styleLetter());
-
-   // Second row: guide and type
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Guide"))
-           .arg(style->styleGuide());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Type"))
-           .arg(style->typeString());
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      style->name(),
+      {
+         // First row -- category and number (letter)
+         {tr("Category"), style->category(),
+          tr("Code"),     style->categoryNumber() + style->styleLetter()},
+         // Second row: guide and type
+         {tr("Guide"),    style->styleGuide(),
+          tr("Type"),     style->typeString()}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Equipment* kit) {
@@ -1288,29 +1439,14 @@ QString RecipeFormatter::getToolTip(Equipment* kit) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( kit->name() );
-
-   // First row -- batchsize and boil time
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Preboil"))
-           .arg(Measurement::displayAmount(Measurement::Amount{kit->boilSize_l(), Measurement::Units::liters}) );
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("BoilTime"))
-           .arg(Measurement::displayAmount(Measurement::Amount{kit->boilTime_min(), Measurement::Units::minutes}) );
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      kit->name(),
+      {
+         // First row -- batchsize and boil time
+         {tr("Preboil"),  Measurement::displayAmount(Measurement::Amount{kit->boilSize_l(),   Measurement::Units::liters }),
+          tr("BoilTime"), Measurement::displayAmount(Measurement::Amount{kit->boilTime_min(), Measurement::Units::minutes})}
+      }
+   );
 }
 
 // Once we do inventory, this needs to be fixed to show amount on hand
@@ -1319,36 +1455,17 @@ QString RecipeFormatter::getToolTip(Fermentable* ferm) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( ferm->name() );
-
-   // First row -- type and color
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Type"))
-           .arg(Fermentable::typeDisplayNames[ferm->type()]);
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Color"))
-           .arg(Measurement::displayAmount(Measurement::Amount{ferm->color_srm(), Measurement::Units::srm}, 1));
-   // Second row -- isMashed and yield?
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Mashed"))
-           .arg( ferm->isMashed() ? tr("Yes") : tr("No") );
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Yield"))
-           .arg(Measurement::displayQuantity(ferm->yield_pct(), 3));
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      ferm->name(),
+      {
+         // First row -- type and color
+         {tr("Type"),   Fermentable::typeDisplayNames[ferm->type()],
+          tr("Color"),  Measurement::displayAmount(Measurement::Amount{ferm->color_srm(), Measurement::Units::srm}, 1)},
+         // Second row -- isMashed and yield?
+         {tr("Mashed"), ferm->isMashed() ? tr("Yes") : tr("No"),
+          tr("Yield"),  Measurement::displayQuantity(ferm->yield_pct(), 3)}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Hop* hop) {
@@ -1356,37 +1473,17 @@ QString RecipeFormatter::getToolTip(Hop* hop) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( hop->name() );
-
-   // First row -- alpha and beta
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Alpha"))
-           .arg(Measurement::displayQuantity(hop->alpha_pct(), 3));
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Beta"))
-           .arg(Measurement::displayQuantity(hop->beta_pct(), 3));
-
-   // Second row -- form and use
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Form"))
-           .arg(Hop::formDisplayNames[hop->form()]);
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Use"))
-           .arg(Hop::useDisplayNames[hop->use()]);
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      hop->name(),
+      {
+         // First row -- alpha and beta
+         {tr("Alpha"), Measurement::displayQuantity(hop->alpha_pct(), 3),
+          tr("Beta"),  Measurement::displayQuantity(hop->beta_pct(), 3)},
+         // Second row -- form and use
+         {tr("Form"),  Hop::formDisplayNames[hop->form()],
+          tr("Use"),   Hop::useDisplayNames[hop->use()]}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Misc* misc) {
@@ -1394,29 +1491,14 @@ QString RecipeFormatter::getToolTip(Misc* misc) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( misc->name() );
-
-   // First row -- type and use
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Type"))
-           .arg(misc->typeStringTr());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Use"))
-           .arg(misc->useStringTr());
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      misc->name(),
+      {
+         // First row -- type and use
+         {tr("Type"), misc->typeStringTr(),
+          tr("Use"),  misc->useStringTr()}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Yeast* yeast) {
@@ -1424,45 +1506,20 @@ QString RecipeFormatter::getToolTip(Yeast* yeast) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( yeast->name() );
-
-   // First row -- type and form
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Type"))
-           .arg(yeast->typeStringTr());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Form"))
-           .arg(yeast->formStringTr());
-   // Second row -- lab and prod id
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Lab"))
-           .arg(yeast->laboratory());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Attenuation"))
-           .arg(Measurement::displayQuantity(yeast->attenuation_pct(), 3));
-
-   // third row -- atten and floc
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Id"))
-           .arg(yeast->productID());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Flocculation"))
-           .arg( yeast->flocculationStringTr());
-
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      yeast->name(),
+      {
+         // First row -- type and form
+         {tr("Type"), yeast->typeStringTr(),
+          tr("Form"), yeast->formStringTr()},
+         // Second row -- lab and attenuation
+         {tr("Lab"),  yeast->laboratory(),
+          tr("Attenuation"),  Measurement::displayQuantity(yeast->attenuation_pct(), 3)},
+         // third row -- prod id and floc
+         {tr("Id"),   yeast->productID(),
+          tr("Flocculation"), yeast->flocculationStringTr()}
+      }
+   );
 }
 
 QString RecipeFormatter::getToolTip(Water* water) {
@@ -1470,44 +1527,20 @@ QString RecipeFormatter::getToolTip(Water* water) {
       return "";
    }
 
-   // Do the style sheet first
-   QString header = "<html><head><style type=\"text/css\">";
-   header += Html::getCss(":/css/tooltip.css");
-   header += "</style></head>";
-
-   QString body   = "<body>";
-
-   body += QString("<div id=\"headerdiv\">");
-   body += QString("<table id=\"tooltip\">");
-   body += QString("<caption>%1</caption>")
-         .arg( water->name() );
-
-   // First row -- Ca and Mg
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Ca"))
-           .arg(water->calcium_ppm());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Mg"))
-           .arg(water->magnesium_ppm());
-   // Second row -- SO4 and Na
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("SO<sub>4</sub>"))
-           .arg(water->sulfate_ppm());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("Na"))
-           .arg(water->sodium_ppm());
-   // third row -- Cl and HCO3
-   body += QString("<tr><td class=\"left\">%1</td><td class=\"value\">%2</td>")
-           .arg(tr("Cl"))
-           .arg(water->chloride_ppm());
-   body += QString("<td class=\"left\">%1</td><td class=\"value\">%2</td></tr>")
-           .arg(tr("HCO<sub>3</sub>"))
-           .arg( water->bicarbonate_ppm());
-
-
-   body += "</table></body></html>";
-
-   return header + body;
+   return makeToolTip(
+      water->name(),
+      {
+         // First row -- Ca and Mg
+         {tr("Ca"),                QString::number(water->calcium_ppm()),
+          tr("Mg"),                QString::number(water->magnesium_ppm())},
+         // Second row -- SO4 and Na
+         {tr("SO<sub>4</sub>"),    QString::number(water->sulfate_ppm()),
+          tr("Na"),                QString::number(water->sodium_ppm())},
+         // third row -- Cl and HCO3
+         {tr("Cl"),                QString::number(water->chloride_ppm()),
+          tr("HCO<sub>3</sub>"),   QString::number(water->bicarbonate_ppm())}
+      }
+   );
 }
 
 void RecipeFormatter::toTextClipboard() {
@@ -31,10 +31,13 @@
 #include <QPrintDialog>
 #include <QStringList>
 #include <QTextBrowser>
+#include <QVector>
 
 #include "model/Recipe.h"
 #include "PrintAndPreviewDialog.h"
 
+struct RecipeDisplaySnapshot;
+
 /*!
  * \class RecipeFormatter
  *
@@ -52,16 +55,44 @@ public:
    //! Set the recipe to view.
    void setRecipe(Recipe* recipe);
 
+   //! Get the HTML view of the recipe set by \c setRecipe.  Must be called on the GUI thread.
    QString getHtmlFormat();
-   QString buildHtmlHeader();
-   QString buildHtmlFooter();
 
-   //! Get a whole mess of html views
-   QString getHtmlFormat(QList<Recipe*> recipes);
+   //
+   // The rest of the HTML functions work from a \c RecipeDisplaySnapshot (which has to be taken on the GUI thread) and
+   // are safe to call on any thread.
+   //
+
+   //! \brief HTML view of one recipe -- ie what \c getHtmlFormat() gives for the same recipe
+   static QString getHtmlFormat(RecipeDisplaySnapshot const & recipe);
+
+   //! \brief As \c getHtmlFormat, but without the header and footer, and optionally with the instructions
+   static QString getHtmlBody(RecipeDisplaySnapshot const & recipe, bool includeInstructions);
+
+   static QString buildHtmlHeader();
+   static QString buildHtmlFooter();
+
+   //! \brief Get a whole mess of html views, with a table of contents
+   static QString getHtmlFormat(QVector<RecipeDisplaySnapshot> const & recipes);
+
+   /**
+    * \brief The table of contents for \c getHtmlFormat(recipes), for callers that write out a lot of recipes one at a
+    *        time rather than build one big string.  Each entry links to an anchor named after the recipe.
+    */
+   static QString buildHtmlTableOfContents(QVector<RecipeDisplaySnapshot> const & recipes);
+
+   /**
+    * \brief HTML sections are cached per Recipe and regenerated when the Recipe or the display settings change.  This
+    *        throws away everything cached, eg to free up the memory.
+    */
+   static void clearHtmlCache();
 
    //! Get a BBCode view. Why is this here?
    QString getBBCodeFormat();
 
+   //! Get a plaintext view (as put on the clipboard by \c toTextClipboard)
+   QString getTextFormat();
+
    //! Generate a tooltip for a recipe
    QString getToolTip(Recipe* rec);
    QString getToolTip(Style* style);
@@ -0,0 +1,356 @@
+/*
+ * RecipeSimilarity.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecipeSimilarity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <QDebug>
+#include <QHash>
+#include <QString>
+
+#include "database/ObjectStoreWrapper.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "model/Yeast.h"
+#include "RecipeBulkRecalc.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   //
+   // Layout of the feature vector.  Anything after the last block is left as 0.
+   //
+   int constexpr statsOffset           = 0;
+   int constexpr numStats              = 5;
+   int constexpr fermentableOffset     = statsOffset + numStats;
+   int constexpr numFermentableSlots   = 16;
+   int constexpr hopOffset             = fermentableOffset + numFermentableSlots;
+   int constexpr numHopSlots           = 12;
+   int constexpr hopTimingOffset       = hopOffset + numHopSlots;
+   int constexpr numHopTimings         = 4;
+   int constexpr yeastOffset           = hopTimingOffset + numHopTimings;
+   int constexpr numYeastSlots         = 8;
+   static_assert(yeastOffset + numYeastSlots <= RecipeSimilarity::numFeatures);
+   static_assert(RecipeSimilarity::numFeatures % 8 == 0);
+
+   //
+   // How much each block counts towards the distance.  The ingredient fractions in each block add up to 1 (times the
+   // weight), so completely different grain bills are about 1.4 apart, as are beers at opposite ends of the OG range.
+   // Hops and yeast count for a bit less, as recipes with the same malt and the same numbers taste more alike than
+   // ones that just share a hop variety.
+   //
+   float constexpr fermentableWeight = 1.0f;
+   float constexpr hopWeight         = 0.7f;
+   float constexpr hopTimingWeight   = 0.5f;
+   float constexpr yeastWeight       = 0.5f;
+
+   //! Which hop timing slot a hop goes in: bittering, late boil, after the boil, dry hop
+   int hopTiming(Hop const & hop) {
+      switch (hop.use()) {
+         case Hop::Use::Mash:
+         case Hop::Use::First_Wort: return 0;
+         case Hop::Use::Boil      : return hop.time_min() >= 30.0 ? 0 : 1;
+         case Hop::Use::Aroma     : return 2;
+         case Hop::Use::Dry_Hop   : return 3;
+      }
+      return 0;
+   }
+
+   //! Slot for an ingredient, so that the same name always gets the same slot
+   int slotFor(QString const & name, int const numSlots) {
+      return static_cast<int>(qHash(name.trimmed().toLower()) % static_cast<uint>(numSlots));
+   }
+
+   /**
+    * \brief Squared distance between two feature vectors.  We add up into 8 separate totals so that the compiler can
+    *        vectorise the loop without being allowed to reorder floating point additions (ie without -ffast-math).
+    */
+   float squaredDistance(float const * lhs, float const * rhs) {
+      float partials[8] = {};
+      for (int ii = 0; ii < RecipeSimilarity::numFeatures; ii += 8) {
+         for (int jj = 0; jj < 8; ++jj) {
+            float const difference = lhs[ii + jj] - rhs[ii + jj];
+            partials[jj] += difference * difference;
+         }
+      }
+      return ((partials[0] + partials[1]) + (partials[2] + partials[3])) +
+             ((partials[4] + partials[5]) + (partials[6] + partials[7]));
+   }
+
+   bool closer(RecipeSimilarity::Match const & lhs, RecipeSimilarity::Match const & rhs) {
+      return lhs.distance < rhs.distance;
+   }
+
+   /**
+    * \brief Does the work of \c RecipeSimilarity::featuresOf, given the results of \c RecipeCalcs::calcAll for
+    *        \c recipe
+    */
+   RecipeSimilarity::FeatureVector featuresFrom(Recipe const & recipe, RecipeCalcs::Results const & results) {
+      RecipeSimilarity::FeatureVector features{};
+
+      features[statsOffset + 0] = static_cast<float>((results.gravities.og - 1.0) * 10.0);
+      features[statsOffset + 1] = static_cast<float>((results.gravities.fg - 1.0) * 30.0);
+      features[statsOffset + 2] = static_cast<float>(results.IBU       / 100.0);
+      features[statsOffset + 3] = static_cast<float>(results.color_srm /  40.0);
+      features[statsOffset + 4] = static_cast<float>(results.ABV_pct   /  12.0);
+
+      auto const fermentables = recipe.getAll<Fermentable>();
+      double totalFermentables_kg = 0.0;
+      for (auto const & fermentable : fermentables) {
+         totalFermentables_kg += fermentable->amount_kg();
+      }
+      if (totalFermentables_kg > 0.0) {
+         for (auto const & fermentable : fermentables) {
+            features[fermentableOffset + slotFor(fermentable->name(), numFermentableSlots)] +=
+               static_cast<float>(fermentableWeight * fermentable->amount_kg() / totalFermentables_kg);
+         }
+      }
+
+      auto const hops = recipe.getAll<Hop>();
+      double totalHops_kg = 0.0;
+      for (auto const & hop : hops) {
+         totalHops_kg += hop->amount_kg();
+      }
+      if (totalHops_kg > 0.0) {
+         for (auto const & hop : hops) {
+            double const fraction = hop->amount_kg() / totalHops_kg;
+            features[hopOffset       + slotFor(hop->name(), numHopSlots)] += static_cast<float>(hopWeight * fraction);
+            features[hopTimingOffset + hopTiming(*hop)] += static_cast<float>(hopTimingWeight * fraction);
+         }
+      }
+
+      auto const yeasts = recipe.getAll<Yeast>();
+      for (auto const & yeast : yeasts) {
+         features[yeastOffset + slotFor(yeast->name(), numYeastSlots)] +=
+            yeastWeight / static_cast<float>(yeasts.size());
+      }
+
+      return features;
+   }
+}
+
+// This private implementation class holds all private non-virtual members of RecipeSimilarity
+class RecipeSimilarity::impl {
+public:
+
+   /**
+    * Constructor
+    */
+   impl() = default;
+
+   /**
+    * Destructor
+    */
+   ~impl() = default;
+
+   /**
+    * \brief Bring the vectors up to date with the recipes in the ObjectStore
+    */
+   void refresh() {
+      BT_TIME_SCOPE("RecipeSimilarity::refresh");
+
+      std::vector<bool> seen(static_cast<std::size_t>(this->recipeIds.size()), false);
+      QList<Recipe *> toUpdate;
+      QVector<int>    toUpdateRows;
+      for (auto recipe : ObjectStoreWrapper::getAllRaw<Recipe>()) {
+         if (recipe->deleted() || !recipe->display()) {
+            continue;
+         }
+         int row = this->rows.value(recipe->key(), -1);
+         bool const isNew = (row < 0);
+         if (isNew) {
+            row = this->recipeIds.size();
+            this->rows.insert(recipe->key(), row);
+            this->recipeIds.append(recipe->key());
+            this->generations.append(0);
+            this->features.resize(this->features.size() + numFeatures);
+            seen.push_back(false);
+         }
+         seen[static_cast<std::size_t>(row)] = true;
+         if (!isNew && this->generations.at(row) == recipe->generation()) {
+            continue;
+         }
+         toUpdate.append(recipe);
+         toUpdateRows.append(row);
+      }
+
+      //
+      // We work out OG etc from snapshots rather than asking the recipes, as a Recipe that has not yet calculated them
+      // would do so when asked, storing its OG and FG and emitting change signals.  Doing all the changed recipes in
+      // one go (which, the first time round, is all of them) also lets the calculations run in parallel.
+      //
+      std::vector<RecipeCalcs::Results> const results = RecipeBulkRecalc::calculate(toUpdate);
+      for (int ii = 0; ii < toUpdate.size(); ++ii) {
+         Recipe const & recipe = *toUpdate.at(ii);
+         int const row = toUpdateRows.at(ii);
+         FeatureVector const recipeFeatures = featuresFrom(recipe, results[static_cast<std::size_t>(ii)]);
+         std::copy(recipeFeatures.cbegin(), recipeFeatures.cend(), this->rowFeatures(row));
+         this->generations[row] = recipe.generation();
+      }
+      int const numUpdated = toUpdate.size();
+
+      //
+      // Anything we didn't see has been deleted or hidden.  Going backwards means the row we move into each gap has
+      // already been checked.
+      //
+      for (int row = this->recipeIds.size() - 1; row >= 0; --row) {
+         if (!seen[static_cast<std::size_t>(row)]) {
+            this->removeRow(row);
+         }
+      }
+
+      if (numUpdated > 0) {
+         qDebug() << Q_FUNC_INFO << "Updated" << numUpdated << "of" << this->recipeIds.size() << "recipe vectors";
+      }
+      return;
+   }
+
+   float * rowFeatures(int const row) {
+      return this->features.data() + static_cast<std::size_t>(row) * numFeatures;
+   }
+
+   //! Move the last row into \c row
+   void removeRow(int const row) {
+      int const lastRow = this->recipeIds.size() - 1;
+      this->rows.remove(this->recipeIds.at(row));
+      if (row != lastRow) {
+         std::copy(this->rowFeatures(lastRow), this->rowFeatures(lastRow) + numFeatures, this->rowFeatures(row));
+         this->recipeIds[row] = this->recipeIds.at(lastRow);
+         this->generations[row] = this->generations.at(lastRow);
+         this->rows.insert(this->recipeIds.at(row), row);
+      }
+      this->recipeIds.removeLast();
+      this->generations.removeLast();
+      this->features.resize(this->features.size() - numFeatures);
+      return;
+   }
+
+   QVector<RecipeSimilarity::Match> nearest(float const * target, int const count, int const excludeRecipeId) const {
+      BT_TIME_SCOPE("RecipeSimilarity::nearest");
+
+      //
+      // Keep the closest so far in a max-heap, so the one to throw out when we find a closer one is always at the
+      // front.  We compare squared distances, and only take square roots of the ones we return.
+      //
+      if (count <= 0) {
+         return QVector<RecipeSimilarity::Match>{};
+      }
+      std::vector<RecipeSimilarity::Match> closest;
+      closest.reserve(static_cast<std::size_t>(count) + 1);
+      float const * rowFeatures = this->features.data();
+      for (int row = 0; row < this->recipeIds.size(); ++row, rowFeatures += numFeatures) {
+         float const distance = squaredDistance(target, rowFeatures);
+         if (static_cast<int>(closest.size()) == count && distance >= closest.front().distance) {
+            continue;
+         }
+         int const recipeId = this->recipeIds.at(row);
+         if (recipeId == excludeRecipeId) {
+            continue;
+         }
+         closest.push_back(RecipeSimilarity::Match{recipeId, distance});
+         std::push_heap(closest.begin(), closest.end(), closer);
+         if (static_cast<int>(closest.size()) > count) {
+            std::pop_heap(closest.begin(), closest.end(), closer);
+            closest.pop_back();
+         }
+      }
+      std::sort_heap(closest.begin(), closest.end(), closer);
+
+      QVector<RecipeSimilarity::Match> matches;
+      matches.reserve(static_cast<int>(closest.size()));
+      for (auto const & match : closest) {
+         matches.append(RecipeSimilarity::Match{match.recipeId, std::sqrt(match.distance)});
+      }
+      return matches;
+   }
+
+   // Member variables
+   //! One row of numFeatures floats for each recipe, one after the other
+   std::vector<float>    features;
+   QVector<int>          recipeIds;
+   //! Recipe::generation() when we last worked out the row's features
+   QVector<unsigned int> generations;
+   QHash<int, int>       rows;
+};
+
+RecipeSimilarity & RecipeSimilarity::getInstance() {
+   //
+   // As of C++11, simple "Meyers singleton" is now thread-safe -- see
+   // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
+   //
+   static RecipeSimilarity singleton;
+
+   return singleton;
+}
+
+RecipeSimilarity::RecipeSimilarity() : pimpl{std::make_unique<impl>()} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+RecipeSimilarity::~RecipeSimilarity() = default;
+
+RecipeSimilarity::FeatureVector RecipeSimilarity::featuresOf(Recipe const & recipe) {
+   return featuresFrom(recipe, RecipeCalcs::calcAll(RecipeSnapshot::create(recipe)));
+}
+
+QVector<RecipeSimilarity::Match> RecipeSimilarity::findSimilar(int const recipeId, int const count) {
+   this->pimpl->refresh();
+   int const row = this->pimpl->rows.value(recipeId, -1);
+   if (row < 0) {
+      // Eg a deleted recipe, or an old version of one.  We can still compare it with the others.
+      Recipe * recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(recipeId);
+      if (!recipe) {
+         qWarning() << Q_FUNC_INFO << "No recipe with ID" << recipeId;
+         return QVector<Match>{};
+      }
+      FeatureVector const features = featuresOf(*recipe);
+      return this->pimpl->nearest(features.data(), count, recipeId);
+   }
+
+   // Copy the row, as it's in the array we're about to search
+   FeatureVector features;
+   std::copy(this->pimpl->rowFeatures(row), this->pimpl->rowFeatures(row) + numFeatures, features.begin());
+   return this->pimpl->nearest(features.data(), count, recipeId);
+}
+
+QVector<RecipeSimilarity::Match> RecipeSimilarity::findNearest(FeatureVector const & features,
+                                                               int const count,
+                                                               int const excludeRecipeId) {
+   this->pimpl->refresh();
+   return this->pimpl->nearest(features.data(), count, excludeRecipeId);
+}
+
+int RecipeSimilarity::size() {
+   this->pimpl->refresh();
+   return this->pimpl->recipeIds.size();
+}
+
+void RecipeSimilarity::invalidateAll() {
+   qDebug() << Q_FUNC_INFO << "Discarding" << this->pimpl->recipeIds.size() << "recipe vectors";
+   this->pimpl->features.clear();
+   this->pimpl->recipeIds.clear();
+   this->pimpl->generations.clear();
+   this->pimpl->rows.clear();
+   return;
+}
@@ -0,0 +1,122 @@
+/*
+ * RecipeSimilarity.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RECIPESIMILARITY_H
+#define RECIPESIMILARITY_H
+#pragma once
+
+#include <array>
+#include <memory> // For PImpl
+
+#include <QVector>
+
+class Recipe;
+
+/*!
+ * \class RecipeSimilarity
+ *
+ * \brief Singleton that finds the recipes most like a given one, across the whole database.
+ *
+ *        Each Recipe is boiled down to a short vector of numbers (see \c featuresOf), made up of:
+ *          - its calculated OG, FG, IBU, color and ABV, each scaled so that the range of typical beers is about 1
+ *          - its grain bill: the fraction (by weight) of each fermentable
+ *          - its hop schedule: the fraction (by weight) of each hop, and of all hops used for bittering, late in the
+ *            boil, after the boil and for dry hopping
+ *          - its yeast(s)
+ *        Ingredients are told apart by name, hashed into a fixed number of slots for each kind of ingredient, so that,
+ *        eg, two recipes using "Maris Otter" get the same slot whichever copy of the Fermentable they use.  (Different
+ *        ingredients will occasionally share a slot, which just makes them count as a bit alike.)
+ *
+ *        The vectors for all (non-deleted, displayed) recipes are kept one after the other in a single array, and a
+ *        query just works out the distance from the target to every one of them and keeps the closest.  With 48
+ *        floats per recipe, that's a few milliseconds for tens of thousands of recipes, so we don't need anything
+ *        cleverer (eg an approximate nearest-neighbour index) at the sizes of database we see.
+ *
+ *        The vectors are worked out the first time they're needed and then, at the start of each query, only for
+ *        recipes whose \c Recipe::generation has changed (or that are new).  Must only be used on the GUI thread (as
+ *        it reads model objects).
+ */
+class RecipeSimilarity {
+public:
+   //! Length of each recipe's vector.  (A multiple of 8 so that distance calculations vectorise well.)
+   static constexpr int numFeatures = 48;
+   using FeatureVector = std::array<float, numFeatures>;
+
+   //! \brief One result of a query
+   struct Match {
+      int   recipeId;
+      //! Euclidean distance between the recipes' vectors: 0 means identical
+      float distance;
+   };
+
+   /**
+    * \brief Get the singleton instance
+    */
+   static RecipeSimilarity & getInstance();
+
+   ~RecipeSimilarity();
+
+   /**
+    * \brief Work out the feature vector for \c recipe, as described above.  We calculate OG etc from a snapshot of the
+    *        Recipe, rather than asking it for them, so this never makes the Recipe recalculate (and store) anything.
+    */
+   static FeatureVector featuresOf(Recipe const & recipe);
+
+   /**
+    * \brief The recipes most like the one with the supplied ID (not including itself), closest first
+    *
+    * \param count Maximum number of recipes to return
+    */
+   QVector<Match> findSimilar(int recipeId, int count = 10);
+
+   /**
+    * \brief The recipes whose vectors are closest to \c features, closest first
+    *
+    * \param excludeRecipeId Recipe to leave out of the results (eg the one \c features came from), or -1 for none
+    */
+   QVector<Match> findNearest(FeatureVector const & features, int count = 10, int excludeRecipeId = -1);
+
+   //! \brief Number of recipes in the index (after bringing it up to date)
+   int size();
+
+   /**
+    * \brief Forget all the vectors and work them out again on the next query, eg after a bulk import
+    */
+   void invalidateAll();
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   /**
+    * Private constructor as singleton
+    */
+   RecipeSimilarity();
+
+   //! No copy constructor, as never want anyone, not even our friends, to make copies of a singleton
+   RecipeSimilarity(RecipeSimilarity const&) = delete;
+   //! No assignment operator , as never want anyone, not even our friends, to make copies of a singleton.
+   RecipeSimilarity& operator=(RecipeSimilarity const&) = delete;
+   //! No move constructor
+   RecipeSimilarity(RecipeSimilarity &&) = delete;
+   //! No move assignment
+   RecipeSimilarity & operator=(RecipeSimilarity &&) = delete;
+};
+
+#endif
@@ -74,43 +74,48 @@ void ScaleRecipeTool::scale(Equipment* equip, double newEff) {
    double oldEfficiency = recObs->efficiency_pct();
    double effRatio = oldEfficiency / newEff;
 
-   this->recObs->setEquipment(equip);
-   this->recObs->setBatchSize_l(newBatchSize_l);
-   this->recObs->setBoilSize_l(equip->boilSize_l());
-   this->recObs->setEfficiency_pct(newEff);
-   this->recObs->setBoilTime_min(equip->boilTime_min());
-
-   for (auto ferm : this->recObs->fermentables()) {
-      if (!ferm->isSugar() && !ferm->isExtract()) {
-         ferm->setAmount_kg(ferm->amount_kg() * effRatio * volRatio);
-      } else {
-         ferm->setAmount_kg(ferm->amount_kg() * volRatio);
+   {
+      // Write all the changes in one go (and recalculate the recipe once) rather than after every setter call
+      Recipe::EditSession editSession{*this->recObs};
+
+      this->recObs->setEquipment(equip);
+      this->recObs->setBatchSize_l(newBatchSize_l);
+      this->recObs->setBoilSize_l(equip->boilSize_l());
+      this->recObs->setEfficiency_pct(newEff);
+      this->recObs->setBoilTime_min(equip->boilTime_min());
+
+      for (auto ferm : this->recObs->fermentables()) {
+         if (!ferm->isSugar() && !ferm->isExtract()) {
+            ferm->setAmount_kg(ferm->amount_kg() * effRatio * volRatio);
+         } else {
+            ferm->setAmount_kg(ferm->amount_kg() * volRatio);
+         }
       }
-   }
 
-   for (auto hop : this->recObs->hops()) {
-      hop->setAmount_kg(hop->amount_kg() * volRatio);
-   }
+      for (auto hop : this->recObs->hops()) {
+         hop->setAmount_kg(hop->amount_kg() * volRatio);
+      }
 
-   for (auto misc : this->recObs->miscs()) {
-      misc->setAmount( misc->amount() * volRatio);
-   }
+      for (auto misc : this->recObs->miscs()) {
+         misc->setAmount( misc->amount() * volRatio);
+      }
 
-   for (auto water : this->recObs->waters()) {
-      water->setAmount(water->amount() * volRatio);
-   }
+      for (auto water : this->recObs->waters()) {
+         water->setAmount(water->amount() * volRatio);
+      }
 
-   Mash* mash = this->recObs->mash();
-   if (mash) {
-      for (auto step : mash->mashSteps()) {
-         // Reset all these to zero so that the user
-         // will know to re-run the mash wizard.
-         step->setDecoctionAmount_l(0);
-         step->setInfuseAmount_l(0);
+      Mash* mash = this->recObs->mash();
+      if (mash) {
+         for (auto step : mash->mashSteps()) {
+            // Reset all these to zero so that the user
+            // will know to re-run the mash wizard.
+            step->setDecoctionAmount_l(0);
+            step->setInfuseAmount_l(0);
+         }
       }
-   }
 
-   // I don't think I should scale the yeasts.
+      // I don't think I should scale the yeasts.
+   }
 
    // Let the user know what happened.
    QMessageBox::information(this, tr("Recipe Scaled"),
@@ -26,6 +26,34 @@
 
 #include "Logging.h"
 
+namespace {
+   //! Any value unique among the QUndoCommand subclasses that implement mergeWith() will do
+   int constexpr simpleUndoableUpdateId = 1;
+
+   /**
+    * \brief Rough size of any heap data a QVariant is holding on to.  (Small values such as numbers and booleans are
+    *        stored inside the QVariant itself.)
+    */
+   std::size_t variantHeapSize(QVariant const & value) {
+      switch (static_cast<QMetaType::Type>(value.userType())) {
+         case QMetaType::QString:
+            return static_cast<std::size_t>(value.toString().capacity()) * sizeof(QChar);
+         case QMetaType::QByteArray:
+            return static_cast<std::size_t>(value.toByteArray().capacity());
+         case QMetaType::QStringList:
+            {
+               std::size_t size = 0;
+               for (auto const & string : value.toStringList()) {
+                  size += sizeof(QString) + static_cast<std::size_t>(string.capacity()) * sizeof(QChar);
+               }
+               return size;
+            }
+         default:
+            return 0;
+      }
+   }
+}
+
 SimpleUndoableUpdate::SimpleUndoableUpdate(QObject & updatee,
                                            BtStringConst const & propertyName,
                                            QVariant newValue,
@@ -60,6 +88,35 @@ void SimpleUndoableUpdate::undo() {
    return;
 }
 
+int SimpleUndoableUpdate::id() const {
+   return simpleUndoableUpdateId;
+}
+
+bool SimpleUndoableUpdate::mergeWith(QUndoCommand const * other) {
+   // We can only be asked to merge with something that has the same id(), which means it must be one of us
+   auto otherUpdate = static_cast<SimpleUndoableUpdate const *>(other);
+   if (&otherUpdate->updatee != &this->updatee || otherUpdate->propertyName != this->propertyName) {
+      return false;
+   }
+
+   // If either of us has children (eg an edit to a mash step's temperature that also changes its end temperature),
+   // then taking the other's new value would lose or mangle what the children do, so we stay separate.
+   if (this->childCount() != 0 || otherUpdate->childCount() != 0) {
+      return false;
+   }
+
+   // Our old value stays the same, but we now go all the way to the other update's new value
+   this->newValue = otherUpdate->newValue;
+   if (this->newValue == this->oldValue) {
+      this->setObsolete(true);
+   }
+   return true;
+}
+
+std::size_t SimpleUndoableUpdate::heldMemory_bytes() const {
+   return sizeof(*this) - sizeof(QUndoCommand) + variantHeapSize(this->oldValue) + variantHeapSize(this->newValue);
+}
+
 bool SimpleUndoableUpdate::undoOrRedo(bool const isUndo)
 {
    // This is where we call the setter for propertyName on updatee, via the magic of the Qt Property System
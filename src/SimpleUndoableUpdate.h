@@ -26,6 +26,7 @@
 #include <QUndoCommand>
 #include <QVariant>
 
+#include "BoundedUndoStack.h"
 #include "utils/BtStringConst.h"
 
 /*!
@@ -35,8 +36,12 @@
  *        By simple, we mean that there is one of them and that it is non-relational (ie can be passed and set by value).
  *        The thing being updated needs to inherit from Q_OBJECT and the field being changed needs to have been
  *        declared as a Q_PROPERTY.
+ *
+ *        Consecutive updates to the same property of the same object are merged into one (so that, eg, a run of
+ *        edits to the recipe name is undone in one go), which means we only ever hold the value from before the
+ *        first edit and the value from after the last one.  If those end up the same, the merged update is dropped.
  */
-class SimpleUndoableUpdate : public QUndoCommand {
+class SimpleUndoableUpdate : public QUndoCommand, public BoundedUndoStack::SizedCommand {
 public:
    /*!
     * \param updatee The entity (eg recipe) we are updating
@@ -63,6 +68,18 @@ public:
     */
    void undo();
 
+   //! \brief All instances share the same ID, as they can be merged if they are for the same property (see mergeWith)
+   virtual int id() const;
+
+   /**
+    * \brief If \c other is an update to the same property of the same object as us, and neither of us has any child
+    *        commands, absorb it (by taking its new value) and return \c true.  Otherwise return \c false.
+    */
+   virtual bool mergeWith(QUndoCommand const * other);
+
+   //! \brief Implements \c BoundedUndoStack::SizedCommand
+   virtual std::size_t heldMemory_bytes() const;
+
 private:
    /*!
     * \brief Undo or redo applying the update
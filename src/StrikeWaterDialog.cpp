@@ -24,36 +24,13 @@
 
 #include <Algorithms.h>
 
+#include "HeatCalculations.h"
+#include "model/MashSimulation.h"
+
 namespace {
    // From Northern Brewer ~0.38 but Jon Palmer suggest 0.41
    // to compensate for the lost to the tun even if the tun is pre-heated
    double const specificHeatBarley = 0.41;
-
-   /**
-    * \brief
-    */
-   double initialInfusionSi(double grainTemp, double targetTemp, double waterToGrain) {
-      if (waterToGrain == 0.0) {
-         return 0.0;
-      }
-      return (specificHeatBarley / waterToGrain) * (targetTemp - grainTemp) + targetTemp;
-   }
-
-   /**
-    * \brief
-    */
-   double mashInfusionSi(double initialTemp,
-                         double targetTemp,
-                         double grainWeight,
-                         double infusionWater,
-                         double mashVolume) {
-      if (infusionWater - targetTemp == 0.0) {
-         return 0.0;
-      }
-
-      return ((targetTemp - initialTemp) * (specificHeatBarley * grainWeight + mashVolume)) / (infusionWater - targetTemp);
-   }
-
 }
 
 StrikeWaterDialog::StrikeWaterDialog(QWidget* parent) : QDialog(parent) {
@@ -97,7 +74,7 @@ double StrikeWaterDialog::computeInitialInfusion() {
       return 0.0;
    }
 
-   return initialInfusionSi(grainTemp, targetMash, waterVolume / grainWeight);
+   return MashSimulation::infusionTemp_c(waterVolume, specificHeatBarley * grainWeight, grainTemp, targetMash);
 }
 
 double StrikeWaterDialog::computeMashInfusion() {
@@ -107,5 +84,7 @@ double StrikeWaterDialog::computeMashInfusion() {
    double targetMashInf = this->targetMashInfVal->toCanonical().quantity();
    double infusionWater = this->infusionWaterVal->toCanonical().quantity();
 
-   return mashInfusionSi(actualMash, targetMashInf, grainWeight, infusionWater, mashVol);
+   // The mash already has water in it, as well as the grain, to heat
+   double const thermalMass_calC = specificHeatBarley * grainWeight + mashVol * HeatCalculations::Cw_calGC;
+   return MashSimulation::infusionAmount_l(infusionWater, thermalMass_calC, actualMash, targetMashInf);
 }
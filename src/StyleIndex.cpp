@@ -0,0 +1,496 @@
+/*
+ * StyleIndex.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "StyleIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include <QDebug>
+#include <QHash>
+#include <QSet>
+
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreWrapper.h"
+#include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "model/Style.h"
+#include "RecipeBulkRecalc.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   //! The things a Style gives a range for and a Recipe has a value for
+   enum Dimension {
+      Og,
+      Fg,
+      Ibu,
+      Color,
+      Abv,
+      NumDimensions
+   };
+
+   //! One array per dimension, all indexed by the same row number
+   using Columns = std::array<QVector<double>, NumDimensions>;
+
+   //! Remove \c row from \c vector by moving the last element into its place.  (Order doesn't matter to us.)
+   template<class T> void removeRow(QVector<T> & vector, int const row) {
+      vector[row] = vector.last();
+      vector.removeLast();
+      return;
+   }
+
+   void removeRow(Columns & columns, int const row) {
+      for (auto & column : columns) {
+         removeRow(column, row);
+      }
+      return;
+   }
+
+   //! A Style that has a min and max of 0 for something hasn't specified that range, so we let anything match it
+   void appendRange(Columns & mins, Columns & maxes, Dimension const dimension, double const min, double const max) {
+      bool const unspecified = (min == 0.0 && max == 0.0);
+      mins [dimension].append(unspecified ? -std::numeric_limits<double>::infinity() : min);
+      maxes[dimension].append(unspecified ?  std::numeric_limits<double>::infinity() : max);
+      return;
+   }
+}
+
+// This private implementation class holds all private non-virtual members of StyleIndex
+class StyleIndex::impl {
+public:
+
+   /**
+    * Constructor
+    */
+   impl(StyleIndex & self) : self{self} {
+      return;
+   }
+
+   /**
+    * Destructor
+    */
+   ~impl() = default;
+
+   /**
+    * \brief Make sure everything is up to date before a query
+    */
+   void refresh() {
+      if (!this->loaded) {
+         this->load();
+      } else {
+         this->refreshStale();
+      }
+      // Anything that changes from now on needs to be signalled
+      this->changeSignalled = false;
+      return;
+   }
+
+   /**
+    * \brief Build the indexes from scratch
+    */
+   void load() {
+      BT_TIME_SCOPE("StyleIndex::load");
+
+      this->clear();
+
+      for (auto style : ObjectStoreWrapper::getAllRaw<Style>()) {
+         if (!style->deleted()) {
+            this->updateStyle(style->key(), style);
+         }
+      }
+
+      //
+      // We work out each recipe's OG etc ourselves, from snapshots, rather than asking the Recipe.  A Recipe that has
+      // not yet calculated them would do so when asked, which stores its OG and FG and emits change signals -- not
+      // something we want to happen just because, eg, the recipe tree is being filtered.  Doing all the recipes in one
+      // go also lets the calculations run in parallel.
+      //
+      QList<Recipe *> const recipes = ObjectStoreWrapper::findAllMatching<Recipe>(
+         [](Recipe const * recipe) {
+            return !recipe->deleted();
+         }
+      );
+      std::vector<RecipeCalcs::Results> const results = RecipeBulkRecalc::calculate(recipes);
+      for (int ii = 0; ii < recipes.size(); ++ii) {
+         this->updateRecipe(recipes.at(ii)->key(), recipes.at(ii), &results[static_cast<std::size_t>(ii)]);
+      }
+      for (int row = 0; row < this->recipeIds.size(); ++row) {
+         this->updateConformance(row);
+      }
+      this->staleStyles.clear();
+      this->staleRecipes.clear();
+      this->loaded = true;
+
+      qDebug() <<
+         Q_FUNC_INFO << "Indexed" << this->styleIds.size() << "styles and" << this->recipeIds.size() << "recipes";
+      return;
+   }
+
+   /**
+    * \brief Forget everything, including our connections to the objects we were watching
+    */
+   void clear() {
+      for (auto const & connection : this->styleConnections) {
+         QObject::disconnect(connection);
+      }
+      for (auto const & connection : this->recipeConnections) {
+         QObject::disconnect(connection);
+      }
+      this->styleConnections.clear();
+      this->recipeConnections.clear();
+
+      this->styleIds.clear();
+      this->styleIsMaster.clear();
+      for (auto & column : this->styleMins ) { column.clear(); }
+      for (auto & column : this->styleMaxes) { column.clear(); }
+      this->styleRows.clear();
+
+      this->recipeIds.clear();
+      this->recipeStyleIds.clear();
+      for (auto & column : this->recipeValues) { column.clear(); }
+      this->recipeConformance.clear();
+      this->recipeRows.clear();
+      this->recipesByOg.clear();
+      this->recipesByOgValid = false;
+
+      this->staleStyles.clear();
+      this->staleRecipes.clear();
+      this->loaded = false;
+      return;
+   }
+
+   /**
+    * \brief Re-read everything that has changed since the last query
+    */
+   void refreshStale() {
+      if (this->staleStyles.isEmpty() && this->staleRecipes.isEmpty()) {
+         return;
+      }
+
+      //
+      // We take the current lists of what's stale, so that anything that gets marked stale while we're working through
+      // them waits until next time.
+      //
+      QSet<int> const staleStyles  = std::exchange(this->staleStyles,  QSet<int>{});
+      QSet<int> const staleRecipes = std::exchange(this->staleRecipes, QSet<int>{});
+
+      for (int const styleId : staleStyles) {
+         Style * style = ObjectStoreWrapper::getByIdRaw<Style>(styleId);
+         this->updateStyle(styleId, (style && !style->deleted()) ? style : nullptr);
+      }
+      for (int const recipeId : staleRecipes) {
+         Recipe * recipe = ObjectStoreWrapper::getByIdRaw<Recipe>(recipeId);
+         if (recipe && !recipe->deleted()) {
+            // As in load(), we calculate the values rather than have the Recipe do it
+            RecipeCalcs::Results const results = RecipeCalcs::calcAll(RecipeSnapshot::create(*recipe));
+            this->updateRecipe(recipeId, recipe, &results);
+         } else {
+            this->updateRecipe(recipeId, nullptr, nullptr);
+         }
+      }
+
+      //
+      // A recipe's conformance needs recalculating if it changed or if its style did.  (There are never many styles
+      // changing at once, so a pass over the recipes' style IDs is cheaper than keeping a reverse lookup up to date.)
+      //
+      for (int row = 0; row < this->recipeIds.size(); ++row) {
+         if (staleRecipes.contains(this->recipeIds.at(row)) || staleStyles.contains(this->recipeStyleIds.at(row))) {
+            this->updateConformance(row);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Add, update or (if \c style is null) remove the entry for \c styleId
+    */
+   void updateStyle(int const styleId, Style * style) {
+      int const row = this->styleRows.value(styleId, -1);
+      if (row >= 0) {
+         this->removeStyleRow(row);
+      }
+      if (!style) {
+         QObject::disconnect(this->styleConnections.take(styleId));
+         return;
+      }
+
+      this->styleRows.insert(styleId, this->styleIds.size());
+      this->styleIds.append(styleId);
+      // Copies of a Style used in recipes have the Style they were copied from as parent
+      this->styleIsMaster.append(style->display() && style->getParentKey() <= 0);
+      appendRange(this->styleMins, this->styleMaxes, Og   , style->ogMin()       , style->ogMax()       );
+      appendRange(this->styleMins, this->styleMaxes, Fg   , style->fgMin()       , style->fgMax()       );
+      appendRange(this->styleMins, this->styleMaxes, Ibu  , style->ibuMin()      , style->ibuMax()      );
+      appendRange(this->styleMins, this->styleMaxes, Color, style->colorMin_srm(), style->colorMax_srm());
+      appendRange(this->styleMins, this->styleMaxes, Abv  , style->abvMin_pct()  , style->abvMax_pct()  );
+
+      if (!this->styleConnections.contains(styleId)) {
+         this->styleConnections.insert(
+            styleId,
+            QObject::connect(style,
+                             &NamedEntity::changed,
+                             &this->self,
+                             [this, styleId]() { this->markStyleStale(styleId); })
+         );
+      }
+      return;
+   }
+
+   void removeStyleRow(int const row) {
+      this->styleRows.remove(this->styleIds.at(row));
+      removeRow(this->styleIds, row);
+      removeRow(this->styleIsMaster, row);
+      removeRow(this->styleMins, row);
+      removeRow(this->styleMaxes, row);
+      if (row < this->styleIds.size()) {
+         this->styleRows.insert(this->styleIds.at(row), row);
+      }
+      return;
+   }
+
+   /**
+    * \brief Add, update or (if \c recipe is null) remove the entry for \c recipeId.  Caller is responsible for then
+    *        calling \c updateConformance.
+    *
+    * \param results The calculated values for \c recipe (ignored if \c recipe is null)
+    */
+   void updateRecipe(int const recipeId, Recipe * recipe, RecipeCalcs::Results const * results) {
+      int const row = this->recipeRows.value(recipeId, -1);
+      if (row >= 0) {
+         this->removeRecipeRow(row);
+      }
+      this->recipesByOgValid = false;
+      if (!recipe) {
+         QObject::disconnect(this->recipeConnections.take(recipeId));
+         return;
+      }
+
+      this->recipeRows.insert(recipeId, this->recipeIds.size());
+      this->recipeIds.append(recipeId);
+      this->recipeStyleIds.append(recipe->getStyleId());
+      this->recipeValues[Og   ].append(results->gravities.og);
+      this->recipeValues[Fg   ].append(results->gravities.fg);
+      this->recipeValues[Ibu  ].append(results->IBU);
+      this->recipeValues[Color].append(results->color_srm);
+      this->recipeValues[Abv  ].append(results->ABV_pct);
+      this->recipeConformance.append(StyleIndex::Conformance::NoStyle);
+
+      if (!this->recipeConnections.contains(recipeId)) {
+         this->recipeConnections.insert(
+            recipeId,
+            QObject::connect(recipe,
+                             &NamedEntity::changed,
+                             &this->self,
+                             [this, recipeId]() { this->markRecipeStale(recipeId); })
+         );
+      }
+      return;
+   }
+
+   void removeRecipeRow(int const row) {
+      this->recipeRows.remove(this->recipeIds.at(row));
+      removeRow(this->recipeIds, row);
+      removeRow(this->recipeStyleIds, row);
+      removeRow(this->recipeValues, row);
+      removeRow(this->recipeConformance, row);
+      if (row < this->recipeIds.size()) {
+         this->recipeRows.insert(this->recipeIds.at(row), row);
+      }
+      return;
+   }
+
+   //! \brief Whether the recipe in \c recipeRow is within the ranges of the style in \c styleRow
+   bool contains(int const styleRow, int const recipeRow) const {
+      for (int dimension = 0; dimension < NumDimensions; ++dimension) {
+         double const value = this->recipeValues[dimension].at(recipeRow);
+         if (value < this->styleMins[dimension].at(styleRow) || value > this->styleMaxes[dimension].at(styleRow)) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   void updateConformance(int const recipeRow) {
+      int const styleRow = this->styleRows.value(this->recipeStyleIds.at(recipeRow), -1);
+      this->recipeConformance[recipeRow] =
+         styleRow < 0                        ? StyleIndex::Conformance::NoStyle :
+         this->contains(styleRow, recipeRow) ? StyleIndex::Conformance::InStyle : StyleIndex::Conformance::OutOfStyle;
+      return;
+   }
+
+   void sortRecipesByOg() {
+      if (this->recipesByOgValid) {
+         return;
+      }
+      this->recipesByOg.resize(this->recipeIds.size());
+      std::iota(this->recipesByOg.begin(), this->recipesByOg.end(), 0);
+      QVector<double> const & og = this->recipeValues[Og];
+      std::sort(this->recipesByOg.begin(),
+                this->recipesByOg.end(),
+                [&og](int const lhs, int const rhs) { return og.at(lhs) < og.at(rhs); });
+      this->recipesByOgValid = true;
+      return;
+   }
+
+   void markStyleStale(int const styleId) {
+      if (this->loaded) {
+         this->staleStyles.insert(styleId);
+         this->signalChange();
+      }
+      return;
+   }
+
+   void markRecipeStale(int const recipeId) {
+      if (this->loaded) {
+         this->staleRecipes.insert(recipeId);
+         this->signalChange();
+      }
+      return;
+   }
+
+   void signalChange() {
+      if (!this->changeSignalled) {
+         this->changeSignalled = true;
+         emit this->self.changed();
+      }
+      return;
+   }
+
+   // Member variables
+   StyleIndex & self;
+   bool loaded = false;
+   bool changeSignalled = false;
+
+   // Styles, one row each
+   QVector<int>     styleIds;
+   QVector<bool>    styleIsMaster;
+   Columns          styleMins;
+   Columns          styleMaxes;
+   QHash<int, int>  styleRows;
+
+   // Recipes, one row each
+   QVector<int>                     recipeIds;
+   QVector<int>                     recipeStyleIds;
+   Columns                          recipeValues;
+   QVector<StyleIndex::Conformance> recipeConformance;
+   QHash<int, int>                  recipeRows;
+   //! Recipe row numbers in OG order -- rebuilt when needed after recipes are added, removed or changed
+   QVector<int>                     recipesByOg;
+   bool                             recipesByOgValid = false;
+
+   // What's changed since the last query
+   QSet<int> staleStyles;
+   QSet<int> staleRecipes;
+
+   QHash<int, QMetaObject::Connection> styleConnections;
+   QHash<int, QMetaObject::Connection> recipeConnections;
+};
+
+StyleIndex & StyleIndex::getInstance() {
+   //
+   // As of C++11, simple "Meyers singleton" is now thread-safe -- see
+   // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
+   //
+   static StyleIndex singleton;
+
+   return singleton;
+}
+
+StyleIndex::StyleIndex() : QObject{}, pimpl{std::make_unique<impl>(*this)} {
+   auto & styleStore  = ObjectStoreTyped<Style >::getInstance();
+   auto & recipeStore = ObjectStoreTyped<Recipe>::getInstance();
+   auto markStyleStale  = [this](int id) { this->pimpl->markStyleStale (id); };
+   auto markRecipeStale = [this](int id) { this->pimpl->markRecipeStale(id); };
+   connect(&styleStore,  &ObjectStoreTyped<Style >::signalObjectInserted, this, markStyleStale );
+   connect(&styleStore,  &ObjectStoreTyped<Style >::signalObjectDeleted,  this, markStyleStale );
+   connect(&recipeStore, &ObjectStoreTyped<Recipe>::signalObjectInserted, this, markRecipeStale);
+   connect(&recipeStore, &ObjectStoreTyped<Recipe>::signalObjectDeleted,  this, markRecipeStale);
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+StyleIndex::~StyleIndex() = default;
+
+StyleIndex::Conformance StyleIndex::conformance(int const recipeId) {
+   this->pimpl->refresh();
+   int const row = this->pimpl->recipeRows.value(recipeId, -1);
+   return row < 0 ? Conformance::NoStyle : this->pimpl->recipeConformance.at(row);
+}
+
+QVector<int> StyleIndex::recipesOutOfStyle() {
+   this->pimpl->refresh();
+   QVector<int> recipeIds;
+   for (int row = 0; row < this->pimpl->recipeIds.size(); ++row) {
+      if (this->pimpl->recipeConformance.at(row) == Conformance::OutOfStyle) {
+         recipeIds.append(this->pimpl->recipeIds.at(row));
+      }
+   }
+   return recipeIds;
+}
+
+QVector<int> StyleIndex::stylesMatching(int const recipeId) {
+   this->pimpl->refresh();
+   QVector<int> styleIds;
+   int const recipeRow = this->pimpl->recipeRows.value(recipeId, -1);
+   if (recipeRow < 0) {
+      return styleIds;
+   }
+   for (int styleRow = 0; styleRow < this->pimpl->styleIds.size(); ++styleRow) {
+      if (this->pimpl->styleIsMaster.at(styleRow) && this->pimpl->contains(styleRow, recipeRow)) {
+         styleIds.append(this->pimpl->styleIds.at(styleRow));
+      }
+   }
+   return styleIds;
+}
+
+QVector<int> StyleIndex::recipesMatching(int const styleId) {
+   this->pimpl->refresh();
+   QVector<int> recipeIds;
+   int const styleRow = this->pimpl->styleRows.value(styleId, -1);
+   if (styleRow < 0) {
+      return recipeIds;
+   }
+
+   // Only the recipes in the style's OG range can match, so we start there and check the other ranges one by one
+   this->pimpl->sortRecipesByOg();
+   QVector<double> const & og = this->pimpl->recipeValues[Og];
+   double const ogMin = this->pimpl->styleMins [Og].at(styleRow);
+   double const ogMax = this->pimpl->styleMaxes[Og].at(styleRow);
+   auto ii = std::lower_bound(this->pimpl->recipesByOg.cbegin(),
+                              this->pimpl->recipesByOg.cend(),
+                              ogMin,
+                              [&og](int const row, double const value) { return og.at(row) < value; });
+   for (; ii != this->pimpl->recipesByOg.cend() && og.at(*ii) <= ogMax; ++ii) {
+      if (this->pimpl->contains(styleRow, *ii)) {
+         recipeIds.append(this->pimpl->recipeIds.at(*ii));
+      }
+   }
+   return recipeIds;
+}
+
+void StyleIndex::invalidateAll() {
+   qDebug() << Q_FUNC_INFO << "Discarding style index";
+   this->pimpl->clear();
+   this->pimpl->signalChange();
+   return;
+}
@@ -0,0 +1,122 @@
+/*
+ * StyleIndex.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STYLEINDEX_H
+#define STYLEINDEX_H
+#pragma once
+
+#include <memory> // For PImpl
+
+#include <QObject>
+#include <QVector>
+
+class Recipe;
+class Style;
+
+/*!
+ * \class StyleIndex
+ *
+ * \brief Singleton that answers "which recipes are out of style", "which styles does this recipe fit" and "which
+ *        recipes fit this style" for the whole database without having to go through every \c Recipe and \c Style
+ *        object each time.
+ *
+ *        We hold two indexes, each in flat arrays (one per dimension):
+ *          - For each Style, its OG, FG, IBU, color and ABV ranges.  (A range where min and max are both 0 is treated
+ *            as "not specified" and matches everything.)
+ *          - For each Recipe, its (calculated) OG, FG, IBU, color and ABV, its Style, and whether it is within that
+ *            Style's ranges.  We also keep the recipes sorted by OG so that "recipes that fit this style" only has to
+ *            look at the ones in the right OG range.
+ *
+ *        The index is built the first time it is queried, and then kept up to date from the \c ObjectStore signals
+ *        (for inserts and deletes) and \c NamedEntity::changed (for edits).  Changes just mark the affected entry as
+ *        stale and it is re-read at the start of the next query, so a burst of edits (eg while the user is typing in a
+ *        recipe) costs nothing until someone asks.
+ *
+ *        All IDs are the usual database keys.  Must only be used on the GUI thread (as it reads model objects).
+ */
+class StyleIndex : public QObject {
+   Q_OBJECT
+
+public:
+   //! \brief How a Recipe relates to its own Style
+   enum class Conformance {
+      NoStyle,
+      InStyle,
+      OutOfStyle
+   };
+
+   /**
+    * \brief Get the singleton instance
+    */
+   static StyleIndex & getInstance();
+
+   virtual ~StyleIndex();
+
+   /**
+    * \brief Whether the Recipe with the supplied ID is within the ranges of its own Style.  Returns \c NoStyle if it
+    *        doesn't have one (or we don't know about the Recipe).
+    */
+   Conformance conformance(int recipeId);
+
+   //! \brief IDs of all (non-deleted) recipes that have a Style but aren't within its ranges
+   QVector<int> recipesOutOfStyle();
+
+   /**
+    * \brief IDs of all the styles whose ranges the Recipe with the supplied ID is within.  Only "master" styles (ie the
+    *        ones in the style tree, not copies used in recipes) are considered.
+    */
+   QVector<int> stylesMatching(int recipeId);
+
+   //! \brief IDs of all (non-deleted) recipes, whatever their own Style, that are within the ranges of \c styleId
+   QVector<int> recipesMatching(int styleId);
+
+   /**
+    * \brief Forget everything and rebuild on the next query, eg after a bulk import or a change to a setting (such as
+    *        the IBU formula) that changes every Recipe.
+    */
+   void invalidateAll();
+
+signals:
+   /**
+    * \brief Emitted when something has changed that could affect the results of a query made since the last time this
+    *        was emitted.  Emitted at most once between queries, so it is cheap for a listener (such as a tree filter)
+    *        to just re-run its query when it receives this.
+    */
+   void changed();
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   /**
+    * Private constructor as singleton
+    */
+   StyleIndex();
+
+   //! No copy constructor, as never want anyone, not even our friends, to make copies of a singleton
+   StyleIndex(StyleIndex const&) = delete;
+   //! No assignment operator , as never want anyone, not even our friends, to make copies of a singleton.
+   StyleIndex& operator=(StyleIndex const&) = delete;
+   //! No move constructor
+   StyleIndex(StyleIndex &&) = delete;
+   //! No move assignment
+   StyleIndex & operator=(StyleIndex &&) = delete;
+};
+
+#endif
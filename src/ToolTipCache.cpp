@@ -0,0 +1,174 @@
+/*
+ * ToolTipCache.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ToolTipCache.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QMultiHash>
+
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Misc.h"
+#include "model/NamedEntity.h"
+#include "model/Recipe.h"
+#include "model/Style.h"
+#include "model/Water.h"
+#include "model/Yeast.h"
+#include "RecipeFormatter.h"
+
+// This private implementation class holds all private non-virtual members of ToolTipCache
+class ToolTipCache::impl {
+public:
+
+   /**
+    * Constructor
+    */
+   impl(ToolTipCache & self) : self{self},
+                               formatter{},
+                               toolTips{},
+                               dependents{} {
+      return;
+   }
+
+   /**
+    * Destructor
+    */
+   ~impl() = default;
+
+   /**
+    * \brief Generate the tooltip for the supplied object.  Note that \c RecipeFormatter::getToolTip is overloaded
+    *        rather than virtual, so we have to work out the type here.
+    */
+   QString generate(NamedEntity * namedEntity) {
+      if (auto recipe = qobject_cast<Recipe *>(namedEntity)) {
+         //
+         // A Recipe's tooltip also shows the name and code of its Style, so, if the Style changes, we need to discard
+         // the Recipe's tooltip as well as the Style's.
+         //
+         Style * style = recipe->style();
+         if (style) {
+            this->addDependency(style, recipe);
+         }
+         return this->formatter.getToolTip(recipe);
+      }
+      if (auto style       = qobject_cast<Style       *>(namedEntity)) { return this->formatter.getToolTip(style      ); }
+      if (auto equipment   = qobject_cast<Equipment   *>(namedEntity)) { return this->formatter.getToolTip(equipment  ); }
+      if (auto fermentable = qobject_cast<Fermentable *>(namedEntity)) { return this->formatter.getToolTip(fermentable); }
+      if (auto hop         = qobject_cast<Hop         *>(namedEntity)) { return this->formatter.getToolTip(hop        ); }
+      if (auto misc        = qobject_cast<Misc        *>(namedEntity)) { return this->formatter.getToolTip(misc       ); }
+      if (auto yeast       = qobject_cast<Yeast       *>(namedEntity)) { return this->formatter.getToolTip(yeast      ); }
+      if (auto water       = qobject_cast<Water       *>(namedEntity)) { return this->formatter.getToolTip(water      ); }
+      return QString{};
+   }
+
+   /**
+    * \brief Ensure we hear about it when \c namedEntity changes or goes away.  It's safe to call this multiple times
+    *        for the same object as we ask for unique connections.
+    */
+   void watch(NamedEntity * namedEntity) {
+      QObject::connect(namedEntity, &NamedEntity::changed, &this->self, &ToolTipCache::invalidate,    Qt::UniqueConnection);
+      QObject::connect(namedEntity, &QObject::destroyed,   &this->self, &ToolTipCache::invalidateFor, Qt::UniqueConnection);
+      return;
+   }
+
+   /**
+    * \brief Record that the cached tooltip for \c dependent needs to be discarded when \c source changes
+    */
+   void addDependency(NamedEntity * source, NamedEntity * dependent) {
+      if (!this->dependents.contains(source, dependent)) {
+         this->dependents.insert(source, dependent);
+      }
+      this->watch(source);
+      return;
+   }
+
+   // Member variables
+   ToolTipCache & self;
+   RecipeFormatter formatter;
+   QHash<QObject const *, QString> toolTips;
+   // Key is an object whose changes affect the tooltip(s) of the value(s)
+   QMultiHash<QObject const *, QObject const *> dependents;
+};
+
+ToolTipCache & ToolTipCache::getInstance() {
+   //
+   // As of C++11, simple "Meyers singleton" is now thread-safe -- see
+   // https://www.modernescpp.com/index.php/thread-safe-initialization-of-a-singleton#h3-guarantees-of-the-c-runtime
+   //
+   static ToolTipCache singleton;
+
+   return singleton;
+}
+
+ToolTipCache::ToolTipCache() : QObject{}, pimpl{std::make_unique<impl>(*this)} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+ToolTipCache::~ToolTipCache() = default;
+
+QString ToolTipCache::getToolTip(NamedEntity * namedEntity) {
+   if (!namedEntity) {
+      return QString{};
+   }
+
+   auto cached = this->pimpl->toolTips.constFind(namedEntity);
+   if (cached != this->pimpl->toolTips.constEnd()) {
+      return cached.value();
+   }
+
+   QString toolTip = this->pimpl->generate(namedEntity);
+   if (!toolTip.isEmpty()) {
+      this->pimpl->watch(namedEntity);
+      this->pimpl->toolTips.insert(namedEntity, toolTip);
+   }
+   return toolTip;
+}
+
+void ToolTipCache::invalidateAll() {
+   qDebug() << Q_FUNC_INFO << "Discarding" << this->pimpl->toolTips.size() << "cached tooltips";
+   this->pimpl->toolTips.clear();
+   this->pimpl->dependents.clear();
+   return;
+}
+
+void ToolTipCache::invalidate() {
+   this->invalidateFor(this->sender());
+   return;
+}
+
+void ToolTipCache::invalidateFor(QObject const * object) {
+   if (!object) {
+      return;
+   }
+
+   this->pimpl->toolTips.remove(object);
+
+   //
+   // Dependencies get re-recorded when the dependent tooltip is next generated, so we can forget them here.  (This
+   // also means we don't hang on to pointers to objects that have been destroyed.)
+   //
+   for (auto dependent : this->pimpl->dependents.values(object)) {
+      this->pimpl->toolTips.remove(dependent);
+   }
+   this->pimpl->dependents.remove(object);
+   return;
+}
@@ -0,0 +1,98 @@
+/*
+ * ToolTipCache.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TOOLTIPCACHE_H
+#define TOOLTIPCACHE_H
+#pragma once
+
+#include <memory> // For PImpl
+
+#include <QObject>
+#include <QString>
+
+class NamedEntity;
+
+/*!
+ * \class ToolTipCache
+ *
+ * \brief Singleton that holds the rich-text tooltips shown when the mouse hovers over a Recipe, Style, Equipment,
+ *        Fermentable, Hop, Misc, Yeast or Water in a tree or table.
+ *
+ *        Generating a tooltip means building an HTML table, and, for a \c Recipe, reading calculated values such as OG
+ *        and IBU (which can in turn trigger a recalculation).  Since the mouse will typically hover over the same few
+ *        items many times without them changing, we build each tooltip once and then keep it until the object it
+ *        describes emits \c NamedEntity::changed (or is destroyed).
+ *
+ *        Tooltips also depend on global display settings (units, color/IBU formula names, language), so callers that
+ *        change those should call \c invalidateAll().
+ */
+class ToolTipCache : public QObject {
+   Q_OBJECT
+
+public:
+   /**
+    * \brief Get the singleton instance
+    */
+   static ToolTipCache & getInstance();
+
+   virtual ~ToolTipCache();
+
+   /**
+    * \brief Returns the tooltip for \c namedEntity, generating (and caching) it if necessary.
+    *
+    * \return Empty string if \c namedEntity is null or not of a type for which we generate tooltips
+    */
+   QString getToolTip(NamedEntity * namedEntity);
+
+   /**
+    * \brief Discard all cached tooltips, eg because display units or formulae have changed
+    */
+   void invalidateAll();
+
+public slots:
+   /**
+    * \brief Discard the cached tooltip for the object that sent the signal (and any tooltips that depend on it)
+    */
+   void invalidate();
+
+   /**
+    * \brief Discard the cached tooltip for a specific object (and any tooltips that depend on it)
+    */
+   void invalidateFor(QObject const * object);
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   /**
+    * Private constructor as singleton
+    */
+   ToolTipCache();
+
+   //! No copy constructor, as never want anyone, not even our friends, to make copies of a singleton
+   ToolTipCache(ToolTipCache const&) = delete;
+   //! No assignment operator , as never want anyone, not even our friends, to make copies of a singleton.
+   ToolTipCache& operator=(ToolTipCache const&) = delete;
+   //! No move constructor
+   ToolTipCache(ToolTipCache &&) = delete;
+   //! No move assignment
+   ToolTipCache & operator=(ToolTipCache &&) = delete;
+};
+
+#endif
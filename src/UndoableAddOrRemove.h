@@ -27,6 +27,7 @@
 #include <QString>
 #include <QUndoCommand>
 
+#include "BoundedUndoStack.h"
 #include "database/ObjectStoreWrapper.h"
 
 class MainWindow;
@@ -37,7 +38,7 @@ class MainWindow;
  * \brief Each instance of this class is a non-trivial undoable addition to, or removal from, a recipe etc.
  */
 template<class UU, class VV>
-class UndoableAddOrRemove : public QUndoCommand {
+class UndoableAddOrRemove : public QUndoCommand, public BoundedUndoStack::SizedCommand {
 public:
    // NB: Constructors are all explicit as we don't want to construct with implicit conversions
    /*!
@@ -113,6 +114,20 @@ public:
       return;
    }
 
+   /*!
+    * \brief Implements \c BoundedUndoStack::SizedCommand.  If we hold the only remaining shared pointer to the object
+    *        (eg because it was deleted when it was removed from a recipe) then we are what is keeping it alive, so we
+    *        count it.  (This counts only the object itself, not any heap data it owns, but it's good enough for
+    *        comparing commands against each other.)
+    */
+   virtual std::size_t heldMemory_bytes() const {
+      std::size_t size = sizeof(*this) - sizeof(QUndoCommand);
+      if (this->whatToAddOrRemove.use_count() == 1) {
+         size += sizeof(VV);
+      }
+      return size;
+   }
+
 private:
    /*!
     * \brief Undo or redo applying the update
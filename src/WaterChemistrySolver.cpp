@@ -0,0 +1,346 @@
+/*
+ * WaterChemistrySolver.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "WaterChemistrySolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDebug>
+
+#include "utils/Instrumentation.h"
+
+namespace {
+   // I've seen some confusion over this constant. 50 mEq/l is what Kai uses.
+   double constexpr mEq = 50.0;
+   // Ca grams per mole
+   double constexpr Cagpm = 40.0;
+   // Mg grams per mole
+   double constexpr Mggpm = 24.30;
+   // HCO3 grams per mole
+   double constexpr HCO3gpm = 61.01;
+   // CO3 grams per mole
+   double constexpr CO3gpm = 60.01;
+   // Acid grams per mole
+   double constexpr lacticgpm = 90.0;
+   double constexpr H3PO4gpm  = 98.0;
+   // Lactic acid solution of 88% is 1.2 kg/L, and we assume it scales linearly down to water
+   double constexpr lacticDensity_kgL = 1.2;
+
+   //! Below this, we don't bother weighting ions by their target, so that 0 ppm targets still count
+   double constexpr minIonWeighting_ppm = 10.0;
+
+   // One unknown for each salt, plus the mash acid
+   int constexpr numUnknowns = WaterChemistrySolver::numSalts + 1;
+   int constexpr acidIndex   = WaterChemistrySolver::numSalts;
+
+   using Vector = std::array<double, numUnknowns>;
+   using Matrix = std::array<Vector, numUnknowns>;
+
+   //! \brief What's in 1g of a salt, in mg
+   struct SaltContents {
+      //! By \c Water::Ions
+      std::array<double, WaterChemistrySolver::numIons> ions;
+      //! Carbonate isn't one of the \c Water::Ions, but it counts towards the alkalinity
+      double co3;
+   };
+
+   /**
+    * \brief What's in each salt (by salt index).  We ask \c Salt, so that there's only one copy of the numbers.
+    */
+   std::array<SaltContents, WaterChemistrySolver::numSalts> const & saltContents() {
+      static auto const table = [] {
+         std::array<SaltContents, WaterChemistrySolver::numSalts> result{};
+         for (int saltIndex = 0; saltIndex < WaterChemistrySolver::numSalts; ++saltIndex) {
+            Salt salt{""};
+            salt.setType(WaterChemistrySolver::saltType(saltIndex));
+            salt.setWhenToAdd(Salt::WhenToAdd::MASH);
+            salt.setAmount(0.001);
+            auto & ions = result[saltIndex].ions;
+            ions[static_cast<int>(Water::Ions::Ca  )] = salt.Ca();
+            ions[static_cast<int>(Water::Ions::Cl  )] = salt.Cl();
+            ions[static_cast<int>(Water::Ions::HCO3)] = salt.HCO3();
+            ions[static_cast<int>(Water::Ions::Mg  )] = salt.Mg();
+            ions[static_cast<int>(Water::Ions::Na  )] = salt.Na();
+            ions[static_cast<int>(Water::Ions::SO4 )] = salt.SO4();
+            result[saltIndex].co3 = salt.CO3();
+         }
+         return result;
+      }();
+      return table;
+   }
+
+   /**
+    * \brief Solve the system made of the rows and columns of \c lhs in \c subset, by Gaussian elimination with
+    *        partial pivoting.  Unknowns not in \c subset are set to 0.  Returns false if the system is singular.
+    */
+   bool solveSubset(Matrix const & lhs, Vector const & rhs, std::array<bool, numUnknowns> const & subset, Vector & x) {
+      std::array<int, numUnknowns> indexes{};
+      int size = 0;
+      for (int ii = 0; ii < numUnknowns; ++ii) {
+         if (subset[ii]) {
+            indexes[size++] = ii;
+         }
+      }
+
+      Matrix a{};
+      Vector b{};
+      for (int row = 0; row < size; ++row) {
+         for (int col = 0; col < size; ++col) {
+            a[row][col] = lhs[indexes[row]][indexes[col]];
+         }
+         b[row] = rhs[indexes[row]];
+      }
+
+      for (int col = 0; col < size; ++col) {
+         int pivot = col;
+         for (int row = col + 1; row < size; ++row) {
+            if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+               pivot = row;
+            }
+         }
+         if (std::abs(a[pivot][col]) < 1e-12) {
+            return false;
+         }
+         std::swap(a[pivot], a[col]);
+         std::swap(b[pivot], b[col]);
+         for (int row = col + 1; row < size; ++row) {
+            double const factor = a[row][col] / a[col][col];
+            for (int kk = col; kk < size; ++kk) {
+               a[row][kk] -= factor * a[col][kk];
+            }
+            b[row] -= factor * b[col];
+         }
+      }
+
+      Vector solution{};
+      for (int row = size - 1; row >= 0; --row) {
+         double sum = b[row];
+         for (int kk = row + 1; kk < size; ++kk) {
+            sum -= a[row][kk] * solution[kk];
+         }
+         solution[row] = sum / a[row][row];
+      }
+
+      x.fill(0.0);
+      for (int ii = 0; ii < size; ++ii) {
+         x[indexes[ii]] = solution[ii];
+      }
+      return true;
+   }
+
+   /**
+    * \brief Minimise ½xᵀGx - hᵀx subject to x >= 0 and x[j] = 0 where \c allowed[j] is false, by the Lawson-Hanson
+    *        active set method (applied to the normal equations, which, at this size, is fine).
+    */
+   Vector nonNegativeLeastSquares(Matrix const & gram,
+                                  Vector const & rhs,
+                                  std::array<bool, numUnknowns> const & allowed) {
+      double constexpr tolerance = 1e-10;
+      Vector x{};
+      std::array<bool, numUnknowns> passive{};
+
+      // Each unknown can only enter the passive set so many times before we'd be going round in circles
+      for (int iteration = 0; iteration < 3 * numUnknowns; ++iteration) {
+         // Negative gradient of the objective.  If it's not positive for anything we could increase, we're done.
+         int best = -1;
+         double bestGradient = tolerance;
+         for (int jj = 0; jj < numUnknowns; ++jj) {
+            if (!allowed[jj] || passive[jj]) {
+               continue;
+            }
+            double gradient = rhs[jj];
+            for (int kk = 0; kk < numUnknowns; ++kk) {
+               gradient -= gram[jj][kk] * x[kk];
+            }
+            if (gradient > bestGradient) {
+               best = jj;
+               bestGradient = gradient;
+            }
+         }
+         if (best < 0) {
+            break;
+         }
+         passive[best] = true;
+
+         // Solve for the passive set and, if that takes anything negative, step back to where it just reaches zero,
+         // drop it and try again.
+         for (;;) {
+            Vector z{};
+            if (!solveSubset(gram, rhs, passive, z)) {
+               passive[best] = false;
+               break;
+            }
+            double alpha = 1.0;
+            bool allPositive = true;
+            for (int jj = 0; jj < numUnknowns; ++jj) {
+               if (passive[jj] && z[jj] <= tolerance) {
+                  allPositive = false;
+                  double const step = x[jj] - z[jj];
+                  alpha = std::min(alpha, step > 0.0 ? x[jj] / step : 0.0);
+               }
+            }
+            if (allPositive) {
+               x = z;
+               break;
+            }
+            for (int jj = 0; jj < numUnknowns; ++jj) {
+               if (passive[jj]) {
+                  x[jj] += alpha * (z[jj] - x[jj]);
+                  if (x[jj] <= tolerance) {
+                     x[jj] = 0.0;
+                     passive[jj] = false;
+                  }
+               }
+            }
+         }
+      }
+      return x;
+   }
+}
+
+Salt::Types WaterChemistrySolver::saltType(int const saltIndex) {
+   return static_cast<Salt::Types>(static_cast<int>(Salt::Types::CACL2) + saltIndex);
+}
+
+WaterChemistrySolver::Solution WaterChemistrySolver::solve(Problem const & problem) {
+   BT_TIME_SCOPE("WaterChemistrySolver::solve");
+   Solution solution;
+   double const allTheWaters = problem.mashWater_l + problem.spargeWater_l;
+   if (allTheWaters <= 0.0) {
+      qWarning() << Q_FUNC_INFO << "No water to add salts to";
+      return solution;
+   }
+   solution.mashShare = problem.mashWater_l / allTheWaters;
+
+   auto const & contents = saltContents();
+
+   // Each unknown's effect on the mash pH per gram.  (Everything in the mash water counts, as in WaterDialog.)
+   Vector pHPerGram{};
+   bool const wantPh = problem.targetMashPh > 0.0 && problem.thickness_LKg > 0.0;
+   if (wantPh) {
+      for (int saltIndex = 0; saltIndex < numSalts; ++saltIndex) {
+         auto const & ions = contents[saltIndex].ions;
+         pHPerGram[saltIndex] = pHShift(alkalinity_mEq(ions[static_cast<int>(Water::Ions::Ca  )],
+                                                       ions[static_cast<int>(Water::Ions::Mg  )],
+                                                       ions[static_cast<int>(Water::Ions::HCO3)],
+                                                       contents[saltIndex].co3),
+                                        problem.thickness_LKg);
+      }
+      pHPerGram[acidIndex] = -pHShift(acid_mEq(1.0, 0.0), problem.thickness_LKg);
+   }
+
+   //
+   // Build the normal equations a row at a time: one row per ion, and one for the pH.  Each row r, with weight w,
+   // contributes w²·rᵀr to the Gram matrix and w²·(target - base)·r to the right hand side.
+   //
+   Matrix gram{};
+   Vector rhs{};
+   auto addRow = [&gram, &rhs](Vector const & row, double const weight, double const wanted) {
+      double const weight2 = weight * weight;
+      for (int jj = 0; jj < numUnknowns; ++jj) {
+         for (int kk = 0; kk < numUnknowns; ++kk) {
+            gram[jj][kk] += weight2 * row[jj] * row[kk];
+         }
+         rhs[jj] += weight2 * row[jj] * wanted;
+      }
+   };
+   for (int ion = 0; ion < numIons; ++ion) {
+      Vector row{};
+      for (int saltIndex = 0; saltIndex < numSalts; ++saltIndex) {
+         row[saltIndex] = contents[saltIndex].ions[ion] / allTheWaters;
+      }
+      double const weight = 1.0 / std::max(problem.target_ppm[ion], minIonWeighting_ppm);
+      addRow(row, weight, problem.target_ppm[ion] - problem.base_ppm[ion]);
+   }
+   if (wantPh) {
+      addRow(pHPerGram, problem.pHWeight, problem.targetMashPh - problem.unadjustedMashPh);
+   }
+
+   // A touch of ridge, so that salts that do the same job (eg CaCl2 and NaCl for chloride) don't make the system
+   // singular: it just prefers smaller amounts where nothing else decides.
+   double trace = 0.0;
+   for (int jj = 0; jj < numUnknowns; ++jj) {
+      trace += gram[jj][jj];
+   }
+   for (int jj = 0; jj < numUnknowns; ++jj) {
+      gram[jj][jj] += 1e-9 * trace / numUnknowns;
+   }
+
+   std::array<bool, numUnknowns> allowed{};
+   for (int saltIndex = 0; saltIndex < numSalts; ++saltIndex) {
+      allowed[saltIndex] = problem.allowedSalts[saltIndex];
+   }
+   allowed[acidIndex] = problem.allowAcid && wantPh;
+
+   Vector const x = nonNegativeLeastSquares(gram, rhs, allowed);
+
+   //
+   // Work out what we've ended up with
+   //
+   solution.ions_ppm = problem.base_ppm;
+   solution.mashPh   = problem.unadjustedMashPh;
+   for (int saltIndex = 0; saltIndex < numSalts; ++saltIndex) {
+      solution.salt_g[saltIndex] = x[saltIndex];
+      for (int ion = 0; ion < numIons; ++ion) {
+         solution.ions_ppm[ion] += x[saltIndex] * contents[saltIndex].ions[ion] / allTheWaters;
+      }
+   }
+   solution.mashLacticAcid_g = x[acidIndex];
+   for (int jj = 0; jj < numUnknowns; ++jj) {
+      solution.mashPh += x[jj] * pHPerGram[jj];
+   }
+
+   if (problem.allowAcid && problem.spargeWater_l > 0.0) {
+      // Just enough acid to cancel out the sparge water's alkalinity.  This is straight titration, so we don't want
+      // any of Kai's mash factors in alkalinity_mEq: HCO3 has one charge, so mg/L over g/mol gives mEq/L.
+      double const spargeAlkalinity_mEq = problem.spargeAlkalinity_ppm / HCO3gpm * problem.spargeWater_l;
+      solution.spargeLacticAcid_g = std::max(0.0, spargeAlkalinity_mEq / acid_mEq(1.0, 0.0));
+   }
+
+   return solution;
+}
+
+double WaterChemistrySolver::alkalinity_mEq(double const ca_mg,
+                                            double const mg_mg,
+                                            double const hco3_mg,
+                                            double const co3_mg) {
+   // I have no idea where the 2 comes from, but Kai did it. I wish I knew why.
+   // The 3.5 and 7 come from Paul Kohlbach's work from the 1940's.
+   // The 61 is another magic number from Kai. Sigh
+   return - (ca_mg / Cagpm * 2) / 3.5 - (mg_mg / Mggpm * 2) / 7 + (hco3_mg / HCO3gpm + co3_mg / CO3gpm) / 61;
+}
+
+double WaterChemistrySolver::acid_mEq(double const lacticAcid_g, double const phosphoricAcid_g) {
+   return 1000 * lacticAcid_g / lacticgpm + 1000 * phosphoricAcid_g / H3PO4gpm;
+}
+
+double WaterChemistrySolver::pHShift(double const alkalinity_mEq, double const thickness_LKg) {
+   // note: The referenced paper says the formula is
+   // gristpH + strikepH * thickness/mEq. I could never get that to work.
+   // the spreadsheet gave me this formula, and  it works much better.
+   return alkalinity_mEq / thickness_LKg / mEq;
+}
+
+double WaterChemistrySolver::lacticSolution_l(double const lacticAcid_g, double const percentAcid) {
+   if (percentAcid <= 0.0) {
+      return 0.0;
+   }
+   double const density_kgL = percentAcid / 88.0 * (lacticDensity_kgL - 1.0) + 1.0;
+   return lacticAcid_g / (1000.0 * density_kgL * percentAcid / 100.0);
+}
@@ -0,0 +1,119 @@
+/*
+ * WaterChemistrySolver.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef WATERCHEMISTRYSOLVER_H
+#define WATERCHEMISTRYSOLVER_H
+#pragma once
+
+#include <array>
+
+#include "model/Salt.h"
+#include "model/Water.h"
+
+/*!
+ * \class WaterChemistrySolver
+ *
+ * \brief Works out the salt and acid additions that get closest to a target water profile and mash pH.
+ *
+ *        We use the same model as \c WaterDialog (ie Kai Troester's, as described there): each salt adds a fixed amount
+ *        of each ion per gram, spread over all the water, and each ion and acid moves the mash pH by a fixed amount per
+ *        gram.  So the ion concentrations and the mash pH are linear in the amounts added, and finding the best
+ *        additions is a small least-squares problem: minimise the weighted squared differences from the target ions
+ *        and pH, subject to no amount being negative (as you can't take salts out of the water).  We solve it with the
+ *        Lawson-Hanson active set method, which, with only seven unknowns, takes a few microseconds -- quick enough to
+ *        redo whenever one of the inputs changes.
+ *
+ *        Salts are added to the mash and sparge water in proportion to their volumes, so that both end up with the
+ *        same profile.  (This is what \c Salt::WhenToAdd::RATIO does.)  Lactic acid for the mash is one of the
+ *        unknowns.  Lactic acid for the sparge is worked out separately, as just enough to neutralise the sparge
+ *        water's alkalinity, because it has no effect on the mash pH in this model.
+ *
+ *        The static \c alkalinity_mEq, \c acid_mEq and \c pHShift functions are the pH formulas themselves, which
+ *        \c WaterDialog also uses to show the pH of whatever the user has chosen.
+ */
+class WaterChemistrySolver {
+public:
+   //! Number of salts we choose amounts of, ie \c Salt::Types::CACL2 to \c Salt::Types::NAHCO3
+   static constexpr int numSalts = 6;
+   static constexpr int numIons  = static_cast<int>(Water::Ions::numIons);
+
+   //! \brief The salt that goes with index \c saltIndex (0 to \c numSalts - 1) in the arrays below
+   static Salt::Types saltType(int saltIndex);
+
+   //! \brief Everything the solver needs to know, all of which the water dialog already works out
+   struct Problem {
+      //! Ions in the water before any additions (ie after any dilution with RO water), in ppm, by \c Water::Ions
+      std::array<double, numIons> base_ppm{};
+      //! Ions we want to end up with, in ppm, by \c Water::Ions
+      std::array<double, numIons> target_ppm{};
+      double mashWater_l   = 0.0;
+      double spargeWater_l = 0.0;
+      //! Mash water to grain ratio, which determines how much the pH moves for a given amount of anything
+      double thickness_LKg = 0.0;
+      //! Mash pH with no salts or acid added (ie grist plus base water)
+      double unadjustedMashPh = 0.0;
+      //! Mash pH we want, or 0 to not care
+      double targetMashPh = 0.0;
+      //! Alkalinity of the sparge water, in ppm as HCO3, for working out how much acid it needs
+      double spargeAlkalinity_ppm = 0.0;
+      //! Which salts we may use, by salt index
+      std::array<bool, numSalts> allowedSalts{true, true, true, true, true, true};
+      bool allowAcid = true;
+      /**
+       * How much getting the pH right matters compared to getting the ions right.  Each ion is weighted so that being
+       * out by its target value (or 10 ppm for small targets) counts 1, and the pH is weighted so that being out by
+       * 1/pHWeight counts 1.
+       */
+      double pHWeight = 10.0;
+   };
+
+   //! \brief The additions that best meet a \c Problem, and what they give
+   struct Solution {
+      //! Total grams of each salt, by salt index, of which a \c mashShare fraction goes in the mash
+      std::array<double, numSalts> salt_g{};
+      double mashShare = 1.0;
+      //! Grams of lactic acid (ie not counting the water it comes in) for the mash and for the sparge
+      double mashLacticAcid_g   = 0.0;
+      double spargeLacticAcid_g = 0.0;
+      //! Resulting ions, in ppm, by \c Water::Ions
+      std::array<double, numIons> ions_ppm{};
+      double mashPh = 0.0;
+   };
+
+   static Solution solve(Problem const & problem);
+
+   /**
+    * \brief Kai's residual alkalinity, in mEq, of the supplied amounts of ions.  (Calcium and magnesium reduce it;
+    *        bicarbonate and carbonate increase it.)  Works equally with mg or mg/L, giving mEq or mEq/L respectively.
+    */
+   static double alkalinity_mEq(double ca_mg, double mg_mg, double hco3_mg, double co3_mg);
+
+   //! \brief Acidity, in mEq, of the supplied grams of acid
+   static double acid_mEq(double lacticAcid_g, double phosphoricAcid_g);
+
+   //! \brief How much \c alkalinity_mEq raises the mash pH (or, if negative, lowers it)
+   static double pHShift(double alkalinity_mEq, double thickness_LKg);
+
+   /**
+    * \brief How many litres of lactic acid solution of strength \c percentAcid contain \c lacticAcid_g of acid.  (The
+    *        inverse of what \c SaltTableModel::totalAcidWeight does.)
+    */
+   static double lacticSolution_l(double lacticAcid_g, double percentAcid);
+};
+
+#endif
@@ -37,6 +37,7 @@
 #include "tableModels/SaltTableModel.h"
 #include "tableModels/WaterTableModel.h"
 #include "WaterButton.h"
+#include "WaterChemistrySolver.h"
 #include "WaterEditor.h"
 #include "WaterListModel.h"
 #include "WaterSortFilterProxyModel.h"
@@ -50,22 +51,16 @@
 //
 
 namespace {
-   // I've seen some confusion over this constant. 50 mEq/l is what Kai uses.
-   double constexpr mEq = 50.0;
-   // Ca grams per mole
-   double constexpr Cagpm = 40.0;
-   // Mg grams per mole
-   double constexpr Mggpm = 24.30;
-   // HCO3 grams per mole
-   double constexpr HCO3gpm = 61.01;
-   // CO3 grams per mole
-   double constexpr CO3gpm = 60.01;
-
    // The pH of a beer with no color
    double constexpr nosrmbeer_ph = 5.6;
    // Magic constants Kai derives in the document above.
    double constexpr pHSlopeLight = 0.21;
    double constexpr pHSlopeDark  = 0.06;
+
+   // What we aim for when matching the target profile: towards the top of the range the pH digit shows as good
+   double constexpr targetMash_ph = 5.4;
+   // Strength of the lactic acid we add when matching the target profile
+   double constexpr lacticAcid_pct = 88.0;
 }
 
 WaterDialog::WaterDialog(QWidget* parent) :
@@ -78,7 +73,8 @@ WaterDialog::WaterDialog(QWidget* parent) :
    m_mashRO{0.0},
    m_spargeRO{0.0},
    m_total_grains{0.0},
-   m_thickness{0.0} {
+   m_thickness{0.0},
+   m_matchTarget{false} {
 
    setupUi(this);
    // initialize the two buttons and lists (I think)
@@ -165,6 +161,7 @@ WaterDialog::WaterDialog(QWidget* parent) :
    connect(m_salt_table_model,    &SaltTableModel::newTotals, this,               &WaterDialog::newTotals   );
    connect(pushButton_addSalt,    &QAbstractButton::clicked,  m_salt_table_model, &SaltTableModel::catchSalt);
    connect(pushButton_removeSalt, &QAbstractButton::clicked,  this,               &WaterDialog::removeSalts );
+   connect(pushButton_matchTarget, &QAbstractButton::toggled, this,               &WaterDialog::setMatchTarget);
 
    connect(spinBox_mashRO,   QOverload<int>::of(&QSpinBox::valueChanged), this, &WaterDialog::setMashRO  );
    connect(spinBox_spargeRO, QOverload<int>::of(&QSpinBox::valueChanged), this, &WaterDialog::setSpargeRO);
@@ -180,6 +177,7 @@ WaterDialog::~WaterDialog() = default;
 void WaterDialog::setMashRO(int val) {
    m_mashRO = val/100.0;
    if ( m_base ) m_base->setMashRO(m_mashRO);
+   if ( m_matchTarget ) solveAdditions();
    newTotals();
    return;
 }
@@ -187,6 +185,7 @@ void WaterDialog::setMashRO(int val) {
 void WaterDialog::setSpargeRO(int val) {
    m_spargeRO = val/100.0;
    if ( m_base ) m_base->setSpargeRO(m_spargeRO);
+   if ( m_matchTarget ) solveAdditions();
    newTotals();
    return;
 }
@@ -292,6 +291,9 @@ void WaterDialog::update_baseProfile(int selected) {
 
       baseProfileButton->setWater(this->m_base.get());
       m_base_editor->setWater(this->m_base);
+      if (this->m_matchTarget) {
+         this->solveAdditions();
+      }
       newTotals();
    }
    return;
@@ -318,6 +320,10 @@ void WaterDialog::update_targetProfile(int selected) {
       m_target_editor->setWater(this->m_target);
 
       this->setDigits();
+      if (this->m_matchTarget) {
+         this->solveAdditions();
+         this->newTotals();
+      }
    }
    return;
 }
@@ -382,6 +388,88 @@ void WaterDialog::removeSalts() {
    return;
 }
 
+void WaterDialog::setMatchTarget(bool checked) {
+   this->m_matchTarget = checked;
+   if (this->m_matchTarget) {
+      this->solveAdditions();
+   } else {
+      // Go back to whatever salts the Recipe had before we started working them out
+      this->m_salt_table_model->restoreSalts();
+   }
+   return;
+}
+
+void WaterDialog::solveAdditions() {
+   if (!this->m_rec || !this->m_rec->mash() || !this->m_target) {
+      return;
+   }
+
+   Mash* mash = m_rec->mash();
+   double allTheWaters = mash->totalMashWater_l();
+   if (qFuzzyCompare(allTheWaters, 0.0) || m_thickness <= 0.0) {
+      qWarning() << Q_FUNC_INFO << "Can not work out additions without a mash";
+      return;
+   }
+
+   WaterChemistrySolver::Problem problem;
+   problem.mashWater_l   = mash->totalInfusionAmount_l();
+   problem.spargeWater_l = mash->totalSpargeAmount_l();
+   problem.thickness_LKg = m_thickness;
+   problem.targetMashPh  = targetMash_ph;
+   problem.unadjustedMashPh = this->calculateGristpH();
+   if (this->m_base) {
+      // Same dilution as in newTotals()
+      double modifier = 1.0 - (m_mashRO * problem.mashWater_l + m_spargeRO * problem.spargeWater_l) / allTheWaters;
+      for (int i = 0; i < static_cast<int>(Water::Ions::numIons); ++i) {
+         problem.base_ppm[i] = modifier * this->m_base->ppm(static_cast<Water::Ions>(i));
+      }
+      problem.unadjustedMashPh += this->calculateSaltpH();
+
+      problem.spargeAlkalinity_ppm = (1.0 - m_spargeRO) * this->m_base->alkalinity();
+      if (!this->m_base->alkalinityAsHCO3()) {
+         problem.spargeAlkalinity_ppm *= 1.22;
+      }
+   }
+   for (int i = 0; i < static_cast<int>(Water::Ions::numIons); ++i) {
+      problem.target_ppm[i] = this->m_target->ppm(static_cast<Water::Ions>(i));
+   }
+
+   auto const solution = WaterChemistrySolver::solve(problem);
+
+   //
+   // Salts go in the mash and sparge in proportion to the water (which is what "Ratio" does), so we give the mash
+   // amount and let the salt table model work out the rest.  Anything under 0.1g isn't worth weighing out.
+   //
+   QList<std::shared_ptr<Salt>> additions;
+   for (int ii = 0; ii < WaterChemistrySolver::numSalts; ++ii) {
+      double mash_g = solution.salt_g[ii] * solution.mashShare;
+      if (mash_g < 0.1) {
+         continue;
+      }
+      auto salt = std::make_shared<Salt>("");
+      salt->setType(WaterChemistrySolver::saltType(ii));
+      salt->setWhenToAdd(problem.spargeWater_l > 0.0 ? Salt::WhenToAdd::RATIO : Salt::WhenToAdd::MASH);
+      salt->setAmount(mash_g / 1000.0);
+      additions.append(salt);
+   }
+   auto addAcid = [&additions](double acid_g, Salt::WhenToAdd whenToAdd) {
+      if (acid_g < 0.1) {
+         return;
+      }
+      auto acid = std::make_shared<Salt>("");
+      acid->setType(Salt::Types::LACTIC);
+      acid->setPercentAcid(lacticAcid_pct);
+      acid->setWhenToAdd(whenToAdd);
+      acid->setAmount(WaterChemistrySolver::lacticSolution_l(acid_g, lacticAcid_pct));
+      additions.append(acid);
+   };
+   addAcid(solution.mashLacticAcid_g,   Salt::WhenToAdd::MASH);
+   addAcid(solution.spargeLacticAcid_g, Salt::WhenToAdd::SPARGE);
+
+   m_salt_table_model->replaceSalts(additions);
+   return;
+}
+
 //! \brief Calcuates the residual alkalinity of the mash water.
 double WaterDialog::calculateRA() const {
    double residual = 0.0;
@@ -410,19 +498,16 @@ double WaterDialog::calculateSaltpH() {
 
    double modifier = 1 - ( (m_mashRO * mash->totalInfusionAmount_l()) + (m_spargeRO * mash->totalSpargeAmount_l())) / allTheWaters;
 
-   // I have no idea where the 2 comes from, but Kai did it. I wish I knew why
    // we get the initial numbers from the base water
-   double cappm = modifier * m_base->calcium_ppm()/Cagpm * 2;
-   double mgppm = modifier * m_base->magnesium_ppm()/Mggpm * 2;
+   double hardness = WaterChemistrySolver::alkalinity_mEq(modifier * m_base->calcium_ppm(),
+                                                          modifier * m_base->magnesium_ppm(),
+                                                          0.0,
+                                                          0.0);
 
    // I need mass of the salts, and all the previous math gave me
    // ppm. Multiplying by the water volume gives me the mass
-   // The 3.5 and 7 come from Paul Kohlbach's work from the 1940's.
-   double totalDelta = (calculateRA() - cappm/3.5 - mgppm/7) * m_rec->mash()->totalInfusionAmount_l();
-   // note: The referenced paper says the formula is
-   // gristpH + strikepH * thickness/mEq. I could never get that to work.
-   // the spreadsheet gave me this formula, and  it works much better.
-   return totalDelta/m_thickness/mEq;
+   double totalDelta = (calculateRA() + hardness) * m_rec->mash()->totalInfusionAmount_l();
+   return WaterChemistrySolver::pHShift(totalDelta, m_thickness);
 }
 
 //! \brief Calculates the pH delta caused by any salt additions.
@@ -430,37 +515,24 @@ double WaterDialog::calculateAddedSaltpH() {
 
    // We need the value from the salt table model, because we need all the
    // added salts, but not the base.
-   double ca   = this->m_salt_table_model->total_Ca()/Cagpm * 2;
-   double mg   = this->m_salt_table_model->total_Mg()/Mggpm * 2;
-   double hco3 = this->m_salt_table_model->total_HCO3()/HCO3gpm;
-   double co3  = this->m_salt_table_model->total_CO3()/CO3gpm;
-
-   // The 61 is another magic number from Kai. Sigh
-   // unlike previous calculations, I am getting a mass here so I do not
+   // Unlike previous calculations, I am getting a mass here so I do not
    // need to convert from mg/L
-   double totalDelta = 0.0 - ca/3.5 - mg/7 + (hco3+co3)/61;
-   return totalDelta/m_thickness/mEq;
+   double totalDelta = WaterChemistrySolver::alkalinity_mEq(this->m_salt_table_model->total_Ca(),
+                                                            this->m_salt_table_model->total_Mg(),
+                                                            this->m_salt_table_model->total_HCO3(),
+                                                            this->m_salt_table_model->total_CO3());
+   return WaterChemistrySolver::pHShift(totalDelta, m_thickness);
 }
 
 //! \brief Calculates the pH adjustment caused by lactic acid, H3PO4 and/or acid
 //! malts
 double WaterDialog::calculateAcidpH() {
-   const double H3PO4_gpm = 98;
-   const double lactic_gpm = 90;
-   double totalDelta = 0.0;
-
    double lactic_amt   = this->m_salt_table_model->totalAcidWeight(Salt::Types::LACTIC);
    double acidmalt_amt = this->m_salt_table_model->totalAcidWeight(Salt::Types::ACIDMLT);
    double H3PO4_amt    = this->m_salt_table_model->totalAcidWeight(Salt::Types::H3PO4);
 
-   if ( lactic_amt + acidmalt_amt > 0.0 ) {
-      totalDelta += 1000 * (lactic_amt + acidmalt_amt) / lactic_gpm;
-   }
-   if ( H3PO4_amt > 0.0 ) {
-      totalDelta += 1000 * H3PO4_amt / H3PO4_gpm;
-   }
-
-   return totalDelta/mEq/m_thickness;
+   double totalDelta = WaterChemistrySolver::acid_mEq(lactic_amt + acidmalt_amt, H3PO4_amt);
+   return WaterChemistrySolver::pHShift(totalDelta, m_thickness);
 }
 
 //! \brief Calculates the theoretical distilled water mash pH. I make some
@@ -532,6 +604,7 @@ void WaterDialog::saveAndClose() {
 }
 
 void WaterDialog::clearAndClose() {
+   this->m_salt_table_model->restoreSalts();
    setVisible(false);
    return;
 }
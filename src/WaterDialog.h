@@ -64,6 +64,8 @@ public slots:
    void removeSalts();
    void setMashRO(int val);
    void setSpargeRO(int val);
+   //! While \c checked, keep the salts and acid worked out to match the target profile
+   void setMatchTarget(bool checked);
    void saveAndClose();
    void clearAndClose();
 
@@ -83,6 +85,9 @@ private:
    double calculateAddedSaltpH();
    double calculateAcidpH();
 
+   //! \brief Replace the salts with those \c WaterChemistrySolver says best match the target profile and mash pH
+   void solveAdditions();
+
    QVector<SmartDigitWidget *>    m_ppm_digits;
    QVector<SmartDigitWidget *>    m_total_digits;
    WaterListModel *            m_base_combo_list;
@@ -99,6 +104,7 @@ private:
    double                      m_total_grains;
    double                      m_thickness;
    double                      m_weighted_colors;
+   bool                        m_matchTarget;
    WaterSortFilterProxyModel * m_base_filter;
    WaterSortFilterProxyModel * m_target_filter;
 };
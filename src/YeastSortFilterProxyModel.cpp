@@ -42,13 +42,16 @@ bool YeastSortFilterProxyModel::lessThan(const QModelIndex &left,
    auto const columnIndex = static_cast<YeastTableModel::ColumnIndex>(left.column());
     switch (columnIndex) {
       case YeastTableModel::ColumnIndex::Inventory:
-         if (Measurement::qStringToSI(leftYeast.toString(), Measurement::PhysicalQuantity::Volume).quantity() == 0.0 &&
-            this->sortOrder() == Qt::AscendingOrder) {
-            return false;
+         {
+            auto const leftAmount  = Measurement::qStringToSI(leftYeast.toString(),
+                                                              Measurement::PhysicalQuantity::Volume);
+            auto const rightAmount = Measurement::qStringToSI(rightYeast.toString(),
+                                                              Measurement::PhysicalQuantity::Volume);
+            if (leftAmount.quantity() == 0.0 && this->sortOrder() == Qt::AscendingOrder) {
+               return false;
+            }
+            return leftAmount < rightAmount;
          }
-
-         return Measurement::qStringToSI(leftYeast.toString(), Measurement::PhysicalQuantity::Volume) <
-                Measurement::qStringToSI(rightYeast.toString(), Measurement::PhysicalQuantity::Volume);
          // This is a lie. I need to figure out if they are weights or volumes.
          // and then figure some reasonable way to compare weights to volumes.
          // Maybe lying isn't such a bad idea
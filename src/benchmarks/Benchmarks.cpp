@@ -0,0 +1,627 @@
+/*
+ * benchmarks/Benchmarks.cpp is part of Brewtarget, and is copyright the following
+ * authors 2023:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// This is the benchmark runner.  It is a separate executable from the unit test runner because the things it measures
+// need a lot more data than the unit tests use (and take a lot longer to run).  Everything runs against a database
+// of synthetic data (see SyntheticData) generated from a fixed seed, so that results from different builds are
+// comparable.
+//
+// We use our own (very simple) timing harness rather than QBENCHMARK because the Qt 5 version of Qt Test cannot write
+// its results as JSON, and we want results that scripts can easily compare between runs.
+//
+// Usage:
+//    brewtarget_benchmarks [--seed <n>] [--scale <factor>] [--iterations <n>] [--json <file>]
+//
+// Results are written to <file> if specified, otherwise to stdout.
+//
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <xercesc/util/PlatformUtils.hpp>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QTableView>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+#include "Application.h"
+#include "BtTreeModel.h"
+#include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/SyntheticData.h"
+#include "HopSortFilterProxyModel.h"
+#include "Logging.h"
+#include "measurement/IbuMethods.h"
+#include "measurement/Measurement.h"
+#include "model/BrewNote.h"
+#include "model/Equipment.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Instruction.h"
+#include "model/Inventory.h"
+#include "model/Mash.h"
+#include "model/MashStep.h"
+#include "model/Misc.h"
+#include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "model/Salt.h"
+#include "model/Style.h"
+#include "model/Water.h"
+#include "model/Yeast.h"
+#include "PersistentSettings.h"
+#include "RecipeSimilarity.h"
+#include "tableModels/HopTableModel.h"
+#include "xml/BeerXml.h"
+
+namespace {
+
+   /**
+    * \brief Collects the timings for each benchmark and turns them into JSON
+    */
+   class Results {
+   public:
+      /**
+       * \param name What was measured, in the form "area/operation"
+       * \param itemsPerIteration How many things (recipes, hops, strings etc) were processed in each iteration, so
+       *                          that results at different scales can be compared
+       * \param samples_ns Time taken by each iteration, in nanoseconds
+       */
+      void add(QString const & name, int const itemsPerIteration, QVector<qint64> samples_ns) {
+         if (samples_ns.isEmpty()) {
+            qWarning() << Q_FUNC_INFO << "No samples for" << name;
+            return;
+         }
+         std::sort(samples_ns.begin(), samples_ns.end());
+         qint64 const total_ns = std::accumulate(samples_ns.cbegin(), samples_ns.cend(), qint64{0});
+         qint64 const median_ns = samples_ns.size() % 2 ?
+            samples_ns.at(samples_ns.size() / 2) :
+            (samples_ns.at(samples_ns.size() / 2 - 1) + samples_ns.at(samples_ns.size() / 2)) / 2;
+
+         QJsonObject result;
+         result["name"             ] = name;
+         result["itemsPerIteration"] = itemsPerIteration;
+         result["iterations"       ] = samples_ns.size();
+         // JSON numbers are doubles, which is fine for nanosecond counts up to about 100 days
+         result["minNs"            ] = static_cast<double>(samples_ns.first());
+         result["medianNs"         ] = static_cast<double>(median_ns);
+         result["meanNs"           ] = static_cast<double>(total_ns) / samples_ns.size();
+         result["maxNs"            ] = static_cast<double>(samples_ns.last());
+         if (itemsPerIteration > 0) {
+            result["medianNsPerItem"] = static_cast<double>(median_ns) / itemsPerIteration;
+         }
+         this->results.append(result);
+
+         // Give some feedback as we go, as the whole run can take a while
+         std::cerr <<
+            name.toStdString() << ": median " << median_ns / 1000 << " us for " << itemsPerIteration << " items" <<
+            std::endl;
+         return;
+      }
+
+      QJsonArray const & toJson() const {
+         return this->results;
+      }
+
+   private:
+      QJsonArray results;
+   };
+
+   /**
+    * \brief Run \c func once to warm up (caches, lazy initialisation etc), then \c iterations more times, timing each
+    *        of the latter runs.
+    */
+   QVector<qint64> timeIterations(int const iterations, std::function<void(int)> func) {
+      func(-1);
+      QVector<qint64> samples_ns;
+      samples_ns.reserve(iterations);
+      QElapsedTimer timer;
+      for (int iteration = 0; iteration < iterations; ++iteration) {
+         timer.start();
+         func(iteration);
+         samples_ns.append(timer.nsecsElapsed());
+      }
+      return samples_ns;
+   }
+
+   //
+   // Options that the parent process passes to the child process it uses to measure loading from the database
+   //
+   char const * const measureLoadOptionName = "measure-load";
+   char const * const jsonOptionName        = "json";
+
+   //
+   // The order in which we trigger the loading of each object store.  Things that other things refer to come first,
+   // so that each store's time is (as far as possible) just its own loading.
+   //
+   struct ObjectStoreLoader {
+      char const * name;
+      std::function<void()> load;
+      //! How many objects the store has (once loaded)
+      std::function<int()> count;
+   };
+   template<class NE> ObjectStoreLoader makeLoader(char const * name) {
+      // The first call to getInstance() is what calls loadAll()
+      return ObjectStoreLoader{name,
+                               []() { ObjectStoreTyped<NE>::getInstance(); },
+                               []() { return ObjectStoreTyped<NE>::getInstance().getAllRaw().size(); }};
+   }
+   QVector<ObjectStoreLoader> const objectStoreLoaders {
+      makeLoader<Equipment           >("Equipment"           ),
+      makeLoader<Fermentable         >("Fermentable"         ),
+      makeLoader<Hop                 >("Hop"                 ),
+      makeLoader<Misc                >("Misc"                ),
+      makeLoader<Salt                >("Salt"                ),
+      makeLoader<Style               >("Style"               ),
+      makeLoader<Water               >("Water"               ),
+      makeLoader<Yeast               >("Yeast"               ),
+      makeLoader<InventoryFermentable>("InventoryFermentable"),
+      makeLoader<InventoryHop        >("InventoryHop"        ),
+      makeLoader<InventoryMisc       >("InventoryMisc"       ),
+      makeLoader<InventoryYeast      >("InventoryYeast"      ),
+      makeLoader<MashStep            >("MashStep"            ),
+      makeLoader<Mash                >("Mash"                ),
+      makeLoader<Instruction         >("Instruction"         ),
+      makeLoader<Recipe              >("Recipe"              ),
+      makeLoader<BrewNote            >("BrewNote"            ),
+   };
+
+   /**
+    * \brief Child process mode: open the database in \c userDataDir, time how long each object store takes to load
+    *        everything from it, and write the results to \c jsonFileName.  This is a JSON object with a "timings"
+    *        object (name -> nanoseconds) and a "counts" object (name -> number of objects loaded).  Opening the
+    *        database ("open") doesn't load any objects, and "total" covers all of them.
+    *
+    *        We need a separate process for this because each object store only loads from the database once per
+    *        process.
+    */
+   int measureLoad(QString const & userDataDir, QString const & jsonFileName) {
+      PersistentSettings::initialise(userDataDir);
+      Logging::initializeLogging();
+      Logging::setLogLevel(Logging::LogLevel_WARNING);
+      Logging::setDirectory(userDataDir, Logging::NewDirectoryIsTemporary);
+      Application::setInteractive(false);
+
+      QJsonObject timings;
+      QJsonObject counts;
+      QElapsedTimer totalTimer;
+      totalTimer.start();
+      if (!Application::initialize()) {
+         qCritical() << Q_FUNC_INFO << "Unable to open database in" << userDataDir;
+         return EXIT_FAILURE;
+      }
+      timings["open"] = static_cast<double>(totalTimer.nsecsElapsed());
+      counts["open"] = 0;
+
+      QElapsedTimer timer;
+      for (auto const & loader : objectStoreLoaders) {
+         timer.start();
+         loader.load();
+         timings[loader.name] = static_cast<double>(timer.nsecsElapsed());
+      }
+      timings["total"] = static_cast<double>(totalTimer.nsecsElapsed());
+
+      // Counting goes through every object, so we do it after all the timings
+      int totalCount = 0;
+      for (auto const & loader : objectStoreLoaders) {
+         int const count = loader.count();
+         counts[loader.name] = count;
+         totalCount += count;
+      }
+      counts["total"] = totalCount;
+
+      QFile jsonFile{jsonFileName};
+      if (!jsonFile.open(QIODevice::WriteOnly)) {
+         qCritical() << Q_FUNC_INFO << "Unable to write to" << jsonFileName;
+         return EXIT_FAILURE;
+      }
+      jsonFile.write(QJsonDocument{QJsonObject{{"timings", timings}, {"counts", counts}}}.toJson());
+      jsonFile.close();
+
+      Application::cleanup();
+      Logging::terminateLogging();
+      return EXIT_SUCCESS;
+   }
+
+   /**
+    * \brief Time loading of the database in \c userDataDir by running ourselves in \c measureLoad mode \c iterations
+    *        times.  Each store's result is per object of that store, as counted by the child process.
+    */
+   void benchmarkLoadAll(Results & results, QString const & userDataDir, int const iterations) {
+      QTemporaryDir jsonDir;
+      QString const jsonFileName = jsonDir.filePath("load.json");
+      QMap<QString, QVector<qint64>> samplesByName;
+      // Every run loads the same database, so the counts are the same each time
+      QJsonObject counts;
+      for (int iteration = 0; iteration < iterations; ++iteration) {
+         int const exitCode = QProcess::execute(
+            QCoreApplication::applicationFilePath(),
+            {QString{"--%1"}.arg(measureLoadOptionName), userDataDir,
+             QString{"--%1"}.arg(jsonOptionName), jsonFileName}
+         );
+         QFile jsonFile{jsonFileName};
+         if (exitCode != EXIT_SUCCESS || !jsonFile.open(QIODevice::ReadOnly)) {
+            qCritical() << Q_FUNC_INFO << "Load measurement process failed with exit code" << exitCode;
+            return;
+         }
+         QJsonObject const measurements = QJsonDocument::fromJson(jsonFile.readAll()).object();
+         QJsonObject const timings = measurements["timings"].toObject();
+         for (auto ii = timings.constBegin(); ii != timings.constEnd(); ++ii) {
+            samplesByName[ii.key()].append(static_cast<qint64>(ii.value().toDouble()));
+         }
+         counts = measurements["counts"].toObject();
+      }
+      for (auto ii = samplesByName.constBegin(); ii != samplesByName.constEnd(); ++ii) {
+         results.add(QString{"objectStore/loadAll/%1"}.arg(ii.key()), counts[ii.key()].toInt(), ii.value());
+      }
+      return;
+   }
+
+   void benchmarkUpdateProperty(Results & results, SyntheticData const & data, int const iterations) {
+      auto const & hops = data.hops();
+      // Each iteration changes the value, so that we always write to the database
+      results.add(
+         "objectStore/updateProperty",
+         hops.size(),
+         timeIterations(iterations, [&hops](int const iteration) {
+            double const delta = (iteration % 2) ? -0.1 : 0.1;
+            for (auto const & hop : hops) {
+               hop->setAlpha_pct(hop->alpha_pct() + delta);
+            }
+         })
+      );
+      return;
+   }
+
+   void benchmarkRecipeCalcs(Results & results, SyntheticData const & data, int const iterations) {
+      auto const & recipes = data.recipes();
+      //
+      // This is what Recipe::recalcAll() does, minus setting and emitting the results (which would mostly measure the
+      // cost of writing them to the database -- covered by objectStore/updateProperty).
+      //
+      results.add(
+         "recipe/recalcAll",
+         recipes.size(),
+         timeIterations(iterations, [&recipes](int) {
+            for (auto const & recipe : recipes) {
+               RecipeCalcs::Results const calcs = RecipeCalcs::calcAll(RecipeSnapshot::create(*recipe));
+               Q_UNUSED(calcs)
+            }
+         })
+      );
+      return;
+   }
+
+   /**
+    * \brief Compare the batched IBU calculation with doing one hop at a time, for every hop in every recipe, using
+    *        each formula.  (Volume and gravity are the same for every hop, as they'd otherwise need a full recalc.)
+    */
+   void benchmarkIbu(Results & results, SyntheticData const & data, int const iterations) {
+      IbuMethods::HopAdditions hopAdditions;
+      for (auto const & recipe : data.recipes()) {
+         RecipeSnapshot const snapshot = RecipeSnapshot::create(*recipe);
+         for (auto const & hop : snapshot.hops) {
+            hopAdditions.append(hop.alpha_pct / 100.0, hop.amount_kg * 1000.0, 20.0, 1.055, hop.time_min);
+         }
+      }
+      int const numHops = static_cast<int>(hopAdditions.size());
+      std::vector<double> ibus(hopAdditions.size());
+
+      IbuMethods::IbuType const oldIbuFormula = IbuMethods::ibuFormula;
+      for (auto const formula : {IbuMethods::TINSETH, IbuMethods::RAGER, IbuMethods::NOONAN}) {
+         IbuMethods::ibuFormula = formula;
+         QString const formulaName = IbuMethods::ibuFormulaName().toLower();
+         results.add(
+            QString{"ibu/%1/single"}.arg(formulaName),
+            numHops,
+            timeIterations(iterations, [&hopAdditions, &ibus](int) {
+               for (std::size_t ii = 0; ii < hopAdditions.size(); ++ii) {
+                  ibus[ii] = IbuMethods::getIbus(hopAdditions.AArating[ii],
+                                                 hopAdditions.hops_grams[ii],
+                                                 hopAdditions.finalVolume_liters[ii],
+                                                 hopAdditions.wort_grav[ii],
+                                                 hopAdditions.minutes[ii]);
+               }
+            })
+         );
+         results.add(
+            QString{"ibu/%1/batch"}.arg(formulaName),
+            numHops,
+            timeIterations(iterations, [&hopAdditions, &ibus](int) {
+               IbuMethods::getIbus(hopAdditions, ibus.data());
+            })
+         );
+      }
+      IbuMethods::ibuFormula = oldIbuFormula;
+      return;
+   }
+
+   /**
+    * \brief Building the recipe feature vectors from scratch, and then a nearest-neighbour search across all of them
+    */
+   void benchmarkSimilarity(Results & results, SyntheticData const & data, int const iterations) {
+      auto const & recipes = data.recipes();
+      if (recipes.isEmpty()) {
+         return;
+      }
+      RecipeSimilarity & recipeSimilarity = RecipeSimilarity::getInstance();
+      // The first call also calculates any recipes that haven't been, which isn't what we're measuring here
+      int const numRecipes = recipeSimilarity.size();
+      results.add(
+         "similarity/index",
+         numRecipes,
+         timeIterations(iterations, [&recipeSimilarity](int) {
+            recipeSimilarity.invalidateAll();
+            recipeSimilarity.size();
+         })
+      );
+      results.add(
+         "similarity/findSimilar",
+         numRecipes,
+         timeIterations(iterations, [&recipeSimilarity, &recipes](int const iteration) {
+            auto const & recipe = recipes.at(std::max(iteration, 0) % recipes.size());
+            recipeSimilarity.findSimilar(recipe->key(), 10);
+         })
+      );
+      return;
+   }
+
+   void benchmarkBeerXml(Results & results, SyntheticData const & data, int const iterations) {
+      QTemporaryDir xmlDir;
+      BeerXML & beerXml = BeerXML::getInstance();
+
+      QList<Recipe const *> allRecipes;
+      for (auto const & recipe : data.recipes()) {
+         allRecipes.append(recipe.get());
+      }
+      QString const exportFileName = xmlDir.filePath("export.xml");
+      results.add(
+         "beerXml/export",
+         allRecipes.size(),
+         timeIterations(iterations, [&](int) {
+            QFile outFile{exportFileName};
+            outFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            beerXml.createXmlFile(outFile);
+            beerXml.toXml(allRecipes, outFile);
+            outFile.close();
+         })
+      );
+
+      //
+      // For import, we use a smaller file, because every import adds to the database.  (Since we're importing recipes
+      // that are already in the database, this is a fair test of how long it takes to spot duplicates.)
+      //
+      QList<Recipe const *> const someRecipes = allRecipes.mid(0, 100);
+      QString const importFileName = xmlDir.filePath("import.xml");
+      QFile importFile{importFileName};
+      importFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+      beerXml.createXmlFile(importFile);
+      beerXml.toXml(someRecipes, importFile);
+      importFile.close();
+      auto importRecipes = [&](int) {
+         QString userMessage;
+         QTextStream userMessageAsStream{&userMessage};
+         if (!beerXml.importFromXML(importFileName, userMessageAsStream)) {
+            qWarning() << Q_FUNC_INFO << "Import failed:" << userMessage;
+         }
+      };
+      results.add("beerXml/import", someRecipes.size(), timeIterations(iterations, importRecipes));
+
+      //
+      // The same import with debug logging turned on, as users are sometimes asked to do when reporting a problem with
+      // importing.  Comparing this with beerXml/import gives the overhead of logging.  (We don't persist the change of
+      // logging level, and put it back afterwards.)
+      //
+      Logging::Level const savedLevel = Logging::getLogLevel();
+      Logging::setLogLevel(Logging::LogLevel_DEBUG, false);
+      results.add("beerXml/importDebugLogging", someRecipes.size(), timeIterations(iterations, importRecipes));
+      Logging::flush();
+      Logging::setLogLevel(savedLevel, false);
+      return;
+   }
+
+   void benchmarkUnitParsing(Results & results, double const scale, int const iterations) {
+      //
+      // A deterministic mix of the sorts of things users type, and that we generate for display and then parse back
+      // when sorting tables
+      //
+      QStringList const templates{"%1 kg", "%1g", "%1 oz", "%1 lb", "%1", "%1 mg"};
+      int const numInputs = std::max(1, static_cast<int>(20000 * scale));
+      QStringList inputs;
+      inputs.reserve(numInputs);
+      for (int ii = 0; ii < numInputs; ++ii) {
+         inputs.append(templates.at(ii % templates.size()).arg(static_cast<double>(ii % 997) / 8.0));
+      }
+      results.add(
+         "measurement/qStringToSI",
+         inputs.size(),
+         timeIterations(iterations, [&inputs](int) {
+            for (auto const & input : inputs) {
+               Measurement::qStringToSI(input, Measurement::PhysicalQuantity::Mass);
+            }
+         })
+      );
+      return;
+   }
+
+   void benchmarkSortProxy(Results & results, int const iterations) {
+      // The table model needs a view to be its parent
+      QTableView tableView;
+      auto hopTableModel = new HopTableModel(&tableView, false);
+      auto hopTableProxy = new HopSortFilterProxyModel(&tableView, false);
+      hopTableProxy->setSourceModel(hopTableModel);
+      tableView.setModel(hopTableProxy);
+      hopTableModel->observeDatabase(true);
+      int const numHops = hopTableModel->rowCount();
+
+      for (auto const column : {HopTableModel::ColumnIndex::Amount,
+                                HopTableModel::ColumnIndex::Inventory,
+                                HopTableModel::ColumnIndex::Name}) {
+         results.add(
+            QString{"sortProxy/hops/%1"}.arg(column == HopTableModel::ColumnIndex::Amount    ? "amount"    :
+                                             column == HopTableModel::ColumnIndex::Inventory ? "inventory" : "name"),
+            numHops,
+            // Alternate the sort order so that every iteration actually has some sorting to do
+            timeIterations(iterations, [hopTableProxy, column](int const iteration) {
+               hopTableProxy->sort(static_cast<int>(column),
+                                   (iteration % 2) ? Qt::AscendingOrder : Qt::DescendingOrder);
+            })
+         );
+      }
+      return;
+   }
+
+   void benchmarkTreeModel(Results & results, int const iterations) {
+      int const numRecipes = ObjectStoreTyped<Recipe>::getInstance().getAllRaw().size();
+      // Constructing the model is what calls BtTreeModel::loadTreeModel()
+      results.add(
+         "btTreeModel/loadTreeModel/recipes",
+         numRecipes,
+         timeIterations(iterations, [](int) {
+            BtTreeModel treeModel{nullptr, BtTreeModel::RECIPEMASK};
+         })
+      );
+      return;
+   }
+}
+
+int main(int argc, char **argv) {
+   // We don't need to show anything, but some of what we measure needs widgets to exist
+   if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+   }
+
+   QApplication app(argc, argv);
+   // As in the unit tests, use different settings from the real application, so that we don't clobber them
+   app.setOrganizationDomain("brewtarget.com/benchmark");
+   app.setApplicationName("brewtarget-benchmark");
+
+   QCommandLineParser parser;
+   QCommandLineOption const seedOption{"seed", "Seed for generating synthetic data (default 1)", "n", "1"};
+   parser.addOption(seedOption);
+   QCommandLineOption const scaleOption{
+      "scale", "Multiplier for the default amount of synthetic data (default 1.0)", "factor", "1.0"
+   };
+   parser.addOption(scaleOption);
+   QCommandLineOption const iterationsOption{
+      "iterations", "Number of timed runs of each benchmark (default 5)", "n", "5"
+   };
+   parser.addOption(iterationsOption);
+   QCommandLineOption const jsonOption{jsonOptionName, "Write results as JSON to <file> rather than stdout", "file"};
+   parser.addOption(jsonOption);
+   // This is for our own use (see measureLoad()) so we don't advertise it
+   QCommandLineOption measureLoadOption{measureLoadOptionName, "", "directory"};
+   measureLoadOption.setFlags(QCommandLineOption::HiddenFromHelp);
+   parser.addOption(measureLoadOption);
+   parser.addHelpOption();
+   parser.process(app);
+
+   try {
+      xercesc::XMLPlatformUtils::Initialize();
+   } catch (xercesc::XMLException const & xercesInitException) {
+      qCritical() << Q_FUNC_INFO << "Xerces XML Parser Initialisation Failed: " << xercesInitException.getMessage();
+      return EXIT_FAILURE;
+   }
+
+   if (parser.isSet(measureLoadOption)) {
+      int const exitCode = measureLoad(parser.value(measureLoadOption), parser.value(jsonOption));
+      xercesc::XMLPlatformUtils::Terminate();
+      return exitCode;
+   }
+
+   quint32 const seed       = parser.value(seedOption).toUInt();
+   double  const scale      = parser.value(scaleOption).toDouble();
+   int     const iterations = std::max(1, parser.value(iterationsOption).toInt());
+
+   // All data, including the database, goes in a temporary directory that is deleted when we finish
+   QTemporaryDir userDataDir;
+   PersistentSettings::initialise(userDataDir.path());
+   PersistentSettings::insert(PersistentSettings::Names::dbType, static_cast<int>(Database::DbType::SQLITE));
+   Logging::initializeLogging();
+   // We don't want to be measuring the speed of logging!
+   Logging::setLogLevel(Logging::LogLevel_WARNING);
+   Logging::setDirectory(userDataDir.path(), Logging::NewDirectoryIsTemporary);
+   Application::setInteractive(false);
+   if (!Application::initialize()) {
+      qCritical() << Q_FUNC_INFO << "Unable to create database in" << userDataDir.path();
+      return EXIT_FAILURE;
+   }
+
+   Results results;
+
+   SyntheticData data{seed};
+   {
+      QElapsedTimer timer;
+      timer.start();
+      data.generate(SyntheticData::Counts::forScale(scale));
+      results.add("syntheticData/generate", data.numObjectsStored(), {timer.nsecsElapsed()});
+   }
+
+   benchmarkLoadAll       (results, userDataDir.path(), iterations);
+   benchmarkUpdateProperty(results, data,               iterations);
+   benchmarkRecipeCalcs   (results, data,               iterations);
+   benchmarkIbu           (results, data,               iterations);
+   benchmarkSimilarity    (results, data,               iterations);
+   benchmarkUnitParsing   (results, scale,              iterations);
+   benchmarkSortProxy     (results,                     iterations);
+   benchmarkTreeModel     (results,                     iterations);
+   // This goes last as importing adds to the database
+   benchmarkBeerXml       (results, data,               iterations);
+
+   QJsonObject output;
+   output["seed"      ] = static_cast<double>(seed);
+   output["scale"     ] = scale;
+   output["iterations"] = iterations;
+   output["qtVersion" ] = QString{qVersion()};
+   output["benchmarks"] = results.toJson();
+   QByteArray const json = QJsonDocument{output}.toJson();
+   if (parser.isSet(jsonOption)) {
+      QFile jsonFile{parser.value(jsonOption)};
+      if (!jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+         qCritical() << Q_FUNC_INFO << "Unable to write to" << jsonFile.fileName();
+         return EXIT_FAILURE;
+      }
+      jsonFile.write(json);
+      jsonFile.close();
+   } else {
+      std::cout << json.toStdString();
+   }
+
+   Application::cleanup();
+   Logging::terminateLogging();
+   xercesc::XMLPlatformUtils::Terminate();
+   return EXIT_SUCCESS;
+}
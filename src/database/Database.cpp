@@ -62,9 +62,11 @@
 #include "config.h"
 #include "database/BtSqlQuery.h"
 #include "database/DatabaseSchemaHelper.h"
+#include "Logging.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
 #include "utils/EnumStringMapping.h"
+#include "utils/Instrumentation.h"
 
 namespace {
    EnumStringMapping const dbTypeToName {
@@ -564,7 +566,7 @@ QSqlDatabase Database::sqlDatabase() const {
    Q_ASSERT(!connectionName.isEmpty());
    QSqlDatabase connection = QSqlDatabase::database(connectionName);
    if (connection.isValid()) {
-      qDebug() << Q_FUNC_INFO << "Returning connection " << connectionName;
+      qCDebug(Logging::database) << Q_FUNC_INFO << "Returning connection " << connectionName;
       return connection;
    }
 
@@ -629,6 +631,8 @@ QSqlDatabase Database::sqlDatabase() const {
 }
 
 bool Database::load() {
+   BT_TIME_SCOPE("Database::load");
+
    this->pimpl->createFromScratch = false;
    this->pimpl->schemaUpdated = false;
    this->pimpl->loadWasSuccessful = false;
@@ -43,7 +43,7 @@
 #include "model/Water.h"
 #include "xml/BeerXml.h"
 
-int const DatabaseSchemaHelper::dbVersion = 10;
+int const DatabaseSchemaHelper::dbVersion = 11;
 
 namespace {
    char const * const FOLDER_FOR_SUPPLIED_RECIPES = "brewtarget";
@@ -530,6 +530,24 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
+   //
+   // Previous versions of a Recipe can now share Hop/Fermentable/etc rows with the current version, so we need to be
+   // able to find quickly all the Recipes using a given row (eg when the DB checks foreign key constraints on
+   // deletion).  We therefore index the "other side" of the recipe junction tables.
+   //
+   bool migrate_to_11([[maybe_unused]] Database & db, BtSqlQuery q) {
+      QVector<QueryAndParameters> const migrationQueries{
+         {QString("CREATE INDEX IF NOT EXISTS fermentable_in_recipe_fermentable_id_idx ON fermentable_in_recipe (fermentable_id)")},
+         {QString("CREATE INDEX IF NOT EXISTS hop_in_recipe_hop_id_idx                 ON hop_in_recipe         (hop_id)"        )},
+         {QString("CREATE INDEX IF NOT EXISTS instruction_in_recipe_instruction_id_idx ON instruction_in_recipe (instruction_id)")},
+         {QString("CREATE INDEX IF NOT EXISTS misc_in_recipe_misc_id_idx               ON misc_in_recipe        (misc_id)"       )},
+         {QString("CREATE INDEX IF NOT EXISTS salt_in_recipe_salt_id_idx               ON salt_in_recipe        (salt_id)"       )},
+         {QString("CREATE INDEX IF NOT EXISTS water_in_recipe_water_id_idx             ON water_in_recipe       (water_id)"      )},
+         {QString("CREATE INDEX IF NOT EXISTS yeast_in_recipe_yeast_id_idx             ON yeast_in_recipe       (yeast_id)"      )}
+      };
+      return executeSqlQueries(q, migrationQueries);
+   }
+
    /*!
     * \brief Migrate from version \c oldVersion to \c oldVersion+1
     */
@@ -567,6 +585,9 @@ namespace {
          case 9:
             ret &= migrate_to_10(database, sqlQuery);
             break;
+         case 10:
+            ret &= migrate_to_11(database, sqlQuery);
+            break;
          default:
             qCritical() << QString("Unknown version %1").arg(oldVersion);
             return false;
@@ -634,6 +655,14 @@ bool DatabaseSchemaHelper::create(Database & database, QSqlDatabase connection)
       return false;
    }
 
+   //
+   // Indexes aren't part of the table definitions, so we add them separately.  The ones added in migrate_to_11 are the
+   // only ones we have at the moment, so it's simplest just to reuse that.
+   //
+   if (!migrate_to_11(database, sqlQuery)) {
+      return false;
+   }
+
    // If we got here, everything went well, so we can commit the DB transaction now, otherwise it will have aborted when
    // we returned from an error branch above.
    dbTransaction.commit();
@@ -19,16 +19,50 @@
 #include "database/DbTransaction.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QSqlError>
 
 #include "database/Database.h"
 
+namespace {
+   /**
+    * \brief What we need to know about the outermost transaction on a connection so that nested ones can join it
+    */
+   struct TransactionState {
+      int depth = 0;
+      bool nestedRollback = false;
+   };
+
+   //
+   // QSqlDatabase connections are per-thread, so we keep the per-connection state per-thread too, which saves us
+   // needing a mutex.
+   //
+   TransactionState & transactionState(QSqlDatabase const & connection) {
+      static thread_local QHash<QString, TransactionState> states;
+      return states[connection.connectionName()];
+   }
+}
 
 DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbTransaction::SpecialBehaviours specialBehaviours) :
    database{database},
    connection{connection},
    committed{false},
-   specialBehaviours{specialBehaviours} {
+   specialBehaviours{specialBehaviours},
+   nested{false} {
+   TransactionState & state = transactionState(this->connection);
+   if (state.depth > 0) {
+      // We're inside another transaction, so we just become part of it
+      this->nested = true;
+      ++state.depth;
+      if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
+         // Turning foreign keys off doesn't work inside a transaction (see below)
+         qWarning() << Q_FUNC_INFO << "Cannot disable foreign keys in a nested transaction";
+         this->specialBehaviours = NONE;
+      }
+      qDebug() << Q_FUNC_INFO << "Joining existing database transaction (depth" << state.depth << ")";
+      return;
+   }
+
    // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have to
    // be careful about the order in which we do things.
    if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
@@ -40,11 +74,24 @@ DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbT
    if (!succeeded) {
       qCritical() << Q_FUNC_INFO << "Unable to start database transaction:" << connection.lastError().text();
    }
+   state.depth = 1;
+   state.nestedRollback = false;
    return;
 }
 
 DbTransaction::~DbTransaction() {
    qDebug() << Q_FUNC_INFO;
+   TransactionState & state = transactionState(this->connection);
+   --state.depth;
+   if (this->nested) {
+      if (!this->committed) {
+         // We can't roll back just part of the transaction, so make sure the whole thing gets rolled back
+         qWarning() << Q_FUNC_INFO << "Nested database transaction rolled back, so outer one will be too";
+         state.nestedRollback = true;
+      }
+      return;
+   }
+
    if (!committed) {
       bool succeeded = this->connection.rollback();
       qDebug() << Q_FUNC_INFO << "Database transaction rollback: " << (succeeded ? "succeeded" : "failed");
@@ -61,6 +108,17 @@ DbTransaction::~DbTransaction() {
 }
 
 bool DbTransaction::commit() {
+   if (this->nested) {
+      // The outermost transaction will do the real commit
+      this->committed = true;
+      return true;
+   }
+
+   if (transactionState(this->connection).nestedRollback) {
+      qCritical() << Q_FUNC_INFO << "Not committing database transaction as a nested one failed";
+      return false;
+   }
+
    this->committed = connection.commit();
    qDebug() << Q_FUNC_INFO << "Database transaction commit: " << (this->committed ? "succeeded" : "failed");
    if (!this->committed) {
@@ -26,6 +26,10 @@ class Database;
 
 /**
  * \brief RAII wrapper for transaction(), commit(), rollback() member functions of QSqlDatabase
+ *
+ *        Transactions can be nested (eg \c Recipe::EditSession wraps lots of calls to \c ObjectStore::updateProperty,
+ *        each of which has its own \c DbTransaction).  An inner \c DbTransaction just becomes part of the outermost
+ *        one: its \c commit() does nothing, and, if it is rolled back, the outermost one will be rolled back too.
  */
 class DbTransaction {
 public:
@@ -58,6 +62,8 @@ private:
    QSqlDatabase & connection;
    bool committed;
    int specialBehaviours;
+   //! \c true if there was already a transaction in progress on this connection when we were constructed
+   bool nested;
 
    // RAII class shouldn't be getting copied or moved
    DbTransaction(DbTransaction const &) = delete;
@@ -34,7 +34,9 @@
 #include "database/Database.h"
 #include "database/DbTransaction.h"
 #include "Logging.h"
+#include "model/NamedEntity.h"
 #include "model/NamedParameterBundle.h"
+#include "utils/Instrumentation.h"
 #include "utils/OptionalHelpers.h"
 
 // Private implementation details that don't need access to class member variables
@@ -463,6 +465,62 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Change one foreign key value in the rows relating to a particular object in a junction table
+    *
+    * \param junctionTable
+    * \param primaryKey
+    * \param oldValue
+    * \param newValue
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool replaceInJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                         QVariant const & primaryKey,
+                                         int const oldValue,
+                                         int const newValue,
+                                         QSqlDatabase & connection) {
+      qDebug() <<
+         Q_FUNC_INFO << "Replacing" << oldValue << "with" << newValue << "for property" <<
+         GetJunctionTableDefinitionPropertyName(junctionTable) << "in junction table" << junctionTable.tableName;
+
+      QString const thisPrimaryKeyBindName =
+         QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
+
+      //
+      // Construct the UPDATE query, which will be of the form
+      //
+      //    UPDATE junctionTable
+      //    SET otherPrimaryKeyColumn = :newValue
+      //    WHERE thisPrimaryKeyColumn = :thisPrimaryKeyColumn AND otherPrimaryKeyColumn = :oldValue;
+      //
+      // Note that any order-by column is left alone, as the new value takes the place of the old one.
+      //
+      QString queryString{"UPDATE "};
+      QTextStream queryStringAsStream{&queryString};
+      queryStringAsStream <<
+         junctionTable.tableName << " SET " << GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) <<
+         " = :newValue WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " = " <<
+         thisPrimaryKeyBindName << " AND " << GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) <<
+         " = :oldValue;";
+
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare(queryString);
+      sqlQuery.bindValue(":newValue", newValue);
+      sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
+      sqlQuery.bindValue(":oldValue", oldValue);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      return true;
+   }
+
    /**
     * \brief Force a QVariant to be a specific type.  Called from \c unwrapAndMapAsNeeded
     */
@@ -842,6 +900,20 @@ public:
     *
     * \return \c true if succeeded, \c false otherwise
     */
+   /**
+    * \brief Read the value of a property that has just been changed, so we can write it to the DB.  Where the property
+    *        is stored in a simple member variable, we read that directly (see \c MemberAccess) rather than going
+    *        through the Qt property system.
+    */
+   QVariant readPropertyToUpdate(QObject const & object, BtStringConst const & propertyName) const {
+      MemberAccess const * memberAccess = this->typeLookup.getMemberAccess(propertyName);
+      if (memberAccess && memberAccess->readAsVariant) {
+         // We only get member access for properties of NamedEntity subclasses, so this cast is safe
+         return memberAccess->readAsVariant(static_cast<NamedEntity const &>(object));
+      }
+      return object.property(*propertyName);
+   }
+
    bool updatePropertyInDb(QSqlDatabase & connection, QObject const & object, BtStringConst const & propertyName) {
       // We'll need some of this info even if it's a junction table property we're updating
       BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
@@ -876,7 +948,7 @@ public:
          queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
          queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
 
-         qDebug() <<
+         qCDebug(Logging::objectStore) <<
             Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
             "with database query" << queryString;
 
@@ -885,7 +957,7 @@ public:
          //
          BtSqlQuery sqlQuery{connection};
          sqlQuery.prepare(queryString);
-         QVariant propertyBindValue{object.property(*propertyName)};
+         QVariant propertyBindValue{this->readPropertyToUpdate(object, propertyName)};
          auto fieldDefn = std::find_if(
             this->primaryTable.tableFields.begin(),
             this->primaryTable.tableFields.end(),
@@ -910,13 +982,14 @@ public:
             //
             Q_ASSERT(ObjectStore::FieldType::Int == fieldDefn->fieldType);
             if (propertyBindValue.toInt() <= 0) {
-               qDebug() << Q_FUNC_INFO << "Treating" << propertyBindValue << "foreign key value as NULL";
+               qCDebug(Logging::objectStore) <<
+                  Q_FUNC_INFO << "Treating" << propertyBindValue << "foreign key value as NULL";
                propertyBindValue = QVariant(QVariant::Int);
             }
          }
          sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), propertyBindValue);
          sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
-         qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+         qCDebug(Logging::objectStore).noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
 
          //
          // Run the query
@@ -951,7 +1024,7 @@ public:
          // As elsewhere, the simplest way to update a junction table is to blat any rows relating to the current object
          // and then write out data based on the current property values.
          //
-         qDebug() <<
+         qCDebug(Logging::objectStore) <<
             Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
             "in junction table" << matchingJunctionTableDefinitionDefn->tableName;
          if (!deleteFromJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, primaryKey, connection)) {
@@ -1211,6 +1284,8 @@ bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connec
 }
 
 void ObjectStore::loadAll(Database * database) {
+   BT_TIME_SCOPE("ObjectStore::loadAll");
+
    if (database) {
       this->pimpl->database = database;
    } else {
@@ -1509,6 +1584,8 @@ QList<std::shared_ptr<QObject> > ObjectStore::getByIds(QVector<int> const & list
 }
 
 int ObjectStore::insert(std::shared_ptr<QObject> object) {
+   BT_TIME_SCOPE("ObjectStore::insert");
+
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1548,6 +1625,8 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
 }
 
 void ObjectStore::update(std::shared_ptr<QObject> object) {
+   BT_TIME_SCOPE("ObjectStore::update");
+
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1673,7 +1752,13 @@ int ObjectStore::insertOrUpdate(QObject & object) {
    return this->pimpl->getPrimaryKey(object).toInt();
 }
 
+TypeLookup const & ObjectStore::getTypeLookup() const {
+   return this->pimpl->typeLookup;
+}
+
 void ObjectStore::updateProperty(QObject const & object, BtStringConst const & propertyName) {
+   BT_TIME_SCOPE("ObjectStore::updateProperty");
+
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    QSqlDatabase connection = this->pimpl->database->sqlDatabase();
@@ -1693,6 +1778,46 @@ void ObjectStore::updateProperty(QObject const & object, BtStringConst const & p
    return;
 }
 
+void ObjectStore::replaceJunctionValue(QObject const & object,
+                                       BtStringConst const & propertyName,
+                                       int const oldValue,
+                                       int const newValue) {
+   BT_TIME_SCOPE("ObjectStore::replaceJunctionValue");
+
+   auto matchingJunctionTableDefinitionDefn = std::find_if(
+      this->pimpl->junctionTables.begin(),
+      this->pimpl->junctionTables.end(),
+      [propertyName](JunctionTableDefinition const & jt) {
+         return GetJunctionTableDefinitionPropertyName(jt) == propertyName;
+      }
+   );
+
+   // It's a coding error to call this for a property that isn't stored in a junction table
+   if (matchingJunctionTableDefinitionDefn == this->pimpl->junctionTables.end()) {
+      qCritical() <<
+         Q_FUNC_INFO << "Unable to find junction table for property" << object.metaObject()->className() << "::" <<
+         propertyName;
+      Q_ASSERT(false);
+      return;
+   }
+
+   // Start transaction
+   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
+   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
+   DbTransaction dbTransaction{*this->pimpl->database, connection};
+
+   if (!replaceInJunctionTableDefinition(*matchingJunctionTableDefinitionDefn,
+                                         this->pimpl->getPrimaryKey(object),
+                                         oldValue,
+                                         newValue,
+                                         connection)) {
+      return;
+   }
+
+   dbTransaction.commit();
+   return;
+}
+
 std::shared_ptr<QObject>  ObjectStore::defaultSoftDelete(int id) {
    //
    // We assume on soft-delete that there is nothing to do on related objects - eg if a Mash is soft deleted (ie marked
@@ -295,6 +295,29 @@ public:
     */
    void updateProperty(QObject const & object, BtStringConst const & propertyName);
 
+   /**
+    * \brief For a property stored in a junction table, where one value in the list has been replaced by another (eg
+    *        when a Recipe swaps a Hop it shares with another Recipe for its own copy of that Hop), update just the
+    *        affected row(s) rather than rewriting all the rows for the object as \c updateProperty would.
+    *
+    *        Unlike \c updateProperty, this does not emit \c signalPropertyChanged, as it is intended for changes that
+    *        are not visible to the user.
+    *
+    * \param object The object whose property has been changed (ie which already holds \c newValue)
+    * \param propertyName
+    * \param oldValue The foreign key that was previously in the list
+    * \param newValue The foreign key that replaced \c oldValue
+    */
+   void replaceJunctionValue(QObject const & object,
+                             BtStringConst const & propertyName,
+                             int const oldValue,
+                             int const newValue);
+
+   /**
+    * \brief The \c TypeLookup for the class of objects we store
+    */
+   TypeLookup const & getTypeLookup() const;
+
    /**
     * \brief Remove the object from our local in-memory cache
     *
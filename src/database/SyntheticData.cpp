@@ -0,0 +1,427 @@
+/*
+ * database/SyntheticData.cpp is part of Brewtarget, and is copyright the following
+ * authors 2023:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/SyntheticData.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <utility>
+
+#include <QDate>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+
+#include "database/ObjectStoreWrapper.h"
+#include "model/BrewNote.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+#include "model/Recipe.h"
+#include "model/Yeast.h"
+
+namespace {
+   //
+   // Bits of names to combine.  The exact words don't matter, but it's useful to have a mix of names that sort in
+   // different orders, share prefixes, etc.
+   //
+   std::array<char const *, 12> const namePrefixes {
+      "Amber", "Bitter", "Copper", "Dark", "Golden", "Hazy", "Imperial", "Northern", "Old", "Red", "Summit", "Winter"
+   };
+   std::array<char const *, 8> const hopNames {
+      "Aurora", "Bramling", "Challenger", "Fuggle", "Goldings", "Magnum", "Saaz", "Target"
+   };
+   std::array<char const *, 8> const fermentableNames {
+      "Pale Malt", "Pilsner Malt", "Munich Malt", "Crystal", "Chocolate Malt", "Wheat Malt", "Flaked Oats", "Invert Sugar"
+   };
+   std::array<char const *, 6> const yeastNames {
+      "Ale", "Lager", "Saison", "Kolsch", "Weizen", "Belgian"
+   };
+   std::array<char const *, 10> const recipeStyles {
+      "Ale", "Bitter", "IPA", "Lager", "Mild", "Porter", "Saison", "Stout", "Tripel", "Weissbier"
+   };
+   std::array<double, 6> const hopTimes_min {60.0, 45.0, 30.0, 15.0, 5.0, 0.0};
+}
+
+SyntheticData::Counts SyntheticData::Counts::forScale(double const scale) {
+   auto scaled = [scale](int const baseCount) { return std::max(1, static_cast<int>(std::lround(baseCount * scale))); };
+   return Counts{
+      scaled(500),  // hops
+      scaled(300),  // fermentables
+      scaled(100),  // yeasts
+      scaled(2000), // recipes
+      scaled(40),   // folders
+      4,            // hopsPerRecipe
+      5,            // fermentablesPerRecipe
+      1,            // versionsPerRecipe
+      2             // brewNotesPerRecipe
+   };
+}
+
+namespace {
+   struct CountName {
+      char const * name;
+      int SyntheticData::Counts::* member;
+   };
+   std::array<CountName, 11> const countNames {{
+      {"hops",                  &SyntheticData::Counts::hops                 },
+      {"fermentables",          &SyntheticData::Counts::fermentables         },
+      {"yeasts",                &SyntheticData::Counts::yeasts               },
+      {"recipes",               &SyntheticData::Counts::recipes              },
+      {"folders",               &SyntheticData::Counts::folders              },
+      {"hopsPerRecipe",         &SyntheticData::Counts::hopsPerRecipe        },
+      {"fermentablesPerRecipe", &SyntheticData::Counts::fermentablesPerRecipe},
+      {"versionsPerRecipe",     &SyntheticData::Counts::versionsPerRecipe    },
+      {"versions",              &SyntheticData::Counts::versionsPerRecipe    },
+      {"brewNotesPerRecipe",    &SyntheticData::Counts::brewNotesPerRecipe   },
+      {"brewNotes",             &SyntheticData::Counts::brewNotesPerRecipe   },
+   }};
+}
+
+std::optional<SyntheticData::Counts> SyntheticData::Counts::fromString(QString const & specification) {
+   //
+   // We need to know the scale before we can apply anything else, so first split everything up and find the scale
+   //
+   QList<std::pair<QString, QString>> namesAndValues;
+   double scale = 1.0;
+   for (QString const & pair : specification.split(',')) {
+      if (pair.trimmed().isEmpty()) {
+         continue;
+      }
+      QStringList const nameAndValue = pair.split('=');
+      if (nameAndValue.size() != 2) {
+         qWarning() << Q_FUNC_INFO << "Expected name=value but got" << pair;
+         return std::nullopt;
+      }
+      QString const name  = nameAndValue.at(0).trimmed();
+      QString const value = nameAndValue.at(1).trimmed();
+      if (name == "scale") {
+         bool ok = false;
+         scale = value.toDouble(&ok);
+         if (!ok || scale <= 0.0) {
+            qWarning() << Q_FUNC_INFO << "Invalid scale" << value;
+            return std::nullopt;
+         }
+         continue;
+      }
+      namesAndValues.append({name, value});
+   }
+
+   Counts counts = Counts::forScale(scale);
+   for (auto const & [name, value] : namesAndValues) {
+      auto const countName = std::find_if(countNames.cbegin(),
+                                          countNames.cend(),
+                                          [&name](CountName const & cn) { return name == cn.name; });
+      if (countName == countNames.cend()) {
+         qWarning() << Q_FUNC_INFO << "Unrecognised name" << name;
+         return std::nullopt;
+      }
+      bool ok = false;
+      int const count = value.toInt(&ok);
+      if (!ok || count < 0) {
+         qWarning() << Q_FUNC_INFO << "Invalid value" << value << "for" << name;
+         return std::nullopt;
+      }
+      counts.*(countName->member) = count;
+   }
+   return counts;
+}
+
+QString SyntheticData::Counts::toString() const {
+   QStringList namesAndValues;
+   for (auto const & countName : countNames) {
+      // Skip the abbreviations
+      if (countName.name == QString{"versions"} || countName.name == QString{"brewNotes"}) {
+         continue;
+      }
+      namesAndValues.append(QString{"%1=%2"}.arg(countName.name).arg(this->*(countName.member)));
+   }
+   return namesAndValues.join(',');
+}
+
+// This private implementation class holds all private non-virtual members of SyntheticData
+class SyntheticData::impl {
+public:
+
+   /**
+    * Constructor
+    */
+   impl(quint32 const seed) : randomNumberGenerator{seed},
+                              hops{},
+                              fermentables{},
+                              yeasts{},
+                              recipes{},
+                              folderPaths{},
+                              numObjectsStored{0} {
+      return;
+   }
+
+   /**
+    * Destructor
+    */
+   ~impl() = default;
+
+   //! \return A number in the range [min, max)
+   double uniform(double const min, double const max) {
+      // std::mt19937 gives 32 random bits; dividing by 2^32 gives a number in [0, 1)
+      double const unit = static_cast<double>(this->randomNumberGenerator()) / 4294967296.0;
+      return min + (max - min) * unit;
+   }
+
+   //! \return A number in the range [0, max)
+   int index(int const max) {
+      return static_cast<int>(this->randomNumberGenerator() % static_cast<quint32>(max));
+   }
+
+   template<typename T, std::size_t N> T const & pick(std::array<T, N> const & choices) {
+      return choices[this->index(N)];
+   }
+
+   //! Roughly 1 in \c n chance of returning \c true
+   bool oneIn(int const n) {
+      return this->index(n) == 0;
+   }
+
+   /**
+    * \brief Set up \c numFolders folder paths, up to two levels deep, for recipes and ingredients to go in.  (The tree
+    *        views create folders from the paths they find, so folders do not need to be stored separately.)
+    */
+   void makeFolderPaths(int const numFolders) {
+      this->folderPaths.clear();
+      int const numTopLevelFolders = std::max(1, static_cast<int>(std::sqrt(numFolders)));
+      for (int ii = 0; ii < numFolders; ++ii) {
+         if (ii < numTopLevelFolders) {
+            this->folderPaths.append(QString{"/Synthetic %1"}.arg(ii + 1));
+         } else {
+            this->folderPaths.append(
+               QString{"/Synthetic %1/Subfolder %2"}.arg(ii % numTopLevelFolders + 1).arg(ii + 1)
+            );
+         }
+      }
+      return;
+   }
+
+   //! \return A folder path or, about one time in ten (or always if there are no folders), an empty string
+   QString folder() {
+      if (this->folderPaths.isEmpty() || this->oneIn(10)) {
+         return QString{};
+      }
+      return this->folderPaths.at(this->index(this->folderPaths.size()));
+   }
+
+   //! Stores \c ne and takes a note of having done so
+   template<class NE> void store(std::shared_ptr<NE> ne) {
+      ObjectStoreWrapper::insert(ne);
+      ++this->numObjectsStored;
+      return;
+   }
+
+   void generateHop(int const serialNumber) {
+      auto hop = std::make_shared<Hop>(QString{"%1 %2 #%3"}.arg(this->pick(namePrefixes))
+                                                           .arg(this->pick(hopNames))
+                                                           .arg(serialNumber));
+      hop->setAlpha_pct(this->uniform(2.0, 18.0));
+      hop->setBeta_pct (this->uniform(2.0, 10.0));
+      hop->setAmount_kg(0.0);
+      hop->setUse(Hop::Use::Boil);
+      hop->setTime_min(60.0);
+      hop->setType(static_cast<Hop::Type>(this->index(3)));
+      hop->setForm(this->oneIn(4) ? Hop::Form::Leaf : Hop::Form::Pellet);
+      hop->setOrigin(this->pick(namePrefixes));
+      hop->setFolder(this->folder());
+      this->store(hop);
+      hop->setInventoryAmount(this->uniform(0.0, 1.0));
+      this->hops.append(hop);
+      return;
+   }
+
+   void generateFermentable(int const serialNumber) {
+      auto fermentable = std::make_shared<Fermentable>(QString{"%1 %2 #%3"}.arg(this->pick(namePrefixes))
+                                                                           .arg(this->pick(fermentableNames))
+                                                                           .arg(serialNumber));
+      // Mostly grains, with the occasional sugar or extract
+      bool const isGrain = !this->oneIn(6);
+      fermentable->setType(isGrain ? Fermentable::Type::Grain :
+                                     (this->oneIn(2) ? Fermentable::Type::Sugar : Fermentable::Type::Dry_Extract));
+      fermentable->setYield_pct(isGrain ? this->uniform(60.0, 82.0) : this->uniform(90.0, 100.0));
+      // Colors are skewed heavily towards pale, as they are in real life
+      fermentable->setColor_srm(1.5 + std::pow(this->uniform(0.0, 1.0), 4.0) * 500.0);
+      fermentable->setMoisture_pct(this->uniform(2.0, 6.0));
+      fermentable->setIsMashed(isGrain);
+      fermentable->setAmount_kg(0.0);
+      fermentable->setFolder(this->folder());
+      this->store(fermentable);
+      fermentable->setInventoryAmount(this->uniform(0.0, 25.0));
+      this->fermentables.append(fermentable);
+      return;
+   }
+
+   void generateYeast(int const serialNumber) {
+      auto yeast = std::make_shared<Yeast>(QString{"%1 %2 #%3"}.arg(this->pick(namePrefixes))
+                                                               .arg(this->pick(yeastNames))
+                                                               .arg(serialNumber));
+      yeast->setType(this->oneIn(4) ? Yeast::Type::Lager : Yeast::Type::Ale);
+      yeast->setForm(this->oneIn(2) ? Yeast::Form::Dry : Yeast::Form::Liquid);
+      yeast->setAttenuation_pct(this->uniform(65.0, 85.0));
+      yeast->setLaboratory(this->pick(namePrefixes));
+      yeast->setProductID(QString::number(1000 + serialNumber));
+      yeast->setFolder(this->folder());
+      this->store(yeast);
+      this->yeasts.append(yeast);
+      return;
+   }
+
+   void generateRecipe(int const serialNumber, Counts const & counts) {
+      auto recipe = std::make_shared<Recipe>(QString{"%1 %2 #%3"}.arg(this->pick(namePrefixes))
+                                                                 .arg(this->pick(recipeStyles))
+                                                                 .arg(serialNumber));
+      double const batchSize_l = this->uniform(10.0, 40.0);
+      recipe->setBatchSize_l(batchSize_l);
+      recipe->setBoilSize_l(batchSize_l * 1.2);
+      recipe->setBoilTime_min(this->oneIn(5) ? 90.0 : 60.0);
+      recipe->setEfficiency_pct(this->uniform(60.0, 85.0));
+      recipe->setBrewer(QString{"Brewer %1"}.arg(this->index(50)));
+      recipe->setFolder(this->folder());
+      // As in MainWindow::newRecipe(), we need the recipe to be stored before we add anything to it
+      this->store(recipe);
+
+      // Adding an ingredient to a recipe stores a copy of it, which we then modify to say how much is used
+      for (int ii = 0; ii < counts.fermentablesPerRecipe && !this->fermentables.isEmpty(); ++ii) {
+         auto fermentable = this->fermentables.at(this->index(this->fermentables.size()));
+         auto added = recipe->add<Fermentable>(fermentable);
+         ++this->numObjectsStored;
+         added->setAmount_kg(batchSize_l * this->uniform(0.005, 0.1));
+      }
+      for (int ii = 0; ii < counts.hopsPerRecipe && !this->hops.isEmpty(); ++ii) {
+         auto hop = this->hops.at(this->index(this->hops.size()));
+         auto added = recipe->add<Hop>(hop);
+         ++this->numObjectsStored;
+         added->setTime_min(this->pick(hopTimes_min));
+         added->setAmount_kg(batchSize_l * this->uniform(0.0002, 0.004));
+      }
+      if (!this->yeasts.isEmpty()) {
+         recipe->add<Yeast>(this->yeasts.at(this->index(this->yeasts.size())));
+         ++this->numObjectsStored;
+      }
+
+      //
+      // Previous versions.  As in RecipeHelper::prepareForPropertyChange(), each one is a copy of the recipe as it was
+      // before the change that created the next version.  Here the "change" is a small tweak to the efficiency.
+      //
+      QList<std::shared_ptr<Recipe>> versions{recipe};
+      if (counts.versionsPerRecipe > 0) {
+         RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
+         for (int ii = 0; ii < counts.versionsPerRecipe; ++ii) {
+            auto previousVersion = std::make_shared<Recipe>(*recipe);
+            this->store(previousVersion);
+            recipe->setAncestor(*previousVersion);
+            recipe->setEfficiency_pct(recipe->efficiency_pct() + this->uniform(-2.0, 2.0));
+            versions.append(previousVersion);
+         }
+      }
+
+      //
+      // Brew notes are shared out between the versions.  Brew dates are spread over the ten years up to a fixed date,
+      // so that they don't depend on when we're run.
+      //
+      QDate const latestBrewDate{2023, 1, 1};
+      for (int ii = 0; ii < counts.brewNotesPerRecipe; ++ii) {
+         auto const & brewedVersion = versions.at(ii % versions.size());
+         auto brewNote = std::make_shared<BrewNote>(*brewedVersion);
+         brewNote->populateNote(brewedVersion.get());
+         brewNote->setBrewDate(latestBrewDate.addDays(-this->index(3650)));
+         this->store(brewNote);
+      }
+
+      this->recipes.append(recipe);
+      return;
+   }
+
+   // Member variables for impl
+   std::mt19937 randomNumberGenerator;
+   QList<std::shared_ptr<Hop>>         hops;
+   QList<std::shared_ptr<Fermentable>> fermentables;
+   QList<std::shared_ptr<Yeast>>       yeasts;
+   QList<std::shared_ptr<Recipe>>      recipes;
+   QStringList folderPaths;
+   int numObjectsStored;
+};
+
+SyntheticData::SyntheticData(quint32 const seed) : pimpl{std::make_unique<impl>(seed)} {
+   return;
+}
+
+// See https://herbsutter.com/gotw/_100/ for why we need to explicitly define the destructor here (and not in the
+// header file)
+SyntheticData::~SyntheticData() = default;
+
+void SyntheticData::generate(SyntheticData::Counts const & counts) {
+   qInfo() << Q_FUNC_INFO << "Generating" << counts.toString();
+   QElapsedTimer timer;
+   timer.start();
+
+   this->pimpl->makeFolderPaths(counts.folders);
+
+   //
+   // Ingredients have to come first as recipes are made from them.  (If we are adding to previously-generated data,
+   // the serial numbers carry on from where they left off so that names stay unique.)
+   //
+   int const firstHop = this->pimpl->hops.size();
+   for (int ii = 0; ii < counts.hops; ++ii) {
+      this->pimpl->generateHop(firstHop + ii + 1);
+   }
+   int const firstFermentable = this->pimpl->fermentables.size();
+   for (int ii = 0; ii < counts.fermentables; ++ii) {
+      this->pimpl->generateFermentable(firstFermentable + ii + 1);
+   }
+   int const firstYeast = this->pimpl->yeasts.size();
+   for (int ii = 0; ii < counts.yeasts; ++ii) {
+      this->pimpl->generateYeast(firstYeast + ii + 1);
+   }
+   int const firstRecipe = this->pimpl->recipes.size();
+   for (int ii = 0; ii < counts.recipes; ++ii) {
+      this->pimpl->generateRecipe(firstRecipe + ii + 1, counts);
+   }
+
+   qInfo() <<
+      Q_FUNC_INFO << "Stored" << this->pimpl->numObjectsStored << "objects in total; this time took" <<
+      timer.elapsed() << "ms";
+   return;
+}
+
+QList<std::shared_ptr<Hop>> const & SyntheticData::hops() const {
+   return this->pimpl->hops;
+}
+
+QList<std::shared_ptr<Fermentable>> const & SyntheticData::fermentables() const {
+   return this->pimpl->fermentables;
+}
+
+QList<std::shared_ptr<Yeast>> const & SyntheticData::yeasts() const {
+   return this->pimpl->yeasts;
+}
+
+QList<std::shared_ptr<Recipe>> const & SyntheticData::recipes() const {
+   return this->pimpl->recipes;
+}
+
+int SyntheticData::numObjectsStored() const {
+   return this->pimpl->numObjectsStored;
+}
@@ -0,0 +1,120 @@
+/*
+ * database/SyntheticData.h is part of Brewtarget, and is copyright the following
+ * authors 2023:
+ *   • Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_SYNTHETICDATA_H
+#define DATABASE_SYNTHETICDATA_H
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+class Fermentable;
+class Hop;
+class Recipe;
+class Yeast;
+
+/**
+ * \brief Generates made-up, but plausible, ingredients, recipes and brew notes and stores them in the current database
+ *        via the normal \c ObjectStore mechanisms.  This is for measuring how we perform with a lot more data than
+ *        ships in the default database (eg in the benchmark runner).
+ *
+ *        For a given seed and set of counts, the generated data is always the same, on every platform and with every
+ *        version of Qt.  (This is why we use \c std::mt19937, whose output is fully specified by the standard, and do
+ *        our own scaling of its output, rather than use \c std::uniform_real_distribution etc, whose results are not.)
+ *
+ *        Data goes into whichever database (SQLite or PostgreSQL) \c Database::instance() is set up to use.  See the
+ *        \c --generate-db command line option in \c main.cpp for generating a database to test against.
+ */
+class SyntheticData {
+public:
+   /**
+    * \brief How much data to generate
+    */
+   struct Counts {
+      int hops;
+      int fermentables;
+      int yeasts;
+      int recipes;
+      //! \brief Number of folders that recipes and ingredients are spread across.  0 means don't use folders.
+      int folders;
+      int hopsPerRecipe;
+      int fermentablesPerRecipe;
+      //! \brief Number of previous versions (ie length of the chain of ancestors) for each recipe
+      int versionsPerRecipe;
+      //! \brief Spread across the recipe and its previous versions
+      int brewNotesPerRecipe;
+
+      /**
+       * \brief Default counts multiplied by \c scale.  (The per-recipe numbers do not change with scale.)
+       */
+      static Counts forScale(double scale);
+
+      /**
+       * \brief Parse a string of comma-separated name=value pairs, eg "recipes=5000,versions=3,scale=2".  Names are
+       *        the same as the member variables, except that "versions" and "brewNotes" are short for
+       *        \c versionsPerRecipe and \c brewNotesPerRecipe, and "scale" gives the starting point for anything not
+       *        otherwise specified (see \c forScale).
+       *
+       * \return \c std::nullopt if \c specification could not be parsed (in which case the reason will have been
+       *         logged)
+       */
+      static std::optional<Counts> fromString(QString const & specification);
+
+      //! \brief Inverse of \c fromString, suitable for logging
+      QString toString() const;
+   };
+
+   SyntheticData(quint32 seed);
+   ~SyntheticData();
+
+   /**
+    * \brief Generate and store everything specified by \c counts.  Can be called more than once, in which case each
+    *        call adds more data.
+    */
+   void generate(Counts const & counts);
+
+   //! \brief The hops created by \c generate (not including the copies used in recipes)
+   QList<std::shared_ptr<Hop>> const & hops() const;
+
+   //! \brief The fermentables created by \c generate (not including the copies used in recipes)
+   QList<std::shared_ptr<Fermentable>> const & fermentables() const;
+
+   //! \brief The yeasts created by \c generate (not including the copies used in recipes)
+   QList<std::shared_ptr<Yeast>> const & yeasts() const;
+
+   //! \brief The recipes created by \c generate (not including their previous versions)
+   QList<std::shared_ptr<Recipe>> const & recipes() const;
+
+   /**
+    * \brief Total number of objects (of all types, including brew notes, recipe versions and in-recipe copies of
+    *        ingredients) stored so far.  This does not count the ingredients that get copied along with each previous
+    *        version of a recipe.
+    */
+   int numObjectsStored() const;
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+};
+
+#endif
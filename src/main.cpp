@@ -23,19 +23,26 @@
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xalanc/Include/PlatformDefinitions.hpp>
 
+#include <algorithm>
+#include <memory>
+
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QCoreApplication>
 #include <QDate>
 #include <QDebug>
 #include <QMessageBox>
 #include <QSharedMemory>
 
 #include "Application.h"
+#include "BatchJobs.h"
 #include "config.h"
 #include "database/Database.h"
+#include "database/SyntheticData.h"
 #include "Localization.h"
 #include "Logging.h"
 #include "PersistentSettings.h"
+#include "utils/ParallelFor.h"
 #include "xml/BeerXml.h"
 
 namespace {
@@ -62,6 +69,58 @@ namespace {
       Database::instance().createBlank(filename);
       exit(0);
    }
+
+   /*!
+    * \brief Adds made-up recipes, ingredients etc to the database, for testing how we perform with large amounts of
+    *        data.  See \c SyntheticData::Counts::fromString for the format of \c specification.
+    *
+    * Use at your own risk -- and preferably with --user-dir pointing somewhere other than your real data!
+    */
+   void generateDb(QString const & specification, QString const & seed) {
+      auto const counts = SyntheticData::Counts::fromString(specification);
+      bool seedOk = false;
+      quint32 const seedValue = seed.toUInt(&seedOk);
+      if (!counts || !seedOk) {
+         qCritical() << "Unable to parse data specification" << specification << "and/or seed" << seed;
+         exit(1);
+      }
+      qInfo() <<
+         "Generating synthetic data with seed" << seedValue << "in" << Database::instance().dbType() << "database";
+      SyntheticData syntheticData{seedValue};
+      syntheticData.generate(*counts);
+      Database::instance().unload();
+      exit(0);
+   }
+
+   /*!
+    * \brief With --batch, we don't want a QApplication, because that needs a display, but we have to decide which
+    *        application object to create before we can use it to parse the command line.
+    */
+   bool isHeadless(int const argc, char const * const * const argv) {
+      for (int ii = 1; ii < argc; ++ii) {
+         QByteArray const argument{argv[ii]};
+         if (argument == "--batch" || argument.startsWith("--batch=")) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   //! \brief In headless mode there's no-one to show a message box to, so we just log fatal errors
+   void reportFatalError(bool const headless, QString const & errorMessage) {
+      if (headless) {
+         qCritical().noquote() << "The application encountered a fatal error:" << errorMessage;
+         return;
+      }
+      QMessageBox::critical(
+         nullptr,
+         QApplication::tr("Application terminates"),
+         errorMessage.isEmpty() ?
+            QApplication::tr("The application encountered a fatal error.") :
+            QApplication::tr("The application encountered a fatal error.\nError message:\n%1").arg(errorMessage)
+      );
+      return;
+   }
 }
 
 int main(int argc, char **argv) {
@@ -73,6 +132,8 @@ int main(int argc, char **argv) {
 
    QGuiApplication::setAttribute(Qt::AA_EnableHighDpiScaling, true);
 
+   bool const headless = isHeadless(argc, argv);
+
    //
    // Various bits of Qt initialisation need to be done straight away for other Qt functionality to work correctly
    //
@@ -87,12 +148,16 @@ int main(int argc, char **argv) {
    // application name are set on the QApplication object, but omitting the call to setOrganizationName() takes out the
    // extra directory layer).
    //
-   QApplication app(argc, argv);
-   app.setOrganizationDomain("brewtarget.com");
+   // In headless mode, we only want a QCoreApplication, so that we can run without a display.
+   //
+   std::unique_ptr<QCoreApplication> app{
+      headless ? std::make_unique<QCoreApplication>(argc, argv) : std::make_unique<QApplication>(argc, argv)
+   };
+   app->setOrganizationDomain("brewtarget.com");
    // We used to vary the application name (and therefore location of config files etc) depending on whether we're
    // building with debug or release version of Qt, but on the whole I don't think this is helpful
-   app.setApplicationName(CONFIG_APPLICATION_NAME_LC);
-   app.setApplicationVersion(CONFIG_VERSION_STRING);
+   app->setApplicationName(CONFIG_APPLICATION_NAME_LC);
+   app->setApplicationVersion(CONFIG_VERSION_STRING);
 
    // Process command-line options relatively early as some may override other settings
    QCommandLineParser parser;
@@ -115,9 +180,33 @@ int main(int argc, char **argv) {
       QString()
    };
    parser.addOption(userDirectoryOption);
+   QCommandLineOption const generateDbOption{
+      "generate-db",
+      "Adds synthetic data for load testing to the database, as specified by <counts> (eg "
+      "\"recipes=5000,versions=3,brewNotes=2,folders=50,scale=2\")",
+      "counts"
+   };
+   parser.addOption(generateDbOption);
+   QCommandLineOption const seedOption{"seed", "Seed for --generate-db (default 1)", "n", "1"};
+   parser.addOption(seedOption);
+   QCommandLineOption const batchOption{
+      "batch",
+      QString{"Runs <job> without any user interface, then exits.  Jobs are: %1.  Arguments for the job follow the "
+              "options."}.arg(BatchJobs::jobNames().join(", ")),
+      "job"
+   };
+   parser.addOption(batchOption);
+   QCommandLineOption const threadsOption{
+      "threads",
+      "Number of threads for --batch jobs to use where they can (default is one per core)",
+      "n",
+      QString::number(ParallelFor::defaultNumThreads())
+   };
+   parser.addOption(threadsOption);
+   parser.addPositionalArgument("arguments", "Arguments for the --batch job", "[arguments...]");
    parser.addHelpOption();
    parser.addVersionOption();
-   parser.process(app);
+   parser.process(*app);
 
    //
    // Having initialised various QApplication settings and read command line options, we can now allow Qt to work out
@@ -134,7 +223,8 @@ int main(int argc, char **argv) {
    // And once we have config, we can initialise logging
    //
    Logging::initializeLogging();
-   qDebug() << Q_FUNC_INFO << "Logging initialised";
+   // This is the start of the timeline of startup stages (see Application::logStartupStage)
+   Application::logStartupStage("Logging initialised");
 
    // Initialize Xerces XML tools
    // NB: This is also where where we would initialise xalanc::XalanTransformer if we were using it
@@ -171,6 +261,11 @@ int main(int argc, char **argv) {
       sharedMemory.attach();
       sharedMemory.detach(); // This should delete the shared memory if no other process is using it
       if (!sharedMemory.create(1)) {
+         if (headless) {
+            // There's no-one to ask, so we play safe
+            qCritical() << "Another instance of" << CONFIG_APPLICATION_NAME_UC << "is already running";
+            return EXIT_FAILURE;
+         }
          enum QMessageBox::StandardButton buttonPressed =
             QMessageBox::warning(NULL,
                                  QApplication::tr("Brewtarget is already running!"),
@@ -182,7 +277,7 @@ int main(int argc, char **argv) {
          if (buttonPressed == QMessageBox::Ok) {
             // We haven't yet called exec on QApplication, so I'm not sure we _need_ to call exit() here, but it
             // doesn't seem to hurt.
-            app.exit();
+            app->exit();
             return EXIT_SUCCESS;
          }
       }
@@ -190,11 +285,12 @@ int main(int argc, char **argv) {
 
    if (parser.isSet(importFromXmlOption)) importFromXml(parser.value(importFromXmlOption));
    if (parser.isSet(createBlankDBOption)) createBlankDb(parser.value(createBlankDBOption));
+   if (parser.isSet(generateDbOption)) generateDb(parser.value(generateDbOption), parser.value(seedOption));
 
    try {
       qInfo() <<
          "Starting" << CONFIG_APPLICATION_NAME_UC << "v" << CONFIG_VERSION_STRING << " (app name" <<
-         app.applicationName() << ") on " << QSysInfo::prettyProductName();
+         app->applicationName() << ") on " << QSysInfo::prettyProductName();
       qInfo() <<
          "Built at" << CONFIG_BUILD_TIMESTAMP << "on" << CONFIG_BUILD_SYSTEM << "for" << CONFIG_RUN_SYSTEM << "with" <<
          CONFIG_CXX_COMPILER_ID << "compiler";
@@ -206,7 +302,17 @@ int main(int argc, char **argv) {
 
       qDebug() << Q_FUNC_INFO << "Library Paths:" << qApp->libraryPaths();
 
-      auto mainAppReturnValue = Application::run();
+      int mainAppReturnValue = 0;
+      if (headless) {
+         int const numThreads = std::max(parser.value(threadsOption).toInt(), 1);
+         QString const jobName = parser.value(batchOption);
+         QStringList const jobArguments = parser.positionalArguments();
+         mainAppReturnValue = Application::runHeadless(
+            [&jobName, &jobArguments, numThreads]() { return BatchJobs::run(jobName, jobArguments, numThreads); }
+         );
+      } else {
+         mainAppReturnValue = Application::run();
+      }
 
       //
       // Clean exit of Xerces XML tools
@@ -223,21 +329,15 @@ int main(int argc, char **argv) {
    }
    catch (const QString & error)
    {
-      QMessageBox::critical(0,
-            QApplication::tr("Application terminates"),
-            QApplication::tr("The application encountered a fatal error.\nError message:\n%1").arg(error));
+      reportFatalError(headless, error);
    }
    catch (std::exception & exception)
    {
-      QMessageBox::critical(0,
-            QApplication::tr("Application terminates"),
-            QApplication::tr("The application encountered a fatal error.\nError message:\n%1").arg(exception.what()));
+      reportFatalError(headless, exception.what());
    }
    catch (...)
    {
-      QMessageBox::critical(0,
-            QApplication::tr("Application terminates"),
-            QApplication::tr("The application encountered a fatal error."));
+      reportFatalError(headless, "");
    }
    return EXIT_FAILURE;
 }
@@ -0,0 +1,162 @@
+/*
+ * measurement/AmountParser.cpp is part of Brewtarget, and is copyright the following
+ * authors 2023:
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "measurement/AmountParser.h"
+
+#include <QDebug>
+#include <QLocale>
+
+#include "Localization.h"
+
+namespace {
+   //
+   // Numbers longer than this (which we don't expect to see in practice) go the slow way.  Note that the buffer has
+   // to allow for an extra leading zero.
+   //
+   int constexpr maxFastPathNumberLength = 62;
+
+   //! \return \c true if \c position is within \c input and the character there is a digit
+   bool isDigitAt(QString const & input, int const position) {
+      return position < input.size() && input.at(position).isDigit();
+   }
+
+   //! \return First position at or after \c position that is not a digit
+   int skipDigits(QString const & input, int position) {
+      while (isDigitAt(input, position)) {
+         ++position;
+      }
+      return position;
+   }
+
+   //! Equivalent of \w in a QRegExp
+   bool isWordCharacter(QChar const character) {
+      return character.isLetterOrNumber() || character.isMark() || character == QLatin1Char('_');
+   }
+}
+
+Measurement::AmountParser const & Measurement::AmountParser::getInstance() {
+   //
+   // Localization::getLocale() is itself only initialised once, so there's no need for us to check whether it has
+   // changed.  As elsewhere, initialisation of a function-local static is thread-safe since C++11.
+   //
+   static AmountParser const parser{Localization::getLocale().decimalPoint(),
+                                    Localization::getLocale().groupSeparator()};
+   return parser;
+}
+
+Measurement::AmountParser::AmountParser(QChar const decimalPoint, QChar const groupSeparator) :
+   decimalPoint  {decimalPoint},
+   groupSeparator{groupSeparator} {
+   qDebug() <<
+      Q_FUNC_INFO << "Decimal point is" << this->decimalPoint << "; group separator is" << this->groupSeparator;
+   return;
+}
+
+Measurement::AmountParser::Result Measurement::AmountParser::parse(QString const & input) const {
+   Result result{false, false, 0.0, 0, 0};
+
+   //
+   // Find the start and end of the first number in the string
+   //
+   int const inputLength = input.size();
+   int numberStart = 0;
+   int numberEnd   = 0;
+   bool hasGroupSeparator = false;
+   for (; numberStart < inputLength; ++numberStart) {
+      QChar const character = input.at(numberStart);
+      if (character.isDigit()) {
+         // Integer part, which might contain one group separator (so long as it's followed by more digits)
+         numberEnd = skipDigits(input, numberStart);
+         if (numberEnd < inputLength &&
+             input.at(numberEnd) == this->groupSeparator &&
+             isDigitAt(input, numberEnd + 1)) {
+            hasGroupSeparator = true;
+            numberEnd = skipDigits(input, numberEnd + 1);
+         }
+         // Optional fractional part
+         if (numberEnd < inputLength && input.at(numberEnd) == this->decimalPoint && isDigitAt(input, numberEnd + 1)) {
+            numberEnd = skipDigits(input, numberEnd + 1);
+         }
+         break;
+      }
+      if (character == this->decimalPoint && isDigitAt(input, numberStart + 1)) {
+         // Number with only a fractional part, eg ".5"
+         numberEnd = skipDigits(input, numberStart + 1);
+         break;
+      }
+   }
+
+   if (numberStart >= inputLength) {
+      return result;
+   }
+   result.found = true;
+   result.quantity = this->toDouble(input, numberStart, numberEnd - numberStart, hasGroupSeparator, result.converted);
+
+   //
+   // Optional whitespace and then optional unit name
+   //
+   int unitStart = numberEnd;
+   while (unitStart < inputLength && input.at(unitStart).isSpace()) {
+      ++unitStart;
+   }
+   int unitEnd = unitStart;
+   while (unitEnd < inputLength && isWordCharacter(input.at(unitEnd))) {
+      ++unitEnd;
+   }
+   result.unitStart  = unitStart;
+   result.unitLength = unitEnd - unitStart;
+   return result;
+}
+
+double Measurement::AmountParser::toDouble(QString const & input,
+                                           int const start,
+                                           int const length,
+                                           bool const hasGroupSeparator,
+                                           bool & ok) const {
+   //
+   // Numbers with group separators are rare in what users type, and there are some subtleties about how the locale
+   // wants them handled (eg whether "1.5" in a locale where '.' is the group separator means 15 or is an error that we
+   // should recover from by trying the C locale) that we leave to Localization::toDouble().  Ditto for anything too
+   // long for our buffer.
+   //
+   if (hasGroupSeparator || length > maxFastPathNumberLength) {
+      return Localization::toDouble(input.mid(start, length), &ok);
+   }
+
+   //
+   // Otherwise, we rewrite the number in the C locale in a buffer on the stack, and get QLocale to convert it for us
+   // without making a copy.  (QString::fromRawData() just wraps our buffer.)
+   //
+   QChar buffer[maxFastPathNumberLength + 2];
+   int bufferLength = 0;
+   if (input.at(start) == this->decimalPoint) {
+      buffer[bufferLength++] = QLatin1Char('0');
+   }
+   for (int ii = start; ii < start + length; ++ii) {
+      QChar const character = input.at(ii);
+      if (character == this->decimalPoint) {
+         buffer[bufferLength++] = QLatin1Char('.');
+      } else {
+         // Map any Unicode digit (eg Arabic-Indic) to its ASCII equivalent
+         buffer[bufferLength++] = QChar{static_cast<ushort>('0' + character.digitValue())};
+      }
+   }
+
+   QString const cLocaleNumber = QString::fromRawData(buffer, bufferLength);
+   return QLocale::c().toDouble(cLocaleNumber, &ok);
+}
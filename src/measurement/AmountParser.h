@@ -0,0 +1,95 @@
+/*
+ * measurement/AmountParser.h is part of Brewtarget, and is copyright the following
+ * authors 2023:
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MEASUREMENT_AMOUNTPARSER_H
+#define MEASUREMENT_AMOUNTPARSER_H
+#pragma once
+
+#include <QChar>
+#include <QString>
+
+namespace Measurement {
+
+   /*!
+    * \class AmountParser
+    *
+    * \brief Splits a string of the form "number [unit]" (eg "5.5 gal", "1,234.5kg", ".5", "3 qt (US)") into its
+    *        numeric part and the name of the unit, if any.
+    *
+    *        This accepts exactly what the regular expression we used to use everywhere for this accepted, ie:
+    *           ((?:\d+G)?\d+(?:D\d+)?|D\d+)\s*(\w+)?
+    *        where D and G are the decimal point and group separator of the current locale, and the first match in the
+    *        string is taken.  (In particular, this means that any leading sign is ignored.)
+    *
+    *        Doing this by hand, rather than with a QRegExp, means we don't have to build (and compile) a regular
+    *        expression, nor allocate the captured strings, for every amount we parse.  This matters because we parse
+    *        amounts not just when the user types them in, but every time a table of ingredients is sorted.
+    *
+    *        The locale's separators are fixed for the life of the program (see \c Localization::getLocale) so we only
+    *        need one instance, obtained via \c AmountParser::getInstance().
+    */
+   class AmountParser {
+   public:
+      /**
+       * \brief Result of \c AmountParser::parse
+       */
+      struct Result {
+         //! \c true if we found something that looks like a number
+         bool   found;
+         //! \c true if we found something that looks like a number \b and it converted to a \c double
+         bool   converted;
+         double quantity;
+         //! Position in the input of the unit name (meaningless if \c unitLength is 0)
+         int    unitStart;
+         //! Length of the unit name, or 0 if there isn't one
+         int    unitLength;
+
+         bool hasUnit() const { return this->unitLength > 0; }
+
+         //! \return Unit name as a reference into \c input (which must be the string that was parsed)
+         QStringRef unitName(QString const & input) const {
+            return input.midRef(this->unitStart, this->unitLength);
+         }
+      };
+
+      /**
+       * \brief Get the parser for the current locale
+       */
+      static AmountParser const & getInstance();
+
+      /**
+       * \brief Parse \c input.  In the normal case (ie unless the number uses a group separator or is absurdly long)
+       *        this does not allocate any memory.
+       */
+      Result parse(QString const & input) const;
+
+   private:
+      AmountParser(QChar const decimalPoint, QChar const groupSeparator);
+
+      double toDouble(QString const & input,
+                      int const start,
+                      int const length,
+                      bool const hasGroupSeparator,
+                      bool & ok) const;
+
+      QChar const decimalPoint;
+      QChar const groupSeparator;
+   };
+}
+
+#endif
@@ -48,8 +48,11 @@ namespace {
 ColorMethods::ColorType ColorMethods::colorFormula = ColorMethods::MOREY;
 
 QString ColorMethods::colorFormulaName() {
+   return ColorMethods::colorFormulaName(ColorMethods::colorFormula);
+}
 
-   switch (ColorMethods::colorFormula) {
+QString ColorMethods::colorFormulaName(ColorType const formula) {
+   switch (formula) {
       case ColorMethods::MOREY:
          return "Morey";
       case ColorMethods::DANIEL:
@@ -99,7 +102,11 @@ void ColorMethods::saveColorFormulaSettings() {
 
 
 double ColorMethods::mcuToSrm(double mcu) {
-   switch (ColorMethods::colorFormula) {
+   return ColorMethods::mcuToSrm(mcu, ColorMethods::colorFormula);
+}
+
+double ColorMethods::mcuToSrm(double mcu, ColorType const formula) {
+   switch (formula) {
       case ColorMethods::MOREY:
          return morey(mcu);
       case ColorMethods::DANIEL:
@@ -107,7 +114,7 @@ double ColorMethods::mcuToSrm(double mcu) {
       case ColorMethods::MOSHER:
          return mosher(mcu);
       default:
-         qCritical() << QObject::tr("Invalid color formula type: %1").arg(ColorMethods::colorFormula);
+         qCritical() << QObject::tr("Invalid color formula type: %1").arg(formula);
          return morey(mcu);
    }
 }
@@ -37,11 +37,17 @@ namespace ColorMethods {
    //! \brief return the color formula name
    QString colorFormulaName();
 
+   //! \brief return the name of \c formula
+   QString colorFormulaName(ColorType formula);
+
    void loadColorFormulaSettings();
    void saveColorFormulaSettings();
 
    //! Depending on selected algorithm, convert malt color units to SRM.
    double mcuToSrm(double mcu);
+
+   //! As above, but with \c formula rather than the selected one.  Unlike the above, safe to call from any thread.
+   double mcuToSrm(double mcu, ColorType formula);
 }
 
 #endif
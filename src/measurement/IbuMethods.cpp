@@ -21,6 +21,7 @@
  */
 #include "measurement/IbuMethods.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QDebug>
@@ -58,6 +59,39 @@ namespace {
       return (hops_grams * utilization * AArating * 1000) / (finalVolume_liters * (1 + gravityFactor));
    }
 
+   //
+   // Greg Noonan's utilization, as a function of boil time, is a 7th order polynomial.  We use these coefficients
+   // (lowest order first) both for a Polynomial in the single-hop calculation and directly in the batched one.
+   //
+   constexpr double noonanUtilizationCoeffs[] {
+      0.7000029428, -0.08868853463, 0.02720809386, -0.002340415323, 0.00009925450081, -0.000002102006144,
+      0.00000002132644293, -0.00000000008229488217
+   };
+
+   /*!
+    * \brief Noonan's table of gravity adjustments (using 60 minutes as a general table).  Written as nested
+    *        conditionals rather than a loop over the table so that the compiler can turn it into selects when it
+    *        vectorises the batched calculation.
+    */
+   inline double noonanGravityFactor(double const wort_grav) {
+      return wort_grav <= 1.050 ? 1.0    :
+             wort_grav <= 1.065 ? 0.9286 :
+             wort_grav <= 1.085 ? 0.8571 :
+                                  0.75;
+   }
+
+   //! \brief Liters in 5 US gallons, which is what Noonan's volume factor is relative to
+   double noonanReferenceVolume_liters() {
+      static double const volume_liters = Measurement::Units::us_gallons.toCanonical(5.0).quantity();
+      return volume_liters;
+   }
+
+   //! \brief Grams in 1 ounce, which is what Noonan's hops factor is relative to
+   double noonanReferenceHops_grams() {
+      static double const hops_grams = Measurement::Units::ounces.toCanonical(1.0).quantity() * 1000.0;
+      return hops_grams;
+   }
+
    /*!
     * \brief Calculates the IBU by Greg Noonans formula
     */
@@ -66,31 +100,84 @@ namespace {
                  double finalVolume_liters,
                  double wort_grav,
                  double minutes) {
-      double volumeFactor = (Measurement::Units::us_gallons.toCanonical(5.0).quantity())/ finalVolume_liters;
-      double hopsFactor = hops_grams/ (Measurement::Units::ounces.toCanonical(1.0).quantity() * 1000.0);
-      static Polynomial p(Polynomial() << 0.7000029428 << -0.08868853463 << 0.02720809386 << -0.002340415323 << 0.00009925450081 << -0.000002102006144 << 0.00000002132644293 << -0.00000000008229488217);
-
-      //using 60 minutes as a general table
-      double utilizationFactorTable[4][2] =  {
-                        {1.050, 1},
-                        {1.065, 0.9286},
-                        {1.085, 0.8571},
-                        {1.100, 0.75}
-                     };
-
-      double utilizationFactor;
-
-      if(wort_grav <= utilizationFactorTable[0][0]) {
-         utilizationFactor = utilizationFactorTable[0][1];
-      } else if(wort_grav <= utilizationFactorTable[1][0]) {
-         utilizationFactor = utilizationFactorTable[1][1];
-      } else if(wort_grav <= utilizationFactorTable[2][0]) {
-         utilizationFactor = utilizationFactorTable[2][1];
-      } else {
-         utilizationFactor = utilizationFactorTable[3][1];
+      double volumeFactor = noonanReferenceVolume_liters() / finalVolume_liters;
+      double hopsFactor = hops_grams / noonanReferenceHops_grams();
+      static Polynomial const p = []() {
+         Polynomial poly;
+         for (double const coeff : noonanUtilizationCoeffs) {
+            poly << coeff;
+         }
+         return poly;
+      }();
+
+      return volumeFactor * ( hopsFactor * (100 * AArating) * p.eval(minutes) ) * noonanGravityFactor(wort_grav);
+   }
+
+   //
+   // Batched versions of the above.  Each is a single loop over plain arrays with no function calls other than to
+   // <cmath>, so that, at least with optimisation turned on, the compiler can vectorise it.  We rearrange the
+   // calculations slightly (eg exp() in place of pow() in Tinseth), but only in ways that give the same answer to
+   // within rounding error.
+   //
+   void tinsethBatch(std::size_t const numHops,
+                     double const * AArating,
+                     double const * hops_grams,
+                     double const * finalVolume_liters,
+                     double const * wort_grav,
+                     double const * minutes,
+                     double const * factor,
+                     double * ibus) {
+      // pow(0.000125, x) == exp(x * ln(0.000125))
+      double const logBignessBase = std::log(0.000125);
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         double const bigness = 1.65 * std::exp((wort_grav[ii] - 1.0) * logBignessBase);
+         double const boilTimeFactor = (1.0 - std::exp(-0.04 * minutes[ii])) / 4.15;
+         ibus[ii] =
+            factor[ii] * (AArating[ii] * hops_grams[ii] * 1000.0 / finalVolume_liters[ii]) * boilTimeFactor * bigness;
       }
+      return;
+   }
+
+   void ragerBatch(std::size_t const numHops,
+                   double const * AArating,
+                   double const * hops_grams,
+                   double const * finalVolume_liters,
+                   double const * wort_grav,
+                   double const * minutes,
+                   double const * factor,
+                   double * ibus) {
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         double const utilization = (18.11 + 13.86 * std::tanh((minutes[ii] - 31.32) / 18.17)) / 100.0;
+         double const gravityFactor = std::max(wort_grav[ii] - 1.050, 0.0) / 0.2;
+         ibus[ii] = factor[ii] * (hops_grams[ii] * utilization * AArating[ii] * 1000.0) /
+                    (finalVolume_liters[ii] * (1.0 + gravityFactor));
+      }
+      return;
+   }
 
-      return(volumeFactor * ( hopsFactor * (100 * AArating) * p.eval(minutes) ) * utilizationFactor);
+   void noonanBatch(std::size_t const numHops,
+                    double const * AArating,
+                    double const * hops_grams,
+                    double const * finalVolume_liters,
+                    double const * wort_grav,
+                    double const * minutes,
+                    double const * factor,
+                    double * ibus) {
+      double const referenceVolume_liters = noonanReferenceVolume_liters();
+      double const referenceHops_grams    = noonanReferenceHops_grams();
+      constexpr int numCoeffs = sizeof(noonanUtilizationCoeffs) / sizeof(noonanUtilizationCoeffs[0]);
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         // Horner's method, as in Polynomial::eval
+         double utilization = 0.0;
+         for (int coeff = numCoeffs - 1; coeff >= 0; --coeff) {
+            utilization = utilization * minutes[ii] + noonanUtilizationCoeffs[coeff];
+         }
+         double const volumeFactor = referenceVolume_liters / finalVolume_liters[ii];
+         double const hopsFactor = hops_grams[ii] / referenceHops_grams;
+         ibus[ii] = factor[ii] * volumeFactor * (hopsFactor * (100.0 * AArating[ii]) * utilization) *
+                    noonanGravityFactor(wort_grav[ii]);
+      }
+      return;
    }
 }
 
@@ -126,7 +213,11 @@ void IbuMethods::saveIbuFormula() {
 }
 
 QString IbuMethods::ibuFormulaName() {
-   switch (IbuMethods::ibuFormula) {
+   return IbuMethods::ibuFormulaName(IbuMethods::ibuFormula);
+}
+
+QString IbuMethods::ibuFormulaName(IbuType const formula) {
+   switch (formula) {
       case IbuMethods::TINSETH: return "Tinseth";
       case IbuMethods::RAGER:   return "Rager";
       case IbuMethods::NOONAN:  return "Noonan";
@@ -139,11 +230,95 @@ double IbuMethods::getIbus(double AArating,
                            double finalVolume_liters,
                            double wort_grav,
                            double minutes) {
-   switch(IbuMethods::ibuFormula) {
+   return IbuMethods::getIbus(AArating, hops_grams, finalVolume_liters, wort_grav, minutes, IbuMethods::ibuFormula);
+}
+
+double IbuMethods::getIbus(double AArating,
+                           double hops_grams,
+                           double finalVolume_liters,
+                           double wort_grav,
+                           double minutes,
+                           IbuType const formula) {
+   switch(formula) {
       case IbuMethods::TINSETH: return tinseth(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
       case IbuMethods::RAGER:   return rager(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
       case IbuMethods::NOONAN:  return noonan(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
    }
-   qCritical() << Q_FUNC_INFO << QObject::tr("Unrecognized IBU formula type. %1").arg(IbuMethods::ibuFormula);
+   qCritical() << Q_FUNC_INFO << QObject::tr("Unrecognized IBU formula type. %1").arg(formula);
    return tinseth(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
 }
+
+void IbuMethods::HopAdditions::reserve(std::size_t const numHops) {
+   this->AArating          .reserve(numHops);
+   this->hops_grams        .reserve(numHops);
+   this->finalVolume_liters.reserve(numHops);
+   this->wort_grav         .reserve(numHops);
+   this->minutes           .reserve(numHops);
+   this->factor            .reserve(numHops);
+   return;
+}
+
+void IbuMethods::HopAdditions::clear() {
+   this->AArating          .clear();
+   this->hops_grams        .clear();
+   this->finalVolume_liters.clear();
+   this->wort_grav         .clear();
+   this->minutes           .clear();
+   this->factor            .clear();
+   return;
+}
+
+std::size_t IbuMethods::HopAdditions::size() const {
+   return this->AArating.size();
+}
+
+void IbuMethods::HopAdditions::append(double const AArating,
+                                      double const hops_grams,
+                                      double const finalVolume_liters,
+                                      double const wort_grav,
+                                      double const minutes,
+                                      double const factor) {
+   this->AArating          .push_back(AArating);
+   this->hops_grams        .push_back(hops_grams);
+   this->finalVolume_liters.push_back(finalVolume_liters);
+   this->wort_grav         .push_back(wort_grav);
+   this->minutes           .push_back(minutes);
+   this->factor            .push_back(factor);
+   return;
+}
+
+void IbuMethods::getIbus(HopAdditions const & hopAdditions, double * ibus, IbuType const formula) {
+   std::size_t const numHops = hopAdditions.size();
+   Q_ASSERT(hopAdditions.hops_grams.size()         == numHops &&
+            hopAdditions.finalVolume_liters.size() == numHops &&
+            hopAdditions.wort_grav.size()          == numHops &&
+            hopAdditions.minutes.size()            == numHops &&
+            hopAdditions.factor.size()             == numHops);
+   if (numHops == 0) {
+      return;
+   }
+
+   auto batch = tinsethBatch;
+   switch (formula) {
+      case IbuMethods::TINSETH: batch = tinsethBatch; break;
+      case IbuMethods::RAGER:   batch = ragerBatch;   break;
+      case IbuMethods::NOONAN:  batch = noonanBatch;  break;
+      default:
+         qCritical() << Q_FUNC_INFO << QObject::tr("Unrecognized IBU formula type. %1").arg(formula);
+         break;
+   }
+   batch(numHops,
+         hopAdditions.AArating.data(),
+         hopAdditions.hops_grams.data(),
+         hopAdditions.finalVolume_liters.data(),
+         hopAdditions.wort_grav.data(),
+         hopAdditions.minutes.data(),
+         hopAdditions.factor.data(),
+         ibus);
+   return;
+}
+
+void IbuMethods::getIbus(HopAdditions const & hopAdditions, double * ibus) {
+   IbuMethods::getIbus(hopAdditions, ibus, IbuMethods::ibuFormula);
+   return;
+}
@@ -22,6 +22,9 @@
 #define MEASUREMENT_IBUMETHODS_H
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 class QString;
 
 /*!
@@ -48,6 +51,9 @@ namespace IbuMethods {
    //! \brief return the bitterness formula's name
    QString ibuFormulaName();
 
+   //! \brief return the name of \c formula
+   QString ibuFormulaName(IbuType formula);
+
    /*!
     * \return IBUs according to selected algorithm.
     * \param AArating in [0,1] (0.04 means 4% AA for example)
@@ -57,6 +63,58 @@ namespace IbuMethods {
     * \param minutes - minutes that the hops are in the boil
     */
    double getIbus(double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
+
+   /*!
+    * \brief As above, but with \c formula rather than the currently selected one.  Unlike the above, this is safe to
+    *        call from any thread.
+    */
+   double getIbus(double AArating,
+                  double hops_grams,
+                  double finalVolume_liters,
+                  double wort_grav,
+                  double minutes,
+                  IbuType formula);
+
+   /*!
+    * \brief A batch of hop additions -- eg all the hops in a recipe, the hops from many recipes, or one hop at many
+    *        different boil times for a chart -- for the batched version of \c getIbus.
+    *
+    *        This holds each input in its own contiguous array ("structure of arrays") rather than one struct per hop,
+    *        so that \c getIbus can work through each array in one simple loop that the compiler is able to vectorise.
+    *        The parameters have the same meanings as for the single-hop \c getIbus, plus a \c factor that the result
+    *        is multiplied by (eg for hop form, equipment hop utilization, or first wort / mash hop adjustment).
+    */
+   struct HopAdditions {
+      std::vector<double> AArating;
+      std::vector<double> hops_grams;
+      std::vector<double> finalVolume_liters;
+      std::vector<double> wort_grav;
+      std::vector<double> minutes;
+      std::vector<double> factor;
+
+      void reserve(std::size_t numHops);
+      void clear();
+      std::size_t size() const;
+      void append(double AArating,
+                  double hops_grams,
+                  double finalVolume_liters,
+                  double wort_grav,
+                  double minutes,
+                  double factor = 1.0);
+   };
+
+   /*!
+    * \brief Batched version of \c getIbus.  Results agree with calling the single-hop version for each hop (and
+    *        multiplying by \c factor) to within rounding error.
+    *
+    * \param hopAdditions The inputs
+    * \param ibus Receives the IBUs for each hop.  Must have room for \c hopAdditions.size() values.
+    * \param formula Which formula to use
+    */
+   void getIbus(HopAdditions const & hopAdditions, double * ibus, IbuType formula);
+
+   //! \brief As above, using the currently selected formula
+   void getIbus(HopAdditions const & hopAdditions, double * ibus);
 }
 
 #endif
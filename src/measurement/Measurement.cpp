@@ -27,6 +27,8 @@
 
 #include "Algorithms.h"
 #include "Localization.h"
+#include "Logging.h"
+#include "measurement/AmountParser.h"
 #include "measurement/PhysicalQuantity.h"
 #include "measurement/UnitSystem.h"
 #include "model/NamedEntity.h"
@@ -71,22 +73,12 @@ namespace {
     *        units or pseudo-units)
     */
    double extractRawDoubleFromString(QString const & input, bool * ok) {
-      if (ok) {
-         *ok = true;
-      }
-
-      // Make sure we get the right decimal point (. or ,) and the right grouping
-      // separator (, or .). Some locales write 1.000,10 and other write
-      // 1,000.10. We need to catch both
-      QString const decimal  = QRegExp::escape(Localization::getLocale().decimalPoint());
-      QString const grouping = QRegExp::escape(Localization::getLocale().groupSeparator());
-
-      QRegExp amtUnit;
-      amtUnit.setPattern("((?:\\d+" + grouping + ")?\\d+(?:" + decimal + "\\d+)?|" + decimal + "\\d+)\\s*(\\w+)?");
-      amtUnit.setCaseSensitivity(Qt::CaseInsensitive);
+      // AmountParser takes care of getting the right decimal point (. or ,) and the right grouping separator (, or .).
+      // Some locales write 1.000,10 and other write 1,000.10. We need to catch both
+      auto const parsed = Measurement::AmountParser::getInstance().parse(input);
 
-      // If the regex dies, return 0.0
-      if (amtUnit.indexIn(input) == -1) {
+      // If we didn't find a number, return 0.0
+      if (!parsed.found) {
          if (ok) {
             *ok = false;
             qWarning() << Q_FUNC_INFO << "Error parsing" << input << "as number";
@@ -94,17 +86,10 @@ namespace {
          return 0.0;
       }
 
-      QString numericPartOfInput = amtUnit.cap(1);
-      double returnValue = 0.0;
-      try {
-         returnValue = Localization::toDouble(numericPartOfInput, ok);
-      } catch (std::invalid_argument const & ex) {
-         qWarning() << Q_FUNC_INFO << "Could not parse" << numericPartOfInput << "as number:" << ex.what();
-      } catch(std::out_of_range const & ex) {
-         qWarning() << Q_FUNC_INFO << "Out of range parsing" << numericPartOfInput << "as number:" << ex.what();
+      if (ok) {
+         *ok = parsed.converted;
       }
-
-      return returnValue;
+      return parsed.quantity;
    }
 }
 
@@ -199,6 +184,40 @@ QString Measurement::displayAmount(Measurement::Amount const & amount,
    return displayUnitSystem.displayAmount(amount, precision, forcedScale);
 }
 
+Measurement::DisplayUnitSystems::DisplayUnitSystems() : unitSystems{physicalQuantityToDisplayUnitSystem} {
+   // It is a coding error if we get here before the display scales have been loaded
+   Q_ASSERT(!this->unitSystems.isEmpty());
+   return;
+}
+
+Measurement::UnitSystem const & Measurement::DisplayUnitSystems::get(PhysicalQuantity physicalQuantity) const {
+   Measurement::UnitSystem const * unitSystem = this->unitSystems.value(physicalQuantity, nullptr);
+   if (nullptr == unitSystem) {
+      // This is a coding error, but we can recover
+      qCritical() <<
+         Q_FUNC_INFO << "No display unit system for physical quantity" << Measurement::getDisplayName(physicalQuantity);
+      Q_ASSERT(false);
+      return Measurement::Unit::getCanonicalUnit(physicalQuantity).getUnitSystem();
+   }
+   return *unitSystem;
+}
+
+QString Measurement::DisplayUnitSystems::displayAmount(Measurement::Amount const & amount, int precision) const {
+   // Same checks as Measurement::displayAmount
+   if (Algorithms::isNan(amount.quantity()) || Algorithms::isInf(amount.quantity())) {
+      return "-";
+   }
+   return this->get(amount.unit()->getPhysicalQuantity()).displayAmount(amount, precision);
+}
+
+bool Measurement::DisplayUnitSystems::operator==(DisplayUnitSystems const & other) const {
+   return this->unitSystems == other.unitSystems;
+}
+
+bool Measurement::DisplayUnitSystems::operator!=(DisplayUnitSystems const & other) const {
+   return !(*this == other);
+}
+
 double Measurement::amountDisplay(Measurement::Amount const & amount,
                                   std::optional<Measurement::SystemOfMeasurement> forcedSystemOfMeasurement,
                                   std::optional<Measurement::UnitSystem::RelativeScale> forcedScale) {
@@ -247,7 +266,9 @@ Measurement::Amount Measurement::qStringToSI(QString qstr,
                                              Measurement::PhysicalQuantity const physicalQuantity,
                                              std::optional<Measurement::SystemOfMeasurement> forcedSystemOfMeasurement,
                                              std::optional<Measurement::UnitSystem::RelativeScale> forcedScale) {
-   qDebug() <<
+   // This gets called for both sides of every comparison when a table of ingredients is sorted, so it only logs when
+   // the measurement category is turned on
+   qCDebug(Logging::measurement) <<
       Q_FUNC_INFO << "Input" << qstr << "of" << physicalQuantity << "; forcedSystemOfMeasurement=" <<
       forcedSystemOfMeasurement << "; forcedScale=" << forcedScale;
 
@@ -25,6 +25,7 @@
 
 #include <optional>
 
+#include <QMap>
 #include <QObject>
 #include <QPair>
 #include <QString>
@@ -84,6 +85,31 @@ namespace Measurement {
                          std::optional<Measurement::SystemOfMeasurement> forcedSystemOfMeasurement = std::nullopt,
                          std::optional<Measurement::UnitSystem::RelativeScale> forcedScale = std::nullopt);
 
+   /*!
+    * \brief A copy, taken when it is constructed, of which display \c UnitSystem is in use for each
+    *        \c PhysicalQuantity.
+    *
+    *        The display settings belong to the GUI thread, so code that formats amounts on another thread (eg
+    *        \c RecipeFormatter building HTML for printing) constructs one of these on the GUI thread first and then
+    *        uses it in place of \c Measurement::displayAmount.  (\c UnitSystem objects themselves never change, so it
+    *        is safe to use them from any thread.)
+    */
+   class DisplayUnitSystems {
+   public:
+      DisplayUnitSystems();
+
+      UnitSystem const & get(PhysicalQuantity physicalQuantity) const;
+
+      //! \brief As \c Measurement::displayAmount, but using the captured \c UnitSystem for \c amount
+      QString displayAmount(Measurement::Amount const & amount, int precision = 3) const;
+
+      bool operator==(DisplayUnitSystems const & other) const;
+      bool operator!=(DisplayUnitSystems const & other) const;
+
+   private:
+      QMap<PhysicalQuantity, UnitSystem const *> unitSystems;
+   };
+
    /*!
     * \brief Converts a measurement (aka amount) to its numerical equivalent in the specified or default units.
     *
@@ -26,57 +26,19 @@
 #include <mutex>    // For std::once_flag etc
 #include <string>
 
-#include <QStringList>
-#include <QRegExp>
 #include <QDebug>
+#include <QMap>
+#include <QStringList>
 
 #include "Algorithms.h"
-#include "Localization.h"
+#include "measurement/AmountParser.h"
 #include "measurement/Measurement.h"
 #include "measurement/UnitSystem.h"
 
 namespace {
 
-   QRegExp getRegExpToMatchAmountPlusUnits() {
-      QRegExp amtUnit;
-
-      // Make sure we get the right decimal point (. or ,) and the right grouping
-      // separator (, or .). Some locales write 1.000,10 and other write
-      // 1,000.10. We need to catch both
-      QString const decimal =  QRegExp::escape(Localization::getLocale().decimalPoint());
-      QString const grouping = QRegExp::escape(Localization::getLocale().groupSeparator());
-
-      amtUnit.setPattern("((?:\\d+" + grouping + ")?\\d+(?:" + decimal + "\\d+)?|" + decimal + "\\d+)\\s*(\\w+)?");
-      amtUnit.setCaseSensitivity(Qt::CaseInsensitive);
-
-      return amtUnit;
-   }
-
-   QString unitNameFromAmountString(QString const & qstr) {
-      QRegExp amtUnit = getRegExpToMatchAmountPlusUnits();
-
-      // if the regex dies, return ?
-      if (amtUnit.indexIn(qstr) == -1) {
-         return QString("?");
-      }
-
-      // Get the unit from the second capture
-      return amtUnit.cap(2);
-   }
-
-   double quantityFromAmountString(QString const & qstr) {
-      QRegExp amtUnit = getRegExpToMatchAmountPlusUnits();
-
-      // if the regex dies, return 0.0
-      if (amtUnit.indexIn(qstr) == -1) {
-         return 0.0;
-      }
-
-      return Localization::toDouble(amtUnit.cap(1), Q_FUNC_INFO);
-   }
-
    /**
-    * \brief This is useful to allow us to initialise \c unitNameLookup and \c physicalQuantityToCanonicalUnit after
+    * \brief This is useful to allow us to initialise \c unitNameTable and \c physicalQuantityToCanonicalUnit after
     *        all \c Unit and \c UnitSystem objects have been created.
     */
    QVector<Measurement::Unit const *> listOfAllUnits;
@@ -115,7 +77,126 @@ namespace {
          return (lhs.lowerCaseUnitName < rhs.lowerCaseUnitName);
       }
    };
-   QMultiMap<NameLookupKey, Measurement::Unit const *> unitNameLookup;
+
+   /**
+    * \brief Look-up from \c NameLookupKey to all the \c Unit objects with that (case-insensitive) name and
+    *        \c PhysicalQuantity.
+    *
+    *        We do a look-up every time we parse an amount with units (including when sorting tables of ingredients),
+    *        so we want this to be fast and not to need the caller to make a lower-case copy of the unit name.  The set of
+    *        keys is fixed once all the Units have been constructed, so, in \c build, we choose a seed for a simple
+    *        (FNV-1a) hash function such that no two keys land in the same bucket -- ie a perfect hash.  A look-up is then
+    *        just one hash and one (case-insensitive) comparison.
+    */
+   class UnitNameTable {
+   public:
+      UnitNameTable() : buckets{}, mask{0}, seed{0} {
+         return;
+      }
+
+      void build(QMap<NameLookupKey, QVector<Measurement::Unit const *>> const & unitsByKey) {
+         // Start with a table a few times bigger than the number of keys, so a suitable seed is quick to find
+         quint32 numBuckets = 1;
+         while (numBuckets < 4 * static_cast<quint32>(unitsByKey.size())) {
+            numBuckets *= 2;
+         }
+
+         for (;; numBuckets *= 2) {
+            for (quint32 candidateSeed = 0; candidateSeed < maxSeedsToTryPerSize; ++candidateSeed) {
+               if (this->tryBuild(unitsByKey, numBuckets, candidateSeed)) {
+                  qDebug() <<
+                     Q_FUNC_INFO << unitsByKey.size() << "unit names in" << numBuckets << "buckets with seed" <<
+                     candidateSeed;
+                  return;
+               }
+            }
+         }
+      }
+
+      /**
+       * \return All the units with name \c name (case-insensitive) for \c physicalQuantity, or \c nullptr if there
+       *         are none
+       */
+      QVector<Measurement::Unit const *> const * find(QStringRef const & name,
+                                                      Measurement::PhysicalQuantity const physicalQuantity) const {
+         if (this->buckets.isEmpty()) {
+            return nullptr;
+         }
+         Bucket const & bucket = this->buckets.at(
+            hash(name.constData(), name.size(), physicalQuantity, this->seed) & this->mask
+         );
+         if (!bucket.used ||
+             bucket.key.physicalQuantity != physicalQuantity ||
+             bucket.key.lowerCaseUnitName.size() != name.size()) {
+            return nullptr;
+         }
+         for (int ii = 0; ii < name.size(); ++ii) {
+            if (bucket.key.lowerCaseUnitName.at(ii) != name.at(ii).toLower()) {
+               return nullptr;
+            }
+         }
+         return &bucket.units;
+      }
+
+      /**
+       * \brief Per-character lower-casing, as used by \c hash and \c find.  (This can differ from QString::toLower()
+       *        for a few exotic characters, so we need to use it when building the table too.)
+       */
+      static QString lowerCase(QString const & name) {
+         QString result{name};
+         for (auto & character : result) {
+            character = character.toLower();
+         }
+         return result;
+      }
+
+   private:
+      static constexpr quint32 maxSeedsToTryPerSize = 1000;
+
+      struct Bucket {
+         bool                               used;
+         NameLookupKey                      key;
+         QVector<Measurement::Unit const *> units;
+      };
+
+      static quint32 hash(QChar const * name,
+                          int const length,
+                          Measurement::PhysicalQuantity const physicalQuantity,
+                          quint32 const seed) {
+         quint32 hashValue = 2166136261u ^ seed;
+         hashValue = (hashValue ^ static_cast<quint32>(physicalQuantity)) * 16777619u;
+         for (int ii = 0; ii < length; ++ii) {
+            hashValue = (hashValue ^ name[ii].toLower().unicode()) * 16777619u;
+         }
+         return hashValue;
+      }
+
+      bool tryBuild(QMap<NameLookupKey, QVector<Measurement::Unit const *>> const & unitsByKey,
+                    quint32 const numBuckets,
+                    quint32 const candidateSeed) {
+         QVector<Bucket> candidateBuckets(static_cast<int>(numBuckets), Bucket{false, {}, {}});
+         for (auto ii = unitsByKey.cbegin(); ii != unitsByKey.cend(); ++ii) {
+            QString const & name = ii.key().lowerCaseUnitName;
+            Bucket & bucket = candidateBuckets[
+               static_cast<int>(hash(name.constData(), name.size(), ii.key().physicalQuantity, candidateSeed) &
+                                (numBuckets - 1))
+            ];
+            if (bucket.used) {
+               return false;
+            }
+            bucket = Bucket{true, ii.key(), ii.value()};
+         }
+         this->buckets = candidateBuckets;
+         this->mask    = numBuckets - 1;
+         this->seed    = candidateSeed;
+         return true;
+      }
+
+      QVector<Bucket> buckets;
+      quint32 mask;
+      quint32 seed;
+   };
+   UnitNameTable unitNameTable;
 
    QMap<Measurement::PhysicalQuantity, Measurement::Unit const *> physicalQuantityToCanonicalUnit;
 
@@ -129,28 +210,24 @@ namespace {
     *                               are no current or foreseeable units that _we_ use whose names only differ by case --
     *                               or, at least, that's the case in English...
     */
-   QList<Measurement::Unit const *> getUnitsByNameAndPhysicalQuantity(QString const & name,
+   QList<Measurement::Unit const *> getUnitsByNameAndPhysicalQuantity(QStringRef const & name,
                                                                       Measurement::PhysicalQuantity const & physicalQuantity,
                                                                       bool const caseInensitiveMatching) {
-      // Need this before we reference unitNameLookup or physicalQuantityToCanonicalUnit
+      // Need this before we reference unitNameTable or physicalQuantityToCanonicalUnit
       std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
 
-      auto matches = unitNameLookup.values(NameLookupKey{physicalQuantity, name.toLower()});
-      qDebug() << Q_FUNC_INFO << name << "has" << matches.length() << "case-insensitive match(es)";
-      if (caseInensitiveMatching) {
-         return matches;
-      }
-
-      // If we ever want to do case insensitive matching (which we think should be rare), the simplest thing is just to
-      // go through all the case-insensitive matches and exclude those that aren't an exact match
-      decltype(matches) filteredMatches;
-      for (auto match : matches) {
-         if (match->name == name) {
-            filteredMatches.append(match);
+      QList<Measurement::Unit const *> matches;
+      auto const units = unitNameTable.find(name, physicalQuantity);
+      if (units) {
+         for (auto const unit : *units) {
+            // If we're not doing case insensitive matching (which we think should be rare), the simplest thing is just
+            // to go through all the case-insensitive matches and exclude those that aren't an exact match
+            if (caseInensitiveMatching || unit->name == name) {
+               matches.append(unit);
+            }
          }
       }
-      qDebug() << Q_FUNC_INFO << name << "has" << filteredMatches.length() << "case-sensitive match(es)";
-      return filteredMatches;
+      return matches;
    }
 
    /**
@@ -161,21 +238,11 @@ namespace {
     * \param caseInensitiveMatching If \c true, do a case-insensitive search.  Eg, match "ml" for milliliters, even
     *                               though the correct name is "mL".
     */
-   QList<Measurement::Unit const *> getUnitsOnlyByName(QString const & name,
+   QList<Measurement::Unit const *> getUnitsOnlyByName(QStringRef const & name,
                                                        bool const caseInensitiveMatching = true) {
-      // Need this before we reference unitNameLookup or physicalQuantityToCanonicalUnit
-      std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
-
       QList<Measurement::Unit const *> allMatches;
-      for (auto key : unitNameLookup.uniqueKeys()) {
-         //
-         // Although it's slightly clunky to call getUnitsByNameAndPhysicalQuantity() here, it saves us re-implementing
-         // all the case-insensitive logic.
-         //
-         auto matches = getUnitsByNameAndPhysicalQuantity(name, key.physicalQuantity, caseInensitiveMatching);
-         if (matches.length() > 0) {
-            allMatches.append(matches);
-         }
+      for (auto const physicalQuantity : Measurement::allPhysicalQuantites) {
+         allMatches.append(getUnitsByNameAndPhysicalQuantity(name, physicalQuantity, caseInensitiveMatching));
       }
       return allMatches;
    }
@@ -231,7 +298,7 @@ Measurement::Unit::Unit(UnitSystem const & unitSystem,
                                 boundaryValue,
                                 (canonical == nullptr) )} {
    //
-   // You might think here would be a neat place to the Unit we are constructing to unitNameLookup and, if appropriate,
+   // You might think here would be a neat place to the Unit we are constructing to unitNameTable and, if appropriate,
    // physicalQuantityToCanonicalUnit.  However, there is not guarantee that unitSystem is constructed at this point, so
    // unitSystem.getPhysicalQuantity() could result in a core dump.
    //
@@ -244,13 +311,16 @@ Measurement::Unit::Unit(UnitSystem const & unitSystem,
 Measurement::Unit::~Unit() = default;
 
 void Measurement::Unit::initialiseLookups() {
+   QMap<NameLookupKey, QVector<Measurement::Unit const *>> unitsByKey;
    for (auto const unit : listOfAllUnits) {
       Measurement::PhysicalQuantity const physicalQuantity = unit->pimpl->unitSystem.getPhysicalQuantity();
-      unitNameLookup.insert(NameLookupKey{physicalQuantity, unit->name.toLower()}, unit);
+      // Most recently constructed first, which is the order we used to get back from QMultiMap::values()
+      unitsByKey[NameLookupKey{physicalQuantity, UnitNameTable::lowerCase(unit->name)}].prepend(unit);
       if (unit->pimpl->isCanonical) {
          physicalQuantityToCanonicalUnit.insert(physicalQuantity, unit);
       }
    }
+   unitNameTable.build(unitsByKey);
    return;
 }
 
@@ -288,7 +358,7 @@ double Measurement::Unit::boundary() const {
 }
 
 Measurement::Unit const & Measurement::Unit::getCanonicalUnit(Measurement::PhysicalQuantity const physicalQuantity) {
-   // Need this before we reference unitNameLookup or physicalQuantityToCanonicalUnit
+   // Need this before we reference unitNameTable or physicalQuantityToCanonicalUnit
    std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
 
    // It's a coding error if there is no canonical unit for a real physical quantity (ie not Mixed).  (And of course
@@ -301,11 +371,13 @@ Measurement::Unit const & Measurement::Unit::getCanonicalUnit(Measurement::Physi
 QString Measurement::Unit::convertWithoutContext(QString const & qstr, QString const & toUnitName) {
 
    qDebug() << Q_FUNC_INFO << "Trying to convert" << qstr << "to" << toUnitName;
-   double fromQuantity = quantityFromAmountString(qstr);
+   auto const parsed = Measurement::AmountParser::getInstance().parse(qstr);
+   double fromQuantity = parsed.quantity;
 
-   QString const fromUnitName = unitNameFromAmountString(qstr);
-   auto const fromUnits = getUnitsOnlyByName(fromUnitName);
-   auto const toUnits   = getUnitsOnlyByName(toUnitName);
+   // If we couldn't find a number, we treat it as having unrecognised units
+   QString const fromUnitName = parsed.found ? parsed.unitName(qstr).toString() : QString("?");
+   auto const fromUnits = getUnitsOnlyByName(QStringRef{&fromUnitName});
+   auto const toUnits   = getUnitsOnlyByName(QStringRef{&toUnitName});
    qDebug() <<
       Q_FUNC_INFO << "Found" << fromUnits.length() << "matches for" << fromUnitName << "and" << toUnits.length() <<
       "matches for" << toUnitName;
@@ -333,7 +405,7 @@ QString Measurement::Unit::convertWithoutContext(QString const & qstr, QString c
 Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
                                                      Measurement::PhysicalQuantity const & physicalQuantity,
                                                      bool const caseInensitiveMatching) {
-   auto matches = getUnitsByNameAndPhysicalQuantity(name, physicalQuantity, caseInensitiveMatching);
+   auto matches = getUnitsByNameAndPhysicalQuantity(QStringRef{&name}, physicalQuantity, caseInensitiveMatching);
 
    auto const numMatches = matches.length();
    if (0 == numMatches) {
@@ -358,16 +430,12 @@ Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
    // Measurement::Unit::imperial_quart, and try to find one that matches the global default.
    Measurement::Unit const * defUnit = nullptr;
    for (auto const unit : matches) {
-      auto const & displayUnitSystem = Measurement::getDisplayUnitSystem(unit->getPhysicalQuantity());
-      qDebug() <<
-         Q_FUNC_INFO << "Look at" << *unit << "from" << unit->getUnitSystem() << "(Display Unit System for" <<
-         unit->getPhysicalQuantity() << "is" << displayUnitSystem << ")";
       if (unit->getPhysicalQuantity() != physicalQuantity) {
          // If the caller knows the amount is, say, a Volume, don't bother trying to match against units for any other
          // physical quantity.
-         qDebug() << Q_FUNC_INFO << "Ignoring match in" << unit->getPhysicalQuantity() << "as not" << physicalQuantity;
          continue;
       }
+      auto const & displayUnitSystem = Measurement::getDisplayUnitSystem(unit->getPhysicalQuantity());
 
       if (displayUnitSystem == unit->getUnitSystem()) {
          // We found a match that belongs to one of the global default unit systems
@@ -387,30 +455,42 @@ Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
 Measurement::Unit const * Measurement::Unit::getUnit(QString const & name,
                                                      Measurement::UnitSystem const & unitSystem,
                                                      bool const caseInensitiveMatching) {
-   auto matches = getUnitsByNameAndPhysicalQuantity(name, unitSystem.getPhysicalQuantity(), caseInensitiveMatching);
+   return Measurement::Unit::getUnit(QStringRef{&name}, unitSystem, caseInensitiveMatching);
+}
+
+Measurement::Unit const * Measurement::Unit::getUnit(QStringRef const & name,
+                                                     Measurement::UnitSystem const & unitSystem,
+                                                     bool const caseInensitiveMatching) {
+   // Need this before we reference unitNameTable
+   std::call_once(initFlag_Lookups, &Measurement::Unit::initialiseLookups);
 
    //
-   // At this point, matches is a list of all units matching the supplied name and the PhysicalQuantity of the supplied
-   // UnitSystem.  If we have more than one match, then we prefer the first one we find (if any) in the supplied
-   // UnitSystem, otherwise, first in the list will have to do.
+   // This is on the path for parsing every amount the user enters (and every amount in a table column being sorted),
+   // so we work directly off the look-up table rather than building a list of matches.
    //
-
-   auto const numMatches = matches.length();
-   if (0 == numMatches) {
+   // Matches are all the units with the supplied name and the PhysicalQuantity of the supplied UnitSystem.  If we have
+   // more than one match, then we prefer the first one we find (if any) in the supplied UnitSystem, otherwise, first
+   // in the list will have to do.
+   //
+   auto const units = unitNameTable.find(name, unitSystem.getPhysicalQuantity());
+   if (!units) {
       return nullptr;
    }
 
-   if (1 == numMatches) {
-      return matches.at(0);
-   }
-
-   for (auto const match : matches) {
-      if (match->getUnitSystem() == unitSystem) {
-         return match;
+   Measurement::Unit const * firstMatch = nullptr;
+   for (auto const unit : *units) {
+      if (!caseInensitiveMatching && unit->name != name) {
+         continue;
+      }
+      if (unit->getUnitSystem() == unitSystem) {
+         return unit;
+      }
+      if (!firstMatch) {
+         firstMatch = unit;
       }
    }
 
-   return matches.at(0);
+   return firstMatch;
 }
 
 // This is where we actually define all the different units and how to convert them to/from their canonical equivalents
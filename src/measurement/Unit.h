@@ -179,6 +179,14 @@ namespace Measurement {
                                   Measurement::UnitSystem const & unitSystem,
                                   bool const caseInensitiveMatching = true);
 
+      /**
+       * \brief As above, but taking a reference to part of a string, so the caller doesn't have to make a copy (eg when
+       *        the unit name is the second half of an amount the user typed in)
+       */
+      static Unit const * getUnit(QStringRef const & name,
+                                  Measurement::UnitSystem const & unitSystem,
+                                  bool const caseInensitiveMatching = true);
+
       /**
        * \brief Get the canonical \c Unit for a given \c PhysicalQuantity.  This will be the unit we use for storing
        *        amounts of this type in the database - eg we always store volumes in liters and mass in kilograms.
@@ -24,9 +24,9 @@
 
 #include <QApplication>
 #include <QDebug>
-#include <QRegExp>
 
-#include "Localization.h"
+#include "Logging.h"
+#include "measurement/AmountParser.h"
 #include "measurement/Unit.h"
 #include "utils/EnumStringMapping.h"
 
@@ -184,25 +184,20 @@ bool Measurement::UnitSystem::operator==(UnitSystem const & other) const {
 }
 
 Measurement::Amount Measurement::UnitSystem::qstringToSI(QString qstr, Unit const & defUnit) const {
-   // All functions in QRegExp are reentrant, so it should be safe to use as a shared const in multi-threaded code.
-   static QRegExp const amtUnit {
-      // Make sure we get the right decimal point (. or ,) and the right grouping separator (, or .).  Some locales
-      // write 1.000,10 and others write 1,000.10.  We need to catch both.
-      "((?:\\d+" + QRegExp::escape(Localization::getLocale().groupSeparator()) + ")?\\d+(?:" +
-      QRegExp::escape(Localization::getLocale().decimalPoint()) + "\\d+)?|" +
-      QRegExp::escape(Localization::getLocale().decimalPoint()) + "\\d+)\\s*(\\w+)?",
-      Qt::CaseInsensitive
-   };
+   // AmountParser knows about the right decimal point (. or ,) and the right grouping separator (, or .).  Some locales
+   // write 1.000,10 and others write 1,000.10.  We need to catch both.
+   auto const parsed = Measurement::AmountParser::getInstance().parse(qstr);
 
    // make sure we can parse the string
-   if (amtUnit.indexIn(qstr) == -1) {
-      qDebug() << Q_FUNC_INFO << "Unable to parse" << qstr;
+   if (!parsed.found) {
+      qCDebug(Logging::measurement) << Q_FUNC_INFO << "Unable to parse" << qstr;
       return Amount{0.0, Measurement::Unit::getCanonicalUnit(this->pimpl->physicalQuantity)};
    }
+   if (!parsed.converted) {
+      qWarning() << Q_FUNC_INFO << "Could not convert number in" << qstr;
+   }
 
-   double const amt = Localization::toDouble(amtUnit.cap(1), Q_FUNC_INFO);
-
-   QString const unitName = amtUnit.cap(2);
+   double const amt = parsed.quantity;
 
    // Look first in this unit system. If you can't find it here, find it
    // globally. I *think* this finally has all the weird magic right. If the
@@ -212,26 +207,28 @@ Measurement::Amount Measurement::UnitSystem::qstringToSI(QString qstr, Unit cons
    // as US Customary.
 
    Unit const * unitToUse = nullptr;
-   if (!unitName.isEmpty()) {
+   if (parsed.hasUnit()) {
       // Unit::getUnit() will, by preference, match to a unit in the current UnitSystem if possible.  If not, it will
       // match to a unit in another UnitSystem for the same PhysicalQuantity.  If there are no matches that way, it will
       // return nullptr;
+      QStringRef const unitName = parsed.unitName(qstr);
       unitToUse = Unit::getUnit(unitName, *this, true);
       if (unitToUse) {
-         qDebug() << Q_FUNC_INFO << this->uniqueName << ":" << unitName << "interpreted as" << unitToUse->name;
+         qCDebug(Logging::measurement) <<
+            Q_FUNC_INFO << this->uniqueName << ":" << unitName << "interpreted as" << unitToUse->name;
       } else {
-         qDebug() <<
+         qCDebug(Logging::measurement) <<
             Q_FUNC_INFO << this->uniqueName << ":" << unitName << "not recognised for" << this->pimpl->physicalQuantity;
       }
    }
 
    if (!unitToUse) {
-      qDebug() << Q_FUNC_INFO << "Defaulting to" << defUnit;
+      qCDebug(Logging::measurement) << Q_FUNC_INFO << "Defaulting to" << defUnit;
       unitToUse = &defUnit;
    }
 
    Measurement::Amount siAmount = unitToUse->toCanonical(amt);
-   qDebug() <<
+   qCDebug(Logging::measurement) <<
       Q_FUNC_INFO << this->uniqueName << ": " << qstr << "is" << amt << " " << unitToUse->name << "=" <<
       siAmount.quantity() << "in" << siAmount.unit()->name;
 
@@ -0,0 +1,298 @@
+/*
+ * model/BoilCurves.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "model/BoilCurves.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <QDebug>
+#include <QHash>
+
+#include "model/Recipe.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   //! Beyond this many recipes, we just start the cache again
+   int constexpr maxCachedRecipes = 100;
+
+   struct CacheEntry {
+      unsigned int generation;
+      BoilCurves::Options options;
+      std::shared_ptr<BoilCurves const> curves;
+   };
+
+   //! Keyed by Recipe key.  Only used on the GUI thread.
+   QHash<int, CacheEntry> & cache() {
+      static QHash<int, CacheEntry> curvesCache;
+      return curvesCache;
+   }
+
+   bool sameHop(RecipeSnapshot::Hop const & lhs, RecipeSnapshot::Hop const & rhs) {
+      return lhs.use       == rhs.use       &&
+             lhs.form      == rhs.form      &&
+             lhs.alpha_pct == rhs.alpha_pct &&
+             lhs.amount_kg == rhs.amount_kg &&
+             lhs.time_min  == rhs.time_min;
+   }
+}
+
+bool BoilCurveOptions::operator==(BoilCurveOptions const & other) const {
+   return this->step_min            == other.step_min     &&
+          this->hopStand_min        == other.hopStand_min &&
+          this->hopStandUtilization == other.hopStandUtilization;
+}
+
+BoilCurves::Conditions BoilCurves::Conditions::of(RecipeSnapshot const & snapshot) {
+   double const grainsInMash_kg = RecipeCalcs::grainsInMash_kg(snapshot);
+   RecipeCalcs::VolumeEstimates const volumes = RecipeCalcs::volumeEstimates(snapshot, grainsInMash_kg);
+   RecipeCalcs::TotalPoints const totalPoints = RecipeCalcs::totalPoints(snapshot);
+   RecipeCalcs::Gravities const gravities =
+      RecipeCalcs::gravities(snapshot, totalPoints, volumes.wortFromMash_l, volumes.finalVolumeNoLosses_l);
+   return Conditions{
+      snapshot.ibuFormula,
+      gravities.og,
+      volumes.finalVolumeNoLosses_l,
+      RecipeCalcs::boilGrav(snapshot, totalPoints),
+      volumes.boilVolume_l,
+      RecipeCalcs::ibuBoilTime_min(snapshot),
+      snapshot.equipment.has_value(),
+      snapshot.equipment ? snapshot.equipment->evapRate_lHr       : 0.0,
+      snapshot.equipment ? snapshot.equipment->hopUtilization_pct : 100.0,
+      snapshot.firstWortHopAdjustment,
+      snapshot.mashHopAdjustment,
+      RecipeCalcs::extractIbus(snapshot)
+   };
+}
+
+bool BoilCurves::Conditions::operator==(Conditions const & other) const {
+   // Same inputs give exactly the same results, so there's no need for fuzzy comparisons here
+   return this->formula                == other.formula                &&
+          this->og                     == other.og                     &&
+          this->finalVolumeNoLosses_l  == other.finalVolumeNoLosses_l  &&
+          this->boilGrav               == other.boilGrav               &&
+          this->boilVolume_l           == other.boilVolume_l           &&
+          this->boilTime_min           == other.boilTime_min           &&
+          this->hasEquipment           == other.hasEquipment           &&
+          this->evapRate_lHr           == other.evapRate_lHr           &&
+          this->hopUtilization_pct     == other.hopUtilization_pct     &&
+          this->firstWortHopAdjustment == other.firstWortHopAdjustment &&
+          this->mashHopAdjustment      == other.mashHopAdjustment      &&
+          this->extractIbus            == other.extractIbus;
+}
+
+BoilCurves::BoilCurves(RecipeSnapshot const & snapshot, Options const & options) :
+   m_options{options},
+   m_snapshot{snapshot},
+   m_conditions{Conditions::of(snapshot)},
+   m_minutes{},
+   m_ibus{},
+   m_gravities{},
+   m_volumes_l{},
+   m_hopIbus{} {
+   BT_TIME_SCOPE("BoilCurves::BoilCurves");
+
+   //
+   // Sample times: every step through the boil and the hop stand, plus the exact end of each (even if it isn't a whole
+   // number of steps).
+   //
+   double const step_min = std::max(m_options.step_min, 0.01);
+   double const boilTime_min = m_conditions.boilTime_min;
+   double const endTime_min = boilTime_min + std::max(m_options.hopStand_min, 0.0);
+   for (int ii = 0; ii * step_min < boilTime_min; ++ii) {
+      m_minutes.append(ii * step_min);
+   }
+   m_minutes.append(boilTime_min);
+   for (int ii = 1; boilTime_min + ii * step_min < endTime_min; ++ii) {
+      m_minutes.append(boilTime_min + ii * step_min);
+   }
+   if (endTime_min > boilTime_min) {
+      m_minutes.append(endTime_min);
+   }
+   int const numSamples = m_minutes.size();
+
+   //
+   // Volume and gravity.  The sugar in the kettle stays the same, so gravity points go up in proportion to the fall in
+   // volume.
+   //
+   m_volumes_l.reserve(numSamples);
+   m_gravities.reserve(numSamples);
+   double const startVolume_l = m_conditions.boilVolume_l;
+   for (double const minutes : m_minutes) {
+      double const boiled_min = std::min(minutes, boilTime_min);
+      double const volume_l = m_snapshot.equipment ?
+         m_snapshot.equipment->wortAfterBoiling_l(startVolume_l, boiled_min) : startVolume_l;
+      m_volumes_l.append(volume_l);
+      m_gravities.append(volume_l > 0.0 ? 1.0 + (m_conditions.boilGrav - 1.0) * startVolume_l / volume_l :
+                                          m_conditions.boilGrav);
+   }
+
+   //
+   // IBUs.  All hops at all samples in one batch.
+   //
+   IbuMethods::HopAdditions hopAdditions;
+   hopAdditions.reserve(static_cast<std::size_t>(m_snapshot.hops.size() * numSamples));
+   for (auto const & hop : m_snapshot.hops) {
+      this->appendHopAdditions(hop, hopAdditions);
+   }
+   std::vector<double> allHopIbus(hopAdditions.size());
+   IbuMethods::getIbus(hopAdditions, allHopIbus.data(), m_conditions.formula);
+
+   m_ibus.fill(m_conditions.extractIbus, numSamples);
+   m_hopIbus.reserve(m_snapshot.hops.size());
+   for (int hopIndex = 0; hopIndex < m_snapshot.hops.size(); ++hopIndex) {
+      auto const hopStart = allHopIbus.cbegin() + static_cast<std::ptrdiff_t>(hopIndex) * numSamples;
+      QVector<double> hopIbus(numSamples);
+      std::copy(hopStart, hopStart + numSamples, hopIbus.begin());
+      for (int sample = 0; sample < numSamples; ++sample) {
+         m_ibus[sample] += hopIbus.at(sample);
+      }
+      m_hopIbus.append(hopIbus);
+   }
+   return;
+}
+
+BoilCurves::~BoilCurves() = default;
+
+void BoilCurves::appendHopAdditions(RecipeSnapshot::Hop const & hop, IbuMethods::HopAdditions & hopAdditions) const {
+   RecipeCalcs::HopIbuParameters const parameters = RecipeCalcs::hopIbuParameters(m_snapshot, hop);
+   double const boilTime_min = m_conditions.boilTime_min;
+   // When the hop goes in, in minutes since the start of the boil.  (This is before the start of the boil for hops
+   // whose time is longer than the boil, and we treat them as having had that extra time by the start of the boil.)
+   double const start_min = boilTime_min - parameters.minutes;
+   bool const isAromaHop = hop.use == Hop::Use::Aroma;
+   for (double const minutes : m_minutes) {
+      double contact_min = 0.0;
+      double factor = 0.0;
+      if (parameters.contributes) {
+         if (minutes >= start_min) {
+            contact_min = minutes <= boilTime_min ?
+               minutes - start_min :
+               (boilTime_min - start_min) + m_options.hopStandUtilization * (minutes - boilTime_min);
+            factor = parameters.factor;
+         }
+      } else if (isAromaHop && minutes > boilTime_min) {
+         contact_min = m_options.hopStandUtilization * (minutes - boilTime_min);
+         factor = parameters.factor;
+      }
+      // Hops that aren't in yet have a factor of 0, which takes care of formulae (Rager and Noonan) that give some
+      // IBUs even for 0 minutes
+      hopAdditions.append(hop.alpha_pct / 100.0,
+                          hop.amount_kg * 1000.0,
+                          m_conditions.finalVolumeNoLosses_l,
+                          m_conditions.og,
+                          contact_min,
+                          factor);
+   }
+   return;
+}
+
+int BoilCurves::numSamples() const {
+   return m_minutes.size();
+}
+
+double BoilCurves::boilTime_min() const {
+   return m_conditions.boilTime_min;
+}
+
+QVector<double> const & BoilCurves::minutes() const {
+   return m_minutes;
+}
+
+QVector<double> const & BoilCurves::ibus() const {
+   return m_ibus;
+}
+
+QVector<double> const & BoilCurves::gravities() const {
+   return m_gravities;
+}
+
+QVector<double> const & BoilCurves::volumes_l() const {
+   return m_volumes_l;
+}
+
+QVector<double> const & BoilCurves::hopIbus(int const hopIndex) const {
+   return m_hopIbus.at(hopIndex);
+}
+
+bool BoilCurves::canUpdateFrom(RecipeSnapshot const & snapshot) const {
+   return snapshot.hops.size() == m_snapshot.hops.size() && Conditions::of(snapshot) == m_conditions;
+}
+
+void BoilCurves::updateHop(int const hopIndex, RecipeSnapshot::Hop const & hop) {
+   BT_TIME_SCOPE("BoilCurves::updateHop");
+   Q_ASSERT(hopIndex >= 0 && hopIndex < m_snapshot.hops.size());
+
+   m_snapshot.hops[hopIndex] = hop;
+
+   IbuMethods::HopAdditions hopAdditions;
+   hopAdditions.reserve(static_cast<std::size_t>(m_minutes.size()));
+   this->appendHopAdditions(hop, hopAdditions);
+   QVector<double> newHopIbus(m_minutes.size());
+   IbuMethods::getIbus(hopAdditions, newHopIbus.data(), m_conditions.formula);
+
+   QVector<double> const & oldHopIbus = m_hopIbus.at(hopIndex);
+   for (int sample = 0; sample < m_minutes.size(); ++sample) {
+      m_ibus[sample] += newHopIbus.at(sample) - oldHopIbus.at(sample);
+   }
+   m_hopIbus[hopIndex] = newHopIbus;
+   return;
+}
+
+std::shared_ptr<BoilCurves const> BoilCurves::forRecipe(Recipe const & recipe, Options const & options) {
+   BT_TIME_SCOPE("BoilCurves::forRecipe");
+
+   auto & curvesCache = cache();
+   auto entry = curvesCache.find(recipe.key());
+   if (entry != curvesCache.end() && entry->options == options) {
+      if (entry->generation == recipe.generation()) {
+         return entry->curves;
+      }
+
+      RecipeSnapshot const snapshot = RecipeSnapshot::create(recipe);
+      if (entry->curves->canUpdateFrom(snapshot)) {
+         // Only hops have changed (or things that don't affect the curves at all), so we just redo the ones that did
+         std::shared_ptr<BoilCurves> updated;
+         for (int hopIndex = 0; hopIndex < snapshot.hops.size(); ++hopIndex) {
+            if (!sameHop(snapshot.hops.at(hopIndex), entry->curves->m_snapshot.hops.at(hopIndex))) {
+               if (!updated) {
+                  updated = std::make_shared<BoilCurves>(*entry->curves);
+               }
+               updated->updateHop(hopIndex, snapshot.hops.at(hopIndex));
+            }
+         }
+         entry->generation = recipe.generation();
+         if (updated) {
+            entry->curves = updated;
+         }
+         return entry->curves;
+      }
+
+      entry->generation = recipe.generation();
+      entry->curves = std::make_shared<BoilCurves const>(snapshot, options);
+      return entry->curves;
+   }
+
+   if (curvesCache.size() >= maxCachedRecipes) {
+      qDebug() << Q_FUNC_INFO << "Clearing cache of" << curvesCache.size() << "recipes";
+      curvesCache.clear();
+   }
+   auto curves = std::make_shared<BoilCurves const>(RecipeSnapshot::create(recipe), options);
+   curvesCache.insert(recipe.key(), CacheEntry{recipe.generation(), options, curves});
+   return curves;
+}
@@ -0,0 +1,141 @@
+/*
+ * model/BoilCurves.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MODEL_BOILCURVES_H
+#define MODEL_BOILCURVES_H
+#pragma once
+
+#include <memory>
+
+#include <QVector>
+
+#include "measurement/IbuMethods.h"
+#include "model/RecipeSnapshot.h"
+
+class Recipe;
+
+/*!
+ * \brief Options for \c BoilCurves.  (This is outside the class only so that the class can use the default values in
+ *        its own default arguments.)
+ */
+struct BoilCurveOptions {
+   //! Minutes between samples
+   double step_min = 1.0;
+   //! Length of hop stand (whirlpool) after the boil, if any
+   double hopStand_min = 0.0;
+   //! How fast hops isomerize during the hop stand relative to during the boil.  1.0 (the default) treats the hop
+   //! stand like more boiling, which is an upper bound.
+   double hopStandUtilization = 1.0;
+
+   bool operator==(BoilCurveOptions const & other) const;
+};
+
+/*!
+ * \class BoilCurves
+ *
+ * \brief IBU, gravity and volume at each step of the boil (and of any hop stand after it), for charts.
+ *
+ *        Everything is calculated in one pass from a \c RecipeSnapshot, as follows:
+ *          - Volume falls from the estimated boil volume at the equipment's evaporation rate (as in
+ *            \c RecipeSnapshot::Equipment::wortEndOfBoil_l), and stays the same during a hop stand.
+ *          - Gravity starts at the boil gravity and rises as the same sugar ends up in less wort.
+ *          - IBU at each step is what the recipe would have if the boil ended there: each hop's contact time so far,
+ *            with the recipe's OG and final volume, as in \c RecipeCalcs::IBU.  So the IBU at the end of the boil is
+ *            the recipe's IBU.
+ *          - During a hop stand, hops from the boil carry on contributing, and aroma hops start to, at
+ *            \c Options::hopStandUtilization times the rate they would in the boil.
+ *
+ *        All the hops at all the steps go through the batched IBU calculation (\c IbuMethods::HopAdditions) in one
+ *        call.  When just one hop changes (eg the user is dragging its time on a slider), \c updateHop recalculates
+ *        only that hop's contribution.  \c forRecipe keeps the curves for each Recipe and works out for itself when
+ *        that is all that is needed.
+ *
+ *        This is plain data, so, once created, it can be used on any thread.
+ */
+class BoilCurves {
+public:
+   using Options = BoilCurveOptions;
+
+   BoilCurves(RecipeSnapshot const & snapshot, Options const & options = Options{});
+   ~BoilCurves();
+
+   int numSamples() const;
+   //! \brief Length of the boil, ie the sample from which any hop stand starts
+   double boilTime_min() const;
+
+   //! \brief Minutes since the start of the boil for each sample
+   QVector<double> const & minutes() const;
+   QVector<double> const & ibus() const;
+   QVector<double> const & gravities() const;
+   QVector<double> const & volumes_l() const;
+   //! \brief IBUs from hop number \c hopIndex (in the same order as \c RecipeSnapshot::hops) at each sample
+   QVector<double> const & hopIbus(int hopIndex) const;
+
+   /**
+    * \brief Whether \c updateHop can bring these curves up to date with \c snapshot, ie whether nothing other than the
+    *        hops (and things that don't affect the curves) has changed.  Adding or removing a hop needs a full
+    *        recalculation.
+    */
+   bool canUpdateFrom(RecipeSnapshot const & snapshot) const;
+
+   //! \brief Change one hop (eg its time or amount) and recalculate just its contribution
+   void updateHop(int hopIndex, RecipeSnapshot::Hop const & hop);
+
+   /**
+    * \brief Curves for \c recipe, from the cache if it hasn't changed since last time, or updated incrementally if only
+    *        its hops have.  Must be called on the GUI thread (as it reads the Recipe).
+    */
+   static std::shared_ptr<BoilCurves const> forRecipe(Recipe const & recipe, Options const & options = Options{});
+
+private:
+   /**
+    * \brief Everything other than the hops themselves that goes into the curves.  If two snapshots have the same
+    *        conditions, the curves for one can be turned into the curves for the other just by updating hops.
+    */
+   struct Conditions {
+      IbuMethods::IbuType formula;
+      double og;
+      double finalVolumeNoLosses_l;
+      double boilGrav;
+      double boilVolume_l;
+      int    boilTime_min;
+      bool   hasEquipment;
+      double evapRate_lHr;
+      double hopUtilization_pct;
+      double firstWortHopAdjustment;
+      double mashHopAdjustment;
+      double extractIbus;
+
+      static Conditions of(RecipeSnapshot const & snapshot);
+      bool operator==(Conditions const & other) const;
+   };
+
+   //! \brief Add the inputs for one hop at every sample to \c hopAdditions
+   void appendHopAdditions(RecipeSnapshot::Hop const & hop, IbuMethods::HopAdditions & hopAdditions) const;
+
+   Options m_options;
+   RecipeSnapshot m_snapshot;
+   Conditions m_conditions;
+   QVector<double> m_minutes;
+   QVector<double> m_ibus;
+   QVector<double> m_gravities;
+   QVector<double> m_volumes_l;
+   QVector<QVector<double>> m_hopIbus;
+};
+
+#endif
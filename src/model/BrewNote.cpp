@@ -36,12 +36,6 @@
 #include "model/Recipe.h"
 #include "model/Yeast.h"
 
-// These belong here, because they really just are constant strings for
-// reaching into a hash
-static const QString kSugarKg("sugar_kg");
-static const QString kSugarKg_IgnoreEff("sugar_kg_ignoreEfficiency");
-
-
 // BrewNote doesn't use its name field, so we sort by brew date
 // TBD: Could consider copying date into name field and leaving the default ordering
 // MAF: In all the databases, names are strings but any date is the proper
@@ -220,11 +214,10 @@ void BrewNote::populateNote(Recipe* parent)
       setBoilOff_l( equip->evapRate_lHr() * ( parent->boilTime_min()/60));
    }
 
-   QHash<QString,double> sugars;
-   sugars = parent->calcTotalPoints();
-   setProjPoints(sugars.value(kSugarKg) + sugars.value(kSugarKg_IgnoreEff));
+   RecipeCalcs::TotalPoints const sugars = parent->calcTotalPoints();
+   setProjPoints(sugars.sugar_kg + sugars.sugar_kg_ignoreEfficiency);
 
-   setProjFermPoints(sugars.value(kSugarKg) + sugars.value(kSugarKg_IgnoreEff));
+   setProjFermPoints(sugars.sugar_kg + sugars.sugar_kg_ignoreEfficiency);
 
    // Out of the gate, we expect projected to be the measured.
    setSg( parent->boilGrav() );
@@ -289,13 +282,10 @@ void BrewNote::recalculateEff(Recipe* parent)
 {
    this->m_recipeId = parent->key();
 
-   QHash<QString,double> sugars;
-
-   sugars = parent->calcTotalPoints();
-   setProjPoints(sugars.value(kSugarKg) + sugars.value(kSugarKg_IgnoreEff));
+   RecipeCalcs::TotalPoints const sugars = parent->calcTotalPoints();
+   setProjPoints(sugars.sugar_kg + sugars.sugar_kg_ignoreEfficiency);
 
-   sugars = parent->calcTotalPoints();
-   setProjFermPoints(sugars.value(kSugarKg) + sugars.value(kSugarKg_IgnoreEff));
+   setProjFermPoints(sugars.sugar_kg + sugars.sugar_kg_ignoreEfficiency);
 
    calculateEffIntoBK_pct();
    calculateBrewHouseEff_pct();
@@ -553,7 +543,7 @@ double BrewNote::pitchTemp_c() const { return m_pitchTemp_c; }
 double BrewNote::fg() const { return m_fg; }
 double BrewNote::finalVolume_l() const { return m_finalVolume_l; }
 double BrewNote::projBoilGrav() const { return m_projBoilGrav; }
-double BrewNote::projVolIntoBK_l() const { return m_projVolIntoFerm_l; }
+double BrewNote::projVolIntoBK_l() const { return m_projVolIntoBK_l; }
 double BrewNote::projStrikeTemp_c() const { return m_projStrikeTemp_c; }
 double BrewNote::projMashFinTemp_c() const { return m_projMashFinTemp_c; }
 double BrewNote::projOg() const { return m_projOg; }
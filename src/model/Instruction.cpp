@@ -167,6 +167,12 @@ void Instruction::addReagent(QString const & reagent) {
    m_reagents.append(reagent);
 }
 
+void Instruction::setReagents(QList<QString> const & reagents) {
+   // As above, reagents aren't stored in the DB
+   m_reagents = reagents;
+   return;
+}
+
 // Accessors ==================================================================
 QString Instruction::directions() { return m_directions; }
 
@@ -185,5 +191,5 @@ int Instruction::instructionNumber() const {
 }
 
 Recipe * Instruction::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return RecipeHelper::findOwningRecipe(*this);
 }
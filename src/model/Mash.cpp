@@ -267,6 +267,9 @@ void Mash::swapMashSteps(MashStep & ms1, MashStep & ms2) {
 }
 
 void Mash::removeAllMashSteps() {
+   // As in Mash::addMashStep(), previous versions of our Recipe need to keep their steps
+   this->prepareForPropertyChange(PropertyNames::Mash::mashSteps);
+
    auto steps = this->mashSteps();
    qDebug() << Q_FUNC_INFO << "Removing" << steps.size() << "steps from" << *this;
    for (auto ms : this->mashSteps()) {
@@ -396,6 +399,10 @@ void Mash::acceptMashStepChange([[maybe_unused]] QMetaProperty prop,
 }
 
 std::shared_ptr<MashStep> Mash::addMashStep(std::shared_ptr<MashStep> mashStep) {
+   // A new step changes the Mash as far as previous versions of its Recipe are concerned, so, like a property change,
+   // it might need a new version, and the Mash not to be shared with the previous ones any more.
+   this->prepareForPropertyChange(PropertyNames::Mash::mashSteps);
+
    if (this->key() > 0) {
       qDebug() << Q_FUNC_INFO << "Add MashStep #" << mashStep->key() << "to Mash #" << this->key();
       mashStep->setMashId(this->key());
@@ -429,6 +436,9 @@ std::shared_ptr<MashStep> Mash::addMashStep(std::shared_ptr<MashStep> mashStep)
 }
 
 std::shared_ptr<MashStep> Mash::removeMashStep(std::shared_ptr<MashStep> mashStep) {
+   // As in Mash::addMashStep(), previous versions of our Recipe need to keep their steps
+   this->prepareForPropertyChange(PropertyNames::Mash::mashSteps);
+
    // Disassociate the MashStep from this Mash
    mashStep->setMashId(-1);
 
@@ -461,7 +471,7 @@ std::shared_ptr<MashStep> Mash::removeMashStep(std::shared_ptr<MashStep> mashSte
 }
 
 Recipe * Mash::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return RecipeHelper::findOwningRecipe(*this);
 }
 
 void Mash::hardDeleteOwnedEntities() {
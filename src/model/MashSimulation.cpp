@@ -0,0 +1,403 @@
+/*
+ * model/MashSimulation.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "model/MashSimulation.h"
+
+#include <algorithm>
+
+#include <QDebug>
+#include <QHash>
+
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreWrapper.h"
+#include "HeatCalculations.h"
+#include "model/Equipment.h"
+#include "model/Mash.h"
+#include "model/Recipe.h"
+#include "utils/Instrumentation.h"
+
+namespace {
+   //! Beyond this many mashes, we just start the cache again
+   int constexpr maxCachedMashes = 100;
+
+   struct CacheEntry {
+      //! Set when the ObjectStore tells us the Mash or one of its steps has changed
+      bool stale;
+      std::shared_ptr<MashSimulation const> simulation;
+   };
+
+   //! Keyed by Mash key.  Only used on the GUI thread.
+   QHash<int, CacheEntry> & cache();
+
+   void markStale(int const mashId) {
+      auto entry = cache().find(mashId);
+      if (entry != cache().end()) {
+         entry->stale = true;
+      }
+      return;
+   }
+
+   void markAllStale() {
+      for (auto & entry : cache()) {
+         entry.stale = true;
+      }
+      return;
+   }
+
+   void markStaleFor(MashStep const * mashStep) {
+      if (mashStep) {
+         markStale(mashStep->getMashId());
+      }
+      return;
+   }
+
+   /**
+    * \brief Everything that can change the result for a stored Mash gets written through its ObjectStore or the
+    *        MashStep one, so that's where we find out about it.  (We can't rely on the Mash's own signals, as not
+    *        every MashStep is connected to its Mash.)
+    */
+   void watchObjectStores() {
+      auto & mashStore     = ObjectStoreTyped<Mash    >::getInstance();
+      auto & mashStepStore = ObjectStoreTyped<MashStep>::getInstance();
+      QObject::connect(&mashStore, &ObjectStoreTyped<Mash>::signalPropertyChanged, [](int id) { markStale(id); });
+      QObject::connect(&mashStore, &ObjectStoreTyped<Mash>::signalObjectDeleted,   [](int id) { cache().remove(id); });
+      QObject::connect(
+         &mashStepStore,
+         &ObjectStoreTyped<MashStep>::signalPropertyChanged,
+         [](int id, BtStringConst const & propertyName) {
+            if (propertyName == PropertyNames::MashStep::mashId) {
+               // The step has moved between mashes, and we only know where it's gone, not where it came from
+               markAllStale();
+               return;
+            }
+            markStaleFor(ObjectStoreWrapper::getByIdRaw<MashStep>(id));
+         }
+      );
+      QObject::connect(
+         &mashStepStore,
+         &ObjectStoreTyped<MashStep>::signalObjectInserted,
+         [](int id) { markStaleFor(ObjectStoreWrapper::getByIdRaw<MashStep>(id)); }
+      );
+      QObject::connect(
+         &mashStepStore,
+         &ObjectStoreTyped<MashStep>::signalObjectDeleted,
+         [](int, std::shared_ptr<QObject> object) { markStaleFor(qobject_cast<MashStep const *>(object.get())); }
+      );
+      return;
+   }
+
+   QHash<int, CacheEntry> & cache() {
+      static QHash<int, CacheEntry> simulationCache;
+      static bool const watching = (watchObjectStores(), true);
+      Q_UNUSED(watching)
+      return simulationCache;
+   }
+
+   QVector<MashSimulation::Step> stepsOf(Mash const & mash) {
+      QVector<MashSimulation::Step> steps;
+      for (auto const & mashStep : mash.mashSteps()) {
+         steps.append(MashSimulation::Step::of(*mashStep));
+      }
+      return steps;
+   }
+}
+
+double const MashSimulation::spargeCooling_c = 10.0;
+
+bool MashSimulationOptions::operator==(MashSimulationOptions const & other) const {
+   return this->grain_kg       == other.grain_kg       &&
+          this->absorption_LKg == other.absorption_LKg &&
+          this->boilingPoint_c == other.boilingPoint_c;
+}
+
+MashSimulation::Step MashSimulation::Step::of(MashStep const & mashStep) {
+   return Step{
+      mashStep.type(),
+      mashStep.isInfusion(),
+      mashStep.isSparge(),
+      mashStep.infuseAmount_l(),
+      mashStep.stepTemp_c(),
+      mashStep.stepTime_min()
+   };
+}
+
+bool MashSimulation::Step::operator==(Step const & other) const {
+   return this->type           == other.type           &&
+          this->isInfusion     == other.isInfusion     &&
+          this->isSparge       == other.isSparge       &&
+          this->infuseAmount_l == other.infuseAmount_l &&
+          this->stepTemp_c     == other.stepTemp_c     &&
+          this->stepTime_min   == other.stepTime_min;
+}
+
+MashSimulation::Tun MashSimulation::Tun::of(Mash const & mash) {
+   return Tun{
+      mash.grainTemp_c(),
+      mash.tunTemp_c(),
+      mash.tunWeight_kg() * mash.tunSpecificHeat_calGC()
+   };
+}
+
+bool MashSimulation::Tun::operator==(Tun const & other) const {
+   return this->grainTemp_c         == other.grainTemp_c &&
+          this->tunTemp_c           == other.tunTemp_c   &&
+          this->tunThermalMass_calC == other.tunThermalMass_calC;
+}
+
+MashSimulation::MashSimulation(Tun const & tun, QVector<Step> const & steps, Options const & options) :
+   m_tun    {tun    },
+   m_options{options},
+   m_steps  {steps  },
+   m_states {} {
+   this->simulateFrom(0);
+   return;
+}
+
+MashSimulation::~MashSimulation() = default;
+
+void MashSimulation::simulateFrom(int const firstStep) {
+   BT_TIME_SCOPE("MashSimulation::simulateFrom");
+   m_states.resize(m_steps.size());
+
+   double const grainThermalMass_calC = m_options.grain_kg * HeatCalculations::Cgrain_calGC;
+   double const grainVolume_l         = m_options.grain_kg / PhysicalConstants::grainDensity_kgL;
+   double const absorbable_l          = m_options.grain_kg * m_options.absorption_LKg;
+
+   for (int ii = firstStep; ii < m_steps.size(); ++ii) {
+      Step const & step = m_steps.at(ii);
+      // The first step also heats the tun, from its own temperature.  After that, the tun is part of the mash.
+      bool const first = (ii == 0);
+      StepState const before = first ? StepState{m_tun.grainTemp_c,
+                                                 m_tun.grainTemp_c,
+                                                 0.0,
+                                                 0.0,
+                                                 grainThermalMass_calC,
+                                                 grainThermalMass_calC,
+                                                 0.0,
+                                                 0.0,
+                                                 0.0,
+                                                 grainVolume_l,
+                                                 0.0,
+                                                 0.0,
+                                                 0.0} : m_states.at(ii - 1);
+      double const tunThermalMass_calC = first ? m_tun.tunThermalMass_calC : 0.0;
+
+      StepState & state = m_states[ii];
+      state.startTemp_c       = before.endTemp_c;
+      state.endTemp_c         = step.stepTemp_c;
+      state.startTime_min     = before.endTime_min;
+      state.endTime_min       = before.endTime_min + step.stepTime_min;
+      state.waterAdded_l      = step.isInfusion ? step.infuseAmount_l : 0.0;
+      state.mashWater_l       = before.mashWater_l  + (step.isSparge ? 0.0 : state.waterAdded_l);
+      state.totalWater_l      = before.totalWater_l + state.waterAdded_l;
+      state.absorbed_l        = std::min(absorbable_l, state.totalWater_l);
+      state.infuseTemp_c      = 0.0;
+      state.decoctionAmount_l = 0.0;
+
+      if (step.isSparge) {
+         if (!first) {
+            state.startTemp_c = before.endTemp_c - spargeCooling_c;
+         }
+         state.heatedThermalMass_calC = spargeThermalMass_calC(m_options.grain_kg,
+                                                               m_options.absorption_LKg,
+                                                               m_tun.tunThermalMass_calC);
+         state.infuseTemp_c = infusionTemp_c(state.waterAdded_l,
+                                             state.heatedThermalMass_calC,
+                                             state.startTemp_c,
+                                             state.endTemp_c);
+         state.thermalMass_calC = state.heatedThermalMass_calC + state.waterAdded_l * HeatCalculations::Cw_calGC;
+         state.mashVolume_l = grainVolume_l + state.absorbed_l + state.waterAdded_l;
+         continue;
+      }
+
+      state.heatedThermalMass_calC = before.thermalMass_calC + tunThermalMass_calC;
+      if (step.isInfusion) {
+         state.infuseTemp_c = infusionTemp_c(state.waterAdded_l,
+                                             before.thermalMass_calC,
+                                             state.startTemp_c,
+                                             state.endTemp_c,
+                                             tunThermalMass_calC,
+                                             m_tun.tunTemp_c);
+      } else if (step.type == MashStep::Type::Decoction) {
+         double const boiledThermalMass_calC =
+            grainThermalMass_calC + before.mashWater_l * HeatCalculations::Cw_calGC;
+         double const fraction = decoctionFraction(state.heatedThermalMass_calC,
+                                                   boiledThermalMass_calC,
+                                                   state.startTemp_c,
+                                                   state.endTemp_c,
+                                                   m_options.boilingPoint_c);
+         if (fraction >= 0.0 && fraction <= 1.0) {
+            state.decoctionAmount_l = fraction * (before.mashWater_l + grainVolume_l);
+         }
+      }
+      state.thermalMass_calC = state.heatedThermalMass_calC + state.waterAdded_l * HeatCalculations::Cw_calGC;
+      state.mashVolume_l = grainVolume_l + state.mashWater_l;
+   }
+   return;
+}
+
+QVector<MashSimulation::Step> const & MashSimulation::steps() const {
+   return m_steps;
+}
+
+QVector<MashSimulation::StepState> const & MashSimulation::states() const {
+   return m_states;
+}
+
+MashSimulation::Tun const & MashSimulation::tun() const {
+   return m_tun;
+}
+
+MashSimulation::Options const & MashSimulation::options() const {
+   return m_options;
+}
+
+double MashSimulation::totalMashWater_l() const {
+   return m_states.isEmpty() ? 0.0 : m_states.last().totalWater_l;
+}
+
+double MashSimulation::totalInfusionAmount_l() const {
+   return m_states.isEmpty() ? 0.0 : m_states.last().mashWater_l;
+}
+
+double MashSimulation::totalSpargeAmount_l() const {
+   return this->totalMashWater_l() - this->totalInfusionAmount_l();
+}
+
+double MashSimulation::totalTime_min() const {
+   return m_states.isEmpty() ? 0.0 : m_states.last().endTime_min;
+}
+
+double MashSimulation::wortFromMash_l() const {
+   return this->totalMashWater_l() - m_options.absorption_LKg * m_options.grain_kg;
+}
+
+double MashSimulation::thermalMass_calC() const {
+   return m_states.isEmpty() ? m_options.grain_kg * HeatCalculations::Cgrain_calGC : m_states.last().thermalMass_calC;
+}
+
+void MashSimulation::updateStep(int const stepIndex, Step const & step) {
+   Q_ASSERT(stepIndex >= 0 && stepIndex < m_steps.size());
+   m_steps[stepIndex] = step;
+   this->simulateFrom(stepIndex);
+   return;
+}
+
+std::shared_ptr<MashSimulation const> MashSimulation::forMash(Mash const & mash, Options const & options) {
+   BT_TIME_SCOPE("MashSimulation::forMash");
+
+   // A Mash that isn't stored yet doesn't have a key to cache it under (or send us signals), so just work it out
+   if (mash.key() <= 0) {
+      return std::make_shared<MashSimulation const>(Tun::of(mash), stepsOf(mash), options);
+   }
+
+   auto & simulationCache = cache();
+   auto entry = simulationCache.find(mash.key());
+   if (entry != simulationCache.end()) {
+      MashSimulation const & cached = *entry->simulation;
+      if (!entry->stale && cached.m_options == options) {
+         return entry->simulation;
+      }
+
+      // If nothing has changed, we still have the right steps, otherwise we need to read them again
+      Tun const tun = entry->stale ? Tun::of(mash) : cached.m_tun;
+      QVector<Step> const steps = entry->stale ? stepsOf(mash) : cached.m_steps;
+      entry->stale = false;
+
+      if (tun == cached.m_tun && options == cached.m_options && steps.size() == cached.m_steps.size()) {
+         // Only steps have changed (if anything), so we just redo things from the first one that did
+         auto const mismatch = std::mismatch(steps.cbegin(), steps.cend(), cached.m_steps.cbegin());
+         if (mismatch.first != steps.cend()) {
+            auto updated = std::make_shared<MashSimulation>(cached);
+            updated->m_steps = steps;
+            updated->simulateFrom(static_cast<int>(mismatch.first - steps.cbegin()));
+            entry->simulation = updated;
+         }
+         return entry->simulation;
+      }
+
+      entry->simulation = std::make_shared<MashSimulation const>(tun, steps, options);
+      return entry->simulation;
+   }
+
+   if (simulationCache.size() >= maxCachedMashes) {
+      qDebug() << Q_FUNC_INFO << "Clearing cache of" << simulationCache.size() << "mashes";
+      simulationCache.clear();
+   }
+   auto simulation = std::make_shared<MashSimulation const>(Tun::of(mash), stepsOf(mash), options);
+   simulationCache.insert(mash.key(), CacheEntry{false, simulation});
+   return simulation;
+}
+
+MashSimulation::Options MashSimulation::optionsFor(Recipe & recipe) {
+   Options options;
+   options.grain_kg = recipe.grainsInMash_kg();
+   Equipment const * equipment = recipe.equipment();
+   if (equipment) {
+      options.absorption_LKg = equipment->grainAbsorption_LKg();
+      options.boilingPoint_c = equipment->boilingPoint_c();
+   }
+   return options;
+}
+
+double MashSimulation::infusionTemp_c(double const water_l,
+                                      double const thermalMass_calC,
+                                      double const fromTemp_c,
+                                      double const toTemp_c,
+                                      double const tunThermalMass_calC,
+                                      double const tunTemp_c) {
+   // NOTE: Assumes 1L of water is 1 kg.
+   if (water_l <= 0.0) {
+      return 0.0;
+   }
+   return (thermalMass_calC * (toTemp_c - fromTemp_c) + tunThermalMass_calC * (toTemp_c - tunTemp_c)) /
+          (water_l * HeatCalculations::Cw_calGC) + toTemp_c;
+}
+
+double MashSimulation::infusionAmount_l(double const waterTemp_c,
+                                        double const thermalMass_calC,
+                                        double const fromTemp_c,
+                                        double const toTemp_c,
+                                        double const tunThermalMass_calC,
+                                        double const tunTemp_c) {
+   // NOTE: Assumes 1L of water is 1 kg.
+   if (waterTemp_c == toTemp_c) {
+      return 0.0;
+   }
+   return (thermalMass_calC * (toTemp_c - fromTemp_c) + tunThermalMass_calC * (toTemp_c - tunTemp_c)) /
+          (HeatCalculations::Cw_calGC * (waterTemp_c - toTemp_c));
+}
+
+double MashSimulation::decoctionFraction(double const thermalMass_calC,
+                                         double const boiledThermalMass_calC,
+                                         double const fromTemp_c,
+                                         double const toTemp_c,
+                                         double const boilingPoint_c) {
+   // The boiled part gives up (boilingPoint_c - toTemp_c) per degree of its thermal mass, and the rest of the mash
+   // (including the tun) takes (toTemp_c - fromTemp_c).
+   return (thermalMass_calC * (toTemp_c - fromTemp_c)) /
+          (boiledThermalMass_calC * (boilingPoint_c - toTemp_c) + boiledThermalMass_calC * (toTemp_c - fromTemp_c));
+}
+
+double MashSimulation::spargeThermalMass_calC(double const grain_kg,
+                                              double const absorption_LKg,
+                                              double const tunThermalMass_calC) {
+   return grain_kg * HeatCalculations::Cgrain_calGC +
+          absorption_LKg * grain_kg * HeatCalculations::Cw_calGC +
+          tunThermalMass_calC;
+}
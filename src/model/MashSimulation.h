@@ -0,0 +1,220 @@
+/*
+ * model/MashSimulation.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MODEL_MASHSIMULATION_H
+#define MODEL_MASHSIMULATION_H
+#pragma once
+
+#include <memory>
+
+#include <QVector>
+
+#include "model/MashStep.h"
+#include "PhysicalConstants.h"
+
+class Mash;
+class Recipe;
+
+/*!
+ * \brief Options for \c MashSimulation, ie the things that come from the Recipe and Equipment rather than the Mash.
+ *        (This is outside the class only so that the class can use the default values in its own default arguments.)
+ */
+struct MashSimulationOptions {
+   //! Mass of grain being mashed (see \c Recipe::grainsInMash_kg)
+   double grain_kg = 0.0;
+   double absorption_LKg = PhysicalConstants::grainAbsorption_Lkg;
+   double boilingPoint_c = 100.0;
+
+   bool operator==(MashSimulationOptions const & other) const;
+};
+
+/*!
+ * \class MashSimulation
+ *
+ * \brief The state of the mash after each of its steps -- water, volume, thermal mass, temperatures, decoction amounts
+ *        and absorbed water -- worked out in one pass over the steps.
+ *
+ *        We use the same simple heat balance throughout, with 1 L of water taken as 1 kg:
+ *          - The thermal mass of the mash is that of the grain, the water in it so far and (from the end of the first
+ *            step, when it has been heated along with the mash) the tun.
+ *          - An infusion brings the mash from the previous step's temperature to its own.  \c StepState::infuseTemp_c
+ *            is how hot its water needs to be to do that.  For the first step, this includes heating the tun from its
+ *            own temperature.
+ *          - A decoction boils part of the mash and returns it.  \c StepState::decoctionAmount_l is how much.
+ *          - A sparge starts about 10C below the previous step, and only heats the grain, the water it has absorbed
+ *            and the tun.
+ *
+ *        The static member functions are the formulas themselves, for tools (such as the mash wizard and designer)
+ *        that are working out what the steps should be rather than what existing ones give.
+ *
+ *        \c forMash keeps the results for each Mash, and works out for itself when they are out of date.  When only
+ *        some steps have changed, it just redoes the state from the first of them onwards.  Results are plain data,
+ *        so, once created, they can be used on any thread.
+ */
+class MashSimulation {
+public:
+   using Options = MashSimulationOptions;
+
+   //! \brief The parts of a \c MashStep that affect the simulation
+   struct Step {
+      MashStep::Type type;
+      bool   isInfusion;
+      bool   isSparge;
+      double infuseAmount_l;
+      double stepTemp_c;
+      double stepTime_min;
+
+      static Step of(MashStep const & mashStep);
+      bool operator==(Step const & other) const;
+   };
+
+   //! \brief The parts of a \c Mash, other than its steps, that affect the simulation
+   struct Tun {
+      double grainTemp_c;
+      double tunTemp_c;
+      double tunThermalMass_calC;
+
+      static Tun of(Mash const & mash);
+      bool operator==(Tun const & other) const;
+   };
+
+   //! \brief The mash after (or, where it says so, during) one step
+   struct StepState {
+      //! Mash temperature before the step (for sparges, allowing for cooling after the last step)
+      double startTemp_c;
+      double endTemp_c;
+      //! Minutes from the start of the mash
+      double startTime_min;
+      double endTime_min;
+      //! What the step heats (grain, water and tun), in calories per degree C
+      double heatedThermalMass_calC;
+      //! Thermal mass of everything in the tun at the end of the step, ie what the next step has to heat
+      double thermalMass_calC;
+      //! Water added in this step
+      double waterAdded_l;
+      //! All water added to the tun so far, not including sparge water
+      double mashWater_l;
+      //! All water added so far, including sparge water
+      double totalWater_l;
+      //! Volume of grain and water in the tun
+      double mashVolume_l;
+      //! Water held back by the grain
+      double absorbed_l;
+      //! For infusions and sparges, how hot the water needs to be to get to \c endTemp_c.  Can be over boiling!
+      double infuseTemp_c;
+      //! For decoctions, how much mash to boil to get to \c endTemp_c (or 0 if it can't be done)
+      double decoctionAmount_l;
+   };
+
+   MashSimulation(Tun const & tun, QVector<Step> const & steps, Options const & options = Options{});
+   ~MashSimulation();
+
+   QVector<Step>      const & steps () const;
+   QVector<StepState> const & states() const;
+   Tun     const & tun    () const;
+   Options const & options() const;
+
+   //! \brief All the water added, as \c Mash::totalMashWater_l
+   double totalMashWater_l() const;
+   //! \brief Water added in non-sparge steps, as \c Mash::totalInfusionAmount_l
+   double totalInfusionAmount_l() const;
+   //! \brief As \c Mash::totalSpargeAmount_l
+   double totalSpargeAmount_l() const;
+   //! \brief As \c Mash::totalTime
+   double totalTime_min() const;
+   //! \brief Water added less what the grain absorbs, as \c RecipeCalcs::volumeEstimates
+   double wortFromMash_l() const;
+   /**
+    * \brief Thermal mass of everything in the tun at the end of the mash so far, ie what the next step added would have
+    *        to heat.  (Before any steps, that's just the grain, as the tun has not yet been heated.)
+    */
+   double thermalMass_calC() const;
+
+   //! \brief Change one step and redo the state from that step onwards
+   void updateStep(int stepIndex, Step const & step);
+
+   /**
+    * \brief Simulation of \c mash, from the cache if it hasn't changed since last time, or updated from the first
+    *        changed step onwards if only some of its steps have.  Must be called on the GUI thread (as it reads the
+    *        Mash).
+    *
+    *        NB: As it is the \c ObjectStore that tells us about changes, this won't see changes that have not yet been
+    *        written, eg inside a \c Recipe::EditSession.
+    */
+   static std::shared_ptr<MashSimulation const> forMash(Mash const & mash, Options const & options = Options{});
+
+   //! \brief Options for \c recipe, from its grain and equipment
+   static Options optionsFor(Recipe & recipe);
+
+   //================================================ Heat balance ====================================================
+
+   /**
+    * \brief Temperature \c water_l of water needs to be to bring something of thermal mass \c thermalMass_calC from
+    *        \c fromTemp_c to \c toTemp_c, optionally also heating a tun of \c tunThermalMass_calC from \c tunTemp_c.
+    *        Returns 0 if there's no water.
+    */
+   static double infusionTemp_c(double water_l,
+                                double thermalMass_calC,
+                                double fromTemp_c,
+                                double toTemp_c,
+                                double tunThermalMass_calC = 0.0,
+                                double tunTemp_c = 0.0);
+
+   /**
+    * \brief Amount of water at \c waterTemp_c needed to do the same.  Returns 0 if the water is already at
+    *        \c toTemp_c.
+    */
+   static double infusionAmount_l(double waterTemp_c,
+                                  double thermalMass_calC,
+                                  double fromTemp_c,
+                                  double toTemp_c,
+                                  double tunThermalMass_calC = 0.0,
+                                  double tunTemp_c = 0.0);
+
+   /**
+    * \brief Fraction of the mash to boil and return to take it from \c fromTemp_c to \c toTemp_c.  Outside [0, 1] if
+    *        that can't be done.
+    *
+    * \param thermalMass_calC thermal mass of everything to heat, including the tun
+    * \param boiledThermalMass_calC thermal mass of the grain and water, ie what the fraction is of
+    */
+   static double decoctionFraction(double thermalMass_calC,
+                                   double boiledThermalMass_calC,
+                                   double fromTemp_c,
+                                   double toTemp_c,
+                                   double boilingPoint_c);
+
+   /**
+    * \brief Thermal mass that a sparge has to heat: the grain, the water it has absorbed and the tun
+    */
+   static double spargeThermalMass_calC(double grain_kg, double absorption_LKg, double tunThermalMass_calC);
+
+   //! Roughly how much the mash cools between the last mash step and sparging
+   static double const spargeCooling_c;
+
+private:
+   //! \brief Work out \c m_states from \c firstStep onwards (assuming the ones before it are right)
+   void simulateFrom(int firstStep);
+
+   Tun     m_tun;
+   Options m_options;
+   QVector<Step>      m_steps;
+   QVector<StepState> m_states;
+};
+
+#endif
@@ -39,7 +39,8 @@ NamedEntity::NamedEntity(QString t_name, bool t_display, QString folder) :
    m_name         {t_name   },
    m_display      {t_display},
    m_deleted      {false    },
-   m_beingModified{false    } {
+   m_beingModified{false    },
+   m_changeCollector{nullptr} {
    return;
 }
 
@@ -65,7 +66,8 @@ NamedEntity::NamedEntity(NamedParameterBundle const & namedParameterBundle) :
    m_name         {namedParameterBundle.val(PropertyNames::NamedEntity::name,      QString{})},
    m_display      {namedParameterBundle.val(PropertyNames::NamedEntity::display,   true     )},
    m_deleted      {namedParameterBundle.val(PropertyNames::NamedEntity::deleted,   false    )},
-   m_beingModified{false} {
+   m_beingModified{false},
+   m_changeCollector{nullptr} {
    return;
 }
 
@@ -77,7 +79,8 @@ NamedEntity::NamedEntity(NamedEntity const & other) :
    m_name      {other.m_name   },
    m_display   {other.m_display},
    m_deleted   {other.m_deleted},
-   m_beingModified{false} {
+   m_beingModified{false},
+   m_changeCollector{nullptr} { // Change collectors are for a particular object, so never copied
    return;
 }
 
@@ -308,6 +311,12 @@ bool NamedEntity::isBeingModified() const {
    return this->m_beingModified;
 }
 
+void NamedEntity::setChangeCollector(NamedEntityChangeCollector * changeCollector) {
+   // Similarly, this is transient and not stored in the DB
+   this->m_changeCollector = changeCollector;
+   return;
+}
+
 QVector<int> NamedEntity::getParentAndChildrenIds() const {
    QVector<int> results;
    NamedEntity const * parent = this->getParent();
@@ -339,6 +348,18 @@ QVector<int> NamedEntity::getParentAndChildrenIds() const {
    return results;
 }
 
+TypeLookup const & NamedEntity::getTypeLookup() const {
+   return this->getObjectStoreTypedInstance().getTypeLookup();
+}
+
+QVariant NamedEntity::storedValueAsVariant(BtStringConst const & propertyName) const {
+   MemberAccess const * memberAccess = this->getTypeLookup().getMemberAccess(propertyName);
+   if (memberAccess && memberAccess->readAsVariant) {
+      return memberAccess->readAsVariant(*this);
+   }
+   return this->property(*propertyName);
+}
+
 QMetaProperty NamedEntity::metaProperty(char const * const name) const {
    return this->metaObject()->property(this->metaObject()->indexOfProperty(name));
 }
@@ -357,6 +378,12 @@ void NamedEntity::prepareForPropertyChange(BtStringConst const & propertyName) {
 }
 
 void NamedEntity::propagatePropertyChange(BtStringConst const & propertyName, bool notify) const {
+   // If someone is batching up changes to us, it's up to them to write and signal this one when they're ready
+   if (this->m_changeCollector) {
+      this->m_changeCollector->collectChange(*this, propertyName, notify);
+      return;
+   }
+
    // If we're already stored in the object store, tell it about the property change so that it can write it to the
    // database.  (We don't pass the new value as it will get read out of the object via propertyName.)
    if (this->m_key > 0) {
@@ -365,18 +392,38 @@ void NamedEntity::propagatePropertyChange(BtStringConst const & propertyName, bo
 
    // Send a signal if needed
    if (notify) {
-      // It's obviously a coding error to supply a property name that is not registered with Qt as a property of this
-      // object
-      int idx = this->metaObject()->indexOfProperty(*propertyName);
-      Q_ASSERT(idx >= 0);
-      QMetaProperty metaProperty = this->metaObject()->property(idx);
-      QVariant value = metaProperty.read(this);
-      emit this->changed(metaProperty, value);
+      this->notifyPropertyChange(propertyName);
    }
 
    return;
 }
 
+void NamedEntity::notifyPropertyChange(BtStringConst const & propertyName) const {
+   // It's obviously a coding error to supply a property name that is not registered with Qt as a property of this
+   // object
+   int idx = this->metaObject()->indexOfProperty(*propertyName);
+   Q_ASSERT(idx >= 0);
+   QMetaProperty metaProperty = this->metaObject()->property(idx);
+   // The setter that called us has just written the value, so, where we can, we read it straight back out of the
+   // member variable rather than going through the getter via the Qt property system.
+   MemberAccess const * memberAccess = this->getTypeLookup().getMemberAccess(propertyName);
+   QVariant value = (memberAccess && memberAccess->readAsVariant) ? memberAccess->readAsVariant(*this) :
+                                                                   metaProperty.read(this);
+   emit this->changed(metaProperty, value);
+   return;
+}
+
+void NamedEntityChangeCollector::writeChange(NamedEntity const & namedEntity, BtStringConst const & propertyName) {
+   Q_ASSERT(namedEntity.m_changeCollector == nullptr);
+   namedEntity.propagatePropertyChange(propertyName, false);
+   return;
+}
+
+void NamedEntityChangeCollector::signalChange(NamedEntity const & namedEntity, BtStringConst const & propertyName) {
+   namedEntity.notifyPropertyChange(propertyName);
+   return;
+}
+
 NamedEntity * NamedEntity::getParent() const {
    if (this->parentKey <= 0) {
       return nullptr;
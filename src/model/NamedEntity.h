@@ -39,6 +39,7 @@
 #include "utils/BtStringConst.h"
 #include "utils/TypeLookup.h"
 
+class NamedEntity;
 class NamedParameterBundle;
 class ObjectStore;
 class Recipe;
@@ -70,6 +71,32 @@ AddPropertyName(parentKey)
 //=========================================== End of property name constants ===========================================
 //======================================================================================================================
 
+/**
+ * \brief Something that wants to hold on to property changes on a \c NamedEntity, rather than have them written to the
+ *        database and signalled straight away.  See \c NamedEntity::setChangeCollector and \c Recipe::EditSession.
+ */
+class NamedEntityChangeCollector {
+public:
+   virtual ~NamedEntityChangeCollector() = default;
+
+   /**
+    * \brief Called by \c NamedEntity::propagatePropertyChange instead of writing the change to the database.  The
+    *        collector is then responsible for (later) calling \c propagatePropertyChange itself once it has been
+    *        removed from \c namedEntity.
+    */
+   virtual void collectChange(NamedEntity const & namedEntity, BtStringConst const & propertyName, bool notify) = 0;
+
+protected:
+   /**
+    * \brief Write a collected change to the database, without emitting any signal.  The collector must already have
+    *        been removed from \c namedEntity, otherwise the change will just get collected again.
+    */
+   static void writeChange(NamedEntity const & namedEntity, BtStringConst const & propertyName);
+
+   //! \brief Emit the \c changed signal for a collected change
+   static void signalChange(NamedEntity const & namedEntity, BtStringConst const & propertyName);
+};
+
 /*!
  * \class NamedEntity
  *
@@ -159,6 +186,9 @@ class NamedEntity : public QObject {
    Q_OBJECT
    Q_CLASSINFO("version","1")
 
+   // NamedEntityChangeCollector needs to be able to call propagatePropertyChange and notifyPropertyChange
+   friend class NamedEntityChangeCollector;
+
 public:
 
    /**
@@ -293,6 +323,13 @@ public:
    void setBeingModified(bool set);
    bool isBeingModified() const;
 
+   /**
+    * \brief Set (or, with \c nullptr, unset) something to receive property changes on this object in place of
+    *        \c propagatePropertyChange writing them to the database and emitting \c changed.  This is a transient
+    *        attribute (not stored in the DB or copied), intended for use by \c Recipe::EditSession.
+    */
+   void setChangeCollector(NamedEntityChangeCollector * changeCollector);
+
    /**
     * \brief Set the ID (aka key) by which this object is uniquely identified in its DB table
     *
@@ -383,6 +420,38 @@ protected:
     */
    virtual ObjectStore & getObjectStoreTypedInstance() const = 0;
 
+public:
+   /**
+    * \brief The \c TypeLookup for the class of this object (eg \c Hop::typeLookup for a \c Hop)
+    */
+   TypeLookup const & getTypeLookup() const;
+
+   /**
+    * \brief Typed read of the member variable in which a property is stored, bypassing the Qt property system (so no
+    *        look-up of the property by name in the meta-object and no \c QVariant).  See \c MemberAccess for caveats --
+    *        in particular, this is the stored value, not necessarily what the getter would return.
+    *
+    *        Eg \c hop.storedValue<double>(PropertyNames::Hop::alpha_pct)
+    *
+    * \return Pointer to the value, or \c nullptr if the property is not stored in a member variable of type \c T
+    */
+   template<typename T> T const * storedValue(BtStringConst const & propertyName) const {
+      MemberAccess const * memberAccess = this->getTypeLookup().getMemberAccess(propertyName);
+      if (!memberAccess || memberAccess->memberType != typeid(T)) {
+         return nullptr;
+      }
+      return static_cast<T const *>(memberAccess->address(*this));
+   }
+
+   /**
+    * \brief Value of a property as a \c QVariant, read straight from the member variable where it is one of the simple
+    *        types that \c MemberAccess handles, and via the Qt property system otherwise.  As with \c storedValue, this
+    *        is for code (eg that called from setters) that wants the stored value.
+    */
+   QVariant storedValueAsVariant(BtStringConst const & propertyName) const;
+
+protected:
+
    /**
     * \brief Used by setters to force a value not to be below a certain amount
     *
@@ -464,13 +533,20 @@ protected:
    /**
     * \brief This is intended to be called from setter member functions (including those of derived classes), \b after
     *        changing a property.  It checks whether the object is is in "cache only" mode and, if not, propagates the
-    *        change down to the database layer and, optionally, also emits a "changed" signal.
+    *        change down to the database layer and, optionally, also emits a "changed" signal.  If a change collector
+    *        is set (see \c setChangeCollector) then the change is instead handed to that to deal with later.
     *
     * \param propertyName The name of the property that has been changed
     * \param emitChangedSignal Whether to emit a "changed" signal. Default is \c true
     */
    void propagatePropertyChange(BtStringConst const & propertyName, bool notify = true) const;
 
+   /**
+    * \brief Emit the "changed" signal for the supplied property.  This is the second half of
+    *        \c propagatePropertyChange, separated out for \c NamedEntityChangeCollector.
+    */
+   void notifyPropertyChange(BtStringConst const & propertyName) const;
+
 
    /**
     * \brief Convenience function to check for the set being a no-op. (Sometimes the UI will call all setters, even on
@@ -513,6 +589,7 @@ private:
   bool m_display;
   bool m_deleted;
   bool m_beingModified;
+  NamedEntityChangeCollector * m_changeCollector;
 };
 
 /**
@@ -21,18 +21,26 @@
  */
 #include "model/Recipe.h"
 
+#include <algorithm>
 #include <cmath> // For pow/log
+#include <optional>
+#include <type_traits>
 
 #include <QDate>
 #include <QDebug>
 #include <QInputDialog>
+#include <QHash>
 #include <QList>
+#include <QMap>
 #include <QObject>
+#include <QPointer>
 
 #include "Algorithms.h"
+#include "database/Database.h"
+#include "database/DbTransaction.h"
 #include "database/ObjectStoreWrapper.h"
 #include "HeatCalculations.h"
-#include "Localization.h"
+#include "Logging.h"
 #include "measurement/ColorMethods.h"
 #include "measurement/IbuMethods.h"
 #include "measurement/Measurement.h"
@@ -44,6 +52,7 @@
 #include "model/MashStep.h"
 #include "model/Misc.h"
 #include "model/NamedParameterBundle.h"
+#include "model/RecipeSnapshot.h"
 #include "model/Salt.h"
 #include "model/Style.h"
 #include "model/Water.h"
@@ -51,8 +60,23 @@
 #include "PersistentSettings.h"
 #include "PhysicalConstants.h"
 #include "PreInstruction.h"
+#include "utils/Instrumentation.h"
 
 namespace {
+   /**
+    * \brief Set once we've seen any Recipe with a previous version, as only then can anything be shared between
+    *        Recipes (see \c Recipe::CopyMode::SharedIngredients).  Never unset, as there's no cheap way to tell when
+    *        the last one goes, and it only matters that it is never wrongly false.
+    */
+   bool previousVersionsExist = false;
+
+   void notePreviousVersion(Recipe const & recipe) {
+      if (recipe.getAncestorId() > 0 && recipe.getAncestorId() != recipe.key()) {
+         previousVersionsExist = true;
+      }
+      return;
+   }
+
    /**
     * \brief Check whether the supplied instance of (subclass of) NamedEntity (a) is an "instance of use of" (ie has a
     *        parent) and (b) is not used in any Recipe.
@@ -88,15 +112,32 @@ namespace {
          return true;
       }
 
-      // The var is used in another Recipe.  (We shouldn't really find ourselves in this position, but the way the rest
-      // of the code works means that, even if we do, we should recover OK - or at least not make the situation any
-      // worse.)
-      qWarning() <<
-         Q_FUNC_INFO << var.metaObject()->className() << "#" << var.key() <<
-         "is unexpectedly already used in recipe #" << matchingRecipe->key();
+      // The var is used in another Recipe.  This is normal if it is shared with a previous version of a Recipe (see
+      // Recipe::CopyMode::SharedIngredients).  Otherwise, we shouldn't really find ourselves in this position, but the
+      // way the rest of the code works means that, even if we do, we should recover OK - or at least not make the
+      // situation any worse.
+      qDebug() <<
+         Q_FUNC_INFO << var.metaObject()->className() << "#" << var.key() << "is already used in recipe #" <<
+         matchingRecipe->key();
       return false;
    }
 
+   /**
+    * \brief Make and store a copy of the supplied instance of (subclass of) NamedEntity, as a "child" (ie "instance of
+    *        use of") of it or its parent.
+    */
+   template<class NE> std::shared_ptr<NE> makeStoredChildCopy(NE const & var) {
+      qDebug() << Q_FUNC_INFO << "Making copy of " << var.metaObject()->className() << "#" << var.key();
+
+      // We need to make a copy...
+      auto copy = std::make_shared<NE>(var);
+      // ...then make sure the copy is a "child" (ie "instance of use of")...
+      copy->makeChild(var);
+      // ...and finally ensure the copy is stored.
+      ObjectStoreWrapper::insert(copy);
+      return copy;
+   }
+
    /**
     * \brief Decide whether the supplied instance of (subclass of) NamedEntity needs to be copied before being added to
     *        a recipe.
@@ -126,15 +167,7 @@ namespace {
          return ObjectStoreWrapper::getById<NE>(var.key());
       }
 
-      qDebug() << Q_FUNC_INFO << "Making copy of " << var.metaObject()->className() << "#" << var.key();
-
-      // We need to make a copy...
-      auto copy = std::make_shared<NE>(var);
-      // ...then make sure the copy is a "child" (ie "instance of use of")...
-      copy->makeChild(var);
-      // ...and finally ensure the copy is stored.
-      ObjectStoreWrapper::insert(copy);
-      return copy;
+      return makeStoredChildCopy(var);
    }
 
    //
@@ -196,7 +229,22 @@ public:
       miscIds{},
       saltIds{},
       waterIds{},
-      yeastIds{} {
+      yeastIds{},
+      generation{0},
+      recalcSnapshot{},
+      cachedSnapshot{},
+      cachedSnapshotGeneration{0},
+      totalPoints{},
+      totalPointsRequests{0},
+      totalPointsCalculations{0},
+      editSession{nullptr},
+      recalcDeferred{false},
+      connectedSignalsForCachedOutput{false} {
+      //
+      // Any change to one of our own properties means anything cached from this Recipe is stale.  (Changes to the
+      // things we contain come in via Recipe::acceptChangeToContainedObject.)
+      //
+      QObject::connect(&recipe, &NamedEntity::changed, &recipe, [this]() { ++this->generation; });
       return;
    }
 
@@ -230,19 +278,117 @@ public:
       return;
    }
 
+   /**
+    * \brief Make another Recipe share the ingredients of a particular type (Hop, Fermentable, etc) of this one -
+    *        typically because we are making a previous version of it.  See \c Recipe::CopyMode::SharedIngredients.
+    */
+   template<class NE> void shareList(Recipe & us, Recipe const & other) {
+      this->accessIds<NE>() = other.pimpl->accessIds<NE>();
+      for (auto ingredient : this->getAllMyRaw<NE>()) {
+         QObject::connect(ingredient, &NamedEntity::changed, &us, &Recipe::acceptChangeToContainedObject);
+      }
+      qDebug() <<
+         Q_FUNC_INFO << "Recipe" << us.name() << "shares" << this->accessIds<NE>().size() << "of" <<
+         NE::staticMetaObject.className() << "with Recipe #" << other.key();
+      return;
+   }
+
+   /**
+    * \brief Whether anything other than this Recipe (eg another version of it) uses \c ne
+    */
+   template<class NE> bool isSharedWithAnotherRecipe(NE const & ne) const {
+      Recipe const * const us = &this->recipe;
+      return nullptr != ObjectStoreWrapper::findFirstMatching<Recipe>(
+         [us, &ne](Recipe * rec) {
+            return rec != us && rec->uses(ne);
+         }
+      );
+   }
+
    /**
     * \brief If the Recipe is about to be deleted, we delete all the things that belong to it.  Note that, with the
     *        exception of Instruction, what we are actually deleting here is not the Hops/Fermentables/etc but the "use
     *        of" Hops/Fermentables/etc records (which are distinguished by having a parent ID.
+    *
+    *        Anything we share with another version of this Recipe still belongs to that version, so we leave it alone.
     */
    template<class NE> void hardDeleteAllMy() {
       qDebug() << Q_FUNC_INFO;
       for (auto id : this->accessIds<NE>()) {
+         NE const * ingredient = ObjectStoreWrapper::getByIdRaw<NE>(id);
+         if (ingredient && this->isSharedWithAnotherRecipe(*ingredient)) {
+            qDebug() <<
+               Q_FUNC_INFO << "Not deleting" << ingredient->metaObject()->className() << "#" << id <<
+               "as it is still used by another Recipe";
+            continue;
+         }
          ObjectStoreWrapper::hardDelete<NE>(id);
       }
       return;
    }
 
+   /**
+    * \brief Make this Recipe (which should be a previous version of the one that owns \c shared) use \c replacement
+    *        instead of \c shared.  Because previous versions are locked, this is not a change as far as the UI is
+    *        concerned, so we only update the DB.
+    */
+   template<class NE> void replaceShared(NE const & shared, NE & replacement) {
+      qDebug() <<
+         Q_FUNC_INFO << "Recipe #" << this->recipe.key() << "now using" << replacement.metaObject()->className() <<
+         "#" << replacement.key() << "instead of #" << shared.key();
+      if constexpr (std::is_same_v<NE, Equipment> || std::is_same_v<NE, Mash> || std::is_same_v<NE, Style>) {
+         if constexpr (std::is_same_v<NE, Equipment>) {
+            this->recipe.equipmentId = replacement.key();
+         } else if constexpr (std::is_same_v<NE, Mash>) {
+            this->recipe.mashId = replacement.key();
+         } else {
+            this->recipe.styleId = replacement.key();
+         }
+         this->recipe.propagatePropertyChange(propertyToPropertyName<NE>(), false);
+      } else {
+         std::replace(this->accessIds<NE>().begin(), this->accessIds<NE>().end(), shared.key(), replacement.key());
+         // Rather than rewrite all this Recipe's rows in the junction table, we can just change the one that matters
+         if (this->recipe.key() > 0) {
+            this->recipe.getObjectStoreTypedInstance().replaceJunctionValue(this->recipe,
+                                                                            propertyToPropertyName<NE>(),
+                                                                            shared.key(),
+                                                                            replacement.key());
+         }
+      }
+
+      QObject::disconnect(&shared, nullptr, &this->recipe, nullptr);
+      QObject::connect(&replacement, &NamedEntity::changed, &this->recipe, &Recipe::acceptChangeToContainedObject);
+      if constexpr (std::is_same_v<NE, Equipment>) {
+         QObject::connect(&replacement, &Equipment::changedBoilSize_l,   &this->recipe, &Recipe::setBoilSize_l);
+         QObject::connect(&replacement, &Equipment::changedBoilTime_min, &this->recipe, &Recipe::setBoilTime_min);
+      }
+      return;
+   }
+
+   /**
+    * \brief If \c ne is an \c NE that is shared with any previous versions of this Recipe, give them a copy of it.
+    *        (They can all share the same copy, as none of them can be modified.)
+    *
+    * \return \c true if \c ne is an \c NE, \c false otherwise
+    */
+   template<class NE> bool unshareIfNeeded(NamedEntity const & ne) {
+      NE const * shared = qobject_cast<NE const *>(&ne);
+      if (!shared) {
+         return false;
+      }
+
+      std::shared_ptr<NE> copy;
+      for (auto ancestor : this->recipe.ancestors()) {
+         if (ancestor->uses(*shared)) {
+            if (!copy) {
+               copy = makeStoredChildCopy(*shared);
+            }
+            ancestor->pimpl->replaceShared(*shared, *copy);
+         }
+      }
+      return true;
+   }
+
    //
    // Inside the class implementation, it's useful to be able to access fermentableIds, hopIds, etc in templated
    // functions.  This allows us to write this->accessIds<NE>() in such a function and have it resolve to
@@ -302,6 +448,110 @@ public:
       return;
    }
 
+   /**
+    * \brief See \c Recipe::connectSignalsForCachedOutput
+    */
+   void connectSignalsForCachedOutput() {
+      if (this->connectedSignalsForCachedOutput) {
+         return;
+      }
+      qDebug() << Q_FUNC_INFO << "Connecting signals for cached output of Recipe #" << this->recipe.key();
+
+      //
+      // Things that are added to the Recipe after it has been loaded will usually have been connected when they were
+      // added, so we ask Qt not to connect them twice.
+      //
+      auto const connectChangedSignal = [this](NamedEntity * containedObject) {
+         connect(containedObject,
+                 &NamedEntity::changed,
+                 &this->recipe,
+                 &Recipe::acceptChangeToContainedObject,
+                 Qt::UniqueConnection);
+      };
+
+      Style * style = this->recipe.style();
+      if (style) {
+         connectChangedSignal(style);
+      }
+      for (auto misc        : this->recipe.miscs()       ) { connectChangedSignal(misc       ); }
+      for (auto water       : this->recipe.waters()      ) { connectChangedSignal(water      ); }
+      for (auto salt        : this->recipe.salts()       ) { connectChangedSignal(salt       ); }
+      for (auto instruction : this->recipe.instructions()) { connectChangedSignal(instruction); }
+      for (auto brewNote    : this->recipe.brewNotes()   ) { connectChangedSignal(brewNote   ); }
+
+      this->connectedSignalsForCachedOutput = true;
+      watchBrewNoteStore();
+      return;
+   }
+
+   /**
+    * \brief BrewNotes are created (when the user brews a Recipe) and deleted without the Recipe being involved, as it's
+    *        the BrewNote that knows which Recipe it belongs to.  So, once any Recipe has cached output, we watch the
+    *        BrewNote ObjectStore to connect new BrewNotes to their Recipe, and to let the Recipe know that its list of
+    *        BrewNotes has changed.
+    */
+   static void watchBrewNoteStore() {
+      static bool watchingBrewNoteStore = false;
+      if (watchingBrewNoteStore) {
+         return;
+      }
+
+      auto & brewNoteStore = ObjectStoreTyped<BrewNote>::getInstance();
+      connect(&brewNoteStore,
+              &ObjectStoreTyped<BrewNote>::signalObjectInserted,
+              &brewNoteStore,
+              [](int id) {
+                 BrewNote * brewNote = ObjectStoreWrapper::getByIdRaw<BrewNote>(id);
+                 Recipe * recipe = brewNote ? ObjectStoreWrapper::getByIdRaw<Recipe>(brewNote->getRecipeId()) : nullptr;
+                 if (recipe) {
+                    if (recipe->pimpl->connectedSignalsForCachedOutput) {
+                       connect(brewNote, &NamedEntity::changed, recipe, &Recipe::acceptChangeToContainedObject);
+                    }
+                    ++recipe->pimpl->generation;
+                 }
+              });
+      connect(&brewNoteStore,
+              &ObjectStoreTyped<BrewNote>::signalObjectDeleted,
+              &brewNoteStore,
+              []([[maybe_unused]] int id, std::shared_ptr<QObject> object) {
+                 BrewNote * brewNote = qobject_cast<BrewNote *>(object.get());
+                 Recipe * recipe = brewNote ? ObjectStoreWrapper::getByIdRaw<Recipe>(brewNote->getRecipeId()) : nullptr;
+                 if (recipe) {
+                    ++recipe->pimpl->generation;
+                 }
+              });
+      watchingBrewNoteStore = true;
+      return;
+   }
+
+   /**
+    * \brief Returns the inputs to the recalc functions.  Inside Recipe::recalcAll, this is the snapshot taken at the
+    *        start of it.  Otherwise, it is the last one we took, unless the Recipe (see \c generation) or the settings
+    *        captured in it have changed since, in which case we take a new one.
+    */
+   std::shared_ptr<RecipeSnapshot const> snapshot() {
+      if (this->recalcSnapshot) {
+         return this->recalcSnapshot;
+      }
+      if (!this->cachedSnapshot ||
+          this->cachedSnapshotGeneration != this->generation ||
+          !this->cachedSnapshot->hasCurrentSettings()) {
+         this->cachedSnapshot = std::make_shared<RecipeSnapshot const>(RecipeSnapshot::create(this->recipe));
+         this->cachedSnapshotGeneration = this->generation;
+      }
+      return this->cachedSnapshot;
+   }
+
+   /**
+    * \brief Total points depend only on the fermentables, so this needs to be called whenever one of them changes, or
+    *        one is added or removed.  (Efficiency and equipment losses are applied after, so changes to them do not
+    *        require the points to be recalculated.)
+    */
+   void invalidateTotalPoints() {
+      this->totalPoints.reset();
+      return;
+   }
+
    // Member variables
    Recipe & recipe;
    QVector<int> fermentableIds;
@@ -311,6 +561,24 @@ public:
    QVector<int> saltIds;
    QVector<int> waterIds;
    QVector<int> yeastIds;
+   // Incremented every time this Recipe or one of the things it contains changes -- see Recipe::generation()
+   unsigned int generation;
+   // Set for the duration of Recipe::recalcAll -- see snapshot()
+   std::shared_ptr<RecipeSnapshot const> recalcSnapshot;
+   // Last snapshot taken outside Recipe::recalcAll, and the generation it was taken at -- see snapshot()
+   std::shared_ptr<RecipeSnapshot const> cachedSnapshot;
+   unsigned int cachedSnapshotGeneration;
+   // Cached result of Recipe::calcTotalPoints -- see invalidateTotalPoints()
+   std::optional<RecipeCalcs::TotalPoints> totalPoints;
+   // For logging how well the totalPoints cache is doing
+   unsigned int totalPointsRequests;
+   unsigned int totalPointsCalculations;
+   // Set while there is an EditSession on this Recipe, during which we put off recalculating until the end
+   EditSession * editSession;
+   // Set if we skipped a recalculation because of editSession
+   bool recalcDeferred;
+   // Set once connectSignalsForCachedOutput() has been called
+   bool connectedSignalsForCachedOutput;
 
 };
 
@@ -518,6 +786,7 @@ Recipe::Recipe(NamedParameterBundle const & namedParameterBundle) :
    m_ancestor_id       {namedParameterBundle.val<int         >(PropertyNames::Recipe::ancestorId        )},
    m_ancestors         {},
    m_hasDescendants    {false} {
+   notePreviousVersion(*this);
    // At this stage, we haven't set any Hops, Fermentables, etc.  This is deliberate because the caller typically needs
    // to access subsidiary records to obtain this info.   Callers will usually use setters (setHopIds, etc but via
    // setProperty) to finish constructing the object.
@@ -525,7 +794,11 @@ Recipe::Recipe(NamedParameterBundle const & namedParameterBundle) :
 }
 
 
-Recipe::Recipe(Recipe const & other) :
+Recipe::Recipe(Recipe const & other) : Recipe{other, CopyMode::Deep} {
+   return;
+}
+
+Recipe::Recipe(Recipe const & other, CopyMode const copyMode) :
    NamedEntity{other},
    pimpl{std::make_unique<impl>(*this)},
    m_type              {other.m_type              },
@@ -571,14 +844,33 @@ Recipe::Recipe(Recipe const & other) :
    //
    NamedEntityModifyingMarker modifyingMarker(*this);
 
-   //
-   // When we make a copy of a Recipe, it needs to be a deep(ish) copy.  In particular, we need to make copies of the
-   // Hops, Fermentables etc as some attributes of the recipe (eg how much and when to add) are stored inside these
-   // ingredients.
    //
    // We _don't_ want to copy BrewNotes (an instance of brewing the Recipe).  (This is easy not to do as we don't
    // currently store BrewNote IDs in Recipe.)
    //
+   // If we are making a previous version of a Recipe then, to begin with, it's identical to the current version, so
+   // there's no need to copy anything else either.  We just use the same IDs as other (including for Style, Mash and
+   // Equipment, which were copied above), and leave it to unshareWithPreviousVersions() to copy the things that change
+   // later.
+   //
+   if (CopyMode::SharedIngredients == copyMode) {
+      this->pimpl->shareList<Fermentable>(*this, other);
+      this->pimpl->shareList<Hop>        (*this, other);
+      this->pimpl->shareList<Instruction>(*this, other);
+      this->pimpl->shareList<Misc>       (*this, other);
+      this->pimpl->shareList<Salt>       (*this, other);
+      this->pimpl->shareList<Water>      (*this, other);
+      this->pimpl->shareList<Yeast>      (*this, other);
+      this->pimpl->connectSignals();
+      this->recalcAll();
+      return;
+   }
+
+   //
+   // Otherwise, when we make a copy of a Recipe, it needs to be a deep(ish) copy.  In particular, we need to make copies
+   // of the Hops, Fermentables etc as some attributes of the recipe (eg how much and when to add) are stored inside
+   // these ingredients.
+   //
    this->pimpl->copyList<Fermentable>(*this, other);
    this->pimpl->copyList<Hop> (*this, other);
    this->pimpl->copyList<Instruction>(*this, other);
@@ -651,545 +943,610 @@ void Recipe::connectSignalsForAllRecipes() {
    return;
 }
 
-
-void Recipe::mashFermentableIns() {
-   /*** Add grains ***/
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("Add grains"));
-   QString str = tr("Add ");
-   QList<QString> reagents = this->getReagents(this->fermentables());
-
-   for (int ii = 0; ii < reagents.size(); ++ii) {
-      str += reagents.at(ii);
-   }
-
-   str += tr("to the mash tun.");
-   ins->setDirections(str);
-
-   this->add(ins);
-
+void Recipe::connectSignalsForCachedOutput() {
+   this->pimpl->connectSignalsForCachedOutput();
    return;
 }
 
-void Recipe::saltWater(Salt::WhenToAdd when) {
+unsigned int Recipe::generation() const {
+   return this->pimpl->generation;
+}
 
-   if (this->mash() == nullptr || this->salts().size() == 0) {
-      return;
-   }
 
-   QStringList reagents = this->getReagents(salts(), when);
-   if (reagents.size() == 0) {
-      return;
+bool Recipe::isFermentableSugar(Fermentable * fermy) {
+   if (fermy->type() == Fermentable::Type::Sugar && fermy->name() == "Milk Sugar (Lactose)") {
+      return false;
    }
 
-   auto ins = std::make_shared<Instruction>();
-   QString tmp = when == Salt::WhenToAdd::MASH ? tr("mash") : tr("sparge");
-   ins->setName(tr("Modify %1 water").arg(tmp));
-   QString str = tr("Dissolve ");
+   return true;
+}
+
+//==================================================Instructions=======================================================
 
-   for (int ii = 0; ii < reagents.size(); ++ii) {
-      str += reagents.at(ii);
-   }
+namespace {
+   /**
+    * \brief Everything instruction generation needs from a Recipe, fetched from the ObjectStore once up front rather
+    *        than by each step.  Hops and miscs are grouped by use, and sorted by time (longest first, as instructions
+    *        are listed) so that each step only looks at the ones it needs, and so that regenerating the instructions
+    *        for an unchanged recipe always gives them in the same order.
+    */
+   struct InstructionIngredients {
+      QList<Fermentable *>             fermentables;
+      QMap<Hop::Use, QList<Hop *>>     hopsByUse;
+      QMap<Misc::Use, QList<Misc *>>   miscsByUse;
+      QList<Yeast *>                   yeasts;
+      QList<Salt *>                    salts;
+      Mash *                           mash;
+      QList<std::shared_ptr<MashStep>> mashSteps;
+      Equipment *                      equipment;
+   };
 
-   str += QString(tr(" into the %1 water").arg(tmp));
-   ins->setDirections(str);
+   InstructionIngredients instructionIngredients(Recipe const & recipe) {
+      InstructionIngredients ingredients;
+      ingredients.fermentables = recipe.fermentables();
+      for (auto hop : recipe.hops()) {
+         ingredients.hopsByUse[hop->use()].append(hop);
+      }
+      for (auto & hops : ingredients.hopsByUse) {
+         std::stable_sort(hops.begin(), hops.end(), [](Hop const * lhs, Hop const * rhs) {
+            return lhs->time_min() > rhs->time_min();
+         });
+      }
+      for (auto misc : recipe.miscs()) {
+         ingredients.miscsByUse[misc->use()].append(misc);
+      }
+      for (auto & miscs : ingredients.miscsByUse) {
+         std::stable_sort(miscs.begin(), miscs.end(), [](Misc const * lhs, Misc const * rhs) {
+            return lhs->time() > rhs->time();
+         });
+      }
+      ingredients.yeasts    = recipe.yeasts();
+      ingredients.salts     = recipe.salts();
+      ingredients.mash      = recipe.mash();
+      if (ingredients.mash) {
+         ingredients.mashSteps = ingredients.mash->mashSteps();
+      }
+      ingredients.equipment = recipe.equipment();
+      return ingredients;
+   }
 
-   this->add(ins);
+   //! \brief What one generated Instruction should say, before we know whether it will be a new or an existing one
+   struct PlannedInstruction {
+      QString        name;
+      QString        directions;
+      double         interval = 0.0;
+      QList<QString> reagents = {};
+   };
 
-   return;
-}
+   using InstructionPlan = QVector<PlannedInstruction>;
 
-void Recipe::mashWaterIns() {
+   void mashFermentableIns(Recipe & recipe, InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      /*** Add grains ***/
+      QString str = Recipe::tr("Add ");
+      for (auto const & reagent : recipe.getReagents(ingredients.fermentables)) {
+         str += reagent;
+      }
+      str += Recipe::tr("to the mash tun.");
 
-   if (this->mash() == nullptr) {
+      plan.append(PlannedInstruction{Recipe::tr("Add grains"), str});
       return;
    }
 
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("Heat water"));
-   QString str = tr("Bring ");
-   QList<QString> reagents = getReagents(mash()->mashSteps());
+   void saltWater(Recipe & recipe,
+                  InstructionIngredients const & ingredients,
+                  Salt::WhenToAdd when,
+                  InstructionPlan & plan) {
+      if (ingredients.mash == nullptr || ingredients.salts.size() == 0) {
+         return;
+      }
 
-   for (int ii = 0; ii < reagents.size(); ++ii) {
-      str += reagents.at(ii);
-   }
+      QStringList reagents = recipe.getReagents(ingredients.salts, when);
+      if (reagents.size() == 0) {
+         return;
+      }
 
-   str += tr("for upcoming infusions.");
-   ins->setDirections(str);
+      QString tmp = when == Salt::WhenToAdd::MASH ? Recipe::tr("mash") : Recipe::tr("sparge");
+      QString str = Recipe::tr("Dissolve ");
+      for (auto const & reagent : reagents) {
+         str += reagent;
+      }
+      str += QString(Recipe::tr(" into the %1 water").arg(tmp));
 
-   this->add(ins);
+      plan.append(PlannedInstruction{Recipe::tr("Modify %1 water").arg(tmp), str});
+      return;
+   }
 
-   return;
-}
+   void mashWaterIns(Recipe & recipe, InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      if (ingredients.mash == nullptr) {
+         return;
+      }
 
-QVector<PreInstruction> Recipe::mashInstructions(double timeRemaining,
-                                                 double totalWaterAdded_l,
-                                                 [[maybe_unused]] unsigned int size) {
-   QVector<PreInstruction> preins;
+      QString str = Recipe::tr("Bring ");
+      for (auto const & reagent : recipe.getReagents(ingredients.mashSteps)) {
+         str += reagent;
+      }
+      str += Recipe::tr("for upcoming infusions.");
 
-   if (mash() == nullptr) {
-      return preins;
+      plan.append(PlannedInstruction{Recipe::tr("Heat water"), str});
+      return;
    }
 
-   for (auto step : this->mash()->mashSteps()) {
-      QString str;
-      if (step->isInfusion()) {
-         str = tr("Add %1 water at %2 to mash to bring it to %3.")
-               .arg(Measurement::displayAmount(Measurement::Amount{step->infuseAmount_l(), Measurement::Units::liters}))
-               .arg(Measurement::displayAmount(Measurement::Amount{step->infuseTemp_c(), Measurement::Units::celsius}))
-               .arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(), Measurement::Units::celsius}));
-         totalWaterAdded_l += step->infuseAmount_l();
-      } else if (step->isTemperature()) {
-         str = tr("Heat mash to %1.").arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(),
-                                                                                         Measurement::Units::celsius}));
-      } else if (step->isDecoction()) {
-         str = tr("Bring %1 of the mash to a boil and return to the mash tun to bring it to %2.")
-               .arg(Measurement::displayAmount(Measurement::Amount{step->decoctionAmount_l(),
-                                                                   Measurement::Units::liters}))
-               .arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(), Measurement::Units::celsius}));
-      }
+   QVector<PreInstruction> mashInstructions(InstructionIngredients const & ingredients, double timeRemaining) {
+      QVector<PreInstruction> preins;
+
+      for (auto step : ingredients.mashSteps) {
+         QString str;
+         if (step->isInfusion()) {
+            str = Recipe::tr("Add %1 water at %2 to mash to bring it to %3.")
+                  .arg(Measurement::displayAmount(Measurement::Amount{step->infuseAmount_l(), Measurement::Units::liters}))
+                  .arg(Measurement::displayAmount(Measurement::Amount{step->infuseTemp_c(), Measurement::Units::celsius}))
+                  .arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(), Measurement::Units::celsius}));
+         } else if (step->isTemperature()) {
+            str = Recipe::tr("Heat mash to %1.").arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(),
+                                                                                                    Measurement::Units::celsius}));
+         } else if (step->isDecoction()) {
+            str = Recipe::tr("Bring %1 of the mash to a boil and return to the mash tun to bring it to %2.")
+                  .arg(Measurement::displayAmount(Measurement::Amount{step->decoctionAmount_l(),
+                                                                      Measurement::Units::liters}))
+                  .arg(Measurement::displayAmount(Measurement::Amount{step->stepTemp_c(), Measurement::Units::celsius}));
+         }
 
-      str += tr(" Hold for %1.").arg(Measurement::displayAmount(Measurement::Amount{step->stepTime_min(),
-                                                                                    Measurement::Units::minutes}));
+         str += Recipe::tr(" Hold for %1.").arg(Measurement::displayAmount(Measurement::Amount{step->stepTime_min(),
+                                                                                               Measurement::Units::minutes}));
 
-      preins.push_back(PreInstruction(str, QString("%1 - %2").arg(step->typeStringTr()).arg(step->name()),
-                                      timeRemaining));
-      timeRemaining -= step->stepTime_min();
+         preins.push_back(PreInstruction(str, QString("%1 - %2").arg(step->typeStringTr()).arg(step->name()),
+                                         timeRemaining));
+         timeRemaining -= step->stepTime_min();
+      }
+      return preins;
    }
-   return preins;
-}
 
-QVector<PreInstruction> Recipe::hopSteps(Hop::Use type) {
-   QVector<PreInstruction> preins;
+   QVector<PreInstruction> hopSteps(InstructionIngredients const & ingredients, Hop::Use type) {
+      QVector<PreInstruction> preins;
 
-   preins.clear();
-   QList<Hop *> hlist = hops();
-   int size = hlist.size();
-   for (int i = 0; static_cast<int>(i) < size; ++i) {
-      Hop * hop = hlist[static_cast<int>(i)];
-      if (hop->use() == type) {
+      for (auto hop : ingredients.hopsByUse.value(type)) {
          QString str;
          if (type == Hop::Use::Boil) {
-            str = tr("Put %1 %2 into boil for %3.");
+            str = Recipe::tr("Put %1 %2 into boil for %3.");
          } else if (type == Hop::Use::Dry_Hop) {
-            str = tr("Put %1 %2 into fermenter for %3.");
+            str = Recipe::tr("Put %1 %2 into fermenter for %3.");
          } else if (type == Hop::Use::First_Wort) {
-            str = tr("Put %1 %2 into first wort for %3.");
+            str = Recipe::tr("Put %1 %2 into first wort for %3.");
          } else if (type == Hop::Use::Mash) {
-            str = tr("Put %1 %2 into mash for %3.");
+            str = Recipe::tr("Put %1 %2 into mash for %3.");
          } else if (type == Hop::Use::Aroma) {
-            str = tr("Steep %1 %2 in wort for %3.");
+            str = Recipe::tr("Steep %1 %2 in wort for %3.");
          } else {
-            qWarning() << "Recipe::hopSteps(): Unrecognized hop use.";
-            str = tr("Use %1 %2 for %3");
+            qWarning() << Q_FUNC_INFO << "Unrecognized hop use.";
+            str = Recipe::tr("Use %1 %2 for %3");
          }
 
          str = str.arg(Measurement::displayAmount(Measurement::Amount{hop->amount_kg(), Measurement::Units::kilograms}))
-               .arg(hop->name())
-               .arg(Measurement::displayAmount(Measurement::Amount{hop->time_min(), Measurement::Units::minutes}));
+                  .arg(hop->name())
+                  .arg(Measurement::displayAmount(Measurement::Amount{hop->time_min(), Measurement::Units::minutes}));
 
-         preins.push_back(PreInstruction(str, tr("Hop addition"), hop->time_min()));
+         preins.push_back(PreInstruction(str, Recipe::tr("Hop addition"), hop->time_min()));
       }
+      return preins;
    }
-   return preins;
-}
 
-QVector<PreInstruction> Recipe::miscSteps(Misc::Use type) {
-   QVector<PreInstruction> preins;
+   QVector<PreInstruction> miscSteps(InstructionIngredients const & ingredients, Misc::Use type) {
+      QVector<PreInstruction> preins;
 
-   QList<Misc *> mlist = miscs();
-   int size = mlist.size();
-   for (unsigned int i = 0; static_cast<int>(i) < size; ++i) {
-      QString str;
-      Misc * misc = mlist[static_cast<int>(i)];
-      if (misc->use() == type) {
+      for (auto misc : ingredients.miscsByUse.value(type)) {
+         QString str;
          if (type == Misc::Use::Boil) {
-            str = tr("Put %1 %2 into boil for %3.");
+            str = Recipe::tr("Put %1 %2 into boil for %3.");
          } else if (type == Misc::Use::Bottling) {
-            str = tr("Use %1 %2 at bottling for %3.");
+            str = Recipe::tr("Use %1 %2 at bottling for %3.");
          } else if (type == Misc::Use::Mash) {
-            str = tr("Put %1 %2 into mash for %3.");
+            str = Recipe::tr("Put %1 %2 into mash for %3.");
          } else if (type == Misc::Use::Primary) {
-            str = tr("Put %1 %2 into primary for %3.");
+            str = Recipe::tr("Put %1 %2 into primary for %3.");
          } else if (type == Misc::Use::Secondary) {
-            str = tr("Put %1 %2 into secondary for %3.");
+            str = Recipe::tr("Put %1 %2 into secondary for %3.");
          } else {
-            qWarning() << "Recipe::getMiscSteps(): Unrecognized misc use.";
-            str = tr("Use %1 %2 for %3.");
+            qWarning() << Q_FUNC_INFO << "Unrecognized misc use.";
+            str = Recipe::tr("Use %1 %2 for %3.");
          }
 
-         str = str .arg(Measurement::displayAmount(Measurement::Amount{
-                                                      misc->amount(),
-                                                      misc->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
-                                                   }))
-               .arg(misc->name())
-               .arg(Measurement::displayAmount(Measurement::Amount{misc->time(), Measurement::Units::minutes}));
+         str = str.arg(Measurement::displayAmount(Measurement::Amount{
+                                                     misc->amount(),
+                                                     misc->amountIsWeight() ? Measurement::Units::kilograms : Measurement::Units::liters
+                                                  }))
+                  .arg(misc->name())
+                  .arg(Measurement::displayAmount(Measurement::Amount{misc->time(), Measurement::Units::minutes}));
 
-         preins.push_back(PreInstruction(str, tr("Misc addition"), misc->time()));
+         preins.push_back(PreInstruction(str, Recipe::tr("Misc addition"), misc->time()));
       }
+      return preins;
    }
-   return preins;
-}
 
-void Recipe::firstWortHopsIns() {
-   QList<QString> reagents = getReagents(hops(), true);
-   if (reagents.size() == 0) {
-      return;
-   }
+   void firstWortHopsIns(Recipe & recipe, InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      QList<QString> reagents = recipe.getReagents(ingredients.hopsByUse.value(Hop::Use::First_Wort), true);
+      if (reagents.size() == 0) {
+         return;
+      }
 
-   QString str = tr("Do first wort hopping with ");
+      QString str = Recipe::tr("Do first wort hopping with ");
+      for (auto const & reagent : reagents) {
+         str += reagent;
+      }
+      str += ".";
 
-   for (int ii = 0; ii < reagents.size(); ++ii) {
-      str += reagents.at(ii);
+      plan.append(PlannedInstruction{Recipe::tr("First wort hopping"), str});
+      return;
    }
-   str += ".";
 
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("First wort hopping"));
-   ins->setDirections(str);
+   void topOffIns(Recipe & recipe, InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      Equipment * e = ingredients.equipment;
+      if (e == nullptr) {
+         return;
+      }
 
-   this->add(ins);
+      double wortInBoil_l = recipe.wortFromMash_l() - e->lauterDeadspace_l();
+      QString str = Recipe::tr("You should now have %1 wort.")
+                    .arg(Measurement::displayAmount(Measurement::Amount{wortInBoil_l, Measurement::Units::liters}));
+      if (e->topUpKettle_l() != 0.0) {
+         return;
+      }
 
-   return;
-}
+      wortInBoil_l += e->topUpKettle_l();
+      QString tmp = Recipe::tr(" Add %1 water to the kettle, bringing pre-boil volume to %2.")
+                    .arg(Measurement::displayAmount(Measurement::Amount{e->topUpKettle_l(), Measurement::Units::liters}))
+                    .arg(Measurement::displayAmount(Measurement::Amount{wortInBoil_l, Measurement::Units::liters}));
 
-void Recipe::topOffIns() {
-   Equipment * e = this->equipment();
-   if (e == nullptr) {
-      return;
-   }
+      str += tmp;
 
-   double wortInBoil_l = wortFromMash_l() - e->lauterDeadspace_l();
-   QString str = tr("You should now have %1 wort.")
-                 .arg(Measurement::displayAmount(Measurement::Amount{wortInBoil_l, Measurement::Units::liters}));
-   if (e->topUpKettle_l() != 0.0) {
+      plan.append(PlannedInstruction{Recipe::tr("Pre-boil"), str, 0.0, {tmp}});
       return;
    }
 
-   wortInBoil_l += e->topUpKettle_l();
-   QString tmp = tr(" Add %1 water to the kettle, bringing pre-boil volume to %2.")
-                 .arg(Measurement::displayAmount(Measurement::Amount{e->topUpKettle_l(), Measurement::Units::liters}))
-                 .arg(Measurement::displayAmount(Measurement::Amount{wortInBoil_l, Measurement::Units::liters}));
-
-   str += tmp;
-
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("Pre-boil"));
-   ins->setDirections(str);
-   ins->addReagent(tmp);
+   bool hasBoilFermentable(InstructionIngredients const & ingredients) {
+      return std::any_of(ingredients.fermentables.cbegin(),
+                         ingredients.fermentables.cend(),
+                         [](Fermentable const * ferm) { return !ferm->isMashed() && !ferm->addAfterBoil(); });
+   }
 
-   this->add(ins);
+   bool hasBoilExtract(InstructionIngredients const & ingredients) {
+      return std::any_of(ingredients.fermentables.cbegin(),
+                         ingredients.fermentables.cend(),
+                         [](Fermentable const * ferm) { return ferm->isExtract(); });
+   }
 
-   return;
-}
+   PreInstruction boilFermentablesPre(InstructionIngredients const & ingredients, double timeRemaining) {
+      QString str = Recipe::tr("Boil or steep ");
+      for (auto ferm : ingredients.fermentables) {
+         if (ferm->isMashed() || ferm->addAfterBoil() || ferm->isExtract()) {
+            continue;
+         }
 
-bool Recipe::hasBoilFermentable() {
-   int i;
-   for (i = 0; static_cast<int>(i) < fermentables().size(); ++i) {
-      Fermentable * ferm = fermentables()[i];
-      if (ferm->isMashed() || ferm->addAfterBoil()) {
-         continue;
-      } else {
-         return true;
+         str += QString("%1 %2, ")
+                .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
+                .arg(ferm->name());
       }
-   }
-   return false;
-}
+      str += ".";
 
-bool Recipe::hasBoilExtract() {
-   int i;
-   for (i = 0; static_cast<int>(i) < fermentables().size(); ++i) {
-      Fermentable * ferm = fermentables()[i];
-      if (ferm->isExtract()) {
-         return true;
-      } else {
-         continue;
-      }
+      return PreInstruction(str, Recipe::tr("Boil/steep fermentables"), timeRemaining);
    }
-   return false;
-}
 
-PreInstruction Recipe::boilFermentablesPre(double timeRemaining) {
-   QString str = tr("Boil or steep ");
-   QList<Fermentable *> flist = fermentables();
-   int size = flist.size();
-   for (int i = 0; static_cast<int>(i) < size; ++i) {
-      Fermentable * ferm = flist[i];
-      if (ferm->isMashed() || ferm->addAfterBoil() || ferm->isExtract()) {
-         continue;
+   PreInstruction addExtracts(InstructionIngredients const & ingredients, double timeRemaining) {
+      QString str = Recipe::tr("Raise water to boil and then remove from heat. Stir in  ");
+      for (auto ferm : ingredients.fermentables) {
+         if (ferm->isExtract()) {
+            str += QString("%1 %2, ")
+                   .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
+                   .arg(ferm->name());
+         }
       }
+      str += ".";
 
-      str += QString("%1 %2, ")
-             .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
-             .arg(ferm->name());
+      return PreInstruction(str, Recipe::tr("Add Extracts to water"), timeRemaining);
    }
-   str += ".";
-
-   return PreInstruction(str, tr("Boil/steep fermentables"), timeRemaining);
-}
 
-bool Recipe::isFermentableSugar(Fermentable * fermy) {
-   if (fermy->type() == Fermentable::Type::Sugar && fermy->name() == "Milk Sugar (Lactose)") {
-      return false;
-   }
+   void postboilFermentablesIns(InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      QString tmp;
+      bool hasFerms = false;
 
-   return true;
-}
+      QString str = Recipe::tr("Add ");
+      for (auto ferm : ingredients.fermentables) {
+         if (!ferm->addAfterBoil()) {
+            continue;
+         }
 
-PreInstruction Recipe::addExtracts(double timeRemaining) const {
-   QString str = tr("Raise water to boil and then remove from heat. Stir in  ");
-   const QList<Fermentable *> flist = fermentables();
-   int size = flist.size();
-   for (int i = 0; static_cast<int>(i) < size; ++i) {
-      const Fermentable * ferm = flist[i];
-      if (ferm->isExtract()) {
-         str += QString("%1 %2, ")
-                .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
-                .arg(ferm->name());
+         hasFerms = true;
+         tmp = QString("%1 %2, ")
+               .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
+               .arg(ferm->name());
+         str += tmp;
       }
-   }
-   str += ".";
-
-   return PreInstruction(str, tr("Add Extracts to water"), timeRemaining);
-}
+      str += Recipe::tr("to the boil at knockout.");
 
-void Recipe::postboilFermentablesIns() {
-   QString tmp;
-   bool hasFerms = false;
-
-   QString str = tr("Add ");
-   QList<Fermentable *> flist = this->fermentables();
-   int size = flist.size();
-   for (int ii = 0; ii < size; ++ii) {
-      Fermentable * ferm = flist[ii];
-      if (!ferm->addAfterBoil()) {
-         continue;
+      if (!hasFerms) {
+         return;
       }
 
-      hasFerms = true;
-      tmp = QString("%1 %2, ")
-            .arg(Measurement::displayAmount(Measurement::Amount{ferm->amount_kg(), Measurement::Units::kilograms}))
-            .arg(ferm->name());
-      str += tmp;
-   }
-   str += tr("to the boil at knockout.");
-
-   if (!hasFerms) {
+      plan.append(PlannedInstruction{Recipe::tr("Knockout additions"), str, 0.0, {tmp}});
       return;
    }
 
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("Knockout additions"));
-   ins->setDirections(str);
-   ins->addReagent(tmp);
-
-   this->add(ins);
+   void postboilIns(Recipe & recipe, InstructionIngredients const & ingredients, InstructionPlan & plan) {
+      Equipment * e = ingredients.equipment;
+      if (e == nullptr) {
+         return;
+      }
 
-   return;
-}
+      double wortInBoil_l = recipe.wortFromMash_l() - e->lauterDeadspace_l();
+      if (e->topUpKettle_l() != 0.0) {
+         wortInBoil_l += e->topUpKettle_l();
+      }
 
-void Recipe::postboilIns() {
-   Equipment * e = equipment();
-   if (e == nullptr) {
+      double wort_l = e->wortEndOfBoil_l(wortInBoil_l);
+      QString str = Recipe::tr("You should have %1 wort post-boil.")
+                    .arg(Measurement::displayAmount(Measurement::Amount{wort_l, Measurement::Units::liters}));
+      str += Recipe::tr("\nYou anticipate losing %1 to trub and chiller loss.")
+             .arg(Measurement::displayAmount(Measurement::Amount{e->trubChillerLoss_l(), Measurement::Units::liters}));
+      wort_l -= e->trubChillerLoss_l();
+      if (e->topUpWater_l() > 0.0)
+         str += Recipe::tr("\nAdd %1 top up water into primary.")
+                .arg(Measurement::displayAmount(Measurement::Amount{e->topUpWater_l(), Measurement::Units::liters}));
+      wort_l += e->topUpWater_l();
+      str += Recipe::tr("\nThe final volume in the primary is %1.")
+             .arg(Measurement::displayAmount(Measurement::Amount{wort_l, Measurement::Units::liters}));
+
+      plan.append(PlannedInstruction{Recipe::tr("Post boil"), str});
       return;
    }
 
-   double wortInBoil_l = wortFromMash_l() - e->lauterDeadspace_l();
-   if (e->topUpKettle_l() != 0.0) {
-      wortInBoil_l += e->topUpKettle_l();
+   void addPreinstructions(QVector<PreInstruction> preins, InstructionPlan & plan) {
+      // Add instructions in descending mash time order.  (Stable sort so that the order is the same every time.)
+      std::stable_sort(preins.begin(), preins.end(), std::greater<PreInstruction>());
+      for (auto & pi : preins) {
+         plan.append(PlannedInstruction{pi.getTitle(), pi.getText(), pi.getTime()});
+      }
+      return;
    }
 
-   double wort_l = e->wortEndOfBoil_l(wortInBoil_l);
-   QString str = tr("You should have %1 wort post-boil.")
-                 .arg(Measurement::displayAmount(Measurement::Amount{wort_l, Measurement::Units::liters}));
-   str += tr("\nYou anticipate losing %1 to trub and chiller loss.")
-          .arg(Measurement::displayAmount(Measurement::Amount{e->trubChillerLoss_l(), Measurement::Units::liters}));
-   wort_l -= e->trubChillerLoss_l();
-   if (e->topUpWater_l() > 0.0)
-      str += tr("\nAdd %1 top up water into primary.")
-             .arg(Measurement::displayAmount(Measurement::Amount{e->topUpWater_l(), Measurement::Units::liters}));
-   wort_l += e->topUpWater_l();
-   str += tr("\nThe final volume in the primary is %1.")
-          .arg(Measurement::displayAmount(Measurement::Amount{wort_l, Measurement::Units::liters}));
+   /**
+    * \brief Work out, in order, all the instructions for \c recipe.  Nothing is written anywhere.
+    */
+   InstructionPlan planInstructions(Recipe & recipe, InstructionIngredients const & ingredients) {
+      InstructionPlan plan;
+      double timeRemaining;
 
-   auto ins = std::make_shared<Instruction>();
-   ins->setName(tr("Post boil"));
-   ins->setDirections(str);
-   this->add(ins);
+      QVector<PreInstruction> preinstructions;
 
-   return;
-}
+      // Mash instructions
 
-void Recipe::addPreinstructions(QVector<PreInstruction> preins) {
-   // Add instructions in descending mash time order.
-   std::sort(preins.begin(), preins.end(), std::greater<PreInstruction>());
-   for (int ii = 0; ii < preins.size(); ++ii) {
-      PreInstruction pi = preins[ii];
+      if (ingredients.mashSteps.size() > 0) {
+         /*** prepare mashed fermentables ***/
+         mashFermentableIns(recipe, ingredients, plan);
 
-      auto ins = std::make_shared<Instruction>();
-      ins->setName(pi.getTitle());
-      ins->setDirections(pi.getText());
-      ins->setInterval(pi.getTime());
+         /*** salt the water ***/
+         saltWater(recipe, ingredients, Salt::WhenToAdd::MASH, plan);
+         saltWater(recipe, ingredients, Salt::WhenToAdd::SPARGE, plan);
 
-      this->add(ins);
-   }
-   return;
-}
+         /*** Prepare water additions ***/
+         mashWaterIns(recipe, ingredients, plan);
 
-void Recipe::generateInstructions() {
-   double timeRemaining;
-   double totalWaterAdded_l = 0.0;
+         timeRemaining = ingredients.mash->totalTime();
 
-   if (!this->instructions().empty()) {
-      this->clearInstructions();
-   }
+         /*** Generate the mash instructions ***/
+         preinstructions = mashInstructions(ingredients, timeRemaining);
 
-   QVector<PreInstruction> preinstructions;
+         /*** Hops mash additions ***/
+         preinstructions += hopSteps(ingredients, Hop::Use::Mash);
 
-   // Mash instructions
+         /*** Misc mash additions ***/
+         preinstructions += miscSteps(ingredients, Misc::Use::Mash);
 
-   int size = (mash() == nullptr) ? 0 : mash()->mashSteps().size();
-   if (size > 0) {
-      /*** prepare mashed fermentables ***/
-      this->mashFermentableIns();
+         /*** Add the preinstructions into the instructions ***/
+         addPreinstructions(preinstructions, plan);
 
-      /*** salt the water ***/
-      saltWater(Salt::WhenToAdd::MASH);
-      saltWater(Salt::WhenToAdd::SPARGE);
+      } // END mash instructions.
 
-      /*** Prepare water additions ***/
-      this->mashWaterIns();
+      // First wort hopping
+      firstWortHopsIns(recipe, ingredients, plan);
 
-      timeRemaining = mash()->totalTime();
+      // Need to top up the kettle before boil?
+      topOffIns(recipe, ingredients, plan);
 
-      /*** Generate the mash instructions ***/
-      preinstructions = mashInstructions(timeRemaining, totalWaterAdded_l, size);
+      // Boil instructions
+      preinstructions.clear();
 
-      /*** Hops mash additions ***/
-      preinstructions += hopSteps(Hop::Use::Mash);
+      // Find boil time.
+      if (ingredients.equipment != nullptr) {
+         timeRemaining = ingredients.equipment->boilTime_min();
+      } else {
+         timeRemaining =
+            Measurement::qStringToSI(QInputDialog::getText(nullptr,
+                                                           Recipe::tr("Boil time"),
+                                                           Recipe::tr("You did not configure an equipment (which you really should), so tell me the boil time.")),
+                                     Measurement::PhysicalQuantity::Time).quantity();
+      }
 
-      /*** Misc mash additions ***/
-      preinstructions += miscSteps(Misc::Use::Mash);
+      QString str = Recipe::tr("Bring the wort to a boil and hold for %1.").arg(
+         Measurement::displayAmount(Measurement::Amount{timeRemaining, Measurement::Units::minutes})
+      );
+      plan.append(PlannedInstruction{Recipe::tr("Start boil"), str, timeRemaining});
 
-      /*** Add the preinstructions into the instructions ***/
-      addPreinstructions(preinstructions);
+      /*** Get fermentables unless we haven't added yet ***/
+      if (hasBoilFermentable(ingredients)) {
+         preinstructions.push_back(boilFermentablesPre(ingredients, timeRemaining));
+      }
 
-   } // END mash instructions.
+      // add the intructions for including Extracts to wort
+      if (hasBoilExtract(ingredients)) {
+         preinstructions.push_back(addExtracts(ingredients, timeRemaining - 1));
+      }
 
-   // First wort hopping
-   this->firstWortHopsIns();
+      /*** Boiled hops ***/
+      preinstructions += hopSteps(ingredients, Hop::Use::Boil);
 
-   // Need to top up the kettle before boil?
-   topOffIns();
+      /*** Boiled miscs ***/
+      preinstructions += miscSteps(ingredients, Misc::Use::Boil);
 
-   // Boil instructions
-   preinstructions.clear();
+      // END boil instructions.
 
-   // Find boil time.
-   if (equipment() != nullptr) {
-      timeRemaining = equipment()->boilTime_min();
-   } else {
-      timeRemaining =
-         Measurement::qStringToSI(QInputDialog::getText(nullptr,
-                                                        tr("Boil time"),
-                                                        tr("You did not configure an equipment (which you really should), so tell me the boil time.")),
-                                  Measurement::PhysicalQuantity::Time).quantity();
-   }
+      // Add instructions in descending mash time order.
+      addPreinstructions(preinstructions, plan);
 
-   QString str = tr("Bring the wort to a boil and hold for %1.").arg(
-      Measurement::displayAmount(Measurement::Amount{timeRemaining, Measurement::Units::minutes})
-   );
+      // FLAMEOUT
+      plan.append(PlannedInstruction{Recipe::tr("Flameout"), Recipe::tr("Stop boiling the wort.")});
 
-   auto startBoilIns = std::make_shared<Instruction>();
-   startBoilIns->setName(tr("Start boil"));
-   startBoilIns->setInterval(timeRemaining);
-   startBoilIns->setDirections(str);
-   this->add(startBoilIns);
+      // Steeped aroma hops
+      addPreinstructions(hopSteps(ingredients, Hop::Use::Aroma), plan);
 
-   /*** Get fermentables unless we haven't added yet ***/
-   if (hasBoilFermentable()) {
-      preinstructions.push_back(boilFermentablesPre(timeRemaining));
-   }
+      // Fermentation instructions
 
-   // add the intructions for including Extracts to wort
-   if (hasBoilExtract()) {
-      preinstructions.push_back(addExtracts(timeRemaining - 1));
-   }
+      /*** Fermentables added after boil ***/
+      postboilFermentablesIns(ingredients, plan);
 
-   /*** Boiled hops ***/
-   preinstructions += hopSteps(Hop::Use::Boil);
+      /*** post boil ***/
+      postboilIns(recipe, ingredients, plan);
 
-   /*** Boiled miscs ***/
-   preinstructions += miscSteps(Misc::Use::Boil);
+      /*** Primary yeast ***/
+      str = Recipe::tr("Cool wort and pitch ");
+      for (auto yeast : ingredients.yeasts) {
+         if (! yeast->addToSecondary()) {
+            str += Recipe::tr("%1 %2 yeast, ").arg(yeast->name()).arg(yeast->typeStringTr());
+         }
+      }
+      str += Recipe::tr("to the primary.");
+      plan.append(PlannedInstruction{Recipe::tr("Pitch yeast"), str});
+      /*** End primary yeast ***/
 
-   // END boil instructions.
+      /*** Primary misc ***/
+      addPreinstructions(miscSteps(ingredients, Misc::Use::Primary), plan);
 
-   // Add instructions in descending mash time order.
-   addPreinstructions(preinstructions);
+      str = Recipe::tr("Let ferment until FG is %1.").arg(
+         Measurement::displayAmount(Measurement::Amount{recipe.fg(), Measurement::Units::specificGravity}, 3)
+      );
+      plan.append(PlannedInstruction{Recipe::tr("Ferment"), str});
 
-   // FLAMEOUT
-   auto flameoutIns = std::make_shared<Instruction>();
-   flameoutIns->setName(tr("Flameout"));
-   flameoutIns->setDirections(tr("Stop boiling the wort."));
-   this->add(flameoutIns);
+      plan.append(PlannedInstruction{Recipe::tr("Transfer to secondary"), Recipe::tr("Transfer beer to secondary.")});
 
-   // Steeped aroma hops
-   preinstructions.clear();
-   preinstructions += hopSteps(Hop::Use::Aroma);
-   addPreinstructions(preinstructions);
+      /*** Secondary misc ***/
+      addPreinstructions(miscSteps(ingredients, Misc::Use::Secondary), plan);
 
-   // Fermentation instructions
-   preinstructions.clear();
+      /*** Dry hopping ***/
+      addPreinstructions(hopSteps(ingredients, Hop::Use::Dry_Hop), plan);
 
-   /*** Fermentables added after boil ***/
-   postboilFermentablesIns();
+      return plan;
+   }
 
-   /*** post boil ***/
-   postboilIns();
+   //! \brief Whether \c instruction already says exactly what a newly-generated one for \c planned would
+   bool isAsPlanned(Instruction & instruction, PlannedInstruction const & planned) {
+      return instruction.name()       == planned.name       &&
+             instruction.directions() == planned.directions &&
+             instruction.interval()   == planned.interval   &&
+             !instruction.hasTimer()                        &&
+             instruction.timerValue().isEmpty()             &&
+             !instruction.completed();
+   }
 
-   /*** Primary yeast ***/
-   str = tr("Cool wort and pitch ");
-   QList<Yeast *> ylist = yeasts();
-   for (int ii = 0; ii < ylist.size(); ++ii) {
-      Yeast * yeast = ylist[ii];
-      if (! yeast->addToSecondary()) {
-         str += tr("%1 %2 yeast, ").arg(yeast->name()).arg(yeast->typeStringTr());
-      }
+   //! \brief Make \c instruction say what \c planned does, only setting (and thus writing to the DB) what differs
+   void makeAsPlanned(Instruction & instruction, PlannedInstruction const & planned) {
+      if (instruction.name()       != planned.name      ) { instruction.setName      (planned.name      ); }
+      if (instruction.directions() != planned.directions) { instruction.setDirections(planned.directions); }
+      if (instruction.interval()   != planned.interval  ) { instruction.setInterval  (planned.interval  ); }
+      if (instruction.hasTimer()                        ) { instruction.setHasTimer  (false             ); }
+      if (!instruction.timerValue().isEmpty()           ) { instruction.setTimerValue(QString{}         ); }
+      if (instruction.completed()                       ) { instruction.setCompleted (false             ); }
+      instruction.setReagents(planned.reagents);
+      return;
    }
-   str += tr("to the primary.");
+}
 
-   auto pitchIns = std::make_shared<Instruction>();
-   pitchIns->setName(tr("Pitch yeast"));
-   pitchIns->setDirections(str);
-   this->add(pitchIns);
-   /*** End primary yeast ***/
+void Recipe::generateInstructions() {
+   BT_TIME_SCOPE("Recipe::generateInstructions");
 
-   /*** Primary misc ***/
-   addPreinstructions(miscSteps(Misc::Use::Primary));
+   InstructionPlan const plan = planInstructions(*this, instructionIngredients(*this));
 
-   str = tr("Let ferment until FG is %1.").arg(
-      Measurement::displayAmount(Measurement::Amount{fg(), Measurement::Units::specificGravity}, 3)
-   );
+   //
+   // Now make our instructions match the plan.  Regenerating typically only changes a few of them (eg after the time
+   // of one hop addition changes), so, rather than deleting them all and inserting new ones, we reuse what we can:
+   // first any existing instruction that is already exactly right, then any left over, updated in place.  Only what's
+   // left after that is inserted or deleted, and all the DB writes go in one transaction.  (The ones in ObjectStore
+   // just become part of it -- see DbTransaction.)
+   //
+   Database & database = Database::instance();
+   QSqlDatabase connection = database.sqlDatabase();
+   DbTransaction dbTransaction{database, connection};
+
+   QList<Instruction *> const existing = this->instructions();
+   QVector<bool> existingUsed(existing.size(), false);
+   QVector<Instruction *> chosen(plan.size(), nullptr);
+   for (int ii = 0; ii < plan.size(); ++ii) {
+      for (int jj = 0; jj < existing.size(); ++jj) {
+         if (!existingUsed.at(jj) && isAsPlanned(*existing.at(jj), plan.at(ii))) {
+            chosen[ii] = existing.at(jj);
+            existingUsed[jj] = true;
+            existing.at(jj)->setReagents(plan.at(ii).reagents);
+            break;
+         }
+      }
+   }
+
+   int numUpdated = 0;
+   int numInserted = 0;
+   int nextLeftover = 0;
+   for (int ii = 0; ii < plan.size(); ++ii) {
+      if (chosen.at(ii)) {
+         continue;
+      }
+      while (nextLeftover < existing.size() && existingUsed[nextLeftover]) {
+         ++nextLeftover;
+      }
+      if (nextLeftover < existing.size()) {
+         chosen[ii] = existing.at(nextLeftover);
+         existingUsed[nextLeftover] = true;
+         makeAsPlanned(*chosen.at(ii), plan.at(ii));
+         ++numUpdated;
+      } else {
+         auto instruction = std::make_shared<Instruction>();
+         makeAsPlanned(*instruction, plan.at(ii));
+         ObjectStoreWrapper::insert(instruction);
+         connect(instruction.get(), &NamedEntity::changed, this, &Recipe::acceptChangeToContainedObject);
+         chosen[ii] = instruction.get();
+         ++numInserted;
+      }
+   }
 
-   auto fermentIns = std::make_shared<Instruction>();
-   fermentIns->setName(tr("Ferment"));
-   fermentIns->setDirections(str);
-   this->add(fermentIns);
+   //
+   // Instructions we no longer need get deleted, except for any that a previous version of this Recipe still lists,
+   // which just stop being ours when we set instructionIds below.
+   //
+   int numDeleted = 0;
+   for (int jj = 0; jj < existing.size(); ++jj) {
+      if (!existingUsed[jj]) {
+         if (!this->pimpl->isSharedWithAnotherRecipe(*existing.at(jj))) {
+            ObjectStoreTyped<Instruction>::getInstance().softDelete(existing.at(jj)->key());
+         }
+         ++numDeleted;
+      }
+   }
 
-   str = tr("Transfer beer to secondary.");
-   auto transferIns = std::make_shared<Instruction>();
-   transferIns->setName(tr("Transfer to secondary"));
-   transferIns->setDirections(str);
-   this->add(transferIns);
+   QVector<int> instructionIds;
+   instructionIds.reserve(chosen.size());
+   for (auto instruction : chosen) {
+      instructionIds.append(instruction->key());
+   }
+   if (instructionIds != this->pimpl->instructionIds) {
+      this->pimpl->instructionIds = instructionIds;
+      this->propagatePropertyChange(propertyToPropertyName<Instruction>());
+   }
 
-   /*** Secondary misc ***/
-   addPreinstructions(miscSteps(Misc::Use::Secondary));
+   if (!dbTransaction.commit()) {
+      qCritical() << Q_FUNC_INFO << "Unable to commit instructions for Recipe #" << this->key();
+   }
 
-   /*** Dry hopping ***/
-   addPreinstructions(hopSteps(Hop::Use::Dry_Hop));
+   qDebug() <<
+      Q_FUNC_INFO << "Recipe #" << this->key() << "now has" << plan.size() << "instructions:" <<
+      plan.size() - numUpdated - numInserted << "unchanged," << numUpdated << "updated," << numInserted <<
+      "inserted and" << numDeleted << "deleted";
 
-   // END fermentation instructions. Let everybody know that now is the time
-   // to update instructions
+   // Let everybody know that now is the time to update instructions
    emit changed(metaProperty(*PropertyNames::Recipe::instructions), this->instructions().size());
 
    return;
@@ -1345,6 +1702,9 @@ template<class NE> std::shared_ptr<NE> Recipe::remove(std::shared_ptr<NE> var) {
       Q_ASSERT(false);
    } else {
       this->propagatePropertyChange(propertyToPropertyName<NE>());
+      if constexpr (std::is_same_v<NE, Fermentable>) {
+         this->pimpl->invalidateTotalPoints();
+      }
       this->recalcIBU(); // .:TODO:. Don't need to do this recalculation when it's Instruction
    }
 
@@ -1400,6 +1760,11 @@ void Recipe::swapInstructions(Instruction * ins1, Instruction * ins2) {
 
 void Recipe::clearInstructions() {
    for (int ii : this->pimpl->instructionIds) {
+      // Anything a previous version of this Recipe still lists is left for that version
+      Instruction const * instruction = ObjectStoreWrapper::getByIdRaw<Instruction>(ii);
+      if (instruction && this->pimpl->isSharedWithAnotherRecipe(*instruction)) {
+         continue;
+      }
       ObjectStoreTyped<Instruction>::getInstance().softDelete(ii);
    }
    this->pimpl->instructionIds.clear();
@@ -1433,7 +1798,14 @@ void Recipe::setStyle(Style * var) {
    }
 
    std::shared_ptr<Style> styleToAdd = copyIfNeeded(*var);
+   Style * oldStyle = this->style();
+   if (oldStyle) {
+      disconnect(oldStyle, nullptr, this, nullptr);
+   }
    this->styleId = styleToAdd->key();
+   if (this->pimpl->connectedSignalsForCachedOutput) {
+      connect(styleToAdd.get(), &NamedEntity::changed, this, &Recipe::acceptChangeToContainedObject);
+   }
    this->propagatePropertyChange(propertyToPropertyName<Style>());
    return;
 }
@@ -1490,6 +1862,7 @@ void Recipe::setMashId(int id) {
 
 void Recipe::setFermentableIds(QVector<int> fermentableIds) {
    this->pimpl->fermentableIds = fermentableIds;
+   this->pimpl->invalidateTotalPoints();
    return;
 }
 
@@ -1745,6 +2118,7 @@ void Recipe::setAncestorId(int ancestorId, bool notify) {
       return;
    }
    this->m_ancestor_id = ancestorId;
+   notePreviousVersion(*this);
    this->propagatePropertyChange(PropertyNames::Recipe::ancestorId, notify);
    return;
 }
@@ -2052,10 +2426,20 @@ double Recipe::batchSizeNoLosses_l() {
 //==============================Recalculators==================================
 
 void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
-   qDebug() << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged;
+   qCDebug(Logging::recipe) << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged;
    // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
    // ::staticMetaObject.className() is a bit more clunky but it's safer.
 
+   if (classNameOfWhatWasAddedOrChanged == Fermentable::staticMetaObject.className()) {
+      this->pimpl->invalidateTotalPoints();
+   }
+
+   // If we're in the middle of an EditSession, it will do one recalcAll at the end, which covers everything below
+   if (this->pimpl->editSession) {
+      this->pimpl->recalcDeferred = true;
+      return;
+   }
+
    if (classNameOfWhatWasAddedOrChanged == Hop::staticMetaObject.className()) {
       this->recalcIBU();
       return;
@@ -2078,6 +2462,8 @@ void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
 }
 
 void Recipe::recalcAll() {
+   BT_TIME_SCOPE("Recipe::recalcAll");
+
    // WARNING
    // Infinite recursion possible, since these methods will emit changed(),
    // causing other objects to call finalVolume_l() for example, which may
@@ -2085,11 +2471,22 @@ void Recipe::recalcAll() {
    //
    // GSG: Now only emit when _uninitializedCalcs is true, which helps some.
 
+   // Inside an EditSession, we wait until the end.  (The exception is if we've never calculated anything, as then
+   // there's nothing sensible for the getters to return in the meantime.)
+   if (this->pimpl->editSession && !m_uninitializedCalcs) {
+      this->pimpl->recalcDeferred = true;
+      return;
+   }
+
    // Someone has already called this function back in the call stack, so return to avoid recursion.
    if (! m_recalcMutex.tryLock()) {
       return;
    }
 
+   // Use one snapshot of our inputs for all the calculations below, rather than one per calculation.  (We can't just
+   // rely on the cache in snapshot() here, because the calculations emit changed(), which bumps our generation.)
+   this->pimpl->recalcSnapshot = this->pimpl->snapshot();
+
    // Times are in seconds, and are cumulative.
    recalcGrainsInMash_kg(); // 0.01
    recalcGrains_kg(); // 0.03
@@ -2102,17 +2499,17 @@ void Recipe::recalcAll() {
    recalcIBU(); // 0.15
    recalcCalories();
 
+   this->pimpl->recalcSnapshot.reset();
+
    m_uninitializedCalcs = false;
 
    m_recalcMutex.unlock();
 }
 
 void Recipe::recalcABV_pct() {
-   double ret;
+   BT_TIME_SCOPE("Recipe::recalcABV_pct");
 
-   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
-   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
-   ret = (76.08 * (m_og_fermentable - m_fg_fermentable) / (1.775 - m_og_fermentable)) * (m_fg_fermentable / 0.794);
+   double const ret = RecipeCalcs::ABV_pct(m_og_fermentable, m_fg_fermentable);
 
    if (! qFuzzyCompare(ret, m_ABV_pct)) {
       m_ABV_pct = ret;
@@ -2123,19 +2520,9 @@ void Recipe::recalcABV_pct() {
 }
 
 void Recipe::recalcColor_srm() {
-   Fermentable * ferm;
-   double mcu = 0.0;
-   double ret;
-   int i;
+   BT_TIME_SCOPE("Recipe::recalcColor_srm");
 
-   QList<Fermentable *> ferms = fermentables();
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-      ferm = ferms[i];
-         // Conversion factor for lb/gal to kg/l = 8.34538.
-      mcu += ferm->color_srm() * 8.34538 * ferm->amount_kg() / m_finalVolumeNoLosses_l;
-   }
-
-   ret = ColorMethods::mcuToSrm(mcu);
+   double const ret = RecipeCalcs::color_srm(*this->pimpl->snapshot(), m_finalVolumeNoLosses_l);
 
    if (! qFuzzyCompare(m_color_srm, ret)) {
       m_color_srm = ret;
@@ -2148,27 +2535,11 @@ void Recipe::recalcColor_srm() {
 }
 
 void Recipe::recalcIBU() {
-   int i;
-   double ibus = 0.0;
-   double tmp = 0.0;
-
-   // Bitterness due to hops...
-   m_ibus.clear();
-   QList<Hop *> hhops = hops();
-   for (i = 0; i < hhops.size(); ++i) {
-      tmp = ibuFromHop(hhops[i]);
-      m_ibus.append(tmp);
-      ibus += tmp;
-   }
+   BT_TIME_SCOPE("Recipe::recalcIBU");
 
-   // Bitterness due to hopped extracts...
-   QList<Fermentable *> ferms = fermentables();
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-         // Conversion factor for lb/gal to kg/l = 8.34538.
-      ibus +=
-         ferms[i]->ibuGalPerLb() *
-         (ferms[i]->amount_kg() / batchSize_l()) / 8.34538;
-   }
+   QVector<double> hopIbus;
+   double const ibus = RecipeCalcs::IBU(*this->pimpl->snapshot(), m_og, m_finalVolumeNoLosses_l, &hopIbus);
+   m_ibus = hopIbus.toList();
 
    if (! qFuzzyCompare(ibus, m_IBU)) {
       m_IBU = ibus;
@@ -2181,75 +2552,18 @@ void Recipe::recalcIBU() {
 }
 
 void Recipe::recalcVolumeEstimates() {
-   double waterAdded_l;
-   double absorption_lKg;
-   double tmp = 0.0;
-   double tmp_wfm = 0.0;
-   double tmp_bv = 0.0;
-   double tmp_fv = 0.0;
-   double tmp_pbv = 0.0;
-
-   // wortFromMash_l ==========================
-   if (mash() == nullptr) {
-      m_wortFromMash_l = 0.0;
-   } else {
-      waterAdded_l = mash()->totalMashWater_l();
-      if (equipment() != nullptr) {
-         absorption_lKg = equipment()->grainAbsorption_LKg();
-      } else {
-         absorption_lKg = PhysicalConstants::grainAbsorption_Lkg;
-      }
-
-      tmp_wfm = (waterAdded_l - absorption_lKg * m_grainsInMash_kg);
-   }
-
-   // boilVolume_l ==============================
-
-   if (equipment() != nullptr) {
-      tmp = tmp_wfm - equipment()->lauterDeadspace_l() + equipment()->topUpKettle_l();
-   } else {
-      tmp = tmp_wfm;
-   }
-
-   // Need to account for extract/sugar volume also.
-   QList<Fermentable *> ferms = fermentables();
-   foreach (Fermentable * f, ferms) {
-      Fermentable::Type type = f->type();
-      if (type == Fermentable::Type::Extract) {
-         tmp += f->amount_kg() / PhysicalConstants::liquidExtractDensity_kgL;
-      } else if (type == Fermentable::Type::Sugar) {
-         tmp += f->amount_kg() / PhysicalConstants::sucroseDensity_kgL;
-      } else if (type == Fermentable::Type::Dry_Extract) {
-         tmp += f->amount_kg() / PhysicalConstants::dryExtractDensity_kgL;
-      }
-   }
-
-   if (tmp <= 0.0) {
-      tmp = boilSize_l();   // Give up.
-   }
-
-   tmp_bv = tmp;
-
-   // finalVolume_l ==============================
+   BT_TIME_SCOPE("Recipe::recalcVolumeEstimates");
 
-   // NOTE: the following figure is not based on the other volume estimates
-   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
-   m_finalVolumeNoLosses_l = batchSizeNoLosses_l();
-   if (equipment() != nullptr) {
-      //_finalVolumeNoLosses_l = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l();
-      tmp_fv = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l() - equipment()->trubChillerLoss_l();
-   } else {
-      m_finalVolume_l = tmp_bv - 4.0; // This is just shooting in the dark. Can't do much without an equipment.
-      //_finalVolumeNoLosses_l = _finalVolume_l;
-   }
-
-   // postBoilVolume_l ===========================
+   RecipeCalcs::VolumeEstimates const volumes =
+      RecipeCalcs::volumeEstimates(*this->pimpl->snapshot(), m_grainsInMash_kg);
+   double const tmp_wfm = volumes.wortFromMash_l;
+   double const tmp_bv  = volumes.boilVolume_l;
+   double const tmp_fv  = volumes.finalVolume_l;
+   double const tmp_pbv = volumes.postBoilVolume_l;
 
-   if (equipment() != nullptr) {
-      tmp_pbv = equipment()->wortEndOfBoil_l(tmp_bv);
-   } else {
-      tmp_pbv = batchSize_l(); // Give up.
-   }
+   // NOTE: the final volume without losses is not based on the other volume estimates since we want to show og, fg,
+   // ibus, etc as if the collected wort is correct.
+   m_finalVolumeNoLosses_l = volumes.finalVolumeNoLosses_l;
 
    if (! qFuzzyCompare(tmp_wfm, m_wortFromMash_l)) {
       m_wortFromMash_l = tmp_wfm;
@@ -2282,19 +2596,9 @@ void Recipe::recalcVolumeEstimates() {
 }
 
 void Recipe::recalcGrainsInMash_kg() {
-   int i, size;
-   double ret = 0.0;
-   Fermentable * ferm;
-
-   QList<Fermentable *> ferms = fermentables();
-   size = ferms.size();
-   for (i = 0; i < size; ++i) {
-      ferm = ferms[i];
+   BT_TIME_SCOPE("Recipe::recalcGrainsInMash_kg");
 
-      if (ferm->type() == Fermentable::Type::Grain && ferm->isMashed()) {
-         ret += ferm->amount_kg();
-      }
-   }
+   double const ret = RecipeCalcs::grainsInMash_kg(*this->pimpl->snapshot());
 
    if (! qFuzzyCompare(ret, m_grainsInMash_kg)) {
       m_grainsInMash_kg = ret;
@@ -2306,14 +2610,9 @@ void Recipe::recalcGrainsInMash_kg() {
 }
 
 void Recipe::recalcGrains_kg() {
-   int i, size;
-   double ret = 0.0;
+   BT_TIME_SCOPE("Recipe::recalcGrains_kg");
 
-   QList<Fermentable *> ferms = fermentables();
-   size = ferms.size();
-   for (i = 0; i < size; ++i) {
-      ret += ferms[i]->amount_kg();
-   }
+   double const ret = RecipeCalcs::grains_kg(*this->pimpl->snapshot());
 
    if (! qFuzzyCompare(ret, m_grains_kg)) {
       m_grains_kg = ret;
@@ -2324,6 +2623,8 @@ void Recipe::recalcGrains_kg() {
 }
 
 void Recipe::recalcSRMColor() {
+   BT_TIME_SCOPE("Recipe::recalcSRMColor");
+
    QColor tmp = Algorithms::srmToColor(m_color_srm);
 
    if (tmp != m_SRMColor) {
@@ -2336,32 +2637,9 @@ void Recipe::recalcSRMColor() {
 
 // the formula in here are taken from http://hbd.org/ensmingr/
 void Recipe::recalcCalories() {
-   double startPlato, finishPlato, RE, abw, oog, ffg, tmp;
-
-   oog = m_og;
-   ffg = m_fg;
-
-   // Need to translate OG and FG into plato
-   startPlato  = -463.37 + (668.72 * oog) - (205.35 * oog * oog);
-   finishPlato = -463.37 + (668.72 * ffg) - (205.35 * ffg * ffg);
+   BT_TIME_SCOPE("Recipe::recalcCalories");
 
-   // RE (real extract)
-   RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
-
-   // Alcohol by weight?
-   abw = (startPlato - RE) / (2.0665 - (0.010665 * startPlato));
-
-   // The final results of this formular are calories per 100 ml.
-   // The 3.55 puts it in terms of 12 oz. I really should have stored it
-   // without that adjust.
-   tmp = ((6.9 * abw) + 4.0 * (RE - 0.1)) * ffg * 3.55;
-
-   //! If there are no fermentables in the recipe, if there is no mash, etc.,
-   //  then the calories/12 oz ends up negative. Since negative doesn't make
-   //  sense, set it to 0
-   if (tmp < 0) {
-      tmp = 0;
-   }
+   double const tmp = RecipeCalcs::calories(m_og, m_fg);
 
    if (! qFuzzyCompare(tmp, m_calories)) {
       m_calories = tmp;
@@ -2374,72 +2652,25 @@ void Recipe::recalcCalories() {
 // other efficiency calculations need access to the maximum theoretical sugars
 // available. The only way I can see of doing that which doesn't suck is to
 // split that calcuation out of recalcOgFg();
-QHash<QString, double> Recipe::calcTotalPoints() {
-   int i;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double sugar_kg                  = 0.0;
-   double nonFermentableSugars_kg    = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-
-   Fermentable * ferm;
-
-   QList<Fermentable *> ferms = fermentables();
-   QHash<QString, double> ret;
-
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-      ferm = ferms[i];
-
-      // If we have some sort of non-grain, we have to ignore efficiency.
-      if (ferm->isSugar() || ferm->isExtract()) {
-         sugar_kg_ignoreEfficiency += ferm->equivSucrose_kg();
+RecipeCalcs::TotalPoints Recipe::calcTotalPoints() {
+   BT_TIME_SCOPE("Recipe::calcTotalPoints");
 
-         if (ferm->addAfterBoil()) {
-            lateAddition_kg_ignoreEff += ferm->equivSucrose_kg();
-         }
-
-         if (!isFermentableSugar(ferm)) {
-            nonFermentableSugars_kg += ferm->equivSucrose_kg();
-         }
-      } else {
-         sugar_kg += ferm->equivSucrose_kg();
-
-         if (ferm->addAfterBoil()) {
-            lateAddition_kg += ferm->equivSucrose_kg();
-         }
-      }
+   ++this->pimpl->totalPointsRequests;
+   if (!this->pimpl->totalPoints) {
+      this->pimpl->totalPoints = RecipeCalcs::totalPoints(*this->pimpl->snapshot());
+      ++this->pimpl->totalPointsCalculations;
+      qCDebug(Logging::recipe) <<
+         Q_FUNC_INFO << "Recalculated total points for Recipe #" << this->key() << "; cache hit rate" <<
+         (this->pimpl->totalPointsRequests - this->pimpl->totalPointsCalculations) << "/" <<
+         this->pimpl->totalPointsRequests;
    }
-
-   ret.insert("sugar_kg", sugar_kg);
-   ret.insert("nonFermentableSugars_kg", nonFermentableSugars_kg);
-   ret.insert("sugar_kg_ignoreEfficiency", sugar_kg_ignoreEfficiency);
-   ret.insert("lateAddition_kg", lateAddition_kg);
-   ret.insert("lateAddition_kg_ignoreEff", lateAddition_kg_ignoreEff);
-
-   return ret;
-
+   return *this->pimpl->totalPoints;
 }
 
 void Recipe::recalcBoilGrav() {
-   double sugar_kg = 0.0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-   double ret;
-   QHash<QString, double> sugars;
-
-   sugars = calcTotalPoints();
-   sugar_kg = sugars.value("sugar_kg");
-   sugar_kg_ignoreEfficiency = sugars.value("sugar_kg_ignoreEfficiency");
-   lateAddition_kg = sugars.value("lateAddition_kg");
-   lateAddition_kg_ignoreEff = sugars.value("lateAddition_kg_ignoreEff");
-
-   // Since the efficiency refers to how much sugar we get into the fermenter,
-   // we need to adjust for that here.
-   sugar_kg = (efficiency_pct() / 100.0 * (sugar_kg - lateAddition_kg) + sugar_kg_ignoreEfficiency -
-               lateAddition_kg_ignoreEff);
-
-   ret = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(sugar_kg, boilSize_l()));
+   BT_TIME_SCOPE("Recipe::recalcBoilGrav");
+
+   double const ret = RecipeCalcs::boilGrav(*this->pimpl->snapshot(), this->calcTotalPoints());
 
    if (! qFuzzyCompare(ret, m_boilGrav)) {
       m_boilGrav = ret;
@@ -2450,20 +2681,7 @@ void Recipe::recalcBoilGrav() {
 }
 
 void Recipe::recalcOgFg() {
-   int i;
-   double plato;
-   double sugar_kg = 0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double nonFermentableSugars_kg = 0.0;
-   double kettleWort_l = 0.0;
-   double postBoilWort_l = 0.0;
-   double ratio = 0.0;
-   double ferm_kg = 0.0;
-   double attenuation_pct = 0.0;
-   double tmp_og, tmp_fg, tmp_pnts, tmp_ferm_pnts, tmp_nonferm_pnts;
-   Yeast * yeast;
-
-   m_og_fermentable = m_fg_fermentable = 0.0;
+   BT_TIME_SCOPE("Recipe::recalcOgFg");
 
    // The first time through really has to get the _og and _fg from the
    // database, not use the initialized values of 1. I (maf) tried putting
@@ -2473,82 +2691,17 @@ void Recipe::recalcOgFg() {
    // GSG: This doesn't work, this og and fg are already set to 1.0 so
    // until we load these values from the database on startup, we have
    // to calculate.
-   if (m_uninitializedCalcs) {
-      m_og = Localization::toDouble(*this, PropertyNames::Recipe::og, Q_FUNC_INFO);
-      m_fg = Localization::toDouble(*this, PropertyNames::Recipe::fg, Q_FUNC_INFO);
-   }
-
-   // Find out how much sugar we have.
-   QHash<QString, double> sugars = calcTotalPoints();
-   sugar_kg                  = sugars.value("sugar_kg");  // Mass of sugar that *is* affected by mash efficiency
-   sugar_kg_ignoreEfficiency =
-      sugars.value("sugar_kg_ignoreEfficiency");  // Mass of sugar that *is not* affected by mash efficiency
-   nonFermentableSugars_kg    =
-      sugars.value("nonFermentableSugars_kg");  // Mass of sugar that is not fermentable (also counted in sugar_kg_ignoreEfficiency)
-
-   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
-   if (equipment() != nullptr) {
-
-      kettleWort_l = (m_wortFromMash_l - equipment()->lauterDeadspace_l()) + equipment()->topUpKettle_l();
-      postBoilWort_l = equipment()->wortEndOfBoil_l(kettleWort_l);
-      ratio = (postBoilWort_l - equipment()->trubChillerLoss_l()) / postBoilWort_l;
-      if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
-         ratio = 1.0;
-      } else if (ratio < 0.0) {
-         ratio = 0.0;
-      } else if (Algorithms::isNan(ratio)) {
-         ratio = 1.0;
-      }
-      // Ignore this again since it should be included in efficiency.
-      //sugar_kg *= ratio;
-      sugar_kg_ignoreEfficiency *= ratio;
-      if (nonFermentableSugars_kg != 0.0) {
-         nonFermentableSugars_kg *= ratio;
-      }
-   }
-
-   // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
-   sugar_kg = sugar_kg * efficiency_pct() / 100.0 + sugar_kg_ignoreEfficiency;
-   plato = Algorithms::getPlato(sugar_kg, m_finalVolumeNoLosses_l);
-
-   tmp_og = Algorithms::PlatoToSG_20C20C(plato);    // og from all sugars
-   tmp_pnts = (tmp_og - 1) * 1000.0; // points from all sugars
-   if (nonFermentableSugars_kg != 0.0) {
-      ferm_kg = sugar_kg - nonFermentableSugars_kg;  // Mass of only fermentable sugars
-      plato = Algorithms::getPlato(ferm_kg, m_finalVolumeNoLosses_l);   // Plato from fermentable sugars
-      m_og_fermentable = Algorithms::PlatoToSG_20C20C(plato);    // og from only fermentable sugars
-      plato = Algorithms::getPlato(nonFermentableSugars_kg, m_finalVolumeNoLosses_l);   // Plate from non-fermentable sugars
-      tmp_nonferm_pnts = ((Algorithms::PlatoToSG_20C20C(plato)) - 1) * 1000.0; // og points from non-fermentable sugars
-   } else {
-      m_og_fermentable = tmp_og;
-      tmp_nonferm_pnts = 0;
-   }
-
-   // Calculage FG
-   QList<Yeast *> yeasties = yeasts();
-   for (i = 0; static_cast<int>(i) < yeasties.size(); ++i) {
-      yeast = yeasties[i];
-      // Get the yeast with the greatest attenuation.
-      if (yeast->attenuation_pct() > attenuation_pct) {
-         attenuation_pct = yeast->attenuation_pct();
-      }
-   }
-   // This means we have yeast, but they neglected to provide attenuation percentages.
-   if (yeasties.size() > 0 && attenuation_pct <= 0.0)  {
-      attenuation_pct = 75.0; // 75% is an average attenuation.
-   }
+   //
+   // (We used to read m_og and m_fg back here through the Qt property system, converting them to strings and back to
+   // doubles in the process.  But the og and fg properties are just the stored values of m_og and m_fg -- see
+   // NamedEntity::storedValue -- so this was a rather expensive no-op.)
 
-   if (nonFermentableSugars_kg != 0.0) {
-      tmp_ferm_pnts = (tmp_pnts - tmp_nonferm_pnts) * (1.0 - attenuation_pct / 100.0); // fg points from fermentable sugars
-      tmp_pnts = tmp_ferm_pnts + tmp_nonferm_pnts;  // FG points from both fermentable and non-fermentable sugars
-      //tmp_pnts *= (1.0 - attenuation_pct/100.0);  // WTF, this completely ignores all the calculations about non-fermentable sugars and just converts everything!
-      tmp_fg =  1 + tmp_pnts / 1000.0; // new FG value
-      m_fg_fermentable =  1 + tmp_ferm_pnts / 1000.0; // FG from fermentables only
-   } else {
-      tmp_pnts *= (1.0 - attenuation_pct / 100.0);
-      tmp_fg =  1 + tmp_pnts / 1000.0;
-      m_fg_fermentable = tmp_fg;
-   }
+   RecipeCalcs::Gravities const gravities =
+      RecipeCalcs::gravities(*this->pimpl->snapshot(), this->calcTotalPoints(), m_wortFromMash_l, m_finalVolumeNoLosses_l);
+   double const tmp_og = gravities.og;
+   double const tmp_fg = gravities.fg;
+   m_og_fermentable = gravities.og_fermentable;
+   m_fg_fermentable = gravities.fg_fermentable;
 
    if (! qFuzzyCompare(m_og, tmp_og)) {
       m_og     = tmp_og;
@@ -2576,73 +2729,92 @@ void Recipe::recalcOgFg() {
    }
 }
 
-//====================================Helpers===========================================
-
-double Recipe::ibuFromHop(Hop const * hop) {
-   Equipment * equip = equipment();
-   double ibus = 0.0;
-   double fwhAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
-      Q_FUNC_INFO
-   );
-   double mashHopAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
-      Q_FUNC_INFO
-   );
+bool Recipe::applyCalcResults(RecipeCalcs::Results const & results) {
+   BT_TIME_SCOPE("Recipe::applyCalcResults");
 
-   if (hop == nullptr) {
-      return 0.0;
+   // Same protection against recursion as in recalcAll
+   if (! m_recalcMutex.tryLock()) {
+      return false;
    }
 
-   double AArating = hop->alpha_pct() / 100.0;
-   double grams = hop->amount_kg() * 1000.0;
-   double minutes = hop->time_min();
-   // Assume 100% utilization until further notice
-   double hopUtilization = 1.0;
-   // Assume 60 min boil until further notice
-   int boilTime = 60;
+   bool anyChanged = false;
+   auto update = [this, &anyChanged](double & member, double const value, BtStringConst const & propertyName) {
+      if (! qFuzzyCompare(member, value)) {
+         member = value;
+         anyChanged = true;
+         if (!m_uninitializedCalcs) {
+            emit changed(metaProperty(*propertyName), member);
+         }
+      }
+      return;
+   };
 
-   // NOTE: we used to carefully calculate the average boil gravity and use it in the
-   // IBU calculations. However, due to John Palmer
-   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
-   // it seems more appropriate to just use the OG directly, since it is the total
-   // amount of break material that truly affects the IBUs.
+   // The results have the same total points as we would have calculated, so we might as well cache them
+   this->pimpl->totalPoints = results.totalPoints;
 
-   if (equip) {
-      hopUtilization = equip->hopUtilization_pct() / 100.0;
-      boilTime = static_cast<int>(equip->boilTime_min());
-   }
+   // Same order as recalcAll
+   update(m_grainsInMash_kg, results.grainsInMash_kg, PropertyNames::Recipe::grainsInMash_kg);
+   update(m_grains_kg,       results.grains_kg,       PropertyNames::Recipe::grains_kg);
 
-   if (hop->use() == Hop::Use::Boil) {
-      ibus = IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, minutes);
-   } else if (hop->use() == Hop::Use::First_Wort) {
-      ibus = fwhAdjust * IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, boilTime);
-   } else if (hop->use() == Hop::Use::Mash && mashHopAdjust > 0.0) {
-      ibus = mashHopAdjust * IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, boilTime);
+   m_finalVolumeNoLosses_l = results.volumes.finalVolumeNoLosses_l;
+   update(m_wortFromMash_l,   results.volumes.wortFromMash_l,   PropertyNames::Recipe::wortFromMash_l);
+   update(m_boilVolume_l,     results.volumes.boilVolume_l,     PropertyNames::Recipe::boilVolume_l);
+   update(m_finalVolume_l,    results.volumes.finalVolume_l,    PropertyNames::Recipe::finalVolume_l);
+   update(m_postBoilVolume_l, results.volumes.postBoilVolume_l, PropertyNames::Recipe::postBoilVolume_l);
+
+   update(m_color_srm, results.color_srm, PropertyNames::Recipe::color_srm);
+   QColor const srmColor = Algorithms::srmToColor(m_color_srm);
+   if (srmColor != m_SRMColor) {
+      m_SRMColor = srmColor;
+      anyChanged = true;
+      if (!m_uninitializedCalcs) {
+         emit changed(metaProperty(*PropertyNames::Recipe::SRMColor), m_SRMColor);
+      }
    }
 
-   // Adjust for hop form. Tinseth's table was created from whole cone data,
-   // and it seems other formulae are optimized that way as well. So, the
-   // utilization is considered unadjusted for whole cones, and adjusted
-   // up for plugs and pellets.
-   //
-   // - http://www.realbeer.com/hops/FAQ.html
-   // - https://groups.google.com/forum/#!topic"brewtarget.h"lp/mv2qvWBC4sU
-   switch (hop->form()) {
-      case Hop::Form::Plug:
-         hopUtilization *= 1.02;
-         break;
-      case Hop::Form::Pellet:
-         hopUtilization *= 1.10;
-         break;
-      default:
-         break;
+   // OG and FG are stored, so, unlike in recalcOgFg, we write them whether or not we were initialised
+   m_og_fermentable = results.gravities.og_fermentable;
+   m_fg_fermentable = results.gravities.fg_fermentable;
+   if (! qFuzzyCompare(m_og, results.gravities.og)) {
+      m_og = results.gravities.og;
+      anyChanged = true;
+      this->propagatePropertyChange(PropertyNames::Recipe::og, false);
+      if (!m_uninitializedCalcs) {
+         emit changed(metaProperty(*PropertyNames::Recipe::og), m_og);
+         emit changed(metaProperty(*PropertyNames::Recipe::points), (m_og - 1.0) * 1e3);
+      }
    }
+   if (! qFuzzyCompare(m_fg, results.gravities.fg)) {
+      m_fg = results.gravities.fg;
+      anyChanged = true;
+      this->propagatePropertyChange(PropertyNames::Recipe::fg, false);
+      if (!m_uninitializedCalcs) {
+         emit changed(metaProperty(*PropertyNames::Recipe::fg), m_fg);
+      }
+   }
+
+   update(m_ABV_pct,  results.ABV_pct,  PropertyNames::Recipe::ABV_pct);
+   update(m_boilGrav, results.boilGrav, PropertyNames::Recipe::boilGrav);
+
+   m_ibus = results.hopIbus.toList();
+   update(m_IBU,      results.IBU,      PropertyNames::Recipe::IBU);
+   update(m_calories, results.calories, PropertyNames::Recipe::calories);
 
-   // Adjust for hop utilization.
-   ibus *= hopUtilization;
+   m_uninitializedCalcs = false;
+
+   m_recalcMutex.unlock();
+   return anyChanged;
+}
+
+//====================================Helpers===========================================
+
+double Recipe::ibuFromHop(Hop const * hop) {
+   if (hop == nullptr) {
+      return 0.0;
+   }
 
-   return ibus;
+   RecipeSnapshot::Hop const hopSnapshot{hop->use(), hop->form(), hop->alpha_pct(), hop->amount_kg(), hop->time_min()};
+   return RecipeCalcs::ibuFromHop(*this->pimpl->snapshot(), hopSnapshot, m_og, m_finalVolumeNoLosses_l);
 }
 
 // this was fixed, but not with an at
@@ -2750,16 +2922,16 @@ QStringList Recipe::getReagents(QList<Salt *> salts, Salt::WhenToAdd wanted) {
    }
    return reagents;
 }
-
 //==========================Accept changes from ingredients====================
 
 void Recipe::acceptChangeToContainedObject([[maybe_unused]] QMetaProperty prop,
                                            [[maybe_unused]] QVariant val) {
    // This tells us which object sent us the signal
    QObject * signalSender = this->sender();
+   ++this->pimpl->generation;
    if (signalSender != nullptr) {
       QString signalSenderClassName = signalSender->metaObject()->className();
-      qDebug() << Q_FUNC_INFO << "Signal received from " << signalSenderClassName;
+      qCDebug(Logging::recipe) << Q_FUNC_INFO << "Signal received from " << signalSenderClassName;
       this->recalcIfNeeded(signalSenderClassName);
    } else {
       qDebug() << Q_FUNC_INFO << "No sender";
@@ -2808,6 +2980,39 @@ Recipe * Recipe::getOwningRecipe() {
    return this;
 }
 
+void Recipe::unshareWithPreviousVersions(NamedEntity const & ne) {
+   // Most Recipes don't have previous versions, in which case there's nothing to share
+   if (!this->hasAncestors()) {
+      return;
+   }
+
+   // MashSteps belong to a Mash, so it's the Mash that's shared
+   MashStep const * mashStep = qobject_cast<MashStep const *>(&ne);
+   if (mashStep) {
+      Mash const * mash = ObjectStoreWrapper::getByIdRaw<Mash>(mashStep->getMashId());
+      if (mash) {
+         this->pimpl->unshareIfNeeded<Mash>(*mash);
+      }
+      return;
+   }
+
+   bool const isSharable = this->pimpl->unshareIfNeeded<Equipment>  (ne) ||
+                           this->pimpl->unshareIfNeeded<Fermentable>(ne) ||
+                           this->pimpl->unshareIfNeeded<Hop>        (ne) ||
+                           this->pimpl->unshareIfNeeded<Instruction>(ne) ||
+                           this->pimpl->unshareIfNeeded<Mash>       (ne) ||
+                           this->pimpl->unshareIfNeeded<Misc>       (ne) ||
+                           this->pimpl->unshareIfNeeded<Salt>       (ne) ||
+                           this->pimpl->unshareIfNeeded<Style>      (ne) ||
+                           this->pimpl->unshareIfNeeded<Water>      (ne) ||
+                           this->pimpl->unshareIfNeeded<Yeast>      (ne);
+   if (!isSharable) {
+      // Eg a BrewNote, which is only ever used by one Recipe
+      qDebug() << Q_FUNC_INFO << ne.metaObject()->className() << "#" << ne.key() << "is never shared";
+   }
+   return;
+}
+
 void Recipe::hardDeleteOwnedEntities() {
    // It's the BrewNote that stores its Recipe ID, so all we need to do is delete our BrewNotes then the subsequent
    // database delete of this Recipe won't hit any foreign key problems.
@@ -2860,6 +3065,164 @@ void Recipe::hardDeleteOrphanedEntities() {
    return;
 }
 
+//=================================Edit sessions================================
+
+// This private implementation class holds all private non-virtual members of Recipe::EditSession
+class Recipe::EditSession::impl {
+public:
+   impl(EditSession & self, Recipe & recipe) :
+      self{self},
+      recipe{&recipe},
+      active{false},
+      covered{},
+      changes{},
+      changeIndex{} {
+      if (recipe.pimpl->editSession) {
+         // There's already a session on this Recipe, so it will take care of everything
+         qDebug() << Q_FUNC_INFO << "Recipe #" << recipe.key() << "already has an edit session";
+         return;
+      }
+      recipe.pimpl->editSession = &self;
+      recipe.pimpl->recalcDeferred = false;
+      this->active = true;
+
+      this->cover(&recipe);
+      this->cover(recipe.equipment());
+      this->cover(recipe.style());
+      Mash * mash = recipe.mash();
+      if (mash) {
+         this->cover(mash);
+         for (auto step : mash->mashSteps()) {
+            this->cover(step.get());
+         }
+      }
+      this->coverAll(recipe.fermentables());
+      this->coverAll(recipe.hops());
+      this->coverAll(recipe.instructions());
+      this->coverAll(recipe.miscs());
+      this->coverAll(recipe.salts());
+      this->coverAll(recipe.waters());
+      this->coverAll(recipe.yeasts());
+      qDebug() << Q_FUNC_INFO << "Started edit session on Recipe #" << recipe.key() << "covering" << this->covered.size();
+      return;
+   }
+
+   ~impl() = default;
+
+   void cover(NamedEntity * namedEntity) {
+      if (namedEntity) {
+         namedEntity->setChangeCollector(&this->self);
+         this->covered.append(QPointer<NamedEntity>{namedEntity});
+      }
+      return;
+   }
+
+   template<class NE> void coverAll(QList<NE *> const & namedEntities) {
+      for (auto namedEntity : namedEntities) {
+         this->cover(namedEntity);
+      }
+      return;
+   }
+
+   void uncoverAll() {
+      for (auto const & namedEntity : this->covered) {
+         // Anything that got deleted during the session will be null
+         if (namedEntity) {
+            namedEntity->setChangeCollector(nullptr);
+         }
+      }
+      this->covered.clear();
+      return;
+   }
+
+   //! \brief A property change we have collected and not yet written
+   struct Change {
+      QPointer<NamedEntity const> namedEntity;
+      BtStringConst const * propertyName;
+      bool notify;
+   };
+
+   EditSession & self;
+   QPointer<Recipe> recipe;
+   //! \c false if we are nested inside another session on the same Recipe or have already been committed
+   bool active;
+   QVector<QPointer<NamedEntity>> covered;
+   //! In the order they were first made, so that the database and listeners see them in a sensible order
+   QVector<Change> changes;
+   //! Position in \c changes of each object and property name, so that we only write each property once
+   QHash<QPair<NamedEntity const *, QString>, int> changeIndex;
+};
+
+Recipe::EditSession::EditSession(Recipe & recipe) : pimpl{std::make_unique<impl>(*this, recipe)} {
+   return;
+}
+
+Recipe::EditSession::~EditSession() {
+   this->commit();
+   return;
+}
+
+void Recipe::EditSession::collectChange(NamedEntity const & namedEntity,
+                                        BtStringConst const & propertyName,
+                                        bool notify) {
+   auto const indexKey = qMakePair(&namedEntity, QString{*propertyName});
+   auto const existing = this->pimpl->changeIndex.constFind(indexKey);
+   if (existing != this->pimpl->changeIndex.cend()) {
+      // We only write the final value, but we do need to signal if any of the changes asked for it
+      this->pimpl->changes[*existing].notify |= notify;
+      return;
+   }
+   this->pimpl->changeIndex.insert(indexKey, this->pimpl->changes.size());
+   this->pimpl->changes.append(impl::Change{QPointer<NamedEntity const>{&namedEntity}, &propertyName, notify});
+   return;
+}
+
+void Recipe::EditSession::commit() {
+   if (!this->pimpl->active) {
+      return;
+   }
+   BT_TIME_SCOPE("Recipe::EditSession::commit");
+   this->pimpl->active = false;
+   this->pimpl->uncoverAll();
+
+   qDebug() << Q_FUNC_INFO << "Committing" << this->pimpl->changes.size() << "property changes";
+
+   // Everything we write, including whatever the recalculation at the end writes, goes in one transaction.  (The
+   // transactions in ObjectStore just become part of this one -- see DbTransaction.)
+   Database & database = Database::instance();
+   QSqlDatabase connection = database.sqlDatabase();
+   DbTransaction dbTransaction{database, connection};
+
+   for (auto const & change : this->pimpl->changes) {
+      if (change.namedEntity) {
+         writeChange(*change.namedEntity, *change.propertyName);
+      }
+   }
+
+   //
+   // Now everything is in the DB, tell everyone about it.  The Recipe is still marked as being in a session whilst we
+   // do this, so the changes we signal to it just get noted for the recalculation below.
+   //
+   for (auto const & change : this->pimpl->changes) {
+      if (change.namedEntity && change.notify) {
+         signalChange(*change.namedEntity, *change.propertyName);
+      }
+   }
+   this->pimpl->changes.clear();
+   this->pimpl->changeIndex.clear();
+
+   if (this->pimpl->recipe) {
+      Recipe & recipe = *this->pimpl->recipe;
+      recipe.pimpl->editSession = nullptr;
+      if (recipe.pimpl->recalcDeferred) {
+         recipe.pimpl->recalcDeferred = false;
+         recipe.recalcAll();
+      }
+   }
+
+   dbTransaction.commit();
+   return;
+}
 
 //======================================================================================================================
 //====================================== Start of Functions in Helper Namespace ========================================
@@ -2873,76 +3236,139 @@ QList<BrewNote *> RecipeHelper::brewNotesForRecipeAndAncestors(Recipe const & re
    return brewNotes;
 }
 
-void RecipeHelper::prepareForPropertyChange(NamedEntity & ne, BtStringConst const & propertyName) {
+template<class NE> Recipe * RecipeHelper::findOwningRecipe(NE const & ne) {
+   Recipe * owner = ObjectStoreWrapper::findFirstMatching<Recipe>(
+      [&ne](Recipe * rec) {
+         return rec->uses(ne);
+      }
+   );
 
    //
-   // If the user has said they don't want versioning, just return
+   // Only versions of the same Recipe share things, and previous versions are always locked.  So, if we found an
+   // unlocked Recipe, it's the owner.  Otherwise, we might have found a previous version, in which case the owner is
+   // the latest later version that also uses ne.  (Usually there's no such thing, so this costs one more search.)
    //
-   if (!RecipeHelper::getAutomaticVersioningEnabled()) {
-      return;
+   while (owner && (owner->locked() || owner->hasDescendants())) {
+      Recipe const * const previous = owner;
+      Recipe * later = ObjectStoreWrapper::findFirstMatching<Recipe>(
+         [&ne, previous](Recipe * rec) {
+            return rec != previous && rec->uses(ne) && rec->isMyAncestor(*previous);
+         }
+      );
+      if (!later) {
+         break;
+      }
+      owner = later;
    }
+   return owner;
+}
+template Recipe * RecipeHelper::findOwningRecipe(Equipment   const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Fermentable const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Hop         const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Instruction const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Mash        const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Misc        const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Salt        const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Style       const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Water       const & ne);
+template Recipe * RecipeHelper::findOwningRecipe(Yeast       const & ne);
 
-   qDebug() <<
-      Q_FUNC_INFO << "Modifying: " << ne.metaObject()->className() << "#" << ne.key() << "property" << propertyName;
+namespace {
+   /**
+    * \brief Automatic versioning means that, once a recipe is brewed, it is "soft locked" and the first change should
+    *        spawn a new version.  Any subsequent change should not spawn a new version until it is brewed again.
+    */
+   void createNewVersionIfNeeded(Recipe & owner) {
+      if (owner.isBeingModified()) {
+         // Recipe is already being modified
+         return;
+      }
 
-   //
-   // If the object we're about to change a property on is a Recipe or is used in a Recipe, then it might need a new
-   // version -- unless it's already being versioned.
-   //
-   Recipe * owner = ne.getOwningRecipe();
-   if (!owner || owner->isBeingModified()) {
-      // Change is not related to a recipe or the recipe is already being modified
-      return;
-   }
+      if (owner.brewNotes().empty()) {
+         // Recipe hasn't been brewed
+         return;
+      }
 
-   //
-   // Automatic versioning means that, once a recipe is brewed, it is "soft locked" and the first change should spawn a
-   // new version.  Any subsequent change should not spawn a new version until it is brewed again.
-   //
-   if (owner->brewNotes().empty()) {
-      // Recipe hasn't been brewed
-      return;
-   }
+      // If the object we're about to change already has descendants, then we don't want to create new ones.
+      if (owner.hasDescendants()) {
+         qDebug() << Q_FUNC_INFO << "Recipe #" << owner.key() << "already has descendants, so not creating any more";
+         return;
+      }
+
+      //
+      // Once we've started doing versioning, we don't want to trigger it again on the same Recipe until we've finished
+      //
+      NamedEntityModifyingMarker ownerModifyingMarker(owner);
+
+      //
+      // Versioning when modifying something in a recipe is *hard*.  If we copy the recipe, there is no easy way to say
+      // "this ingredient in the old recipe is that ingredient in the new".  So we make the copy the "prior version" and
+      // keep modifying the Recipe the user is working on.
+      //
+      // Taking a deep copy of the Recipe would mean writing new rows for every Hop, Fermentable, MashStep etc, almost
+      // all of which would never change.  Instead, the copy shares them with the Recipe, and the one that is about to
+      // change gets copied (for the prior version) in Recipe::unshareWithPreviousVersions().  We still need to put the
+      // copy in the DB, so it has an ID.  (This will also emit signalObjectInserted for the new Recipe from
+      // ObjectStoreTyped<Recipe>.)
+      //
+      qDebug() << Q_FUNC_INFO << "Copying Recipe" << owner.key();
+
+      // We also don't want to trigger versioning on the newly spawned Recipe until we're completely done here!
+      std::shared_ptr<Recipe> spawn = std::make_shared<Recipe>(owner, Recipe::CopyMode::SharedIngredients);
+      NamedEntityModifyingMarker spawnModifyingMarker(*spawn);
+      ObjectStoreWrapper::insert(spawn);
+
+      qDebug() << Q_FUNC_INFO << "Copied Recipe #" << owner.key() << "to new Recipe #" << spawn->key();
+
+      // We assert that the newly created version of the recipe has not yet been brewed (and therefore will not get
+      // automatically versioned on subsequent changes before it is brewed).
+      Q_ASSERT(spawn->brewNotes().empty());
+
+      //
+      // By default, copying a Recipe does not copy all its ancestry.  Here, we want the copy to become our ancestor (ie
+      // previous version).  This will also emit a signalPropertyChanged from ObjectStoreTyped<Recipe>, which the UI can
+      // pick up to update tree display of Recipes etc.
+      //
+      owner.setAncestor(*spawn);
 
-   // If the object we're about to change already has descendants, then we don't want to create new ones.
-   if (owner->hasDescendants()) {
-      qDebug() << Q_FUNC_INFO << "Recipe #" << owner->key() << "already has descendants, so not creating any more";
       return;
    }
+}
 
+void RecipeHelper::prepareForPropertyChange(NamedEntity & ne, BtStringConst const & propertyName) {
    //
-   // Once we've started doing versioning, we don't want to trigger it again on the same Recipe until we've finished
+   // If the user has said they don't want versioning, and there are no previous versions for the object to be shared
+   // with, there's nothing to do -- and we don't want to go asking every Recipe whether it uses the object.
    //
-   NamedEntityModifyingMarker ownerModifyingMarker(*owner);
+   bool const versioningEnabled = RecipeHelper::getAutomaticVersioningEnabled();
+   if (!versioningEnabled && !previousVersionsExist) {
+      return;
+   }
 
    //
-   // Versioning when modifying something in a recipe is *hard*.  If we copy the recipe, there is no easy way to say
-   // "this ingredient in the old recipe is that ingredient in the new".  One approach would be to use the delete idea,
-   // ie copy everything but what's being modified, clone what's being modified and add the clone to the copy.  Another
-   // is to take a deep copy of the Recipe and make that the "prior version".
+   // If the object we're about to change a property on is a Recipe or is used in a Recipe, then it might need a new
+   // version.  Even if versioning is now turned off, it might also be shared with previous versions of that Recipe.
    //
+   Recipe * owner = ne.getOwningRecipe();
+   if (!owner) {
+      // Change is not related to a recipe
+      return;
+   }
 
-   // Create a deep copy of the Recipe, and put it in the DB, so it has an ID.
-   // (This will also emit signalObjectInserted for the new Recipe from ObjectStoreTyped<Recipe>.)
-   qDebug() << Q_FUNC_INFO << "Copying Recipe" << owner->key();
-
-   // We also don't want to trigger versioning on the newly spawned Recipe until we're completely done here!
-   std::shared_ptr<Recipe> spawn = std::make_shared<Recipe>(*owner);
-   NamedEntityModifyingMarker spawnModifyingMarker(*spawn);
-   ObjectStoreWrapper::insert(spawn);
-
-   qDebug() << Q_FUNC_INFO << "Copied Recipe #" << owner->key() << "to new Recipe #" << spawn->key();
-
-   // We assert that the newly created version of the recipe has not yet been brewed (and therefore will not get
-   // automatically versioned on subsequent changes before it is brewed).
-   Q_ASSERT(spawn->brewNotes().empty());
+   if (versioningEnabled) {
+      qDebug() <<
+         Q_FUNC_INFO << "Modifying: " << ne.metaObject()->className() << "#" << ne.key() << "property" <<
+         propertyName;
+      createNewVersionIfNeeded(*owner);
+   }
 
    //
-   // By default, copying a Recipe does not copy all its ancestry.  Here, we want the copy to become our ancestor (ie
-   // previous version).  This will also emit a signalPropertyChanged from ObjectStoreTyped<Recipe>, which the UI can
-   // pick up to update tree display of Recipes etc.
+   // Whether or not we just created a new version, we don't want the change to show up in any previous ones.  (Changes
+   // to the Recipe itself don't need any special handling as each version has its own Recipe record.)
    //
-   owner->setAncestor(*spawn);
+   if (&ne != owner) {
+      owner->unshareWithPreviousVersions(ne);
+   }
 
    return;
 }
@@ -37,8 +37,9 @@
 
 #include "model/BrewNote.h"
 #include "model/NamedEntity.h"
-#include "model/Hop.h" // Dammit! Have to include these for Hop::Use (see hopSteps()) and Misc::Use (see miscSteps()).
+#include "model/Hop.h"
 #include "model/Misc.h"
+#include "model/RecipeSnapshot.h"
 #include "model/Salt.h"  // Needed for Salt::WhenToAdd (see getReagents())
 
 //======================================================================================================================
@@ -120,7 +121,6 @@ class Fermentable;
 class Instruction;
 class Mash;
 class MashStep;
-class PreInstruction;
 class Style;
 class Water;
 class Yeast;
@@ -145,9 +145,68 @@ public:
     */
    static TypeLookup const typeLookup;
 
+   /**
+    * \brief How we treat the Hops, Fermentables, Mash etc of a Recipe when copying it
+    */
+   enum class CopyMode {
+      //! The copy gets its own copies of everything.  This is what the user expects when they copy a Recipe.
+      Deep,
+      /**
+       * The copy shares the rows of the original, and a row is only copied when it is about to be changed (see
+       * \c unshareWithPreviousVersions).  This is how we make previous versions of a Recipe.
+       */
+      SharedIngredients
+   };
+
+   /**
+    * \brief RAII helper for making a lot of changes to a Recipe in one go, eg when scaling it or running the mash
+    *        wizard.  Without it, every setter on the Recipe, its Equipment, Style, Mash, MashSteps and ingredients
+    *        writes to the database in its own transaction, emits \c changed, and very often triggers a full
+    *        \c Recipe::recalcAll.
+    *
+    *        For as long as the session exists, property changes on those objects are collected rather than written,
+    *        and recalculation of the Recipe is put off.  On \c commit (or destruction), each changed property is
+    *        written once, all in a single database transaction, then one \c changed signal is emitted per changed
+    *        property, followed by (at most) one recalculation.
+    *
+    *        Notes:
+    *         - Only the objects the Recipe uses when the session starts are covered.  Things added during the session
+    *           (including new Equipment or Mash copies) get written as normal.
+    *         - Adding and removing ingredients still happens immediately - it's only property changes that are
+    *           batched.
+    *         - Reads inside the session see the new values of properties, but calculated properties of the Recipe
+    *           (OG, IBU etc) are not updated until the end.
+    *         - A session on a Recipe that already has one does nothing, so it is safe to nest them.
+    */
+   class EditSession : public NamedEntityChangeCollector {
+   public:
+      EditSession(Recipe & recipe);
+      ~EditSession();
+
+      /**
+       * \brief Write, signal and recalculate everything changed so far, and end the session.  Called automatically by
+       *        the destructor if not called explicitly.
+       */
+      void commit();
+
+      virtual void collectChange(NamedEntity const & namedEntity, BtStringConst const & propertyName, bool notify);
+
+   private:
+      // Private implementation details - see https://herbsutter.com/gotw/_100/
+      class impl;
+      std::unique_ptr<impl> pimpl;
+
+      // RAII class shouldn't be getting copied or moved
+      EditSession(EditSession const &) = delete;
+      EditSession & operator=(EditSession const &) = delete;
+      EditSession(EditSession &&) = delete;
+      EditSession & operator=(EditSession &&) = delete;
+   };
+
    Recipe(QString name);
    Recipe(NamedParameterBundle const & namedParameterBundle);
    Recipe(Recipe const & other);
+   Recipe(Recipe const & other, CopyMode const copyMode);
 
    virtual ~Recipe();
 
@@ -317,6 +376,24 @@ public:
     */
    static void connectSignalsForAllRecipes();
 
+   /**
+    * \brief Returns a counter that goes up every time this Recipe, or one of the ingredients etc it contains, changes.
+    *        The absolute value means nothing, but callers that cache things derived from the Recipe (eg formatted HTML)
+    *        can compare it with the value they saw last time to know whether their cached copy is stale.
+    */
+   unsigned int generation() const;
+
+   /**
+    * \brief By default, \c generation() only changes when something that goes into our calculations (ingredients,
+    *        equipment, mash) changes.  Things generated from us (eg by \c RecipeFormatter) also show the style, miscs,
+    *        waters, salts, instructions and brew notes, so anything that caches such output against \c generation()
+    *        needs to call this first, on the GUI thread, to have changes to those counted too.
+    *
+    *        Most recipes are never printed, so we don't connect these signals for every Recipe at start-up, only for
+    *        the ones that ask.  Calling this more than once for the same Recipe is harmless.
+    */
+   void connectSignalsForCachedOutput();
+
    /*!
     * \brief Add (a copy if necessary of) a Hop/Fermentable/Instruction etc (that may or may not already be in an
     *        ObjectStore).
@@ -370,7 +447,10 @@ public:
    void clearInstructions();
    //! \brief Insert instruction ins into slot pos.
    void insertInstruction(Instruction const & ins, int pos);
-   //! \brief Automagically generate a list of instructions.
+   /**
+    * \brief Automagically generate a list of instructions.  Existing instructions that still say the right thing are
+    *        kept as they are, and others are updated, added or removed as needed, all in one DB transaction.
+    */
    void generateInstructions();
    /*!
     * Finds the next ingredient to add that has a time
@@ -491,18 +571,10 @@ public:
    void setAncestorId    (int ancestorId, bool notify = true);
 
    // Other junk.
-   QVector<PreInstruction> mashInstructions(double timeRemaining, double totalWaterAdded_l, unsigned int size);
-   QVector<PreInstruction> mashSteps();
-   QVector<PreInstruction> hopSteps(Hop::Use type = Hop::Use::Boil);
-   QVector<PreInstruction> miscSteps(Misc::Use type = Misc::Use::Boil);
-   PreInstruction boilFermentablesPre(double timeRemaining);
-   bool hasBoilFermentable();
-   bool hasBoilExtract();
    static bool isFermentableSugar(Fermentable *);
    bool hasAncestors() const;
    bool isMyAncestor(Recipe const & maybe) const;
    bool hasDescendants() const;
-   PreInstruction addExtracts(double timeRemaining) const;
 
    // Helpers
    //! \brief Get the ibus from a given \c hop.
@@ -515,7 +587,26 @@ public:
    QList<QString> getReagents(QList<Hop *> hops, bool firstWort = false);
    //! \brief Formats the salts for instructions
    QStringList getReagents(QList<Salt *> salts, Salt::WhenToAdd wanted);
-   QHash<QString, double> calcTotalPoints();
+   /**
+    * \brief The maximum theoretical sugars available from the fermentables, which the OG, boil gravity and brewhouse
+    *        efficiency calculations all need.  The result is cached until one of our fermentables changes (or one is
+    *        added or removed).
+    */
+   RecipeCalcs::TotalPoints calcTotalPoints();
+
+   /**
+    * \brief Take results calculated elsewhere (typically on a worker thread, from a \c RecipeSnapshot of this Recipe --
+    *        see \c RecipeBulkRecalc) as our calculated properties.  This does the same as \c recalcAll, except that
+    *        the calculations have already been done, and that changes to the stored values (OG and FG) are written to
+    *        the DB even if we have not yet calculated anything ourselves -- because the whole point of a bulk
+    *        recalculation is to bring the DB up to date.
+    *
+    *        NB: The caller is responsible for ensuring the results are from a snapshot of the Recipe as it is now (eg
+    *            by checking \c generation has not changed since the snapshot was taken).
+    *
+    * \return \c true if any calculated property changed
+    */
+   bool applyCalcResults(RecipeCalcs::Results const & results);
 
    // Setters that are not slots
    void setType              (Type    const   val);
@@ -551,6 +642,14 @@ public:
 
    virtual Recipe * getOwningRecipe();
 
+   /**
+    * \brief Previous versions of this Recipe can share Hops, Fermentables, Mash etc with it (see
+    *        \c CopyMode::SharedIngredients).  This should be called before \c ne (which is something used by this
+    *        Recipe, or a \c MashStep of its \c Mash) is modified, and gives any previous versions that share \c ne
+    *        their own copy of it, so that they are unaffected by the change.
+    */
+   void unshareWithPreviousVersions(NamedEntity const & ne);
+
    /**
     * \brief A Recipe owns some of its contained objects, so needs to delete those if it itself is being deleted
     */
@@ -677,17 +776,7 @@ private:
    // Emits changed(og), changed(fg). Depends on: _wortFromMash_l, _finalVolume_l
    Q_INVOKABLE void recalcOgFg();
 
-   // Adds instructions to the recipe.
-   void postboilFermentablesIns();
-   void postboilIns();
-   void mashFermentableIns();
-   void mashWaterIns();
-   void firstWortHopsIns();
-   void topOffIns();
-   void saltWater(Salt::WhenToAdd when);
-
    //void setDefaults();
-   void addPreinstructions(QVector<PreInstruction> preins);
    bool isValidType(const QString & str);
 };
 
@@ -700,6 +789,14 @@ namespace RecipeHelper {
     */
    QList<BrewNote *> brewNotesForRecipeAndAncestors(Recipe const & recipe);
 
+   /**
+    * \brief Because previous versions of a Recipe can share ingredients etc with it, more than one Recipe can use
+    *        \c ne.  In that case, it is owned by the most recent of them, ie the one that has the others as ancestors.
+    *
+    * \return The Recipe that owns \c ne, or \c nullptr if it is not used in any Recipe
+    */
+   template<class NE> Recipe * findOwningRecipe(NE const & ne);
+
    /**
     * \brief Checks whether an about-to-be-made property change require us to create a new version of a Recipe - eg
     *        because we are modifying some ingredient or other attribute of the Recipe and automatic versioning is
@@ -0,0 +1,512 @@
+/*
+ * model/RecipeSnapshot.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "model/RecipeSnapshot.h"
+
+#include <vector>
+
+#include "Algorithms.h"
+#include "Localization.h"
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
+#include "model/Equipment.h"
+#include "model/Mash.h"
+#include "model/MashSimulation.h"
+#include "model/Recipe.h"
+#include "model/Yeast.h"
+#include "PersistentSettings.h"
+#include "PhysicalConstants.h"
+
+namespace {
+   // See RecipeSnapshot::calcSettingsChanged.  Only used on the GUI thread.
+   unsigned int calcSettingsGeneration = 0;
+}
+
+bool RecipeSnapshot::Fermentable::isSugar() const {
+   return this->type == ::Fermentable::Type::Sugar;
+}
+
+bool RecipeSnapshot::Fermentable::isExtract() const {
+   return this->type == ::Fermentable::Type::Extract || this->type == ::Fermentable::Type::Dry_Extract;
+}
+
+double RecipeSnapshot::Equipment::wortEndOfBoil_l(double kettleWort_l) const {
+   return this->wortAfterBoiling_l(kettleWort_l, this->boilTime_min);
+}
+
+double RecipeSnapshot::Equipment::wortAfterBoiling_l(double kettleWort_l, double minutes) const {
+   return kettleWort_l - (minutes / 60.0) * this->evapRate_lHr;
+}
+
+RecipeSnapshot RecipeSnapshot::create(Recipe const & recipe) {
+   RecipeSnapshot snapshot;
+   snapshot.key            = recipe.key();
+   snapshot.name           = recipe.name();
+   snapshot.batchSize_l    = recipe.batchSize_l();
+   snapshot.boilSize_l     = recipe.boilSize_l();
+   snapshot.efficiency_pct = recipe.efficiency_pct();
+
+   ::Equipment * equipment = recipe.equipment();
+   if (equipment) {
+      snapshot.equipment = RecipeSnapshot::Equipment{
+         equipment->boilTime_min(),
+         equipment->evapRate_lHr(),
+         equipment->grainAbsorption_LKg(),
+         equipment->hopUtilization_pct(),
+         equipment->lauterDeadspace_l(),
+         equipment->topUpKettle_l(),
+         equipment->topUpWater_l(),
+         equipment->trubChillerLoss_l()
+      };
+   }
+
+   ::Mash * mash = recipe.mash();
+   if (mash) {
+      // This gets asked for on every recalculation, so we use the cached simulation rather than go through the steps
+      snapshot.mash = RecipeSnapshot::Mash{MashSimulation::forMash(*mash)->totalMashWater_l()};
+   }
+
+   QList<::Fermentable *> const fermentables = recipe.fermentables();
+   snapshot.fermentables.reserve(fermentables.size());
+   for (auto fermentable : fermentables) {
+      snapshot.fermentables.append(RecipeSnapshot::Fermentable{
+         fermentable->type(),
+         fermentable->amount_kg(),
+         fermentable->color_srm(),
+         fermentable->ibuGalPerLb(),
+         fermentable->equivSucrose_kg(),
+         fermentable->isMashed(),
+         fermentable->addAfterBoil(),
+         Recipe::isFermentableSugar(fermentable)
+      });
+   }
+
+   QList<::Hop *> const hops = recipe.hops();
+   snapshot.hops.reserve(hops.size());
+   for (auto hop : hops) {
+      snapshot.hops.append(RecipeSnapshot::Hop{
+         hop->use(),
+         hop->form(),
+         hop->alpha_pct(),
+         hop->amount_kg(),
+         hop->time_min()
+      });
+   }
+
+   QList<::Yeast *> const yeasts = recipe.yeasts();
+   snapshot.yeasts.reserve(yeasts.size());
+   for (auto yeast : yeasts) {
+      snapshot.yeasts.append(RecipeSnapshot::Yeast{yeast->attenuation_pct()});
+   }
+
+   snapshot.firstWortHopAdjustment = Localization::toDouble(
+      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
+      Q_FUNC_INFO
+   );
+   snapshot.mashHopAdjustment = Localization::toDouble(
+      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
+      Q_FUNC_INFO
+   );
+   snapshot.ibuFormula             = IbuMethods::ibuFormula;
+   snapshot.colorFormula           = ColorMethods::colorFormula;
+   snapshot.calcSettingsGeneration = calcSettingsGeneration;
+
+   return snapshot;
+}
+
+void RecipeSnapshot::calcSettingsChanged() {
+   ++calcSettingsGeneration;
+   return;
+}
+
+bool RecipeSnapshot::hasCurrentSettings() const {
+   return this->calcSettingsGeneration == calcSettingsGeneration &&
+          this->ibuFormula             == IbuMethods::ibuFormula  &&
+          this->colorFormula           == ColorMethods::colorFormula;
+}
+
+double RecipeSnapshot::batchSizeNoLosses_l() const {
+   double ret = this->batchSize_l;
+   if (this->equipment) {
+      ret += this->equipment->trubChillerLoss_l;
+   }
+   return ret;
+}
+
+double RecipeCalcs::grainsInMash_kg(RecipeSnapshot const & recipe) {
+   double ret = 0.0;
+   for (auto const & fermentable : recipe.fermentables) {
+      if (fermentable.type == Fermentable::Type::Grain && fermentable.isMashed) {
+         ret += fermentable.amount_kg;
+      }
+   }
+   return ret;
+}
+
+double RecipeCalcs::grains_kg(RecipeSnapshot const & recipe) {
+   double ret = 0.0;
+   for (auto const & fermentable : recipe.fermentables) {
+      ret += fermentable.amount_kg;
+   }
+   return ret;
+}
+
+RecipeCalcs::VolumeEstimates RecipeCalcs::volumeEstimates(RecipeSnapshot const & recipe, double grainsInMash_kg) {
+   VolumeEstimates ret{0.0, 0.0, 0.0, 0.0, 0.0};
+
+   // wortFromMash_l ==========================
+   if (recipe.mash) {
+      double const absorption_lKg =
+         recipe.equipment ? recipe.equipment->grainAbsorption_LKg : PhysicalConstants::grainAbsorption_Lkg;
+      ret.wortFromMash_l = recipe.mash->totalMashWater_l - absorption_lKg * grainsInMash_kg;
+   }
+
+   // boilVolume_l ==============================
+   double tmp = ret.wortFromMash_l;
+   if (recipe.equipment) {
+      tmp += recipe.equipment->topUpKettle_l - recipe.equipment->lauterDeadspace_l;
+   }
+
+   // Need to account for extract/sugar volume also.
+   for (auto const & fermentable : recipe.fermentables) {
+      if (fermentable.type == Fermentable::Type::Extract) {
+         tmp += fermentable.amount_kg / PhysicalConstants::liquidExtractDensity_kgL;
+      } else if (fermentable.type == Fermentable::Type::Sugar) {
+         tmp += fermentable.amount_kg / PhysicalConstants::sucroseDensity_kgL;
+      } else if (fermentable.type == Fermentable::Type::Dry_Extract) {
+         tmp += fermentable.amount_kg / PhysicalConstants::dryExtractDensity_kgL;
+      }
+   }
+
+   if (tmp <= 0.0) {
+      tmp = recipe.boilSize_l;   // Give up.
+   }
+   ret.boilVolume_l = tmp;
+
+   // finalVolume_l ==============================
+
+   // NOTE: the following figure is not based on the other volume estimates
+   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
+   ret.finalVolumeNoLosses_l = recipe.batchSizeNoLosses_l();
+   if (recipe.equipment) {
+      ret.finalVolume_l = recipe.equipment->wortEndOfBoil_l(ret.boilVolume_l) +
+                          recipe.equipment->topUpWater_l - recipe.equipment->trubChillerLoss_l;
+   }
+   // Without an equipment, we can't really say anything about the final volume, so it stays at 0.
+
+   // postBoilVolume_l ===========================
+   if (recipe.equipment) {
+      ret.postBoilVolume_l = recipe.equipment->wortEndOfBoil_l(ret.boilVolume_l);
+   } else {
+      ret.postBoilVolume_l = recipe.batchSize_l; // Give up.
+   }
+
+   return ret;
+}
+
+double RecipeCalcs::color_srm(RecipeSnapshot const & recipe, double finalVolumeNoLosses_l) {
+   double mcu = 0.0;
+   for (auto const & fermentable : recipe.fermentables) {
+      // Conversion factor for lb/gal to kg/l = 8.34538.
+      mcu += fermentable.color_srm * 8.34538 * fermentable.amount_kg / finalVolumeNoLosses_l;
+   }
+   return ColorMethods::mcuToSrm(mcu, recipe.colorFormula);
+}
+
+RecipeCalcs::TotalPoints RecipeCalcs::totalPoints(RecipeSnapshot const & recipe) {
+   TotalPoints ret{0.0, 0.0, 0.0, 0.0, 0.0};
+
+   for (auto const & fermentable : recipe.fermentables) {
+      // If we have some sort of non-grain, we have to ignore efficiency.
+      if (fermentable.isSugar() || fermentable.isExtract()) {
+         ret.sugar_kg_ignoreEfficiency += fermentable.equivSucrose_kg;
+
+         if (fermentable.addAfterBoil) {
+            ret.lateAddition_kg_ignoreEff += fermentable.equivSucrose_kg;
+         }
+
+         if (!fermentable.isFermentableSugar) {
+            ret.nonFermentableSugars_kg += fermentable.equivSucrose_kg;
+         }
+      } else {
+         ret.sugar_kg += fermentable.equivSucrose_kg;
+
+         if (fermentable.addAfterBoil) {
+            ret.lateAddition_kg += fermentable.equivSucrose_kg;
+         }
+      }
+   }
+
+   return ret;
+}
+
+RecipeCalcs::Gravities RecipeCalcs::gravities(RecipeSnapshot const & recipe,
+                                              TotalPoints const & sugars,
+                                              double wortFromMash_l,
+                                              double finalVolumeNoLosses_l) {
+   Gravities ret{0.0, 0.0, 0.0, 0.0};
+
+   double sugar_kg                  = sugars.sugar_kg;                  // Mass of sugar that *is* affected by mash efficiency
+   double sugar_kg_ignoreEfficiency = sugars.sugar_kg_ignoreEfficiency; // Mass of sugar that *is not* affected by mash efficiency
+   double nonFermentableSugars_kg   = sugars.nonFermentableSugars_kg;   // Mass of sugar that is not fermentable (also counted in sugar_kg_ignoreEfficiency)
+
+   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
+   if (recipe.equipment) {
+      double const kettleWort_l =
+         (wortFromMash_l - recipe.equipment->lauterDeadspace_l) + recipe.equipment->topUpKettle_l;
+      double const postBoilWort_l = recipe.equipment->wortEndOfBoil_l(kettleWort_l);
+      double ratio = (postBoilWort_l - recipe.equipment->trubChillerLoss_l) / postBoilWort_l;
+      if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
+         ratio = 1.0;
+      } else if (ratio < 0.0) {
+         ratio = 0.0;
+      } else if (Algorithms::isNan(ratio)) {
+         ratio = 1.0;
+      }
+      // Ignore this again since it should be included in efficiency.
+      //sugar_kg *= ratio;
+      sugar_kg_ignoreEfficiency *= ratio;
+      if (nonFermentableSugars_kg != 0.0) {
+         nonFermentableSugars_kg *= ratio;
+      }
+   }
+
+   // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
+   sugar_kg = sugar_kg * recipe.efficiency_pct / 100.0 + sugar_kg_ignoreEfficiency;
+   double plato = Algorithms::getPlato(sugar_kg, finalVolumeNoLosses_l);
+
+   ret.og = Algorithms::PlatoToSG_20C20C(plato);    // og from all sugars
+   double pnts = (ret.og - 1) * 1000.0; // points from all sugars
+   double nonFermPnts = 0.0;
+   if (nonFermentableSugars_kg != 0.0) {
+      double const ferm_kg = sugar_kg - nonFermentableSugars_kg;  // Mass of only fermentable sugars
+      plato = Algorithms::getPlato(ferm_kg, finalVolumeNoLosses_l);   // Plato from fermentable sugars
+      ret.og_fermentable = Algorithms::PlatoToSG_20C20C(plato);    // og from only fermentable sugars
+      plato = Algorithms::getPlato(nonFermentableSugars_kg, finalVolumeNoLosses_l);   // Plato from non-fermentable sugars
+      nonFermPnts = ((Algorithms::PlatoToSG_20C20C(plato)) - 1) * 1000.0; // og points from non-fermentable sugars
+   } else {
+      ret.og_fermentable = ret.og;
+   }
+
+   // Calculate FG.  Get the yeast with the greatest attenuation.
+   double attenuation_pct = 0.0;
+   for (auto const & yeast : recipe.yeasts) {
+      if (yeast.attenuation_pct > attenuation_pct) {
+         attenuation_pct = yeast.attenuation_pct;
+      }
+   }
+   // This means we have yeast, but they neglected to provide attenuation percentages.
+   if (recipe.yeasts.size() > 0 && attenuation_pct <= 0.0)  {
+      attenuation_pct = 75.0; // 75% is an average attenuation.
+   }
+
+   if (nonFermentableSugars_kg != 0.0) {
+      double const fermPnts = (pnts - nonFermPnts) * (1.0 - attenuation_pct / 100.0); // fg points from fermentable sugars
+      pnts = fermPnts + nonFermPnts;  // FG points from both fermentable and non-fermentable sugars
+      ret.fg = 1 + pnts / 1000.0;
+      ret.fg_fermentable = 1 + fermPnts / 1000.0; // FG from fermentables only
+   } else {
+      pnts *= (1.0 - attenuation_pct / 100.0);
+      ret.fg = 1 + pnts / 1000.0;
+      ret.fg_fermentable = ret.fg;
+   }
+
+   return ret;
+}
+
+double RecipeCalcs::ABV_pct(double og_fermentable, double fg_fermentable) {
+   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
+   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
+   return (76.08 * (og_fermentable - fg_fermentable) / (1.775 - og_fermentable)) * (fg_fermentable / 0.794);
+}
+
+double RecipeCalcs::boilGrav(RecipeSnapshot const & recipe, TotalPoints const & sugars) {
+   // Since the efficiency refers to how much sugar we get into the fermenter,
+   // we need to adjust for that here.
+   double const sugar_kg = recipe.efficiency_pct / 100.0 * (sugars.sugar_kg - sugars.lateAddition_kg) +
+                           sugars.sugar_kg_ignoreEfficiency - sugars.lateAddition_kg_ignoreEff;
+
+   return Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(sugar_kg, recipe.boilSize_l));
+}
+
+int RecipeCalcs::ibuBoilTime_min(RecipeSnapshot const & recipe) {
+   // Assume 60 min boil until further notice
+   return recipe.equipment ? static_cast<int>(recipe.equipment->boilTime_min) : 60;
+}
+
+RecipeCalcs::HopIbuParameters RecipeCalcs::hopIbuParameters(RecipeSnapshot const & recipe,
+                                                            RecipeSnapshot::Hop const & hop) {
+   // Assume 100% utilization until further notice
+   double hopUtilization = 1.0;
+   int const boilTime = RecipeCalcs::ibuBoilTime_min(recipe);
+
+   // NOTE: we used to carefully calculate the average boil gravity and use it in the
+   // IBU calculations. However, due to John Palmer
+   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
+   // it seems more appropriate to just use the OG directly, since it is the total
+   // amount of break material that truly affects the IBUs.
+
+   if (recipe.equipment) {
+      hopUtilization = recipe.equipment->hopUtilization_pct / 100.0;
+   }
+
+   // Adjust for hop form. Tinseth's table was created from whole cone data,
+   // and it seems other formulae are optimized that way as well. So, the
+   // utilization is considered unadjusted for whole cones, and adjusted
+   // up for plugs and pellets.
+   //
+   // - http://www.realbeer.com/hops/FAQ.html
+   switch (hop.form) {
+      case Hop::Form::Plug:
+         hopUtilization *= 1.02;
+         break;
+      case Hop::Form::Pellet:
+         hopUtilization *= 1.10;
+         break;
+      default:
+         break;
+   }
+
+   if (hop.use == Hop::Use::Boil) {
+      return HopIbuParameters{true, hop.time_min, hopUtilization};
+   }
+   if (hop.use == Hop::Use::First_Wort) {
+      return HopIbuParameters{true, static_cast<double>(boilTime), recipe.firstWortHopAdjustment * hopUtilization};
+   }
+   if (hop.use == Hop::Use::Mash && recipe.mashHopAdjustment > 0.0) {
+      return HopIbuParameters{true, static_cast<double>(boilTime), recipe.mashHopAdjustment * hopUtilization};
+   }
+   return HopIbuParameters{false, 0.0, hopUtilization};
+}
+
+double RecipeCalcs::ibuFromHop(RecipeSnapshot const & recipe,
+                               RecipeSnapshot::Hop const & hop,
+                               double og,
+                               double finalVolumeNoLosses_l) {
+   HopIbuParameters const parameters = RecipeCalcs::hopIbuParameters(recipe, hop);
+   if (!parameters.contributes) {
+      return 0.0;
+   }
+   return parameters.factor * IbuMethods::getIbus(hop.alpha_pct / 100.0,
+                                                  hop.amount_kg * 1000.0,
+                                                  finalVolumeNoLosses_l,
+                                                  og,
+                                                  parameters.minutes,
+                                                  recipe.ibuFormula);
+}
+
+double RecipeCalcs::IBU(RecipeSnapshot const & recipe,
+                        double og,
+                        double finalVolumeNoLosses_l,
+                        QVector<double> * hopIbus) {
+   //
+   // Bitterness due to hops.  Rather than calling ibuFromHop for each hop, we gather up the ones that contribute and
+   // do them all in one go with the batched IBU calculation.
+   //
+   IbuMethods::HopAdditions hopAdditions;
+   hopAdditions.reserve(static_cast<std::size_t>(recipe.hops.size()));
+   // For each hop, its index in hopAdditions, or -1 if it doesn't contribute
+   QVector<int> additionIndexes(recipe.hops.size(), -1);
+   for (int ii = 0; ii < recipe.hops.size(); ++ii) {
+      RecipeSnapshot::Hop const & hop = recipe.hops.at(ii);
+      HopIbuParameters const parameters = RecipeCalcs::hopIbuParameters(recipe, hop);
+      if (parameters.contributes) {
+         additionIndexes[ii] = static_cast<int>(hopAdditions.size());
+         hopAdditions.append(hop.alpha_pct / 100.0,
+                             hop.amount_kg * 1000.0,
+                             finalVolumeNoLosses_l,
+                             og,
+                             parameters.minutes,
+                             parameters.factor);
+      }
+   }
+   std::vector<double> additionIbus(hopAdditions.size());
+   IbuMethods::getIbus(hopAdditions, additionIbus.data(), recipe.ibuFormula);
+
+   double ibus = 0.0;
+   if (hopIbus) {
+      hopIbus->clear();
+      hopIbus->reserve(recipe.hops.size());
+   }
+   for (int ii = 0; ii < recipe.hops.size(); ++ii) {
+      double const hopIbu =
+         additionIndexes.at(ii) < 0 ? 0.0 : additionIbus[static_cast<std::size_t>(additionIndexes.at(ii))];
+      if (hopIbus) {
+         hopIbus->append(hopIbu);
+      }
+      ibus += hopIbu;
+   }
+
+   // Bitterness due to hopped extracts...
+   ibus += RecipeCalcs::extractIbus(recipe);
+
+   return ibus;
+}
+
+double RecipeCalcs::extractIbus(RecipeSnapshot const & recipe) {
+   double ibus = 0.0;
+   for (auto const & fermentable : recipe.fermentables) {
+      // Conversion factor for lb/gal to kg/l = 8.34538.
+      ibus += fermentable.ibuGalPerLb * (fermentable.amount_kg / recipe.batchSize_l) / 8.34538;
+   }
+   return ibus;
+}
+
+// the formula in here are taken from http://hbd.org/ensmingr/
+double RecipeCalcs::calories(double og, double fg) {
+   // Need to translate OG and FG into plato
+   double const startPlato  = -463.37 + (668.72 * og) - (205.35 * og * og);
+   double const finishPlato = -463.37 + (668.72 * fg) - (205.35 * fg * fg);
+
+   // RE (real extract)
+   double const RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
+
+   // Alcohol by weight?
+   double const abw = (startPlato - RE) / (2.0665 - (0.010665 * startPlato));
+
+   // The final results of this formular are calories per 100 ml.
+   // The 3.55 puts it in terms of 12 oz. I really should have stored it
+   // without that adjust.
+   double const ret = ((6.9 * abw) + 4.0 * (RE - 0.1)) * fg * 3.55;
+
+   //! If there are no fermentables in the recipe, if there is no mash, etc.,
+   //  then the calories/12 oz ends up negative. Since negative doesn't make
+   //  sense, set it to 0
+   return ret < 0 ? 0 : ret;
+}
+
+RecipeCalcs::Results RecipeCalcs::calcAll(RecipeSnapshot const & recipe) {
+   Results ret;
+   ret.grainsInMash_kg = RecipeCalcs::grainsInMash_kg(recipe);
+   ret.grains_kg       = RecipeCalcs::grains_kg(recipe);
+   ret.totalPoints     = RecipeCalcs::totalPoints(recipe);
+   ret.volumes         = RecipeCalcs::volumeEstimates(recipe, ret.grainsInMash_kg);
+   ret.color_srm       = RecipeCalcs::color_srm(recipe, ret.volumes.finalVolumeNoLosses_l);
+   ret.gravities       = RecipeCalcs::gravities(recipe,
+                                                ret.totalPoints,
+                                                ret.volumes.wortFromMash_l,
+                                                ret.volumes.finalVolumeNoLosses_l);
+   ret.ABV_pct         = RecipeCalcs::ABV_pct(ret.gravities.og_fermentable, ret.gravities.fg_fermentable);
+   ret.boilGrav        = RecipeCalcs::boilGrav(recipe, ret.totalPoints);
+   ret.IBU             = RecipeCalcs::IBU(recipe,
+                                          ret.gravities.og,
+                                          ret.volumes.finalVolumeNoLosses_l,
+                                          &ret.hopIbus);
+   ret.calories        = RecipeCalcs::calories(ret.gravities.og, ret.gravities.fg);
+   return ret;
+}
@@ -0,0 +1,289 @@
+/*
+ * model/RecipeSnapshot.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MODEL_RECIPESNAPSHOT_H
+#define MODEL_RECIPESNAPSHOT_H
+#pragma once
+
+#include <optional>
+
+#include <QString>
+#include <QVector>
+
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
+#include "model/Fermentable.h"
+#include "model/Hop.h"
+
+class Recipe;
+
+/*!
+ * \class RecipeSnapshot
+ *
+ * \brief Immutable, plain-value copy of the parts of a \c Recipe (and its ingredients, equipment and mash) that the
+ *        recipe calculations need.  All amounts are in canonical SI units (kilograms, liters, minutes, etc).
+ *
+ *        \c Recipe, \c Hop, \c Fermentable etc are \c QObject instances that belong to the GUI thread, so it is not safe
+ *        to read them from anywhere else.  A \c RecipeSnapshot, by contrast, is just data: once it has been created
+ *        (on the GUI thread), it can be copied to, and read from, any thread.  The functions in \c RecipeCalcs take
+ *        a snapshot and return results without touching any model objects.
+ */
+struct RecipeSnapshot {
+   struct Fermentable {
+      ::Fermentable::Type type;
+      double amount_kg;
+      double color_srm;
+      double ibuGalPerLb;
+      //! \brief See \c Fermentable::equivSucrose_kg
+      double equivSucrose_kg;
+      bool   isMashed;
+      bool   addAfterBoil;
+      //! \brief See \c Recipe::isFermentableSugar
+      bool   isFermentableSugar;
+
+      bool isSugar()   const;
+      bool isExtract() const;
+   };
+
+   struct Hop {
+      ::Hop::Use  use;
+      ::Hop::Form form;
+      double alpha_pct;
+      double amount_kg;
+      double time_min;
+   };
+
+   struct Yeast {
+      double attenuation_pct;
+   };
+
+   struct Equipment {
+      double boilTime_min;
+      double evapRate_lHr;
+      double grainAbsorption_LKg;
+      double hopUtilization_pct;
+      double lauterDeadspace_l;
+      double topUpKettle_l;
+      double topUpWater_l;
+      double trubChillerLoss_l;
+
+      //! \brief See \c Equipment::wortEndOfBoil_l
+      double wortEndOfBoil_l(double kettleWort_l) const;
+
+      //! \brief As \c wortEndOfBoil_l, but after boiling for only \c minutes
+      double wortAfterBoiling_l(double kettleWort_l, double minutes) const;
+   };
+
+   struct Mash {
+      double totalMashWater_l;
+   };
+
+   /**
+    * \brief Take a snapshot of \c recipe.  This reads model objects, so must be called on the GUI thread.
+    */
+   static RecipeSnapshot create(Recipe const & recipe);
+
+   /**
+    * \brief Needs to be called (on the GUI thread) when any of the settings we capture below changes, so that
+    *        \c hasCurrentSettings can tell that snapshots taken before the change are out of date.
+    */
+   static void calcSettingsChanged();
+
+   /**
+    * \brief Whether the settings captured in this snapshot are still the ones in force.  (Changes to the Recipe itself
+    *        are tracked by \c Recipe::generation.)  Must be called on the GUI thread.
+    */
+   bool hasCurrentSettings() const;
+
+   //! \brief \c batchSize_l plus trub/chiller losses, as \c Recipe::batchSizeNoLosses_l
+   double batchSizeNoLosses_l() const;
+
+   int     key;
+   QString name;
+   double  batchSize_l;
+   double  boilSize_l;
+   double  efficiency_pct;
+
+   std::optional<Equipment> equipment;
+   std::optional<Mash>      mash;
+   QVector<Fermentable>     fermentables;
+   QVector<Hop>             hops;
+   QVector<Yeast>           yeasts;
+
+   //
+   // Settings that affect the calculations.  We capture these too, so that the calculations do not need to read
+   // PersistentSettings (which is not something we want to be doing for every hop on every recalculation anyway) or
+   // the selected IBU and color formulas (which can be changed on the GUI thread while a worker is calculating).
+   //
+   double                  firstWortHopAdjustment;
+   double                  mashHopAdjustment;
+   IbuMethods::IbuType     ibuFormula;
+   ColorMethods::ColorType colorFormula;
+   //! How many times \c calcSettingsChanged had been called when the snapshot was taken
+   unsigned int            calcSettingsGeneration;
+};
+
+/*!
+ * \namespace RecipeCalcs
+ *
+ * \brief The calculations behind \c Recipe's calculated properties (OG, FG, IBU, color, volumes etc), as free
+ *        functions of a \c RecipeSnapshot.  These are pure functions, so it is safe to call them from any thread.
+ *
+ *        Some calculations depend on the results of others (eg IBU depends on OG and final volume), in which case the
+ *        earlier result is passed in explicitly.  \c RecipeCalcs::calcAll does everything in the right order.
+ */
+namespace RecipeCalcs {
+
+   //! \brief Outputs of \c RecipeCalcs::volumeEstimates
+   struct VolumeEstimates {
+      double wortFromMash_l;
+      double boilVolume_l;
+      double finalVolume_l;
+      double finalVolumeNoLosses_l;
+      double postBoilVolume_l;
+   };
+
+   /**
+    * \brief Outputs of \c RecipeCalcs::totalPoints: the maximum theoretical sugars available from the fermentables.
+    *        These depend only on the fermentables -- efficiency and equipment losses are applied afterwards.
+    */
+   struct TotalPoints {
+      double sugar_kg;
+      double nonFermentableSugars_kg;
+      double sugar_kg_ignoreEfficiency;
+      double lateAddition_kg;
+      double lateAddition_kg_ignoreEff;
+   };
+
+   //! \brief Outputs of \c RecipeCalcs::gravities
+   struct Gravities {
+      double og;
+      double fg;
+      //! \brief OG from fermentable sugars only
+      double og_fermentable;
+      //! \brief FG from fermentable sugars only
+      double fg_fermentable;
+   };
+
+   //! \brief Everything \c RecipeCalcs::calcAll calculates
+   struct Results {
+      double          grainsInMash_kg;
+      double          grains_kg;
+      TotalPoints     totalPoints;
+      VolumeEstimates volumes;
+      double          color_srm;
+      Gravities       gravities;
+      double          ABV_pct;
+      double          boilGrav;
+      double          IBU;
+      //! \brief IBUs from each hop, in the same order as \c RecipeSnapshot::hops
+      QVector<double> hopIbus;
+      double          calories;
+   };
+
+   //! \brief Mass of grains that are mashed
+   double grainsInMash_kg(RecipeSnapshot const & recipe);
+
+   //! \brief Mass of all fermentables
+   double grains_kg(RecipeSnapshot const & recipe);
+
+   /**
+    * \param grainsInMash_kg as returned by \c RecipeCalcs::grainsInMash_kg
+    */
+   VolumeEstimates volumeEstimates(RecipeSnapshot const & recipe, double grainsInMash_kg);
+
+   /**
+    * \param finalVolumeNoLosses_l from \c RecipeCalcs::volumeEstimates
+    */
+   double color_srm(RecipeSnapshot const & recipe, double finalVolumeNoLosses_l);
+
+   TotalPoints totalPoints(RecipeSnapshot const & recipe);
+
+   /**
+    * \param totalPoints from \c RecipeCalcs::totalPoints
+    * \param wortFromMash_l from \c RecipeCalcs::volumeEstimates
+    * \param finalVolumeNoLosses_l from \c RecipeCalcs::volumeEstimates
+    */
+   Gravities gravities(RecipeSnapshot const & recipe,
+                       TotalPoints const & totalPoints,
+                       double wortFromMash_l,
+                       double finalVolumeNoLosses_l);
+
+   /**
+    * \param og_fermentable from \c RecipeCalcs::gravities
+    * \param fg_fermentable from \c RecipeCalcs::gravities
+    */
+   double ABV_pct(double og_fermentable, double fg_fermentable);
+
+   /**
+    * \param totalPoints from \c RecipeCalcs::totalPoints
+    */
+   double boilGrav(RecipeSnapshot const & recipe, TotalPoints const & totalPoints);
+
+   //! \brief How a hop's IBUs are calculated, apart from its amount and alpha acid, and the OG and volume
+   struct HopIbuParameters {
+      //! \c false if the hop doesn't contribute any bitterness (eg dry hops)
+      bool   contributes;
+      //! Boil time to use in the IBU formula
+      double minutes;
+      //! What to multiply the formula's result by, for hop form, equipment hop utilization and first wort / mash hop
+      //! adjustment.  (For hops that don't contribute, this is just the hop form and equipment part, which is what
+      //! \c BoilCurves uses for hops added during a hop stand.)
+      double factor;
+   };
+
+   /**
+    * \brief Boil time used in the IBU calculations: the equipment's, rounded down to whole minutes, or 60 if there is
+    *        no equipment.  First wort and mash hops are treated as being in the boil for all of this time.
+    */
+   int ibuBoilTime_min(RecipeSnapshot const & recipe);
+
+   HopIbuParameters hopIbuParameters(RecipeSnapshot const & recipe, RecipeSnapshot::Hop const & hop);
+
+   /**
+    * \param og from \c RecipeCalcs::gravities
+    * \param finalVolumeNoLosses_l from \c RecipeCalcs::volumeEstimates
+    */
+   double ibuFromHop(RecipeSnapshot const & recipe,
+                     RecipeSnapshot::Hop const & hop,
+                     double og,
+                     double finalVolumeNoLosses_l);
+
+   //! \brief Bitterness from hopped extracts
+   double extractIbus(RecipeSnapshot const & recipe);
+
+   /**
+    * \param og from \c RecipeCalcs::gravities
+    * \param finalVolumeNoLosses_l from \c RecipeCalcs::volumeEstimates
+    * \param hopIbus If not null, receives the IBUs from each hop, in the same order as \c RecipeSnapshot::hops
+    */
+   double IBU(RecipeSnapshot const & recipe,
+              double og,
+              double finalVolumeNoLosses_l,
+              QVector<double> * hopIbus = nullptr);
+
+   //! \brief Calories per 12 oz
+   double calories(double og, double fg);
+
+   /**
+    * \brief Do all the calculations, in the same order as \c Recipe::recalcAll
+    */
+   Results calcAll(RecipeSnapshot const & recipe);
+}
+
+#endif
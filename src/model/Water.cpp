@@ -234,5 +234,5 @@ double Water::ppm(Water::Ions const ion) const {
 }
 
 Recipe * Water::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return RecipeHelper::findOwningRecipe(*this);
 }
@@ -310,5 +310,5 @@ void Yeast::setAddToSecondary( bool var ) {
 }
 
 Recipe * Yeast::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return RecipeHelper::findOwningRecipe(*this);
 }
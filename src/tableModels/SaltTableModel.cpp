@@ -102,6 +102,7 @@ void SaltTableModel::observeRecipe(Recipe* rec) {
       QObject::disconnect( this->recObs, nullptr, this, nullptr );
       removeAll();
    }
+   this->replacedSalts.clear();
 
    this->recObs = rec;
    if ( this->recObs ) {
@@ -277,7 +278,10 @@ double SaltTableModel::totalAcidWeight(Salt::Types type) const
    double ret = 0.0;
    if (type != Salt::Types::NONE) {
       for (auto salt : this->rows) {
-         if ( salt->type() == type && salt->whenToAdd() != Salt::WhenToAdd::NEVER) {
+         // Acid added to the sparge water doesn't get near the mash
+         if ( salt->type() == type &&
+              salt->whenToAdd() != Salt::WhenToAdd::NEVER &&
+              salt->whenToAdd() != Salt::WhenToAdd::SPARGE ) {
             double mult  = multiplier(*salt);
             // Acid malts are easy
             if ( type == Salt::Types::ACIDMLT ) {
@@ -347,7 +351,42 @@ void SaltTableModel::removeSalts(QList<int>deadSalts) {
    return;
 }
 
+void SaltTableModel::replaceSalts(QList<std::shared_ptr<Salt>> salts) {
+   //
+   // Unlike removeSalts(), we don't touch the Recipe or the DB here, as the user might yet change their mind (by
+   // cancelling or by no longer asking for the additions to be worked out).  Salts the Recipe already has just drop out
+   // of the table, and we remember them so that saveAndClose() can take them out of the Recipe.  (Salts we put in the
+   // table don't have IDs, so they never end up here.)
+   //
+   for (auto salt : this->rows) {
+      if (salt->key() > 0 && !this->replacedSalts.contains(salt)) {
+         this->replacedSalts.append(salt);
+      }
+   }
+   this->removeAll();
+
+   for (auto salt : salts) {
+      salt->setName(saltNames.at(static_cast<int>(salt->type())));
+   }
+   this->addSalts(salts);
+   emit newTotals();
+   return;
+}
+
+void SaltTableModel::restoreSalts() {
+   this->replacedSalts.clear();
+   this->removeAll();
+   if (this->recObs) {
+      this->addSalts(this->recObs->getAll<Salt>());
+   }
+   emit newTotals();
+   return;
+}
+
 void SaltTableModel::removeAll() {
+   if (this->rows.isEmpty()) {
+      return;
+   }
    beginRemoveRows( QModelIndex(), 0, this->rows.size()-1 );
    while (!this->rows.isEmpty() ) {
       disconnect(this->rows.takeLast().get(), nullptr, this, nullptr );
@@ -529,6 +568,21 @@ bool SaltTableModel::setData(QModelIndex const & index, QVariant const & value,
 }
 
 void SaltTableModel::saveAndClose() {
+   // Salts that replaceSalts() took out of the table now come out of the Recipe.  As in removeSalts(), they don't
+   // malinger in the database -- unless another Recipe (eg a previous version of this one) still uses them.
+   for (auto salt : this->replacedSalts) {
+      this->recObs->remove(salt);
+      bool const usedElsewhere = nullptr != ObjectStoreWrapper::findFirstMatching<Recipe>(
+         [salt](Recipe * rec) {
+            return rec->uses(*salt);
+         }
+      );
+      if (!usedElsewhere) {
+         ObjectStoreWrapper::hardDelete(*salt);
+      }
+   }
+   this->replacedSalts.clear();
+
    // all of the writes should have been instantaneous unless
    // we've added a new salt. Wonder if this will work?
    for (auto salt : this->rows) {
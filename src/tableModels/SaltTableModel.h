@@ -91,9 +91,18 @@ public:
 
    double total(Water::Ions ion) const;
    double total( Salt::Types type ) const;
+   //! \brief Weight of acid of the given type that goes in the mash (so not counting anything added only to the sparge)
    double totalAcidWeight(Salt::Types type) const;
 
    void removeSalts(QList<int>deadSalts);
+   /**
+    * \brief Remove all the salts and put \c salts in their place, naming each one after its type.  Used when the salts
+    *        have been worked out for the user (see \c WaterChemistrySolver).  This only changes what is in the table:
+    *        the Recipe loses its old salts in \c saveAndClose().
+    */
+   void replaceSalts(QList<std::shared_ptr<Salt>> salts);
+   //! \brief Undo any \c replaceSalts(), ie go back to showing the Recipe's salts
+   void restoreSalts();
    void saveAndClose();
 
 public slots:
@@ -106,6 +115,8 @@ signals:
 
 private:
    double spargePct;
+   //! Salts the Recipe has that \c replaceSalts() has taken out of the table
+   QList<std::shared_ptr<Salt>> replacedSalts;
    double multiplier(Salt & salt) const;
 };
 
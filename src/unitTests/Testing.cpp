@@ -23,15 +23,19 @@
  */
 #include "unitTests/Testing.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <exception>
 #include <iostream> // For std::cout
 #include <math.h>
 #include <memory>
+#include <vector>
 
 #include <xercesc/util/PlatformUtils.hpp>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QString>
 #include <QtTest/QtTest>
 #if QT_VERSION < QT_VERSION_CHECK(5,10,0)
@@ -42,21 +46,39 @@
 #include <QVector>
 
 #include "Algorithms.h"
+#include "BoundedUndoStack.h"
 #include "config.h"
 #include "database/ObjectStoreWrapper.h"
+#include "HeatCalculations.h"
 #include "Localization.h"
 #include "Logging.h"
+#include "measurement/AmountParser.h"
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
 #include "measurement/Measurement.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
+#include "model/BoilCurves.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
 #include "model/Mash.h"
+#include "model/MashSimulation.h"
 #include "model/MashStep.h"
+#include "model/Misc.h"
 #include "model/NamedParameterBundle.h"
 #include "model/Recipe.h"
+#include "model/RecipeSnapshot.h"
+#include "model/Style.h"
 #include "PersistentSettings.h"
+#include "RecipeBulkRecalc.h"
+#include "RecipeDisplaySnapshot.h"
+#include "RecipeFormatter.h"
+#include "RecipeSimilarity.h"
+#include "SimpleUndoableUpdate.h"
+#include "StyleIndex.h"
+#include "utils/ParallelFor.h"
+#include "WaterChemistrySolver.h"
 
 namespace {
 
@@ -747,6 +769,288 @@ void Testing::testAlgorithms() {
    return;
 }
 
+namespace {
+   // Same cubic as Algorithms uses internally for SG -> Plato
+   Polynomial const platoFromSgForTest { Polynomial() << -616.868 << 1111.14 << -630.272 << 135.997 };
+
+   //! \brief SG for \c plato the way \c Algorithms::PlatoToSG_20C20C used to do it, for comparison
+   double platoToSgByRootFinding(double const plato) {
+      Polynomial poly{platoFromSgForTest};
+      poly[0] -= plato;
+      return poly.rootFind(0.900, 1.150);
+   }
+}
+
+void Testing::testPlatoToSgConversion() {
+   // Horner evaluation should agree with the obvious way of doing it
+   for (double sg = 0.95; sg < 1.15; sg += 0.01) {
+      double const naive = -616.868 + 1111.14 * sg - 630.272 * sg * sg + 135.997 * sg * sg * sg;
+      QVERIFY2(fuzzyComp(platoFromSgForTest.eval(sg), naive, 1e-9), "Polynomial::eval mismatch");
+      QVERIFY2(
+         fuzzyComp(platoFromSgForTest.evalDerivative(sg), 1111.14 - 2 * 630.272 * sg + 3 * 135.997 * sg * sg, 1e-9),
+         "Polynomial::evalDerivative mismatch"
+      );
+   }
+
+   // Step through Plato in a way that doesn't line up with the table's own points.  Range is -28 to 34 Plato, which
+   // is roughly SG 0.900 to 1.150.
+   double maxError = 0.0;
+   for (double plato = -28.0; plato <= 34.0; plato += 0.0137) {
+      double const sg = Algorithms::PlatoToSG_20C20C(plato);
+      double const expected = platoToSgByRootFinding(plato);
+      maxError = std::max(maxError, std::abs(sg - expected));
+      QVERIFY2(fuzzyComp(sg, expected, 1e-9), "Table-driven Plato -> SG differs from root-finding");
+      QVERIFY2(fuzzyComp(Algorithms::SG_20C20C_toPlato(sg), plato, 1e-7), "Plato -> SG -> Plato round trip failed");
+   }
+   qDebug() << Q_FUNC_INFO << "Max difference from root-finding:" << maxError;
+
+   // Outside the table, we should still get the root-finding answer
+   QVERIFY2(fuzzyComp(Algorithms::PlatoToSG_20C20C(-40.0), platoToSgByRootFinding(-40.0), 1e-9), "Low Plato");
+   QVERIFY2(fuzzyComp(Algorithms::PlatoToSG_20C20C( 40.0), platoToSgByRootFinding( 40.0), 1e-9), "High Plato");
+   return;
+}
+
+void Testing::benchmarkPlatoToSg() {
+   // Warm up, so we don't count building the table
+   Algorithms::PlatoToSG_20C20C(12.0);
+
+   double total = 0.0;
+   QBENCHMARK {
+      for (double plato = 0.0; plato < 30.0; plato += 0.1) {
+         total += Algorithms::PlatoToSG_20C20C(plato);
+      }
+   }
+
+   // Time the old way too, so the two can be compared in the output
+   QElapsedTimer timer;
+   timer.start();
+   for (double plato = 0.0; plato < 30.0; plato += 0.1) {
+      total += platoToSgByRootFinding(plato);
+   }
+   qDebug() << Q_FUNC_INFO << "300 conversions by root-finding took" << timer.nsecsElapsed() << "ns";
+
+   QVERIFY(total > 0.0);
+   return;
+}
+
+namespace {
+   /**
+    * \brief A spread of hop additions covering the ranges we see in real recipes, including gravities either side of
+    *        the breakpoints in the Rager and Noonan formulae.
+    */
+   IbuMethods::HopAdditions hopAdditionsForTest() {
+      IbuMethods::HopAdditions hopAdditions;
+      for (double minutes = 0.0; minutes <= 90.0; minutes += 5.0) {
+         for (double const wort_grav : {1.030, 1.050, 1.0501, 1.065, 1.075, 1.085, 1.100, 1.120}) {
+            for (double const AArating : {0.03, 0.065, 0.15}) {
+               hopAdditions.append(AArating, 10.0 + minutes, 20.0 + 10.0 * AArating, wort_grav, minutes, 1.1);
+            }
+         }
+      }
+      return hopAdditions;
+   }
+}
+
+void Testing::testIbuBatch() {
+   IbuMethods::HopAdditions const hopAdditions = hopAdditionsForTest();
+   std::vector<double> ibus(hopAdditions.size());
+
+   IbuMethods::IbuType const oldIbuFormula = IbuMethods::ibuFormula;
+   for (auto const formula : {IbuMethods::TINSETH, IbuMethods::RAGER, IbuMethods::NOONAN}) {
+      IbuMethods::ibuFormula = formula;
+      IbuMethods::getIbus(hopAdditions, ibus.data());
+      for (std::size_t ii = 0; ii < hopAdditions.size(); ++ii) {
+         double const expected = hopAdditions.factor[ii] * IbuMethods::getIbus(hopAdditions.AArating[ii],
+                                                                               hopAdditions.hops_grams[ii],
+                                                                               hopAdditions.finalVolume_liters[ii],
+                                                                               hopAdditions.wort_grav[ii],
+                                                                               hopAdditions.minutes[ii]);
+         QVERIFY2(fuzzyComp(ibus[ii], expected, 1e-9 * std::max(1.0, std::abs(expected))),
+                  qPrintable(QString{"Formula %1, hop %2: batch %3, single %4"}
+                                .arg(formula).arg(ii).arg(ibus[ii]).arg(expected)));
+      }
+   }
+   IbuMethods::ibuFormula = oldIbuFormula;
+
+   // An empty batch should be fine too
+   IbuMethods::getIbus(IbuMethods::HopAdditions{}, nullptr);
+   return;
+}
+
+void Testing::benchmarkIbuBatch() {
+   IbuMethods::HopAdditions const hopAdditions = hopAdditionsForTest();
+   std::vector<double> ibus(hopAdditions.size());
+
+   double total = 0.0;
+   QBENCHMARK {
+      for (auto const formula : {IbuMethods::TINSETH, IbuMethods::RAGER, IbuMethods::NOONAN}) {
+         IbuMethods::getIbus(hopAdditions, ibus.data(), formula);
+         total += ibus.front();
+      }
+   }
+
+   // Time the one-hop-at-a-time way too, so the two can be compared in the output
+   IbuMethods::IbuType const oldIbuFormula = IbuMethods::ibuFormula;
+   QElapsedTimer timer;
+   timer.start();
+   for (auto const formula : {IbuMethods::TINSETH, IbuMethods::RAGER, IbuMethods::NOONAN}) {
+      IbuMethods::ibuFormula = formula;
+      for (std::size_t ii = 0; ii < hopAdditions.size(); ++ii) {
+         total += hopAdditions.factor[ii] * IbuMethods::getIbus(hopAdditions.AArating[ii],
+                                                                hopAdditions.hops_grams[ii],
+                                                                hopAdditions.finalVolume_liters[ii],
+                                                                hopAdditions.wort_grav[ii],
+                                                                hopAdditions.minutes[ii]);
+      }
+   }
+   qDebug() <<
+      Q_FUNC_INFO << 3 * hopAdditions.size() << "single-hop IBU calculations took" << timer.nsecsElapsed() << "ns";
+   IbuMethods::ibuFormula = oldIbuFormula;
+
+   QVERIFY(total > 0.0);
+   return;
+}
+
+void Testing::testRecipeSnapshotCalcs() {
+   //
+   // Because a RecipeSnapshot is just data, we can build one by hand, without any database or model objects:
+   // 20 liters of all-grain wort from 5kg of (mashed) grain with 70% yield, at 70% efficiency, with 75% attenuation.
+   //
+   RecipeSnapshot snapshot;
+   snapshot.key            = -1;
+   snapshot.name           = "Snapshot Test";
+   snapshot.batchSize_l    = 20.0;
+   snapshot.boilSize_l     = 25.0;
+   snapshot.efficiency_pct = 70.0;
+   snapshot.fermentables.append(RecipeSnapshot::Fermentable{
+      Fermentable::Type::Grain, 5.0, 2.0, 0.0, 5.0 * 0.70, true, false, true
+   });
+   snapshot.hops.append(RecipeSnapshot::Hop{Hop::Use::Boil, Hop::Form::Leaf, 4.0, 0.085, 60.0});
+   snapshot.yeasts.append(RecipeSnapshot::Yeast{75.0});
+   snapshot.firstWortHopAdjustment = 1.1;
+   snapshot.mashHopAdjustment      = 0.0;
+   snapshot.ibuFormula             = IbuMethods::TINSETH;
+   snapshot.colorFormula           = ColorMethods::MOREY;
+
+   QVERIFY2(fuzzyComp(RecipeCalcs::grainsInMash_kg(snapshot), 5.0, 0.0001), "Wrong grains in mash");
+   QVERIFY2(fuzzyComp(RecipeCalcs::grains_kg(snapshot),       5.0, 0.0001), "Wrong grains");
+
+   // With no equipment, there are no losses, so final volume is just the batch size
+   auto const volumes = RecipeCalcs::volumeEstimates(snapshot, RecipeCalcs::grainsInMash_kg(snapshot));
+   QVERIFY2(fuzzyComp(volumes.finalVolumeNoLosses_l, 20.0, 0.0001), "Wrong final volume (no losses)");
+
+   double const expectedOg = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(5.0 * 0.70 * 0.70, 20.0));
+   auto const gravities = RecipeCalcs::gravities(snapshot,
+                                                 RecipeCalcs::totalPoints(snapshot),
+                                                 volumes.wortFromMash_l,
+                                                 volumes.finalVolumeNoLosses_l);
+   QVERIFY2(fuzzyComp(gravities.og, expectedOg,                            0.0001), "Wrong OG");
+   QVERIFY2(fuzzyComp(gravities.fg, 1.0 + (expectedOg - 1.0) * 0.25,       0.0001), "Wrong FG");
+   QVERIFY2(fuzzyComp(gravities.og_fermentable, gravities.og,              0.0001), "Wrong fermentable OG");
+
+   // calcAll should give the same answers as the individual calculations
+   auto const results = RecipeCalcs::calcAll(snapshot);
+   QVERIFY2(fuzzyComp(results.gravities.og, gravities.og, 0.0001), "calcAll OG mismatch");
+   QVERIFY2(results.hopIbus.size() == snapshot.hops.size(), "Wrong number of per-hop IBUs");
+   QVERIFY2(
+      fuzzyComp(results.IBU,
+                RecipeCalcs::ibuFromHop(snapshot, snapshot.hops.at(0), gravities.og, volumes.finalVolumeNoLosses_l),
+                0.0001),
+      "calcAll IBU mismatch"
+   );
+   QVERIFY2(results.IBU > 0.0, "No IBUs from boil hop");
+
+   // The calculations should use the formulas captured in the snapshot, not whatever is selected now
+   IbuMethods::IbuType     const oldIbuFormula   = IbuMethods::ibuFormula;
+   ColorMethods::ColorType const oldColorFormula = ColorMethods::colorFormula;
+   IbuMethods::ibuFormula     = IbuMethods::RAGER;
+   ColorMethods::colorFormula = ColorMethods::MOSHER;
+   auto const resultsAfterSettingsChange = RecipeCalcs::calcAll(snapshot);
+   IbuMethods::ibuFormula     = oldIbuFormula;
+   ColorMethods::colorFormula = oldColorFormula;
+   QVERIFY2(fuzzyComp(resultsAfterSettingsChange.IBU, results.IBU, 0.0001), "IBU used selected formula");
+   QVERIFY2(fuzzyComp(resultsAfterSettingsChange.color_srm, results.color_srm, 0.0001), "Color used selected formula");
+
+   snapshot.ibuFormula   = IbuMethods::RAGER;
+   snapshot.colorFormula = ColorMethods::MOSHER;
+   auto const resultsWithOtherFormulas = RecipeCalcs::calcAll(snapshot);
+   QVERIFY2(!fuzzyComp(resultsWithOtherFormulas.IBU, results.IBU, 0.0001), "IBU ignored captured formula");
+   QVERIFY2(!fuzzyComp(resultsWithOtherFormulas.color_srm, results.color_srm, 0.0001),
+            "Color ignored captured formula");
+   return;
+}
+
+void Testing::testBoilCurves() {
+   //
+   // As in testRecipeSnapshotCalcs, but with equipment (so that there's evaporation), a mash (so that there's a boil
+   // volume), and a hop that goes in part way through the boil.
+   //
+   RecipeSnapshot snapshot;
+   snapshot.key            = -1;
+   snapshot.name           = "Boil Curves Test";
+   snapshot.batchSize_l    = 20.0;
+   snapshot.boilSize_l     = 25.0;
+   snapshot.efficiency_pct = 70.0;
+   snapshot.equipment      = RecipeSnapshot::Equipment{60.0, 4.0, 1.0, 100.0, 0.0, 0.0, 0.0, 0.0};
+   snapshot.mash           = RecipeSnapshot::Mash{30.0};
+   snapshot.fermentables.append(RecipeSnapshot::Fermentable{
+      Fermentable::Type::Grain, 5.0, 2.0, 0.0, 5.0 * 0.70, true, false, true
+   });
+   snapshot.hops.append(RecipeSnapshot::Hop{Hop::Use::Boil,  Hop::Form::Pellet, 10.0, 0.020, 60.0});
+   snapshot.hops.append(RecipeSnapshot::Hop{Hop::Use::Boil,  Hop::Form::Leaf,    5.0, 0.030, 15.0});
+   snapshot.hops.append(RecipeSnapshot::Hop{Hop::Use::Aroma, Hop::Form::Leaf,    5.0, 0.030,  0.0});
+   snapshot.yeasts.append(RecipeSnapshot::Yeast{75.0});
+   snapshot.firstWortHopAdjustment = 1.1;
+   snapshot.mashHopAdjustment      = 0.0;
+   snapshot.ibuFormula             = IbuMethods::TINSETH;
+   snapshot.colorFormula           = ColorMethods::MOREY;
+
+   BoilCurves::Options options;
+   options.step_min     = 5.0;
+   options.hopStand_min = 20.0;
+   BoilCurves curves{snapshot, options};
+
+   // Every 5 minutes from 0 to 80 inclusive
+   QCOMPARE(curves.numSamples(), 17);
+   QVERIFY(fuzzyComp(curves.boilTime_min(), 60.0, 0.0001));
+   int const endOfBoil = 12;
+   QVERIFY(fuzzyComp(curves.minutes().at(endOfBoil), 60.0, 0.0001));
+
+   // At the end of the boil, we should have exactly what the recipe calculations give
+   auto const results = RecipeCalcs::calcAll(snapshot);
+   QVERIFY(fuzzyComp(curves.ibus().at(endOfBoil),      results.IBU,                                        0.0001));
+   QVERIFY(fuzzyComp(curves.volumes_l().at(endOfBoil), results.volumes.postBoilVolume_l,                   0.0001));
+   QVERIFY(fuzzyComp(curves.volumes_l().at(0),         results.volumes.boilVolume_l,                       0.0001));
+   QVERIFY(fuzzyComp(curves.gravities().at(0),         results.boilGrav,                                   0.0001));
+   QVERIFY(fuzzyComp(curves.hopIbus(1).at(endOfBoil),  results.hopIbus.at(1),                              0.0001));
+
+   // Nothing before the late hop goes in, and the aroma hop only counts in the hop stand
+   QVERIFY(fuzzyComp(curves.hopIbus(1).at(9), 0.0, 0.0001));
+   QVERIFY(curves.hopIbus(1).at(10) > 0.0);
+   QVERIFY(fuzzyComp(curves.hopIbus(2).at(endOfBoil), 0.0, 0.0001));
+   QVERIFY(curves.hopIbus(2).last() > 0.0);
+   for (int ii = 1; ii < curves.numSamples(); ++ii) {
+      QVERIFY(curves.ibus().at(ii)      >= curves.ibus().at(ii - 1));
+      QVERIFY(curves.gravities().at(ii) >= curves.gravities().at(ii - 1));
+   }
+
+   // Updating one hop should give the same as starting again
+   RecipeSnapshot::Hop const changedHop{Hop::Use::Boil, Hop::Form::Leaf, 5.0, 0.040, 30.0};
+   QVERIFY(curves.canUpdateFrom(snapshot));
+   curves.updateHop(1, changedHop);
+   snapshot.hops[1] = changedHop;
+   BoilCurves const fromScratch{snapshot, options};
+   for (int ii = 0; ii < curves.numSamples(); ++ii) {
+      QVERIFY(fuzzyComp(curves.ibus().at(ii), fromScratch.ibus().at(ii), 0.0001));
+   }
+
+   // ...but something that changes gravity needs a full recalculation
+   snapshot.fermentables[0].amount_kg = 6.0;
+   QVERIFY(!curves.canUpdateFrom(snapshot));
+
+   return;
+}
+
 void Testing::testTypeLookups() {
 ///   QVERIFY2(Hop::typeLookup.getType(PropertyNames::Hop::alpha_pct).typeIndex == typeid(double),
 ///            "PropertyNames::Hop::alpha_pct not a double");
@@ -755,6 +1059,19 @@ void Testing::testTypeLookups() {
 ///            "PropertyNames::Fermentable::grainGroup not optional");
 ///   QVERIFY2(grainGroupTypeInfo.classification == TypeInfo::Classification::OptionalEnum,
 ///            "PropertyNames::Fermentable::grainGroup not optional enum");
+
+   // Typed access to stored values should see what the setters stored, and refuse to give us the wrong type
+   Hop hop{"Typed access test"};
+   hop.setAlpha_pct(6.5);
+   hop.setName("Typed access test hop");
+   double const * alpha_pct = hop.storedValue<double>(PropertyNames::Hop::alpha_pct);
+   QVERIFY(alpha_pct);
+   QCOMPARE(*alpha_pct, 6.5);
+   QString const * name = hop.storedValue<QString>(PropertyNames::NamedEntity::name);
+   QVERIFY(name);
+   QCOMPARE(*name, QString{"Typed access test hop"});
+   QVERIFY(!hop.storedValue<int>(PropertyNames::Hop::alpha_pct));
+   QCOMPARE(hop.storedValueAsVariant(PropertyNames::Hop::alpha_pct), hop.property(*PropertyNames::Hop::alpha_pct));
    return;
 }
 void Testing::testLogRotation() {
@@ -775,6 +1092,9 @@ void Testing::testLogRotation() {
    // Put logging back to normal
    Logging::setLoggingToStderr(true);
 
+   // Messages are written out on a background thread, so make sure they've all made it to disk before we look
+   Logging::flush();
+
 
    QFileInfoList fileList = Logging::getLogFileList();
    qDebug() << Q_FUNC_INFO << "Logging::getLogFileList() has" << fileList.size() << "entries";
@@ -792,6 +1112,162 @@ void Testing::testLogRotation() {
    return;
 }
 
+void Testing::benchmarkLogging() {
+   // NB: We don't want to overwrite whatever logging level is stored in the settings, so we don't persist any of the
+   //     changes we make here, and we put things back how they were at the end.
+   Logging::Level const savedLevel = Logging::getLogLevel();
+   Logging::setLoggingToStderr(false);
+
+   // Enabled debug logging, as eg during an import with the logging level set to DEBUG
+   Logging::setLogLevel(Logging::LogLevel_DEBUG, false);
+   QVERIFY(Logging::xml().isDebugEnabled());
+   QBENCHMARK {
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Found" << 1 << "node(s) for " << "RECIPES/RECIPE/HOPS/HOP/ALPHA";
+   }
+   Logging::flush();
+
+   // The same message with debug logging turned off shouldn't cost anything much
+   Logging::setLogLevel(Logging::LogLevel_INFO, false);
+   QVERIFY(!Logging::xml().isDebugEnabled());
+   QBENCHMARK {
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Found" << 1 << "node(s) for " << "RECIPES/RECIPE/HOPS/HOP/ALPHA";
+   }
+
+   Logging::setLogLevel(savedLevel, false);
+   Logging::setLoggingToStderr(true);
+   return;
+}
+
+void Testing::testAmountParser() {
+   auto const & parser = Measurement::AmountParser::getInstance();
+   QString const decimalPoint   = Localization::getLocale().decimalPoint();
+   QString const groupSeparator = Localization::getLocale().groupSeparator();
+
+   QString const gallons = QString{"5%1500 gal"}.arg(decimalPoint);
+   auto result = parser.parse(gallons);
+   QVERIFY(result.found);
+   QVERIFY(result.converted);
+   QVERIFY(qFuzzyCompare(result.quantity, 5.5));
+   QCOMPARE(result.unitName(gallons).toString(), QString{"gal"});
+
+   // Leading decimal point and no space before the unit
+   QString const kilograms = QString{"%15kg"}.arg(decimalPoint);
+   result = parser.parse(kilograms);
+   QVERIFY(result.converted);
+   QVERIFY(qFuzzyCompare(result.quantity, 0.5));
+   QCOMPARE(result.unitName(kilograms).toString(), QString{"kg"});
+
+   // Group separator (which goes via Localization::toDouble)
+   QString const grams = QString{"1%1234%25 g"}.arg(groupSeparator, decimalPoint);
+   result = parser.parse(grams);
+   QVERIFY(result.converted);
+   QVERIFY(qFuzzyCompare(result.quantity, 1234.5));
+   QCOMPARE(result.unitName(grams).toString(), QString{"g"});
+
+   // No number, and no unit
+   QVERIFY(!parser.parse("abc").found);
+   result = parser.parse("12");
+   QVERIFY(result.converted);
+   QVERIFY(!result.hasUnit());
+   QVERIFY(qFuzzyCompare(result.quantity, 12.0));
+
+   // Unit names are matched case-insensitively by default
+   QCOMPARE(Measurement::Unit::getUnit("ML", Measurement::PhysicalQuantity::Volume), &Measurement::Units::milliliters);
+   QVERIFY(!Measurement::Unit::getUnit("ML", Measurement::PhysicalQuantity::Volume, false));
+   return;
+}
+
+void Testing::benchmarkAmountParsing() {
+   QString const amount = QString{"5%1500 gal"}.arg(Localization::getLocale().decimalPoint());
+   QBENCHMARK {
+      Measurement::qStringToSI(amount, Measurement::PhysicalQuantity::Volume);
+   }
+   return;
+}
+
+void Testing::testBoundedUndoStack() {
+   // QObject's objectName is a Q_PROPERTY, so we can use it for undoable updates without needing the database
+   BtStringConst const objectName{"objectName"};
+   QObject first;
+   QObject second;
+   first.setObjectName("a");
+   second.setObjectName("x");
+
+   // Consecutive edits of the same property merge into one command that undoes all of them
+   BoundedUndoStack stack{3, BoundedUndoStack::defaultMaxMemory_bytes};
+   stack.push(new SimpleUndoableUpdate(first, objectName, "b", "Change name"));
+   stack.push(new SimpleUndoableUpdate(first, objectName, "c", "Change name"));
+   QCOMPARE(first.objectName(), QString{"c"});
+   QCOMPARE(stack.count(), 1);
+   QCOMPARE(stack.numMerged(), 1);
+   stack.undo();
+   QCOMPARE(first.objectName(), QString{"a"});
+   QVERIFY(!stack.canUndo());
+   stack.redo();
+   QCOMPARE(first.objectName(), QString{"c"});
+
+   // Editing back to the original value leaves nothing to undo
+   stack.push(new SimpleUndoableUpdate(first, objectName, "a", "Change name"));
+   QCOMPARE(first.objectName(), QString{"a"});
+   QCOMPARE(stack.count(), 0);
+   QCOMPARE(stack.memoryUsage_bytes(), std::size_t{0});
+
+   // Edits to different objects don't merge, and the oldest are thrown away once we go over the command limit
+   for (int ii = 0; ii < 5; ++ii) {
+      stack.push(new SimpleUndoableUpdate(ii % 2 ? second : first, objectName, QString::number(ii), "Change name"));
+   }
+   QCOMPARE(stack.count(), 3);
+   QCOMPARE(stack.numEvicted(), 2);
+   QVERIFY(stack.memoryUsage_bytes() > 0);
+   stack.undo();
+   stack.undo();
+   stack.undo();
+   QVERIFY(!stack.canUndo());
+   // The first two edits (to "0" and "1") are gone, so we can only get back as far as them
+   QCOMPARE(first.objectName(), QString{"0"});
+   QCOMPARE(second.objectName(), QString{"1"});
+
+   // Pushing after an undo throws away what could have been redone
+   stack.redo();
+   QVERIFY(stack.canRedo());
+   stack.push(new SimpleUndoableUpdate(second, objectName, "y", "Change name"));
+   QVERIFY(!stack.canRedo());
+
+   // With a tiny memory limit, only the most recent command is kept
+   BoundedUndoStack tinyStack{100, 1};
+   tinyStack.push(new SimpleUndoableUpdate(first,  objectName, "p", "Change name"));
+   tinyStack.push(new SimpleUndoableUpdate(second, objectName, "q", "Change name"));
+   QCOMPARE(tinyStack.count(), 1);
+   QCOMPARE(tinyStack.numEvicted(), 1);
+
+   // Edits with child commands (eg a step temperature edit that also moves the end temperature) don't merge, as each
+   // has to undo its children as well as itself
+   first.setObjectName("a");
+   second.setObjectName("x");
+   BoundedUndoStack childStack{10, BoundedUndoStack::defaultMaxMemory_bytes};
+   auto withChild = new SimpleUndoableUpdate(first, objectName, "b", "Change names");
+   new SimpleUndoableUpdate(second, objectName, "y", "Change names", withChild);
+   childStack.push(withChild);
+   withChild = new SimpleUndoableUpdate(first, objectName, "c", "Change names");
+   new SimpleUndoableUpdate(second, objectName, "z", "Change names", withChild);
+   childStack.push(withChild);
+   childStack.push(new SimpleUndoableUpdate(first, objectName, "d", "Change name"));
+   QCOMPARE(first.objectName(), QString{"d"});
+   QCOMPARE(second.objectName(), QString{"z"});
+   QCOMPARE(childStack.count(), 3);
+   QCOMPARE(childStack.numMerged(), 0);
+   childStack.undo();
+   QCOMPARE(first.objectName(), QString{"c"});
+   QCOMPARE(second.objectName(), QString{"z"});
+   childStack.undo();
+   QCOMPARE(first.objectName(), QString{"b"});
+   QCOMPARE(second.objectName(), QString{"y"});
+   childStack.undo();
+   QCOMPARE(first.objectName(), QString{"a"});
+   QCOMPARE(second.objectName(), QString{"x"});
+   return;
+}
+
 void Testing::cleanupTestCase() {
    Application::cleanup();
    Logging::terminateLogging();
@@ -848,3 +1324,565 @@ void Testing::runTest() {
    QVERIFY( mw );
    */
 }
+
+void Testing::testCopyOnWriteVersioning() {
+   auto recipe = std::make_shared<Recipe>(QString{"Copy-on-write versioning"});
+   ObjectStoreWrapper::insert(recipe);
+
+   auto hop = std::make_shared<Hop>();
+   hop->setName("Versioned hop");
+   hop->setAmount_kg(0.010);
+   ObjectStoreWrapper::insert(hop);
+   auto hopInRecipe = recipe->add(hop);
+
+   auto fermentable = std::make_shared<Fermentable>();
+   fermentable->setName("Versioned fermentable");
+   fermentable->setAmount_kg(4.0);
+   ObjectStoreWrapper::insert(fermentable);
+   auto fermentableInRecipe = recipe->add(fermentable);
+
+   // Versioning only kicks in once the Recipe has been brewed
+   auto brewNote = std::make_shared<BrewNote>(*recipe);
+   ObjectStoreWrapper::insert(brewNote);
+
+   bool const wasVersioningEnabled = RecipeHelper::getAutomaticVersioningEnabled();
+   RecipeHelper::setAutomaticVersioningEnabled(true);
+   int const numFermentablesBefore = ObjectStoreWrapper::getAll<Fermentable>().size();
+   hopInRecipe->setAmount_kg(0.020);
+   int const numFermentablesAfter = ObjectStoreWrapper::getAll<Fermentable>().size();
+   RecipeHelper::setAutomaticVersioningEnabled(wasVersioningEnabled);
+
+   // We should have a previous version...
+   QCOMPARE(recipe->ancestors().size(), 1);
+   Recipe const * previousVersion = recipe->ancestors().at(0);
+
+   // ...that shares the unchanged fermentable rather than having its own copy...
+   QVERIFY(previousVersion->uses(*fermentableInRecipe));
+   QCOMPARE(numFermentablesAfter, numFermentablesBefore);
+   QCOMPARE(fermentableInRecipe->getOwningRecipe(), recipe.get());
+
+   // ...but has its own copy of the hop, with the amount from before the change
+   QVERIFY(!previousVersion->uses(*hopInRecipe));
+   QCOMPARE(previousVersion->hops().size(), 1);
+   QVERIFY(fuzzyComp(previousVersion->hops().at(0)->amount_kg(), 0.010, 0.0001));
+   QVERIFY(fuzzyComp(hopInRecipe->amount_kg(),                    0.020, 0.0001));
+   return;
+}
+
+void Testing::testVersionedMashStep() {
+   auto recipe = std::make_shared<Recipe>(QString{"Versioned mash step"});
+   ObjectStoreWrapper::insert(recipe);
+   auto mash = std::make_shared<Mash>("Versioned mash");
+   ObjectStoreWrapper::insert(mash);
+   recipe->setMash(mash);
+   auto firstStep = std::make_shared<MashStep>("Versioned mash first step");
+   firstStep->setStepTemp_c(65.0);
+   mash->addMashStep(firstStep);
+   QCOMPARE(mash->mashSteps().size(), 1);
+
+   // Versioning only kicks in once the Recipe has been brewed
+   auto brewNote = std::make_shared<BrewNote>(*recipe);
+   ObjectStoreWrapper::insert(brewNote);
+
+   bool const wasVersioningEnabled = RecipeHelper::getAutomaticVersioningEnabled();
+   RecipeHelper::setAutomaticVersioningEnabled(true);
+   auto secondStep = std::make_shared<MashStep>("Versioned mash second step");
+   secondStep->setStepTemp_c(76.0);
+   recipe->mash()->addMashStep(secondStep);
+   RecipeHelper::setAutomaticVersioningEnabled(wasVersioningEnabled);
+
+   // The new step is in the current version...
+   QCOMPARE(recipe->mash()->mashSteps().size(), 2);
+
+   // ...but not in the previous one, which now has its own Mash
+   QCOMPARE(recipe->ancestors().size(), 1);
+   Recipe const * previousVersion = recipe->ancestors().at(0);
+   QVERIFY(!previousVersion->uses(*recipe->mash()));
+   QVERIFY(previousVersion->mash());
+   QCOMPARE(previousVersion->mash()->mashSteps().size(), 1);
+   return;
+}
+
+void Testing::testVersionedMashStepRemoval() {
+   //
+   // Make a brewed Recipe with a two-step Mash, then remove steps from its Mash with versioning on.  We do this once
+   // for Mash::removeMashStep() and once for Mash::removeAllMashSteps().
+   //
+   auto makeBrewedRecipe = [](QString const & name) {
+      auto recipe = std::make_shared<Recipe>(name);
+      ObjectStoreWrapper::insert(recipe);
+      auto mash = std::make_shared<Mash>(name);
+      ObjectStoreWrapper::insert(mash);
+      recipe->setMash(mash);
+      mash->addMashStep(std::make_shared<MashStep>(name + " first step"));
+      mash->addMashStep(std::make_shared<MashStep>(name + " second step"));
+      ObjectStoreWrapper::insert(std::make_shared<BrewNote>(*recipe));
+      return recipe;
+   };
+   auto oneStepRemoved = makeBrewedRecipe("Versioned mash step removal");
+   auto allStepsRemoved = makeBrewedRecipe("Versioned mash all steps removal");
+
+   bool const wasVersioningEnabled = RecipeHelper::getAutomaticVersioningEnabled();
+   RecipeHelper::setAutomaticVersioningEnabled(true);
+   oneStepRemoved->mash()->removeMashStep(oneStepRemoved->mash()->mashSteps().at(1));
+   allStepsRemoved->mash()->removeAllMashSteps();
+   RecipeHelper::setAutomaticVersioningEnabled(wasVersioningEnabled);
+
+   // The steps are gone from the current versions...
+   QCOMPARE(oneStepRemoved->mash()->mashSteps().size(), 1);
+   QCOMPARE(allStepsRemoved->mash()->mashSteps().size(), 0);
+
+   // ...but the previous versions have their own Mash, with all its steps
+   for (auto recipe : {oneStepRemoved, allStepsRemoved}) {
+      QCOMPARE(recipe->ancestors().size(), 1);
+      Recipe const * previousVersion = recipe->ancestors().at(0);
+      QVERIFY(!previousVersion->uses(*recipe->mash()));
+      QVERIFY(previousVersion->mash());
+      QCOMPARE(previousVersion->mash()->mashSteps().size(), 2);
+   }
+   return;
+}
+
+void Testing::testRecipeDisplaySnapshot() {
+   auto recipe = std::make_shared<Recipe>(QString{"Display snapshot"});
+   ObjectStoreWrapper::insert(recipe);
+   auto misc = recipe->add<Misc>(std::make_shared<Misc>(QString{"Irish moss"}));
+
+   // Until something caches the Recipe's formatted output, changes to things that are only displayed (not calculated
+   // with) don't need to bump the generation
+   unsigned int const generationBeforeSnapshot = recipe->generation();
+   misc->setName("Whirlfloc");
+   QCOMPARE(recipe->generation(), generationBeforeSnapshot);
+
+   // Taking a snapshot connects those signals, so from then on they do
+   RecipeDisplaySnapshot const snapshot = RecipeDisplaySnapshot::create(*recipe);
+   QCOMPARE(snapshot.generation, recipe->generation());
+   QCOMPARE(snapshot.miscs.size(), 1);
+   QCOMPARE(snapshot.miscs.at(0).name, QString{"Whirlfloc"});
+   QVERIFY(RecipeFormatter::getHtmlFormat(snapshot).contains("Whirlfloc"));
+
+   misc->setName("Protafloc");
+   QVERIFY(recipe->generation() != snapshot.generation);
+
+   // So the cached HTML isn't reused for the changed Recipe
+   QString const html = RecipeFormatter::getHtmlFormat(RecipeDisplaySnapshot::create(*recipe));
+   QVERIFY(html.contains("Protafloc"));
+   QVERIFY(!html.contains("Whirlfloc"));
+   return;
+}
+
+void Testing::testRecipeEditSession() {
+   auto recipe = std::make_shared<Recipe>(QString{"Edit session"});
+   ObjectStoreWrapper::insert(recipe);
+
+   auto fermentable = std::make_shared<Fermentable>();
+   fermentable->setName("Edit session fermentable");
+   fermentable->setType(Fermentable::Type::Grain);
+   fermentable->setAmount_kg(4.0);
+   ObjectStoreWrapper::insert(fermentable);
+   auto fermentableInRecipe = recipe->add(fermentable);
+   QVERIFY(fuzzyComp(recipe->grains_kg(), 4.0, 0.0001));
+
+   // Count the signals for just the property we're changing
+   int numAmountSignals = 0;
+   auto const connection = connect(fermentableInRecipe.get(), &NamedEntity::changed, this, [&numAmountSignals](QMetaProperty prop) {
+      if (prop.name() == QString{*PropertyNames::Fermentable::amount_kg}) {
+         ++numAmountSignals;
+      }
+   });
+
+   {
+      Recipe::EditSession editSession{*recipe};
+      fermentableInRecipe->setAmount_kg(5.0);
+      {
+         // A nested session should just be part of the outer one
+         Recipe::EditSession nestedEditSession{*recipe};
+         fermentableInRecipe->setAmount_kg(6.0);
+      }
+
+      // New values are visible straight away, but nothing is signalled or recalculated until the end
+      QVERIFY(fuzzyComp(fermentableInRecipe->amount_kg(), 6.0, 0.0001));
+      QCOMPARE(numAmountSignals, 0);
+      QVERIFY(fuzzyComp(recipe->grains_kg(), 4.0, 0.0001));
+
+      editSession.commit();
+      QCOMPARE(numAmountSignals, 1);
+      QVERIFY(fuzzyComp(recipe->grains_kg(), 6.0, 0.0001));
+   }
+
+   // Once the session is over, changes go through as normal
+   fermentableInRecipe->setAmount_kg(7.0);
+   QCOMPARE(numAmountSignals, 2);
+   QVERIFY(fuzzyComp(recipe->grains_kg(), 7.0, 0.0001));
+   disconnect(connection);
+   return;
+}
+
+void Testing::testParallelFor() {
+   // Every index should be visited exactly once, whatever the number of threads and chunk size
+   for (int const numThreads : {1, 2, 4, 16}) {
+      for (int const chunkSize : {1, 7, 1000}) {
+         int const count = 1001;
+         std::vector<std::atomic<int>> visits(count);
+         ParallelFor::forEachIndex(count,
+                                   [&visits](int const ii) { visits[static_cast<std::size_t>(ii)].fetch_add(1); },
+                                   numThreads,
+                                   chunkSize);
+         QVERIFY(std::all_of(visits.cbegin(), visits.cend(), [](std::atomic<int> const & v) { return v.load() == 1; }));
+      }
+   }
+
+   // Nothing to do should be fine too
+   ParallelFor::forEachIndex(0, [](int) { QFAIL("Should not be called"); });
+   return;
+}
+
+void Testing::testBulkRecalc() {
+   auto recipe = std::make_shared<Recipe>(QString{"Bulk recalculation"});
+   ObjectStoreWrapper::insert(recipe);
+   recipe->setBatchSize_l(20.0);
+   recipe->setBoilSize_l(25.0);
+
+   auto hop = std::make_shared<Hop>();
+   hop->setName("Bulk recalculation hop");
+   hop->setAlpha_pct(5.0);
+   hop->setAmount_kg(0.030);
+   hop->setUse(Hop::Use::Boil);
+   hop->setTime_min(60);
+   ObjectStoreWrapper::insert(hop);
+   recipe->add(hop);
+
+   auto fermentable = std::make_shared<Fermentable>();
+   fermentable->setName("Bulk recalculation fermentable");
+   fermentable->setType(Fermentable::Type::Grain);
+   fermentable->setYield_pct(75.0);
+   fermentable->setAmount_kg(4.0);
+   ObjectStoreWrapper::insert(fermentable);
+   recipe->add(fermentable);
+
+   // Changing the formula doesn't, by itself, change anything we've already calculated...
+   double const ibuBefore = recipe->IBU();
+   IbuMethods::IbuType const oldIbuFormula = IbuMethods::ibuFormula;
+   IbuMethods::ibuFormula = (oldIbuFormula == IbuMethods::TINSETH) ? IbuMethods::RAGER : IbuMethods::TINSETH;
+   QVERIFY(fuzzyComp(recipe->IBU(), ibuBefore, 0.0001));
+
+   // ...but a bulk recalculation should give us the same as calculating this one Recipe from scratch
+   RecipeBulkRecalc::Stats const stats = RecipeBulkRecalc::recalcAll(4);
+   QVERIFY(stats.numRecipes >= 1);
+   QVERIFY(stats.numChanged >= 1);
+   RecipeCalcs::Results const expected = RecipeCalcs::calcAll(RecipeSnapshot::create(*recipe));
+   QVERIFY(!fuzzyComp(recipe->IBU(), ibuBefore, 0.0001));
+   QVERIFY(fuzzyComp(recipe->IBU(), expected.IBU,          0.0001));
+   QVERIFY(fuzzyComp(recipe->og(),  expected.gravities.og, 0.0001));
+   QVERIFY(fuzzyComp(recipe->fg(),  expected.gravities.fg, 0.0001));
+
+   // Doing it again shouldn't change anything
+   QCOMPARE(RecipeBulkRecalc::recalcAll(4).numChanged, 0);
+
+   IbuMethods::ibuFormula = oldIbuFormula;
+   RecipeBulkRecalc::recalcAll(4);
+   QVERIFY(fuzzyComp(recipe->IBU(), ibuBefore, 0.0001));
+   return;
+}
+
+void Testing::testStyleIndex() {
+   auto recipe = std::make_shared<Recipe>(QString{"Style index"});
+   ObjectStoreWrapper::insert(recipe);
+   recipe->setBatchSize_l(20.0);
+   recipe->setBoilSize_l(25.0);
+
+   auto hop = std::make_shared<Hop>();
+   hop->setName("Style index hop");
+   hop->setAlpha_pct(5.0);
+   hop->setAmount_kg(0.030);
+   hop->setUse(Hop::Use::Boil);
+   hop->setTime_min(60);
+   ObjectStoreWrapper::insert(hop);
+   // The recipe gets its own copy of the hop, so that's the one we need to change later
+   auto recipeHop = recipe->add(hop);
+
+   auto fermentable = std::make_shared<Fermentable>();
+   fermentable->setName("Style index fermentable");
+   fermentable->setType(Fermentable::Type::Grain);
+   fermentable->setYield_pct(75.0);
+   fermentable->setAmount_kg(4.0);
+   fermentable->setColor_srm(5.0);
+   ObjectStoreWrapper::insert(fermentable);
+   recipe->add(fermentable);
+
+   // A style that fits the recipe, leaving the color range unspecified
+   auto style = std::make_shared<Style>(QString{"Style index style"});
+   style->setOgMin (recipe->og()  - 0.005);
+   style->setOgMax (recipe->og()  + 0.005);
+   style->setFgMin (recipe->fg()  - 0.005);
+   style->setFgMax (recipe->fg()  + 0.005);
+   style->setIbuMin(recipe->IBU() - 5.0);
+   style->setIbuMax(recipe->IBU() + 5.0);
+   style->setAbvMin_pct(recipe->ABV_pct() - 1.0);
+   style->setAbvMax_pct(recipe->ABV_pct() + 1.0);
+   ObjectStoreWrapper::insert(style);
+
+   StyleIndex & styleIndex = StyleIndex::getInstance();
+   QCOMPARE(styleIndex.conformance(recipe->key()), StyleIndex::Conformance::NoStyle);
+   QVERIFY(styleIndex.stylesMatching(recipe->key()).contains(style->key()));
+   QVERIFY(styleIndex.recipesMatching(style->key()).contains(recipe->key()));
+
+   // The recipe gets its own copy of the style, which the index should pick up
+   recipe->setStyle(style.get());
+   QVERIFY(recipe->style() != nullptr);
+   QCOMPARE(styleIndex.conformance(recipe->key()), StyleIndex::Conformance::InStyle);
+   QVERIFY(!styleIndex.recipesOutOfStyle().contains(recipe->key()));
+   // Copies of a style aren't offered as matches
+   QVERIFY(recipe->style()->key() != style->key());
+   QVERIFY(!styleIndex.stylesMatching(recipe->key()).contains(recipe->style()->key()));
+   QVERIFY( styleIndex.stylesMatching(recipe->key()).contains(style->key()));
+
+   // Changing the recipe's style should take it out of style...
+   recipe->style()->setIbuMax(recipe->IBU() - 1.0);
+   QCOMPARE(styleIndex.conformance(recipe->key()), StyleIndex::Conformance::OutOfStyle);
+   QVERIFY(styleIndex.recipesOutOfStyle().contains(recipe->key()));
+
+   // ...and changing the recipe should bring it back in
+   recipeHop->setAmount_kg(0.001);
+   recipe->style()->setIbuMin(0.0);
+   QVERIFY(recipe->IBU() < recipe->style()->ibuMax());
+   QCOMPARE(styleIndex.conformance(recipe->key()), StyleIndex::Conformance::InStyle);
+
+   // Deleted recipes drop out of the index
+   ObjectStoreWrapper::softDelete(*recipe);
+   QVERIFY(!styleIndex.recipesMatching(style->key()).contains(recipe->key()));
+   QCOMPARE(styleIndex.conformance(recipe->key()), StyleIndex::Conformance::NoStyle);
+   return;
+}
+
+namespace {
+   /**
+    * \brief Make a simple recipe with one malt and one hop for testRecipeSimilarity
+    */
+   std::shared_ptr<Recipe> similarityTestRecipe(QString const & name,
+                                                QString const & maltName,
+                                                double const malt_kg,
+                                                double const hop_kg) {
+      auto recipe = std::make_shared<Recipe>(name);
+      ObjectStoreWrapper::insert(recipe);
+      recipe->setBatchSize_l(20.0);
+      recipe->setBoilSize_l(25.0);
+
+      auto fermentable = std::make_shared<Fermentable>(maltName);
+      fermentable->setType(Fermentable::Type::Grain);
+      fermentable->setYield_pct(75.0);
+      fermentable->setColor_srm(4.0);
+      fermentable->setAmount_kg(malt_kg);
+      ObjectStoreWrapper::insert(fermentable);
+      recipe->add(fermentable);
+
+      auto hop = std::make_shared<Hop>(QString{"Similarity hop"});
+      hop->setAlpha_pct(6.0);
+      hop->setAmount_kg(hop_kg);
+      hop->setUse(Hop::Use::Boil);
+      hop->setTime_min(60);
+      ObjectStoreWrapper::insert(hop);
+      recipe->add(hop);
+      return recipe;
+   }
+}
+
+void Testing::testRecipeSimilarity() {
+   auto original  = similarityTestRecipe("Similarity original",  "Similarity pale malt",     4.0, 0.030);
+   auto nearCopy  = similarityTestRecipe("Similarity near copy", "Similarity pale malt",     4.1, 0.031);
+   auto different = similarityTestRecipe("Similarity different", "Similarity crystal malt", 7.0, 0.090);
+
+   // The same recipe gives the same vector
+   QVERIFY(RecipeSimilarity::featuresOf(*original) == RecipeSimilarity::featuresOf(*original));
+
+   RecipeSimilarity & recipeSimilarity = RecipeSimilarity::getInstance();
+   QVector<RecipeSimilarity::Match> matches = recipeSimilarity.findSimilar(original->key(), 3);
+   QCOMPARE(matches.size(), std::min(3, recipeSimilarity.size() - 1));
+   QCOMPARE(matches.first().recipeId, nearCopy->key());
+   for (int ii = 0; ii < matches.size(); ++ii) {
+      // Never includes the recipe we asked about, and closest comes first
+      QVERIFY(matches.at(ii).recipeId != original->key());
+      QVERIFY(ii == 0 || matches.at(ii - 1).distance <= matches.at(ii).distance);
+   }
+
+   // Searching for the vector itself should find the recipe it came from, at no distance
+   matches = recipeSimilarity.findNearest(RecipeSimilarity::featuresOf(*different), 1);
+   QCOMPARE(matches.size(), 1);
+   QCOMPARE(matches.first().recipeId, different->key());
+   QVERIFY(matches.first().distance < 0.0001f);
+
+   // If the near copy changes a lot, it shouldn't be nearest any more
+   float const nearCopyDistance = recipeSimilarity.findSimilar(original->key(), 1).first().distance;
+   nearCopy->getAll<Hop>().first()->setAmount_kg(0.300);
+   nearCopy->getAll<Hop>().first()->setUse(Hop::Use::Dry_Hop);
+   matches = recipeSimilarity.findSimilar(original->key(), recipeSimilarity.size());
+   for (auto const & match : matches) {
+      if (match.recipeId == nearCopy->key()) {
+         QVERIFY(match.distance > nearCopyDistance);
+      }
+   }
+
+   // Deleted recipes aren't returned
+   ObjectStoreWrapper::softDelete(*nearCopy);
+   matches = recipeSimilarity.findSimilar(original->key(), recipeSimilarity.size());
+   for (auto const & match : matches) {
+      QVERIFY(match.recipeId != nearCopy->key());
+   }
+   return;
+}
+
+void Testing::testGenerateInstructions() {
+   auto recipe = similarityTestRecipe("Instructions test", "Instructions pale malt", 4.0, 0.030);
+   // Need an equipment, otherwise generating instructions asks the user for the boil time
+   recipe->setEquipment(this->equipFiveGalNoLoss.get());
+
+   recipe->generateInstructions();
+   QVector<int> const firstIds = recipe->getInstructionIds();
+   QVERIFY(firstIds.size() > 0);
+
+   // Nothing has changed, so we should get back the same instructions
+   recipe->generateInstructions();
+   QCOMPARE(recipe->getInstructionIds(), firstIds);
+
+   // Changing the time of the hop should just update its instruction in place
+   auto hop = recipe->getAll<Hop>().first();
+   hop->setTime_min(30);
+   recipe->generateInstructions();
+   QCOMPARE(recipe->getInstructionIds(), firstIds);
+   int numHopInstructions = 0;
+   for (auto instruction : recipe->instructions()) {
+      if (instruction->name() == Recipe::tr("Hop addition")) {
+         QCOMPARE(instruction->interval(), 30.0);
+         ++numHopInstructions;
+      }
+   }
+   QCOMPARE(numHopInstructions, 1);
+
+   // Adding a hop adds one instruction and keeps all the others
+   auto lateHop = std::make_shared<Hop>(QString{"Instructions late hop"});
+   lateHop->setAlpha_pct(6.0);
+   lateHop->setAmount_kg(0.020);
+   lateHop->setUse(Hop::Use::Boil);
+   lateHop->setTime_min(5);
+   ObjectStoreWrapper::insert(lateHop);
+   recipe->add(lateHop);
+   recipe->generateInstructions();
+   QVector<int> const secondIds = recipe->getInstructionIds();
+   QCOMPARE(secondIds.size(), firstIds.size() + 1);
+   for (int id : firstIds) {
+      QVERIFY(secondIds.contains(id));
+   }
+
+   // Removing it again should delete just that one
+   recipe->remove(recipe->getAll<Hop>().last());
+   recipe->generateInstructions();
+   QCOMPARE(recipe->getInstructionIds().size(), firstIds.size());
+   return;
+}
+
+void Testing::testMashSimulation() {
+   MashSimulation::Options options;
+   options.grain_kg       = 5.0;
+   options.absorption_LKg = 1.0;
+   options.boilingPoint_c = 100.0;
+   MashSimulation::Tun const tun{20.0, 18.0, 2000.0};
+   QVector<MashSimulation::Step> const steps{
+      {MashStep::Type::Infusion,    true,  false, 15.0, 65.0, 60.0},
+      {MashStep::Type::Decoction,   false, false,  0.0, 72.0, 10.0},
+      {MashStep::Type::Temperature, false, false,  0.0, 76.0, 10.0},
+      {MashStep::Type::batchSparge, true,  true,  10.0, 76.0, 15.0}
+   };
+   MashSimulation simulation{tun, steps, options};
+   QCOMPARE(simulation.states().size(), steps.size());
+
+   // The strike water has to heat the grain and the tun
+   double const grainThermalMass_calC = options.grain_kg * HeatCalculations::Cgrain_calGC;
+   double const expectedStrike_c =
+      (grainThermalMass_calC * (65.0 - 20.0) + tun.tunThermalMass_calC * (65.0 - 18.0)) /
+      (15.0 * HeatCalculations::Cw_calGC) + 65.0;
+   QVERIFY(qFuzzyCompare(simulation.states().at(0).infuseTemp_c, expectedStrike_c));
+   // ...and needs the amount of water we started with at that temperature
+   QVERIFY(qFuzzyCompare(MashSimulation::infusionAmount_l(expectedStrike_c,
+                                                          grainThermalMass_calC,
+                                                          20.0,
+                                                          65.0,
+                                                          tun.tunThermalMass_calC,
+                                                          18.0),
+                         15.0));
+   QVERIFY(simulation.states().at(1).decoctionAmount_l > 0.0);
+   QCOMPARE(simulation.totalMashWater_l(),      25.0);
+   QCOMPARE(simulation.totalInfusionAmount_l(), 15.0);
+   QCOMPARE(simulation.totalSpargeAmount_l(),   10.0);
+   QCOMPARE(simulation.totalTime_min(),         95.0);
+   QCOMPARE(simulation.wortFromMash_l(),        20.0);
+
+   // Changing one step should give the same answer as simulating the changed steps from scratch
+   MashSimulation::Step changed = steps.at(1);
+   changed.stepTemp_c = 70.0;
+   simulation.updateStep(1, changed);
+   QVector<MashSimulation::Step> changedSteps = steps;
+   changedSteps[1] = changed;
+   MashSimulation const fromScratch{tun, changedSteps, options};
+   for (int ii = 0; ii < steps.size(); ++ii) {
+      auto const & updated  = simulation.states().at(ii);
+      auto const & expected = fromScratch.states().at(ii);
+      QCOMPARE(updated.startTemp_c,       expected.startTemp_c);
+      QCOMPARE(updated.thermalMass_calC,  expected.thermalMass_calC);
+      QCOMPARE(updated.infuseTemp_c,      expected.infuseTemp_c);
+      QCOMPARE(updated.decoctionAmount_l, expected.decoctionAmount_l);
+      QCOMPARE(updated.mashVolume_l,      expected.mashVolume_l);
+   }
+   return;
+}
+
+void Testing::testWaterChemistrySolver() {
+   // Make a target from known additions to RO water, so we know an exact answer exists
+   double constexpr caso4_g = 3.0;
+   double constexpr cacl2_g = 2.0;
+   Salt caso4{""};
+   caso4.setType(Salt::Types::CASO4);
+   caso4.setWhenToAdd(Salt::WhenToAdd::MASH);
+   caso4.setAmount(caso4_g / 1000.0);
+   Salt cacl2{""};
+   cacl2.setType(Salt::Types::CACL2);
+   cacl2.setWhenToAdd(Salt::WhenToAdd::MASH);
+   cacl2.setAmount(cacl2_g / 1000.0);
+
+   WaterChemistrySolver::Problem problem;
+   problem.mashWater_l   = 20.0;
+   problem.spargeWater_l = 10.0;
+   problem.thickness_LKg = 4.0;
+   problem.unadjustedMashPh = 5.7;
+   problem.target_ppm[static_cast<int>(Water::Ions::Ca )] = (caso4.Ca() + cacl2.Ca()) / 30.0;
+   problem.target_ppm[static_cast<int>(Water::Ions::SO4)] = caso4.SO4() / 30.0;
+   problem.target_ppm[static_cast<int>(Water::Ions::Cl )] = cacl2.Cl()  / 30.0;
+
+   auto solution = WaterChemistrySolver::solve(problem);
+   for (int ion = 0; ion < WaterChemistrySolver::numIons; ++ion) {
+      QVERIFY(std::abs(solution.ions_ppm[ion] - problem.target_ppm[ion]) < 0.5);
+   }
+   QVERIFY(std::abs(solution.salt_g[static_cast<int>(Salt::Types::CASO4) - 1] - caso4_g) < 0.01);
+   QVERIFY(std::abs(solution.salt_g[static_cast<int>(Salt::Types::CACL2) - 1] - cacl2_g) < 0.01);
+   QVERIFY(std::abs(solution.mashShare - 2.0 / 3.0) < 1e-9);
+   // No pH target, so no acid
+   QCOMPARE(solution.mashLacticAcid_g, 0.0);
+
+   // Asking for less than the base water has can only be met by adding nothing
+   problem.base_ppm.fill(150.0);
+   solution = WaterChemistrySolver::solve(problem);
+   for (double amount_g : solution.salt_g) {
+      QVERIFY(amount_g >= 0.0);
+      QVERIFY(amount_g < 0.01);
+   }
+
+   // With the ions already right, the pH should be fixed with acid alone
+   problem.target_ppm = problem.base_ppm;
+   problem.targetMashPh = 5.3;
+   solution = WaterChemistrySolver::solve(problem);
+   QVERIFY(solution.mashLacticAcid_g > 0.0);
+   QVERIFY(std::abs(solution.mashPh - 5.3) < 0.01);
+   for (double amount_g : solution.salt_g) {
+      QVERIFY(amount_g < 0.01);
+   }
+   return;
+}
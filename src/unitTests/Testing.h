@@ -92,6 +92,18 @@ private slots:
     */
    void testAlgorithms();
 
+   /**
+    * \brief Verify the table-driven \c Algorithms::PlatoToSG_20C20C against root-finding on the same cubic, across
+    *        (and slightly beyond) the range of plausible gravities.
+    */
+   void testPlatoToSgConversion();
+
+   //! \brief Benchmark \c Algorithms::PlatoToSG_20C20C against the root-finding it replaced
+   void benchmarkPlatoToSg();
+
+   //! \brief Verify the recipe calculations that work on a \c RecipeSnapshot rather than a live \c Recipe
+   void testRecipeSnapshotCalcs();
+
    /**
     * \brief Verify the mechanism we use for looking up type info about a parameter in the "model" classes (ie
     *        \c NamedEntity and subclasses thereof).
@@ -101,6 +113,67 @@ private slots:
    //! \brief Verify Log rotation is working
    void testLogRotation();
 
+   /**
+    * \brief Measure the cost of a debug message in one of our logging categories, when that level is enabled (message
+    *        is queued for the background log writer) and disabled (message is not built at all).
+    */
+   void benchmarkLogging();
+
+   //! \brief Verify \c Measurement::AmountParser and the unit name lookups that go with it
+   void testAmountParser();
+
+   //! \brief Measure the cost of parsing an amount the user typed in (or that we are sorting a table on)
+   void benchmarkAmountParsing();
+
+   //! \brief Verify merging and eviction in \c BoundedUndoStack
+   void testBoundedUndoStack();
+
+   //! \brief Verify that a new version of a Recipe only copies the ingredient that changed
+   void testCopyOnWriteVersioning();
+
+   //! \brief Verify that adding a step to the Mash of a versioned Recipe leaves the previous version's Mash alone
+   void testVersionedMashStep();
+
+   //! \brief Verify that removing steps from the Mash of a versioned Recipe leaves the previous version's Mash alone
+   void testVersionedMashStepRemoval();
+
+   //! \brief Verify that taking a \c RecipeDisplaySnapshot makes display-only changes bump the Recipe's generation, so
+   //!        that cached HTML is regenerated
+   void testRecipeDisplaySnapshot();
+
+   //! \brief Verify that \c Recipe::EditSession holds back signals and recalculation until it is committed
+   void testRecipeEditSession();
+
+   //! \brief Verify that \c ParallelFor::forEachIndex visits every index exactly once
+   void testParallelFor();
+
+   //! \brief Verify that \c RecipeBulkRecalc brings recipes up to date after a change to the IBU formula
+   void testBulkRecalc();
+
+   //! \brief Verify that the batched IBU calculation agrees with the single-hop one for all formulae
+   void testIbuBatch();
+
+   //! \brief Compare the cost of the batched IBU calculation with doing one hop at a time
+   void benchmarkIbuBatch();
+
+   //! \brief Verify \c BoilCurves against the end-of-boil recipe calculations, and incremental against full updates
+   void testBoilCurves();
+
+   //! \brief Verify that \c StyleIndex queries follow changes to recipes and styles
+   void testStyleIndex();
+
+   //! \brief Verify that \c RecipeSimilarity ranks a near-copy of a recipe first, and notices when it changes
+   void testRecipeSimilarity();
+
+   //! \brief Verify that regenerating a recipe's instructions keeps the ones that haven't changed
+   void testGenerateInstructions();
+
+   //! \brief Verify that \c MashSimulation follows the heat balance, and that updating one step matches starting again
+   void testMashSimulation();
+
+   //! \brief Verify that \c WaterChemistrySolver finds additions that hit a reachable target, and never negative ones
+   void testWaterChemistrySolver();
+
 };
 
 #endif
@@ -0,0 +1,271 @@
+/*
+ * utils/Instrumentation.cpp is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/Instrumentation.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include <QDebug>
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+
+namespace {
+   struct TraceEvent {
+      char const * name;
+      int threadNumber;
+      qint64 start_ns;
+      qint64 duration_ns;
+   };
+
+   //
+   // Probes are function-local statics, so they can be created from any thread at any time.  We use a mutex to guard
+   // the list of them, but we only need to take it when a probe is created or when someone asks for the figures.
+   //
+   std::mutex & registryMutex() {
+      static std::mutex mutex;
+      return mutex;
+   }
+   QVector<Instrumentation::Probe *> & registry() {
+      static QVector<Instrumentation::Probe *> probes;
+      return probes;
+   }
+   QVector<Instrumentation::Gauge *> & gaugeRegistry() {
+      static QVector<Instrumentation::Gauge *> gauges;
+      return gauges;
+   }
+
+   //
+   // Trace events, by contrast, are recorded on every hit (when tracing is on) so we don't want to do anything
+   // expensive while holding the mutex
+   //
+   std::atomic<bool> tracingEnabled{false};
+   std::mutex & traceMutex() {
+      static std::mutex mutex;
+      return mutex;
+   }
+   QVector<TraceEvent> & traceEvents() {
+      static QVector<TraceEvent> events;
+      return events;
+   }
+
+   //! Times in the trace are relative to this
+   std::chrono::steady_clock::time_point traceEpoch() {
+      static std::chrono::steady_clock::time_point const epoch = std::chrono::steady_clock::now();
+      return epoch;
+   }
+
+   //! Small, stable, per-thread numbers are easier to read in the trace viewer than native thread IDs
+   int threadNumber() {
+      static std::atomic<int> nextThreadNumber{1};
+      thread_local int const number = nextThreadNumber.fetch_add(1, std::memory_order_relaxed);
+      return number;
+   }
+
+   qint64 toNanoseconds(std::chrono::steady_clock::duration const duration) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+   }
+
+   //! Escape the (very few) characters that could break a JSON string
+   QString jsonEscaped(char const * text) {
+      QString escaped = QString::fromUtf8(text);
+      escaped.replace('\\', "\\\\");
+      escaped.replace('"', "\\\"");
+      return escaped;
+   }
+}
+
+Instrumentation::Probe::Probe(char const * const name) :
+   name{name},
+   count{0},
+   total_ns{0},
+   max_ns{0},
+   histogram{} {
+   // Make sure the trace epoch is set no later than the first probe, so that trace times are never negative
+   traceEpoch();
+   std::lock_guard<std::mutex> lock{registryMutex()};
+   registry().append(this);
+   return;
+}
+
+void Instrumentation::Probe::record(std::chrono::steady_clock::time_point const start,
+                                    std::chrono::steady_clock::time_point const end) {
+   quint64 const duration_ns = static_cast<quint64>(toNanoseconds(end - start));
+
+   this->count.fetch_add(1, std::memory_order_relaxed);
+   this->total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+   quint64 previousMax = this->max_ns.load(std::memory_order_relaxed);
+   while (duration_ns > previousMax &&
+          !this->max_ns.compare_exchange_weak(previousMax, duration_ns, std::memory_order_relaxed)) {
+      // compare_exchange_weak updated previousMax for us, so nothing else to do
+   }
+   std::size_t const bucket = static_cast<std::size_t>(
+      std::upper_bound(histogramBucketLimits_ns.cbegin(),
+                       histogramBucketLimits_ns.cend(),
+                       static_cast<qint64>(duration_ns)) - histogramBucketLimits_ns.cbegin()
+   );
+   this->histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+   if (tracingEnabled.load(std::memory_order_relaxed)) {
+      TraceEvent const event{this->name,
+                             threadNumber(),
+                             toNanoseconds(start - traceEpoch()),
+                             static_cast<qint64>(duration_ns)};
+      std::lock_guard<std::mutex> lock{traceMutex()};
+      if (traceEvents().size() < maxTraceEvents) {
+         traceEvents().append(event);
+      }
+   }
+   return;
+}
+
+Instrumentation::ProbeStats Instrumentation::Probe::stats() const {
+   ProbeStats stats{this->name,
+                    this->count.load(std::memory_order_relaxed),
+                    this->total_ns.load(std::memory_order_relaxed),
+                    this->max_ns.load(std::memory_order_relaxed),
+                    {}};
+   for (std::size_t ii = 0; ii < numHistogramBuckets; ++ii) {
+      stats.histogram[ii] = this->histogram[ii].load(std::memory_order_relaxed);
+   }
+   return stats;
+}
+
+void Instrumentation::Probe::reset() {
+   this->count.store(0, std::memory_order_relaxed);
+   this->total_ns.store(0, std::memory_order_relaxed);
+   this->max_ns.store(0, std::memory_order_relaxed);
+   for (auto & bucket : this->histogram) {
+      bucket.store(0, std::memory_order_relaxed);
+   }
+   return;
+}
+
+QVector<Instrumentation::ProbeStats> Instrumentation::allStats() {
+   std::lock_guard<std::mutex> lock{registryMutex()};
+   QVector<ProbeStats> stats;
+   stats.reserve(registry().size());
+   for (Probe const * probe : registry()) {
+      stats.append(probe->stats());
+   }
+   return stats;
+}
+
+Instrumentation::Gauge::Gauge(char const * const name) :
+   name{name},
+   value{0} {
+   std::lock_guard<std::mutex> lock{registryMutex()};
+   gaugeRegistry().append(this);
+   return;
+}
+
+char const * Instrumentation::Gauge::getName() const {
+   return this->name;
+}
+
+qint64 Instrumentation::Gauge::get() const {
+   return this->value.load(std::memory_order_relaxed);
+}
+
+QVector<QPair<char const *, qint64>> Instrumentation::allGauges() {
+   std::lock_guard<std::mutex> lock{registryMutex()};
+   QVector<QPair<char const *, qint64>> values;
+   values.reserve(gaugeRegistry().size());
+   for (Gauge const * gauge : gaugeRegistry()) {
+      values.append(qMakePair(gauge->getName(), gauge->get()));
+   }
+   return values;
+}
+
+void Instrumentation::reset() {
+   {
+      std::lock_guard<std::mutex> lock{registryMutex()};
+      for (Probe * probe : registry()) {
+         probe->reset();
+      }
+   }
+   std::lock_guard<std::mutex> lock{traceMutex()};
+   traceEvents().clear();
+   return;
+}
+
+void Instrumentation::setTracing(bool const enabled) {
+   qInfo() << Q_FUNC_INFO << "Tracing" << (enabled ? "on" : "off");
+   if (enabled) {
+      std::lock_guard<std::mutex> lock{traceMutex()};
+      traceEvents().clear();
+   }
+   tracingEnabled.store(enabled, std::memory_order_relaxed);
+   return;
+}
+
+bool Instrumentation::isTracing() {
+   return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+int Instrumentation::numTraceEvents() {
+   std::lock_guard<std::mutex> lock{traceMutex()};
+   return traceEvents().size();
+}
+
+bool Instrumentation::writeChromeTrace(QString const & fileName) {
+   // Take a copy so that we don't hold up the probes while we write the file
+   QVector<TraceEvent> events;
+   {
+      std::lock_guard<std::mutex> lock{traceMutex()};
+      events = traceEvents();
+   }
+
+   QFile file{fileName};
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      qWarning() << Q_FUNC_INFO << "Unable to open" << fileName << "for writing:" << file.errorString();
+      return false;
+   }
+
+   //
+   // We write the JSON by hand rather than building a QJsonDocument because there can be a lot of events and they are
+   // all of the same simple form.  "X" events are "complete" events, ie ones with a start and a duration.  Times are
+   // in microseconds, but fractions are allowed.
+   //
+   QTextStream out{&file};
+   out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+   QSet<int> threadNumbers;
+   bool first = true;
+   for (auto const & event : events) {
+      out << (first ? "" : ",\n") <<
+         "{\"name\":\"" << jsonEscaped(event.name) << "\",\"cat\":\"brewtarget\",\"ph\":\"X\",\"pid\":1,\"tid\":" <<
+         event.threadNumber << ",\"ts\":" << QString::number(event.start_ns / 1000.0, 'f', 3) << ",\"dur\":" <<
+         QString::number(event.duration_ns / 1000.0, 'f', 3) << "}";
+      threadNumbers.insert(event.threadNumber);
+      first = false;
+   }
+   // Metadata events to give the threads names in the viewer
+   for (int const number : threadNumbers) {
+      out << (first ? "" : ",\n") <<
+         "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << number << ",\"args\":{\"name\":\"Thread " <<
+         number << "\"}}";
+      first = false;
+   }
+   out << "\n]}\n";
+   out.flush();
+   file.close();
+
+   qInfo() << Q_FUNC_INFO << "Wrote" << events.size() << "trace events to" << fileName;
+   return file.error() == QFileDevice::NoError;
+}
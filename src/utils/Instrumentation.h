@@ -0,0 +1,214 @@
+/*
+ * utils/Instrumentation.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_INSTRUMENTATION_H
+#define UTILS_INSTRUMENTATION_H
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * \brief Lightweight timing probes for the places where we expect time to go (loading from the DB, recipe
+ *        calculations, building tree models, BeerXML, etc).
+ *
+ *        To time a function (or any other scope), put this at the top of it:
+ *
+ *           BT_TIME_SCOPE("Recipe::recalcAll");
+ *
+ *        Each probe keeps a count of how many times it was hit, the total and maximum time taken, and a histogram of
+ *        durations (see \c Instrumentation::ProbeStats).  In addition, tracing can be turned on (see
+ *        \c Instrumentation::setTracing) to record every individual timing, and the results written to a file that
+ *        can be viewed in Chrome's about://tracing page or https://ui.perfetto.dev.
+ *
+ *        A probe that isn't being traced costs two reads of the steady clock and a few atomic additions.  Building
+ *        with \c BT_NO_INSTRUMENTATION defined (eg via the CMake option \c NO_INSTRUMENTATION) removes the probes
+ *        altogether.
+ *
+ *        Similarly, \c BT_SET_GAUGE("undoStack/bytes", value) records the latest value of something we want to keep an
+ *        eye on (eg how much memory something is using) so that it can be shown alongside the timings.
+ *
+ *        The name passed to \c BT_TIME_SCOPE or \c BT_SET_GAUGE must be a string literal (or otherwise live for the
+ *        whole program) as we only store the pointer.
+ */
+namespace Instrumentation {
+
+   //! \brief Upper bounds (exclusive) of histogram buckets.  The last bucket is for everything else.
+   constexpr std::array<qint64, 7> histogramBucketLimits_ns {
+      1'000,          // 1µs
+      10'000,         // 10µs
+      100'000,        // 100µs
+      1'000'000,      // 1ms
+      10'000'000,     // 10ms
+      100'000'000,    // 100ms
+      1'000'000'000   // 1s
+   };
+   constexpr std::size_t numHistogramBuckets = histogramBucketLimits_ns.size() + 1;
+
+   /**
+    * \brief Point-in-time copy of the figures for one probe
+    */
+   struct ProbeStats {
+      char const * name;
+      quint64 count;
+      quint64 total_ns;
+      quint64 max_ns;
+      std::array<quint64, numHistogramBuckets> histogram;
+   };
+
+   /**
+    * \brief One named timing probe.  Don't create these directly -- use \c BT_TIME_SCOPE, which makes a function-local
+    *        static one per call site.  Probes with the same name are reported separately if they are at different
+    *        call sites.
+    */
+   class Probe {
+   public:
+      Probe(char const * const name);
+      ~Probe() = default;
+
+      void record(std::chrono::steady_clock::time_point const start, std::chrono::steady_clock::time_point const end);
+
+      ProbeStats stats() const;
+
+      void reset();
+
+   private:
+      char const * const name;
+      std::atomic<quint64> count;
+      std::atomic<quint64> total_ns;
+      std::atomic<quint64> max_ns;
+      std::array<std::atomic<quint64>, numHistogramBuckets> histogram;
+
+      // Probes are registered by address, so must not be copied or moved
+      Probe(Probe const &) = delete;
+      Probe & operator=(Probe const &) = delete;
+      Probe(Probe &&) = delete;
+      Probe & operator=(Probe &&) = delete;
+   };
+
+   /**
+    * \brief RAII timer that records the time between its construction and destruction in a \c Probe
+    */
+   class ScopedTimer {
+   public:
+      ScopedTimer(Probe & probe) : probe{probe}, start{std::chrono::steady_clock::now()} {
+         return;
+      }
+      ~ScopedTimer() {
+         this->probe.record(this->start, std::chrono::steady_clock::now());
+         return;
+      }
+
+   private:
+      Probe & probe;
+      std::chrono::steady_clock::time_point const start;
+
+      ScopedTimer(ScopedTimer const &) = delete;
+      ScopedTimer & operator=(ScopedTimer const &) = delete;
+      ScopedTimer(ScopedTimer &&) = delete;
+      ScopedTimer & operator=(ScopedTimer &&) = delete;
+   };
+
+   /**
+    * \brief A named value that we show along with the probe figures.  Don't create these directly -- use
+    *        \c BT_SET_GAUGE, which makes a function-local static one per call site.
+    */
+   class Gauge {
+   public:
+      Gauge(char const * const name);
+      ~Gauge() = default;
+
+      void set(qint64 const newValue) {
+         this->value.store(newValue, std::memory_order_relaxed);
+         return;
+      }
+
+      char const * getName() const;
+      qint64 get() const;
+
+   private:
+      char const * const name;
+      std::atomic<qint64> value;
+
+      // Gauges are registered by address, so must not be copied or moved
+      Gauge(Gauge const &) = delete;
+      Gauge & operator=(Gauge const &) = delete;
+      Gauge(Gauge &&) = delete;
+      Gauge & operator=(Gauge &&) = delete;
+   };
+
+   /**
+    * \return Figures for all the probes that have been hit at least once so far (ie whose call sites have been
+    *         reached), in the order they were first hit
+    */
+   QVector<ProbeStats> allStats();
+
+   /**
+    * \return Name and latest value of each gauge that has been set at least once so far, in the order they were first
+    *         set
+    */
+   QVector<QPair<char const *, qint64>> allGauges();
+
+   /**
+    * \brief Zero the figures for all probes, and discard any trace events recorded so far.  (Gauges are left alone, as
+    *        they are current values rather than accumulated figures.)
+    */
+   void reset();
+
+   /**
+    * \brief Turn recording of individual timings on or off.  Off by default.  To stop memory use growing without
+    *        limit if this is left on, we stop recording after \c maxTraceEvents events (but carry on updating the
+    *        per-probe figures).
+    */
+   void setTracing(bool enabled);
+   bool isTracing();
+   constexpr int maxTraceEvents = 1'000'000;
+
+   //! \return Number of trace events recorded since tracing was last turned on or \c reset() was called
+   int numTraceEvents();
+
+   /**
+    * \brief Write recorded trace events to \c fileName in the Chrome Trace Event format
+    *        (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU)
+    *
+    * \return \c false if the file could not be written (in which case the reason will have been logged)
+    */
+   bool writeChromeTrace(QString const & fileName);
+}
+
+#ifdef BT_NO_INSTRUMENTATION
+#define BT_TIME_SCOPE(name)
+#define BT_SET_GAUGE(name, value)
+#else
+// We need two levels of indirection to get __LINE__ expanded before it is pasted onto the variable names
+#define BT_TIME_SCOPE_CONCAT_INNER(a, b) a##b
+#define BT_TIME_SCOPE_CONCAT(a, b) BT_TIME_SCOPE_CONCAT_INNER(a, b)
+#define BT_TIME_SCOPE(name) \
+   static Instrumentation::Probe BT_TIME_SCOPE_CONCAT(btProbe_, __LINE__){name}; \
+   Instrumentation::ScopedTimer BT_TIME_SCOPE_CONCAT(btTimer_, __LINE__){BT_TIME_SCOPE_CONCAT(btProbe_, __LINE__)}
+#define BT_SET_GAUGE(name, value) \
+   do { static Instrumentation::Gauge btGauge{name}; btGauge.set(value); } while (false)
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * utils/ParallelFor.h is part of Brewtarget, and is Copyright the following
+ * authors 2023
+ * - Matt Young <mfsy@yahoo.com>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UTILS_PARALLELFOR_H
+#define UTILS_PARALLELFOR_H
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+/**
+ * \brief Simple data-parallel loops for batch work (eg recalculating every Recipe in the database) that doesn't touch
+ *        any model objects or the database.  We only need QtCore for this, so there's no dependency on QtConcurrent.
+ *
+ *        NB: Model objects (\c Recipe, \c Hop etc) and database connections belong to the GUI thread, so the function
+ *        passed in must only work on plain data (eg \c RecipeSnapshot).
+ */
+namespace ParallelFor {
+
+   //! \brief Default number of threads: one per core
+   inline int defaultNumThreads() {
+      return std::max(QThread::idealThreadCount(), 1);
+   }
+
+   namespace detail {
+      /**
+       * \brief Each worker takes the next \c chunkSize indexes from a shared counter until there are none left.  This
+       *        means threads that get quick items take more of them, so we don't need to know in advance how long each
+       *        item will take.
+       */
+      template<class Functor>
+      class Worker : public QRunnable {
+      public:
+         Worker(std::atomic<int> & nextIndex, int const count, int const chunkSize, Functor const & functor) :
+            nextIndex{nextIndex},
+            count{count},
+            chunkSize{chunkSize},
+            functor{functor} {
+            return;
+         }
+
+         virtual void run() {
+            for (;;) {
+               int const start = this->nextIndex.fetch_add(this->chunkSize, std::memory_order_relaxed);
+               if (start >= this->count) {
+                  return;
+               }
+               int const end = std::min(start + this->chunkSize, this->count);
+               for (int ii = start; ii < end; ++ii) {
+                  this->functor(ii);
+               }
+            }
+         }
+
+      private:
+         std::atomic<int> & nextIndex;
+         int const count;
+         int const chunkSize;
+         Functor const & functor;
+      };
+   }
+
+   /**
+    * \brief Call \c functor(ii) for every \c ii from 0 to \c count - 1, spread across \c numThreads threads (one of
+    *        which is the calling thread), and wait for them all to finish.
+    *
+    *        \c functor must be safe to call from several threads at once, must not throw, and should not rely on the
+    *        order of the calls.  Typically it reads element \c ii of one (const) container and writes element \c ii of
+    *        another, pre-sized, one.
+    *
+    * \param chunkSize How many consecutive indexes a thread takes at a time.  Bigger chunks mean less contention on the
+    *                  shared counter; smaller ones mean better load-balancing at the end.
+    */
+   template<class Functor>
+   void forEachIndex(int const count,
+                     Functor const & functor,
+                     int const numThreads = defaultNumThreads(),
+                     int const chunkSize = 16) {
+      if (count <= 0) {
+         return;
+      }
+      std::atomic<int> nextIndex{0};
+      detail::Worker<Functor> work{nextIndex, count, std::max(chunkSize, 1), functor};
+      int const numWorkers = std::min(std::max(numThreads, 1), count);
+      if (numWorkers > 1) {
+         // We use our own pool rather than QThreadPool::globalInstance() so that callers can say exactly how many
+         // threads to use (eg when measuring how well something scales)
+         QThreadPool pool;
+         pool.setMaxThreadCount(numWorkers - 1);
+         for (int ii = 1; ii < numWorkers; ++ii) {
+            auto extraWorker = new detail::Worker<Functor>{nextIndex, count, std::max(chunkSize, 1), functor};
+            extraWorker->setAutoDelete(true);
+            pool.start(extraWorker);
+         }
+         work.run();
+         pool.waitForDone();
+      } else {
+         work.run();
+      }
+      return;
+   }
+}
+
+#endif
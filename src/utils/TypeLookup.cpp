@@ -35,6 +35,12 @@ bool TypeInfo::isOptional() const {
    return false;
 }
 
+TypeInfo TypeInfo::withMemberAccess(MemberAccess const * memberAccess) const {
+   TypeInfo result{*this};
+   result.memberAccess = memberAccess;
+   return result;
+}
+
 TypeLookup::TypeLookup(char       const * const                                 className,
                        std::initializer_list<TypeLookup::LookupMap::value_type> initializerList,
                        TypeLookup const * const                                 parentClassLookup) :
@@ -44,19 +50,35 @@ TypeLookup::TypeLookup(char       const * const
    return;
 }
 
-TypeInfo const & TypeLookup::getType(BtStringConst const & propertyName) const {
-   auto match = std::find_if(
-      this->lookupMap.begin(),
-      this->lookupMap.end(),
-      [& propertyName](auto const & record) { return propertyName == *record.first; }
-   );
+TypeInfo const * TypeLookup::findType(BtStringConst const & propertyName) const {
+   //
+   // Callers almost always pass in the same PropertyNames::... constant that was used to build the map, so we can
+   // usually find it by address, which is a lot quicker than comparing strings.
+   //
+   auto match = this->lookupMap.find(&propertyName);
+   if (match == this->lookupMap.end()) {
+      match = std::find_if(
+         this->lookupMap.begin(),
+         this->lookupMap.end(),
+         [& propertyName](auto const & record) { return propertyName == *record.first; }
+      );
+   }
 
    if (match != this->lookupMap.end()) {
-      return match->second;
+      return &match->second;
    }
 
    if (this->parentClassLookup) {
-      return this->parentClassLookup->getType(propertyName);
+      return this->parentClassLookup->findType(propertyName);
+   }
+
+   return nullptr;
+}
+
+TypeInfo const & TypeLookup::getType(BtStringConst const & propertyName) const {
+   TypeInfo const * typeInfo = this->findType(propertyName);
+   if (typeInfo) {
+      return *typeInfo;
    }
 
    // It's a coding error if we tried to look up a property that we don't know about
@@ -71,3 +93,8 @@ bool TypeLookup::isOptional(BtStringConst const & propertyName) const {
    // that case here
    return this->getType(propertyName).isOptional();
 }
+
+MemberAccess const * TypeLookup::getMemberAccess(BtStringConst const & propertyName) const {
+   TypeInfo const * typeInfo = this->findType(propertyName);
+   return typeInfo ? typeInfo->memberAccess : nullptr;
+}
@@ -23,6 +23,10 @@
 #include <optional>
 #include <typeindex>
 #include <typeinfo>
+#include <type_traits>
+
+#include <QString>
+#include <QVariant>
 
 #include "BtFieldType.h"
 #include "utils/BtStringConst.h"
@@ -86,6 +90,83 @@ template <typename T> concept IsOptionalEnum  = is_optional_enum<T>::value;
 template <typename T> concept IsOptionalOther = !is_optional_enum<T>::value && is_optional<T>::value;
 #endif
 
+class NamedEntity;
+
+/**
+ * \brief Typed access to the member variable in which a property is stored.  \c PROPERTY_TYPE_LOOKUP_ENTRY generates
+ *        one of these from the member pointer it is given, which means internal code (recalculations, writing a
+ *        changed property to the DB, etc) can read a stored value without going through \c QObject::property() --
+ *        ie without looking up the property by name in the meta-object or boxing the value in a \c QVariant.
+ *
+ *        Note that this gives the value \b as \b stored.  A handful of getters do more than return a member
+ *        variable (eg \c Recipe::og() will do all the recipe calculations if they have not yet been done), so this is
+ *        for code that knows the stored value is what it wants, typically because a setter has just written it.
+ *
+ *        Use \c NamedEntity::storedValue rather than accessing this directly.
+ */
+struct MemberAccess {
+   //! Exact type of the member variable (so, unlike \c TypeInfo::typeIndex, including any \c std::optional wrapper)
+   std::type_index memberType;
+
+   //! \return Address of the member variable in \c object
+   void const * (*address)(NamedEntity const & object);
+
+   /**
+    * \brief For the simple types (\c double, \c int, \c unsigned \c int, \c bool, \c QString) that make up the vast
+    *        majority of properties, this returns the value wrapped in a \c QVariant, for code that needs one anyway.
+    *        For other types, it is \c nullptr and callers should fall back to \c QObject::property().
+    */
+   QVariant (*readAsVariant)(NamedEntity const & object);
+};
+
+/**
+ * \brief Splits a pointer-to-member type into the class and member types
+ */
+template<typename T> struct MemberPointerTraits;
+template<class C, typename M> struct MemberPointerTraits<M C::*> {
+   using ClassType  = C;
+   using MemberType = M;
+};
+
+/**
+ * \brief Generates the \c MemberAccess for a given member pointer.  You shouldn't need to use this directly as
+ *        \c PROPERTY_TYPE_LOOKUP_ENTRY takes care of it.
+ *
+ *        Some properties are stored in a member of a pimpl class (eg \c Recipe::impl::hopIds) or of a class that is not
+ *        a \c NamedEntity (eg \c Inventory::impl::amount), which we can't get to from a \c NamedEntity reference, so
+ *        \c get() returns \c nullptr for those.
+ */
+template<auto memberPointer> struct MemberAccessFor {
+   using ClassType  = typename MemberPointerTraits<decltype(memberPointer)>::ClassType;
+   using MemberType = typename MemberPointerTraits<decltype(memberPointer)>::MemberType;
+
+   static void const * address(NamedEntity const & object) {
+      return &(static_cast<ClassType const &>(object).*memberPointer);
+   }
+
+   static QVariant readAsVariant(NamedEntity const & object) {
+      return QVariant::fromValue(*static_cast<MemberType const *>(address(object)));
+   }
+
+   static MemberAccess const * get() {
+      if constexpr (std::is_base_of_v<NamedEntity, ClassType>) {
+         if constexpr (std::is_same_v<MemberType, double      > ||
+                       std::is_same_v<MemberType, int         > ||
+                       std::is_same_v<MemberType, unsigned int> ||
+                       std::is_same_v<MemberType, bool        > ||
+                       std::is_same_v<MemberType, QString     >) {
+            static MemberAccess const memberAccess{typeid(MemberType), &address, &readAsVariant};
+            return &memberAccess;
+         } else {
+            static MemberAccess const memberAccess{typeid(MemberType), &address, nullptr};
+            return &memberAccess;
+         }
+      } else {
+         return nullptr;
+      }
+   }
+};
+
 /**
  * \brief Extends \c std::type_index with some other info we need about a type for serialisation, specifically whether
  *        it is an enum and/or whether it is \c std::optional.
@@ -139,12 +220,21 @@ struct TypeInfo {
     */
    std::optional<BtFieldType> fieldType;
 
+   /**
+    * \brief Typed access to the member variable in which the property is stored, or \c nullptr if there isn't one we
+    *        can access from a \c NamedEntity.  See \c MemberAccess.
+    */
+   MemberAccess const * memberAccess = nullptr;
+
    /**
     * \return \c true if \c classification is \c OptionalEnum or \c OptionalOther, \c false otherwise (ie if
     *         \c classification is \c RequiredEnum or \c RequiredOther
     */
    bool isOptional() const;
 
+   //! \return Copy of this \c TypeInfo with \c memberAccess set.  Used by \c PROPERTY_TYPE_LOOKUP_ENTRY.
+   TypeInfo withMemberAccess(MemberAccess const * memberAccess) const;
+
    /**
     * \brief Factory functions to construct a \c TypeInfo for a given type.
     *
@@ -208,7 +298,20 @@ public:
     */
    bool isOptional(BtStringConst const & propertyName) const;
 
+   /**
+    * \brief Get typed access to the member variable in which a given property is stored.  Unlike \c getType, it is not
+    *        an error to ask about a property we don't know about.
+    *
+    * \return \c nullptr if there is no such property or it is not stored in a member we can access
+    */
+   MemberAccess const * getMemberAccess(BtStringConst const & propertyName) const;
+
 private:
+   /**
+    * \return \c TypeInfo for \c propertyName from this lookup or its parent(s), or \c nullptr if not found
+    */
+   TypeInfo const * findType(BtStringConst const & propertyName) const;
+
    char       const * const className;
    LookupMap          const lookupMap;
    TypeLookup const * const parentClassLookup;
@@ -225,12 +328,13 @@ private:
  *           PROPERTY_TYPE_LOOKUP_ENTRY(PropertyNames::Hop::notes    , Hop::m_notes                                     ),
  *           PROPERTY_TYPE_LOOKUP_ENTRY(PropertyNames::Hop::alpha_pct, Hop::m_alpha_pct, NonPhysicalQuantity::Percentage),
  *           PROPERTY_TYPE_LOOKUP_ENTRY(PropertyNames::Hop::amount_kg, Hop::m_amount_kg, Measurment::Mass               ),
- *        The macro and the templates above etc then do the necessary.
+ *        The macro and the templates above etc then do the necessary, including generating the \c MemberAccess that
+ *        lets internal code read the member directly (see \c NamedEntity::storedValue).
  *
  *        Note that the introduction of __VA_OPT__ in C++20 makes dealing with the optional third argument a LOT less
  *        painful than it would otherwise be!
  */
-#define PROPERTY_TYPE_LOOKUP_ENTRY(propNameConstVar, memberVar, ...) {&propNameConstVar, TypeInfo::construct<decltype(memberVar)>(__VA_OPT__ (__VA_ARGS__))}
+#define PROPERTY_TYPE_LOOKUP_ENTRY(propNameConstVar, memberVar, ...) {&propNameConstVar, TypeInfo::construct<decltype(memberVar)>(__VA_OPT__ (__VA_ARGS__)).withMemberAccess(MemberAccessFor<&memberVar>::get())}
 
 /**
  * \brief Similar to \c PROPERTY_TYPE_LOOKUP_ENTRY but used when we do not have a member variable and instead must use
@@ -45,6 +45,7 @@
 #include "model/Style.h"
 #include "model/Water.h"
 #include "model/Yeast.h"
+#include "utils/Instrumentation.h"
 #include "xml/BtDomErrorHandler.h"
 #include "xml/MibEnum.h"
 #include "xml/XmlCoding.h"
@@ -742,6 +743,8 @@ void BeerXML::createXmlFile(QFile & outFile) const {
 }
 
 template<class NE> void BeerXML::toXml(QList<NE const *> const & nes, QFile & outFile) const {
+   BT_TIME_SCOPE("BeerXML::toXml");
+
    // We don't want to output empty container records
    if (nes.empty()) {
       return;
@@ -783,6 +786,8 @@ template void BeerXML::toXml(QList<Recipe      const *> const & nes, QFile & out
 
 // fromXml ====================================================================
 bool BeerXML::importFromXML(QString const & filename, QTextStream & userMessage) {
+   BT_TIME_SCOPE("BeerXML::importFromXML");
+
    //
    // During importation we do not want automatic versioning turned on because, during the process of reading in a
    // Recipe we'll end up creating load of versions of it.  The magic of RAII means it's a one-liner to suspend
@@ -27,6 +27,7 @@
 #include <xalanc/XPath/XPathEvaluator.hpp>
 #include <xalanc/XalanDOM/XalanNamedNodeMap.hpp>
 
+#include "Logging.h"
 #include "xml/XmlCoding.h"
 #include "utils/OptionalHelpers.h"
 
@@ -111,7 +112,7 @@ std::shared_ptr<NamedEntity> XmlRecord::getNamedEntity() const {
 bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                      xalanc::XalanNode * rootNodeOfRecord,
                      QTextStream & userMessage) {
-   qDebug() << Q_FUNC_INFO;
+   qCDebug(Logging::xml) << Q_FUNC_INFO;
 
    xalanc::XPathEvaluator xPathEvaluator;
    //
@@ -145,7 +146,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                                     rootNodeOfRecord,
                                     fieldDefinition->xPath.getXalanString());
       auto numChildNodes = nodesForCurrentXPath.getLength();
-      qDebug() << Q_FUNC_INFO << "Found" << numChildNodes << "node(s) for " << fieldDefinition->xPath;
+      qCDebug(Logging::xml) << Q_FUNC_INFO << "Found" << numChildNodes << "node(s) for " << fieldDefinition->xPath;
       if (XmlRecord::FieldType::RecordSimple == fieldDefinition->fieldType ||
           XmlRecord::FieldType::RecordComplex == fieldDefinition->fieldType) {
          //
@@ -174,12 +175,12 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
          XQString fieldName{fieldContainerNode->getNodeName()};
          xalanc::XalanNodeList const * fieldContents = fieldContainerNode->getChildNodes();
          int numChildrenOfContainerNode = fieldContents->getLength();
-         qDebug() <<
+         qCDebug(Logging::xml) <<
             Q_FUNC_INFO << "Node " << fieldDefinition->xPath << "(" << fieldName << ":" <<
             XALAN_NODE_TYPES[fieldContainerNode->getNodeType()] << ") has " <<
             numChildrenOfContainerNode << " children";
          if (0 == numChildrenOfContainerNode) {
-            qDebug() << Q_FUNC_INFO << "Empty!";
+            qCDebug(Logging::xml) << Q_FUNC_INFO << "Empty!";
          } else {
             {
                //
@@ -194,7 +195,7 @@ bool XmlRecord::load(xalanc::DOMSupport & domSupport,
                }
                xalanc::XalanNode * valueNode = fieldContents->item(0);
                XQString value(valueNode->getNodeValue());
-               qDebug() << Q_FUNC_INFO << "Value " << value;
+               qCDebug(Logging::xml) << Q_FUNC_INFO << "Value " << value;
 
                bool parsedValueOk = false;
                QVariant parsedValue;
@@ -642,13 +643,11 @@ bool XmlRecord::normaliseAndStoreChildRecordsInDb(QTextStream & userMessage,
          // It's a coding error if we can't create a valid QVariant from a pointer to class we are trying to "set"
          Q_ASSERT(QVariant::fromValue(ii->xmlRecord->namedEntity.get()).isValid());
 
-         qDebug() <<
-            Q_FUNC_INFO << "Setting" << propertyName << "property (type = " <<
-            this->namedEntity->metaObject()->property(
-               this->namedEntity->metaObject()->indexOfProperty(propertyName)
-            ).typeName() << ") on" << this->namedEntityClassName << "object";
-         this->namedEntity->setProperty(propertyName,
-                                        QVariant::fromValue(ii->xmlRecord->namedEntity.get()));
+         qCDebug(Logging::xml) <<
+            Q_FUNC_INFO << "Setting" << propertyName << "property (type = " << metaProperty.typeName() << ") on" <<
+            this->namedEntityClassName << "object";
+         // We already have the QMetaProperty, so there's no need to have QObject::setProperty() look it up again
+         metaProperty.write(this->namedEntity.get(), QVariant::fromValue(ii->xmlRecord->namedEntity.get()));
       }
    }
    return true;